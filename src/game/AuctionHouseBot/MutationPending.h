@@ -68,6 +68,7 @@ struct PendingMutation
     std::string reserveKey;     ///< "bid:<auc>:<seq>" gold reserve, or empty
     std::string itemKey;        ///< "item:<auc>" escrow row (sell), or empty
     std::string depKey;         ///< "dep:<auc>" deposit row (sell), or empty
+    uint8  houseGroup;          ///< auctioneer's house group: the worker it went to
 };
 
 /**
@@ -187,8 +188,9 @@ void AhHandlePlayerMutationResult(PlayerMutationResult const& res);
 /// AH_RESOLVE_NO_ACK (spec 4.3). Implemented by Task 12.
 uint8 AhHandleResolveApply(ResolveApply const& ra);
 
-/// Reconcile-on-reconnect walk (spec 8). Implemented by Task 12.
-void AhReconcileOnReconnect();
+/// Reconcile-on-reconnect walk (spec 8) over the pendings of the house groups
+/// in @p houseMask (the reconnecting worker's, see AhHouseShards.h).
+void AhReconcileOnReconnect(uint8 houseMask);
 
 /// Forward-only re-attempt of finalizes whose checked commit failed (spec 4.1
 /// step 4, "failed finalize") + the in-doubt tombstone sweep. Called once per
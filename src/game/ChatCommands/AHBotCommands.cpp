@@ -92,11 +92,18 @@ bool ChatHandler::HandleAHBotRebuildCommand(char* args)
  */
 bool ChatHandler::HandleAHBotReloadCommand(char* /*args*/)
 {
-    WorkerSupervisor* sv = sWorld.GetAhSupervisor();
-    if (sv != NULL && sv->ServiceActive())
+    std::vector<WorkerSupervisor*> shards;
+    sWorld.GetAhSupervisors(shards);
+    bool serviceActive = false;
+    for (size_t i = 0; i < shards.size(); ++i)
+    {
+        serviceActive = serviceActive || shards[i]->ServiceActive();
+    }
+
+    if (serviceActive)
     {
         // Refresh the mangosd-side config (sAuctionBotConfig, bot GUID,
-        // etc.) and forward a reload signal to the child process.
+        // etc.) and forward a reload signal to every active child process.
         sAuctionBot.ReloadAllConfig();
 
         GmCmd gc;
@@ -104,7 +111,13 @@ bool ChatHandler::HandleAHBotReloadCommand(char* /*args*/)
         IpcMessage m;
         m.op = IPC_GMCMD;
         gc.Encode(m.body);
-        sv->Channel().SendFrame(m);
+        for (size_t i = 0; i < shards.size(); ++i)
+        {
+            if (shards[i]->ServiceActive())
+            {
+                shards[i]->Channel().SendFrame(m);
+            }
+        }
 
         SendSysMessage("AH bot config reloaded (mangosd); reload signal"
                        " sent to AH service - result will be logged.");
@@ -204,13 +217,29 @@ bool ChatHandler::HandleAHBotStatusCommand(char* args)
     }
 
     // --- AH subprocess service state + executor stats ---
-    WorkerSupervisor* sv = sWorld.GetAhSupervisor();
-    if (sv != NULL)
+    std::vector<WorkerSupervisor*> shards;
+    sWorld.GetAhSupervisors(shards);
+    bool serviceActive = false;
+    for (size_t i = 0; i < shards.size(); ++i)
     {
-        const char* svcState = sv->ServiceActive()
+        serviceActive = serviceActive || shards[i]->ServiceActive();
+    }
+    if (!shards.empty())
+    {
+        const char* svcState = serviceActive
             ? "active"
             : "inactive (in-process bot running)";
         PSendSysMessage("[AH service] state: %s", svcState);
+        if (shards.size() > 1)
+        {
+            // AH.Service.Shards: one line per house-shard worker.
+            for (size_t i = 0; i < shards.size(); ++i)
+            {
+                PSendSysMessage("[AH service] worker %s: %s",
+                                AhHouseMaskName(shards[i]->Houses()).c_str(),
+                                shards[i]->ServiceActive() ? "active" : "down");
+            }
+        }
         PSendSysMessage("[AH service] executor: applied=%llu rejected=%llu"
                         " duplicate=%llu malformed=%llu",
                         sAuctionIntentExecutor.GetApplied(),
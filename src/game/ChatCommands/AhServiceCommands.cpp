@@ -72,6 +72,34 @@ static bool IsAhServiceConnected(WorkerSupervisor* sv)
     return sv != NULL && sv->Channel().Connected();
 }
 
+// ---------------------------------------------------------------------------
+// Helper: send one frame to every connected AH worker (one per house shard,
+// see AH.Service.Shards). Returns how many workers were connected; @p failed
+// counts those whose send failed.
+// ---------------------------------------------------------------------------
+
+static uint32 SendToAhWorkers(IpcMessage const& msg, uint32& failed)
+{
+    std::vector<WorkerSupervisor*> shards;
+    sWorld.GetAhSupervisors(shards);
+
+    uint32 connected = 0;
+    failed = 0;
+    for (size_t i = 0; i < shards.size(); ++i)
+    {
+        if (!IsAhServiceConnected(shards[i]))
+        {
+            continue;
+        }
+        ++connected;
+        if (!shards[i]->Channel().SendFrame(msg))
+        {
+            ++failed;
+        }
+    }
+    return connected;
+}
+
 static std::string TrimRepairArgs(char const* args)
 {
     std::string text = args ? args : "";
@@ -534,18 +562,17 @@ bool ChatHandler::HandleAhServiceConsoleShowCommand(char* /*args*/)
         return false;
     }
 
-    WorkerSupervisor* sv = sWorld.GetAhSupervisor();
-    if (!IsAhServiceConnected(sv))
+    IpcMessage msg;
+    msg.op = IPC_CONSOLE;
+    msg.body << static_cast<uint8>(1);
+    uint32 failed = 0;
+    if (SendToAhWorkers(msg, failed) == 0)
     {
         SendSysMessage("AH service is not running.");
         SetSentErrorMessage(true);
         return false;
     }
-
-    IpcMessage msg;
-    msg.op = IPC_CONSOLE;
-    msg.body << static_cast<uint8>(1);
-    if (!sv->Channel().SendFrame(msg))
+    if (failed != 0)
     {
         SendSysMessage("AH service is not responding (send failed).");
         SetSentErrorMessage(true);
@@ -570,18 +597,17 @@ bool ChatHandler::HandleAhServiceConsoleHideCommand(char* /*args*/)
         return false;
     }
 
-    WorkerSupervisor* sv = sWorld.GetAhSupervisor();
-    if (!IsAhServiceConnected(sv))
+    IpcMessage msg;
+    msg.op = IPC_CONSOLE;
+    msg.body << static_cast<uint8>(0);
+    uint32 failed = 0;
+    if (SendToAhWorkers(msg, failed) == 0)
     {
         SendSysMessage("AH service is not running.");
         SetSentErrorMessage(true);
         return false;
     }
-
-    IpcMessage msg;
-    msg.op = IPC_CONSOLE;
-    msg.body << static_cast<uint8>(0);
-    if (!sv->Channel().SendFrame(msg))
+    if (failed != 0)
     {
         SendSysMessage("AH service is not responding (send failed).");
         SetSentErrorMessage(true);
@@ -42,6 +42,7 @@
 #include "CreatureEventAIMgr.h"
 #include "BattleGroundMgr.h"
 #include "ItemEnchantmentMgr.h"
+#include "AuctionHouseMgr.h"
 #include "CommandMgr.h"
 
 /**
@@ -1385,6 +1386,7 @@ bool ChatHandler::HandleReloadLocalesItemCommand(char* /*args*/)
 {
     sLog.outString("Re-Loading Locales Item ... ");
     sObjectMgr.LoadItemLocales();
+    sAuctionMgr.ResetItemNameCache();
     SendGlobalSysMessage("DB table `locales_item` reloaded.", SEC_MODERATOR);
     return true;
 }
@@ -37,9 +37,14 @@
 #include "ObjectMgr.h"
 #include "World.h"
 #include "Config.h"
+#include "Database/DatabaseEnv.h"
 #include "GitRevision.h"
+#include "OpcodeStats.h"
+#include "OpcodeTable.h"
+#include "PlayerSaveScheduler.h"
 #include "SystemConfig.h"
 #include "UpdateTime.h"
+#include "WorldNetwork.h"
 #include "revision_data.h"
 
 /**
@@ -88,6 +93,221 @@ bool ChatHandler::HandleServerInfoCommand(char* /*args*/)
     PSendSysMessage(LANG_UPTIME, str.c_str());
     PSendSysMessage("World Delay: %u", updateTime); // ToDo: move to language string
 
+    // Writes handed to the transport bound the send() syscalls from above; compare
+    // a run with Network.CorkOutput against one without.
+    WorldNetwork::SendStats const net = sWorldNetwork.GetSendStats();
+    uint32 const uptime = std::max<uint32>(sWorld.GetUptime(), 1);
+    PSendSysMessage("Network: " UI64FMTD " packets in " UI64FMTD " writes (%.1f writes/sec, %.0f bytes/write, corking %s)",
+        net.packets, net.writes, double(net.writes) / uptime,
+        net.writes ? double(net.bytes) / net.writes : 0.0, net.corked ? "on" : "off");
+    if (net.shaping)
+    {
+        PSendSysMessage("Shaping: " UI64FMTD " packets held for congested clients, " UI64FMTD " superseded movement updates merged",
+            net.shaped, net.merged);
+    }
+
+    // One line per async thread of the character database, unkeyed shard first
+    // (see CharacterDatabaseAsyncShards).
+    std::vector<SqlDelayStats> const dbStats = CharacterDatabase.GetAsyncStats();
+    for (SqlDelayStats const& shard : dbStats)
+    {
+        PSendSysMessage("Character DB async %u: " UI64FMTD " queued, " UI64FMTD " done, avg wait %.2f ms, avg exec %.2f ms, max latency %.1f ms",
+            shard.shard, shard.queued, shard.executed,
+            shard.executed ? shard.totalWaitUs / 1000.0 / shard.executed : 0.0,
+            shard.executed ? shard.totalExecUs / 1000.0 / shard.executed : 0.0,
+            shard.maxLatencyUs / 1000.0);
+    }
+
+    Player::SaveCounters const& saves = Player::GetSaveCounters();
+    uint64 const deltaSaves = saves.saves[Player::SaveCounters::DELTA];
+    uint64 const fullSaves = saves.saves[Player::SaveCounters::FULL];
+    PSendSysMessage("Player saves: " UI64FMTD " delta (%.1f statements each), " UI64FMTD " full (%.1f statements each)",
+        deltaSaves, deltaSaves ? double(saves.statements[Player::SaveCounters::DELTA]) / deltaSaves : 0.0,
+        fullSaves, fullSaves ? double(saves.statements[Player::SaveCounters::FULL]) / fullSaves : 0.0);
+
+    if (sPlayerSaveScheduler.IsEnabled())
+    {
+        PlayerSaveScheduler::Stats const stats = sPlayerSaveScheduler.GetStats();
+        PSendSysMessage("Save scheduler: %u in rotation, %u due (oldest %u ms), last tick %u saves / %u statements, "
+            UI64FMTD " ticks over budget, " UI64FMTD " turns skipped",
+            stats.rotation, stats.due, stats.oldestDueMs, stats.lastTickSaves, stats.lastTickStatements,
+            stats.budgetStops, stats.skipped);
+    }
+
+    return true;
+}
+
+/**
+ * @brief Handler for HandleServerOpcodesCommand command.
+ *
+ * Syntax: .server opcodes [world|map|out [count]] | reset
+ *
+ * Lists the busiest opcodes counted since startup or the last reset; without a
+ * lane the top five of each lane are shown.
+ *
+ * @param args Command arguments.
+ * @returns True if the command executed successfully, false otherwise.
+ */
+bool ChatHandler::HandleServerOpcodesCommand(char* args)
+{
+    if (!sOpcodeStats.IsEnabled())
+    {
+        SendSysMessage("Opcode statistics are disabled (OpcodeStats.Enable).");
+        return true;
+    }
+
+    if (ExtractLiteralArg(&args, "reset"))
+    {
+        sOpcodeStats.Reset();
+        SendSysMessage("Opcode statistics reset.");
+        return true;
+    }
+
+    static char const* const laneNames[OPSTATS_LANE_COUNT] = { "world", "map", "out" };
+
+    uint32 firstLane = 0;
+    uint32 lastLane = OPSTATS_LANE_COUNT - 1;
+    uint32 count = 5;
+    if (*args)
+    {
+        char* laneArg = ExtractLiteralArg(&args);
+        if (!laneArg)
+        {
+            return false;
+        }
+
+        uint32 lane = 0;
+        while (lane < OPSTATS_LANE_COUNT && strncmp(laneArg, laneNames[lane], strlen(laneArg)) != 0)
+        {
+            ++lane;
+        }
+
+        if (lane == OPSTATS_LANE_COUNT)
+        {
+            return false;
+        }
+
+        firstLane = lastLane = lane;
+        count = 20;
+        if (*args && !ExtractUInt32(&args, count))
+        {
+            return false;
+        }
+    }
+
+    PSendSysMessage("Opcode statistics for the last %u seconds:", uint32(time(NULL) - sOpcodeStats.GetSince()));
+    for (uint32 lane = firstLane; lane <= lastLane; ++lane)
+    {
+        std::vector<OpcodeStats::Row> const rows = sOpcodeStats.GetTop(OpcodeStatsLane(lane), count);
+        PSendSysMessage("[%s] %u opcodes", laneNames[lane], uint32(rows.size()));
+        for (OpcodeStats::Row const& row : rows)
+        {
+            OpcodeStats::Counter const& c = row.counter;
+            if (lane == OPSTATS_LANE_OUTBOUND)
+            {
+                PSendSysMessage("  %s: " UI64FMTD " sent, " UI64FMTD " bytes",
+                    LookupOpcodeName(row.opcode), c.calls, c.bytes);
+            }
+            else
+            {
+                PSendSysMessage("  %s: " UI64FMTD " calls, " UI64FMTD " bytes, total " UI64FMTD " us, avg %u us, p99 %u us, max %u us",
+                    LookupOpcodeName(row.opcode), c.calls, c.bytes, c.totalUs, uint32(c.totalUs / c.calls),
+                    c.PercentileUs(0.99), c.maxUs);
+            }
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief Handler for HandleServerQueriesCommand command.
+ *
+ * Syntax: .server queries [world|character|realm [count]] | reset
+ *
+ * Lists the SQL statements with the most total time since startup or the last
+ * reset; without a database the top five of each are shown.
+ *
+ * @param args Command arguments.
+ * @returns True if the command executed successfully, false otherwise.
+ */
+bool ChatHandler::HandleServerQueriesCommand(char* args)
+{
+    static char const* const databaseNames[] = { "world", "character", "realm" };
+    Database* const databases[] = { &WorldDatabase, &CharacterDatabase, &LoginDatabase };
+    uint32 const databaseCount = countof(databaseNames);
+
+    if (!WorldDatabase.GetProfiler().IsEnabled())
+    {
+        SendSysMessage("Query statistics are disabled (DatabaseProfiler.Enable).");
+        return true;
+    }
+
+    if (ExtractLiteralArg(&args, "reset"))
+    {
+        for (uint32 i = 0; i < databaseCount; ++i)
+        {
+            databases[i]->GetProfiler().Reset();
+        }
+        SendSysMessage("Query statistics reset.");
+        return true;
+    }
+
+    uint32 first = 0;
+    uint32 last = databaseCount - 1;
+    uint32 count = 5;
+    if (*args)
+    {
+        char* nameArg = ExtractLiteralArg(&args);
+        if (!nameArg)
+        {
+            return false;
+        }
+
+        uint32 index = 0;
+        while (index < databaseCount && strncmp(nameArg, databaseNames[index], strlen(nameArg)) != 0)
+        {
+            ++index;
+        }
+
+        if (index == databaseCount)
+        {
+            return false;
+        }
+
+        first = last = index;
+        count = 20;
+        if (*args && !ExtractUInt32(&args, count))
+        {
+            return false;
+        }
+    }
+
+    for (uint32 i = first; i <= last; ++i)
+    {
+        SqlProfiler& profiler = databases[i]->GetProfiler();
+        std::vector<SqlProfiler::Row> const rows = profiler.GetTop(count);
+        PSendSysMessage("[%s] top %u statements of the last %u seconds:", databaseNames[i], uint32(rows.size()),
+                        uint32(time(NULL) - profiler.GetSince()));
+        for (SqlProfiler::Row const& row : rows)
+        {
+            SqlProfiler::Counter const& c = row.counter;
+            PSendSysMessage("  " UI64FMTD " ms, " UI64FMTD " calls (" UI64FMTD " async), avg %u us, max %u us, " UI64FMTD " rows",
+                c.TotalUs() / 1000, c.Calls(), c.calls[SQL_CALLER_ASYNC], uint32(c.TotalUs() / c.Calls()), c.maxUs, c.rows);
+            if (c.calls[SQL_CALLER_WORLD])
+            {
+                PSendSysMessage("  ! " UI64FMTD " sync calls on the world thread, " UI64FMTD " ms",
+                    c.calls[SQL_CALLER_WORLD], c.totalUs[SQL_CALLER_WORLD] / 1000);
+            }
+            if (c.calls[SQL_CALLER_MAP])
+            {
+                PSendSysMessage("  ! " UI64FMTD " sync calls on map threads, " UI64FMTD " ms",
+                    c.calls[SQL_CALLER_MAP], c.totalUs[SQL_CALLER_MAP] / 1000);
+            }
+            PSendSysMessage("    %s", row.statement.c_str());
+        }
+    }
+
     return true;
 }
 
@@ -135,6 +135,9 @@ int MapUpdater::wait()
 
 void MapUpdater::workerLoop()
 {
+    // the tick waits for every map, so a sync query here holds it up like one on the world thread
+    SqlProfiler::SetThreadCaller(SQL_CALLER_MAP);
+
     for (;;)
     {
         Task task(nullptr, 0);
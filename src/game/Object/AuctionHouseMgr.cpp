@@ -46,6 +46,7 @@
 
 #include "Policies/Singleton.h"
 
+#include <algorithm>
 #include <string>
 #include <vector>
 
@@ -947,6 +948,17 @@ void AuctionHouseMgr::Update()
     }
 }
 
+/**
+ * @brief Drops the cached lower-cased item names of every house.
+ */
+void AuctionHouseMgr::ResetItemNameCache()
+{
+    for (int i = 0; i < MAX_AUCTION_HOUSE_TYPE; ++i)
+    {
+        mAuctions[i].ResetItemNameCache();
+    }
+}
+
 /**
  * @brief Resolves the team associated with an auction house entry.
  *
@@ -1045,6 +1057,170 @@ AuctionHouseEntry const* AuctionHouseMgr::GetAuctionHouseEntry(Unit* unit)
     return sAuctionHouseStore.LookupEntry(houseid);
 }
 
+/**
+ * @brief Adds an auction to this house and to its browse index.
+ *
+ * @param ah The auction to add; replaces any auction with the same id.
+ */
+void AuctionHouseObject::AddAuction(AuctionEntry* ah)
+{
+    MANGOS_ASSERT(ah);
+
+    AuctionEntryMap::iterator itr = AuctionsMap.find(ah->Id);
+    if (itr != AuctionsMap.end())
+    {
+        UnindexAuction(itr->second);
+        itr->second = ah;
+    }
+    else
+    {
+        AuctionsMap[ah->Id] = ah;
+    }
+    IndexAuction(ah);
+}
+
+/**
+ * @brief Removes an auction from this house and from its browse index.
+ *
+ * The entry itself is not deleted.
+ *
+ * @param id The auction id.
+ * @return true if the auction was present; otherwise, false.
+ */
+bool AuctionHouseObject::RemoveAuction(uint32 id)
+{
+    AuctionEntryMap::iterator itr = AuctionsMap.find(id);
+    if (itr == AuctionsMap.end())
+    {
+        return false;
+    }
+    UnindexAuction(itr->second);
+    AuctionsMap.erase(itr);
+    return true;
+}
+
+/**
+ * @brief Files an auction under its item entry's class, subclass, inventory
+ *        type, quality and required level.
+ *
+ * @param ah The auction, already in AuctionsMap.
+ */
+void AuctionHouseObject::IndexAuction(AuctionEntry* ah)
+{
+    ItemPrototype const* proto = ObjectMgr::GetItemPrototype(ah->itemTemplate);
+    if (!proto)
+    {
+        return;
+    }
+
+    m_byClass[proto->Class][ah->Id] = ah;
+    m_bySubClass[(proto->Class << 16) | proto->SubClass][ah->Id] = ah;
+    m_byInventoryType[proto->InventoryType][ah->Id] = ah;
+    m_byQuality[proto->Quality][ah->Id] = ah;
+    m_byRequiredLevel[proto->RequiredLevel][ah->Id] = ah;
+    m_byTemplate[proto->ItemId].auctions[ah->Id] = ah;
+}
+
+/// Erase @p id from @p index[key], dropping the bucket once it is empty.
+static void ErasePosting(std::map<uint32, AuctionHouseObject::AuctionEntryMap>& index,
+    uint32 key, uint32 id)
+{
+    std::map<uint32, AuctionHouseObject::AuctionEntryMap>::iterator itr = index.find(key);
+    if (itr == index.end())
+    {
+        return;
+    }
+    itr->second.erase(id);
+    if (itr->second.empty())
+    {
+        index.erase(itr);
+    }
+}
+
+/**
+ * @brief Reverses IndexAuction.
+ *
+ * @param ah The auction, still in AuctionsMap.
+ */
+void AuctionHouseObject::UnindexAuction(AuctionEntry* ah)
+{
+    ItemPrototype const* proto = ObjectMgr::GetItemPrototype(ah->itemTemplate);
+    if (!proto)
+    {
+        return;
+    }
+
+    ErasePosting(m_byClass, proto->Class, ah->Id);
+    ErasePosting(m_bySubClass, (proto->Class << 16) | proto->SubClass, ah->Id);
+    ErasePosting(m_byInventoryType, proto->InventoryType, ah->Id);
+    ErasePosting(m_byQuality, proto->Quality, ah->Id);
+    ErasePosting(m_byRequiredLevel, proto->RequiredLevel, ah->Id);
+
+    std::map<uint32, ListedTemplate>::iterator itr = m_byTemplate.find(proto->ItemId);
+    if (itr != m_byTemplate.end())
+    {
+        itr->second.auctions.erase(ah->Id);
+        if (itr->second.auctions.empty())
+        {
+            m_byTemplate.erase(itr);
+        }
+    }
+}
+
+/**
+ * @brief Drops the cached lower-cased item names of this house.
+ */
+void AuctionHouseObject::ResetItemNameCache()
+{
+    for (std::map<uint32, ListedTemplate>::iterator itr = m_byTemplate.begin(); itr != m_byTemplate.end(); ++itr)
+    {
+        itr->second.lowered.clear();
+        itr->second.loweredState.clear();
+    }
+}
+
+/**
+ * @brief Same answer as Utf8FitTo on the item's localized name, from the
+ *        per-locale cache.
+ *
+ * @param listed The listed item entry.
+ * @param itemId The item entry id.
+ * @param loc_idx The DB locale index of the searching session.
+ * @param wsearchedname The lower-cased search string.
+ * @return true if the name contains the search string.
+ */
+bool AuctionHouseObject::TemplateNameFits(ListedTemplate& listed, uint32 itemId, int loc_idx,
+    std::wstring const& wsearchedname)
+{
+    size_t const slot = loc_idx < 0 ? 0 : size_t(loc_idx) + 1;
+    if (listed.loweredState.size() <= slot)
+    {
+        listed.lowered.resize(slot + 1);
+        listed.loweredState.resize(slot + 1, 0);
+    }
+
+    if (listed.loweredState[slot] == 0)
+    {
+        ItemPrototype const* proto = ObjectMgr::GetItemPrototype(itemId);
+        std::string name = proto ? proto->Name1 : "";
+        sObjectMgr.GetItemLocaleStrings(itemId, loc_idx, &name);
+
+        if (Utf8toWStr(name, listed.lowered[slot]))
+        {
+            wstrToLower(listed.lowered[slot]);
+            listed.loweredState[slot] = 1;
+        }
+        else
+        {
+            listed.lowered[slot].clear();
+            listed.loweredState[slot] = 2;
+        }
+    }
+
+    return listed.loweredState[slot] == 1 &&
+        listed.lowered[slot].find(wsearchedname) != std::wstring::npos;
+}
+
 /**
  * @brief Updates auction entries and expires finished auctions.
  */
@@ -1125,10 +1301,11 @@ void AuctionHouseObject::Update()
                 {
                     sAuctionMgr.SendAuctionExpiredMail(old->second);
 
-                    old->second->DeleteFromDB();
-                    sAuctionMgr.RemoveAItem(old->second->itemGuidLow);
-                    delete old->second;
-                    AuctionsMap.erase(old);
+                    AuctionEntry* expired = old->second;
+                    expired->DeleteFromDB();
+                    sAuctionMgr.RemoveAItem(expired->itemGuidLow);
+                    RemoveAuction(expired->Id);
+                    delete expired;
                     continue;
                 }
             }
@@ -1184,9 +1361,148 @@ void AuctionHouseObject::BuildListOwnerItems(WorldPacket& data, Player* player,
     }
 }
 
+/// Append every @p index bucket keyed lo..hi to @p out; returns their total size.
+static size_t CollectPostings(std::map<uint32, AuctionHouseObject::AuctionEntryMap> const& index,
+    uint32 lo, uint32 hi, std::vector<AuctionHouseObject::AuctionEntryMap const*>& out)
+{
+    size_t total = 0;
+    std::map<uint32, AuctionHouseObject::AuctionEntryMap>::const_iterator itr = index.lower_bound(lo);
+    for (; itr != index.end() && itr->first <= hi; ++itr)
+    {
+        out.push_back(&itr->second);
+        total += itr->second.size();
+    }
+    return total;
+}
+
+/// Keep @p candidate (its buckets hold @p size auctions) as the walk when it is
+/// the first or the smallest set so far; @p candidate is left empty.
+static void TakeIfSmaller(std::vector<AuctionHouseObject::AuctionEntryMap const*>& candidate,
+    size_t size, std::vector<AuctionHouseObject::AuctionEntryMap const*>& postings,
+    size_t& best, bool& narrowed)
+{
+    if (!narrowed || size < best)
+    {
+        postings.swap(candidate);
+        best = size;
+        narrowed = true;
+    }
+    candidate.clear();
+}
+
+/// Order auctions by id, the order a walk over the whole house yields.
+static bool AuctionIdLess(AuctionEntry const* a, AuctionEntry const* b)
+{
+    return a->Id < b->Id;
+}
+
+/**
+ * @brief Collects the auctions a public browse must look at, in auction id
+ *        order.
+ *
+ * Instead of the whole house, only the smallest candidate set the filters
+ * allow is returned: one class or class/subclass bucket, one inventory type,
+ * the quality buckets at or above the minimum, the required-level range, or
+ * the item entries whose cached lower-cased name matches. The candidates are
+ * a superset of the matches; the caller still runs the full filter.
+ *
+ * @param wsearchedname The lower-cased search string.
+ * @param loc_idx The DB locale index of the searching session.
+ * @param levelmin The minimum required item level filter.
+ * @param levelmax The maximum required item level filter.
+ * @param inventoryType The inventory type filter.
+ * @param itemClass The item class filter.
+ * @param itemSubClass The item subclass filter.
+ * @param quality The minimum quality filter.
+ * @param out Receives the candidates, ascending by auction id.
+ */
+void AuctionHouseObject::CollectBrowseCandidates(std::wstring const& wsearchedname, int loc_idx,
+    uint32 levelmin, uint32 levelmax, uint32 inventoryType, uint32 itemClass, uint32 itemSubClass,
+    uint32 quality, std::vector<AuctionEntry*>& out)
+{
+    out.clear();
+
+    // Pick the smallest candidate set; none chosen means the whole house.
+    std::vector<AuctionEntryMap const*> postings;
+    std::vector<AuctionEntryMap const*> candidate;
+    size_t best = AuctionsMap.size();
+    bool narrowed = false;
+
+    if (itemClass != 0xffffffff)
+    {
+        size_t const size = itemSubClass != 0xffffffff
+            ? CollectPostings(m_bySubClass, (itemClass << 16) | itemSubClass, (itemClass << 16) | itemSubClass, candidate)
+            : CollectPostings(m_byClass, itemClass, itemClass, candidate);
+        TakeIfSmaller(candidate, size, postings, best, narrowed);
+    }
+
+    if (inventoryType != 0xffffffff)
+    {
+        size_t const size = CollectPostings(m_byInventoryType, inventoryType, inventoryType, candidate);
+        TakeIfSmaller(candidate, size, postings, best, narrowed);
+    }
+
+    if (quality != 0xffffffff)
+    {
+        size_t const size = CollectPostings(m_byQuality, quality, 0xffffffff, candidate);
+        TakeIfSmaller(candidate, size, postings, best, narrowed);
+    }
+
+    if (levelmin != 0x00 && (levelmax == 0x00 || levelmax >= levelmin))
+    {
+        size_t const size = CollectPostings(m_byRequiredLevel, levelmin,
+            levelmax != 0x00 ? levelmax : 0xffffffff, candidate);
+        TakeIfSmaller(candidate, size, postings, best, narrowed);
+    }
+    else if (levelmin != 0x00)
+    {
+        // levelmax below levelmin: nothing can match.
+        postings.clear();
+        best = 0;
+        narrowed = true;
+    }
+
+    // The name index costs one cached find per listed entry, so skip it when
+    // the candidate set is already smaller than that.
+    if (!wsearchedname.empty() && m_byTemplate.size() < best)
+    {
+        size_t size = 0;
+        for (std::map<uint32, ListedTemplate>::iterator itr = m_byTemplate.begin(); itr != m_byTemplate.end(); ++itr)
+        {
+            if (TemplateNameFits(itr->second, itr->first, loc_idx, wsearchedname))
+            {
+                candidate.push_back(&itr->second.auctions);
+                size += itr->second.auctions.size();
+            }
+        }
+        TakeIfSmaller(candidate, size, postings, best, narrowed);
+    }
+
+    if (!narrowed)
+    {
+        postings.push_back(&AuctionsMap);
+    }
+
+    out.reserve(best);
+    for (size_t i = 0; i < postings.size(); ++i)
+    {
+        for (AuctionEntryMap::const_iterator itr = postings[i]->begin(); itr != postings[i]->end(); ++itr)
+        {
+            out.push_back(itr->second);
+        }
+    }
+    if (postings.size() > 1)
+    {
+        std::sort(out.begin(), out.end(), AuctionIdLess);
+    }
+}
+
 /**
  * @brief Builds the filtered public auction browse list.
  *
+ * Only the candidates CollectBrowseCandidates picks are filtered, in auction
+ * id order, so the page and the total match a walk over every auction.
+ *
  * @param data The packet buffer to append to.
  * @param player The player requesting the list.
  * @param wsearchedname The search string in wide-character form.
@@ -1208,9 +1524,13 @@ void AuctionHouseObject::BuildListAuctionItems(WorldPacket& data, Player* player
 {
     int loc_idx = player->GetSession()->GetSessionDbLocaleIndex();
 
-    for (AuctionEntryMap::const_iterator itr = AuctionsMap.begin(); itr != AuctionsMap.end(); ++itr)
+    std::vector<AuctionEntry*> walk;
+    CollectBrowseCandidates(wsearchedname, loc_idx, levelmin, levelmax, inventoryType,
+        itemClass, itemSubClass, quality, walk);
+
+    for (size_t i = 0; i < walk.size(); ++i)
     {
-        AuctionEntry* Aentry = itr->second;
+        AuctionEntry* Aentry = walk[i];
         Item* item = sAuctionMgr.GetAItem(Aentry->itemGuidLow);
         if (!item)
         {
@@ -1264,12 +1584,26 @@ void AuctionHouseObject::BuildListAuctionItems(WorldPacket& data, Player* player
                 }
             }
 
-            std::string name = proto->Name1;
-            sObjectMgr.GetItemLocaleStrings(proto->ItemId, loc_idx, &name);
-
-            if (!wsearchedname.empty() && !Utf8FitTo(name, wsearchedname))
+            if (!wsearchedname.empty())
             {
-                continue;
+                std::map<uint32, ListedTemplate>::iterator listed = m_byTemplate.find(proto->ItemId);
+                if (listed != m_byTemplate.end())
+                {
+                    if (!TemplateNameFits(listed->second, proto->ItemId, loc_idx, wsearchedname))
+                    {
+                        continue;
+                    }
+                }
+                else
+                {
+                    std::string name = proto->Name1;
+                    sObjectMgr.GetItemLocaleStrings(proto->ItemId, loc_idx, &name);
+
+                    if (!Utf8FitTo(name, wsearchedname))
+                    {
+                        continue;
+                    }
+                }
             }
 
             if (count < 50 && totalcount >= listfrom)
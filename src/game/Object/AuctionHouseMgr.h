@@ -41,6 +41,7 @@
 #include "Policies/Singleton.h"
 #include "DBCStructure.h"
 
+#include <map>
 #include <string>
 #include <vector>
 
@@ -178,11 +179,7 @@ class AuctionHouseObject
         AuctionEntryMap const& GetAuctions() const { return AuctionsMap; }
         AuctionEntryMapBounds GetAuctionsBounds() const {return AuctionEntryMapBounds(AuctionsMap.begin(), AuctionsMap.end()); }
 
-        void AddAuction(AuctionEntry* ah)
-        {
-            MANGOS_ASSERT(ah);
-            AuctionsMap[ah->Id] = ah;
-        }
+        void AddAuction(AuctionEntry* ah);
 
         AuctionEntry* GetAuction(uint32 id) const
         {
@@ -190,10 +187,7 @@ class AuctionHouseObject
             return itr != AuctionsMap.end() ? itr->second : NULL;
         }
 
-        bool RemoveAuction(uint32 id)
-        {
-            return AuctionsMap.erase(id);
-        }
+        bool RemoveAuction(uint32 id);
 
         void Update();
 
@@ -204,6 +198,17 @@ class AuctionHouseObject
             uint32 inventoryType, uint32 itemClass, uint32 itemSubClass, uint32 quality,
             uint32& count, uint32& totalcount);
 
+        /// The auctions BuildListAuctionItems filters for these arguments, in
+        /// auction id order: a superset of the matches, taken from the browse
+        /// index instead of the whole house.
+        void CollectBrowseCandidates(std::wstring const& wsearchedname, int loc_idx,
+            uint32 levelmin, uint32 levelmax, uint32 inventoryType, uint32 itemClass,
+            uint32 itemSubClass, uint32 quality, std::vector<AuctionEntry*>& out);
+
+        /// Forget the lower-cased item names the browse index cached (after a
+        /// locales_item reload); they are rebuilt on the next name search.
+        void ResetItemNameCache();
+
         /// Dispatcher for in-process browse fallback (C1/I1). Switches on @p kind:
         ///   0 = LIST (public browse), 1 = OWNER, 2 = BIDDER.
         /// For BIDDER the @p clientOutbidIds entries are prepended in CLIENT ORDER
@@ -218,7 +223,35 @@ class AuctionHouseObject
         AuctionEntry* AddAuction(AuctionHouseEntry const* auctionHouseEntry, Item* newItem, uint32 etime, uint32 bid, uint32 buyout = 0, uint32 deposit = 0, Player* pl = NULL, bool ownTransaction = true);
         AuctionEntry* AddAuctionByGuid(AuctionHouseEntry const* auctionHouseEntry, Item* newItem, uint32 etime, uint32 bid, uint32 buyout, uint32 lowguid);
     private:
+        /// Auctions bucketed by one item_template column. Each bucket is an
+        /// AuctionEntryMap, so it walks in auction id order like AuctionsMap.
+        typedef std::map<uint32, AuctionEntryMap> AuctionPostings;
+
+        /// The auctions of one item entry in this house, plus the entry's name
+        /// lower-cased the way Utf8FitTo does it, filled per locale on the
+        /// first name search in that locale.
+        struct ListedTemplate
+        {
+            AuctionEntryMap           auctions;
+            std::vector<std::wstring> lowered;       ///< [loc_idx + 1]
+            std::vector<uint8>        loweredState;  ///< [loc_idx + 1]: 0 unfilled, 1 filled, 2 not UTF-8
+        };
+
+        void IndexAuction(AuctionEntry* ah);
+        void UnindexAuction(AuctionEntry* ah);
+        bool TemplateNameFits(ListedTemplate& listed, uint32 itemId, int loc_idx,
+            std::wstring const& wsearchedname);
+
         AuctionEntryMap AuctionsMap;
+
+        // Browse index over AuctionsMap, kept in step by AddAuction/RemoveAuction.
+        // Auctions whose item entry is unknown are left out of it.
+        AuctionPostings m_byClass;                          ///< key: Class
+        AuctionPostings m_bySubClass;                       ///< key: Class << 16 | SubClass
+        AuctionPostings m_byInventoryType;                  ///< key: InventoryType
+        AuctionPostings m_byQuality;                        ///< key: Quality
+        AuctionPostings m_byRequiredLevel;                  ///< key: RequiredLevel
+        std::map<uint32, ListedTemplate> m_byTemplate;      ///< key: item entry
 };
 
 /**
@@ -300,6 +333,9 @@ class AuctionHouseMgr
         void AddAItem(Item* it);
         bool RemoveAItem(uint32 id);
 
+        /// AuctionHouseObject::ResetItemNameCache for every house.
+        void ResetItemNameCache();
+
         void Update();
 
     private:
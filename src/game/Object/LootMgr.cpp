@@ -120,8 +120,9 @@ void LootStore::LoadLootTable()
     // Clearing store (for reloading case)
     Clear();
 
-    //                                                 0      1     2                    3        4              5         6
-    QueryResult* result = WorldDatabase.PQuery("SELECT `entry`, `item`, `ChanceOrQuestChance`, `groupid`, `mincountOrRef`, `maxcount`, `condition_id` FROM `%s`", GetName());
+    //                                             0        1              2                3             4              5             6
+    std::string const sql = std::string("SELECT `entry`, `item`, `ChanceOrQuestChance`, `groupid`, `mincountOrRef`, `maxcount`, `condition_id` FROM `") + GetName() + "`";
+    QueryResult* result = WorldDatabase.QuerySnapshot(sql.c_str(), GetName(), true);
 
     if (result)
     {
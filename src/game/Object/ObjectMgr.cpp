@@ -550,24 +550,30 @@ void ObjectMgr::LoadCreatureSpells()
 
 
 
+// the AH bot forged system owner has no characters row; case-insensitive, to
+// match the DB collation of `characters`.`name`
+bool ObjectMgr::IsAhBotSystemOwnerName(const std::string& name)
+{
+    std::wstring wname;
+    std::wstring wsys;
+    if (!Utf8toWStr(name, wname) || !Utf8toWStr(AHBOT_SYSTEM_OWNER_NAME, wsys))
+    {
+        return false;
+    }
+
+    wstrToLower(wname);
+    wstrToLower(wsys);
+    return wname == wsys;
+}
+
 // name must be checked to correctness (if received) before call this function
 ObjectGuid ObjectMgr::GetPlayerGuidByName(std::string name) const
 {
     // AH bot forged system owner: resolve the reserved name to the sentinel
-    // GUID WITHOUT a characters row or a DB round-trip (case-insensitive, to
-    // match the DB collation used below).
+    // GUID WITHOUT a characters row or a DB round-trip.
+    if (IsAhBotSystemOwnerName(name))
     {
-        std::wstring wname;
-        std::wstring wsys;
-        if (Utf8toWStr(name, wname) && Utf8toWStr(AHBOT_SYSTEM_OWNER_NAME, wsys))
-        {
-            wstrToLower(wname);
-            wstrToLower(wsys);
-            if (wname == wsys)
-            {
-                return ObjectGuid(HIGHGUID_PLAYER, AHBOT_SYSTEM_OWNER_GUID);
-            }
-        }
+        return ObjectGuid(HIGHGUID_PLAYER, AHBOT_SYSTEM_OWNER_GUID);
     }
 
     ObjectGuid guid;
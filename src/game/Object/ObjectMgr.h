@@ -43,6 +43,8 @@
 
 #include <map>
 #include <limits>
+#include <memory>
+#include <mutex>
 
 class Group;
 class Item;
@@ -583,6 +585,7 @@ class ObjectMgr
         void GetPlayerLevelInfo(uint32 race, uint32 class_, uint32 level, PlayerLevelInfo* info) const;
 
         ObjectGuid GetPlayerGuidByName(std::string name) const;
+        static bool IsAhBotSystemOwnerName(const std::string& name);
         bool GetPlayerNameByGUID(ObjectGuid guid, std::string& name) const;
         Team GetPlayerTeamByGUID(ObjectGuid guid) const;
         uint8 GetPlayerClassByGUID(ObjectGuid guid) const;
@@ -1132,6 +1135,10 @@ class ObjectMgr
         void LoadReservedPlayersNames();
         bool IsReservedName(const std::string& name) const;
 
+        // names of characters being created, held until their first save has run
+        bool ClaimCreatingName(const std::string& name);
+        void ReleaseCreatingName(const std::string& name, std::shared_ptr<SqlCommitStatus> const& save = nullptr);
+
         // name with valid structure and symbols
         static uint8 CheckPlayerName(const std::string& name, bool create = false);
         static PetNameInvalidReason CheckPetName(const std::string& name);
@@ -1344,6 +1351,11 @@ class ObjectMgr
         typedef std::set<std::wstring> ReservedNamesMap;
         ReservedNamesMap    m_ReservedNames;
 
+        // creates in flight (NULL) or saves not run yet, by lowercased name; sessions update on several threads
+        typedef std::map<std::wstring, std::shared_ptr<SqlCommitStatus> > CreatingNamesMap;
+        CreatingNamesMap    m_CreatingNames;
+        std::mutex          m_CreatingNamesLock;
+
         GraveYardMap        mGraveYardMap;
 
         GameTeleMap         m_GameTeleMap;
@@ -1370,6 +1382,7 @@ class ObjectMgr
         void LoadQuestRelationsHelper(QuestRelationsMap& map, QuestActor actor, QuestRole role);
         void LoadVendors(char const* tableName, bool isTemplates);
         void LoadTrainers(char const* tableName, bool isTemplates);
+        void SweepCreatingNames();
 
         void LoadGossipMenu(std::set<uint32>& gossipScriptSet);
         void LoadGossipMenuItems(std::set<uint32>& gossipScriptSet);
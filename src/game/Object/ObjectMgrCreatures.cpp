@@ -765,7 +765,7 @@ void ObjectMgr::LoadCreatureModelInfo()
 void ObjectMgr::LoadCreatures()
 {
     uint32 count = 0;
-    QueryResult* result = WorldDatabase.Query(
+    QueryResult* result = WorldDatabase.QuerySnapshot(
         //                      0                  1     2      3
             "SELECT `creature`.`guid`, `creature`.`id`, `map`, `modelid`,"
         //    4               5             6             7             8              9                10           11
@@ -777,7 +777,8 @@ void ObjectMgr::LoadCreatures()
             "FROM `creature` "
             "LEFT OUTER JOIN `game_event_creature` ON `creature`.`guid` = `game_event_creature`.`guid` "
             "LEFT OUTER JOIN `pool_creature` ON `creature`.`guid` = `pool_creature`.`guid` "
-            "LEFT OUTER JOIN `pool_creature_template` ON `creature`.`id` = `pool_creature_template`.`id`");
+            "LEFT OUTER JOIN `pool_creature_template` ON `creature`.`id` = `pool_creature_template`.`id`",
+            "creature,game_event_creature,pool_creature,pool_creature_template", true);
 
     if (!result)
     {
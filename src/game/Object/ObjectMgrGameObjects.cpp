@@ -64,7 +64,7 @@
  */
 void ObjectMgr::LoadGameObjects()
 {
-    QueryResult* result = WorldDatabase.Query(
+    QueryResult* result = WorldDatabase.QuerySnapshot(
         //                        0                    1                  2                   3                          4                          5             6
             "SELECT `gameobject`.`guid`, `gameobject`.`id`, `gameobject`.`map`, `gameobject`.`position_x`, `gameobject`.`position_y`, `gameobject`.`position_z`, `gameobject`.`orientation`, "
         //                 7                         8                         9                         10                        11                            12              13
@@ -74,7 +74,8 @@ void ObjectMgr::LoadGameObjects()
             "FROM `gameobject` "
             "LEFT OUTER JOIN `game_event_gameobject` ON `gameobject`.`guid` = `game_event_gameobject`.`guid` "
             "LEFT OUTER JOIN `pool_gameobject` ON `gameobject`.`guid` = `pool_gameobject`.`guid` "
-            "LEFT OUTER JOIN `pool_gameobject_template` ON `gameobject`.`id` = `pool_gameobject_template`.`id`");
+            "LEFT OUTER JOIN `pool_gameobject_template` ON `gameobject`.`id` = `pool_gameobject_template`.`id`",
+            "gameobject,game_event_gameobject,pool_gameobject,pool_gameobject_template", true);
 
     if (!result)
     {
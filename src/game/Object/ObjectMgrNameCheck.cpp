@@ -26,6 +26,7 @@
 
 #include "ObjectMgr.h"
 #include "Database/DatabaseEnv.h"
+#include "Database/SqlOperations.h"
 #include "Log.h"
 #include "ProgressBar.h"
 #include "Util.h"
@@ -152,6 +153,79 @@ bool ObjectMgr::IsReservedName(const std::string& name) const
     return m_ReservedNames.find(wstr) != m_ReservedNames.end();
 }
 
+/**
+ * @brief Claims a name for a character creation in flight.
+ *
+ * The name check of a create is an async query, so two creates of the same
+ * name could both find it free before either character row is written.
+ *
+ * @param name The normalized player name.
+ * @return false if another create holds the name or its save has not run yet.
+ */
+bool ObjectMgr::ClaimCreatingName(const std::string& name)
+{
+    std::wstring wstr;
+    if (!Utf8toWStr(name, wstr))
+    {
+        return false;
+    }
+
+    wstrToLower(wstr);
+
+    std::lock_guard<std::mutex> guard(m_CreatingNamesLock);
+    SweepCreatingNames();
+    return m_CreatingNames.insert(CreatingNamesMap::value_type(wstr, nullptr)).second;
+}
+
+/**
+ * @brief Ends a ClaimCreatingName() claim.
+ *
+ * @param name The claimed name.
+ * @param save The new character's save; the name stays held until it has run.
+ */
+void ObjectMgr::ReleaseCreatingName(const std::string& name, std::shared_ptr<SqlCommitStatus> const& save)
+{
+    std::wstring wstr;
+    if (!Utf8toWStr(name, wstr))
+    {
+        return;
+    }
+
+    wstrToLower(wstr);
+
+    std::lock_guard<std::mutex> guard(m_CreatingNamesLock);
+    SweepCreatingNames();
+    if (save && save->Get() == SqlCommitStatus::PENDING)
+    {
+        m_CreatingNames[wstr] = save;
+    }
+    else
+    {
+        m_CreatingNames.erase(wstr);
+    }
+}
+
+/**
+ * @brief Drops the names whose save has run; caller holds m_CreatingNamesLock.
+ *
+ * Once the row is written the name query finds it, and a failed save frees
+ * the name, so only creates in flight and pending saves need to stay.
+ */
+void ObjectMgr::SweepCreatingNames()
+{
+    for (CreatingNamesMap::iterator itr = m_CreatingNames.begin(); itr != m_CreatingNames.end();)
+    {
+        if (itr->second && itr->second->Get() != SqlCommitStatus::PENDING)
+        {
+            m_CreatingNames.erase(itr++);
+        }
+        else
+        {
+            ++itr;
+        }
+    }
+}
+
 enum LanguageType
 {
     LT_BASIC_LATIN    = 0x0000,
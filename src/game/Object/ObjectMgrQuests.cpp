@@ -78,7 +78,7 @@ void ObjectMgr::LoadQuests()
 
     m_ExclusiveQuestGroups.clear();
 
-    QueryResult* result = WorldDatabase.Query(
+    QueryResult* result = WorldDatabase.QuerySnapshot(
         //           0        1         2             3           4             5       6                  7                8                9
             "SELECT `entry`, `Method`, `ZoneOrSort`, `MinLevel`, `QuestLevel`, `Type`, `RequiredClasses`, `RequiredRaces`, `RequiredSkill`, `RequiredSkillValue`,"
         //    10                     11                   12                       13                     14                       15                     16                  17
@@ -113,7 +113,7 @@ void ObjectMgr::LoadQuests()
             "`OfferRewardEmoteDelay1`, `OfferRewardEmoteDelay2`, `OfferRewardEmoteDelay3`, `OfferRewardEmoteDelay4`,"
         //    123            124
             "`StartScript`, `CompleteScript`"
-            " FROM `quest_template`");
+            " FROM `quest_template`", "quest_template");
     if (!result)
     {
         BarGoLink bar(1);
@@ -29,6 +29,7 @@
 #include "Opcodes.h"
 #include "SpellMgr.h"
 #include "World.h"
+#include "PlayerSaveScheduler.h"
 #include "WorldPacket.h"
 #include "WorldSession.h"
 #include "UpdateMask.h"
@@ -462,6 +463,12 @@ Player::Player(WorldSession* session): Unit(), m_mover(this), m_camera(this), m_
     // randomize first save time in range [CONFIG_UINT32_INTERVAL_SAVE] around [CONFIG_UINT32_INTERVAL_SAVE]
     // this must help in case next save after mass player load after server startup
     m_nextSave = urand(m_nextSave / 2, m_nextSave * 3 / 2);
+    m_savedCharacterDigest = 0;
+    m_savedAuraDigest = 0;
+    m_savedStatsDigest = 0;
+    m_pendingCharacterDigest = 0;
+    m_pendingAuraDigest = 0;
+    m_pendingStatsDigest = 0;
 
     clearResurrectRequestData();
 
@@ -1267,7 +1274,12 @@ void Player::Update(uint32 update_diff, uint32 p_time)
     // Handle periodic saving
     if (m_nextSave > 0)
     {
-        if (update_diff >= m_nextSave)
+        if (update_diff >= m_nextSave && sPlayerSaveScheduler.IsEnabled())
+        {
+            // overdue: the save scheduler paces autosaves, keep the timer running for .save
+            m_nextSave = 1;
+        }
+        else if (update_diff >= m_nextSave)
         {
             // m_nextSave reset in SaveToDB call
             // Used by Eluna
@@ -1277,7 +1289,7 @@ void Player::Update(uint32 update_diff, uint32 p_time)
                 e->OnSave(this);
             }
 #endif /* ENABLE_ELUNA */
-            SaveToDB();
+            SaveToDB(!sWorld.getConfig(CONFIG_BOOL_PLAYER_SAVE_DELTA));
             DETAIL_LOG("Player '%s' (GUID: %u) saved", GetName(), GetGUIDLow());
         }
         else
@@ -2052,8 +2052,25 @@ class Player : public Unit
         /***                   SAVE SYSTEM                     ***/
         /*********************************************************/
 
-        // Save the player to the database
-        void SaveToDB();
+        // Save the player to the database; a delta save (autosave) only writes what changed since the last save.
+        // Returns the number of statements queued, 0 when the save is deferred past a far teleport
+        uint32 SaveToDB(bool fullSave = true);
+
+        // Outcome of the last SaveToDB() transaction, NULL before the first save
+        std::shared_ptr<SqlCommitStatus> const& GetSaveCommit() const { return m_saveCommit; }
+
+        // Rough count of changed rows the next save has to write (items, quests, skills, spells, mail)
+        uint32 GetPendingSaveWork() const;
+
+        /// Save volume since startup, split by delta and full saves (see .server info)
+        struct SaveCounters
+        {
+            enum Kind { DELTA, FULL, KIND_COUNT };
+
+            std::atomic<uint64> saves[KIND_COUNT];
+            std::atomic<uint64> statements[KIND_COUNT];
+        };
+        static SaveCounters const& GetSaveCounters() { return s_saveCounters; }
 
         // Save the inventory and gold to the database
         void SaveInventoryAndGoldToDB(); // fast save function for item/money cheating preventing
@@ -2393,7 +2410,7 @@ class Player : public Unit
 
         void _LoadSpellCooldowns(QueryResult* result) { m_spellCooldownMgr.LoadFromDB(result); }
 
-        void _SaveSpellCooldowns() { m_spellCooldownMgr.SaveToDB(); }
+        void _SaveSpellCooldowns(bool fullSave = true) { m_spellCooldownMgr.SaveToDB(fullSave); }
 
         // Set resurrect request data
         void setResurrectRequestData(ObjectGuid guid, uint32 mapId, float X, float Y, float Z, uint32 health, uint32 mana)
@@ -3783,7 +3800,7 @@ class Player : public Unit
         void _SaveActions();
 
         // Save player auras to the database
-        void _SaveAuras();
+        void _SaveAuras(bool fullSave = true);
 
         // Save player inventory to the database
         void _SaveInventory();
@@ -3798,8 +3815,11 @@ class Player : public Unit
         // Save battleground data to the database
         void _SaveBGData();
 
-        // Save player stats to the database
-        void _SaveStats();
+        // Save player stats to the database, returns the statements queued
+        uint32 _SaveStats(bool fullSave = true);
+
+        // Adopt the digests of the previous save if it committed, forget them otherwise
+        void _SettleSaveDigests();
 
         // Set create bits for the update mask
         void _SetCreateBits(UpdateMask* updateMask, Player* target) const override;
@@ -3847,6 +3867,14 @@ class Player : public Unit
 
         Team m_team; // Player's team
         uint32 m_nextSave; // Next save time
+        uint64 m_savedCharacterDigest; // Digest of the `characters` string columns last committed, 0 if unknown
+        uint64 m_savedAuraDigest; // Digest of the auras last committed, 0 if unknown
+        uint64 m_savedStatsDigest; // Digest of the `character_stats` row last committed, 0 if unknown
+        uint64 m_pendingCharacterDigest; // Digests queued by the last save, adopted once m_saveCommit reports it committed
+        uint64 m_pendingAuraDigest;
+        uint64 m_pendingStatsDigest;
+        std::shared_ptr<SqlCommitStatus> m_saveCommit; // Outcome of the last save's transaction, NULL before the first save
+        static SaveCounters s_saveCounters;
         time_t m_speakTime; // Last speak time
         uint32 m_speakCount; // Speak count
 
@@ -98,7 +98,49 @@
 
 #define MAKE_SKILL_BONUS(t, p) MAKE_PAIR32(t,p)
 
-void Player::SaveToDB()
+/**
+ * @brief FNV-1a digest of the values a save would write.
+ *
+ * Delta saves compare it with the digest of the previous save to skip
+ * rewriting rows that did not change. 0 is never produced by real data, so a
+ * digest of 0 means "not saved yet".
+ */
+class SaveDigest
+{
+    public:
+        SaveDigest() : m_hash(UI64LIT(14695981039346656037)) {}
+
+        template<typename T>
+        SaveDigest& operator<<(T value)
+        {
+            Add(&value, sizeof(value));
+            return *this;
+        }
+
+        SaveDigest& operator<<(std::string const& value)
+        {
+            Add(value.data(), value.size());
+            return *this << uint32(value.size());
+        }
+
+        uint64 Get() const { return m_hash ? m_hash : 1; }
+
+    private:
+        void Add(void const* data, size_t size)
+        {
+            uint8 const* bytes = static_cast<uint8 const*>(data);
+            for (size_t i = 0; i < size; ++i)
+            {
+                m_hash = (m_hash ^ bytes[i]) * UI64LIT(1099511628211);
+            }
+        }
+
+        uint64 m_hash;
+};
+
+Player::SaveCounters Player::s_saveCounters;
+
+uint32 Player::SaveToDB(bool fullSave)
 {
     // we should assure this: ASSERT((m_nextSave != sWorld.getConfig(CONFIG_UINT32_INTERVAL_SAVE)));
     // delay auto save at any saves (manual, in code, or autosave)
@@ -108,12 +150,18 @@ void Player::SaveToDB()
     if (IsBeingTeleportedFar())
     {
         ScheduleDelayedOperation(DELAYED_SAVE_PLAYER);
-        return;
+        return 0;
     }
 
     DEBUG_FILTER_LOG(LOG_FILTER_PLAYER_STATS, "The value of player %s at save: ", m_name.c_str());
     outDebugStatsValues();
 
+    // the digests compared below must describe rows that are in the database
+    _SettleSaveDigests();
+
+    // everything queued below (pet save included) keeps its order on this character's async shard
+    Database::ShardKeyScope shardKey(CharacterDatabase, GetGUIDLow());
+
     CharacterDatabase.BeginTransaction();
 
     UpdateHonor();
@@ -129,150 +177,225 @@ void Player::SaveToDB()
     }
 #endif /* ENABLE_ELUNA */
 
-    static SqlStatementID delChar ;
-    static SqlStatementID insChar ;
+    // the string columns are only rewritten when they differ from what the last save wrote
+    std::ostringstream ss;
+    ss << m_taxi;                                           // string with TaxiMaskSize numbers
+    std::string const taxiMask = ss.str();
+    ss.str(std::string());
 
-    SqlStatement stmt = CharacterDatabase.CreateStatement(delChar, "DELETE FROM `characters` WHERE `guid` = ?");
-    stmt.PExecute(GetGUIDLow());
+    std::string const taxiPath = m_taxi.SaveTaxiDestinationsToString();
 
-    SqlStatement uberInsert = CharacterDatabase.CreateStatement(insChar, "INSERT INTO `characters` (`guid`,`account`,`name`,`race`,`class`,`gender`, "
-        "`level`,`xp`,`money`,`playerBytes`,`playerBytes2`,`playerFlags`,"
-        "`map`, `position_x`, `position_y`, `position_z`, `orientation`, "
-        "`taximask`, `online`, `cinematic`, "
-        "`totaltime`, `leveltime`, `rest_bonus`, `logout_time`, `is_logout_resting`, `resettalents_cost`, `resettalents_time`, "
-        "`trans_x`, `trans_y`, `trans_z`, `trans_o`, `transguid`, `extra_flags`, `stable_slots`, `at_login`, `zone`, "
-        "`death_expire_time`, `taxi_path`, "
-        "`honor_highest_rank`, `honor_standing`, `stored_honor_rating`, `stored_dishonorable_kills`, `stored_honorable_kills`, "
-        "`watchedFaction`, `drunk`, `health`, `power1`, `power2`, `power3`, "
-        "`power4`, `power5`, `exploredZones`, `equipmentCache`, `ammoId`, `actionBars`, `createdDate`) "
-        "VALUES ( ?, ?, ?, ?, ?, ?, "
-        "?, ?, ?, ?, ?, ?, "
-        "?, ?, ?, ?, ?, "
-        "?, ?, ?, "
-        "?, ?, ?, ?, ?, ?, ?, "
-        "?, ?, ?, ?, ?, ?, ?, ?, ?, "
-        "?, ?, "
-        "?, ?, ?, ?, ?, "
-        "?, ?, ?, ?, ?, ?, "
-        "?, ?, ?, ?, ?, ?, ?) ");
-
-    uberInsert.addUInt32(GetGUIDLow());
-    uberInsert.addUInt32(GetSession()->GetAccountId());
-    uberInsert.addString(m_name.c_str());
-    uberInsert.addUInt8(getRace());
-    uberInsert.addUInt8(getClass());
-    uberInsert.addUInt8(getGender());
-    uberInsert.addUInt32(getLevel());
-    uberInsert.addUInt32(GetUInt32Value(PLAYER_XP));
-    uberInsert.addUInt32(GetMoney());
-    uberInsert.addUInt32(GetUInt32Value(PLAYER_BYTES));
-    uberInsert.addUInt32(GetUInt32Value(PLAYER_BYTES_2));
-    uberInsert.addUInt32(GetUInt32Value(PLAYER_FLAGS));
-
-    if (!IsBeingTeleported())
-    {
-        uberInsert.addUInt32(GetMapId());
-        uberInsert.addFloat(finiteAlways(GetPositionX()));
-        uberInsert.addFloat(finiteAlways(GetPositionY()));
-        uberInsert.addFloat(finiteAlways(GetPositionZ()));
-        uberInsert.addFloat(finiteAlways(GetOrientation()));
+    for (uint32 i = 0; i < PLAYER_EXPLORED_ZONES_SIZE; ++i)
+    {
+        ss << GetUInt32Value(PLAYER_EXPLORED_ZONES_1 + i) << " ";
     }
-    else
+    std::string const exploredZones = ss.str();
+    ss.str(std::string());
+
+    for (uint32 i = 0; i < EQUIPMENT_SLOT_END; ++i)         // string: item id, ench (perm/temp)
     {
-        uberInsert.addUInt32(GetTeleportDest().mapid);
-        uberInsert.addFloat(finiteAlways(GetTeleportDest().coord_x));
-        uberInsert.addFloat(finiteAlways(GetTeleportDest().coord_y));
-        uberInsert.addFloat(finiteAlways(GetTeleportDest().coord_z));
-        uberInsert.addFloat(finiteAlways(GetTeleportDest().orientation));
+        ss << GetUInt32Value(PLAYER_VISIBLE_ITEM_1_0 + i * MAX_VISIBLE_ITEM_OFFSET) << " ";
+
+        uint32 ench1 = GetUInt32Value(PLAYER_VISIBLE_ITEM_1_0 + i * MAX_VISIBLE_ITEM_OFFSET + 1 + PERM_ENCHANTMENT_SLOT);
+        uint32 ench2 = GetUInt32Value(PLAYER_VISIBLE_ITEM_1_0 + i * MAX_VISIBLE_ITEM_OFFSET + 1 + TEMP_ENCHANTMENT_SLOT);
+        ss << uint32(MAKE_PAIR32(ench1, ench2)) << " ";
     }
+    std::string const equipmentCache = ss.str();
+    ss.str(std::string());
 
-    std::ostringstream ss;
-    ss << m_taxi;                                   // string with TaxiMaskSize numbers
-    uberInsert.addString(ss);
+    SaveDigest blobDigest;
+    blobDigest << taxiMask << taxiPath << exploredZones << equipmentCache;
 
-    uberInsert.addUInt32(IsInWorld() ? 1 : 0);
+    // Binds the `characters` columns in table order; the full save binds every
+    // column for its INSERT, the delta save only the ones that can change in game
+    // for its UPDATE (the string columns go in a statement of their own).
+    auto bindCharacter = [&](SqlStatement& stmt, bool insert)
+    {
+        if (insert)
+        {
+            stmt.addUInt32(GetGUIDLow());
+            stmt.addUInt32(GetSession()->GetAccountId());
+        }
+        stmt.addString(m_name.c_str());
+        if (insert)
+        {
+            stmt.addUInt8(getRace());
+            stmt.addUInt8(getClass());
+        }
+        stmt.addUInt8(getGender());
+        stmt.addUInt32(getLevel());
+        stmt.addUInt32(GetUInt32Value(PLAYER_XP));
+        stmt.addUInt32(GetMoney());
+        stmt.addUInt32(GetUInt32Value(PLAYER_BYTES));
+        stmt.addUInt32(GetUInt32Value(PLAYER_BYTES_2));
+        stmt.addUInt32(GetUInt32Value(PLAYER_FLAGS));
+
+        if (!IsBeingTeleported())
+        {
+            stmt.addUInt32(GetMapId());
+            stmt.addFloat(finiteAlways(GetPositionX()));
+            stmt.addFloat(finiteAlways(GetPositionY()));
+            stmt.addFloat(finiteAlways(GetPositionZ()));
+            stmt.addFloat(finiteAlways(GetOrientation()));
+        }
+        else
+        {
+            stmt.addUInt32(GetTeleportDest().mapid);
+            stmt.addFloat(finiteAlways(GetTeleportDest().coord_x));
+            stmt.addFloat(finiteAlways(GetTeleportDest().coord_y));
+            stmt.addFloat(finiteAlways(GetTeleportDest().coord_z));
+            stmt.addFloat(finiteAlways(GetTeleportDest().orientation));
+        }
 
-    uberInsert.addUInt32(m_cinematic);
+        if (insert)
+        {
+            stmt.addString(taxiMask);
+        }
 
-    uberInsert.addUInt32(m_Played_time[PLAYED_TIME_TOTAL]);
-    uberInsert.addUInt32(m_Played_time[PLAYED_TIME_LEVEL]);
+        stmt.addUInt32(IsInWorld() ? 1 : 0);
 
-    uberInsert.addFloat(finiteAlways(m_rest_bonus));
-    uberInsert.addUInt64(uint64(time(NULL)));
-    uberInsert.addUInt32(HasFlag(PLAYER_FLAGS, PLAYER_FLAGS_RESTING) ? 1 : 0);
-    // save, far from tavern/city
-    // save, but in tavern/city
-    uberInsert.addUInt32(m_resetTalentsCost);
-    uberInsert.addUInt64(uint64(m_resetTalentsTime));
+        stmt.addUInt32(m_cinematic);
 
-    Position const* transportPosition = m_movementInfo.GetTransportPos();
-    uberInsert.addFloat(finiteAlways(transportPosition->x));
-    uberInsert.addFloat(finiteAlways(transportPosition->y));
-    uberInsert.addFloat(finiteAlways(transportPosition->z));
-    uberInsert.addFloat(finiteAlways(transportPosition->o));
+        stmt.addUInt32(m_Played_time[PLAYED_TIME_TOTAL]);
+        stmt.addUInt32(m_Played_time[PLAYED_TIME_LEVEL]);
 
-    if (m_transport)
-    {
-        uberInsert.addUInt32(m_transport->GetGUIDLow());
-    }
-    else
-    {
-        uberInsert.addUInt32(0);
-    }
+        stmt.addFloat(finiteAlways(m_rest_bonus));
+        stmt.addUInt64(uint64(time(NULL)));
+        stmt.addUInt32(HasFlag(PLAYER_FLAGS, PLAYER_FLAGS_RESTING) ? 1 : 0);
+        // save, far from tavern/city
+        // save, but in tavern/city
+        stmt.addUInt32(m_resetTalentsCost);
+        stmt.addUInt64(uint64(m_resetTalentsTime));
 
-    uberInsert.addUInt32(m_ExtraFlags);
+        Position const* transportPosition = m_movementInfo.GetTransportPos();
+        stmt.addFloat(finiteAlways(transportPosition->x));
+        stmt.addFloat(finiteAlways(transportPosition->y));
+        stmt.addFloat(finiteAlways(transportPosition->z));
+        stmt.addFloat(finiteAlways(transportPosition->o));
 
-    uberInsert.addUInt32(uint32(GetStableSlots()));         // to prevent save uint8 as char
+        if (m_transport)
+        {
+            stmt.addUInt32(m_transport->GetGUIDLow());
+        }
+        else
+        {
+            stmt.addUInt32(0);
+        }
 
-    uberInsert.addUInt32(uint32(m_atLoginFlags));
+        stmt.addUInt32(m_ExtraFlags);
 
-    uberInsert.addUInt32(IsInWorld() ? GetZoneId() : GetCachedZoneId());
+        stmt.addUInt32(uint32(GetStableSlots()));           // to prevent save uint8 as char
 
-    uberInsert.addUInt64(uint64(m_deathExpireTime));
+        stmt.addUInt32(uint32(m_atLoginFlags));
 
-    ss << m_taxi.SaveTaxiDestinationsToString();       // string
-    uberInsert.addString(ss);
+        stmt.addUInt32(IsInWorld() ? GetZoneId() : GetCachedZoneId());
 
-    uberInsert.addUInt32(uint32(m_highest_rank.rank));
-    uberInsert.addInt32(m_standing_pos);
-    uberInsert.addFloat(finiteAlways(m_stored_honor));
-    uberInsert.addUInt32(m_stored_dishonorableKills);
-    uberInsert.addUInt32(m_stored_honorableKills);
+        stmt.addUInt64(uint64(m_deathExpireTime));
 
-    // FIXME: at this moment send to DB as unsigned, including unit32(-1)
-    uberInsert.addUInt32(GetUInt32Value(PLAYER_FIELD_WATCHED_FACTION_INDEX));
+        if (insert)
+        {
+            stmt.addString(taxiPath);
+        }
 
-    uberInsert.addUInt16(uint16(GetUInt32Value(PLAYER_BYTES_3) & 0xFFFE));   // DrunkState
+        stmt.addUInt32(uint32(m_highest_rank.rank));
+        stmt.addInt32(m_standing_pos);
+        stmt.addFloat(finiteAlways(m_stored_honor));
+        stmt.addUInt32(m_stored_dishonorableKills);
+        stmt.addUInt32(m_stored_honorableKills);
 
-    uberInsert.addUInt32(GetHealth());
+        // FIXME: at this moment send to DB as unsigned, including unit32(-1)
+        stmt.addUInt32(GetUInt32Value(PLAYER_FIELD_WATCHED_FACTION_INDEX));
 
-    for (uint32 i = 0; i < MAX_POWERS; ++i) // power1 to power5
-    {
-        uberInsert.addUInt32(GetPower(Powers(i)));
-    }
+        stmt.addUInt16(uint16(GetUInt32Value(PLAYER_BYTES_3) & 0xFFFE));   // DrunkState
 
-    for (uint32 i = 0; i < PLAYER_EXPLORED_ZONES_SIZE; ++i) // string
-    {
-        ss << GetUInt32Value(PLAYER_EXPLORED_ZONES_1 + i) << " ";
-    }
-    uberInsert.addString(ss); // exploredZOnes
+        stmt.addUInt32(GetHealth());
 
-    for (uint32 i = 0; i < EQUIPMENT_SLOT_END; ++i)         // string: item id, ench (perm/temp)
-    {
-        ss << GetUInt32Value(PLAYER_VISIBLE_ITEM_1_0 + i * MAX_VISIBLE_ITEM_OFFSET) << " ";
+        for (uint32 i = 0; i < MAX_POWERS; ++i)             // power1 to power5
+        {
+            stmt.addUInt32(GetPower(Powers(i)));
+        }
 
-        uint32 ench1 = GetUInt32Value(PLAYER_VISIBLE_ITEM_1_0 + i * MAX_VISIBLE_ITEM_OFFSET + 1 + PERM_ENCHANTMENT_SLOT);
-        uint32 ench2 = GetUInt32Value(PLAYER_VISIBLE_ITEM_1_0 + i * MAX_VISIBLE_ITEM_OFFSET + 1 + TEMP_ENCHANTMENT_SLOT);
-        ss << uint32(MAKE_PAIR32(ench1, ench2)) << " ";
-    }
-    uberInsert.addString(ss); // EquipmentCache
+        if (insert)
+        {
+            stmt.addString(exploredZones);
+            stmt.addString(equipmentCache);
+        }
 
-    uberInsert.addUInt32(GetUInt32Value(PLAYER_AMMO_ID));
+        stmt.addUInt32(GetUInt32Value(PLAYER_AMMO_ID));
 
-    uberInsert.addUInt32(uint32(GetByteValue(PLAYER_FIELD_BYTES, 2))); // actionbars
-    uberInsert.addUInt32(GetCreatedDate());
+        stmt.addUInt32(uint32(GetByteValue(PLAYER_FIELD_BYTES, 2))); // actionbars
+        if (insert)
+        {
+            stmt.addUInt32(GetCreatedDate());
+        }
+    };
+
+    if (fullSave)
+    {
+        static SqlStatementID delChar ;
+        static SqlStatementID insChar ;
+
+        SqlStatement stmt = CharacterDatabase.CreateStatement(delChar, "DELETE FROM `characters` WHERE `guid` = ?");
+        stmt.PExecute(GetGUIDLow());
+
+        SqlStatement uberInsert = CharacterDatabase.CreateStatement(insChar, "INSERT INTO `characters` (`guid`,`account`,`name`,`race`,`class`,`gender`, "
+            "`level`,`xp`,`money`,`playerBytes`,`playerBytes2`,`playerFlags`,"
+            "`map`, `position_x`, `position_y`, `position_z`, `orientation`, "
+            "`taximask`, `online`, `cinematic`, "
+            "`totaltime`, `leveltime`, `rest_bonus`, `logout_time`, `is_logout_resting`, `resettalents_cost`, `resettalents_time`, "
+            "`trans_x`, `trans_y`, `trans_z`, `trans_o`, `transguid`, `extra_flags`, `stable_slots`, `at_login`, `zone`, "
+            "`death_expire_time`, `taxi_path`, "
+            "`honor_highest_rank`, `honor_standing`, `stored_honor_rating`, `stored_dishonorable_kills`, `stored_honorable_kills`, "
+            "`watchedFaction`, `drunk`, `health`, `power1`, `power2`, `power3`, "
+            "`power4`, `power5`, `exploredZones`, `equipmentCache`, `ammoId`, `actionBars`, `createdDate`) "
+            "VALUES ( ?, ?, ?, ?, ?, ?, "
+            "?, ?, ?, ?, ?, ?, "
+            "?, ?, ?, ?, ?, "
+            "?, ?, ?, "
+            "?, ?, ?, ?, ?, ?, ?, "
+            "?, ?, ?, ?, ?, ?, ?, ?, ?, "
+            "?, ?, "
+            "?, ?, ?, ?, ?, "
+            "?, ?, ?, ?, ?, ?, "
+            "?, ?, ?, ?, ?, ?, ?) ");
+
+        bindCharacter(uberInsert, true);
+        uberInsert.Execute();
+    }
+    else
+    {
+        static SqlStatementID updChar ;
+        static SqlStatementID updCharStrings ;
+
+        SqlStatement stmt = CharacterDatabase.CreateStatement(updChar, "UPDATE `characters` SET `name` = ?, `gender` = ?, "
+            "`level` = ?, `xp` = ?, `money` = ?, `playerBytes` = ?, `playerBytes2` = ?, `playerFlags` = ?, "
+            "`map` = ?, `position_x` = ?, `position_y` = ?, `position_z` = ?, `orientation` = ?, "
+            "`online` = ?, `cinematic` = ?, "
+            "`totaltime` = ?, `leveltime` = ?, `rest_bonus` = ?, `logout_time` = ?, `is_logout_resting` = ?, `resettalents_cost` = ?, `resettalents_time` = ?, "
+            "`trans_x` = ?, `trans_y` = ?, `trans_z` = ?, `trans_o` = ?, `transguid` = ?, `extra_flags` = ?, `stable_slots` = ?, `at_login` = ?, `zone` = ?, "
+            "`death_expire_time` = ?, "
+            "`honor_highest_rank` = ?, `honor_standing` = ?, `stored_honor_rating` = ?, `stored_dishonorable_kills` = ?, `stored_honorable_kills` = ?, "
+            "`watchedFaction` = ?, `drunk` = ?, `health` = ?, `power1` = ?, `power2` = ?, `power3` = ?, "
+            "`power4` = ?, `power5` = ?, `ammoId` = ?, `actionBars` = ? "
+            "WHERE `guid` = ?");
+
+        bindCharacter(stmt, false);
+        stmt.addUInt32(GetGUIDLow());
+        stmt.Execute();
 
-    uberInsert.Execute();
+        if (blobDigest.Get() != m_savedCharacterDigest)
+        {
+            stmt = CharacterDatabase.CreateStatement(updCharStrings, "UPDATE `characters` SET `taximask` = ?, `taxi_path` = ?, "
+                "`exploredZones` = ?, `equipmentCache` = ? WHERE `guid` = ?");
+            stmt.addString(taxiMask);
+            stmt.addString(taxiPath);
+            stmt.addString(exploredZones);
+            stmt.addString(equipmentCache);
+            stmt.addUInt32(GetGUIDLow());
+            stmt.Execute();
+        }
+    }
+    m_pendingCharacterDigest = blobDigest.Get();
 
     if (m_mailsUpdated)                                     // save mails only when needed
     {
@@ -283,28 +406,109 @@ void Player::SaveToDB()
     _SaveInventory();
     _SaveQuestStatus();
     _SaveSpells();
-    _SaveSpellCooldowns();
+    _SaveSpellCooldowns(fullSave);
     _SaveActions();
-    _SaveAuras();
+    _SaveAuras(fullSave);
     _SaveSkills();
     m_reputationMgr.SaveToDB();
     _SaveHonorCP();
     GetSession()->SaveTutorialsData();                      // changed only while character in game
 
-    CharacterDatabase.CommitTransaction();
-
     // check if stats should only be saved on logout
-    // save stats can be out of transaction
+    // stats share the transaction so one commit status covers every digest
     if (m_session->isLogingOut() || !sWorld.getConfig(CONFIG_BOOL_STATS_SAVE_ONLY_ON_LOGOUT))
     {
-        _SaveStats();
+        _SaveStats(fullSave);
     }
 
+    uint32 statements = uint32(CharacterDatabase.GetTransactionSize());
+    m_saveCommit = std::make_shared<SqlCommitStatus>();
+    CharacterDatabase.CommitTransaction(m_saveCommit);
+
+    SaveCounters::Kind const kind = fullSave ? SaveCounters::FULL : SaveCounters::DELTA;
+    ++s_saveCounters.saves[kind];
+    s_saveCounters.statements[kind] += statements;
+    DEBUG_LOG("Player '%s' (GUID: %u) %s save: %u statements", GetName(), GetGUIDLow(), fullSave ? "full" : "delta", statements);
+
     // save pet (hunter pet level and experience and all type pets health/mana).
     if (Pet* pet = GetPet())
     {
         pet->SavePetToDB(PET_SAVE_AS_CURRENT);
     }
+
+    return statements;
+}
+
+/**
+ * @brief Settles the digests queued by the previous SaveToDB().
+ *
+ * They become the saved digests only once that save's transaction has
+ * committed. A save that failed or is still queued leaves the rows unknown,
+ * so the saved digests are cleared and the next save rewrites everything it
+ * would otherwise skip; being on the same shard, it lands after the queued one.
+ */
+void Player::_SettleSaveDigests()
+{
+    if (!m_saveCommit)
+    {
+        return;
+    }
+
+    if (m_saveCommit->Get() == SqlCommitStatus::COMMITTED)
+    {
+        m_savedCharacterDigest = m_pendingCharacterDigest;
+        m_savedAuraDigest = m_pendingAuraDigest;
+        m_savedStatsDigest = m_pendingStatsDigest;
+    }
+    else
+    {
+        m_savedCharacterDigest = 0;
+        m_savedAuraDigest = 0;
+        m_savedStatsDigest = 0;
+        m_spellCooldownMgr.MarkChanged();
+    }
+
+    // a part this save skips carries its last committed digest forward
+    m_pendingCharacterDigest = m_savedCharacterDigest;
+    m_pendingAuraDigest = m_savedAuraDigest;
+    m_pendingStatsDigest = m_savedStatsDigest;
+    m_saveCommit.reset();
+}
+
+uint32 Player::GetPendingSaveWork() const
+{
+    uint32 work = uint32(m_itemUpdateQueue.size());
+
+    for (QuestStatusMap::const_iterator itr = mQuestStatus.begin(); itr != mQuestStatus.end(); ++itr)
+    {
+        if (itr->second.uState != QUEST_UNCHANGED)
+        {
+            ++work;
+        }
+    }
+
+    for (SkillStatusMap::const_iterator itr = mSkillStatus.begin(); itr != mSkillStatus.end(); ++itr)
+    {
+        if (itr->second.uState != SKILL_UNCHANGED)
+        {
+            ++work;
+        }
+    }
+
+    for (PlayerSpellMap::const_iterator itr = m_spells.begin(); itr != m_spells.end(); ++itr)
+    {
+        if (itr->second.state != PLAYERSPELL_UNCHANGED)
+        {
+            ++work;
+        }
+    }
+
+    if (m_mailsUpdated)
+    {
+        ++work;
+    }
+
+    return work;
 }
 
 // fast save function for item/money cheating preventing - save only inventory and money state
@@ -380,26 +584,31 @@ void Player::_SaveActions()
 
 /**
  * @brief Saves eligible active aura state to the database.
+ *
+ * A delta save skips the rewrite while the set of saved auras (spell, caster,
+ * stacks, charges, amounts) is unchanged. Remaining durations count in whole
+ * minutes, so a timed aura is rewritten by any autosave a minute or more after
+ * the last one and comes back at most that much long after a crash.
+ *
+ * @param fullSave False to skip the rewrite when nothing changed.
  */
-void Player::_SaveAuras()
+void Player::_SaveAuras(bool fullSave)
 {
     static SqlStatementID deleteAuras ;
     static SqlStatementID insertAuras ;
 
-    SqlStatement stmt = CharacterDatabase.CreateStatement(deleteAuras, "DELETE FROM `character_aura` WHERE `guid` = ?");
-    stmt.PExecute(GetGUIDLow());
-
-    SpellAuraHolderMap const& auraHolders = GetSpellAuraHolderMap();
-
-    if (auraHolders.empty())
+    struct SavedAura
     {
-        return;
-    }
+        SpellAuraHolder const* holder;
+        int32 damage[MAX_EFFECT_INDEX];
+        uint32 periodicTime[MAX_EFFECT_INDEX];
+        uint32 effIndexMask;
+    };
 
-    stmt = CharacterDatabase.CreateStatement(insertAuras, "INSERT INTO `character_aura` (`guid`, `caster_guid`, `item_guid`, `spell`, `stackcount`, `remaincharges`, "
-        "`basepoints0`, `basepoints1`, `basepoints2`, `periodictime0`, `periodictime1`, `periodictime2`, `maxduration`, `remaintime`, `effIndexMask`) "
-        "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)");
+    std::vector<SavedAura> saved;
+    SaveDigest digest;
 
+    SpellAuraHolderMap const& auraHolders = GetSpellAuraHolderMap();
     for (SpellAuraHolderMap::const_iterator itr = auraHolders.begin(); itr != auraHolders.end(); ++itr)
     {
         SpellAuraHolder* holder = itr->second;
@@ -407,59 +616,93 @@ void Player::_SaveAuras()
         // save singleTarget auras if self cast.
         bool selfCastHolder = holder->GetCasterGuid() == GetObjectGuid();
         TrackedAuraType trackedType = holder->GetTrackedAuraType();
-        if (!holder->IsPassive() && !IsChanneledSpell(holder->GetSpellProto()) &&
-            (trackedType == TRACK_AURA_TYPE_NOT_TRACKED || (trackedType == TRACK_AURA_TYPE_SINGLE_TARGET && selfCastHolder)))
+        if (holder->IsPassive() || IsChanneledSpell(holder->GetSpellProto()) ||
+            (trackedType != TRACK_AURA_TYPE_NOT_TRACKED && (trackedType != TRACK_AURA_TYPE_SINGLE_TARGET || !selfCastHolder)))
         {
-            int32  damage[MAX_EFFECT_INDEX];
-            uint32 periodicTime[MAX_EFFECT_INDEX];
-            uint32 effIndexMask = 0;
+            continue;
+        }
 
-            for (uint32 i = 0; i < MAX_EFFECT_INDEX; ++i)
-            {
-                damage[i] = 0;
-                periodicTime[i] = 0;
+        SavedAura aura;
+        aura.holder = holder;
+        aura.effIndexMask = 0;
 
-                if (Aura* aur = holder->GetAuraByEffectIndex(SpellEffectIndex(i)))
+        for (uint32 i = 0; i < MAX_EFFECT_INDEX; ++i)
+        {
+            aura.damage[i] = 0;
+            aura.periodicTime[i] = 0;
+
+            if (Aura* aur = holder->GetAuraByEffectIndex(SpellEffectIndex(i)))
+            {
+                // don't save not own area auras
+                if (aur->IsAreaAura() && holder->GetCasterGuid() != GetObjectGuid())
                 {
-                    // don't save not own area auras
-                    if (aur->IsAreaAura() && holder->GetCasterGuid() != GetObjectGuid())
-                    {
-                        continue;
-                    }
-
-                    damage[i] = aur->GetModifier()->m_amount;
-                    periodicTime[i] = aur->GetModifier()->periodictime;
-                    effIndexMask |= (1 << i);
+                    continue;
                 }
-            }
 
-            if (!effIndexMask)
-            {
-                continue;
+                aura.damage[i] = aur->GetModifier()->m_amount;
+                aura.periodicTime[i] = aur->GetModifier()->periodictime;
+                aura.effIndexMask |= (1 << i);
             }
+        }
 
-            stmt.addUInt32(GetGUIDLow());
-            stmt.addUInt64(holder->GetCasterGuid().GetRawValue());
-            stmt.addUInt32(holder->GetCastItemGuid().GetCounter());
-            stmt.addUInt32(holder->GetId());
-            stmt.addUInt32(holder->GetStackAmount());
-            stmt.addUInt8(holder->GetAuraCharges());
+        if (!aura.effIndexMask)
+        {
+            continue;
+        }
 
-            for (uint32 i = 0; i < MAX_EFFECT_INDEX; ++i)
-            {
-                stmt.addInt32(damage[i]);
-            }
+        digest << holder->GetId() << holder->GetCasterGuid().GetRawValue() << holder->GetCastItemGuid().GetCounter()
+               << holder->GetStackAmount() << holder->GetAuraCharges() << holder->GetAuraMaxDuration() << aura.effIndexMask
+               << holder->GetAuraDuration() / int32(MINUTE * IN_MILLISECONDS);
+        for (uint32 i = 0; i < MAX_EFFECT_INDEX; ++i)
+        {
+            digest << aura.damage[i] << aura.periodicTime[i];
+        }
+        saved.push_back(aura);
+    }
 
-            for (uint32 i = 0; i < MAX_EFFECT_INDEX; ++i)
-            {
-                stmt.addUInt32(periodicTime[i]);
-            }
+    m_pendingAuraDigest = digest.Get();
+    if (!fullSave && m_pendingAuraDigest == m_savedAuraDigest)
+    {
+        return;
+    }
 
-            stmt.addInt32(holder->GetAuraMaxDuration());
-            stmt.addInt32(holder->GetAuraDuration());
-            stmt.addUInt32(effIndexMask);
-            stmt.Execute();
+    SqlStatement stmt = CharacterDatabase.CreateStatement(deleteAuras, "DELETE FROM `character_aura` WHERE `guid` = ?");
+    stmt.PExecute(GetGUIDLow());
+
+    if (saved.empty())
+    {
+        return;
+    }
+
+    stmt = CharacterDatabase.CreateStatement(insertAuras, "INSERT INTO `character_aura` (`guid`, `caster_guid`, `item_guid`, `spell`, `stackcount`, `remaincharges`, "
+        "`basepoints0`, `basepoints1`, `basepoints2`, `periodictime0`, `periodictime1`, `periodictime2`, `maxduration`, `remaintime`, `effIndexMask`) "
+        "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)");
+
+    for (std::vector<SavedAura>::const_iterator itr = saved.begin(); itr != saved.end(); ++itr)
+    {
+        SpellAuraHolder const* holder = itr->holder;
+
+        stmt.addUInt32(GetGUIDLow());
+        stmt.addUInt64(holder->GetCasterGuid().GetRawValue());
+        stmt.addUInt32(holder->GetCastItemGuid().GetCounter());
+        stmt.addUInt32(holder->GetId());
+        stmt.addUInt32(holder->GetStackAmount());
+        stmt.addUInt8(holder->GetAuraCharges());
+
+        for (uint32 i = 0; i < MAX_EFFECT_INDEX; ++i)
+        {
+            stmt.addInt32(itr->damage[i]);
         }
+
+        for (uint32 i = 0; i < MAX_EFFECT_INDEX; ++i)
+        {
+            stmt.addUInt32(itr->periodicTime[i]);
+        }
+
+        stmt.addInt32(holder->GetAuraMaxDuration());
+        stmt.addInt32(holder->GetAuraDuration());
+        stmt.addUInt32(itr->effIndexMask);
+        stmt.Execute();
     }
 }
 
@@ -747,12 +990,45 @@ void Player::_SaveSpells()
 
 // save player stats -- only for external usage
 // real stats will be recalculated on player login
-void Player::_SaveStats()
+uint32 Player::_SaveStats(bool fullSave)
 {
     // check if stat saving is enabled and if char level is high enough
     if (!sWorld.getConfig(CONFIG_UINT32_MIN_LEVEL_STAT_SAVE) || getLevel() < sWorld.getConfig(CONFIG_UINT32_MIN_LEVEL_STAT_SAVE))
     {
-        return;
+        return 0;
+    }
+
+    uint32 maxPower[MAX_POWERS];
+    float stat[MAX_STATS];
+    uint32 resistance[MAX_SPELL_SCHOOL];
+
+    SaveDigest digest;
+    digest << GetMaxHealth();
+    for (int i = 0; i < MAX_POWERS; ++i)
+    {
+        maxPower[i] = GetMaxPower(Powers(i));
+        digest << maxPower[i];
+    }
+    for (int i = 0; i < MAX_STATS; ++i)
+    {
+        stat[i] = GetStat(Stats(i));
+        digest << stat[i];
+    }
+    // armor + school resistances
+    for (int i = 0; i < MAX_SPELL_SCHOOL; ++i)
+    {
+        resistance[i] = GetResistance(SpellSchools(i));
+        digest << resistance[i];
+    }
+    digest << GetFloatValue(PLAYER_BLOCK_PERCENTAGE) << GetFloatValue(PLAYER_DODGE_PERCENTAGE)
+           << GetFloatValue(PLAYER_PARRY_PERCENTAGE) << GetFloatValue(PLAYER_CRIT_PERCENTAGE)
+           << GetFloatValue(PLAYER_RANGED_CRIT_PERCENTAGE)
+           << GetUInt32Value(UNIT_FIELD_ATTACK_POWER) << GetUInt32Value(UNIT_FIELD_RANGED_ATTACK_POWER);
+
+    m_pendingStatsDigest = digest.Get();
+    if (!fullSave && m_pendingStatsDigest == m_savedStatsDigest)
+    {
+        return 0;
     }
 
     static SqlStatementID delStats ;
@@ -770,16 +1046,15 @@ void Player::_SaveStats()
     stmt.addUInt32(GetMaxHealth());
     for (int i = 0; i < MAX_POWERS; ++i)
     {
-        stmt.addUInt32(GetMaxPower(Powers(i)));
+        stmt.addUInt32(maxPower[i]);
     }
     for (int i = 0; i < MAX_STATS; ++i)
     {
-        stmt.addFloat(GetStat(Stats(i)));
+        stmt.addFloat(stat[i]);
     }
-    // armor + school resistances
     for (int i = 0; i < MAX_SPELL_SCHOOL; ++i)
     {
-        stmt.addUInt32(GetResistance(SpellSchools(i)));
+        stmt.addUInt32(resistance[i]);
     }
     stmt.addFloat(GetFloatValue(PLAYER_BLOCK_PERCENTAGE));
     stmt.addFloat(GetFloatValue(PLAYER_DODGE_PERCENTAGE));
@@ -790,6 +1065,7 @@ void Player::_SaveStats()
     stmt.addUInt32(GetUInt32Value(UNIT_FIELD_RANGED_ATTACK_POWER));
 
     stmt.Execute();
+    return 2;
 }
 
 /**
@@ -155,6 +155,7 @@ void SpellCooldownMgr::AddSpellCooldown(uint32 spellid, uint32 itemid, time_t en
     sc.end = end_time;
     sc.itemid = itemid;
     m_cooldowns[spellid] = sc;
+    m_changed = true;
 }
 
 void SpellCooldownMgr::SendCooldownEvent(SpellEntry const* spellInfo, uint32 itemId, Spell* spell)
@@ -171,7 +172,10 @@ void SpellCooldownMgr::SendCooldownEvent(SpellEntry const* spellInfo, uint32 ite
 
 void SpellCooldownMgr::RemoveSpellCooldown(uint32 spell_id, bool update /* = false */)
 {
-    m_cooldowns.erase(spell_id);
+    if (m_cooldowns.erase(spell_id))
+    {
+        m_changed = true;
+    }
 
     if (update)
     {
@@ -211,6 +215,7 @@ void SpellCooldownMgr::RemoveAllSpellCooldown()
         }
 
         m_cooldowns.clear();
+        m_changed = true;
     }
 }
 
@@ -254,11 +259,18 @@ void SpellCooldownMgr::LoadFromDB(QueryResult* result)
     }
 }
 
-void SpellCooldownMgr::SaveToDB()
+void SpellCooldownMgr::SaveToDB(bool fullSave)
 {
     static SqlStatementID deleteSpellCooldown ;
     static SqlStatementID insertSpellCooldown ;
 
+    // expired rows left behind are harmless, LoadFromDB() skips outdated cooldowns
+    if (!fullSave && !m_changed)
+    {
+        return;
+    }
+    m_changed = false;
+
     SqlStatement stmt = CharacterDatabase.CreateStatement(deleteSpellCooldown, "DELETE FROM `character_spell_cooldown` WHERE `guid` = ?");
     stmt.PExecute(m_owner->GetGUIDLow());
 
@@ -53,7 +53,7 @@ typedef std::map<uint32, SpellCooldown> SpellCooldowns;
 class SpellCooldownMgr
 {
     public:
-        explicit SpellCooldownMgr(Player* owner) : m_owner(owner) {}
+        explicit SpellCooldownMgr(Player* owner) : m_owner(owner), m_changed(true) {}
 
         SpellCooldowns const& GetSpellCooldownMap() const { return m_cooldowns; }
 
@@ -77,11 +77,15 @@ class SpellCooldownMgr
         void RemoveSpellCategoryCooldown(uint32 cat, bool update = false);
         void RemoveAllSpellCooldown();
         void LoadFromDB(QueryResult* result);
-        void SaveToDB();
+        /// @param fullSave false skips the rewrite when no cooldown was added or removed since the last save
+        void SaveToDB(bool fullSave = true);
+        /// Forces the next delta save to rewrite the rows, e.g. after a save that did not commit.
+        void MarkChanged() { m_changed = true; }
 
     private:
         Player* m_owner;            ///< Non-owning pointer to the owning Player.
         SpellCooldowns m_cooldowns; ///< Active spell cooldowns keyed by spell id.
+        bool m_changed;             ///< m_cooldowns differs from the saved rows (expiry aside).
 };
 
 #endif // MANGOS_H_SPELLCOOLDOWNMGR
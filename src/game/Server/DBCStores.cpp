@@ -27,10 +27,16 @@
 #include "Log.h"
 #include "ProgressBar.h"
 #include "SharedDefines.h"
+#include "Threading/TaskGraph.h"
+#include "Timer.h"
+#include "Util.h"
 
 #include "DBCfmt.h"
 
+#include <algorithm>
+#include <atomic>
 #include <map>
+#include <mutex>
 
 typedef std::map<uint32, uint32> AreaIDByAreaFlag;
 typedef std::map<uint32, uint32> AreaFlagByMapID;
@@ -200,20 +206,31 @@ static bool LoadDBC_assert_print(uint32 fsize, uint32 rsize, const std::string&
     return false;
 }
 
+/**
+ * @brief What the DBC loads running side by side share.
+ */
+struct DBCLoadState
+{
+    explicit DBCLoadState(BarGoLink& progress) : availableLocales(0xFFFFFFFF), bar(progress) {}
+
+    std::atomic<uint32> availableLocales;                   ///< bitmask for index of fullLocaleNameList
+    std::mutex lock;                                        ///< guards bar and errors
+    BarGoLink& bar;
+    StoreProblemList errors;                                ///< missing or incompatible files
+};
+
 template<class T>
 
 /**
  * @brief Loads a DBC file and its localized string tables.
  *
  * @tparam T The DBC record type.
- * @param availableDbcLocales Bitmask of still-available locales.
- * @param bar The startup progress indicator.
- * @param errlist The list collecting missing or incompatible files.
+ * @param state The progress, error list and locale mask shared by all loads.
  * @param storage The storage receiving loaded records.
  * @param dbc_path The base DBC directory.
  * @param filename The DBC filename to load.
  */
-inline void LoadDBC(uint32& availableDbcLocales, BarGoLink& bar, StoreProblemList& errlist, DBCStorage<T>& storage, const std::string& dbc_path, const std::string& filename)
+inline void LoadDBC(DBCLoadState& state, DBCStorage<T>& storage, const std::string& dbc_path, const std::string& filename)
 {
     // compatibility format and C++ structure sizes
     MANGOS_ASSERT(DBCFileLoader::GetFormatRecordSize(storage.GetFormat()) == sizeof(T) || LoadDBC_assert_print(DBCFileLoader::GetFormatRecordSize(storage.GetFormat()), sizeof(T), filename));
@@ -221,10 +238,14 @@ inline void LoadDBC(uint32& availableDbcLocales, BarGoLink& bar, StoreProblemLis
     std::string dbc_filename = dbc_path + filename;
     if (storage.Load(dbc_filename.c_str()))
     {
-        bar.step();
+        {
+            std::lock_guard<std::mutex> guard(state.lock);
+            state.bar.step();
+        }
+
         for (uint8 i = 0; fullLocaleNameList[i].name; ++i)
         {
-            if (!(availableDbcLocales & (1 << i)))
+            if (!(state.availableLocales & (1 << i)))
             {
                 continue;
             }
@@ -232,49 +253,121 @@ inline void LoadDBC(uint32& availableDbcLocales, BarGoLink& bar, StoreProblemLis
             std::string dbc_filename_loc = dbc_path + fullLocaleNameList[i].name + "/" + filename;
             if (!storage.LoadStringsFrom(dbc_filename_loc.c_str()))
             {
-                availableDbcLocales &= ~(1 << i); // mark as not available for speedup next checks
+                state.availableLocales &= ~(1 << i);        // mark as not available for speedup next checks
             }
         }
     }
     else
     {
         // sort problematic dbc to (1) non compatible and (2) nonexistent
+        std::string problem = dbc_filename;
         FILE* f = fopen(dbc_filename.c_str(), "rb");
         if (f)
         {
             char buf[100];
             snprintf(buf, 100, " (exist, but have %u fields instead %zu) Wrong client version DBC file?", storage.GetFieldCount(), strlen(storage.GetFormat()));
-            errlist.push_back(dbc_filename + buf);
+            problem += buf;
             fclose(f);
         }
-        else
-        {
-            errlist.push_back(dbc_filename);
-        }
+
+        std::lock_guard<std::mutex> guard(state.lock);
+        state.errors.push_back(problem);
     }
 }
 
+/**
+ * @brief Adds the load of one DBC file to @p loads.
+ */
+template<class T>
+inline void QueueDBC(MaNGOS::TaskGraph& loads, DBCLoadState& state, DBCStorage<T>& storage, const std::string& dbc_path, const char* filename)
+{
+    loads.Add(filename, [&state, &storage, &dbc_path, filename](uint32)
+    {
+        LoadDBC(state, storage, dbc_path, filename);
+    });
+}
+
 /**
  * @brief Loads all required DBC stores and initializes lookup helpers.
  *
  * @param dataPath The base data directory containing DBC files.
+ * @param threads How many files to load at once.
  */
-void LoadDBCStores(const std::string& dataPath)
+void LoadDBCStores(const std::string& dataPath, uint32 threads)
 {
     std::string dbcPath = dataPath + "dbc/";
 
     const uint32 DBCFilesCount = 50;
 
-    BarGoLink bar(DBCFilesCount);
-
-    StoreProblemList bad_dbc_files;
-
-    // bitmask for index of fullLocaleNameList
-    uint32 availableDbcLocales = 0xFFFFFFFF;
+    uint32 const startTime = getMSTime();
+    uint64 const startMemory = GetResidentMemory();
 
-    LoadDBC(availableDbcLocales, bar, bad_dbc_files, sAreaStore,                dbcPath, "AreaTable.dbc");
+    BarGoLink bar(DBCFilesCount);
 
-    // must be after sAreaStore loading
+    DBCLoadState state(bar);
+
+    // the files are independent of each other: map them side by side
+    MaNGOS::TaskGraph loads;
+
+    QueueDBC(loads, state, sAreaStore,                dbcPath, "AreaTable.dbc");
+    QueueDBC(loads, state, sAreaTriggerStore,         dbcPath, "AreaTrigger.dbc");
+    QueueDBC(loads, state, sAuctionHouseStore,        dbcPath, "AuctionHouse.dbc");
+    QueueDBC(loads, state, sBankBagSlotPricesStore,   dbcPath, "BankBagSlotPrices.dbc");
+    QueueDBC(loads, state, sCharStartOutfitStore,     dbcPath, "CharStartOutfit.dbc");
+    QueueDBC(loads, state, sChatChannelsStore,        dbcPath, "ChatChannels.dbc");
+    QueueDBC(loads, state, sChrClassesStore,          dbcPath, "ChrClasses.dbc");
+    QueueDBC(loads, state, sChrRacesStore,            dbcPath, "ChrRaces.dbc");
+    QueueDBC(loads, state, sCinematicSequencesStore,  dbcPath, "CinematicSequences.dbc");
+    QueueDBC(loads, state, sCreatureDisplayInfoStore, dbcPath, "CreatureDisplayInfo.dbc");
+    QueueDBC(loads, state, sCreatureDisplayInfoExtraStore, dbcPath, "CreatureDisplayInfoExtra.dbc");
+    QueueDBC(loads, state, sCreatureFamilyStore,      dbcPath, "CreatureFamily.dbc");
+    QueueDBC(loads, state, sCreatureSpellDataStore,   dbcPath, "CreatureSpellData.dbc");
+    QueueDBC(loads, state, sCreatureTypeStore,        dbcPath, "CreatureType.dbc");
+    QueueDBC(loads, state, sDurabilityCostsStore,     dbcPath, "DurabilityCosts.dbc");
+    QueueDBC(loads, state, sDurabilityQualityStore,   dbcPath, "DurabilityQuality.dbc");
+    QueueDBC(loads, state, sEmotesStore,              dbcPath, "Emotes.dbc");
+    QueueDBC(loads, state, sEmotesTextStore,          dbcPath, "EmotesText.dbc");
+    QueueDBC(loads, state, sFactionStore,             dbcPath, "Faction.dbc");
+    QueueDBC(loads, state, sFactionTemplateStore,     dbcPath, "FactionTemplate.dbc");
+    QueueDBC(loads, state, sGameObjectDisplayInfoStore, dbcPath, "GameObjectDisplayInfo.dbc");
+    QueueDBC(loads, state, sItemBagFamilyStore,       dbcPath, "ItemBagFamily.dbc");
+    QueueDBC(loads, state, sItemClassStore,           dbcPath, "ItemClass.dbc");
+    QueueDBC(loads, state, sItemRandomPropertiesStore, dbcPath, "ItemRandomProperties.dbc");
+    QueueDBC(loads, state, sItemSetStore,             dbcPath, "ItemSet.dbc");
+    QueueDBC(loads, state, sLiquidTypeStore,          dbcPath, "LiquidType.dbc");
+    QueueDBC(loads, state, sLockStore,                dbcPath, "Lock.dbc");
+    QueueDBC(loads, state, sMailTemplateStore,        dbcPath, "MailTemplate.dbc");
+    QueueDBC(loads, state, sMapStore,                 dbcPath, "Map.dbc");
+#if !defined(CLASSIC)
+    QueueDBC(loads, state, sMovieStore,               dbcPath, "Movie.dbc");
+#endif
+    QueueDBC(loads, state, sQuestSortStore,           dbcPath, "QuestSort.dbc");
+    QueueDBC(loads, state, sSkillLineStore,           dbcPath, "SkillLine.dbc");
+    QueueDBC(loads, state, sSkillLineAbilityStore,    dbcPath, "SkillLineAbility.dbc");
+    QueueDBC(loads, state, sSkillRaceClassInfoStore,  dbcPath, "SkillRaceClassInfo.dbc");
+    QueueDBC(loads, state, sSoundEntriesStore,        dbcPath, "SoundEntries.dbc");
+    QueueDBC(loads, state, sSpellStore,               dbcPath, "Spell.dbc");
+    QueueDBC(loads, state, sSpellCastTimesStore,      dbcPath, "SpellCastTimes.dbc");
+    QueueDBC(loads, state, sSpellDurationStore,       dbcPath, "SpellDuration.dbc");
+    QueueDBC(loads, state, sSpellFocusObjectStore,    dbcPath, "SpellFocusObject.dbc");
+    QueueDBC(loads, state, sSpellItemEnchantmentStore, dbcPath, "SpellItemEnchantment.dbc");
+    QueueDBC(loads, state, sSpellRadiusStore,         dbcPath, "SpellRadius.dbc");
+    QueueDBC(loads, state, sSpellRangeStore,          dbcPath, "SpellRange.dbc");
+    QueueDBC(loads, state, sSpellShapeshiftFormStore, dbcPath, "SpellShapeshiftForm.dbc");
+    QueueDBC(loads, state, sStableSlotPricesStore,    dbcPath, "StableSlotPrices.dbc");
+    QueueDBC(loads, state, sTalentStore,              dbcPath, "Talent.dbc");
+    QueueDBC(loads, state, sTalentTabStore,           dbcPath, "TalentTab.dbc");
+    QueueDBC(loads, state, sTaxiNodesStore,           dbcPath, "TaxiNodes.dbc");
+    QueueDBC(loads, state, sTaxiPathStore,            dbcPath, "TaxiPath.dbc");
+    QueueDBC(loads, state, sTaxiPathNodeStore,        dbcPath, "TaxiPathNode.dbc");
+    QueueDBC(loads, state, sWorldMapAreaStore,        dbcPath, "WorldMapArea.dbc");
+    QueueDBC(loads, state, sWMOAreaTableStore,        dbcPath, "WMOAreaTable.dbc");
+    // QueueDBC(loads, state, sWorldMapOverlayStore,     dbcPath, "WorldMapOverlay.dbc");
+    QueueDBC(loads, state, sWorldSafeLocsStore,       dbcPath, "WorldSafeLocs.dbc");
+
+    loads.Run(threads);
+
+    // the lookup tables built from the stores, now that all of them are in
     for (uint32 i = 1; i <= sAreaStore.GetNumRows(); ++i)   // areaid numbered from 1
     {
         if (AreaTableEntry const* area = sAreaStore.LookupEntry(i))
@@ -290,24 +383,6 @@ void LoadDBCStores(const std::string& dataPath)
         }
     }
 
-    LoadDBC(availableDbcLocales, bar, bad_dbc_files, sAreaTriggerStore,         dbcPath, "AreaTrigger.dbc");
-    LoadDBC(availableDbcLocales, bar, bad_dbc_files, sAuctionHouseStore,        dbcPath, "AuctionHouse.dbc");
-    LoadDBC(availableDbcLocales, bar, bad_dbc_files, sBankBagSlotPricesStore,   dbcPath, "BankBagSlotPrices.dbc");
-    LoadDBC(availableDbcLocales, bar, bad_dbc_files, sCharStartOutfitStore,     dbcPath, "CharStartOutfit.dbc");
-    LoadDBC(availableDbcLocales, bar, bad_dbc_files, sChatChannelsStore,        dbcPath, "ChatChannels.dbc");
-    LoadDBC(availableDbcLocales, bar, bad_dbc_files, sChrClassesStore,          dbcPath, "ChrClasses.dbc");
-    LoadDBC(availableDbcLocales, bar, bad_dbc_files, sChrRacesStore,            dbcPath, "ChrRaces.dbc");
-    LoadDBC(availableDbcLocales, bar, bad_dbc_files, sCinematicSequencesStore,  dbcPath, "CinematicSequences.dbc");
-    LoadDBC(availableDbcLocales, bar, bad_dbc_files, sCreatureDisplayInfoStore, dbcPath, "CreatureDisplayInfo.dbc");
-    LoadDBC(availableDbcLocales, bar, bad_dbc_files, sCreatureDisplayInfoExtraStore, dbcPath, "CreatureDisplayInfoExtra.dbc");
-    LoadDBC(availableDbcLocales, bar, bad_dbc_files, sCreatureFamilyStore,      dbcPath, "CreatureFamily.dbc");
-    LoadDBC(availableDbcLocales, bar, bad_dbc_files, sCreatureSpellDataStore,   dbcPath, "CreatureSpellData.dbc");
-    LoadDBC(availableDbcLocales, bar, bad_dbc_files, sCreatureTypeStore,        dbcPath, "CreatureType.dbc");
-    LoadDBC(availableDbcLocales, bar, bad_dbc_files, sDurabilityCostsStore,     dbcPath, "DurabilityCosts.dbc");
-    LoadDBC(availableDbcLocales, bar, bad_dbc_files, sDurabilityQualityStore,   dbcPath, "DurabilityQuality.dbc");
-    LoadDBC(availableDbcLocales, bar, bad_dbc_files, sEmotesStore,              dbcPath, "Emotes.dbc");
-    LoadDBC(availableDbcLocales, bar, bad_dbc_files, sEmotesTextStore,          dbcPath, "EmotesText.dbc");
-    LoadDBC(availableDbcLocales, bar, bad_dbc_files, sFactionStore,             dbcPath, "Faction.dbc");
     for (uint32 i = 0; i < sFactionStore.GetNumRows(); ++i)
     {
         FactionEntry const* faction = sFactionStore.LookupEntry(i);
@@ -318,26 +393,6 @@ void LoadDBCStores(const std::string& dataPath)
         }
     }
 
-    LoadDBC(availableDbcLocales, bar, bad_dbc_files, sFactionTemplateStore,     dbcPath, "FactionTemplate.dbc");
-    LoadDBC(availableDbcLocales, bar, bad_dbc_files, sGameObjectDisplayInfoStore, dbcPath, "GameObjectDisplayInfo.dbc");
-
-    LoadDBC(availableDbcLocales, bar, bad_dbc_files, sItemBagFamilyStore,       dbcPath, "ItemBagFamily.dbc");
-    LoadDBC(availableDbcLocales, bar, bad_dbc_files, sItemClassStore,           dbcPath, "ItemClass.dbc");
-    LoadDBC(availableDbcLocales, bar, bad_dbc_files, sItemRandomPropertiesStore, dbcPath, "ItemRandomProperties.dbc");
-    LoadDBC(availableDbcLocales, bar, bad_dbc_files, sItemSetStore,             dbcPath, "ItemSet.dbc");
-    LoadDBC(availableDbcLocales, bar, bad_dbc_files, sLiquidTypeStore,          dbcPath, "LiquidType.dbc");
-    LoadDBC(availableDbcLocales, bar, bad_dbc_files, sLockStore,                dbcPath, "Lock.dbc");
-    LoadDBC(availableDbcLocales, bar, bad_dbc_files, sMailTemplateStore,        dbcPath, "MailTemplate.dbc");
-    LoadDBC(availableDbcLocales, bar, bad_dbc_files, sMapStore,                 dbcPath, "Map.dbc");
-#if !defined(CLASSIC)
-    LoadDBC(availableDbcLocales, bar, bad_dbc_files, sMovieStore,               dbcPath, "Movie.dbc");
-#endif
-    LoadDBC(availableDbcLocales, bar, bad_dbc_files, sQuestSortStore,           dbcPath, "QuestSort.dbc");
-    LoadDBC(availableDbcLocales, bar, bad_dbc_files, sSkillLineStore,           dbcPath, "SkillLine.dbc");
-    LoadDBC(availableDbcLocales, bar, bad_dbc_files, sSkillLineAbilityStore,    dbcPath, "SkillLineAbility.dbc");
-    LoadDBC(availableDbcLocales, bar, bad_dbc_files, sSkillRaceClassInfoStore,  dbcPath, "SkillRaceClassInfo.dbc");
-    LoadDBC(availableDbcLocales, bar, bad_dbc_files, sSoundEntriesStore,        dbcPath, "SoundEntries.dbc");
-    LoadDBC(availableDbcLocales, bar, bad_dbc_files, sSpellStore,               dbcPath, "Spell.dbc");
     for (uint32 i = 1; i < sSpellStore.GetNumRows(); ++i)
     {
         SpellEntry const* spell = sSpellStore.LookupEntry(i);
@@ -383,16 +438,6 @@ void LoadDBCStores(const std::string& dataPath)
         }
     }
 
-    LoadDBC(availableDbcLocales, bar, bad_dbc_files, sSpellCastTimesStore,      dbcPath, "SpellCastTimes.dbc");
-    LoadDBC(availableDbcLocales, bar, bad_dbc_files, sSpellDurationStore,       dbcPath, "SpellDuration.dbc");
-    LoadDBC(availableDbcLocales, bar, bad_dbc_files, sSpellFocusObjectStore,    dbcPath, "SpellFocusObject.dbc");
-    LoadDBC(availableDbcLocales, bar, bad_dbc_files, sSpellItemEnchantmentStore, dbcPath, "SpellItemEnchantment.dbc");
-    LoadDBC(availableDbcLocales, bar, bad_dbc_files, sSpellRadiusStore,         dbcPath, "SpellRadius.dbc");
-    LoadDBC(availableDbcLocales, bar, bad_dbc_files, sSpellRangeStore,          dbcPath, "SpellRange.dbc");
-    LoadDBC(availableDbcLocales, bar, bad_dbc_files, sSpellShapeshiftFormStore, dbcPath, "SpellShapeshiftForm.dbc");
-    LoadDBC(availableDbcLocales, bar, bad_dbc_files, sStableSlotPricesStore,    dbcPath, "StableSlotPrices.dbc");
-    LoadDBC(availableDbcLocales, bar, bad_dbc_files, sTalentStore,              dbcPath, "Talent.dbc");
-
     // create talent spells set
     for (unsigned int i = 0; i < sTalentStore.GetNumRows(); ++i)
     {
@@ -410,8 +455,6 @@ void LoadDBCStores(const std::string& dataPath)
         }
     }
 
-    LoadDBC(availableDbcLocales, bar, bad_dbc_files, sTalentTabStore,           dbcPath, "TalentTab.dbc");
-
     // prepare fast data access to bit pos of talent ranks for use at inspecting
     {
         // fill table by amount of talent ranks and fill sTalentTabBitSizeInInspect
@@ -493,9 +536,6 @@ void LoadDBCStores(const std::string& dataPath)
         }
     }
 
-    LoadDBC(availableDbcLocales, bar, bad_dbc_files, sTaxiNodesStore,           dbcPath, "TaxiNodes.dbc");
-
-    LoadDBC(availableDbcLocales, bar, bad_dbc_files, sTaxiPathStore,            dbcPath, "TaxiPath.dbc");
     for (uint32 i = 1; i < sTaxiPathStore.GetNumRows(); ++i)
     {
         if (TaxiPathEntry const* entry = sTaxiPathStore.LookupEntry(i))
@@ -506,7 +546,6 @@ void LoadDBCStores(const std::string& dataPath)
     uint32 pathCount = sTaxiPathStore.GetNumRows();
 
     //## TaxiPathNode.dbc ## Loaded only for initialization different structures
-    LoadDBC(availableDbcLocales, bar, bad_dbc_files, sTaxiPathNodeStore,        dbcPath, "TaxiPathNode.dbc");
     // Calculate path nodes count
     std::vector<uint32> pathLength;
     pathLength.resize(pathCount);                           // 0 and some other indexes not used
@@ -588,8 +627,6 @@ void LoadDBCStores(const std::string& dataPath)
         }
     }
 
-    LoadDBC(availableDbcLocales, bar, bad_dbc_files, sWorldMapAreaStore,        dbcPath, "WorldMapArea.dbc");
-    LoadDBC(availableDbcLocales, bar, bad_dbc_files, sWMOAreaTableStore,        dbcPath, "WMOAreaTable.dbc");
     for (uint32 i = 0; i < sWMOAreaTableStore.GetNumRows(); ++i)
     {
         if (WMOAreaTableEntry const* entry = sWMOAreaTableStore.LookupEntry(i))
@@ -597,25 +634,25 @@ void LoadDBCStores(const std::string& dataPath)
             sWMOAreaInfoByTripple.insert(WMOAreaInfoByTripple::value_type(WMOAreaTableTripple(entry->WMOID, entry->NameSetID, entry->WMOGroupID), entry));
         }
     }
-    // LoadDBC(availableDbcLocales,bar,bad_dbc_files,sWorldMapOverlayStore,     dbcPath,"WorldMapOverlay.dbc");
-    LoadDBC(availableDbcLocales, bar, bad_dbc_files, sWorldSafeLocsStore,       dbcPath, "WorldSafeLocs.dbc");
 
-    // error checks
-    if (bad_dbc_files.size() >= DBCFilesCount)
+    // error checks; the loads finished in any order
+    state.errors.sort();
+
+    if (state.errors.size() >= DBCFilesCount)
     {
         sLog.outError("\nIncorrect DataDir value in mangosd.conf or ALL required *.dbc files (%d) not found by path: %sdbc", DBCFilesCount, dataPath.c_str());
         Log::WaitBeforeContinueIfNeed();
         exit(1);
     }
-    else if (!bad_dbc_files.empty())
+    else if (!state.errors.empty())
     {
         std::string str;
-        for (std::list<std::string>::iterator i = bad_dbc_files.begin(); i != bad_dbc_files.end(); ++i)
+        for (std::list<std::string>::iterator i = state.errors.begin(); i != state.errors.end(); ++i)
         {
             str += *i + "\n";
         }
 
-        sLog.outError("\nSome required *.dbc files (%u from %d) not found or not compatible:\n%s", (uint32)bad_dbc_files.size(), DBCFilesCount, str.c_str());
+        sLog.outError("\nSome required *.dbc files (%u from %d) not found or not compatible:\n%s", (uint32)state.errors.size(), DBCFilesCount, str.c_str());
         Log::WaitBeforeContinueIfNeed();
         exit(1);
     }
@@ -631,7 +668,9 @@ void LoadDBCStores(const std::string& dataPath)
         exit(1);
     }
 
-    sLog.outString(">> Initialized %d data stores", DBCFilesCount);
+    uint64 const endMemory = GetResidentMemory();
+    sLog.outString(">> Initialized %d data stores in %u ms on %u threads, resident memory %u KB -> %u KB", DBCFilesCount,
+                   getMSTimeDiff(startTime, getMSTime()), std::max(threads, 1u), uint32(startMemory / 1024), uint32(endMemory / 1024));
     sLog.outString();
 }
 
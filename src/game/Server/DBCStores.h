@@ -193,9 +193,9 @@ extern DBCStorage <WMOAreaTableEntry>            sWMOAreaTableStore;
 extern DBCStorage <WorldSafeLocsEntry>           sWorldSafeLocsStore;
 
 /**
- * Loads all required DBC stores from the specified data path.
+ * Loads all required DBC stores from the specified data path, @p threads files at a time.
  */
-void LoadDBCStores(const std::string& dataPath);
+void LoadDBCStores(const std::string& dataPath, uint32 threads = 1);
 
 // script support functions
 DBCStorage <SoundEntriesEntry>          const* GetSoundEntriesStore();
@@ -0,0 +1,304 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2025 MaNGOS <https://www.getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+#include "OpcodeStats.h"
+
+#include "Log.h"
+#include "OpcodeTable.h"
+
+#include <algorithm>
+#include <cstdio>
+
+static char const* const s_laneNames[OPSTATS_LANE_COUNT] = { "world", "map", "out" };
+
+/// One recording thread's counters since the last merge.
+struct OpcodeStats::Shard
+{
+    Shard()
+    {
+        for (uint32 lane = 0; lane < OPSTATS_LANE_COUNT; ++lane)
+        {
+            counters[lane].resize(NUM_MSG_TYPES);
+            touched[lane].reserve(64);
+        }
+    }
+
+    Counter& Touch(OpcodeStatsLane lane, uint16 opcode)
+    {
+        Counter& c = counters[lane][opcode];
+        if (!c.calls)
+        {
+            touched[lane].push_back(opcode);
+        }
+        return c;
+    }
+
+    std::mutex lock;                                        // contended only by the per-tick merge
+    std::vector<Counter> counters[OPSTATS_LANE_COUNT];
+    std::vector<uint16> touched[OPSTATS_LANE_COUNT];
+};
+
+uint32 OpcodeStats::Counter::PercentileUs(double fraction) const
+{
+    uint64 const wanted = uint64(calls * fraction);
+    uint64 seen = 0;
+    for (uint32 i = 0; i < HISTOGRAM_BUCKETS; ++i)
+    {
+        seen += buckets[i];
+        if (seen > wanted || seen == calls)
+        {
+            return std::min(BucketUpperUs(i), maxUs);
+        }
+    }
+    return maxUs;
+}
+
+uint32 OpcodeStats::BucketUpperUs(uint32 bucket)
+{
+    return bucket + 1 < HISTOGRAM_BUCKETS ? 16u << bucket : 0xFFFFFFFFu;
+}
+
+OpcodeStats::OpcodeStats()
+    : m_enabled(false), m_since(time(NULL)), m_dumpInterval(0), m_dumpTimer(0)
+{
+    for (uint32 lane = 0; lane < OPSTATS_LANE_COUNT; ++lane)
+    {
+        m_totals[lane].resize(NUM_MSG_TYPES);
+    }
+}
+
+OpcodeStats::~OpcodeStats()
+{
+}
+
+void OpcodeStats::Configure(bool enabled, uint32 dumpIntervalSecs, std::string const& dumpFile)
+{
+    if (enabled && !IsEnabled())
+    {
+        Reset();
+    }
+
+    m_enabled.store(enabled, std::memory_order_relaxed);
+    m_dumpInterval = dumpIntervalSecs * IN_MILLISECONDS;
+    m_dumpTimer = 0;
+    m_dumpFile = dumpFile;
+}
+
+OpcodeStats::Shard& OpcodeStats::LocalShard()
+{
+    // Shards are owned by the singleton and outlive the thread that made them,
+    // so the merge never races a thread exit.
+    thread_local Shard* shard = NULL;
+    if (!shard)
+    {
+        std::lock_guard<std::mutex> guard(m_shardsLock);
+        m_shards.push_back(std::unique_ptr<Shard>(new Shard()));
+        shard = m_shards.back().get();
+    }
+    return *shard;
+}
+
+void OpcodeStats::RecordHandler(OpcodeStatsLane lane, uint16 opcode, size_t bytes, uint32 elapsedUs)
+{
+    if (opcode >= NUM_MSG_TYPES)
+    {
+        return;
+    }
+
+    uint32 bucket = 0;
+    while (bucket + 1 < HISTOGRAM_BUCKETS && elapsedUs >= BucketUpperUs(bucket))
+    {
+        ++bucket;
+    }
+
+    Shard& shard = LocalShard();
+    std::lock_guard<std::mutex> guard(shard.lock);
+    Counter& c = shard.Touch(lane, opcode);
+    ++c.calls;
+    c.bytes += bytes;
+    c.totalUs += elapsedUs;
+    c.maxUs = std::max(c.maxUs, elapsedUs);
+    ++c.buckets[bucket];
+}
+
+void OpcodeStats::RecordSend(uint16 opcode, size_t bytes)
+{
+    if (opcode >= NUM_MSG_TYPES)
+    {
+        return;
+    }
+
+    Shard& shard = LocalShard();
+    std::lock_guard<std::mutex> guard(shard.lock);
+    Counter& c = shard.Touch(OPSTATS_LANE_OUTBOUND, opcode);
+    ++c.calls;
+    c.bytes += bytes;
+}
+
+void OpcodeStats::MergeShards()
+{
+    std::lock_guard<std::mutex> shardsGuard(m_shardsLock);
+    std::lock_guard<std::mutex> totalsGuard(m_totalsLock);
+    for (std::unique_ptr<Shard>& shard : m_shards)
+    {
+        std::lock_guard<std::mutex> guard(shard->lock);
+        for (uint32 lane = 0; lane < OPSTATS_LANE_COUNT; ++lane)
+        {
+            for (uint16 opcode : shard->touched[lane])
+            {
+                Counter& from = shard->counters[lane][opcode];
+                Counter& to = m_totals[lane][opcode];
+                to.calls += from.calls;
+                to.bytes += from.bytes;
+                to.totalUs += from.totalUs;
+                to.maxUs = std::max(to.maxUs, from.maxUs);
+                for (uint32 i = 0; i < HISTOGRAM_BUCKETS; ++i)
+                {
+                    to.buckets[i] += from.buckets[i];
+                }
+                from = Counter();
+            }
+            shard->touched[lane].clear();
+        }
+    }
+}
+
+void OpcodeStats::Update(uint32 diff)
+{
+    if (!IsEnabled())
+    {
+        return;
+    }
+
+    MergeShards();
+
+    if (!m_dumpInterval || m_dumpFile.empty())
+    {
+        return;
+    }
+
+    m_dumpTimer += diff;
+    if (m_dumpTimer >= m_dumpInterval)
+    {
+        m_dumpTimer = 0;
+        Dump(m_dumpFile);
+    }
+}
+
+void OpcodeStats::Reset()
+{
+    std::lock_guard<std::mutex> shardsGuard(m_shardsLock);
+    for (std::unique_ptr<Shard>& shard : m_shards)
+    {
+        std::lock_guard<std::mutex> guard(shard->lock);
+        for (uint32 lane = 0; lane < OPSTATS_LANE_COUNT; ++lane)
+        {
+            for (uint16 opcode : shard->touched[lane])
+            {
+                shard->counters[lane][opcode] = Counter();
+            }
+            shard->touched[lane].clear();
+        }
+    }
+
+    std::lock_guard<std::mutex> totalsGuard(m_totalsLock);
+    for (uint32 lane = 0; lane < OPSTATS_LANE_COUNT; ++lane)
+    {
+        std::fill(m_totals[lane].begin(), m_totals[lane].end(), Counter());
+    }
+    m_since = time(NULL);
+}
+
+std::vector<OpcodeStats::Row> OpcodeStats::GetTop(OpcodeStatsLane lane, uint32 count) const
+{
+    std::vector<Row> rows;
+    {
+        std::lock_guard<std::mutex> guard(m_totalsLock);
+        for (uint32 opcode = 0; opcode < NUM_MSG_TYPES; ++opcode)
+        {
+            if (m_totals[lane][opcode].calls)
+            {
+                rows.push_back(Row{ uint16(opcode), m_totals[lane][opcode] });
+            }
+        }
+    }
+
+    bool const byBytes = lane == OPSTATS_LANE_OUTBOUND;
+    std::sort(rows.begin(), rows.end(), [byBytes](Row const& a, Row const& b)
+    {
+        return byBytes ? a.counter.bytes > b.counter.bytes : a.counter.totalUs > b.counter.totalUs;
+    });
+
+    if (count && rows.size() > count)
+    {
+        rows.resize(count);
+    }
+    return rows;
+}
+
+bool OpcodeStats::Dump(std::string const& fileName) const
+{
+    FILE* file = fopen(fileName.c_str(), "a");
+    if (!file)
+    {
+        sLog.outError("OpcodeStats: can't open dump file '%s'", fileName.c_str());
+        return false;
+    }
+
+    time_t const now = time(NULL);
+    fprintf(file, "# opcode stats at " UI64FMTD ", counting since " UI64FMTD " (%u seconds)\n",
+            uint64(now), uint64(m_since), uint32(now - m_since));
+    fprintf(file, "# lane,opcode,name,calls,bytes,total_us,max_us,p50_us,p99_us");
+    for (uint32 i = 0; i < HISTOGRAM_BUCKETS; ++i)
+    {
+        if (i + 1 < HISTOGRAM_BUCKETS)
+        {
+            fprintf(file, ",lt%u", BucketUpperUs(i));
+        }
+        else
+        {
+            fprintf(file, ",ge%u", BucketUpperUs(i - 1));
+        }
+    }
+    fputc('\n', file);
+
+    for (uint32 lane = 0; lane < OPSTATS_LANE_COUNT; ++lane)
+    {
+        for (Row const& row : GetTop(OpcodeStatsLane(lane), 0))
+        {
+            Counter const& c = row.counter;
+            fprintf(file, "%s,0x%04X,%s," UI64FMTD "," UI64FMTD "," UI64FMTD ",%u,%u,%u",
+                    s_laneNames[lane], row.opcode, LookupOpcodeName(row.opcode),
+                    c.calls, c.bytes, c.totalUs, c.maxUs, c.PercentileUs(0.5), c.PercentileUs(0.99));
+            for (uint32 i = 0; i < HISTOGRAM_BUCKETS; ++i)
+            {
+                fprintf(file, ",%u", c.buckets[i]);
+            }
+            fputc('\n', file);
+        }
+    }
+
+    fclose(file);
+    return true;
+}
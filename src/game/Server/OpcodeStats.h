@@ -0,0 +1,122 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2025 MaNGOS <https://www.getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+#ifndef MANGOS_H_OPCODESTATS
+#define MANGOS_H_OPCODESTATS
+
+#include "Common.h"
+#include "Policies/Singleton.h"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/// Where a packet was counted (see OpcodeStats.Enable).
+enum OpcodeStatsLane
+{
+    OPSTATS_LANE_WORLD      = 0,                            ///< handler ran in World::UpdateSessions
+    OPSTATS_LANE_MAP        = 1,                            ///< handler ran in Map::Update (thread-safe opcodes)
+    OPSTATS_LANE_OUTBOUND   = 2,                            ///< WorldSession::SendPacket, no handler time
+    OPSTATS_LANE_COUNT
+};
+
+/**
+ * @brief Per-opcode call, byte and handler-time counters.
+ *
+ * Recording threads (world, map workers, anything calling SendPacket) write
+ * into a shard of their own; the world thread folds every shard into the
+ * totals once per tick, so the hot path never touches a shared cache line.
+ */
+class OpcodeStats : public MaNGOS::Singleton<OpcodeStats>
+{
+    friend class MaNGOS::Singleton<OpcodeStats>;
+
+public:
+    /// Handler time buckets: [0,16us), [16,32us), ... doubling up to [16ms, inf).
+    static uint32 const HISTOGRAM_BUCKETS = 12;
+
+    struct Counter
+    {
+        uint64 calls = 0;
+        uint64 bytes = 0;
+        uint64 totalUs = 0;
+        uint32 maxUs = 0;
+        uint32 buckets[HISTOGRAM_BUCKETS] = {};
+
+        /// Smallest bucket upper bound covering @p fraction of the calls, in microseconds.
+        uint32 PercentileUs(double fraction) const;
+    };
+
+    struct Row
+    {
+        uint16 opcode;
+        Counter counter;
+    };
+
+    void Configure(bool enabled, uint32 dumpIntervalSecs, std::string const& dumpFile);
+    bool IsEnabled() const { return m_enabled.load(std::memory_order_relaxed); }
+
+    void RecordHandler(OpcodeStatsLane lane, uint16 opcode, size_t bytes, uint32 elapsedUs);
+    void RecordSend(uint16 opcode, size_t bytes);
+
+    /// World thread, once per tick: merge shards and write the periodic dump.
+    void Update(uint32 diff);
+    void Reset();
+
+    /// Busiest opcodes of a lane; inbound lanes sort by total handler time, outbound by bytes.
+    std::vector<Row> GetTop(OpcodeStatsLane lane, uint32 count) const;
+    time_t GetSince() const { return m_since; }
+
+    bool Dump(std::string const& fileName) const;
+
+    static uint32 BucketUpperUs(uint32 bucket);
+
+private:
+    struct Shard;
+
+    OpcodeStats();
+    ~OpcodeStats();
+
+    Shard& LocalShard();
+    void MergeShards();
+
+    std::atomic<bool> m_enabled;
+
+    std::mutex m_shardsLock;
+    std::vector<std::unique_ptr<Shard> > m_shards;
+
+    mutable std::mutex m_totalsLock;
+    std::vector<Counter> m_totals[OPSTATS_LANE_COUNT];
+    time_t m_since;
+
+    uint32 m_dumpInterval;
+    uint32 m_dumpTimer;
+    std::string m_dumpFile;
+};
+
+#define sOpcodeStats MaNGOS::Singleton<OpcodeStats>::Instance()
+
+#endif
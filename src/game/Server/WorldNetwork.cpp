@@ -27,6 +27,7 @@
 #include "ClientConnection.h"
 #include "Log.h"
 #include "OpcodeTable.h"
+#include "World.h"
 
 WorldNetwork::WorldNetwork()
     : m_listener(m_gateway)
@@ -46,6 +47,13 @@ bool WorldNetwork::Start(uint16 port, std::string const& bindIp)
     }
 
     InitializeOpcodes();
+    proto::ClientConnection::SetCorking(
+        sWorld.getConfig(CONFIG_BOOL_NETWORK_CORK_OUTPUT),
+        sWorld.getConfig(CONFIG_UINT32_NETWORK_CORK_FLUSH_BYTES));
+    proto::ClientConnection::SetShaping(
+        sWorld.getConfig(CONFIG_BOOL_NETWORK_SHAPE_OUTPUT),
+        sWorld.getConfig(CONFIG_UINT32_NETWORK_SHAPE_BACKLOG_BYTES),
+        sWorld.getConfig(CONFIG_UINT32_NETWORK_SHAPE_TICK_BYTES));
     if (!m_listener.Start(port, bindIp))
     {
         sLog.outError("WorldNetwork::Start: failed to listen on %s:%u",
@@ -72,3 +80,18 @@ uint32 WorldNetwork::GetOpenConnectionCount() const
 {
     return proto::ClientConnection::GetOpenConnectionCount();
 }
+
+WorldNetwork::SendStats WorldNetwork::GetSendStats() const
+{
+    proto::ClientConnection::SendStats const stats =
+        proto::ClientConnection::GetSendStats();
+    SendStats result;
+    result.packets = stats.packets;
+    result.writes = stats.writes;
+    result.bytes = stats.bytes;
+    result.shaped = stats.shaped;
+    result.merged = stats.merged;
+    result.corked = proto::ClientConnection::IsCorking();
+    result.shaping = proto::ClientConnection::IsShaping();
+    return result;
+}
@@ -40,6 +40,20 @@ public:
     void Stop();
     uint32 GetOpenConnectionCount() const;
 
+    /// Client output totals since startup (see Network.CorkOutput).
+    struct SendStats
+    {
+        uint64 packets = 0;
+        uint64 writes = 0;
+        uint64 bytes = 0;
+        uint64 shaped = 0;
+        uint64 merged = 0;
+        bool corked = false;
+        bool shaping = false;
+    };
+
+    SendStats GetSendStats() const;
+
 private:
     WorldNetwork();
     ~WorldNetwork();
@@ -50,6 +50,7 @@
 #include "Database/DatabaseEnv.h"
 #include "Log.h"
 #include "OpcodeTable.h"
+#include "OpcodeStats.h"
 #include "SessionMailbox.h"
 #include "WorldPacket.h"
 #include "WorldSession.h"
@@ -73,6 +74,8 @@
 // Warden
 #include "WardenWin.h"
 #include "WardenMac.h"
+#include <algorithm>
+#include <chrono>
 #include <cstdarg>
 
 /**
@@ -169,6 +172,12 @@ WorldSession::~WorldSession()
 {
     m_mailbox->Close();
 
+    // a create dropped with the session never answers, free its name
+    if (!m_charCreateName.empty())
+    {
+        sObjectMgr.ReleaseCreatingName(m_charCreateName);
+    }
+
     ///- unload player if not unloaded
     if (_player)
     {
@@ -236,6 +245,11 @@ void WorldSession::SendPacket(WorldPacket const* packet)
         return;
     }
 
+    if (sOpcodeStats.IsEnabled())
+    {
+        sOpcodeStats.RecordSend(packet->GetOpcode(), packet->size());
+    }
+
 #ifdef MANGOS_DEBUG
 
     // Code for network use statistic
@@ -275,6 +289,15 @@ void WorldSession::SendPacket(WorldPacket const* packet)
     m_link->SendPacket(*packet);
 }
 
+/// Push output corked during this tick to the client (see Network.CorkOutput)
+void WorldSession::FlushPackets()
+{
+    if (m_link)
+    {
+        m_link->Flush();
+    }
+}
+
 void WorldSession::SetPendingAddonInfo(std::unique_ptr<WorldPacket> packet)
 {
     m_pendingAddonInfo = std::move(packet);
@@ -318,6 +341,12 @@ void WorldSession::LogUnprocessedTail(WorldPacket* packet)
 /// Update the WorldSession (triggered by World update)
 bool WorldSession::Update(PacketFilter& updater)
 {
+    ///- Resume the handlers whose async queries are done, on the world thread only
+    if (!updater.InMapContext())
+    {
+        ProcessQueryCallbacks();
+    }
+
     ///- Retrieve packets from the receive queue and call the appropriate handlers
     /// not process packets if the client link already closed
     WorldPacket* packet = NULL;
@@ -345,7 +374,7 @@ bool WorldSession::Update(PacketFilter& updater)
                     }
                     else if (_player->IsInWorld())
                     {
-                        ExecuteOpcode(opHandle, packet);
+                        ExecuteOpcode(opHandle, packet, updater.InMapContext());
                     }
 
                     // lag can cause STATUS_LOGGEDIN opcodes to arrive after the player started a transfer
@@ -365,7 +394,7 @@ bool WorldSession::Update(PacketFilter& updater)
                     else
                         // not expected _player or must checked in packet hanlder
                     {
-                        ExecuteOpcode(opHandle, packet);
+                        ExecuteOpcode(opHandle, packet, updater.InMapContext());
                     }
                     break;
                 case STATUS_TRANSFER:
@@ -379,7 +408,7 @@ bool WorldSession::Update(PacketFilter& updater)
                     }
                     else
                     {
-                        ExecuteOpcode(opHandle, packet);
+                        ExecuteOpcode(opHandle, packet, updater.InMapContext());
                     }
                     break;
                 case STATUS_AUTHED:
@@ -396,7 +425,7 @@ bool WorldSession::Update(PacketFilter& updater)
                     // and before other STATUS_LOGGEDIN_OR_RECENTLY_LOGGOUT opcodes.
                     m_playerRecentlyLogout = false;
 
-                    ExecuteOpcode(opHandle, packet);
+                    ExecuteOpcode(opHandle, packet, updater.InMapContext());
                     break;
                 case STATUS_NEVER:
                     sLog.outError("SESSION: received not allowed opcode %s (0x%.4X)",
@@ -1062,13 +1091,58 @@ void WorldSession::SendTransferAborted(uint32 mapid, uint8 reason, uint8 arg)
     SendPacket(&data);
 }
 
+/**
+ * @brief Queues a continuation for an async query.
+ *
+ * @param future The query handle; an invalid one resumes the callback at once with no result.
+ * @param callback The continuation, given the result to own.
+ */
+void WorldSession::AddQueryCallback(SqlQueryFuture const& future, std::function<void(QueryResult*)> const& callback)
+{
+    if (!future.IsValid())
+    {
+        callback(NULL);
+        return;
+    }
+
+    std::lock_guard<std::mutex> guard(m_queryCallbackLock);
+    m_queryCallbacks.push_back(QueryCallback(future, callback));
+}
+
+/**
+ * @brief Runs the continuations whose queries are done.
+ */
+void WorldSession::ProcessQueryCallbacks()
+{
+    // a callback may add the next step of its handler: run that too if it is done already
+    for (;;)
+    {
+        QueryCallback ready;
+        {
+            std::lock_guard<std::mutex> guard(m_queryCallbackLock);
+            std::vector<QueryCallback>::iterator itr = std::find_if(m_queryCallbacks.begin(), m_queryCallbacks.end(),
+                [](QueryCallback const& pending) { return pending.first.IsReady(); });
+            if (itr == m_queryCallbacks.end())
+            {
+                return;
+            }
+
+            ready = *itr;
+            m_queryCallbacks.erase(itr);
+        }
+
+        ready.second(ready.first.Take());
+    }
+}
+
 /**
  * @brief Executes a validated opcode handler with delayed-teleport protection.
  *
  * @param opHandle The opcode handler metadata.
  * @param packet The packet to process.
+ * @param inMap True when called from Map::Update() rather than the world thread.
  */
-void WorldSession::ExecuteOpcode(OpcodeHandler const& opHandle, WorldPacket* packet)
+void WorldSession::ExecuteOpcode(OpcodeHandler const& opHandle, WorldPacket* packet, bool inMap)
 {
 #ifdef ENABLE_ELUNA
     if (Eluna* e = sWorld.GetEluna())
@@ -1087,7 +1161,18 @@ void WorldSession::ExecuteOpcode(OpcodeHandler const& opHandle, WorldPacket* pac
         _player->SetCanDelayTeleport(true);
     }
 
-    (this->*opHandle.handler)(*packet);
+    if (sOpcodeStats.IsEnabled())
+    {
+        std::chrono::steady_clock::time_point const start = std::chrono::steady_clock::now();
+        (this->*opHandle.handler)(*packet);
+        uint64 const elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+        sOpcodeStats.RecordHandler(inMap ? OPSTATS_LANE_MAP : OPSTATS_LANE_WORLD, packet->GetOpcode(), packet->size(),
+                                   uint32(std::min<uint64>(elapsed, 0xFFFFFFFF)));
+    }
+    else
+    {
+        (this->*opHandle.handler)(*packet);
+    }
 
     if (_player)
     {
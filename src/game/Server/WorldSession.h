@@ -35,8 +35,11 @@
 #include "ObjectGuid.h"
 #include "AuctionHouseMgr.h"
 #include "Item.h"
+#include "Database/SqlQueryFuture.h"
 #include <chrono>
+#include <functional>
 #include <memory>
+#include <mutex>
 
 struct ItemPrototype;
 struct AuctionEntry;
@@ -141,6 +144,15 @@ class PacketFilter
             return true;
         }
 
+        /**
+         * @brief Whether packets accepted by this filter run inside Map::Update()
+         * @return True for map-context filters
+         */
+        virtual bool InMapContext() const
+        {
+            return false;
+        }
+
     protected:
         WorldSession* const m_pSession;
 };
@@ -182,6 +194,11 @@ class MapSessionFilter : public PacketFilter
         {
             return false;
         }
+
+        bool InMapContext() const override
+        {
+            return true;
+        }
 };
 
 /**
@@ -270,6 +287,7 @@ class WorldSession
         void SizeError(WorldPacket const& packet, uint32 size) const;
 
         void SendPacket(WorldPacket const* packet);
+        void FlushPackets();
         void SetPendingAddonInfo(std::unique_ptr<WorldPacket> packet);
         void SendPendingAddonInfo();
         void SendNotification(const char* format, ...) ATTR_PRINTF(2, 3);
@@ -353,6 +371,20 @@ class WorldSession
 
         bool Update(PacketFilter& updater);
 
+        /**
+         * @brief Resume @p callback with the result of @p future at a later Update()
+         *
+         * Lets a handler issue Database::QueryAsync() instead of blocking the
+         * tick; any thread may add one. The callback runs on the
+         * world thread, before the packets of the update that finds the query
+         * done, and owns (deletes) the result.
+         * Pending callbacks die with the session, so capturing `this` is safe;
+         * the player may have logged out meanwhile, check GetPlayer() again.
+         * Callbacks run as their queries finish, not in the order they were
+         * added; to order two, add the second from inside the first.
+         */
+        void AddQueryCallback(SqlQueryFuture const& future, std::function<void(QueryResult*)> const& callback);
+
         /// Handle the authentication waiting queue (to be completed)
         void SendAuthWaitQue(uint32 position);
 
@@ -899,7 +931,17 @@ class WorldSession
         bool VerifyMovementInfo(MovementInfo const& movementInfo) const;
         void HandleMoverRelocation(MovementInfo& movementInfo);
 
-        void ExecuteOpcode(OpcodeHandler const& opHandle, WorldPacket* packet);
+        void ExecuteOpcode(OpcodeHandler const& opHandle, WorldPacket* packet, bool inMap);
+        void ProcessQueryCallbacks();
+
+        /// A CMSG_CHAR_CREATE waiting on its queries
+        struct CharCreateInfo
+        {
+            std::string name;
+            uint8 race, class_, gender, skin, face, hairStyle, hairColor, facialHair, outfitId;
+        };
+        void SendCharCreateResult(uint8 result, std::shared_ptr<SqlCommitStatus> const& save = nullptr);
+        void CreateCharacter(CharCreateInfo const& info, QueryResult* result);
 
         // logging helper
         void LogUnexpectedOpcode(WorldPacket* packet, const char* reason);
@@ -934,6 +976,11 @@ class WorldSession
         std::chrono::steady_clock::time_point m_lastPingTime;
         bool m_hasPinged;
         uint32 m_overSpeedPings;
+
+        typedef std::pair<SqlQueryFuture, std::function<void(QueryResult*)> > QueryCallback;
+        std::vector<QueryCallback> m_queryCallbacks;        // added to from the world and map threads, run on the world thread
+        std::mutex m_queryCallbackLock;
+        std::string m_charCreateName;                       // claimed by a CMSG_CHAR_CREATE waiting on its queries, empty if none
 };
 #endif
 /// @}
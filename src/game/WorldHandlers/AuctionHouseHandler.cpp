@@ -79,6 +79,21 @@
 // please DO NOT use iterator++, because it is slower than ++iterator!!!
 // post-incrementation is always slower than pre-incrementation !
 
+// Map an AuctionHouseEntry to its house group (0/1/2): the BrowseQuery house
+// code and the AH.Service.Shards routing key. The houseId ranges mirror the
+// live faction split (1..3 = Alliance, 4..6 = Horde, else Neutral).
+static uint8 AhHouseToType(AuctionHouseEntry const* e)
+{
+    return AhHouseIdToGroup(e->houseId);
+}
+
+// The AH worker owning @p e's house group (one worker unless
+// AH.Service.Shards splits the houses), or NULL when none is published.
+static WorkerSupervisor* AhSupervisorFor(AuctionHouseEntry const* e)
+{
+    return sWorld.GetAhSupervisor(AhHouseToType(e));
+}
+
 // SP-1 coordinator: the player-facing "AH temporarily unavailable" signal -- a
 // transient center-screen flash (SMSG_NOTIFICATION) PLUS a persistent red system
 // chat line. Used wherever a worker is the AH authority but cannot serve: the
@@ -127,8 +142,8 @@ uint16 AhClassifyBidForward(uint32 auctionId, uint32 bidderGuidLow, uint32 price
 }
 
 bool AhBuildCancelPrepareForward(MutationPendingMap& pending, uint32 playerGuidLow,
-                                 uint32 auctionId, uint64 uuid, uint32 sentSec,
-                                 IpcMessage& out)
+                                 uint32 auctionId, uint8 houseGroup, uint64 uuid,
+                                 uint32 sentSec, IpcMessage& out)
 {
     if (!pending.CanRegister(playerGuidLow))
     {
@@ -146,6 +161,7 @@ bool AhBuildCancelPrepareForward(MutationPendingMap& pending, uint32 playerGuidL
     pm.reserveKey.clear();
     pm.itemKey.clear();
     pm.depKey.clear();
+    pm.houseGroup     = houseGroup;
     pending.Register(pm);
 
     PlayerCancelPrepare prep;
@@ -192,16 +208,18 @@ void WorldSession::SendAuctionHello(Unit* unit)
     // rather than silently opening the window. When the worker is not configured,
     // open normally (legacy single-process). This is the single chokepoint for
     // every open path (auctioneer click, gossip option, .auction GM commands).
-    WorkerSupervisor* sv = sWorld.GetAhSupervisor();
+    // With AH.Service.Shards only this auctioneer's worker has to be up.
+
+    // always return pointer
+    AuctionHouseEntry const* ahEntry = AuctionHouseMgr::GetAuctionHouseEntry(unit);
+
+    WorkerSupervisor* sv = AhSupervisorFor(ahEntry);
     if (sWorld.IsAhServiceConfigured() && !(sv && sv->ServiceActive()))
     {
         AhSendUnavailableMessage(this);
         return;
     }
 
-    // always return pointer
-    AuctionHouseEntry const* ahEntry = AuctionHouseMgr::GetAuctionHouseEntry(unit);
-
     WorldPacket data(MSG_AUCTION_HELLO, 12);
     data << unit->GetObjectGuid();
     data << uint32(ahEntry->houseId);
@@ -659,7 +677,7 @@ void WorldSession::HandleAuctionSellItem(WorldPacket& recv_data)
         // down => the existing unavailable path (center flash + red chat line)
         // plus an ERR_DATABASE command result so the client UI unlocks
         // (the same result class as the M2 in-doubt tombstone).
-        WorkerSupervisor* sv = sWorld.GetAhSupervisor();
+        WorkerSupervisor* sv = AhSupervisorFor(auctionHouseEntry);
         if (!sv || !sv->ServiceActive())
         {
             AhSendUnavailableMessage(this);
@@ -740,6 +758,7 @@ void WorldSession::HandleAuctionSellItem(WorldPacket& recv_data)
         pm.reserveKey.clear();
         pm.itemKey        = "item:" + aucIdStr;
         pm.depKey         = "dep:" + aucIdStr;
+        pm.houseGroup     = AhHouseToType(auctionHouseEntry);
         sWorld.GetMutationPending().Register(pm);
 
         PlayerSellIntent psi;
@@ -937,7 +956,7 @@ void WorldSession::HandleAuctionPlaceBid(WorldPacket& recv_data)
     {
         Player* pl = GetPlayer();
 
-        WorkerSupervisor* sv = sWorld.GetAhSupervisor();
+        WorkerSupervisor* sv = AhSupervisorFor(auctionHouseEntry);
         if (!sv || !sv->ServiceActive())
         {
             AhSendUnavailableMessage(this);
@@ -1009,6 +1028,7 @@ void WorldSession::HandleAuctionPlaceBid(WorldPacket& recv_data)
         pm.reserveKey     = reserveKey;
         pm.itemKey.clear();
         pm.depKey.clear();
+        pm.houseGroup     = AhHouseToType(auctionHouseEntry);
         sWorld.GetMutationPending().Register(pm);
 
         IpcMessage m;
@@ -1237,7 +1257,7 @@ void WorldSession::HandleAuctionRemoveItem(WorldPacket& recv_data)
     {
         Player* pl = GetPlayer();
 
-        WorkerSupervisor* sv = sWorld.GetAhSupervisor();
+        WorkerSupervisor* sv = AhSupervisorFor(auctionHouseEntry);
         if (!sv || !sv->ServiceActive())
         {
             AhSendUnavailableMessage(this);
@@ -1248,7 +1268,8 @@ void WorldSession::HandleAuctionRemoveItem(WorldPacket& recv_data)
         uint64 const uuid = AhMintMutationUuid();
         IpcMessage m;
         if (!AhBuildCancelPrepareForward(sWorld.GetMutationPending(), pl->GetGUIDLow(),
-                                         auctionId, uuid, uint32(time(NULL)), m))
+                                         auctionId, AhHouseToType(auctionHouseEntry),
+                                         uuid, uint32(time(NULL)), m))
         {
             SendAuctionCommandResultData(auctionId, AUCTION_REMOVED, AUCTION_ERR_DATABASE, EQUIP_ERR_OK, 0);
             return;
@@ -1509,23 +1530,6 @@ void WorldSession::HandleAuctionRemoveItem(WorldPacket& recv_data)
 // SP-1 async browse proxy: profile/recipe/house builders + in-process fallback
 // ===========================================================================
 
-// Map an AuctionHouseEntry to the BrowseQuery house code (0/1/2). The houseId
-// ranges mirror the live faction split (1..3 = Alliance, 4..6 = Horde, else
-// Neutral).
-static uint8 AhHouseToType(AuctionHouseEntry const* e)
-{
-    uint32 id = e->houseId;
-    if (id >= 1u && id <= 3u)
-    {
-        return 0u;   // ALLIANCE
-    }
-    if (id >= 4u && id <= 6u)
-    {
-        return 1u;   // HORDE
-    }
-    return 2u;       // NEUTRAL
-}
-
 // Snapshot the browsing player's usability inputs into the wire profile.
 static void AhBuildBrowseQueryProfile(Player* player, PlayerProfile& out)
 {
@@ -1699,7 +1703,7 @@ void WorldSession::HandleAuctionListBidderItems(WorldPacket& recv_data)
     }
 
     // ----- SP-1 async proxy: hand the browse to the worker when active -----
-    WorkerSupervisor* sv = sWorld.GetAhSupervisor();
+    WorkerSupervisor* sv = AhSupervisorFor(auctionHouseEntry);
     if (sv && sv->ServiceActive())
     {
         PendingBrowse pb;
@@ -1828,7 +1832,7 @@ void WorldSession::HandleAuctionListOwnerItems(WorldPacket& recv_data)
     }
 
     // ----- SP-1 async proxy: hand the browse to the worker when active -----
-    WorkerSupervisor* sv = sWorld.GetAhSupervisor();
+    WorkerSupervisor* sv = AhSupervisorFor(auctionHouseEntry);
     if (sv && sv->ServiceActive())
     {
         PendingBrowse pb;
@@ -1958,7 +1962,7 @@ void WorldSession::HandleAuctionListItems(WorldPacket& recv_data)
     //  auctioneerGuid.GetString().c_str(), listfrom, searchedname.c_str(), levelmin, levelmax, auctionSlotID, auctionMainCategory, auctionSubCategory, quality, usable);
 
     // ----- SP-1 async proxy: hand the browse to the worker when active -----
-    WorkerSupervisor* sv = sWorld.GetAhSupervisor();
+    WorkerSupervisor* sv = AhSupervisorFor(auctionHouseEntry);
     if (sv && sv->ServiceActive())
     {
         std::wstring wsearchedname;
@@ -3054,7 +3058,6 @@ void AhHandlePlayerMutationResult(PlayerMutationResult const& res)
 static void AhHandleCancelPrepared(PlayerMutationResult const& res)
 {
     MutationPendingMap& pend = sWorld.GetMutationPending();
-    WorkerSupervisor* sv = sWorld.GetAhSupervisor();
 
     PendingMutation pm;
     if (!pend.Peek(res.uuid, pm))
@@ -3062,6 +3065,9 @@ static void AhHandleCancelPrepared(PlayerMutationResult const& res)
         sLog.outError("[AHMut] PROTOCOL FAULT: PREPARED for unknown uuid " UI64FMTD, res.uuid);
         return;
     }
+    // The decision goes back to the worker holding the prepare lock: the one
+    // owning the auction's house group.
+    WorkerSupervisor* sv = sWorld.GetAhSupervisor(pm.houseGroup);
     if (pm.op != uint16(IPC_PLAYER_CANCEL))
     {
         sLog.outError("[AHMut] PROTOCOL FAULT: PREPARED for non-cancel op 0x%04X (uuid " UI64FMTD ")",
@@ -3675,7 +3681,7 @@ static void AhAbortAndRelease(PendingMutation const& pm)
         }
     }
 
-    WorkerSupervisor* const sv = sWorld.GetAhSupervisor();
+    WorkerSupervisor* const sv = sWorld.GetAhSupervisor(pm.houseGroup);
     if (sv != NULL && sv->ServiceActive())
     {
         PlayerCancelDecide d;
@@ -3695,11 +3701,21 @@ static void AhAbortAndRelease(PendingMutation const& pm)
 // service-just-became-active edge (spec 8). Per uuid: COMMITTED/APPLIED =>
 // finalize-forward; CANCEL_PREPARED => abort + release; absent (or an anomalous
 // present state) => release the reservation. Each disposition consumes its slot.
-void AhReconcileOnReconnect()
+// Only pendings in @p houseMask's groups are walked: a worker that reconnects
+// settles its own houses, never a sibling shard's still in flight.
+void AhReconcileOnReconnect(uint8 houseMask)
 {
     MutationPendingMap& pend = sWorld.GetMutationPending();
+    std::vector<PendingMutation> all;
+    pend.SnapshotInflight(all);
     std::vector<PendingMutation> inflight;
-    pend.SnapshotInflight(inflight);
+    for (size_t i = 0; i < all.size(); ++i)
+    {
+        if (houseMask & AhHouseGroupBit(all[i].houseGroup))
+        {
+            inflight.push_back(all[i]);
+        }
+    }
     if (inflight.empty())
     {
         return;
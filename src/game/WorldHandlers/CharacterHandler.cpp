@@ -58,6 +58,7 @@
 #include "Group.h"
 #include "Database/DatabaseImpl.h"
 #include "PlayerDump.h"
+#include "PlayerSaveScheduler.h"
 #include "SocialMgr.h"
 #include "Util.h"
 #include "Language.h"
@@ -287,6 +288,7 @@ void PlayerbotHolder::AddPlayerBot(uint64 playerGuid, uint32 masterAccountId)
         delete holder;                                      // delete all unprocessed queries
         return;
     }
+    Database::ShardKeyScope shardKey(CharacterDatabase, ObjectGuid(playerGuid).GetCounter());
     CharacterDatabase.DelayQueryHolder(&chrHandler, &CharacterHandler::HandlePlayerBotLoginCallback, holder);
 }
 #endif
@@ -368,6 +370,14 @@ void WorldSession::HandleCharCreateOpcode(WorldPacket& recv_data)
 
     WorldPacket data(SMSG_CHAR_CREATE, 1);                  // returned with diff.values in all cases
 
+    // one at a time: the character counts are only checked again once it is saved
+    if (!m_charCreateName.empty())
+    {
+        data << (uint8)CHAR_CREATE_IN_PROGRESS;
+        SendPacket(&data);
+        return;
+    }
+
     if (GetSecurity() == SEC_PLAYER)
     {
         if (uint32 mask = sWorld.getConfig(CONFIG_UINT32_CHARACTERS_CREATING_DISABLED))
@@ -427,102 +437,156 @@ void WorldSession::HandleCharCreateOpcode(WorldPacket& recv_data)
         return;
     }
 
-    if (sObjectMgr.GetPlayerGuidByName(name))
+    if (ObjectMgr::IsAhBotSystemOwnerName(name))
     {
         data << (uint8)CHAR_CREATE_NAME_IN_USE;
         SendPacket(&data);
         return;
     }
 
-    QueryResult* resultacct = LoginDatabase.PQuery("SELECT SUM(`numchars`) FROM `realmcharacters` WHERE `acctid` = '%u'", GetAccountId());
-    if (resultacct)
+    // the name query below cannot see a create of the same name whose character row is not written yet
+    if (!sObjectMgr.ClaimCreatingName(name))
     {
-        Field* fields = resultacct->Fetch();
-        uint32 acctcharcount = fields[0].GetUInt32();
-        delete resultacct;
+        data << (uint8)CHAR_CREATE_NAME_IN_USE;
+        SendPacket(&data);
+        return;
+    }
 
-        if (acctcharcount >= sWorld.getConfig(CONFIG_UINT32_CHARACTERS_PER_ACCOUNT))
+    // the name and both character counts are read side by side on the async
+    // threads; the checks resume one by one at the next session updates
+    std::shared_ptr<CharCreateInfo> info = std::make_shared<CharCreateInfo>();
+    info->name = name;
+    info->race = race_;
+    info->class_ = class_;
+    info->gender = gender;
+    info->skin = skin;
+    info->face = face;
+    info->hairStyle = hairStyle;
+    info->hairColor = hairColor;
+    info->facialHair = facialHair;
+    info->outfitId = outfitId;
+
+    CharacterDatabase.escape_string(name);
+    SqlQueryFuture nameQuery = CharacterDatabase.PQueryAsync("SELECT `guid` FROM `characters` WHERE `name` = '%s'", name.c_str());
+    SqlQueryFuture accountQuery = LoginDatabase.PQueryAsync("SELECT SUM(`numchars`) FROM `realmcharacters` WHERE `acctid` = '%u'", GetAccountId());
+    SqlQueryFuture realmQuery = CharacterDatabase.PQueryAsync("SELECT `race` FROM `characters` WHERE `account` = '%u'", GetAccountId());
+
+    m_charCreateName = info->name;
+
+    AddQueryCallback(nameQuery, [this, info, accountQuery, realmQuery](QueryResult* result)
+    {
+        if (result)
         {
-            data << (uint8)CHAR_CREATE_ACCOUNT_LIMIT;
-            SendPacket(&data);
+            delete result;
+            SendCharCreateResult(CHAR_CREATE_NAME_IN_USE);
             return;
         }
-    }
 
-    QueryResult* result = CharacterDatabase.PQuery("SELECT COUNT(`guid`) FROM `characters` WHERE `account` = '%u'", GetAccountId());
-    uint8 charcount = 0;
-    if (result)
+        AddQueryCallback(accountQuery, [this, info, realmQuery](QueryResult* result)
+        {
+            if (result)
+            {
+                uint32 acctcharcount = result->Fetch()[0].GetUInt32();
+                delete result;
+
+                if (acctcharcount >= sWorld.getConfig(CONFIG_UINT32_CHARACTERS_PER_ACCOUNT))
+                {
+                    SendCharCreateResult(CHAR_CREATE_ACCOUNT_LIMIT);
+                    return;
+                }
+            }
+
+            AddQueryCallback(realmQuery, [this, info](QueryResult* result)
+            {
+                CreateCharacter(*info, result);
+            });
+        });
+    });
+}
+
+/**
+ * @brief Answers a CMSG_CHAR_CREATE, ending the request.
+ *
+ * @param result The character creation response code.
+ * @param save The new character's save; its name stays claimed until that has run.
+ */
+void WorldSession::SendCharCreateResult(uint8 result, std::shared_ptr<SqlCommitStatus> const& save)
+{
+    sObjectMgr.ReleaseCreatingName(m_charCreateName, save);
+    m_charCreateName.clear();
+
+    WorldPacket data(SMSG_CHAR_CREATE, 1);
+    data << uint8(result);
+    SendPacket(&data);
+}
+
+/**
+ * @brief Finishes a character creation once its name and account checks passed.
+ *
+ * @param info The validated creation request.
+ * @param result The races of the account's characters on this realm; deleted here.
+ */
+void WorldSession::CreateCharacter(CharCreateInfo const& info, QueryResult* result)
+{
+    uint8 charcount = result ? uint8(result->GetRowCount()) : 0;
+    if (charcount >= sWorld.getConfig(CONFIG_UINT32_CHARACTERS_PER_REALM))
     {
-        Field* fields = result->Fetch();
-        charcount = fields[0].GetUInt8();
         delete result;
-
-        if (charcount >= sWorld.getConfig(CONFIG_UINT32_CHARACTERS_PER_REALM))
-        {
-            data << (uint8)CHAR_CREATE_SERVER_LIMIT;
-            SendPacket(&data);
-            return;
-        }
+        SendCharCreateResult(CHAR_CREATE_SERVER_LIMIT);
+        return;
     }
 
     bool AllowTwoSideAccounts = !sWorld.IsPvPRealm() || sWorld.getConfig(CONFIG_BOOL_ALLOW_TWO_SIDE_ACCOUNTS) || GetSecurity() > SEC_PLAYER;
     CinematicsSkipMode skipCinematics = CinematicsSkipMode(sWorld.getConfig(CONFIG_UINT32_SKIP_CINEMATICS));
 
     bool have_same_race = false;
-    if (!AllowTwoSideAccounts || skipCinematics == CINEMATICS_SKIP_SAME_RACE)
+    if (result && (!AllowTwoSideAccounts || skipCinematics == CINEMATICS_SKIP_SAME_RACE))
     {
-        QueryResult* result2 = CharacterDatabase.PQuery("SELECT `race` FROM `characters` WHERE `account` = '%u' %s",
-            GetAccountId(), (skipCinematics == CINEMATICS_SKIP_SAME_RACE) ? "" : "LIMIT 1");
-        if (result2)
-        {
-            Team team_ = Player::TeamForRace(race_);
+        Team team_ = Player::TeamForRace(info.race);
 
-            Field* field = result2->Fetch();
-            uint8 acc_race  = field[0].GetUInt32();
+        Field* field = result->Fetch();
+        uint8 acc_race  = field[0].GetUInt32();
 
-            // need to check team only for first character
-            // TODO: what to if account already has characters of both races?
-            if (!AllowTwoSideAccounts)
+        // need to check team only for first character
+        // TODO: what to if account already has characters of both races?
+        if (!AllowTwoSideAccounts)
+        {
+            if (acc_race == 0 || Player::TeamForRace(acc_race) != team_)
             {
-                if (acc_race == 0 || Player::TeamForRace(acc_race) != team_)
-                {
-                    data << (uint8)CHAR_CREATE_PVP_TEAMS_VIOLATION;
-                    SendPacket(&data);
-                    delete result2;
-                    return;
-                }
+                delete result;
+                SendCharCreateResult(CHAR_CREATE_PVP_TEAMS_VIOLATION);
+                return;
             }
+        }
 
-            // search same race for cinematic or same class if need
-            // TODO: check if cinematic already shown? (already logged in?; cinematic field)
-            while (skipCinematics == CINEMATICS_SKIP_SAME_RACE && !have_same_race)
+        // search same race for cinematic or same class if need
+        // TODO: check if cinematic already shown? (already logged in?; cinematic field)
+        while (skipCinematics == CINEMATICS_SKIP_SAME_RACE && !have_same_race)
+        {
+            if (!result->NextRow())
             {
-                if (!result2->NextRow())
-                {
-                    break;
-                }
+                break;
+            }
 
-                field = result2->Fetch();
-                acc_race = field[0].GetUInt32();
+            field = result->Fetch();
+            acc_race = field[0].GetUInt32();
 
-                have_same_race = race_ == acc_race;
-            }
-            delete result2;
+            have_same_race = info.race == acc_race;
         }
     }
+    delete result;
 
     Player* pNewChar = new Player(this);
     // Sets the createdTime of the character which is UNIX timestamp
     uint32 createdDate = GetUnixTimeStamp(); // Unix Timestamp in seconds
     pNewChar->SetCreatedDate(createdDate); // TODO get currentTimeStamp for createdTime
 
-    if (!pNewChar->Create(sObjectMgr.GeneratePlayerLowGuid(), name, race_, class_, gender, skin, face, hairStyle, hairColor, facialHair, outfitId))
+    if (!pNewChar->Create(sObjectMgr.GeneratePlayerLowGuid(), info.name, info.race, info.class_, info.gender, info.skin, info.face, info.hairStyle, info.hairColor, info.facialHair, info.outfitId))
     {
         // Player not create (race/class problem?)
         delete pNewChar;
 
-        data << (uint8)CHAR_CREATE_ERROR;
-        SendPacket(&data);
+        SendCharCreateResult(CHAR_CREATE_ERROR);
 
         return;
     }
@@ -541,12 +605,11 @@ void WorldSession::HandleCharCreateOpcode(WorldPacket& recv_data)
     LoginDatabase.PExecute("DELETE FROM `realmcharacters` WHERE `acctid`= '%u' AND `realmid`= '%u'", GetAccountId(), realmID);
     LoginDatabase.PExecute("INSERT INTO `realmcharacters` (`numchars`, `acctid`, `realmid`) VALUES (%u, %u, %u)",  charcount, GetAccountId(), realmID);
 
-    data << (uint8)CHAR_CREATE_SUCCESS;
-    SendPacket(&data);
+    SendCharCreateResult(CHAR_CREATE_SUCCESS, pNewChar->GetSaveCommit());
 
     std::string IP_str = GetRemoteAddress();
-    BASIC_LOG("Account: %d (IP: %s) Create Character:[%s] (guid: %u)", GetAccountId(), IP_str.c_str(), name.c_str(), pNewChar->GetGUIDLow());
-    sLog.outChar("Account: %d (IP: %s) Create Character:[%s] (guid: %u)", GetAccountId(), IP_str.c_str(), name.c_str(), pNewChar->GetGUIDLow());
+    BASIC_LOG("Account: %d (IP: %s) Create Character:[%s] (guid: %u)", GetAccountId(), IP_str.c_str(), info.name.c_str(), pNewChar->GetGUIDLow());
+    sLog.outChar("Account: %d (IP: %s) Create Character:[%s] (guid: %u)", GetAccountId(), IP_str.c_str(), info.name.c_str(), pNewChar->GetGUIDLow());
 
     // Used by Eluna
 #ifdef ENABLE_ELUNA
@@ -657,6 +720,8 @@ void WorldSession::HandlePlayerLoginOpcode(WorldPacket& recv_data)
         return;
     }
 
+    // same shard as the character's saves, so a relog reads what the logout wrote
+    Database::ShardKeyScope shardKey(CharacterDatabase, playerGuid.GetCounter());
     CharacterDatabase.DelayQueryHolder(&chrHandler, &CharacterHandler::HandlePlayerLoginCallback, holder);
 }
 
@@ -852,6 +917,7 @@ void WorldSession::HandlePlayerLogin(LoginQueryHolder* holder)
     }
 
     sObjectAccessor.AddObject(pCurrChar);
+    sPlayerSaveScheduler.AddPlayer(pCurrChar);
     DEBUG_LOG("Player %s added to map %i", pCurrChar->GetName(), pCurrChar->GetMapId());
 
     /* send the player's social lists */
@@ -771,56 +771,67 @@ void WorldSession::SendStablePet(ObjectGuid guid)
 {
     DEBUG_LOG("WORLD: Recv MSG_LIST_STABLED_PETS Send.");
 
-    WorldPacket data(MSG_LIST_STABLED_PETS, 200);           // guess size
-    data << guid;
+    ObjectGuid playerGuid = _player->GetObjectGuid();
 
-    Pet* pet = _player->GetPet();
+    //                                                                0      1     2   3      4      5        6
+    AddQueryCallback(CharacterDatabase.PQueryAsync("SELECT `owner`, `slot`, `id`, `entry`, `level`, `loyalty`, `name` FROM `character_pet` WHERE `owner` = '%u' AND `slot` >= '%u' AND `slot` <= '%u' ORDER BY `slot`",
+        playerGuid.GetCounter(), PET_SAVE_FIRST_STABLE_SLOT, PET_SAVE_LAST_STABLE_SLOT),
+        [this, guid, playerGuid](QueryResult* result)
+    {
+        // logged out (or into another character) meanwhile
+        if (!_player || _player->GetObjectGuid() != playerGuid)
+        {
+            delete result;
+            return;
+        }
 
-    size_t wpos = data.wpos();
-    data << uint8(0);                                       // place holder for slot show number
+        WorldPacket data(MSG_LIST_STABLED_PETS, 200);       // guess size
+        data << guid;
 
-    data << uint8(GetPlayer()->GetStableSlots());
+        Pet* pet = _player->GetPet();
 
-    uint8 num = 0;                                          // counter for place holder
+        size_t wpos = data.wpos();
+        data << uint8(0);                                   // place holder for slot show number
 
-    // not let move dead pet in slot
-    if (pet && pet->IsAlive() && pet->getPetType() == HUNTER_PET)
-    {
-        data << uint32(pet->GetCharmInfo()->GetPetNumber());
-        data << uint32(pet->GetEntry());
-        data << uint32(pet->getLevel());
-        data << pet->GetName();                             // petname
-        data << uint32(pet->GetLoyaltyLevel());             // loyalty
-        data << uint8(0x01);                                // client slot 1 == current pet (0)
-        ++num;
-    }
+        data << uint8(GetPlayer()->GetStableSlots());
 
-    //                                                     0      1     2   3      4      5        6
-    QueryResult* result = CharacterDatabase.PQuery("SELECT `owner`, `slot`, `id`, `entry`, `level`, `loyalty`, `name` FROM `character_pet` WHERE `owner` = '%u' AND `slot` >= '%u' AND `slot` <= '%u' ORDER BY `slot`",
-        _player->GetGUIDLow(), PET_SAVE_FIRST_STABLE_SLOT, PET_SAVE_LAST_STABLE_SLOT);
+        uint8 num = 0;                                      // counter for place holder
 
-    if (result)
-    {
-        do
+        // not let move dead pet in slot
+        if (pet && pet->IsAlive() && pet->getPetType() == HUNTER_PET)
         {
-            Field* fields = result->Fetch();
-
-            data << uint32(fields[2].GetUInt32());          // petnumber
-            data << uint32(fields[3].GetUInt32());          // creature entry
-            data << uint32(fields[4].GetUInt32());          // level
-            data << fields[6].GetString();                  // name
-            data << uint32(fields[5].GetUInt32());          // loyalty
-            data << uint8(fields[1].GetUInt32() + 1);       // slot
-
+            data << uint32(pet->GetCharmInfo()->GetPetNumber());
+            data << uint32(pet->GetEntry());
+            data << uint32(pet->getLevel());
+            data << pet->GetName();                         // petname
+            data << uint32(pet->GetLoyaltyLevel());         // loyalty
+            data << uint8(0x01);                            // client slot 1 == current pet (0)
             ++num;
         }
-        while (result->NextRow());
 
-        delete result;
-    }
+        if (result)
+        {
+            do
+            {
+                Field* fields = result->Fetch();
 
-    data.put<uint8>(wpos, num);                             // set real data to placeholder
-    SendPacket(&data);
+                data << uint32(fields[2].GetUInt32());      // petnumber
+                data << uint32(fields[3].GetUInt32());      // creature entry
+                data << uint32(fields[4].GetUInt32());      // level
+                data << fields[6].GetString();              // name
+                data << uint32(fields[5].GetUInt32());      // loyalty
+                data << uint8(fields[1].GetUInt32() + 1);   // slot
+
+                ++num;
+            }
+            while (result->NextRow());
+
+            delete result;
+        }
+
+        data.put<uint8>(wpos, num);                         // set real data to placeholder
+        SendPacket(&data);
+    });
 }
 
 /**
@@ -209,7 +209,6 @@ void WorldSession::HandlePetitionShowSignOpcode(WorldPacket& recv_data)
     DEBUG_LOG("Received opcode CMSG_PETITION_SHOW_SIGNATURES");
     // recv_data.hexlike();
 
-    uint8 signs = 0;
     ObjectGuid petitionguid;
     recv_data >> petitionguid;                              // petition guid
 
@@ -222,34 +221,34 @@ void WorldSession::HandlePetitionShowSignOpcode(WorldPacket& recv_data)
         return;
     }
 
-    QueryResult* result = CharacterDatabase.PQuery("SELECT `playerguid` FROM `petition_sign` WHERE `petitionguid` = '%u'", petitionguid_low);
+    DEBUG_LOG("CMSG_PETITION_SHOW_SIGNATURES petition: %s", petitionguid.GetString().c_str());
 
-    // result==NULL also correct in case no sign yet
-    if (result)
+    ObjectGuid ownerGuid = _player->GetObjectGuid();
+    AddQueryCallback(CharacterDatabase.PQueryAsync("SELECT `playerguid` FROM `petition_sign` WHERE `petitionguid` = '%u'", petitionguid_low),
+        [this, petitionguid, ownerGuid](QueryResult* result)
     {
-        signs = (uint8)result->GetRowCount();
-    }
+        // result==NULL also correct in case no sign yet
+        uint8 signs = result ? uint8(result->GetRowCount()) : 0;
 
-    DEBUG_LOG("CMSG_PETITION_SHOW_SIGNATURES petition: %s", petitionguid.GetString().c_str());
+        WorldPacket data(SMSG_PETITION_SHOW_SIGNATURES, (8 + 8 + 4 + 1 + signs * 12));
+        data << ObjectGuid(petitionguid);                   // petition guid
+        data << ownerGuid;                                  // owner guid
+        data << uint32(petitionguid.GetCounter());          // guild guid (in mangos always same as GUID_LOPART(petitionguid)
+        data << uint8(signs);                               // sign's count
 
-    WorldPacket data(SMSG_PETITION_SHOW_SIGNATURES, (8 + 8 + 4 + 1 + signs * 12));
-    data << ObjectGuid(petitionguid);                       // petition guid
-    data << _player->GetObjectGuid();                       // owner guid
-    data << uint32(petitionguid_low);                       // guild guid (in mangos always same as GUID_LOPART(petitionguid)
-    data << uint8(signs);                                   // sign's count
-
-    for (uint8 i = 1; i <= signs; ++i)
-    {
-        Field* fields2 = result->Fetch();
-        ObjectGuid signerGuid = ObjectGuid(HIGHGUID_PLAYER, fields2[0].GetUInt32());
+        for (uint8 i = 1; i <= signs; ++i)
+        {
+            Field* fields2 = result->Fetch();
+            ObjectGuid signerGuid = ObjectGuid(HIGHGUID_PLAYER, fields2[0].GetUInt32());
 
-        data << ObjectGuid(signerGuid);                     // Player GUID
-        data << uint32(0);                                  // there 0 ...
+            data << ObjectGuid(signerGuid);                 // Player GUID
+            data << uint32(0);                              // there 0 ...
 
-        result->NextRow();
-    }
-    delete result;
-    SendPacket(&data);
+            result->NextRow();
+        }
+        delete result;
+        SendPacket(&data);
+    });
 }
 
 /**
@@ -280,49 +279,44 @@ void WorldSession::SendPetitionQueryOpcode(ObjectGuid petitionguid)
 {
     uint32 petitionLowGuid = petitionguid.GetCounter();
 
-    ObjectGuid ownerGuid;
-    std::string name = "NO_NAME_FOR_GUID";
-    uint8 signs = 0;
-
-    QueryResult* result = CharacterDatabase.PQuery(
+    AddQueryCallback(CharacterDatabase.PQueryAsync(
             "SELECT `ownerguid`, `name`, "
             "  (SELECT COUNT(`playerguid`) FROM `petition_sign` WHERE `petition_sign`.`petitionguid` = '%u') AS `signs` "
-            "FROM `petition` WHERE `petitionguid` = '%u'", petitionLowGuid, petitionLowGuid);
-
-    if (result)
+            "FROM `petition` WHERE `petitionguid` = '%u'", petitionLowGuid, petitionLowGuid),
+        [this, petitionLowGuid](QueryResult* result)
     {
+        if (!result)
+        {
+            DEBUG_LOG("CMSG_PETITION_QUERY failed for petition (GUID: %u)", petitionLowGuid);
+            return;
+        }
+
         Field* fields = result->Fetch();
-        ownerGuid = ObjectGuid(HIGHGUID_PLAYER, fields[0].GetUInt32());
-        name      = fields[1].GetCppString();
-        signs     = fields[2].GetUInt8();
+        ObjectGuid ownerGuid = ObjectGuid(HIGHGUID_PLAYER, fields[0].GetUInt32());
+        std::string name = fields[1].GetCppString();
         delete result;
-    }
-    else
-    {
-        DEBUG_LOG("CMSG_PETITION_QUERY failed for petition (GUID: %u)", petitionLowGuid);
-        return;
-    }
-
-    WorldPacket data(SMSG_PETITION_QUERY_RESPONSE, (4 + 8 + name.size() + 1 + 2 + 4 * 11));
-    data << uint32(petitionLowGuid);                        // guild/team guid (in mangos always same as GUID_LOPART(petition guid)
-    data << ObjectGuid(ownerGuid);                          // charter owner guid
-    data << name;                                           // name (guild/arena team)
-    data << uint8(0);                                       // CString
-    data << uint32(1);
-    data << uint32(9);
-    data << uint32(9);                                      // bypass client - side limitation, a different value is needed here for each petition
-    data << uint32(0);                                      // 5
-    data << uint32(0);                                      // 6
-    data << uint32(0);                                      // 7
-    data << uint32(0);                                      // 8
-    data << uint32(0);                                      // 9
-    data << uint16(0);                                      // 10 2 bytes field
-    data << uint32(0);                                      // 11
-    data << uint32(0);                                      // 12
-    data << uint32(0);                                      // 13 count of next strings; if 0, no data for strings, only 1 uint32 below
-    // for (int i=0; i<field13; ++i) data << chartSignersName[i];   Probably, names of the petition signers
-    data << uint32(0);
-    SendPacket(&data);
+
+        WorldPacket data(SMSG_PETITION_QUERY_RESPONSE, (4 + 8 + name.size() + 1 + 2 + 4 * 11));
+        data << uint32(petitionLowGuid);                    // guild/team guid (in mangos always same as GUID_LOPART(petition guid)
+        data << ObjectGuid(ownerGuid);                      // charter owner guid
+        data << name;                                       // name (guild/arena team)
+        data << uint8(0);                                   // CString
+        data << uint32(1);
+        data << uint32(9);
+        data << uint32(9);                                  // bypass client - side limitation, a different value is needed here for each petition
+        data << uint32(0);                                  // 5
+        data << uint32(0);                                  // 6
+        data << uint32(0);                                  // 7
+        data << uint32(0);                                  // 8
+        data << uint32(0);                                  // 9
+        data << uint16(0);                                  // 10 2 bytes field
+        data << uint32(0);                                  // 11
+        data << uint32(0);                                  // 12
+        data << uint32(0);                                  // 13 count of next strings; if 0, no data for strings, only 1 uint32 below
+        // for (int i=0; i<field13; ++i) data << chartSignersName[i];   Probably, names of the petition signers
+        data << uint32(0);
+        SendPacket(&data);
+    });
 }
 
 /**
@@ -0,0 +1,190 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2025 MaNGOS <https://www.getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+#include "PlayerSaveScheduler.h"
+
+#include "Log.h"
+#include "ObjectAccessor.h"
+#include "Player.h"
+#include "World.h"
+#include "WorldSession.h"
+
+#include <algorithm>
+
+namespace
+{
+    // a player whose save timer is above this was saved (logout, .save, trade...) since its last turn
+    uint32 RecentlySavedMs(uint32 interval)
+    {
+        return interval / 2;
+    }
+}
+
+PlayerSaveScheduler::PlayerSaveScheduler()
+    : m_enabled(false), m_maxPlayersPerTick(1), m_maxStatementsPerTick(0),
+      m_rotationSize(0), m_credit(0.0), m_clock(0), m_rebuildDelay(0)
+{
+}
+
+void PlayerSaveScheduler::Configure(bool enabled, uint32 maxPlayersPerTick, uint32 maxStatementsPerTick)
+{
+    if (!enabled)
+    {
+        // overdue players pick their own autosave up again in Player::Update
+        m_rotation.clear();
+        m_due.clear();
+        m_rotationSize = 0;
+        m_credit = 0.0;
+        m_rebuildDelay = 0;
+    }
+
+    m_enabled.store(enabled, std::memory_order_relaxed);
+    m_maxPlayersPerTick = std::max(maxPlayersPerTick, 1u);
+    m_maxStatementsPerTick = maxStatementsPerTick;
+}
+
+void PlayerSaveScheduler::StartRotation()
+{
+    std::vector<ObjectGuid> players;
+    sObjectAccessor.DoForAllPlayers([&players](Player* player)
+    {
+        players.push_back(player->GetObjectGuid());
+    });
+
+    // a fixed order keeps each player's turn at the same point of every rotation
+    std::sort(players.begin(), players.end());
+
+    m_rotation.assign(players.begin(), players.end());
+    m_rotationSize = uint32(players.size());
+    m_credit = 0.0;
+}
+
+void PlayerSaveScheduler::AddPlayer(Player* player)
+{
+    if (!IsEnabled())
+    {
+        return;
+    }
+
+    // the randomized first-save timer of a login would read as a recent save and
+    // cost it this turn; it has saved nothing yet, so it is due like anyone else
+    player->SetSaveTimer(std::min(player->GetSaveTimer(), RecentlySavedMs(sWorld.getConfig(CONFIG_UINT32_INTERVAL_SAVE))));
+
+    // a login waits for the rest of this rotation, not for the next rebuild
+    m_rotation.push_back(player->GetObjectGuid());
+    ++m_rotationSize;
+}
+
+void PlayerSaveScheduler::Update(uint32 diff)
+{
+    if (!IsEnabled())
+    {
+        return;
+    }
+
+    uint32 const interval = sWorld.getConfig(CONFIG_UINT32_INTERVAL_SAVE);
+    if (!interval)
+    {
+        return;
+    }
+
+    m_clock += diff;
+    m_rebuildDelay = m_rebuildDelay > diff ? m_rebuildDelay - diff : 0;
+    m_stats.lastTickSaves = 0;
+    m_stats.lastTickStatements = 0;
+
+    // logins join the running rotation, so an idle world needs no rescan before the interval is up
+    if (m_rotation.empty() && m_due.empty() && !m_rebuildDelay)
+    {
+        StartRotation();
+        m_rebuildDelay = interval;
+    }
+
+    // hand out turns at rotation size / interval, so a rotation spans one interval
+    m_credit += double(m_rotationSize) * diff / interval;
+    while (m_credit >= 1.0 && !m_rotation.empty())
+    {
+        m_due.push_back(DueEntry{ m_rotation.front(), m_clock, 0 });
+        m_rotation.pop_front();
+        m_credit -= 1.0;
+    }
+    if (m_rotation.empty())
+    {
+        m_credit = 0.0;
+    }
+
+    // players saved by logout, .save, trades etc. since their last turn wait for the next rotation
+    uint32 const recentlySaved = RecentlySavedMs(interval);
+    m_due.erase(std::remove_if(m_due.begin(), m_due.end(), [this, recentlySaved](DueEntry& entry)
+    {
+        Player* player = sObjectAccessor.FindPlayer(entry.guid, false);
+        if (!player || player->GetSession()->isLogingOut() || player->GetSaveTimer() > recentlySaved)
+        {
+            ++m_stats.skipped;
+            return true;
+        }
+
+        // unsaved state first; one point per second waited keeps a clean player from starving
+        entry.score = player->GetPendingSaveWork() + (m_clock - entry.since) / IN_MILLISECONDS;
+        return false;
+    }), m_due.end());
+
+    std::stable_sort(m_due.begin(), m_due.end(), [](DueEntry const& a, DueEntry const& b)
+    {
+        return a.score > b.score;
+    });
+
+    bool const fullSave = !sWorld.getConfig(CONFIG_BOOL_PLAYER_SAVE_DELTA);
+    size_t saved = 0;
+    while (saved < m_due.size())
+    {
+        // the first save of a tick always goes through, so a tight statement budget still makes progress
+        if (saved && (saved >= m_maxPlayersPerTick ||
+                      (m_maxStatementsPerTick && m_stats.lastTickStatements >= m_maxStatementsPerTick)))
+        {
+            ++m_stats.budgetStops;
+            break;
+        }
+
+        Player* player = sObjectAccessor.FindPlayer(m_due[saved].guid, false);
+        uint32 const statements = player->SaveToDB(fullSave);
+        DETAIL_LOG("Player '%s' (GUID: %u) saved by the save scheduler after waiting %u ms",
+                   player->GetName(), player->GetGUIDLow(), m_clock - m_due[saved].since);
+
+        m_stats.lastTickStatements += statements;
+        ++saved;
+    }
+    m_due.erase(m_due.begin(), m_due.begin() + saved);
+
+    m_stats.lastTickSaves = uint32(saved);
+    m_stats.saves += saved;
+    m_stats.statements += m_stats.lastTickStatements;
+    m_stats.rotation = uint32(m_rotation.size());
+    m_stats.due = uint32(m_due.size());
+    m_stats.oldestDueMs = 0;
+    for (DueEntry const& entry : m_due)
+    {
+        m_stats.oldestDueMs = std::max(m_stats.oldestDueMs, m_clock - entry.since);
+    }
+}
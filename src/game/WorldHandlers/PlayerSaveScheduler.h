@@ -0,0 +1,108 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2025 MaNGOS <https://www.getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+#ifndef MANGOS_H_PLAYERSAVESCHEDULER
+#define MANGOS_H_PLAYERSAVESCHEDULER
+
+#include "Common.h"
+#include "ObjectGuid.h"
+#include "Policies/Singleton.h"
+
+#include <atomic>
+#include <deque>
+#include <vector>
+
+class Player;
+
+/**
+ * @brief Paces player autosaves across the save interval (see PlayerSave.Scheduler).
+ *
+ * Online players are walked in a fixed guid order, a rotation per
+ * PlayerSave.Interval, so autosaves land evenly on every tick instead of in
+ * waves behind a login burst. A player logging in joins the end of the
+ * running rotation. Players whose turn has come wait in the due list; each
+ * tick saves the ones with the most unsaved state first, up to the per-tick
+ * player and statement budget, and carries the rest over.
+ *
+ * Runs on the world thread after the maps have updated, so it never races
+ * Player::Update.
+ */
+class PlayerSaveScheduler : public MaNGOS::Singleton<PlayerSaveScheduler>
+{
+    friend class MaNGOS::Singleton<PlayerSaveScheduler>;
+
+public:
+    struct Stats
+    {
+        uint32 rotation = 0;                                ///< players still ahead in this rotation
+        uint32 due = 0;                                     ///< players whose turn came but are not saved yet
+        uint32 oldestDueMs = 0;                             ///< longest wait in the due list
+        uint32 lastTickSaves = 0;
+        uint32 lastTickStatements = 0;
+        uint64 saves = 0;
+        uint64 statements = 0;
+        uint64 skipped = 0;                                 ///< turns dropped: saved elsewhere since, or logged out
+        uint64 budgetStops = 0;                             ///< ticks that left due players for the next tick
+    };
+
+    void Configure(bool enabled, uint32 maxPlayersPerTick, uint32 maxStatementsPerTick);
+    bool IsEnabled() const { return m_enabled.load(std::memory_order_relaxed); }
+
+    /// World thread, once per tick after sMapMgr.Update.
+    void Update(uint32 diff);
+
+    /// World thread, when a player enters the world.
+    void AddPlayer(Player* player);
+
+    Stats GetStats() const { return m_stats; }
+
+private:
+    struct DueEntry
+    {
+        ObjectGuid guid;
+        uint32 since;                                       ///< m_clock when the turn came
+        uint32 score;
+    };
+
+    PlayerSaveScheduler();
+
+    void StartRotation();
+
+    std::atomic<bool> m_enabled;
+    uint32 m_maxPlayersPerTick;
+    uint32 m_maxStatementsPerTick;
+
+    std::deque<ObjectGuid> m_rotation;
+    uint32 m_rotationSize;                                  ///< players the rotation started with, sets the pace
+    double m_credit;                                        ///< turns earned but not handed out yet
+    std::vector<DueEntry> m_due;
+    uint32 m_clock;
+    uint32 m_rebuildDelay;                                  ///< ms before an empty rotation may be rebuilt
+
+    Stats m_stats;
+};
+
+#define sPlayerSaveScheduler MaNGOS::Singleton<PlayerSaveScheduler>::Instance()
+
+#endif
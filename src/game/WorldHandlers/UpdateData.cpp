@@ -32,7 +32,8 @@
  * Features:
  * - Accumulates object update blocks for batch transmission
  * - Tracks out-of-range objects (visibility removal)
- * - zlib compression for large packets (configurable threshold: 100 bytes)
+ * - zlib compression for large packets (configurable threshold: 100 bytes),
+ *   through one reusable deflate stream per thread
  * - Packed GUID encoding for bandwidth efficiency
  *
  * Packet structure:
@@ -56,6 +57,82 @@
 #include "World.h"
 #include "ObjectGuid.h"
 
+#include <cstring>
+
+namespace
+{
+/**
+ * @brief A deflate stream owned by one thread and reused for every packet it compresses.
+ *
+ * deflateInit() allocates roughly 256KB of window and hash state. Update packets are
+ * built on the map threads, so initialising a fresh stream per packet put that much
+ * allocator traffic on every compressed SMSG_UPDATE_OBJECT. deflateReset() rewinds
+ * the stream without releasing its buffers.
+ */
+class UpdateDeflateStream
+{
+    public:
+        UpdateDeflateStream() : m_level(-1)
+        {
+            std::memset(&m_stream, 0, sizeof(m_stream));
+        }
+
+        ~UpdateDeflateStream()
+        {
+            if (m_level >= 0)
+            {
+                deflateEnd(&m_stream);
+            }
+        }
+
+        /**
+         * @brief Get the stream rewound for a new packet at the given level.
+         * @return The stream, or NULL if zlib could not (re)initialise it.
+         */
+        z_stream* Acquire(int level)
+        {
+            if (m_level == level)
+            {
+                int z_res = deflateReset(&m_stream);
+                if (z_res == Z_OK)
+                {
+                    return &m_stream;
+                }
+
+                sLog.outError("Can't compress update packet (zlib: deflateReset) Error code: %i (%s)", z_res, zError(z_res));
+            }
+
+            // first use on this thread, a reload changed the level, or the reset failed
+            if (m_level >= 0)
+            {
+                deflateEnd(&m_stream);
+                m_level = -1;
+            }
+
+            std::memset(&m_stream, 0, sizeof(m_stream));
+            m_stream.zalloc = (alloc_func)0;
+            m_stream.zfree = (free_func)0;
+            m_stream.opaque = (voidpf)0;
+
+            int z_res = deflateInit(&m_stream, level);
+            if (z_res != Z_OK)
+            {
+                sLog.outError("Can't compress update packet (zlib: deflateInit) Error code: %i (%s)", z_res, zError(z_res));
+                return NULL;
+            }
+
+            m_level = level;
+            return &m_stream;
+        }
+
+    private:
+        z_stream m_stream;
+        int m_level;                                        ///< level m_stream was initialised with, -1 if none
+};
+
+thread_local UpdateDeflateStream t_updateDeflateStream;
+}
+
 /**
  * @brief Construct empty UpdateData
  *
@@ -100,33 +177,27 @@ void UpdateData::AddOutOfRangeGUID(ObjectGuid const& guid)
  *
  * Compresses update data using zlib deflate algorithm.
  * Compression level is controlled by CONFIG_UINT32_COMPRESSION config.
+ * The deflate state is per thread and reused between calls.
  *
  * @note On error, dst_size is set to 0
  * @note Uses Z_BEST_SPEED (level 1) by default for CPU efficiency
  */
 void UpdateData::Compress(void* dst, uint32* dst_size, void* src, int src_size)
 {
-    z_stream c_stream;
-
-    c_stream.zalloc = (alloc_func)0;
-    c_stream.zfree = (free_func)0;
-    c_stream.opaque = (voidpf)0;
-
     // default Z_BEST_SPEED (1)
-    int z_res = deflateInit(&c_stream, sWorld.getConfig(CONFIG_UINT32_COMPRESSION));
-    if (z_res != Z_OK)
+    z_stream* c_stream = t_updateDeflateStream.Acquire(sWorld.getConfig(CONFIG_UINT32_COMPRESSION));
+    if (!c_stream)
     {
-        sLog.outError("Can't compress update packet (zlib: deflateInit) Error code: %i (%s)", z_res, zError(z_res));
         *dst_size = 0;
         return;
     }
 
-    c_stream.next_out = (Bytef*)dst;
-    c_stream.avail_out = *dst_size;
-    c_stream.next_in = (Bytef*)src;
-    c_stream.avail_in = (uInt)src_size;
+    c_stream->next_out = (Bytef*)dst;
+    c_stream->avail_out = *dst_size;
+    c_stream->next_in = (Bytef*)src;
+    c_stream->avail_in = (uInt)src_size;
 
-    z_res = deflate(&c_stream, Z_NO_FLUSH);
+    int z_res = deflate(c_stream, Z_NO_FLUSH);
     if (z_res != Z_OK)
     {
         sLog.outError("Can't compress update packet (zlib: deflate) Error code: %i (%s)", z_res, zError(z_res));
@@ -134,14 +205,14 @@ void UpdateData::Compress(void* dst, uint32* dst_size, void* src, int src_size)
         return;
     }
 
-    if (c_stream.avail_in != 0)
+    if (c_stream->avail_in != 0)
     {
         sLog.outError("Can't compress update packet (zlib: deflate not greedy)");
         *dst_size = 0;
         return;
     }
 
-    z_res = deflate(&c_stream, Z_FINISH);
+    z_res = deflate(c_stream, Z_FINISH);
     if (z_res != Z_STREAM_END)
     {
         sLog.outError("Can't compress update packet (zlib: deflate should report Z_STREAM_END instead %i (%s)", z_res, zError(z_res));
@@ -149,15 +220,7 @@ void UpdateData::Compress(void* dst, uint32* dst_size, void* src, int src_size)
         return;
     }
 
-    z_res = deflateEnd(&c_stream);
-    if (z_res != Z_OK)
-    {
-        sLog.outError("Can't compress update packet (zlib: deflateEnd) Error code: %i (%s)", z_res, zError(z_res));
-        *dst_size = 0;
-        return;
-    }
-
-    *dst_size = c_stream.total_out;
+    *dst_size = c_stream->total_out;
 }
 
 /**
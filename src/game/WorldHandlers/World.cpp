@@ -49,6 +49,8 @@
 #include "SystemConfig.h"
 #include "Log.h"
 #include "OpcodeTable.h"
+#include "OpcodeStats.h"
+#include "PlayerSaveScheduler.h"
 #include "WorldSession.h"
 #include "WorldPacket.h"
 #include "Player.h"
@@ -97,6 +99,7 @@
 #include "UpdateTime.h"
 #include "GameTime.h"
 #include "ScheduledExit.h"
+#include "Threading/TaskGraph.h"
 
 #ifdef ENABLE_ELUNA
 #include "LuaEngine.h"
@@ -123,7 +126,10 @@
 #include "AuctionHouseBot/MutationPending.h"
 #include "PlayerMutations.h"
 
+#include <algorithm>
 #include <cstdarg>
+#include <functional>
+#include <initializer_list>
 #include <iostream>
 #include <sstream>
 #include <vector>
@@ -184,6 +190,85 @@ namespace
 
         return 0;
     }
+
+    /**
+     * @brief Startup loads declared with their dependencies (see StartupLoadThreads).
+     *
+     * With one thread every load is an ordinary startup step, in the order it
+     * was added. With more, independent loads overlap on a pool of workers,
+     * each pinned to its own world database connection, and the phase ends
+     * with a timeline of what ran side by side.
+     */
+    class StartupLoads
+    {
+        public:
+            explicit StartupLoads(uint32 threads) : m_threads(threads) {}
+
+            /**
+             * @brief add a load
+             *
+             * @param text the step line, as for StartupUI::Step()
+             * @param work
+             * @param after loads that must have finished first
+             * @return uint32 the load's id, for the dependencies of later loads
+             */
+            uint32 Add(char const* text, std::function<void()> work, std::initializer_list<uint32> after = {})
+            {
+                uint32 const id = uint32(m_timeline.size());
+
+                StartupUI::TimelineEntry entry;
+                entry.text = text;
+                entry.worker = 0;
+                entry.startMs = 0;
+                entry.durationMs = 0;
+                entry.rows = 0;
+                entry.rowsKnown = false;
+                m_timeline.push_back(entry);
+
+                m_graph.Add(text, [this, id, work](uint32 worker)
+                {
+                    if (m_threads <= 1)
+                    {
+                        StartupUI::Step(m_timeline[id].text);
+                        work();
+                        return;
+                    }
+
+                    Database::QueryConnectionScope pin(WorldDatabase, worker);
+                    StartupUI::ConcurrentStep(m_timeline[id].text);
+                    work();
+                    m_timeline[id].rowsKnown = StartupUI::ConcurrentStepRows(m_timeline[id].rows);
+                }, after);
+
+                return id;
+            }
+
+            void Run()
+            {
+                if (m_threads <= 1)
+                {
+                    m_graph.Run(1);
+                    return;
+                }
+
+                StartupUI::BeginConcurrent();
+                m_graph.Run(m_threads, [](uint32) { WorldDatabase.ThreadStart(); }, [](uint32) { WorldDatabase.ThreadEnd(); });
+
+                std::vector<MaNGOS::TaskGraph::Report> const& reports = m_graph.GetReports();
+                for (size_t i = 0; i < reports.size(); ++i)
+                {
+                    m_timeline[i].worker = reports[i].worker;
+                    m_timeline[i].startMs = reports[i].startMs;
+                    m_timeline[i].durationMs = reports[i].durationMs;
+                }
+                StartupUI::EndConcurrent(m_timeline, m_graph.GetElapsedMs());
+            }
+
+        private:
+            MaNGOS::TaskGraph m_graph;
+            std::vector<StartupUI::TimelineEntry> m_timeline;
+            uint32 m_threads;
+    };
 }
 
 /**
@@ -245,7 +330,10 @@ World::World()
     // PF3-A: single-threaded construction; relaxed is sufficient here. The
     // release/acquire pairing happens later between SetAhSupervisor() and the
     // world tick loop.
-    m_ahSupervisor.store(NULL, std::memory_order_relaxed);
+    for (uint8 g = 0; g < AH_HOUSE_GROUP_COUNT; ++g)
+    {
+        m_ahSupervisor[g].store(NULL, std::memory_order_relaxed);
+    }
     m_ahServiceConfigured.store(false, std::memory_order_relaxed);
 }
 
@@ -440,7 +528,7 @@ void World::SetInitialWorldSettings()
 
     ///- Load the DBC files
     StartupUI::Step("Initialize DBC data stores...");
-    LoadDBCStores(m_dataPath);
+    LoadDBCStores(m_dataPath, getConfig(CONFIG_UINT32_STARTUP_LOAD_THREADS));
     DetectDBCLang();
     sObjectMgr.SetDBCLocaleIndex(GetDefaultDbcLocale());    // Get once for all the locale index of DBC language (console/broadcasts)
 
@@ -489,99 +577,87 @@ void World::SetInitialWorldSettings()
 
     StartupUI::BeginPhase("World data");
 
-    StartupUI::Step("Loading Page Texts...");
-    sObjectMgr.LoadPageTexts();
+    ///- Template and spell data: each load names the loads it reads, so independent ones can overlap
+    uint32 const loadThreads = std::min(getConfig(CONFIG_UINT32_STARTUP_LOAD_THREADS), WorldDatabase.GetQueryConnectionCount());
+    if (loadThreads > 1)
+    {
+        sLog.outString("Loading template and spell data on %u threads", loadThreads);
+    }
 
-    StartupUI::Step("Loading Game Object Templates...");     // must be after LoadPageTexts
-    sObjectMgr.LoadGameobjectInfo();
+    StartupLoads loads(loadThreads);
 
-    StartupUI::Step("Loading GameObject models...");
-    LoadGameObjectModelList();
-    sLog.outString();
+    uint32 const pageTexts = loads.Add("Loading Page Texts...", []() { sObjectMgr.LoadPageTexts(); });
+
+    uint32 const goTemplates = loads.Add("Loading Game Object Templates...", []() { sObjectMgr.LoadGameobjectInfo(); }, { pageTexts });
+
+    loads.Add("Loading GameObject models...", []()
+    {
+        LoadGameObjectModelList();
+        sLog.outString();
+    });
+
+    // the spell tables only fill their own SpellMgr maps; the ones that resolve ranks
+    // (SpellRankHelper, GetFirstSpellInChain, doForHighRanks) read the chains
+    uint32 const spellChains = loads.Add("Loading Spell Chain Data...", []() { sSpellMgr.LoadSpellChains(); });
 
-    StartupUI::Step("Loading Spell Chain Data...");
-    sSpellMgr.LoadSpellChains();
+    loads.Add("Loading Spell Elixir types...", []() { sSpellMgr.LoadSpellElixirs(); });
 
-    StartupUI::Step("Loading Spell Elixir types...");
-    sSpellMgr.LoadSpellElixirs();
+    loads.Add("Loading Spell Facing Flags...", []() { sSpellMgr.LoadFacingCasterFlags(); });
 
-    StartupUI::Step("Loading Spell Facing Flags...");
-    sSpellMgr.LoadFacingCasterFlags();
+    loads.Add("Loading Spell Learn Skills...", []() { sSpellMgr.LoadSpellLearnSkills(); }, { spellChains });
 
-    StartupUI::Step("Loading Spell Learn Skills...");
-    sSpellMgr.LoadSpellLearnSkills();                       // must be after LoadSpellChains
+    loads.Add("Loading Spell Learn Spells...", []() { sSpellMgr.LoadSpellLearnSpells(); });
 
-    StartupUI::Step("Loading Spell Learn Spells...");
-    sSpellMgr.LoadSpellLearnSpells();
+    loads.Add("Loading Spell Proc Event conditions...", []() { sSpellMgr.LoadSpellProcEvents(); }, { spellChains });
 
-    StartupUI::Step("Loading Spell Proc Event conditions...");
-    sSpellMgr.LoadSpellProcEvents();
+    loads.Add("Loading Spell Bonus Data...", []() { sSpellMgr.LoadSpellBonuses(); }, { spellChains });
 
-    StartupUI::Step("Loading Spell Bonus Data...");
-    sSpellMgr.LoadSpellBonuses();
+    loads.Add("Loading Spell Proc Item Enchant...", []() { sSpellMgr.LoadSpellProcItemEnchant(); }, { spellChains });
 
-    StartupUI::Step("Loading Spell Proc Item Enchant...");
-    sSpellMgr.LoadSpellProcItemEnchant();                   // must be after LoadSpellChains
+    loads.Add("Loading Spell Linked definitions...", []() { sSpellMgr.LoadSpellLinked(); }, { spellChains });
 
-    StartupUI::Step("Loading Spell Linked definitions...");
-    sSpellMgr.LoadSpellLinked();                            // must be after LoadSpellChains
+    loads.Add("Loading Aggro Spells Definitions...", []() { sSpellMgr.LoadSpellThreats(); }, { spellChains });
 
-    StartupUI::Step("Loading Aggro Spells Definitions...");
-    sSpellMgr.LoadSpellThreats();
+    loads.Add("Loading NPC Texts...", []() { sObjectMgr.LoadGossipText(); });
 
-    StartupUI::Step("Loading NPC Texts...");
-    sObjectMgr.LoadGossipText();
+    uint32 const randomEnchants = loads.Add("Loading Item Random Enchantments Table...", []() { LoadRandomEnchantmentsTable(); });
 
-    StartupUI::Step("Loading Item Random Enchantments Table...");
-    LoadRandomEnchantmentsTable();
+    uint32 const disables = loads.Add("Loading Disables...", []() { DisableMgr::LoadDisables(); });
 
-    StartupUI::Step("Loading Disables...");                  // must be before loading quests and items
-    DisableMgr::LoadDisables();
+    uint32 const items = loads.Add("Loading Item Templates...", []() { sObjectMgr.LoadItemPrototypes(); },
+                                   { randomEnchants, pageTexts, disables });
 
-    StartupUI::Step("Loading Item Templates...");            // must be after LoadRandomEnchantmentsTable and LoadPageTexts
-    sObjectMgr.LoadItemPrototypes();
+    uint32 const modelInfo = loads.Add("Loading Creature Model Based Info Data...", []() { sObjectMgr.LoadCreatureModelInfo(); });
 
-    StartupUI::Step("Loading Creature Model Based Info Data...");
-    sObjectMgr.LoadCreatureModelInfo();
+    uint32 const creatureItems = loads.Add("Loading Creature Items...", []() { sObjectMgr.LoadCreatureItemTemplates(); });
 
-    StartupUI::Step("Loading Creature Items...");
-    sObjectMgr.LoadCreatureItemTemplates();
+    uint32 const equipment = loads.Add("Loading Equipment templates...", []() { sObjectMgr.LoadEquipmentTemplates(); }, { creatureItems });
 
-    StartupUI::Step("Loading Equipment templates...");
-    sObjectMgr.LoadEquipmentTemplates();
+    uint32 const creatureStats = loads.Add("Loading Creature Stats...", []() { sObjectMgr.LoadCreatureClassLvlStats(); });
 
-    StartupUI::Step("Loading Creature Stats...");
-    sObjectMgr.LoadCreatureClassLvlStats();
+    uint32 const creatureTemplates = loads.Add("Loading Creature templates...", []() { sObjectMgr.LoadCreatureTemplates(); },
+                                               { modelInfo, creatureItems, equipment, creatureStats });
 
-    StartupUI::Step("Loading Creature templates...");
-    sObjectMgr.LoadCreatureTemplates();
+    loads.Add("Loading Creature template spells...", []() { sObjectMgr.LoadCreatureTemplateSpells(); }, { creatureTemplates });
 
-    StartupUI::Step("Loading Creature template spells...");
-    sObjectMgr.LoadCreatureTemplateSpells();
+    loads.Add("Loading Creature spells...", []() { sObjectMgr.LoadCreatureSpells(); });
 
-    StartupUI::Step("Loading Creature spells...");
-    sObjectMgr.LoadCreatureSpells();
+    uint32 const scriptTargets = loads.Add("Loading SpellsScriptTarget...", []() { sSpellMgr.LoadSpellScriptTarget(); },
+                                           { creatureTemplates, goTemplates });
 
-    StartupUI::Step("Loading SpellsScriptTarget...");
-    sSpellMgr.LoadSpellScriptTarget();                      // must be after LoadCreatureTemplates and LoadGameobjectInfo
+    loads.Add("Loading ItemRequiredTarget...", []() { sObjectMgr.LoadItemRequiredTarget(); }, { items, creatureTemplates, scriptTargets });
 
-    StartupUI::Step("Loading ItemRequiredTarget...");
-    sObjectMgr.LoadItemRequiredTarget();
+    loads.Add("Loading Reputation Reward Rates...", []() { sObjectMgr.LoadReputationRewardRate(); });
 
-    StartupUI::Step("Loading Reputation Reward Rates...");
-    sObjectMgr.LoadReputationRewardRate();
+    loads.Add("Loading Creature Reputation OnKill Data...", []() { sObjectMgr.LoadReputationOnKill(); }, { creatureTemplates });
 
-    StartupUI::Step("Loading Creature Reputation OnKill Data...");
-    sObjectMgr.LoadReputationOnKill();
+    loads.Add("Loading Reputation Spillover Data...", []() { sObjectMgr.LoadReputationSpilloverTemplate(); });
 
-    StartupUI::Step("Loading Reputation Spillover Data...");
-    sObjectMgr.LoadReputationSpilloverTemplate();
+    loads.Add("Loading Points Of Interest Data...", []() { sObjectMgr.LoadPointsOfInterest(); });
 
-    StartupUI::Step("Loading Points Of Interest Data...");
-    sObjectMgr.LoadPointsOfInterest();
+    loads.Add("Loading Pet Create Spells...", []() { sObjectMgr.LoadPetCreateSpells(); }, { creatureTemplates });
 
-    StartupUI::Step("Loading Pet Create Spells...");
-    sObjectMgr.LoadPetCreateSpells();
+    loads.Run();
 
     StartupUI::Step("Loading Creature Data...");
     sObjectMgr.LoadCreatures();
@@ -993,6 +1069,10 @@ void World::SetInitialWorldSettings()
              (startupDuration / 60000), ((startupDuration % 60000) / 1000));
     StartupUI::LogOnly(startupLine);
 
+    snprintf(startupLine, sizeof(startupLine), "Startup memory: peak resident %u MB, %u MB now",
+             uint32(GetPeakResidentMemory() / (1024 * 1024)), uint32(GetResidentMemory() / (1024 * 1024)));
+    StartupUI::LogOnly(startupLine);
+
     showFooter(startupDuration);
 
     ///- World initialization is over: drop the console hooks, so no runtime log
@@ -1238,13 +1318,44 @@ void World::Update(uint32 diff)
     /// <li> Handle AHBot operations
     if (m_timers[WUPDATE_AHBOT].Passed())
     {
-        // PF3-A: acquire-load the published supervisor pointer once. The
-        // matching release store in SetAhSupervisor() guarantees the
+        // PF3-A: acquire-load the published supervisor pointers once. The
+        // matching release store in SetAhSupervisor() guarantees each
         // supervisor's construction + Start() is fully visible before any
         // non-NULL pointer can be observed here.
-        WorkerSupervisor* const ahSupervisor = GetAhSupervisor();
-        const bool serviceActive =
-            (ahSupervisor != NULL && ahSupervisor->ServiceActive());
+        std::vector<WorkerSupervisor*> ahShards;
+        GetAhSupervisors(ahShards);
+
+        // The in-process bot stands down while ANY worker is active: it has
+        // no notion of house shards, and resuming it for one failed shard
+        // would double-write the houses the live shards still own.
+        bool serviceActive = false;
+        for (size_t shard = 0; shard < ahShards.size(); ++shard)
+        {
+            WorkerSupervisor* const ahSupervisor = ahShards[shard];
+            AhShardWatch& watch = AhWatchFor(ahSupervisor);
+            const bool shardActive = ahSupervisor->ServiceActive();
+            if (shardActive != watch.prevActive)
+            {
+                if (ahShards.size() > 1)
+                {
+                    sLog.outString("[AHSupervisor] AH worker for %s %s",
+                                   AhHouseMaskName(ahSupervisor->Houses()).c_str(),
+                                   shardActive ? "active" : "inactive");
+                }
+                if (shardActive)
+                {
+                    // SP-2 (spec 8): on the just-became-active edge, reconcile
+                    // every in-flight player-mutation reservation of this
+                    // worker's houses against the shared worker journal
+                    // (committed => finalize-forward, absent => release,
+                    // cancel-prepared => abort + release). No-op when nothing
+                    // is in-flight (the default-off / steady-state case).
+                    AhReconcileOnReconnect(ahSupervisor->Houses());
+                }
+                watch.prevActive = shardActive;
+            }
+            serviceActive = serviceActive || shardActive;
+        }
 
         /// Transition logging: announce each time the in-process bot stands
         /// down for / resumes from the out-of-process service.
@@ -1255,12 +1366,6 @@ void World::Update(uint32 diff)
             {
                 sLog.outString("[AHSupervisor] AH service active -"
                                " in-process AuctionHouseBot standing down");
-                // SP-2 (spec 8): on the just-became-active edge, reconcile every
-                // in-flight player-mutation reservation against the shared worker
-                // journal (committed => finalize-forward, absent => release,
-                // cancel-prepared => abort + release). No-op when nothing is
-                // in-flight (the default-off / steady-state case).
-                AhReconcileOnReconnect();
             }
             else
             {
@@ -1324,53 +1429,64 @@ void World::Update(uint32 diff)
         m_timers[WUPDATE_AHBOT].Reset();
     }
 
-    /// <li> Tick the AH subprocess supervisor and drain inbound frames
-    // PF3-A: acquire-load the published supervisor pointer once for this whole
-    // block (see SetAhSupervisor()). Reusing one local keeps every dereference
-    // below consistent and avoids repeated atomic loads.
-    WorkerSupervisor* const ahSupervisor = GetAhSupervisor();
-    if (ahSupervisor != NULL)
-    {
-        // Tick() uses wall-clock deltas internally; do NOT gate behind
-        // WUPDATE_AHBOT. Tick() drives heartbeat/restart/protocol and MUST run
-        // every tick regardless of service health (it is what transitions the
-        // service from inactive back to active).
-        ahSupervisor->Tick(GetGameTime());
-
-        // Overflow visibility: warn (rate-limited) when the inbound queue
-        // has dropped frames since we last checked.
-        static size_t s_lastDroppedSeen = 0;
-        static time_t s_lastOverflowWarn = 0;
-        static time_t s_lastNearFullWarn = 0;
-        const size_t  dropped = ahSupervisor->InboundDropped();
-        if (dropped > s_lastDroppedSeen)
+    /// <li> Tick the AH subprocess supervisors and drain inbound frames
+    // PF3-A: acquire-load the published supervisor pointers once for this whole
+    // block (see SetAhSupervisor()). Reusing one list keeps every dereference
+    // below consistent and avoids repeated atomic loads. There is one entry per
+    // worker: one, unless AH.Service.Shards splits the houses.
+    std::vector<WorkerSupervisor*> ahShards;
+    GetAhSupervisors(ahShards);
+    if (!ahShards.empty())
+    {
+        bool anyShardActive = false;
+        for (size_t shard = 0; shard < ahShards.size(); ++shard)
         {
-            const time_t now = time(NULL);
-            // Warn at most once every 60 seconds to avoid log spam.
-            // Baseline only advances on emission so suppressed bursts are
-            // counted correctly in the next warning.
-            if (now - s_lastOverflowWarn >= 60)
+            WorkerSupervisor* const ahSupervisor = ahShards[shard];
+            AhShardWatch& watch = AhWatchFor(ahSupervisor);
+
+            // Tick() uses wall-clock deltas internally; do NOT gate behind
+            // WUPDATE_AHBOT. Tick() drives heartbeat/restart/protocol and MUST
+            // run every tick regardless of service health (it is what
+            // transitions the service from inactive back to active).
+            ahSupervisor->Tick(GetGameTime());
+
+            // Overflow visibility: warn (rate-limited) when the inbound queue
+            // has dropped frames since we last checked.
+            const size_t dropped = ahSupervisor->InboundDropped();
+            if (dropped > watch.lastDroppedSeen)
             {
-                sLog.outError("[AHSupervisor] inbound queue overflow:"
-                              " %u frame(s) dropped (total %u)",
-                              static_cast<unsigned>(dropped - s_lastDroppedSeen),
-                              static_cast<unsigned>(dropped));
-                s_lastOverflowWarn = now;
-                s_lastDroppedSeen  = dropped;
+                const time_t now = time(NULL);
+                // Warn at most once every 60 seconds to avoid log spam.
+                // Baseline only advances on emission so suppressed bursts are
+                // counted correctly in the next warning.
+                if (now - watch.lastOverflowWarn >= 60)
+                {
+                    sLog.outError("[AHSupervisor] inbound queue overflow (%s):"
+                                  " %u frame(s) dropped (total %u)",
+                                  AhHouseMaskName(ahSupervisor->Houses()).c_str(),
+                                  static_cast<unsigned>(dropped - watch.lastDroppedSeen),
+                                  static_cast<unsigned>(dropped));
+                    watch.lastOverflowWarn = now;
+                    watch.lastDroppedSeen  = dropped;
+                }
             }
-        }
 
-        // The apply loop (DrainInbound + HandleAhInbound) and the near-full
-        // back-pressure check are gated on service health. When the service is
-        // inactive (crash / heartbeat-timeout / stand-down) the in-process
-        // AuctionHouseBot resumes (see the WUPDATE_AHBOT block above); applying
-        // the dead child's last staged batch at the same time would over-post
-        // against the resumed in-process bot. WorkerSupervisor clears its
-        // staged frames on child exit, so a reconnecting child never replays
-        // the dead child's stale batch; this gate is the second guard.
-        if (ahSupervisor->ServiceActive())
-        {
-            // Drain up to 256 application frames per tick.
+            // The apply loop (DrainInbound + HandleAhInbound) and the near-full
+            // back-pressure check are gated on service health. When the service
+            // is inactive (crash / heartbeat-timeout / stand-down) the
+            // in-process AuctionHouseBot may resume (see the WUPDATE_AHBOT block
+            // above); applying the dead child's last staged batch at the same
+            // time would over-post against the resumed in-process bot.
+            // WorkerSupervisor clears its staged frames on child exit, so a
+            // reconnecting child never replays the dead child's stale batch;
+            // this gate is the second guard.
+            if (!ahSupervisor->ServiceActive())
+            {
+                continue;
+            }
+            anyShardActive = true;
+
+            // Drain up to 256 application frames per tick from each worker.
             std::vector<IpcMessage> msgs;
             ahSupervisor->DrainInbound(msgs, 256);
 
@@ -1382,10 +1498,11 @@ void World::Update(uint32 diff)
             if (qSize >= IPC_INBOUND_QUEUE_CAP * 4 / 5)
             {
                 const time_t now = time(NULL);
-                if (now - s_lastNearFullWarn >= 60)
+                if (now - watch.lastNearFullWarn >= 60)
                 {
-                    sLog.outError("[AHSupervisor] inbound queue near full:"
+                    sLog.outError("[AHSupervisor] inbound queue near full (%s):"
                                   " %u / %u frames - sending IPC_QUEUE_FULL",
+                                  AhHouseMaskName(ahSupervisor->Houses()).c_str(),
                                   static_cast<unsigned>(qSize),
                                   static_cast<unsigned>(IPC_INBOUND_QUEUE_CAP));
 
@@ -1396,15 +1513,18 @@ void World::Update(uint32 diff)
                     qf.op = IPC_QUEUE_FULL;
                     ahSupervisor->Channel().SendFrame(qf);
 
-                    s_lastNearFullWarn = now;
+                    watch.lastNearFullWarn = now;
                 }
             }
 
             for (size_t i = 0; i < msgs.size(); ++i)
             {
-                HandleAhInbound(msgs[i]);
+                HandleAhInbound(msgs[i], ahSupervisor);
             }
+        }
 
+        if (anyShardActive)
+        {
             // SP-2: retry failed value-finalizes and age un-answered player
             // mutations into in-doubt tombstones (forward-only; never rolls
             // back). Cheap no-op when both queues are empty.
@@ -1479,6 +1599,9 @@ void World::Update(uint32 diff)
     }
 #endif /* ENABLE_ELUNA */
 
+    ///- Autosave the players whose turn has come, within this tick's save budget
+    sPlayerSaveScheduler.Update(diff);
+
     ///- Delete all characters which have been deleted X days before
     if (m_timers[WUPDATE_DELETECHARS].Passed())
     {
@@ -1532,6 +1655,51 @@ void World::Update(uint32 diff)
 
     // cleanup unused GridMap objects as well as VMaps
     sTerrainMgr.Update(diff);
+
+    ///- Fold this tick's per-thread opcode counters into the totals
+    sOpcodeStats.Update(diff);
+
+    ///- Every map and world system has produced this tick's packets: write each
+    ///- session's corked output to its socket in one go and release shaped output
+    if (getConfig(CONFIG_BOOL_NETWORK_CORK_OUTPUT) || getConfig(CONFIG_BOOL_NETWORK_SHAPE_OUTPUT))
+    {
+        for (SessionMap::const_iterator itr = m_sessions.begin(); itr != m_sessions.end(); ++itr)
+        {
+            itr->second->FlushPackets();
+        }
+    }
+}
+
+void World::GetAhSupervisors(std::vector<WorkerSupervisor*>& out) const
+{
+    out.clear();
+    for (uint8 g = 0; g < AH_HOUSE_GROUP_COUNT; ++g)
+    {
+        WorkerSupervisor* const sv = GetAhSupervisor(g);
+        if (sv != NULL && std::find(out.begin(), out.end(), sv) == out.end())
+        {
+            out.push_back(sv);
+        }
+    }
+}
+
+World::AhShardWatch& World::AhWatchFor(WorkerSupervisor* sv)
+{
+    for (size_t i = 0; i < m_ahShardWatch.size(); ++i)
+    {
+        if (m_ahShardWatch[i].sv == sv)
+        {
+            return m_ahShardWatch[i];
+        }
+    }
+    AhShardWatch watch;
+    watch.sv               = sv;
+    watch.prevActive       = false;
+    watch.lastDroppedSeen  = 0;
+    watch.lastOverflowWarn = 0;
+    watch.lastNearFullWarn = 0;
+    m_ahShardWatch.push_back(watch);
+    return m_ahShardWatch.back();
 }
 
 // ---------------------------------------------------------------------------
@@ -1545,7 +1713,7 @@ void World::Update(uint32 diff)
  * is live. M2 will add IPC_AH_* intent routing here; keep the switch
  * extensible.
  */
-void World::HandleAhInbound(const IpcMessage& msg)
+void World::HandleAhInbound(const IpcMessage& msg, WorkerSupervisor* source)
 {
     switch (msg.op)
     {
@@ -1573,12 +1741,10 @@ void World::HandleAhInbound(const IpcMessage& msg)
             // empty -- op 0 -- for a malformed body, which we must not send).
             IpcMessage result;
             sAuctionIntentExecutor.Apply(msg, result);
-            // PF3-A: acquire-load the published supervisor pointer (see
-            // SetAhSupervisor()) before dereferencing it.
-            WorkerSupervisor* const ahSupervisor = GetAhSupervisor();
-            if (ahSupervisor != NULL && result.op != IpcOpcode(0))
+            // The result goes back to the worker that sent the intent.
+            if (source != NULL && result.op != IpcOpcode(0))
             {
-                ahSupervisor->Channel().SendFrame(result);
+                source->Channel().SendFrame(result);
             }
             break;
         }
@@ -1725,6 +1891,24 @@ void World::HandleAhInbound(const IpcMessage& msg)
             AhHandlePlayerMutationResult(res);
             break;
         }
+        case IPC_PLAYER_RESULT_BATCH:
+        {
+            // The replies of one worker group commit: the records were
+            // committed together, so apply them in one pass, in commit order.
+            // One frame counts once against the per-tick drain budget.
+            ByteBuffer body(msg.body);
+            PlayerMutationResultBatch batch;
+            if (!batch.Decode(body))
+            {
+                sLog.outError("[AHSupervisor] IPC_PLAYER_RESULT_BATCH decode failed");
+                break;
+            }
+            for (size_t i = 0; i < batch.results.size(); ++i)
+            {
+                AhHandlePlayerMutationResult(batch.results[i]);
+            }
+            break;
+        }
         case IPC_RESOLVE_APPLY:
         {
             // SP-2 write-authority: worker-initiated resolution (WON / EXPIRED /
@@ -1745,8 +1929,8 @@ void World::HandleAhInbound(const IpcMessage& msg)
             {
                 break;
             }
-            WorkerSupervisor* const sv = GetAhSupervisor();
-            if (sv != NULL)
+            // The ack goes back to the worker tracking the resolution.
+            if (source != NULL)
             {
                 ResolveAck ack;
                 ack.uuid   = ra.uuid;
@@ -1754,7 +1938,7 @@ void World::HandleAhInbound(const IpcMessage& msg)
                 IpcMessage reply;
                 reply.op = IPC_RESOLVE_ACK;
                 ack.Encode(reply.body);
-                sv->Channel().SendFrame(reply);
+                source->Channel().SendFrame(reply);
             }
             break;
         }
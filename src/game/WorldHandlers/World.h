@@ -37,6 +37,7 @@
 #include "SharedDefines.h"
 #include "AuctionHouseBot/BrowsePending.h"
 #include "AuctionHouseBot/MutationPending.h"
+#include "AhHouseShards.h"
 #include <set>
 #include <list>
 #include <vector>
@@ -200,6 +201,7 @@ enum eConfigUInt32Values
     CONFIG_UINT32_CHARDELETE_METHOD,
     CONFIG_UINT32_CHARDELETE_MIN_LEVEL,
     CONFIG_UINT32_NUMTHREADS,
+    CONFIG_UINT32_STARTUP_LOAD_THREADS,
     CONFIG_UINT32_GUID_RESERVE_SIZE_CREATURE,
     CONFIG_UINT32_GUID_RESERVE_SIZE_GAMEOBJECT,
     CONFIG_UINT32_CREATURE_RESPAWN_AGGRO_DELAY,
@@ -219,6 +221,14 @@ enum eConfigUInt32Values
     CONFIG_UINT32_PLAYERBOT_MINBOTLEVEL,
 #endif
     CONFIG_UINT32_AUTOBROADCAST_INTERVAL,
+    CONFIG_UINT32_NETWORK_CORK_FLUSH_BYTES,
+    CONFIG_UINT32_NETWORK_SHAPE_BACKLOG_BYTES,
+    CONFIG_UINT32_NETWORK_SHAPE_TICK_BYTES,
+    CONFIG_UINT32_OPCODE_STATS_DUMP_INTERVAL,
+    CONFIG_UINT32_DB_SLOW_QUERY_MS,
+    CONFIG_UINT32_DB_SYNC_QUERY_CHECK,
+    CONFIG_UINT32_PLAYER_SAVE_TICK_PLAYERS,
+    CONFIG_UINT32_PLAYER_SAVE_TICK_STATEMENTS,
     CONFIG_UINT32_VALUE_COUNT
 };
 
@@ -358,7 +368,13 @@ enum eConfigBoolValues
     CONFIG_BOOL_OUTDOORPVP_SI_ENABLED,
     CONFIG_BOOL_OUTDOORPVP_EP_ENABLED,
     CONFIG_BOOL_KICK_PLAYER_ON_BAD_PACKET,
+    CONFIG_BOOL_NETWORK_CORK_OUTPUT,
+    CONFIG_BOOL_NETWORK_SHAPE_OUTPUT,
+    CONFIG_BOOL_OPCODE_STATS,
+    CONFIG_BOOL_DB_PROFILER,
     CONFIG_BOOL_STATS_SAVE_ONLY_ON_LOGOUT,
+    CONFIG_BOOL_PLAYER_SAVE_DELTA,
+    CONFIG_BOOL_PLAYER_SAVE_SCHEDULER,
     CONFIG_BOOL_CLEAN_CHARACTER_DB,
     CONFIG_BOOL_VMAP_INDOOR_CHECK,
     CONFIG_BOOL_PET_UNSUMMON_AT_MOUNT,
@@ -684,28 +700,41 @@ class World
         Eluna* eluna;
 #endif /* ENABLE_ELUNA */
 
-        // AH subprocess supervisor (Task 5+).
-        // Set by mangosd.cpp after WorkerSupervisor::Start() succeeds.
-        // Returns NULL if AH.Service.Enabled=0 OR startup failed -- a NULL
-        // supervisor does NOT distinguish "not configured" from "configured but
-        // failed to start". Use IsAhServiceConfigured() for that distinction.
+        // AH subprocess supervisors (Task 5+), one slot per house group
+        // (AhHouseShards.h). Set by Master.cpp after WorkerSupervisor::Start()
+        // succeeds: one worker owns every slot, unless AH.Service.Shards splits
+        // the houses across several. Returns NULL if AH.Service.Enabled=0 OR
+        // that worker's startup failed -- a NULL supervisor does NOT
+        // distinguish "not configured" from "configured but failed to start".
+        // Use IsAhServiceConfigured() for that distinction.
         //
         // PF3-A: published with a RELEASE store and read with ACQUIRE loads.
         // SetAhSupervisor() runs AFTER worldThread->open(0) has already started
-        // the world tick loop, so the world thread reads this pointer
+        // the world tick loop, so the world thread reads these pointers
         // concurrently. The release/acquire pairing guarantees the
         // WorkerSupervisor's construction + Start() member stores
         // happen-before any non-NULL observation, so the world thread can never
         // dereference a half-constructed supervisor on a weakly-ordered CPU.
-        void SetAhSupervisor(WorkerSupervisor* sv)
+        void SetAhSupervisor(uint8 houseGroup, WorkerSupervisor* sv)
         {
-            m_ahSupervisor.store(sv, std::memory_order_release);
+            if (houseGroup < AH_HOUSE_GROUP_COUNT)
+            {
+                m_ahSupervisor[houseGroup].store(sv, std::memory_order_release);
+            }
         }
-        WorkerSupervisor* GetAhSupervisor() const
+        WorkerSupervisor* GetAhSupervisor(uint8 houseGroup) const
         {
-            return m_ahSupervisor.load(std::memory_order_acquire);
+            if (houseGroup >= AH_HOUSE_GROUP_COUNT)
+            {
+                return NULL;
+            }
+            return m_ahSupervisor[houseGroup].load(std::memory_order_acquire);
         }
 
+        /// Every published supervisor once, in house-group order (a worker
+        /// owning several groups is listed at its first).
+        void GetAhSupervisors(std::vector<WorkerSupervisor*>& out) const;
+
         // SP-1 coordinator authority: TRUE iff the AH worker is the CONFIGURED
         // read authority (AH.Service.Enabled=1), independent of whether the
         // supervisor object is currently live. A failed WorkerSupervisor::Start()
@@ -849,10 +878,25 @@ class World
         // List of Maps that should be force-loaded on startup
         std::set<uint32> m_configForceLoadMapIds;
 
-        // AH subprocess supervisor pointer (NULL when service is disabled).
-        // PF3-A: atomic so the publishing release store in SetAhSupervisor()
-        // synchronises-with the acquire loads in the world tick loop.
-        std::atomic<WorkerSupervisor*> m_ahSupervisor;
+        // AH subprocess supervisor per house group (NULL when service is
+        // disabled). PF3-A: atomic so the publishing release store in
+        // SetAhSupervisor() synchronises-with the acquire loads in the world
+        // tick loop.
+        std::atomic<WorkerSupervisor*> m_ahSupervisor[AH_HOUSE_GROUP_COUNT];
+
+        /// World-thread bookkeeping for one supervisor in the tick block.
+        struct AhShardWatch
+        {
+            WorkerSupervisor* sv;
+            bool   prevActive;        ///< ServiceActive() at the last AHBOT tick
+            size_t lastDroppedSeen;   ///< InboundDropped() at the last warning
+            time_t lastOverflowWarn;
+            time_t lastNearFullWarn;
+        };
+        std::vector<AhShardWatch> m_ahShardWatch;
+
+        /// The watch entry of @p sv, created on first sight.
+        AhShardWatch& AhWatchFor(WorkerSupervisor* sv);
 
         // SP-1 coordinator authority flag (see SetAhServiceConfigured). Persists
         // for the process lifetime once AH.Service.Enabled=1, even if the
@@ -871,9 +915,10 @@ class World
          * M1 stub: logs the opcode. M2 will route IPC_AH_* intents to
          * the AH executor. Keep this switch extensible.
          *
-         * @param msg The inbound frame from the ah-service child.
+         * @param msg    The inbound frame from the ah-service child.
+         * @param source The supervisor it arrived on; replies go back there.
          */
-        void HandleAhInbound(const IpcMessage& msg);
+        void HandleAhInbound(const IpcMessage& msg, WorkerSupervisor* source);
 };
 
 extern uint32 realmID;
@@ -50,6 +50,8 @@
 #include "Platform/Define.h"
 #include "Log.h"
 #include "Opcodes.h"
+#include "OpcodeStats.h"
+#include "PlayerSaveScheduler.h"
 #include "WorldSession.h"
 #include "WorldPacket.h"
 #include "Player.h"
@@ -280,6 +282,12 @@ void World::LoadConfigSettings(bool reload)
     setConfig(CONFIG_UINT32_INTERVAL_SAVE, "PlayerSave.Interval", 15 * MINUTE * IN_MILLISECONDS);
     setConfigMinMax(CONFIG_UINT32_MIN_LEVEL_STAT_SAVE, "PlayerSave.Stats.MinLevel", 0, 0, MAX_LEVEL);
     setConfig(CONFIG_BOOL_STATS_SAVE_ONLY_ON_LOGOUT, "PlayerSave.Stats.SaveOnlyOnLogout", true);
+    setConfig(CONFIG_BOOL_PLAYER_SAVE_DELTA, "PlayerSave.Delta", true);
+    setConfig(CONFIG_BOOL_PLAYER_SAVE_SCHEDULER, "PlayerSave.Scheduler", false);
+    setConfigMin(CONFIG_UINT32_PLAYER_SAVE_TICK_PLAYERS, "PlayerSave.TickPlayers", 5, 1);
+    setConfig(CONFIG_UINT32_PLAYER_SAVE_TICK_STATEMENTS, "PlayerSave.TickStatements", 200);
+    sPlayerSaveScheduler.Configure(getConfig(CONFIG_BOOL_PLAYER_SAVE_SCHEDULER), getConfig(CONFIG_UINT32_PLAYER_SAVE_TICK_PLAYERS),
+                                   getConfig(CONFIG_UINT32_PLAYER_SAVE_TICK_STATEMENTS));
 
     setConfigMin(CONFIG_UINT32_INTERVAL_GRIDCLEAN, "GridCleanUpDelay", 5 * MINUTE * IN_MILLISECONDS, MIN_GRID_DELAY);
     if (reload)
@@ -288,6 +296,7 @@ void World::LoadConfigSettings(bool reload)
     }
 
     setConfig(CONFIG_UINT32_NUMTHREADS, "MapUpdateThreads", 2);
+    setConfigMinMax(CONFIG_UINT32_STARTUP_LOAD_THREADS, "StartupLoadThreads", 4, 1, 16);
 
     setConfigMin(CONFIG_UINT32_INTERVAL_MAPUPDATE, "MapUpdateInterval", 100, MIN_MAP_UPDATE_DELAY);
     if (reload)
@@ -506,6 +515,33 @@ void World::LoadConfigSettings(bool reload)
     setConfig(CONFIG_BOOL_OUTDOORPVP_EP_ENABLED,                       "OutdoorPvp.EPEnabled", true);
 
     setConfig(CONFIG_BOOL_KICK_PLAYER_ON_BAD_PACKET, "Network.KickOnBadPacket", false);
+    if (configNoReload(reload, CONFIG_BOOL_NETWORK_CORK_OUTPUT, "Network.CorkOutput", false))
+    {
+        setConfig(CONFIG_BOOL_NETWORK_CORK_OUTPUT, "Network.CorkOutput", false);
+    }
+    setConfigMinMax(CONFIG_UINT32_NETWORK_CORK_FLUSH_BYTES, "Network.CorkFlushBytes", 16384, 1024, 1024 * 1024);
+    if (configNoReload(reload, CONFIG_BOOL_NETWORK_SHAPE_OUTPUT, "Network.ShapeOutput", false))
+    {
+        setConfig(CONFIG_BOOL_NETWORK_SHAPE_OUTPUT, "Network.ShapeOutput", false);
+    }
+    setConfigMinMax(CONFIG_UINT32_NETWORK_SHAPE_BACKLOG_BYTES, "Network.ShapeBacklogBytes", 65536, 4096, 16 * 1024 * 1024);
+    setConfigMinMax(CONFIG_UINT32_NETWORK_SHAPE_TICK_BYTES, "Network.ShapeTickBytes", 16384, 0, 16 * 1024 * 1024);
+
+    setConfig(CONFIG_BOOL_OPCODE_STATS, "OpcodeStats.Enable", false);
+    setConfig(CONFIG_UINT32_OPCODE_STATS_DUMP_INTERVAL, "OpcodeStats.DumpInterval", 300);
+    sOpcodeStats.Configure(getConfig(CONFIG_BOOL_OPCODE_STATS), getConfig(CONFIG_UINT32_OPCODE_STATS_DUMP_INTERVAL),
+                           sConfig.GetStringDefault("OpcodeStats.DumpFile", "opcode-stats.log"));
+
+    setConfig(CONFIG_BOOL_DB_PROFILER, "DatabaseProfiler.Enable", false);
+    setConfig(CONFIG_UINT32_DB_SLOW_QUERY_MS, "DatabaseProfiler.SlowQueryMs", 0);
+    WorldDatabase.GetProfiler().Configure(getConfig(CONFIG_BOOL_DB_PROFILER), getConfig(CONFIG_UINT32_DB_SLOW_QUERY_MS));
+    CharacterDatabase.GetProfiler().Configure(getConfig(CONFIG_BOOL_DB_PROFILER), getConfig(CONFIG_UINT32_DB_SLOW_QUERY_MS));
+    LoginDatabase.GetProfiler().Configure(getConfig(CONFIG_BOOL_DB_PROFILER), getConfig(CONFIG_UINT32_DB_SLOW_QUERY_MS));
+
+    setConfigMinMax(CONFIG_UINT32_DB_SYNC_QUERY_CHECK, "DatabaseProfiler.SyncQueryCheck", SQL_SYNC_QUERY_ALLOW, SQL_SYNC_QUERY_ALLOW, SQL_SYNC_QUERY_ASSERT);
+    WorldDatabase.SetSyncQueryCheck(SqlSyncQueryCheck(getConfig(CONFIG_UINT32_DB_SYNC_QUERY_CHECK)));
+    CharacterDatabase.SetSyncQueryCheck(SqlSyncQueryCheck(getConfig(CONFIG_UINT32_DB_SYNC_QUERY_CHECK)));
+    LoginDatabase.SetSyncQueryCheck(SqlSyncQueryCheck(getConfig(CONFIG_UINT32_DB_SYNC_QUERY_CHECK)));
 
     setConfig(CONFIG_BOOL_PLAYER_COMMANDS, "PlayerCommands", false);
 
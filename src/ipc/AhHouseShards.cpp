@@ -0,0 +1,184 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2025 MaNGOS <https://www.getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "AhHouseShards.h"
+
+#include <cctype>
+
+namespace
+{
+    const char* const s_groupNames[AH_HOUSE_GROUP_COUNT] =
+    {
+        "alliance", "horde", "neutral"
+    };
+
+    /// Lower-cased copy of @p text with the blanks removed.
+    std::string Squeeze(std::string const& text)
+    {
+        std::string out;
+        out.reserve(text.size());
+        for (size_t i = 0; i < text.size(); ++i)
+        {
+            unsigned char const c = static_cast<unsigned char>(text[i]);
+            if (!std::isspace(c))
+            {
+                out += static_cast<char>(std::tolower(c));
+            }
+        }
+        return out;
+    }
+
+    /// Split @p text on @p sep; empty pieces are kept.
+    void Split(std::string const& text, char sep, std::vector<std::string>& out)
+    {
+        size_t start = 0;
+        for (;;)
+        {
+            size_t const end = text.find(sep, start);
+            if (end == std::string::npos)
+            {
+                out.push_back(text.substr(start));
+                return;
+            }
+            out.push_back(text.substr(start, end - start));
+            start = end + 1;
+        }
+    }
+}
+
+uint8 AhHouseIdToGroup(uint32 houseId)
+{
+    // Mirrors AuctionHouseMgr::GetAuctionHouseTeam.
+    switch (houseId)
+    {
+        case 1: case 2: case 3:
+            return 0;
+        case 4: case 5: case 6:
+            return 1;
+        default:
+            return 2;
+    }
+}
+
+bool AhParseHouseMask(std::string const& text, uint8& mask)
+{
+    std::vector<std::string> names;
+    Split(Squeeze(text), ',', names);
+
+    uint8 parsed = 0;
+    for (size_t i = 0; i < names.size(); ++i)
+    {
+        if (names[i].empty())
+        {
+            continue;
+        }
+        if (names[i] == "all")
+        {
+            parsed |= AH_HOUSE_MASK_ALL;
+            continue;
+        }
+
+        bool known = false;
+        for (uint8 g = 0; g < AH_HOUSE_GROUP_COUNT; ++g)
+        {
+            if (names[i] == s_groupNames[g])
+            {
+                parsed |= AhHouseGroupBit(g);
+                known = true;
+                break;
+            }
+        }
+        if (!known)
+        {
+            return false;
+        }
+    }
+
+    if (parsed == 0)
+    {
+        return false;
+    }
+    mask = parsed;
+    return true;
+}
+
+std::string AhHouseMaskName(uint8 mask)
+{
+    std::string out;
+    for (uint8 g = 0; g < AH_HOUSE_GROUP_COUNT; ++g)
+    {
+        if (mask & AhHouseGroupBit(g))
+        {
+            if (!out.empty())
+            {
+                out += ',';
+            }
+            out += s_groupNames[g];
+        }
+    }
+    return out;
+}
+
+bool AhParseShardTable(std::string const& text, std::vector<uint8>& out,
+                       std::string& error)
+{
+    out.clear();
+
+    std::string const table = Squeeze(text);
+    if (table.empty())
+    {
+        out.push_back(AH_HOUSE_MASK_ALL);
+        return true;
+    }
+
+    std::vector<std::string> shards;
+    Split(table, ';', shards);
+
+    uint8 owned = 0;
+    for (size_t i = 0; i < shards.size(); ++i)
+    {
+        uint8 mask = 0;
+        if (!AhParseHouseMask(shards[i], mask))
+        {
+            error = "shard " + std::to_string(i) + " (\"" + shards[i] +
+                    "\") is empty or names an unknown house group";
+            out.clear();
+            return false;
+        }
+        if (owned & mask)
+        {
+            error = "shard " + std::to_string(i) + " (\"" + shards[i] +
+                    "\") repeats a house group owned by an earlier shard";
+            out.clear();
+            return false;
+        }
+        owned |= mask;
+        out.push_back(mask);
+    }
+
+    if (owned != AH_HOUSE_MASK_ALL)
+    {
+        error = "no shard owns " + AhHouseMaskName(AH_HOUSE_MASK_ALL & ~owned);
+        out.clear();
+        return false;
+    }
+    return true;
+}
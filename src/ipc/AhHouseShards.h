@@ -0,0 +1,85 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2025 MaNGOS <https://www.getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef AH_IPC_HOUSE_SHARDS_H
+#define AH_IPC_HOUSE_SHARDS_H
+
+#include "Common.h"
+
+#include <string>
+#include <vector>
+
+/**
+ * @file AhHouseShards.h
+ * @brief Which auction-house groups one AH worker owns.
+ *
+ * The auction houses fall into three groups, the same three maps the
+ * in-process AuctionHouseMgr keeps: 0 alliance (houseid 1-3), 1 horde
+ * (houseid 4-6), 2 neutral (houseid 7). A worker owns a set of groups,
+ * carried as a bit mask (bit g = group g). mangosd reads the shard table
+ * from AH.Service.Shards, runs one worker per entry, and routes each
+ * player request to the worker owning the auctioneer's group; the worker
+ * gets its mask on the command line (--houses) and loads, serves and bots
+ * only those groups.
+ */
+
+/// Number of house groups (alliance, horde, neutral).
+static const uint8 AH_HOUSE_GROUP_COUNT = 3;
+
+/// Mask owning every group: the single-worker default.
+static const uint8 AH_HOUSE_MASK_ALL = 0x07;
+
+/// Mask bit of house group @p group (0..2).
+inline uint8 AhHouseGroupBit(uint8 group)
+{
+    return static_cast<uint8>(1u << group);
+}
+
+/// House group of a DBC houseid: 1-3 alliance, 4-6 horde, anything else neutral.
+uint8 AhHouseIdToGroup(uint32 houseId);
+
+/**
+ * @brief Parse a comma-separated group list ("alliance,horde", "neutral",
+ *        "all") into a mask. Names are case-insensitive; blanks are ignored.
+ * @return false on an unknown name or an empty list.
+ */
+bool AhParseHouseMask(std::string const& text, uint8& mask);
+
+/// Render @p mask back into the list AhParseHouseMask() accepts.
+std::string AhHouseMaskName(uint8 mask);
+
+/**
+ * @brief Parse a shard table: group lists separated by ';', one per worker,
+ *        e.g. "alliance;horde;neutral" or "alliance,horde;neutral".
+ *
+ * An empty (or all-blank) table means one worker owning every group. The
+ * table must partition the groups: every group owned by exactly one shard.
+ *
+ * @param text  The AH.Service.Shards value.
+ * @param out   One mask per shard, in table order.
+ * @param error Set to the reason on failure.
+ * @return false on a parse error, an empty shard, or a group owned by no
+ *         shard or by two.
+ */
+bool AhParseShardTable(std::string const& text, std::vector<uint8>& out,
+                       std::string& error);
+
+#endif // AH_IPC_HOUSE_SHARDS_H
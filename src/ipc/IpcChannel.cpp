@@ -153,6 +153,19 @@ void IpcServer::SetWriteAuthority(bool on)
     }
 }
 
+void IpcServer::SetSharedMemory(bool on)
+{
+    if (m_link)
+    {
+        m_link->shmOffer.store(on, std::memory_order_release);
+    }
+}
+
+bool IpcServer::SharedMemoryActive() const
+{
+    return m_link && m_link->shmActive.load(std::memory_order_acquire);
+}
+
 // ===========================================================================
 // IpcClient
 // ===========================================================================
@@ -247,3 +260,8 @@ bool IpcClient::WriteAuthority() const
 {
     return m_link && m_link->writeAuthority.load(std::memory_order_acquire) != 0u;
 }
+
+bool IpcClient::SharedMemoryActive() const
+{
+    return m_link && m_link->shmActive.load(std::memory_order_acquire);
+}
@@ -161,6 +161,16 @@ class IpcServer
          */
         void SetWriteAuthority(bool on);
 
+        /**
+         * @brief Offer the shared-memory ring transport to the child after
+         *        IPC_READY (Linux; the child may decline and stay on TCP).
+         * Supervisor thread, before SpawnChild(); atomic store.
+         */
+        void SetSharedMemory(bool on);
+
+        /// True while the live connection runs over the shared-memory rings.
+        bool SharedMemoryActive() const;
+
     private:
         BoundedQueue<IpcMessage>    m_inbound;
         IpcServerLink*              m_link;       ///< Shared link (refcounted).
@@ -241,6 +251,9 @@ class IpcClient
          */
         bool WriteAuthority() const;
 
+        /// True while the connection runs over the shared-memory rings.
+        bool SharedMemoryActive() const;
+
     private:
         BoundedQueue<IpcMessage>    m_inbound;
         IpcClientLink*              m_link;       ///< Shared link (refcounted).
@@ -42,7 +42,9 @@ IpcClientHandler::IpcClientHandler(IpcSocket&& sock,
       m_secret(secret),
       m_inbound(inbound),
       m_link(link),
-      m_closing(false)
+      m_closing(false),
+      m_shmTx(false),
+      m_shmRx(false)
 {
     if (m_link)
     {
@@ -83,6 +85,16 @@ int IpcClientHandler::SendHello()
 // ---------------------------------------------------------------------------
 
 void IpcClientHandler::ReceiveLoop(std::atomic<bool>& stop)
+{
+    if (ReceiveSocket(stop) && m_shmRx)
+    {
+        ReceiveShared(stop);
+    }
+
+    OnClose();
+}
+
+bool IpcClientHandler::ReceiveSocket(std::atomic<bool>& stop)
 {
     char buf[4096];
 
@@ -96,13 +108,12 @@ void IpcClientHandler::ReceiveLoop(std::atomic<bool>& stop)
         }
         if (n <= 0)
         {
-            break;
+            return false;
         }
 
         m_recvBuf.append(reinterpret_cast<const uint8*>(buf),
                          static_cast<size_t>(n));
 
-        bool fatal = false;
         while (m_recvBuf.rpos() < m_recvBuf.size())
         {
             IpcMessage msg;
@@ -116,26 +127,64 @@ void IpcClientHandler::ReceiveLoop(std::atomic<bool>& stop)
                 }
                 fprintf(stderr, "IpcClientHandler: framing error: %s\n",
                         err.c_str());
-                fatal = true;
-                break;
+                return false;
             }
 
             if (ProcessFrame(msg) == -1)
             {
-                fatal = true;
-                break;
+                return false;
+            }
+
+            if (m_shmRx)
+            {
+                // IPC_SHM_SWITCH is the server's last frame on the socket.
+                if (m_recvBuf.rpos() != m_recvBuf.size())
+                {
+                    fprintf(stderr, "IpcClientHandler: socket data after"
+                                    " IPC_SHM_SWITCH\n");
+                    return false;
+                }
+                m_recvBuf.clear();
+                return true;
             }
         }
 
         CompactRecvBuf();
+    }
 
-        if (fatal)
+    return false;
+}
+
+void IpcClientHandler::ReceiveShared(std::atomic<bool>& stop)
+{
+    while (!stop.load(std::memory_order_acquire) &&
+           !m_closing.load(std::memory_order_acquire))
+    {
+        IpcMessage msg;
+        std::string err;
+        const int r = m_shm->Read(msg, 200, err);
+        if (r < 0)
         {
-            break;
+            fprintf(stderr, "IpcClientHandler: shared-memory ring error: %s\n",
+                    err.c_str());
+            return;
+        }
+        if (r == 0)
+        {
+            // The socket stays the liveness signal while the rings are idle.
+            char probe;
+            if (m_sock.RecvSome(&probe, 1, 0) != -2)
+            {
+                return;
+            }
+            continue;
         }
-    }
 
-    OnClose();
+        if (ProcessFrame(msg) == -1)
+        {
+            return;
+        }
+    }
 }
 
 // ---------------------------------------------------------------------------
@@ -173,6 +222,12 @@ int IpcClientHandler::SendFrame(const IpcMessage& msg)
         return -1;
     }
 
+    if (m_shmTx.load(std::memory_order_acquire))
+    {
+        std::lock_guard<std::mutex> g(m_sendMtx);
+        return SendOnRing(msg);
+    }
+
     ByteBuffer wire;
     msg.Encode(wire);
 
@@ -181,6 +236,10 @@ int IpcClientHandler::SendFrame(const IpcMessage& msg)
     {
         return -1;
     }
+    if (m_shmTx.load(std::memory_order_relaxed))
+    {
+        return SendOnRing(msg);
+    }
     if (!m_sock.SendAll(wire.contents(), wire.size()))
     {
         return -1;
@@ -188,6 +247,76 @@ int IpcClientHandler::SendFrame(const IpcMessage& msg)
     return 0;
 }
 
+int IpcClientHandler::SendOnRing(const IpcMessage& msg)
+{
+    // Caller holds m_sendMtx (single producer).
+    if (m_closing.load(std::memory_order_acquire))
+    {
+        return -1;
+    }
+    if (m_shm->Write(msg, m_closing) != 0)
+    {
+        if (!m_closing.load(std::memory_order_acquire))
+        {
+            fprintf(stderr, "IpcClientHandler: outbound ring corrupt\n");
+            m_sock.ShutdownBoth();
+        }
+        return -1;
+    }
+    return 0;
+}
+
+// ---------------------------------------------------------------------------
+// AcceptSharedMemory - take up the server's IPC_SHM_OFFER
+// ---------------------------------------------------------------------------
+
+int IpcClientHandler::AcceptSharedMemory(const IpcMessage& offer)
+{
+    if (m_shm)
+    {
+        fprintf(stderr, "IpcClientHandler: duplicate IPC_SHM_OFFER\n");
+        return -1;
+    }
+
+    // Body: uint32 ring bytes, then the object name.
+    if (offer.body.size() <= sizeof(uint32))
+    {
+        fprintf(stderr, "IpcClientHandler: short IPC_SHM_OFFER - ignored\n");
+        return 0;
+    }
+    ByteBuffer b;
+    b.append(offer.body.contents(), offer.body.size());
+    uint32 ringBytes;
+    b >> ringBytes;
+    const std::string name(reinterpret_cast<const char*>(b.contents() + b.rpos()),
+                           b.size() - b.rpos());
+
+    std::unique_ptr<IpcShmChannel> shm(new IpcShmChannel());
+    if (!shm->Open(name, ringBytes))
+    {
+        // Not fatal: without an ACCEPT the server simply keeps using TCP.
+        fprintf(stderr, "IpcClientHandler: cannot map %s - staying on TCP\n",
+                name.c_str());
+        return 0;
+    }
+    m_shm = std::move(shm);
+
+    IpcMessage accept;
+    accept.op = IPC_SHM_ACCEPT;
+    ByteBuffer wire;
+    accept.Encode(wire);
+
+    std::lock_guard<std::mutex> g(m_sendMtx);
+    if (m_closing.load(std::memory_order_acquire) ||
+        !m_sock.SendAll(wire.contents(), wire.size()))
+    {
+        return -1;
+    }
+    // Our last frame on the socket; the server reads the ring from here on.
+    m_shmTx.store(true, std::memory_order_release);
+    return 0;
+}
+
 // ---------------------------------------------------------------------------
 // InboundFrameAcceptable - per-opcode size predicate (shared with tests)
 // ---------------------------------------------------------------------------
@@ -271,6 +400,28 @@ int IpcClientHandler::ProcessFrame(const IpcMessage& msg)
 
         case IPC_CLI_LIVE:
         {
+            if (msg.op == IPC_SHM_OFFER)
+            {
+                return AcceptSharedMemory(msg);
+            }
+            if (msg.op == IPC_SHM_SWITCH)
+            {
+                if (!m_shmTx.load(std::memory_order_acquire) || m_shmRx)
+                {
+                    fprintf(stderr, "IpcClientHandler: unexpected"
+                                    " IPC_SHM_SWITCH\n");
+                    return -1;
+                }
+                m_shmRx = true;
+                if (m_link)
+                {
+                    m_link->shmActive.store(true, std::memory_order_release);
+                }
+                fprintf(stdout, "IpcClientHandler: data plane moved to shared"
+                                " memory\n");
+                fflush(stdout);
+                break;
+            }
             if (!InboundFrameAcceptable(msg.op,
                                         static_cast<uint32>(msg.body.size())))
             {
@@ -319,6 +470,7 @@ void IpcClientHandler::OnClose()
     if (m_link)
     {
         m_link->live.store(false, std::memory_order_release);
+        m_link->shmActive.store(false, std::memory_order_release);
         m_link->ClearSendTarget(this);
     }
 
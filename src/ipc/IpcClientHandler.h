@@ -28,6 +28,7 @@
 #include "BoundedQueue.h"
 #include "IpcLink.h"
 #include "IpcSocket.h"
+#include "IpcShm.h"
 
 #include <atomic>
 #include <memory>
@@ -56,6 +57,12 @@ enum IpcClientHandshakeState
  * Handshake (client side):
  *   SendHello()        -> send IPC_HELLO { proto, pid, secret }
  *   recv IPC_HELLO_ACK -> send IPC_READY (channel now live)
+ *
+ * Shared-memory upgrade (optional, offered by the server):
+ *   recv IPC_SHM_OFFER  -> map the rings; send IPC_SHM_ACCEPT, then write
+ *                          every later frame to the ring (on failure: ignore
+ *                          the offer and stay on TCP)
+ *   recv IPC_SHM_SWITCH -> read every later frame from the ring
  */
 class IpcClientHandler : public std::enable_shared_from_this<IpcClientHandler>
 {
@@ -73,7 +80,8 @@ class IpcClientHandler : public std::enable_shared_from_this<IpcClientHandler>
         void ReceiveLoop(std::atomic<bool>& stop);
 
         /**
-         * @brief Encode and send @p msg on the socket. Thread-safe.
+         * @brief Encode and send @p msg on the socket (or the shared-memory
+         *        ring once upgraded). Thread-safe.
          * @return 0 on success, -1 on failure.
          */
         int SendFrame(const IpcMessage& msg);
@@ -98,7 +106,16 @@ class IpcClientHandler : public std::enable_shared_from_this<IpcClientHandler>
 
         std::atomic<bool>           m_closing;
 
+        /// Shared-memory data plane; null until an offer was accepted.
+        std::unique_ptr<IpcShmChannel> m_shm;
+        std::atomic<bool>           m_shmTx;    ///< sends go to the ring
+        bool                        m_shmRx;    ///< receive thread only
+
         int  ProcessFrame(const IpcMessage& msg);
+        bool ReceiveSocket(std::atomic<bool>& stop);
+        void ReceiveShared(std::atomic<bool>& stop);
+        int  SendOnRing(const IpcMessage& msg);
+        int  AcceptSharedMemory(const IpcMessage& offer);
         void CompactRecvBuf();
         void OnClose();
 };
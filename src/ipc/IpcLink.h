@@ -61,6 +61,8 @@ struct IpcLink
           runId(0),
           writeAuthority(0),
           handlerActive(false),
+          shmOffer(false),
+          shmActive(false),
           refCount(0)
     {
     }
@@ -82,6 +84,14 @@ struct IpcLink
     /// on close.
     std::atomic<bool> handlerActive;
 
+    /// Server: offer the shared-memory transport after READY. Set by the
+    /// caller before Start(); read by the handler thread.
+    std::atomic<bool> shmOffer;
+
+    /// True while this connection's frames travel over the shared-memory
+    /// rings; cleared on close.
+    std::atomic<bool> shmActive;
+
     // --- reliable inbound lane (unbounded, never dropped) ---
 
     std::deque<IpcMessage> reliableInbound;
@@ -59,6 +59,9 @@ IpcBodySizeRule IpcExpectedBodySize(uint16 op)
         case IPC_SHUTDOWN_ACK:  return IPC_RULE_EXACT(0);
         case IPC_ECHO:          return IPC_RULE_MAXLEN(IPC_ECHO_MAX_BODY);
         case IPC_ECHO_REPLY:    return IPC_RULE_MAXLEN(IPC_ECHO_MAX_BODY);
+        case IPC_SHM_OFFER:     return IPC_RULE_MAXLEN(IPC_ECHO_MAX_BODY); // uint32 ring size + name
+        case IPC_SHM_ACCEPT:    return IPC_RULE_EXACT(0);
+        case IPC_SHM_SWITCH:    return IPC_RULE_EXACT(0);
 
         // --- AH consumer frames (fixed wire layouts) ---
         case IPC_INTENT_SELL:   // 33
@@ -81,6 +84,7 @@ IpcBodySizeRule IpcExpectedBodySize(uint16 op)
         case IPC_PLAYER_BUYOUT:         return IPC_RULE_EXACT(PlayerBuyoutIntent::WIRE_SIZE);
         case IPC_PLAYER_CANCEL:         return IPC_RULE_EXACT(PlayerCancelPrepare::WIRE_SIZE);
         case IPC_PLAYER_RESULT:         return IPC_RULE_EXACT(PlayerMutationResult::WIRE_SIZE);
+        case IPC_PLAYER_RESULT_BATCH:   return IPC_RULE_MAXLEN(PlayerMutationResultBatch::MAX_WIRE);
         case IPC_RESOLVE_APPLY:         return IPC_RULE_EXACT(ResolveApply::WIRE_SIZE);
         case IPC_RESOLVE_ACK:           return IPC_RULE_EXACT(ResolveAck::WIRE_SIZE);
         case IPC_PLAYER_CANCEL_CONFIRM: return IPC_RULE_EXACT(PlayerCancelDecide::WIRE_SIZE);
@@ -43,6 +43,9 @@ enum IpcOpcode : uint16
     IPC_SHUTDOWN_ACK    = 0x0009,   ///< Either direction: shutdown acknowledged
     IPC_ECHO            = 0x000A,   ///< Debug echo request
     IPC_ECHO_REPLY      = 0x000B,   ///< Debug echo reply
+    IPC_SHM_OFFER       = 0x000C,   ///< mangosd -> service: shared-memory rings to map
+    IPC_SHM_ACCEPT      = 0x000D,   ///< Service -> mangosd: mapped; last frame on TCP
+    IPC_SHM_SWITCH      = 0x000E,   ///< mangosd -> service: last frame on TCP
 
     // 0x1000+ reserved for AH consumer (Milestone 2)
     IPC_AH_RESERVED_MIN  = 0x1000,  ///< Boundary sentinel (not a real opcode)
@@ -67,6 +70,7 @@ enum IpcOpcode : uint16
     IPC_RESOLVE_ACK           = 0x1046,  ///< mangosd -> worker: APPLIED|FAILED|DUPLICATE
     IPC_PLAYER_CANCEL_CONFIRM = 0x1047,  ///< mangosd -> worker: cancel commit
     IPC_PLAYER_CANCEL_ABORT   = 0x1048,  ///< mangosd -> worker: cancel abort/unlock
+    IPC_PLAYER_RESULT_BATCH   = 0x1049,  ///< worker -> mangosd: several results, one group commit
 };
 
 #endif // AH_IPC_OPCODES_H
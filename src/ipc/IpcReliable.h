@@ -38,6 +38,7 @@ inline bool IpcIsReliableOpcode(uint16 op)
         case IPC_PLAYER_BUYOUT:
         case IPC_PLAYER_CANCEL:
         case IPC_PLAYER_RESULT:
+        case IPC_PLAYER_RESULT_BATCH:
         case IPC_RESOLVE_APPLY:
         case IPC_RESOLVE_ACK:
         case IPC_PLAYER_CANCEL_CONFIRM:
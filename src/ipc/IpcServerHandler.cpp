@@ -37,7 +37,9 @@ IpcServerHandler::IpcServerHandler(IpcSocket&& sock,
       m_writeAuthority(writeAuthority),
       m_inbound(inbound),
       m_link(link),
-      m_closing(false)
+      m_closing(false),
+      m_shmTx(false),
+      m_shmRx(false)
 {
     if (m_link)
     {
@@ -59,6 +61,16 @@ IpcServerHandler::~IpcServerHandler()
 // ---------------------------------------------------------------------------
 
 void IpcServerHandler::ReceiveLoop(std::atomic<bool>& stop)
+{
+    if (ReceiveSocket(stop) && m_shmRx)
+    {
+        ReceiveShared(stop);
+    }
+
+    OnClose();
+}
+
+bool IpcServerHandler::ReceiveSocket(std::atomic<bool>& stop)
 {
     char buf[4096];
 
@@ -72,13 +84,12 @@ void IpcServerHandler::ReceiveLoop(std::atomic<bool>& stop)
         }
         if (n <= 0)
         {
-            break; // 0 = peer closed, -1 = error
+            return false; // 0 = peer closed, -1 = error
         }
 
         m_recvBuf.append(reinterpret_cast<const uint8*>(buf),
                          static_cast<size_t>(n));
 
-        bool fatal = false;
         while (m_recvBuf.rpos() < m_recvBuf.size())
         {
             // PF2-C: fail-fast on oversize-for-op BEFORE buffering the body.
@@ -86,8 +97,7 @@ void IpcServerHandler::ReceiveLoop(std::atomic<bool>& stop)
             {
                 if (RejectOversizeForOp())
                 {
-                    fatal = true;
-                    break;
+                    return false;
                 }
             }
 
@@ -104,28 +114,67 @@ void IpcServerHandler::ReceiveLoop(std::atomic<bool>& stop)
                 }
                 sLog.outError("IpcServerHandler: framing error: %s - closing",
                               err.c_str());
-                fatal = true;
-                break;
+                return false;
             }
 
             if (ProcessFrame(msg) == -1)
             {
-                fatal = true;
-                break;
+                return false;
+            }
+
+            if (m_shmRx)
+            {
+                // IPC_SHM_ACCEPT is the child's last frame on the socket.
+                if (m_recvBuf.rpos() != m_recvBuf.size())
+                {
+                    sLog.outError("IpcServerHandler: socket data after"
+                                  " IPC_SHM_ACCEPT - closing");
+                    return false;
+                }
+                m_recvBuf.clear();
+                return true;
             }
         }
 
         // Drop consumed front bytes so a peer that always leaves a trailing
         // partial frame cannot make m_recvBuf grow without bound.
         CompactRecvBuf();
+    }
+
+    return false;
+}
 
-        if (fatal)
+void IpcServerHandler::ReceiveShared(std::atomic<bool>& stop)
+{
+    while (!stop.load(std::memory_order_acquire) &&
+           !m_closing.load(std::memory_order_acquire))
+    {
+        IpcMessage msg;
+        std::string err;
+        const int r = m_shm->Read(msg, 200, err, &IpcServerHandler::OversizeForOp);
+        if (r < 0)
         {
-            break;
+            sLog.outError("IpcServerHandler: shared-memory ring error: %s"
+                          " - closing", err.c_str());
+            return;
+        }
+        if (r == 0)
+        {
+            // Idle: the socket is still the liveness signal. Anything but a
+            // timeout means the child closed it (or broke protocol by writing).
+            char probe;
+            if (m_sock.RecvSome(&probe, 1, 0) != -2)
+            {
+                return;
+            }
+            continue;
         }
-    }
 
-    OnClose();
+        if (ProcessFrame(msg) == -1)
+        {
+            return;
+        }
+    }
 }
 
 // ---------------------------------------------------------------------------
@@ -165,6 +214,11 @@ bool IpcServerHandler::RejectOversizeForOp()
     const uint16 op  = m_recvBuf.read<uint16>(base + 2);
     const uint32 len = m_recvBuf.read<uint32>(base + 4);
 
+    return OversizeForOp(op, len);
+}
+
+bool IpcServerHandler::OversizeForOp(uint16 op, uint32 len)
+{
     const IpcBodySizeRule rule = IpcExpectedBodySize(op);
     if (!rule.known)
     {
@@ -193,10 +247,26 @@ int IpcServerHandler::SendFrame(const IpcMessage& msg)
         return -1;
     }
 
+    if (m_shmTx.load(std::memory_order_acquire))
+    {
+        std::lock_guard<std::mutex> g(m_sendMtx);
+        return SendOnRing(msg);
+    }
+
     ByteBuffer wire;
     msg.Encode(wire);
 
     std::lock_guard<std::mutex> g(m_sendMtx);
+    if (m_shmTx.load(std::memory_order_relaxed))
+    {
+        return SendOnRing(msg);   // switched while we encoded
+    }
+    return SendOnSocket(wire);
+}
+
+int IpcServerHandler::SendOnSocket(const ByteBuffer& wire)
+{
+    // Caller holds m_sendMtx.
     if (m_closing.load(std::memory_order_acquire))
     {
         return -1;
@@ -208,6 +278,99 @@ int IpcServerHandler::SendFrame(const IpcMessage& msg)
     return 0;
 }
 
+int IpcServerHandler::SendOnRing(const IpcMessage& msg)
+{
+    // Caller holds m_sendMtx (single producer).
+    if (m_closing.load(std::memory_order_acquire))
+    {
+        return -1;
+    }
+    if (m_shm->Write(msg, m_closing) != 0)
+    {
+        if (!m_closing.load(std::memory_order_acquire))
+        {
+            // The child moved our ring's head somewhere impossible: treat it
+            // like a broken stream and let the receive thread close.
+            sLog.outError("IpcServerHandler: outbound ring corrupt - closing");
+            m_sock.ShutdownBoth();
+        }
+        return -1;
+    }
+    return 0;
+}
+
+// ---------------------------------------------------------------------------
+// Shared-memory upgrade
+// ---------------------------------------------------------------------------
+
+void IpcServerHandler::OfferSharedMemory()
+{
+    if (!IpcShmChannel::Supported())
+    {
+        sLog.outString("IpcServerHandler: shared-memory transport not built"
+                       " on this platform - staying on TCP");
+        return;
+    }
+
+    std::unique_ptr<IpcShmChannel> shm(new IpcShmChannel());
+    if (!shm->Create(IPC_SHM_RING_BYTES))
+    {
+        sLog.outError("IpcServerHandler: cannot create shared-memory rings"
+                      " - staying on TCP");
+        return;
+    }
+
+    IpcMessage offer;
+    offer.op = IPC_SHM_OFFER;
+    offer.body << uint32(shm->RingBytes());
+    offer.body.append(reinterpret_cast<const uint8*>(shm->Name().data()),
+                      shm->Name().size());
+
+    // Kept before the send: the child's accept can only follow it.
+    m_shm = std::move(shm);
+    if (SendFrame(offer) == -1)
+    {
+        m_shm.reset();
+    }
+}
+
+int IpcServerHandler::AcceptSharedMemory()
+{
+    if (!m_shm || m_shmRx)
+    {
+        sLog.outError("IpcServerHandler: unexpected IPC_SHM_ACCEPT - closing");
+        return -1;
+    }
+
+    // Both sides have it mapped; nothing else gets to open it.
+    m_shm->Unlink();
+
+    {
+        std::lock_guard<std::mutex> g(m_sendMtx);
+        IpcMessage sw;
+        sw.op = IPC_SHM_SWITCH;
+        ByteBuffer wire;
+        sw.Encode(wire);
+        // Our last frame on the socket: the child drains the socket up to
+        // here before it starts on the ring, so ordering holds across the
+        // switch.
+        if (SendOnSocket(wire) == -1)
+        {
+            return -1;
+        }
+        m_shmTx.store(true, std::memory_order_release);
+    }
+
+    m_shmRx = true;
+    if (m_link)
+    {
+        m_link->shmActive.store(true, std::memory_order_release);
+    }
+    sLog.outString("IpcServerHandler: data plane moved to shared memory"
+                   " (%u KiB rings)", m_shm->RingBytes() / 1024u);
+    return 0;
+}
+
 // ---------------------------------------------------------------------------
 // ProcessFrame - handshake state machine (server side)
 // ---------------------------------------------------------------------------
@@ -293,6 +456,11 @@ int IpcServerHandler::ProcessFrame(const IpcMessage& msg)
             }
 
             sLog.outString("IpcServerHandler: AH service READY");
+
+            if (m_link && m_link->shmOffer.load(std::memory_order_acquire))
+            {
+                OfferSharedMemory();
+            }
             break;
         }
 
@@ -322,6 +490,11 @@ int IpcServerHandler::ProcessFrame(const IpcMessage& msg)
                 break;
             }
 
+            if (msg.op == IPC_SHM_ACCEPT)
+            {
+                return AcceptSharedMemory();
+            }
+
             // PF2-B: stamp with our per-connection run-id so the supervisor can
             // drop a frame produced by a PRIOR child that slipped into the queue.
             IpcMessage stamped(msg);
@@ -361,6 +534,7 @@ void IpcServerHandler::OnClose()
     if (m_link)
     {
         m_link->live.store(false, std::memory_order_release);
+        m_link->shmActive.store(false, std::memory_order_release);
         m_link->ClearSendTarget(this);
         m_link->handlerActive.store(false, std::memory_order_release);
     }
@@ -27,6 +27,7 @@
 #include "IpcMessage.h"
 #include "BoundedQueue.h"
 #include "IpcLink.h"
+#include "IpcShm.h"
 #include "IpcSocket.h"
 
 #include <atomic>
@@ -58,6 +59,14 @@ enum IpcServerHandshakeState
  *   recv IPC_HELLO -> verify proto + secret -> send IPC_HELLO_ACK
  *   recv IPC_READY -> mark live
  *
+ * Shared-memory upgrade (optional, IpcServer::SetSharedMemory):
+ *   on live          -> create the rings, send IPC_SHM_OFFER
+ *   recv IPC_SHM_ACCEPT (the child's last TCP frame)
+ *                    -> unlink the name, send IPC_SHM_SWITCH (our last TCP
+ *                       frame), then send and receive on the rings only
+ * A child that cannot map the rings never accepts and the link stays on TCP.
+ * The socket stays open either way; its closure ends the connection.
+ *
  * This is a 1-connection server; the owning thread guarantees only one handler
  * is active at a time (single-owner guard on the link).
  */
@@ -77,11 +86,16 @@ class IpcServerHandler : public std::enable_shared_from_this<IpcServerHandler>
         void ReceiveLoop(std::atomic<bool>& stop);
 
         /**
-         * @brief Encode and send @p msg on the socket. Thread-safe.
+         * @brief Send @p msg on the socket, or on the outbound ring once the
+         *        link has switched to shared memory. Thread-safe.
          * @return 0 on success, -1 on failure.
          */
         int SendFrame(const IpcMessage& msg);
 
+        /// PF2-C rule: true if @p op is known and @p bodyLen exceeds its
+        /// maximum (logged). Also the header check of the inbound ring.
+        static bool OversizeForOp(uint16 op, uint32 bodyLen);
+
         bool IsLive() const { return m_state == IPC_SRV_LIVE; }
         bool IsClosing() const { return m_closing.load(std::memory_order_acquire); }
 
@@ -100,7 +114,17 @@ class IpcServerHandler : public std::enable_shared_from_this<IpcServerHandler>
 
         std::atomic<bool>           m_closing;
 
+        std::unique_ptr<IpcShmChannel> m_shm;   ///< offered rings (NULL: TCP only)
+        std::atomic<bool>           m_shmTx;    ///< sends go to the ring
+        bool                        m_shmRx;    ///< receive thread reads the ring
+
         int  ProcessFrame(const IpcMessage& msg);
+        bool ReceiveSocket(std::atomic<bool>& stop);
+        void ReceiveShared(std::atomic<bool>& stop);
+        int  SendOnSocket(const ByteBuffer& wire);
+        int  SendOnRing(const IpcMessage& msg);
+        void OfferSharedMemory();
+        int  AcceptSharedMemory();
         void CompactRecvBuf();
         bool RejectOversizeForOp();
         void OnClose();
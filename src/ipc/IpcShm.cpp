@@ -0,0 +1,494 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2025 MaNGOS <https://www.getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "IpcShm.h"
+#include "IpcVersion.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <new>
+
+#if defined(__linux__)
+#include <chrono>
+#include <ctime>
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    /// "MAHS": mangos AH shared memory.
+    const uint32 IPC_SHM_MAGIC   = 0x5348414Du;
+    const uint32 IPC_SHM_LAYOUT  = 1u;
+    const uint32 FRAME_HEADER    = 8u;    ///< version + opcode + body length
+    const int    WRITE_WAIT_MS   = 200;
+}
+
+static_assert(ATOMIC_INT_LOCK_FREE == 2,
+              "the shared-memory rings need lock-free 32-bit atomics");
+
+/// One cache line per role, so producer and consumer never false-share.
+struct IpcShmChannel::RingHeader
+{
+    // Written by the producer.
+    alignas(64) std::atomic<uint32> tail;        ///< bytes ever written
+    std::atomic<uint32>             dataSeq;     ///< data doorbell (futex word)
+    std::atomic<uint32>             dataWaiters; ///< consumer asleep on dataSeq
+    // Written by the consumer.
+    alignas(64) std::atomic<uint32> head;        ///< bytes ever consumed
+    std::atomic<uint32>             spaceSeq;    ///< space doorbell (futex word)
+    std::atomic<uint32>             spaceWaiters;///< producer asleep on spaceSeq
+};
+
+struct IpcShmChannel::RegionHeader
+{
+    alignas(64) uint32 magic;
+    uint32             layout;
+    uint32             ringBytes;
+};
+
+#if defined(__linux__)
+
+namespace
+{
+    const size_t RING_HEADERS_AT = 64u;
+    const size_t DATA_AT         = RING_HEADERS_AT + 2u * 128u;
+
+    /// Sleep while *word == expected, at most timeoutMs. Cross-process, so
+    /// not FUTEX_PRIVATE.
+    void FutexWait(std::atomic<uint32>& word, uint32 expected, int timeoutMs)
+    {
+        timespec ts;
+        ts.tv_sec  = timeoutMs / 1000;
+        ts.tv_nsec = static_cast<long>(timeoutMs % 1000) * 1000000L;
+        ::syscall(SYS_futex, reinterpret_cast<uint32*>(&word), FUTEX_WAIT,
+                  expected, &ts, NULL, 0);
+    }
+
+    void FutexWake(std::atomic<uint32>& word)
+    {
+        ::syscall(SYS_futex, reinterpret_cast<uint32*>(&word), FUTEX_WAKE,
+                  1, NULL, NULL, 0);
+    }
+
+    /// Ring @p seq, waking its sleeper if it announced itself. Pairs with the
+    /// waiter's "announce, re-check, sleep": whichever side moves second sees
+    /// the other (all seq_cst).
+    void Doorbell(std::atomic<uint32>& seq, std::atomic<uint32>& waiters)
+    {
+        seq.fetch_add(1u);
+        if (waiters.load() != 0u)
+        {
+            FutexWake(seq);
+        }
+    }
+
+    std::atomic<uint32> g_shmSerial(0);
+}
+
+bool IpcShmChannel::Supported()
+{
+    return true;
+}
+
+IpcShmChannel::IpcShmChannel()
+    : m_base(NULL), m_mapBytes(0), m_ringBytes(0), m_owner(false),
+      m_tx(0), m_rx(1), m_txTail(0), m_rxHead(0)
+{
+}
+
+IpcShmChannel::~IpcShmChannel()
+{
+    Unlink();
+    if (m_base != NULL)
+    {
+        ::munmap(m_base, m_mapBytes);
+        m_base = NULL;
+    }
+}
+
+bool IpcShmChannel::Create(uint32 ringBytes)
+{
+    if (m_base != NULL || ringBytes < FRAME_HEADER + IPC_MAX_FRAME ||
+        (ringBytes & (ringBytes - 1u)) != 0u)
+    {
+        return false;
+    }
+
+    // Unguessable enough that another account cannot pre-create the name;
+    // O_EXCL refuses it anyway if it does.
+    char name[64];
+    snprintf(name, sizeof(name), "/mangos-ah-%u-%u-%llx",
+             static_cast<unsigned>(::getpid()),
+             static_cast<unsigned>(g_shmSerial.fetch_add(1u)),
+             static_cast<unsigned long long>(
+                 std::chrono::steady_clock::now().time_since_epoch().count()));
+
+    const int fd = ::shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd < 0)
+    {
+        return false;
+    }
+    m_name  = name;
+    m_owner = true;
+    m_ringBytes = ringBytes;
+
+    const bool ok = Map(fd, true);
+    ::close(fd);
+    if (!ok)
+    {
+        Unlink();
+        return false;
+    }
+
+    RegionHeader* region = reinterpret_cast<RegionHeader*>(m_base);
+    region->magic     = IPC_SHM_MAGIC;
+    region->layout    = IPC_SHM_LAYOUT;
+    region->ringBytes = ringBytes;
+    for (uint32 i = 0; i < 2u; ++i)
+    {
+        RingHeader* ring = new (Ring(i)) RingHeader();
+        ring->tail.store(0u);
+        ring->dataSeq.store(0u);
+        ring->dataWaiters.store(0u);
+        ring->head.store(0u);
+        ring->spaceSeq.store(0u);
+        ring->spaceWaiters.store(0u);
+    }
+
+    m_tx = 0u;
+    m_rx = 1u;
+    return true;
+}
+
+bool IpcShmChannel::Open(const std::string& name, uint32 ringBytes)
+{
+    if (m_base != NULL || name.empty() || name[0] != '/' ||
+        ringBytes < FRAME_HEADER + IPC_MAX_FRAME ||
+        (ringBytes & (ringBytes - 1u)) != 0u)
+    {
+        return false;
+    }
+
+    const int fd = ::shm_open(name.c_str(), O_RDWR, 0600);
+    if (fd < 0)
+    {
+        return false;
+    }
+    m_name = name;
+    m_ringBytes = ringBytes;
+
+    const bool ok = Map(fd, false);
+    ::close(fd);
+    if (!ok)
+    {
+        return false;
+    }
+
+    const RegionHeader* region = reinterpret_cast<const RegionHeader*>(m_base);
+    if (region->magic != IPC_SHM_MAGIC || region->layout != IPC_SHM_LAYOUT ||
+        region->ringBytes != ringBytes)
+    {
+        ::munmap(m_base, m_mapBytes);
+        m_base = NULL;
+        return false;
+    }
+
+    m_tx = 1u;
+    m_rx = 0u;
+    m_txTail = Ring(m_tx)->tail.load();
+    m_rxHead = Ring(m_rx)->head.load();
+    return true;
+}
+
+bool IpcShmChannel::Map(int fd, bool create)
+{
+    m_mapBytes = DATA_AT + 2u * static_cast<size_t>(m_ringBytes);
+
+    if (create)
+    {
+        if (::ftruncate(fd, static_cast<off_t>(m_mapBytes)) != 0)
+        {
+            return false;
+        }
+    }
+    else
+    {
+        struct stat st;
+        if (::fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < m_mapBytes)
+        {
+            return false;
+        }
+    }
+
+    void* p = ::mmap(NULL, m_mapBytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (p == MAP_FAILED)
+    {
+        return false;
+    }
+    m_base = static_cast<uint8*>(p);
+    return true;
+}
+
+void IpcShmChannel::Unlink()
+{
+    if (m_owner && !m_name.empty())
+    {
+        ::shm_unlink(m_name.c_str());
+    }
+    m_owner = false;
+}
+
+IpcShmChannel::RingHeader* IpcShmChannel::Ring(uint32 index) const
+{
+    static_assert(sizeof(RingHeader) == 128u, "ring header layout");
+    return reinterpret_cast<RingHeader*>(m_base + RING_HEADERS_AT + index * 128u);
+}
+
+uint8* IpcShmChannel::Data(uint32 index) const
+{
+    return m_base + DATA_AT + static_cast<size_t>(index) * m_ringBytes;
+}
+
+void IpcShmChannel::CopyIn(uint8* data, uint32 pos, const uint8* src, uint32 len) const
+{
+    const uint32 at    = pos & (m_ringBytes - 1u);
+    const uint32 first = std::min(len, m_ringBytes - at);
+    memcpy(data + at, src, first);
+    if (first < len)
+    {
+        memcpy(data, src + first, len - first);
+    }
+}
+
+void IpcShmChannel::CopyOut(const uint8* data, uint32 pos, uint8* dst, uint32 len) const
+{
+    const uint32 at    = pos & (m_ringBytes - 1u);
+    const uint32 first = std::min(len, m_ringBytes - at);
+    memcpy(dst, data + at, first);
+    if (first < len)
+    {
+        memcpy(dst + first, data, len - first);
+    }
+}
+
+int IpcShmChannel::Write(const IpcMessage& msg, const std::atomic<bool>& abort)
+{
+    if (m_base == NULL || msg.body.size() > IPC_MAX_FRAME)
+    {
+        return -1;
+    }
+
+    RingHeader* ring = Ring(m_tx);
+    const uint32 bodyLen = static_cast<uint32>(msg.body.size());
+    const uint32 need    = FRAME_HEADER + bodyLen;
+
+    for (;;)
+    {
+        const uint32 used = m_txTail - ring->head.load(std::memory_order_acquire);
+        if (used > m_ringBytes)
+        {
+            return -1;  // the consumer's head is not one we could have produced
+        }
+        if (m_ringBytes - used >= need)
+        {
+            break;
+        }
+
+        // Full: announce, re-check, then sleep on the consumer's doorbell.
+        ring->spaceWaiters.store(1u);
+        const uint32 seen = ring->spaceSeq.load();
+        if (m_ringBytes - (m_txTail - ring->head.load()) < need)
+        {
+            FutexWait(ring->spaceSeq, seen, WRITE_WAIT_MS);
+        }
+        ring->spaceWaiters.store(0u);
+        if (abort.load(std::memory_order_acquire))
+        {
+            return -1;
+        }
+    }
+
+    // Same little-endian header IpcMessage::Encode writes.
+    uint8 header[FRAME_HEADER];
+    uint16 version = IPC_PROTOCOL_VERSION;
+    uint16 op      = static_cast<uint16>(msg.op);
+    uint32 len     = bodyLen;
+    EndianConvert(version);
+    EndianConvert(op);
+    EndianConvert(len);
+    memcpy(header, &version, 2);
+    memcpy(header + 2, &op, 2);
+    memcpy(header + 4, &len, 4);
+
+    uint8* data = Data(m_tx);
+    CopyIn(data, m_txTail, header, FRAME_HEADER);
+    if (bodyLen != 0u)
+    {
+        CopyIn(data, m_txTail + FRAME_HEADER, msg.body.contents(), bodyLen);
+    }
+    m_txTail += need;
+    ring->tail.store(m_txTail, std::memory_order_release);
+    Doorbell(ring->dataSeq, ring->dataWaiters);
+    return 0;
+}
+
+int IpcShmChannel::Read(IpcMessage& out, int timeoutMs, std::string& err,
+                        HeaderCheck check)
+{
+    if (m_base == NULL)
+    {
+        err = "not mapped";
+        return -1;
+    }
+
+    RingHeader* ring = Ring(m_rx);
+    uint32 avail = ring->tail.load(std::memory_order_acquire) - m_rxHead;
+    if (avail == 0u)
+    {
+        // Empty: announce, re-check, then sleep on the producer's doorbell.
+        ring->dataWaiters.store(1u);
+        const uint32 seen = ring->dataSeq.load();
+        avail = ring->tail.load() - m_rxHead;
+        if (avail == 0u)
+        {
+            FutexWait(ring->dataSeq, seen, timeoutMs);
+            avail = ring->tail.load(std::memory_order_acquire) - m_rxHead;
+        }
+        ring->dataWaiters.store(0u);
+        if (avail == 0u)
+        {
+            return 0;
+        }
+    }
+
+    // The producer publishes whole frames only, so anything short of a full
+    // header + body here is a corrupt (or hostile) ring.
+    if (avail > m_ringBytes || avail < FRAME_HEADER)
+    {
+        err = "ring position out of range";
+        return -1;
+    }
+
+    uint8 header[FRAME_HEADER];
+    const uint8* data = Data(m_rx);
+    CopyOut(data, m_rxHead, header, FRAME_HEADER);
+    uint16 version;
+    uint16 op;
+    uint32 len;
+    memcpy(&version, header, 2);
+    memcpy(&op, header + 2, 2);
+    memcpy(&len, header + 4, 4);
+    EndianConvert(version);
+    EndianConvert(op);
+    EndianConvert(len);
+
+    if (version != IPC_PROTOCOL_VERSION)
+    {
+        err = "version mismatch";
+        return -1;
+    }
+    if (len > IPC_MAX_FRAME)
+    {
+        err = "oversize frame";
+        return -1;
+    }
+    if (len > avail - FRAME_HEADER)
+    {
+        err = "truncated frame";
+        return -1;
+    }
+    if (check != NULL && check(op, len))
+    {
+        err = "oversize frame for opcode";
+        return -1;
+    }
+
+    out.op = IpcOpcode(op);
+    out.body.clear();
+    if (len != 0u)
+    {
+        // Straight from the ring into the message body (two runs if the
+        // frame wraps).
+        const uint32 at    = (m_rxHead + FRAME_HEADER) & (m_ringBytes - 1u);
+        const uint32 first = std::min(len, m_ringBytes - at);
+        out.body.append(data + at, first);
+        if (first < len)
+        {
+            out.body.append(data, len - first);
+        }
+    }
+
+    m_rxHead += FRAME_HEADER + len;
+    ring->head.store(m_rxHead, std::memory_order_release);
+    Doorbell(ring->spaceSeq, ring->spaceWaiters);
+    return 1;
+}
+
+#else // !__linux__
+
+bool IpcShmChannel::Supported()
+{
+    return false;
+}
+
+IpcShmChannel::IpcShmChannel()
+    : m_base(NULL), m_mapBytes(0), m_ringBytes(0), m_owner(false),
+      m_tx(0), m_rx(1), m_txTail(0), m_rxHead(0)
+{
+}
+
+IpcShmChannel::~IpcShmChannel()
+{
+}
+
+bool IpcShmChannel::Create(uint32 /*ringBytes*/)
+{
+    return false;
+}
+
+bool IpcShmChannel::Open(const std::string& /*name*/, uint32 /*ringBytes*/)
+{
+    return false;
+}
+
+void IpcShmChannel::Unlink()
+{
+}
+
+int IpcShmChannel::Write(const IpcMessage& /*msg*/, const std::atomic<bool>& /*abort*/)
+{
+    return -1;
+}
+
+int IpcShmChannel::Read(IpcMessage& /*out*/, int /*timeoutMs*/, std::string& err,
+                        HeaderCheck /*check*/)
+{
+    err = "shared memory transport not built";
+    return -1;
+}
+
+#endif // __linux__
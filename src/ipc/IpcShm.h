@@ -0,0 +1,138 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2025 MaNGOS <https://www.getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef AH_IPC_SHM_H
+#define AH_IPC_SHM_H
+
+#include "Common.h"
+#include "IpcMessage.h"
+
+#include <atomic>
+#include <string>
+
+/**
+ * @brief Bytes of ring storage per direction. A power of two (positions wrap
+ *        modulo 2^32) and larger than the biggest legal frame
+ *        (8 + IPC_MAX_FRAME), so any frame fits once the consumer catches up.
+ */
+static const uint32 IPC_SHM_RING_BYTES = 2u << 20;
+
+/**
+ * @brief Shared-memory data plane for one IPC connection (Linux only).
+ *
+ * Two single-producer/single-consumer byte rings live in one POSIX shared
+ * memory object: ring 0 carries mangosd -> worker frames, ring 1 worker ->
+ * mangosd. A frame is stored exactly as on the TCP stream (the 8-byte
+ * IpcMessage header, then the body), written straight from the message and
+ * copied straight into the receiver's IpcMessage: no wire ByteBuffer, no
+ * syscall on the data path. A consumer with nothing to read sleeps on a futex
+ * doorbell that the producer rings only while someone is waiting; a producer
+ * facing a full ring sleeps on the consumer's doorbell the same way.
+ *
+ * The TCP connection stays open underneath: it carries the authenticated
+ * handshake and the upgrade (IPC_SHM_OFFER / IPC_SHM_ACCEPT / IPC_SHM_SWITCH,
+ * see IpcServerHandler), and its closure remains the liveness signal.
+ *
+ * TRUST: the worker can write the whole region. Each side therefore keeps its
+ * own position (the producer its tail, the consumer its head) in private
+ * memory and only reads the peer's position, rejecting any value that would
+ * put more than the ring size in flight; every frame header is bounds- and
+ * version-checked before its body is copied. A corrupt ring is fatal to the
+ * connection, exactly like a framing error on the socket.
+ *
+ * Each direction must have a single writer and a single reader; the handlers
+ * guarantee that with their send mutex and their one receive thread.
+ */
+class IpcShmChannel
+{
+    public:
+        /// Optional header veto for Read(): true = reject the frame (fatal).
+        typedef bool (*HeaderCheck)(uint16 op, uint32 bodyLen);
+
+        /// False where the transport is not built (the caller stays on TCP).
+        static bool Supported();
+
+        IpcShmChannel();
+        ~IpcShmChannel();
+
+        /**
+         * @brief Server side: create, size and map a fresh owner-only shared
+         *        memory object, and initialise both rings. Writes ring 0.
+         * @return true on success; Name() then identifies the object.
+         */
+        bool Create(uint32 ringBytes);
+
+        /**
+         * @brief Client side: map the object offered by the server and check
+         *        its layout. Writes ring 1.
+         * @return true on success.
+         */
+        bool Open(const std::string& name, uint32 ringBytes);
+
+        /// Remove the name (the mappings stay valid). Idempotent.
+        void Unlink();
+
+        const std::string& Name() const { return m_name; }
+        uint32 RingBytes() const { return m_ringBytes; }
+        bool Valid() const { return m_base != NULL; }
+
+        /**
+         * @brief Append one frame. Blocks while the ring is full, re-checking
+         *        @p abort every 200 ms.
+         * @return 0 on success, -1 if the frame can never fit, the ring is
+         *         corrupt, or @p abort was raised.
+         */
+        int Write(const IpcMessage& msg, const std::atomic<bool>& abort);
+
+        /**
+         * @brief Take the next frame, waiting up to @p timeoutMs for one.
+         * @return 1 frame read, 0 nothing arrived, -1 corrupt ring (@p err
+         *         says why).
+         */
+        int Read(IpcMessage& out, int timeoutMs, std::string& err,
+                 HeaderCheck check = NULL);
+
+    private:
+        struct RingHeader;
+        struct RegionHeader;
+
+        bool Map(int fd, bool create);
+        RingHeader* Ring(uint32 index) const;
+        uint8* Data(uint32 index) const;
+        void CopyIn(uint8* data, uint32 pos, const uint8* src, uint32 len) const;
+        void CopyOut(const uint8* data, uint32 pos, uint8* dst, uint32 len) const;
+
+        uint8*      m_base;
+        size_t      m_mapBytes;
+        uint32      m_ringBytes;
+        std::string m_name;
+        bool        m_owner;        ///< we created the name (and unlink it)
+        uint32      m_tx;           ///< ring this side writes
+        uint32      m_rx;           ///< ring this side reads
+        uint32      m_txTail;       ///< private producer position
+        uint32      m_rxHead;       ///< private consumer position
+
+        // Non-copyable: owns a mapping.
+        IpcShmChannel(const IpcShmChannel&);
+        IpcShmChannel& operator=(const IpcShmChannel&);
+};
+
+#endif // AH_IPC_SHM_H
@@ -25,6 +25,8 @@
 #include "Common.h"
 #include "Utilities/ByteBuffer.h"
 
+#include <vector>
+
 /**
  * @file PlayerMutations.h
  * @brief SP-2 wire types: player mutations + worker-initiated resolutions.
@@ -295,6 +297,58 @@ struct PlayerMutationResult
     }
 };
 
+// ---------------------------------------------------------------------------
+// PlayerMutationResultBatch  (wire size = 2 + count * 64 bytes)
+// ---------------------------------------------------------------------------
+
+/**
+ * @brief Several results in one IPC_PLAYER_RESULT_BATCH frame: the replies of
+ *        one worker group commit. A uint16 count, then count records laid out
+ *        exactly as IPC_PLAYER_RESULT bodies, in commit order.
+ */
+struct PlayerMutationResultBatch
+{
+    static const size_t MAX_RECORDS = 64u;
+    static const size_t MAX_WIRE    = 2u + MAX_RECORDS * PlayerMutationResult::WIRE_SIZE;
+
+    std::vector<PlayerMutationResult> results;
+
+    void Encode(ByteBuffer& buf) const
+    {
+        buf << uint16(results.size());
+        for (size_t i = 0; i < results.size(); ++i)
+        {
+            results[i].Encode(buf);
+        }
+    }
+
+    /// Rejects an empty or over-long batch and any count that does not match
+    /// the body length exactly.
+    bool Decode(ByteBuffer& buf)
+    {
+        if (buf.rpos() + 2u > buf.size())
+        {
+            return false;
+        }
+        uint16 count = 0;
+        buf >> count;
+        if (count == 0u || count > MAX_RECORDS ||
+            buf.rpos() + count * PlayerMutationResult::WIRE_SIZE != buf.size())
+        {
+            return false;
+        }
+        results.resize(count);
+        for (uint16 i = 0; i < count; ++i)
+        {
+            if (!results[i].Decode(buf))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
 // ---------------------------------------------------------------------------
 // ResolveApply  (wire size = 8+1 + 53 = 62 bytes)
 // ---------------------------------------------------------------------------
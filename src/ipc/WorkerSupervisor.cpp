@@ -67,7 +67,11 @@ WorkerSupervisor::WorkerSupervisor(const std::string& name,
     // running, never toward a silent stall).
     , m_childHealthy(false)
     , m_runId(0)
+    , m_runIdSlot(0)
+    , m_runIdStride(1)
+    , m_houses(AH_HOUSE_MASK_ALL)
     , m_writeAuthority(false)
+    , m_sharedMemory(false)
     , m_appDropped(0)
 #ifdef _WIN32
     , m_jobObject(NULL)
@@ -148,7 +152,7 @@ bool WorkerSupervisor::Start()
 bool WorkerSupervisor::SpawnChild()
 {
     // Build the argument list.
-    // ah-service --port <p> --botguid <g> --config <c>
+    // ah-service --port <p> --botguid <g> --config <c> [--houses <groups>]
     //
     // C4: the shared secret is passed OUT-OF-BAND via the AH_SERVICE_SECRET
     // environment variable and is NOT placed on argv, so it cannot be read from
@@ -162,6 +166,11 @@ bool WorkerSupervisor::SpawnChild()
     args.push_back(std::to_string(static_cast<unsigned>(m_botGuid)));
     args.push_back("--config");
     args.push_back(m_cfgPath);
+    if (m_houses != AH_HOUSE_MASK_ALL)
+    {
+        args.push_back("--houses");
+        args.push_back(AhHouseMaskName(m_houses));
+    }
 
     // For logging: the argument list carries NO secret, so it is safe to log.
     std::string cmdLog = m_exePath;
@@ -171,12 +180,14 @@ bool WorkerSupervisor::SpawnChild()
         cmdLog += a;
     }
 
-    // Assign a new per-spawn run-id (monotonically increasing; 0 is never used).
+    // Assign a new per-spawn run-id (monotonically increasing; 0 is never used;
+    // sibling shards step through disjoint residues, see SetRunIdSlot()).
     // Arm the run-id + SP-2 write-authority for the IPC_HELLO_ACK before the
     // child can connect.
-    ++m_runId;
+    m_runId = (m_runId == 0) ? m_runIdSlot + 1 : m_runId + m_runIdStride;
     m_ipc.SetRunId(m_runId);
     m_ipc.SetWriteAuthority(m_writeAuthority);
+    m_ipc.SetSharedMemory(m_sharedMemory);
     sLog.outString("[WorkerSupervisor:%s] assigned run-id %u",
                    m_name.c_str(), static_cast<unsigned>(m_runId));
 
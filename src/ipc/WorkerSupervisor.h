@@ -23,6 +23,7 @@
 #define AH_WORKER_SUPERVISOR_H
 
 #include "Common.h"
+#include "AhHouseShards.h"
 #include "IpcChannel.h"
 #include "IpcMessage.h"
 #include "IpcProcess.h"
@@ -171,6 +172,35 @@ class WorkerSupervisor
          */
         void SetWriteAuthority(bool on) { m_writeAuthority = on; }
 
+        /**
+         * @brief Offer the worker the shared-memory ring transport after its
+         *        handshake. Call before Start(); applied on every spawn.
+         */
+        void SetSharedMemory(bool on) { m_sharedMemory = on; }
+
+        /**
+         * @brief Restrict the worker to the house groups in @p mask
+         *        (AhHouseShards.h), passed to the child as --houses. Call
+         *        before Start(); the default owns every group.
+         */
+        void SetHouses(uint8 mask) { m_houses = mask; }
+
+        /// House groups this supervisor's worker owns.
+        uint8 Houses() const { return m_houses; }
+
+        /**
+         * @brief Keep this supervisor's run-ids disjoint from its sibling
+         *        shards': spawn n is given run-id (n - 1) * @p stride +
+         *        @p slot + 1. The worker mints uuids under its run-id, so two
+         *        shards must never hold the same one. Call before Start();
+         *        the default (slot 0, stride 1) numbers spawns 1, 2, 3, ...
+         */
+        void SetRunIdSlot(uint32 slot, uint32 stride)
+        {
+            m_runIdSlot   = slot;
+            m_runIdStride = stride;
+        }
+
         /**
          * @brief Drain up to @p maxPerTick application frames into @p out.
          *
@@ -283,8 +313,12 @@ class WorkerSupervisor
         std::string  m_secret;
         uint32       m_botGuid;
         std::string  m_cfgPath;
-        uint32       m_runId;       ///< Per-spawn run-id; incremented on every spawn.
+        uint32       m_runId;       ///< Per-spawn run-id; advanced on every spawn.
+        uint32       m_runIdSlot;   ///< First run-id - 1 (shard index).
+        uint32       m_runIdStride; ///< Run-id step between spawns (shard count).
+        uint8        m_houses;      ///< House-group mask passed as --houses.
         bool         m_writeAuthority; ///< [SP-2] authority bit sent in IPC_HELLO_ACK.
+        bool         m_sharedMemory;   ///< offer IPC_SHM_OFFER after IPC_READY.
 
         IpcServer    m_ipc;
 
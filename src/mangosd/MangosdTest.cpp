@@ -6,6 +6,8 @@
 #include "ObjectMgr.h"
 #include "ObjectGuid.h"
 #include "AuctionHouseMgr.h"
+#include "DBCStores.h"
+#include "SQLStorages.h"
 #include "AuctionHouseBot/AhBotSystemOwner.h"
 #include "AuctionHouseBot/AuctionIntentExecutor.h"
 #include "AuctionHouseBot/CustodyDeferred.h"
@@ -21,14 +23,19 @@
 #include "BrowseMessages.h"
 #include "World.h"
 #include "PlayerMutations.h"
+#include "UpdateData.h"
+#include "UpdateFields.h"
+#include <zlib.h>
+#include <chrono>
 #include <cstdio>
+#include <cstring>
 #include <ctime>
 #include <memory>
 #include <string>
 
 bool AhBuildCancelPrepareForward(MutationPendingMap& pending, uint32 playerGuidLow,
-                                 uint32 auctionId, uint64 uuid, uint32 sentSec,
-                                 IpcMessage& out);
+                                 uint32 auctionId, uint8 houseGroup, uint64 uuid,
+                                 uint32 sentSec, IpcMessage& out);
 bool AhRepairCommittedCancelAuction(uint32 auctionId, uint32& repairedRows);
 
 static void TestCliPrint(void* /*arg*/, char const* /*text*/)
@@ -1491,7 +1498,7 @@ static int RunAhForwardReserveTest()
     MutationPendingMap cancelPend;
     uint64 const cancelUuid = UINT64_C(0xCA00000000000043);
     IpcMessage cancelFrame;
-    if (!AhBuildCancelPrepareForward(cancelPend, 1u, sellId, cancelUuid, 1234u,
+    if (!AhBuildCancelPrepareForward(cancelPend, 1u, sellId, 2u, cancelUuid, 1234u,
                                      cancelFrame))
     {
         printf("ahforwardreserve FAIL: cancel forward helper refused empty map\n");
@@ -1520,7 +1527,8 @@ static int RunAhForwardReserveTest()
         cancelPm.reservedAmount != 0u ||
         !cancelPm.reserveKey.empty() ||
         !cancelPm.itemKey.empty() ||
-        !cancelPm.depKey.empty())
+        !cancelPm.depKey.empty() ||
+        cancelPm.houseGroup != 2u)
     {
         printf("ahforwardreserve FAIL: cancel pending shape\n");
         pass = false;
@@ -3172,6 +3180,347 @@ static int RunAhMaterializeTest()
     return 1;
 }
 
+/// Append one creature CREATE_OBJECT2 block shaped like what
+/// Object::BuildCreateUpdateBlockForPlayer emits for a mob: living movement
+/// block, then a values block with the fields a creature actually sets.
+static void BenchAppendCreatureCreateBlock(UpdateData& data, uint32 lowGuid, uint32 entry)
+{
+    ByteBuffer& buf = data.GetBuffer();
+    ObjectGuid const guid(HIGHGUID_UNIT, entry, lowGuid);
+
+    buf << uint8(UPDATETYPE_CREATE_OBJECT2);
+    buf << guid.WriteAsPacked();
+    buf << uint8(TYPEID_UNIT);
+    buf << uint8(UPDATEFLAG_ALL | UPDATEFLAG_LIVING | UPDATEFLAG_HAS_POSITION);
+
+    // movement: flags, time, position, fall time, six speeds
+    buf << uint32(0) << uint32(lowGuid * 37u);
+    buf << float(-8913.2f + lowGuid % 50) << float(554.6f + lowGuid % 30) << float(93.1f) << float(0.5f * (lowGuid % 12));
+    buf << uint32(0);
+    buf << float(2.5f) << float(7.0f) << float(4.5f) << float(4.722222f) << float(2.5f) << float(3.141594f);
+    buf << uint32(1);                                       // UPDATEFLAG_ALL
+
+    // values: update mask then the set fields, in index order
+    uint32 const fields[] =
+    {
+        OBJECT_FIELD_GUID, OBJECT_FIELD_GUID + 1, OBJECT_FIELD_TYPE, OBJECT_FIELD_ENTRY, OBJECT_FIELD_SCALE_X,
+        UNIT_FIELD_HEALTH, UNIT_FIELD_MAXHEALTH, UNIT_FIELD_LEVEL, UNIT_FIELD_FACTIONTEMPLATE,
+        UNIT_FIELD_BYTES_0, UNIT_FIELD_FLAGS, UNIT_FIELD_DISPLAYID, UNIT_FIELD_DISPLAYID + 1
+    };
+    uint32 const maskBlocks = (UNIT_END + 31) / 32;
+    std::vector<uint32> mask(maskBlocks, 0);
+    for (uint32 field : fields)
+    {
+        mask[field / 32] |= 1u << (field % 32);
+    }
+
+    buf << uint8(maskBlocks);
+    for (uint32 block : mask)
+    {
+        buf << block;
+    }
+
+    buf << uint32(guid.GetRawValue() & 0xFFFFFFFF) << uint32(guid.GetRawValue() >> 32);
+    buf << uint32(TYPEMASK_OBJECT | TYPEMASK_UNIT) << entry << float(1.0f);
+    buf << uint32(1200 + lowGuid % 300) << uint32(1500) << uint32(10 + lowGuid % 50) << uint32(14);
+    buf << uint32(0x00000100) << uint32(0x00000008) << uint32(entry % 4000) << uint32(entry % 4000);
+
+    data.AddUpdateBlock();
+}
+
+/// Zlib baseline: what UpdateData::Compress did before it kept a deflate
+/// stream per thread -- deflateInit/deflateEnd around every packet.
+static uLong BenchCompressFreshStream(std::vector<uint8>& dst, ByteBuffer const& src, int level)
+{
+    z_stream c_stream;
+    std::memset(&c_stream, 0, sizeof(c_stream));
+    if (deflateInit(&c_stream, level) != Z_OK)
+    {
+        return 0;
+    }
+
+    c_stream.next_out = dst.data();
+    c_stream.avail_out = uInt(dst.size());
+    c_stream.next_in = const_cast<Bytef*>(src.contents());
+    c_stream.avail_in = uInt(src.size());
+    int const z_res = deflate(&c_stream, Z_FINISH);
+    uLong const out = z_res == Z_STREAM_END ? c_stream.total_out : 0;
+    deflateEnd(&c_stream);
+    return out;
+}
+
+namespace
+{
+    struct BrowseIndexQuery
+    {
+        char const* name;
+        uint32 levelmin;
+        uint32 levelmax;
+        uint32 inventoryType;
+        uint32 itemClass;
+        uint32 itemSubClass;
+        uint32 quality;
+    };
+
+    /// The template-only part of BuildListAuctionItems' filter.
+    bool BrowseIndexMatches(AuctionEntry const* a, BrowseIndexQuery const& q, std::wstring const& wname)
+    {
+        ItemPrototype const* proto = ObjectMgr::GetItemPrototype(a->itemTemplate);
+        if (!proto)
+        {
+            return false;
+        }
+        if ((q.itemClass != 0xffffffff && proto->Class != q.itemClass) ||
+            (q.itemSubClass != 0xffffffff && proto->SubClass != q.itemSubClass) ||
+            (q.inventoryType != 0xffffffff && proto->InventoryType != q.inventoryType) ||
+            (q.quality != 0xffffffff && proto->Quality < q.quality) ||
+            (q.levelmin != 0x00 && (proto->RequiredLevel < q.levelmin ||
+                (q.levelmax != 0x00 && proto->RequiredLevel > q.levelmax))))
+        {
+            return false;
+        }
+        return wname.empty() || Utf8FitTo(proto->Name1, wname);
+    }
+}
+
+/// Self-test for the AuctionHouseObject browse index: fills a private house
+/// with auctions over the loaded item_template, then checks for a battery of
+/// filters that CollectBrowseCandidates returns every match of a full scan,
+/// in ascending auction id order, and for a class filter no more than that
+/// class holds. Repeats after removals and an id re-use. Returns 0 on pass.
+static int RunAhBrowseIndexTest()
+{
+    AuctionHouseEntry const* houseEntry = sAuctionHouseStore.LookupEntry(7);
+    if (!houseEntry)
+    {
+        printf("ahbrowseindex FAIL: AuctionHouse.dbc has no neutral house\n");
+        return 2;
+    }
+
+    // Two auctions per template for the first 1500 templates, ids interleaved
+    // so every bucket is a scattered id range.
+    AuctionHouseObject house;
+    std::vector<uint32> templates;
+    for (uint32 id = 0; id < sItemStorage.GetMaxEntry() && templates.size() < 1500u; ++id)
+    {
+        if (sItemStorage.LookupEntry<ItemPrototype>(id))
+        {
+            templates.push_back(id);
+        }
+    }
+    if (templates.size() < 10u)
+    {
+        printf("ahbrowseindex FAIL: only %zu item templates loaded\n", templates.size());
+        return 2;
+    }
+    for (int copy = 0; copy < 2; ++copy)
+    {
+        for (size_t i = 0; i < templates.size(); ++i)
+        {
+            AuctionEntry* a = new AuctionEntry();
+            a->Id                = copy == 0 ? uint32(i * 2 + 1) : uint32(i * 2 + 2);
+            a->itemTemplate      = templates[(i * 7 + copy) % templates.size()];
+            a->itemCount         = 1;
+            a->auctionHouseEntry = houseEntry;
+            house.AddAuction(a);
+        }
+    }
+
+    ItemPrototype const* sample = ObjectMgr::GetItemPrototype(templates[templates.size() / 2]);
+    std::string sampleName = sample->Name1;
+    std::wstring wsample;
+    Utf8toWStr(sampleName, wsample);
+    wstrToLower(wsample);
+    std::string nameProbe;
+    WStrToUtf8(wsample.substr(0, 3), nameProbe);
+
+    BrowseIndexQuery const queries[] =
+    {
+        { "",          0,  0,  0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff },
+        { "",          0,  0,  0xffffffff, sample->Class, 0xffffffff, 0xffffffff },
+        { "",          0,  0,  0xffffffff, sample->Class, sample->SubClass, 0xffffffff },
+        { "",          0,  0,  sample->InventoryType, 0xffffffff, 0xffffffff, 0xffffffff },
+        { "",          0,  0,  0xffffffff, 0xffffffff, 0xffffffff, 3 },
+        { "",          10, 20, 0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff },
+        { "",          40, 0,  0xffffffff, 0xffffffff, 0xffffffff, 2 },
+        { "",          30, 20, 0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff },
+        { nameProbe.c_str(), 0, 0, 0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff },
+        { nameProbe.c_str(), 0, 0, 0xffffffff, sample->Class, 0xffffffff, 1 },
+        { sampleName.c_str(), 0, 0, 0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff },
+        { "zzqx no such item", 0, 0, 0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff },
+    };
+
+    for (int round = 0; round < 2; ++round)
+    {
+        for (size_t qi = 0; qi < sizeof(queries) / sizeof(queries[0]); ++qi)
+        {
+            BrowseIndexQuery const& q = queries[qi];
+            std::wstring wname;
+            Utf8toWStr(q.name, wname);
+            wstrToLower(wname);
+
+            std::vector<AuctionEntry*> candidates;
+            house.CollectBrowseCandidates(wname, -1, q.levelmin, q.levelmax, q.inventoryType,
+                q.itemClass, q.itemSubClass, q.quality, candidates);
+
+            for (size_t i = 1; i < candidates.size(); ++i)
+            {
+                if (candidates[i - 1]->Id >= candidates[i]->Id)
+                {
+                    printf("ahbrowseindex FAIL: query %zu round %d candidates not in id order\n", qi, round);
+                    return 1;
+                }
+            }
+
+            size_t matches = 0;
+            size_t classBucket = 0;
+            size_t c = 0;
+            AuctionHouseObject::AuctionEntryMap const& all = house.GetAuctions();
+            for (AuctionHouseObject::AuctionEntryMap::const_iterator itr = all.begin(); itr != all.end(); ++itr)
+            {
+                ItemPrototype const* proto = ObjectMgr::GetItemPrototype(itr->second->itemTemplate);
+                if (q.itemClass != 0xffffffff && proto->Class == q.itemClass)
+                {
+                    ++classBucket;
+                }
+                if (!BrowseIndexMatches(itr->second, q, wname))
+                {
+                    continue;
+                }
+                ++matches;
+                while (c < candidates.size() && candidates[c]->Id < itr->first)
+                {
+                    ++c;
+                }
+                if (c == candidates.size() || candidates[c] != itr->second)
+                {
+                    printf("ahbrowseindex FAIL: query %zu round %d missed auction %u\n", qi, round, itr->first);
+                    return 1;
+                }
+            }
+            if (q.itemClass != 0xffffffff && candidates.size() > classBucket)
+            {
+                printf("ahbrowseindex FAIL: query %zu round %d walked %zu > class bucket %zu\n",
+                       qi, round, candidates.size(), classBucket);
+                return 1;
+            }
+            if (q.levelmin > q.levelmax && q.levelmax != 0 && !candidates.empty())
+            {
+                printf("ahbrowseindex FAIL: query %zu round %d empty level range gave candidates\n", qi, round);
+                return 1;
+            }
+            printf("ahbrowseindex: round %d query %2zu: %5zu matches from %5zu candidates of %5zu\n",
+                   round, qi, matches, candidates.size(), all.size());
+        }
+
+        if (round == 0)
+        {
+            // Remove every third auction and re-use one removed id for
+            // another template: the index must follow both.
+            std::vector<AuctionEntry*> gone;
+            AuctionHouseObject::AuctionEntryMap const& all = house.GetAuctions();
+            for (AuctionHouseObject::AuctionEntryMap::const_iterator itr = all.begin(); itr != all.end(); ++itr)
+            {
+                if (itr->first % 3 == 0)
+                {
+                    gone.push_back(itr->second);
+                }
+            }
+            for (size_t i = 0; i < gone.size(); ++i)
+            {
+                if (!house.RemoveAuction(gone[i]->Id))
+                {
+                    printf("ahbrowseindex FAIL: RemoveAuction(%u) returned false\n", gone[i]->Id);
+                    return 1;
+                }
+                delete gone[i];
+            }
+
+            AuctionEntry* first = house.GetAuction(1);
+            AuctionEntry* reused = new AuctionEntry();
+            reused->Id                = 1;
+            reused->itemTemplate      = sample->ItemId;
+            reused->itemCount         = 1;
+            reused->auctionHouseEntry = houseEntry;
+            house.AddAuction(reused);
+            delete first;
+        }
+    }
+
+    std::vector<AuctionEntry*> left;
+    house.CollectBrowseCandidates(std::wstring(), -1, 0, 0, 0xffffffff, 0xffffffff,
+        0xffffffff, 0xffffffff, left);
+    if (left.size() != house.GetAuctions().size())
+    {
+        printf("ahbrowseindex FAIL: unfiltered walk has %zu of %zu auctions\n",
+               left.size(), house.GetAuctions().size());
+        return 1;
+    }
+
+    printf("ahbrowseindex OK\n");
+    return 0;
+}
+
+/// Microbenchmark for UpdateData::BuildPacket over realistic creature create
+/// blocks (the packet a player gets when a populated grid comes into view).
+/// Reports per-packet cost through BuildPacket, which reuses the thread's
+/// deflate stream, next to a fresh-stream-per-packet zlib baseline. No DB or
+/// world data needed. Returns 0 on pass.
+static int RunUpdateDataBench()
+{
+    uint32 const level = sWorld.getConfig(CONFIG_UINT32_COMPRESSION) ? sWorld.getConfig(CONFIG_UINT32_COMPRESSION) : 1;
+    sWorld.setConfig(CONFIG_UINT32_COMPRESSION, level);
+
+    uint32 const blockCounts[] = { 1, 8, 30, 100 };
+    uint32 const iterations = 2000;
+
+    for (uint32 blocks : blockCounts)
+    {
+        UpdateData data;
+        for (uint32 i = 0; i < blocks; ++i)
+        {
+            BenchAppendCreatureCreateBlock(data, 1000 + i, 3000 + (i * 7) % 400);
+        }
+
+        size_t rawSize = 0;
+        size_t packedSize = 0;
+        auto const buildStart = std::chrono::steady_clock::now();
+        for (uint32 i = 0; i < iterations; ++i)
+        {
+            WorldPacket packet;
+            if (!data.BuildPacket(&packet))
+            {
+                printf("updatedatabench FAIL: BuildPacket failed (%u blocks)\n", blocks);
+                return 1;
+            }
+            packedSize = packet.size();
+            rawSize = packet.GetOpcode() == SMSG_COMPRESSED_UPDATE_OBJECT ? packet.read<uint32>(0) : packet.size();
+        }
+        double const buildUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - buildStart).count() / iterations;
+
+        ByteBuffer raw(rawSize);
+        raw << uint32(blocks) << uint8(0);
+        raw.append(data.GetBuffer());
+        std::vector<uint8> out(compressBound(uLong(raw.size())));
+        auto const freshStart = std::chrono::steady_clock::now();
+        for (uint32 i = 0; i < iterations; ++i)
+        {
+            if (!BenchCompressFreshStream(out, raw, int(level)))
+            {
+                printf("updatedatabench FAIL: baseline deflate failed (%u blocks)\n", blocks);
+                return 1;
+            }
+        }
+        double const freshUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - freshStart).count() / iterations;
+
+        printf("updatedatabench: %3u create blocks, %6zu -> %6zu bytes: BuildPacket %8.2f us/packet, fresh-stream deflate %8.2f us/packet\n",
+               blocks, rawSize, packedSize, buildUs, freshUs);
+    }
+
+    printf("updatedatabench OK\n");
+    return 0;
+}
+
 int RunMangosdTest(std::string const& name)
 {
     if (name == "noop")
@@ -3250,6 +3599,16 @@ int RunMangosdTest(std::string const& name)
         return RunAhMaterializeTest();
     }
 
+    if (name == "ahbrowseindex")
+    {
+        return RunAhBrowseIndexTest();
+    }
+
+    if (name == "updatedatabench")
+    {
+        return RunUpdateDataBench();
+    }
+
     printf("%s FAIL: unknown test\n", name.c_str());
     return 2;
 }
@@ -49,11 +49,13 @@
 #include "SOAP/SoapThread.h"
 #endif
 
+#include <algorithm>
 #include <chrono>
 #include <cstdio>
 #include <cstdlib>
 #include <string>
 #include <thread>
+#include <vector>
 
 #ifdef _WIN32
 #include <windows.h>
@@ -141,7 +143,8 @@ namespace
      * @brief Open one database and verify its schema version.
      */
     bool OpenDatabase(DatabaseType& db, const char* infoKey, const char* connKey,
-                      const char* label, DatabaseTypes versionCheck)
+                      const char* shardKey, const char* label, DatabaseTypes versionCheck,
+                      int minConnections = 1)
     {
         const std::string dbstring = sConfig.GetStringDefault(infoKey, "");
         if (dbstring.empty())
@@ -150,10 +153,11 @@ namespace
             return false;
         }
 
-        const int nConnections = sConfig.GetIntDefault(connKey, 1);
-        sLog.outString("%s total connections: %i", label, nConnections + 1);
+        const int nConnections = std::max(sConfig.GetIntDefault(connKey, 1), minConnections);
+        const int nAsyncShards = sConfig.GetIntDefault(shardKey, 0);
+        sLog.outString("%s total connections: %i", label, nConnections + 1 + nAsyncShards);
 
-        if (!db.Initialize(dbstring.c_str(), nConnections))
+        if (!db.Initialize(dbstring.c_str(), nConnections, nAsyncShards))
         {
             sLog.outError("Can not connect to %s %s", label, dbstring.c_str());
             return false;
@@ -167,21 +171,22 @@ namespace
 
 bool Master::StartDatabases()
 {
-    if (!OpenDatabase(WorldDatabase, "WorldDatabaseInfo", "WorldDatabaseConnections",
-                      "World Database", DATABASE_WORLD))
+    // one connection per startup load thread, see World::SetInitialWorldSettings
+    if (!OpenDatabase(WorldDatabase, "WorldDatabaseInfo", "WorldDatabaseConnections", "WorldDatabaseAsyncShards",
+                      "World Database", DATABASE_WORLD, sConfig.GetIntDefault("StartupLoadThreads", 4)))
     {
         return false;
     }
     DatabaseGuard worldGuard(WorldDatabase);
 
-    if (!OpenDatabase(CharacterDatabase, "CharacterDatabaseInfo", "CharacterDatabaseConnections",
+    if (!OpenDatabase(CharacterDatabase, "CharacterDatabaseInfo", "CharacterDatabaseConnections", "CharacterDatabaseAsyncShards",
                       "Character Database", DATABASE_CHARACTER))
     {
         return false;
     }
     DatabaseGuard characterGuard(CharacterDatabase);
 
-    if (!OpenDatabase(LoginDatabase, "LoginDatabaseInfo", "LoginDatabaseConnections",
+    if (!OpenDatabase(LoginDatabase, "LoginDatabaseInfo", "LoginDatabaseConnections", "LoginDatabaseAsyncShards",
                       "Login Database", DATABASE_REALMD))
     {
         return false;
@@ -257,6 +262,9 @@ void Master::WorldLoop()
 {
     uint32 realPrevTime = getMSTime();
 
+    // from here on a synchronous query on this thread holds up the tick
+    SqlProfiler::SetThreadCaller(SQL_CALLER_WORLD);
+
     sLog.outString("World Updater started (%lldms min update interval)",
                    static_cast<long long>(WORLD_SLEEP_CONST.count()));
 
@@ -609,18 +617,20 @@ namespace
 #endif
 
     /**
-     * @brief The auction-house worker subprocess (optional, default-off).
+     * @brief The auction-house worker subprocess(es) (optional, default-off).
      *
-     * Not a thread: the supervisor owns a child process and its IPC link. It gets the
+     * Not a thread: each supervisor owns a child process and its IPC link. It gets the
      * same lifecycle as everything else so its Shutdown() is ordered by the same rule —
      * joined after the world loop has stopped, so no tick can race it.
+     *
+     * AH.Service.Shards splits the auction houses across several workers, one
+     * supervisor each, on consecutive ports from AH.Service.Port. A failed shard is
+     * isolated: the others still start and serve their houses.
      */
     class AhServiceService : public IService
     {
         public:
 
-            AhServiceService() : m_supervisor(nullptr) {}
-
             const char* Name() const override { return "AH service"; }
 
             void Start() override
@@ -632,49 +642,99 @@ namespace
                 // than silently reverting to in-process reads.
                 sWorld.SetAhServiceConfigured(true);
 
-                m_supervisor = new WorkerSupervisor(
-                    "ah-service",
-                    sConfig.GetStringDefault("AH.Service.Path", "service-workers/ah-service/ah-service"),
-                    uint16(sConfig.GetIntDefault("AH.Service.Port", 5760)),
-                    sConfig.GetStringDefault("AH.Service.Secret", "changeme"),
-                    sAuctionBotConfig.GetAHBotId(),
-                    sConfig.GetStringDefault("AH.Service.Config", "ah-service.conf"));
-
-                // SP-2: arm the write-authority bit for the IPC handshake BEFORE Start() --
-                // IPC_HELLO_ACK carries {runId, writeAuthority} to the worker (spec
-                // decision 7: the worker never reads it from its own conf). Applied on
-                // every child respawn.
-                m_supervisor->SetWriteAuthority(sWorld.IsAhWriteAuthority());
-
-                if (!m_supervisor->Start())
+                std::vector<uint8> shards;
+                std::string error;
+                if (!AhParseShardTable(sConfig.GetStringDefault("AH.Service.Shards", ""), shards, error))
                 {
-                    sLog.outError("AH service failed to start; falling back to in-process bot");
-                    delete m_supervisor;
-                    m_supervisor = nullptr;
+                    sLog.outError("AH.Service.Shards is invalid (%s); running one AH worker for all houses",
+                                  error.c_str());
+                    shards.assign(1, AH_HOUSE_MASK_ALL);
                 }
+                if (shards.size() > 1 && sWorld.getConfig(CONFIG_BOOL_ALLOW_TWO_SIDE_INTERACTION_AUCTION))
+                {
+                    // Cross-faction auctions merge every house into one book, which
+                    // only a single worker can hold.
+                    sLog.outError("AH.Service.Shards needs AllowTwoSide.Interaction.Auction = 0;"
+                                  " running one AH worker for all houses");
+                    shards.assign(1, AH_HOUSE_MASK_ALL);
+                }
+
+                uint16 const basePort = uint16(sConfig.GetIntDefault("AH.Service.Port", 5760));
+                for (size_t i = 0; i < shards.size(); ++i)
+                {
+                    std::string name = "ah-service";
+                    if (shards.size() > 1)
+                    {
+                        name += ":" + AhHouseMaskName(shards[i]);
+                    }
+
+                    WorkerSupervisor* sv = new WorkerSupervisor(
+                        name,
+                        sConfig.GetStringDefault("AH.Service.Path", "service-workers/ah-service/ah-service"),
+                        uint16(basePort + i),
+                        sConfig.GetStringDefault("AH.Service.Secret", "changeme"),
+                        sAuctionBotConfig.GetAHBotId(),
+                        sConfig.GetStringDefault("AH.Service.Config", "ah-service.conf"));
+
+                    // SP-2: arm the write-authority bit for the IPC handshake BEFORE Start() --
+                    // IPC_HELLO_ACK carries {runId, writeAuthority} to the worker (spec
+                    // decision 7: the worker never reads it from its own conf). Applied on
+                    // every child respawn.
+                    sv->SetWriteAuthority(sWorld.IsAhWriteAuthority());
+                    sv->SetSharedMemory(sConfig.GetBoolDefault("AH.Service.SharedMemory", false));
+                    // Shards own disjoint houses and mint uuids under disjoint run-ids.
+                    sv->SetHouses(shards[i]);
+                    sv->SetRunIdSlot(uint32(i), uint32(shards.size()));
+
+                    if (!sv->Start())
+                    {
+                        sLog.outError("AH service (%s) failed to start; its houses stay unavailable"
+                                      " until mangosd restarts", AhHouseMaskName(shards[i]).c_str());
+                        delete sv;
+                        continue;
+                    }
 
-                // Published before the world loop starts, so the first tick already sees it.
-                sWorld.SetAhSupervisor(m_supervisor);
+                    // Published before the world loop starts, so the first tick already sees it.
+                    for (uint8 g = 0; g < AH_HOUSE_GROUP_COUNT; ++g)
+                    {
+                        if (shards[i] & AhHouseGroupBit(g))
+                        {
+                            sWorld.SetAhSupervisor(g, sv);
+                        }
+                    }
+                    m_supervisors.push_back(sv);
+                }
+
+                if (m_supervisors.empty())
+                {
+                    sLog.outError("AH service failed to start; falling back to in-process bot");
+                }
             }
 
             void Join() override
             {
-                if (!m_supervisor)
+                if (m_supervisors.empty())
                 {
                     return;
                 }
 
                 // Unpublish before destroying: the world loop has stopped, but nothing else
                 // should be able to observe a dangling supervisor.
-                sWorld.SetAhSupervisor(nullptr);
-                m_supervisor->Shutdown();
-                delete m_supervisor;
-                m_supervisor = nullptr;
+                for (uint8 g = 0; g < AH_HOUSE_GROUP_COUNT; ++g)
+                {
+                    sWorld.SetAhSupervisor(g, nullptr);
+                }
+                for (size_t i = 0; i < m_supervisors.size(); ++i)
+                {
+                    m_supervisors[i]->Shutdown();
+                    delete m_supervisors[i];
+                }
+                m_supervisors.clear();
             }
 
         private:
 
-            WorkerSupervisor* m_supervisor;
+            std::vector<WorkerSupervisor*> m_supervisors;
     };
 }
 
@@ -20,29 +20,31 @@
  */
 
 #include "AuctionBook.h"
+#include "AhHouseShards.h"
 #include "ServiceDatabase.h"
 #include "ItemInstanceFields.h"
 #include "PlayerMutations.h"
 
+#include <algorithm>
 #include <cstdio>
+#include <functional>
+#include <map>
 
 AuctionBook::AuctionBook(ServiceDatabase* db)
-    : m_db(db)
+    : m_db(db),
+      m_houseMask(AH_HOUSE_MASK_ALL)
 {
 }
 
 uint8 AuctionBook::HouseGroup(uint8 houseId)
 {
     // Mirrors AuctionHouseMgr::GetAuctionHouseTeam (AuctionHouseMgr.cpp:930-945).
-    switch (houseId)
-    {
-        case 1: case 2: case 3:
-            return 0;   // ALLIANCE map
-        case 4: case 5: case 6:
-            return 1;   // HORDE map
-        default:
-            return 2;   // NEUTRAL map (houseid 7)
-    }
+    return AhHouseIdToGroup(houseId);
+}
+
+bool AuctionBook::OwnsHouse(uint8 houseId) const
+{
+    return (m_houseMask & AhHouseGroupBit(HouseGroup(houseId))) != 0;
 }
 
 uint8 AuctionBook::Admit(uint8 op, BookRow const* row)
@@ -74,8 +76,14 @@ uint8 AuctionBook::Admit(uint8 op, BookRow const* row)
 bool AuctionBook::BuildFromRows(std::vector<RawAuctionRow> const& rows,
                                 std::vector<AhJournal::JournalRow> const& activeJournal)
 {
-    m_rows.clear();
+    m_slots.clear();
+    m_freeSlots.clear();
+    m_slotOf.clear();
+    m_expiries.clear();
+    m_due.clear();
     m_orphans.clear();
+    m_slots.reserve(rows.size());
+    m_slotOf.reserve(rows.size());
 
     for (size_t i = 0; i < rows.size(); ++i)
     {
@@ -83,6 +91,14 @@ bool AuctionBook::BuildFromRows(std::vector<RawAuctionRow> const& rows,
         BookRow row = r.row;
         row.state = BOOK_LIVE;
 
+        // Another house shard's listing (AH.Service.Shards): not ours to
+        // serve, expire or report. A bad houseid counts as neutral, so
+        // exactly one shard reports it under gate B.
+        if (!OwnsHouse(row.houseId))
+        {
+            continue;
+        }
+
         // Gate A -- the listed item must exist and decode. Legacy DELETEs the
         // auction (AuctionHouseMgr.cpp:823-830; an unloadable item ends the
         // same way via LoadAuctionItems:729-743). The worker REPORTS instead
@@ -125,13 +141,13 @@ bool AuctionBook::BuildFromRows(std::vector<RawAuctionRow> const& rows,
             row.randomPropertyId = r.itemRandProp;
         }
 
-        if (m_rows.find(row.id) != m_rows.end())
+        if (m_slotOf.find(row.id) != m_slotOf.end())
         {
             fprintf(stderr, "ah-service: book load: duplicate auction id %u -"
                             " refusing to run\n", row.id);
             return false;
         }
-        m_rows[row.id] = row;
+        Store(row);
     }
 
     // Journal re-mark (spec 4.3 v3 I2/I3) + one-ACTIVE-per-auction invariant.
@@ -273,24 +289,137 @@ bool AuctionBook::LoadFromDb(ServiceDatabase& db,
     }
 
     printf("ah-service: book loaded: %u live listing(s), %u orphan(s) reported\n",
-           static_cast<unsigned>(m_rows.size()),
+           static_cast<unsigned>(m_slotOf.size()),
            static_cast<unsigned>(m_orphans.size()));
     return true;
 }
 
+void AuctionBook::AttachListener(AuctionBookListener* listener)
+{
+    m_listeners.push_back(listener);
+    Mirror(*listener);
+}
+
+void AuctionBook::Mirror(AuctionBookListener& listener) const
+{
+    // Ascending id, as the book was always mirrored.
+    std::vector<std::pair<uint32, uint32> > ids;
+    ids.reserve(m_slotOf.size());
+    for (std::unordered_map<uint32, uint32>::const_iterator it = m_slotOf.begin();
+         it != m_slotOf.end(); ++it)
+    {
+        ids.push_back(*it);
+    }
+    std::sort(ids.begin(), ids.end());
+    for (size_t i = 0; i < ids.size(); ++i)
+    {
+        listener.OnInsert(m_slots[ids[i].second].row);
+    }
+}
+
+void AuctionBook::NotifyInsert(BookRow const& row)
+{
+    for (size_t i = 0; i < m_listeners.size(); ++i)
+    {
+        m_listeners[i]->OnInsert(row);
+    }
+}
+
+void AuctionBook::NotifyBid(uint32 auctionId, uint32 bidder, uint32 bid)
+{
+    for (size_t i = 0; i < m_listeners.size(); ++i)
+    {
+        m_listeners[i]->OnBid(auctionId, bidder, bid);
+    }
+}
+
+void AuctionBook::NotifyRemove(uint32 auctionId)
+{
+    for (size_t i = 0; i < m_listeners.size(); ++i)
+    {
+        m_listeners[i]->OnRemove(auctionId);
+    }
+}
+
 BookRow* AuctionBook::Find(uint32 auctionId)
 {
-    BookMap::iterator it = m_rows.find(auctionId);
-    if (it == m_rows.end())
+    std::unordered_map<uint32, uint32>::const_iterator it = m_slotOf.find(auctionId);
+    if (it == m_slotOf.end())
     {
         return NULL;
     }
-    return &it->second;
+    return &m_slots[it->second].row;
+}
+
+void AuctionBook::Store(BookRow const& row)
+{
+    std::unordered_map<uint32, uint32>::iterator it = m_slotOf.find(row.id);
+    if (it != m_slotOf.end())
+    {
+        BookRow& current = m_slots[it->second].row;
+        if (current.expireTime == row.expireTime)
+        {
+            current = row;   // same schedule: heap / due entry still right
+            return;
+        }
+        Erase(row.id);
+    }
+
+    uint32 slot;
+    if (!m_freeSlots.empty())
+    {
+        slot = m_freeSlots.back();
+        m_freeSlots.pop_back();
+    }
+    else
+    {
+        slot = static_cast<uint32>(m_slots.size());
+        m_slots.push_back(Slot());
+    }
+    m_slots[slot].row  = row;
+    m_slots[slot].live = true;
+    m_slotOf[row.id] = slot;
+
+    m_expiries.push_back(Expiry(row.expireTime, row.id));
+    std::push_heap(m_expiries.begin(), m_expiries.end(), std::greater<Expiry>());
+}
+
+void AuctionBook::Erase(uint32 auctionId)
+{
+    std::unordered_map<uint32, uint32>::iterator it = m_slotOf.find(auctionId);
+    if (it == m_slotOf.end())
+    {
+        return;
+    }
+    m_slots[it->second].live = false;
+    m_freeSlots.push_back(it->second);
+    m_slotOf.erase(it);
+    m_due.erase(auctionId);   // its heap entry, if still queued, dies lazily
+
+    if (m_expiries.size() > 2u * m_slotOf.size() + 1024u)
+    {
+        CompactExpiries();
+    }
+}
+
+void AuctionBook::CompactExpiries()
+{
+    m_expiries.clear();
+    for (std::unordered_map<uint32, uint32>::const_iterator it = m_slotOf.begin();
+         it != m_slotOf.end(); ++it)
+    {
+        if (m_due.find(it->first) == m_due.end())
+        {
+            m_expiries.push_back(Expiry(m_slots[it->second].row.expireTime, it->first));
+        }
+    }
+    std::make_heap(m_expiries.begin(), m_expiries.end(), std::greater<Expiry>());
 }
 
 void AuctionBook::Insert(BookRow const& row)
 {
-    m_rows[row.id] = row;
+    Store(row);
+    NotifyInsert(row);
     if (m_db != NULL)
     {
         // Mirrors AuctionEntry::SaveToDB (AuctionHouseMgr.cpp:1524-1530).
@@ -316,6 +445,7 @@ void AuctionBook::UpdateBid(uint32 auctionId, uint32 bidder, uint32 bid)
     }
     row->bidder = bidder;
     row->bid    = bid;
+    NotifyBid(auctionId, bidder, bid);
     if (m_db != NULL)
     {
         // Mirrors the UpdateBid persist (AuctionHouseMgr.cpp:1738).
@@ -328,7 +458,8 @@ void AuctionBook::UpdateBid(uint32 auctionId, uint32 bidder, uint32 bid)
 
 void AuctionBook::Remove(uint32 auctionId)
 {
-    m_rows.erase(auctionId);
+    Erase(auctionId);
+    NotifyRemove(auctionId);
     if (m_db != NULL)
     {
         // Mirrors AuctionEntry::DeleteFromDB (AuctionHouseMgr.cpp:1515-1519).
@@ -339,7 +470,8 @@ void AuctionBook::Remove(uint32 auctionId)
 
 void AuctionBook::RollbackInsert(uint32 auctionId)
 {
-    m_rows.erase(auctionId);
+    Erase(auctionId);
+    NotifyRemove(auctionId);
 }
 
 void AuctionBook::RollbackUpdateBid(uint32 auctionId, uint32 prevBidder, uint32 prevBid)
@@ -349,27 +481,43 @@ void AuctionBook::RollbackUpdateBid(uint32 auctionId, uint32 prevBidder, uint32
     {
         row->bidder = prevBidder;
         row->bid    = prevBid;
+        NotifyBid(auctionId, prevBidder, prevBid);
     }
 }
 
 void AuctionBook::RollbackRemove(BookRow const& row)
 {
-    m_rows[row.id] = row;
+    Store(row);
+    NotifyInsert(row);
 }
 
 void AuctionBook::RemoveMemoryOnly(uint32 auctionId)
 {
-    m_rows.erase(auctionId);
+    Erase(auctionId);
+    NotifyRemove(auctionId);
+}
+
+void AuctionBook::UpdateBidMemoryOnly(uint32 auctionId, uint32 bidder, uint32 bid)
+{
+    BookRow* row = Find(auctionId);
+    if (row == NULL)
+    {
+        return;
+    }
+    row->bidder = bidder;
+    row->bid    = bid;
+    NotifyBid(auctionId, bidder, bid);
 }
 
 uint32 AuctionBook::CountOwned(uint32 ownerGuid, uint8 houseId) const
 {
     uint8 const group = HouseGroup(houseId);
     uint32 count = 0;
-    for (BookMap::const_iterator it = m_rows.begin(); it != m_rows.end(); ++it)
+    for (size_t i = 0; i < m_slots.size(); ++i)
     {
-        if (it->second.owner == ownerGuid &&
-            HouseGroup(it->second.houseId) == group)
+        BookRow const& row = m_slots[i].row;
+        if (m_slots[i].live && row.owner == ownerGuid &&
+            HouseGroup(row.houseId) == group)
         {
             ++count;
         }
@@ -377,25 +525,39 @@ uint32 AuctionBook::CountOwned(uint32 ownerGuid, uint8 houseId) const
     return count;
 }
 
-void AuctionBook::VisitExpired(uint64 now, std::vector<uint32>& outIds) const
+void AuctionBook::VisitExpired(uint64 now, std::vector<uint32>& outIds)
 {
     outIds.clear();
-    BookMap::const_iterator it = m_rows.begin();
-    for (; it != m_rows.end(); ++it)
+
+    // Move every expiry that has come due onto the due set. A surfacing entry
+    // is stale when its row has gone or was re-stored with another time.
+    while (!m_expiries.empty() && m_expiries.front().first <= now)
     {
-        if (it->second.state != static_cast<uint8>(BOOK_LIVE))
+        Expiry const due = m_expiries.front();
+        std::pop_heap(m_expiries.begin(), m_expiries.end(), std::greater<Expiry>());
+        m_expiries.pop_back();
+
+        BookRow const* row = Find(due.second);
+        if (row != NULL && row->expireTime == due.first)
         {
-            continue;
+            m_due.insert(due.second);
         }
-        if (it->second.expireTime > now)
+    }
+
+    // Due rows stay until they leave the book: one that is prepared, resolving
+    // or not resolved this tick (budget, window) is offered again next time.
+    for (std::set<uint32>::const_iterator it = m_due.begin(); it != m_due.end(); ++it)
+    {
+        BookRow const* row = Find(*it);
+        if (row->state == static_cast<uint8>(BOOK_LIVE) && row->expireTime <= now)
         {
-            continue;
+            outIds.push_back(*it);
         }
-        outIds.push_back(it->first);
     }
 }
 
 void AuctionBook::TestSeedRow(BookRow const& row)
 {
-    m_rows[row.id] = row;
+    Store(row);
+    NotifyInsert(row);
 }
@@ -25,8 +25,10 @@
 #include "Common.h"
 #include "Journal.h"
 
-#include <map>
+#include <set>
 #include <string>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 class ServiceDatabase;
@@ -35,13 +37,19 @@ class ServiceDatabase;
  * @file AuctionBook.h
  * @brief SP-2 authoritative in-memory auction book (spec v3 sections 3 / 4.3b / 5.6).
  *
- * Owned by the MAIN service-loop thread ONLY (the serializer). Browse stays
- * SQL-backed on its own thread; this book is the VALIDATOR's state, never a
- * browse source. Mutating methods with a DB side effect append their SQL to
+ * Owned by the MAIN service-loop thread ONLY (the serializer). The browse
+ * thread never reads the book: attached listeners (the BrowseIndex, the bot's
+ * MarketSnapshot) receive every memory mutation (rollbacks included) and keep
+ * their own copies. Mutating methods with a DB side effect append their SQL to
  * the CALLER's open transaction on the worker's own character-DB connection
  * (callers own the txn). Constructed with db == NULL the book runs memory-only
  * (--selftest mode: no SQL is ever issued).
  *
+ * Storage is a dense slot array (freed slots are reused) with an id -> slot
+ * hash, and expiry is a min-heap on expireTime: the expiry sweep pops only the
+ * auctions whose time has come and keeps them in a small due set until they
+ * leave the book, instead of scanning every row each tick.
+ *
  * The worker builds WITHOUT game headers, so the AuctionError wire values it
  * must emit are pinned here as BOOK_ERR_* (source of truth:
  * src/game/Object/AuctionHouseMgr.h:64-75). mangosd casts
@@ -119,12 +127,40 @@ struct RawAuctionRow
     int32   itemRandProp;  ///< blob word 44 (random property id)
 };
 
+/**
+ * @brief Receives every memory mutation of the book, on the main thread, in
+ *        the order it is applied.
+ */
+class AuctionBookListener
+{
+    public:
+        virtual ~AuctionBookListener() {}
+
+        virtual void OnInsert(BookRow const& row) = 0;
+        virtual void OnBid(uint32 auctionId, uint32 bidder, uint32 bid) = 0;
+        virtual void OnRemove(uint32 auctionId) = 0;
+};
+
 class AuctionBook
 {
     public:
         /// db == NULL -> memory-only selftest mode (no SQL side effects).
         explicit AuctionBook(ServiceDatabase* db);
 
+        /**
+         * @brief Restrict the book to the house groups in @p mask
+         *        (AhHouseShards.h): the load skips every other house's rows,
+         *        orphans included, and OwnsHouse() rejects them afterwards.
+         *        Set before LoadFromDb; the default owns every group.
+         */
+        void SetHouseMask(uint8 mask)
+        {
+            m_houseMask = mask;
+        }
+
+        /// True if @p houseId falls in one of this book's house groups.
+        bool OwnsHouse(uint8 houseId) const;
+
         /**
          * @brief SELECT auction LEFT JOIN item_instance, decode, BuildFromRows,
          *        then persist any gate-C adoption (the legacy repair UPDATE,
@@ -141,7 +177,19 @@ class AuctionBook
         bool BuildFromRows(std::vector<RawAuctionRow> const& rows,
                            std::vector<AhJournal::JournalRow> const& activeJournal);
 
+        /**
+         * @brief Mirror every current row into @p listener, then forward each
+         *        later memory mutation to it.
+         */
+        void AttachListener(AuctionBookListener* listener);
+
+        /// Replay every current row into @p listener's OnInsert, ascending
+        /// id, without attaching it.
+        void Mirror(AuctionBookListener& listener) const;
+
         /// @return the live row, or NULL. Pointer valid until the next mutation.
+        /// expireTime must not be changed through it (it keys the expiry heap):
+        /// re-Insert the row instead.
         BookRow* Find(uint32 auctionId);
 
         /// Memory insert + INSERT INTO `auction` on the caller's open txn
@@ -166,6 +214,10 @@ class AuctionBook
          */
         void RemoveMemoryOnly(uint32 auctionId);
 
+        /// Memory-only bid update, after the caller's own transaction that
+        /// persisted it has committed (MutationHandler::OnBotBid).
+        void UpdateBidMemoryOnly(uint32 auctionId, uint32 bidder, uint32 bid);
+
         // Memory-only compensation when CommitTransactionChecked fails: the DB
         // rolled back, so the in-memory image must be restored to match.
         void RollbackInsert(uint32 auctionId);
@@ -192,7 +244,7 @@ class AuctionBook
 
         size_t Size() const
         {
-            return m_rows.size();
+            return m_slotOf.size();
         }
 
         /// houseid -> map group: 1-3 alliance(0), 4-6 horde(1), else neutral(2).
@@ -218,8 +270,9 @@ class AuctionBook
          *
          * 4.3b: CANCEL_PREPARED and RESOLVING rows are skipped by state.
          * Ascending id (deterministic mint order for the tick budget).
+         * Cost is the number of due rows, not the size of the book.
          */
-        void VisitExpired(uint64 now, std::vector<uint32>& outIds) const;
+        void VisitExpired(uint64 now, std::vector<uint32>& outIds);
 
         /**
          * @brief SELFTEST-ONLY: seed a row in memory with no auction INSERT
@@ -229,11 +282,39 @@ class AuctionBook
         void TestSeedRow(BookRow const& row);
 
     private:
-        typedef std::map<uint32, BookRow> BookMap;
-
-        BookMap                m_rows;
+        /// One storage slot; a freed slot waits in m_freeSlots for reuse.
+        struct Slot
+        {
+            BookRow row;
+            bool    live;
+        };
+
+        /// (expireTime, auction id): a scheduled expiry, earliest on top.
+        typedef std::pair<uint64, uint32> Expiry;
+
+        std::vector<Slot>                  m_slots;
+        std::vector<uint32>                m_freeSlots;
+        std::unordered_map<uint32, uint32> m_slotOf;    ///< auction id -> slot
+        /// Min-heap of future expiries. Entries of rows removed (or replaced)
+        /// since are dropped lazily when they surface.
+        std::vector<Expiry>                m_expiries;
+        /// Rows whose expiry has passed and which are still in the book.
+        std::set<uint32>                   m_due;
         std::vector<OrphanRow> m_orphans;
         ServiceDatabase*       m_db;
+        uint8                  m_houseMask;   ///< owned house groups
+        std::vector<AuctionBookListener*> m_listeners;
+
+        /// Insert or overwrite a row in memory and schedule its expiry.
+        void Store(BookRow const& row);
+        /// Drop a row from memory (slot, hash and due set).
+        void Erase(uint32 auctionId);
+        /// Rebuild the heap without dead entries once they dominate it.
+        void CompactExpiries();
+
+        void NotifyInsert(BookRow const& row);
+        void NotifyBid(uint32 auctionId, uint32 bidder, uint32 bid);
+        void NotifyRemove(uint32 auctionId);
 
         // Non-copyable: single-owner main-thread state.
         AuctionBook(const AuctionBook&);
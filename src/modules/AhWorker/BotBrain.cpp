@@ -20,10 +20,12 @@
  */
 
 #include "BotBrain.h"
+#include "AhHouseShards.h"
 #include "Common.h"
 #include "Utilities/Util.h"
 #include "Log/Log.h"
 
+#include <algorithm>
 #include <ctime>
 #include <limits>
 #include <map>
@@ -85,6 +87,7 @@ BotBrain::BotBrain(const ServiceConfig& config, const ItemPool& pool,
       m_runId(runId),
       m_seq(0),
       m_operationSelector(0),
+      m_houseMask(AH_HOUSE_MASK_ALL),
       m_sellerEnabled(false),
       m_buyerEnabled(false)
 {
@@ -525,23 +528,23 @@ void BotBrain::RunOneOperation(std::vector<EmittedIntent>& out)
          count < 2 * AH_MAX_AUCTION_HOUSE_TYPE; ++count)
     {
         bool successStep = false;
+        uint8 const house = static_cast<uint8>(
+            m_operationSelector % AH_MAX_AUCTION_HOUSE_TYPE);
+        // A house owned by another shard (AH.Service.Shards) is skipped.
+        bool const owned = (m_houseMask & AhHouseGroupBit(house)) != 0;
 
-        if (m_operationSelector < AH_MAX_AUCTION_HOUSE_TYPE)
+        if (owned && m_operationSelector < AH_MAX_AUCTION_HOUSE_TYPE)
         {
             if (m_sellerEnabled)
             {
-                successStep = SellerUpdate(
-                    static_cast<uint8>(m_operationSelector), out);
+                successStep = SellerUpdate(house, out);
             }
         }
-        else
+        else if (owned)
         {
             if (m_buyerEnabled)
             {
-                successStep = BuyerUpdate(
-                    static_cast<uint8>(
-                        m_operationSelector - AH_MAX_AUCTION_HOUSE_TYPE),
-                    out);
+                successStep = BuyerUpdate(house, out);
             }
         }
 
@@ -649,7 +652,7 @@ uint32 BotBrain::SetStat(SellerHouseConfig& cfg)
 
 bool BotBrain::getRandomArray(
     const SellerHouseConfig& cfg, RandomArray& ra,
-    const std::vector<std::vector<uint32> >& addedItem) const
+    const uint32 (&addedItem)[AH_MAX_AUCTION_QUALITY][AH_MAX_ITEM_CLASS]) const
 {
     ra.clear();
     bool Ok = false;
@@ -706,6 +709,10 @@ void BotBrain::SetPricesOfItem(const SellerHouseConfig& cfg, uint32& buyp,
 // live auctions. The item selection (getRandomArray + random pick from the
 // pool) and price math are identical; CreateItem/AddAuctionByGuid become a
 // SellIntent the executor (Task 9) applies.
+//
+// The source rebuilds the random array before every item. Only the cell just
+// picked can change, so the array is built once and that one cell dropped
+// when it is satisfied; the array, and so every urand draw, stays the same.
 // ---------------------------------------------------------------------------
 
 void BotBrain::addNewAuctions(SellerHouseConfig& cfg,
@@ -727,10 +734,12 @@ void BotBrain::addNewAuctions(SellerHouseConfig& cfg,
     }
 
     RandomArray randArray;
-    std::vector<std::vector<uint32> > itemsAdded(
-        AH_MAX_AUCTION_QUALITY, std::vector<uint32>(AH_MAX_ITEM_CLASS, 0));
+    uint32 itemsAdded[AH_MAX_AUCTION_QUALITY][AH_MAX_ITEM_CLASS] = {};
+
+    getRandomArray(cfg, randArray, itemsAdded);
+    out.reserve(out.size() + std::min<size_t>(items, cfg.lastMissedItem));
 
-    while (getRandomArray(cfg, randArray, itemsAdded) && (items > 0))
+    while (!randArray.empty() && (items > 0))
     {
         --items;
 
@@ -743,6 +752,10 @@ void BotBrain::addNewAuctions(SellerHouseConfig& cfg,
         const ItemIdPool& bucket = m_pool.GetBucket(color, itemclass);
         uint32 itemID = bucket[urand(0, bucket.size() - 1)];
         ++itemsAdded[color][itemclass];
+        if (cfg.missItems[color][itemclass] <= itemsAdded[color][itemclass])
+        {
+            randArray.erase(randArray.begin() + pos);
+        }
 
         if (!itemID)
         {
@@ -964,85 +977,110 @@ bool BotBrain::BuyerUpdate(uint8 houseType, std::vector<EmittedIntent>& out)
 }
 
 // ---------------------------------------------------------------------------
-// addNewAuctionBuyerBotBid - REIMPLEMENTED against MarketSnapshot.
-//
-// Folds the source's GetBuyableEntry (cpp:1020) + PrepareListOfEntry
-// (cpp:1100) + addNewAuctionBuyerBotBid (cpp:1306) into a single pass
-// over the house's snapshot:
-//
-//   1. Build SameItemInfo (per-itemId average/min buy/bid prices) exactly as
-//      GetBuyableEntry does, from EVERY record in the house.
-//   2. Build the candidate set with the SAME predicates GetBuyableEntry uses
-//      (skip bot-owned auctions unless a player bid on them; otherwise take
-//      any auction that has a bid+bidder, or any with no bid at all).
-//   3. PRUNE the cross-tick LastChecked map: remove any entry whose auctionId
-//      is not present in the current snapshot (mirrors PrepareListOfEntry's
-//      stale-CheckedEntry pruning, cpp:1100).
-//   4. SKIP candidates whose LastChecked is within the configured recheck
-//      interval (AHBOT_CONFIG_UINT32_BUYER_RECHECK_INTERVAL minutes, read
-//      live so a GM reload takes effect immediately; mirrors cpp:1337).
-//      Set LastChecked = now when a candidate IS evaluated.
-//   5. Derive BuyCycles from the POST-skip (not raw) candidate count, matching
-//      the source's BuyCycles derivation from config.CheckedEntry.size().
-//   6. For each evaluated candidate, run the IDENTICAL decision logic from
-//      addNewAuctionBuyerBotBid (price computation, IsBuyable/IsBidable,
-//      bid-vs-buyout coin flip), emitting Bid/Buyout intents.
-//
-// The cross-tick LastChecked map lives in m_buyerLastChecked[houseType]
-// (a BotBrain member) so it persists between ticks exactly as
-// AHB_Buyer_Config::CheckedEntry does in the in-process bot.
+// PlanBuyer - steps 1-5 below in ONE pass over the house.
 //
-// Wall-clock time(NULL) is used for 'now'.  The source uses server gametime,
-// but gametime advances 1:1 with wall-clock; a 20-minute throttle is coarse
-// enough that the difference is irrelevant.
+// The house is sorted by auction id and so is the LastChecked map, so the
+// two are walked side by side: a LastChecked entry the walk steps over
+// without meeting its record is stale and erased (step 3), and a matching
+// one gives the throttle time without a lookup (step 4). Only the first
+// BuyCycles eligible auctions are ever evaluated, so SameItemInfo (step 1)
+// is then summed for their items alone, in house order - the same additions
+// in the same order as the full build. No per-record allocation remains.
 // ---------------------------------------------------------------------------
 
-void BotBrain::addNewAuctionBuyerBotBid(BuyerHouseConfig& cfg,
-                                        std::vector<EmittedIntent>& out)
+void BotBrain::PlanBuyer(std::vector<AuctionRecord> const& house,
+                         uint32 botGuid, time_t now, time_t recheckSecs,
+                         uint32 boostCycles, uint32 normalCycles,
+                         std::map<uint32, time_t>& lastChecked,
+                         BuyerPlan& plan)
 {
-    const std::vector<AuctionRecord>& house =
-        m_snapshot.GetHouse(cfg.houseType);
-
-    // Wall-clock 'now' — see rationale above re: gametime equivalence.
-    time_t now = time(NULL);
-
-    // Convenience reference to the persistent per-house LastChecked map.
-    std::map<uint32, time_t>& lastChecked =
-        m_buyerLastChecked[cfg.houseType];
+    plan.candidateCount = 0;
+    plan.evaluate.clear();
+    plan.itemInfo.clear();
 
-    // --- Step 1+2: build SameItemInfo + candidate list (GetBuyableEntry) ---
-    struct BuyerItemInfo
-    {
-        BuyerItemInfo()
-            : ItemCount(0), BuyPrice(0.0), BidPrice(0.0),
-              MinBuyPrice(0), MinBidPrice(0) {}
-        uint32 ItemCount;
-        double BuyPrice;
-        double BidPrice;
-        uint32 MinBuyPrice;
-        uint32 MinBidPrice;
-    };
-    std::map<uint32, BuyerItemInfo> sameItemInfo;
-
-    // snapshotIds: the set of auctionIds present this tick (for pruning).
-    std::map<uint32, bool> snapshotIds;
-
-    // candidates: indices into 'house' that pass the selection predicates.
-    std::vector<size_t> candidates;
+    std::vector<size_t>& eligible = plan.evaluate;
 
+    std::map<uint32, time_t>::iterator lc = lastChecked.begin();
     for (size_t r = 0; r < house.size(); ++r)
     {
         const AuctionRecord& rec = house[r];
 
         // Guard: itemCount is the divisor used throughout (item->GetCount()).
+        // Such a record is not in the snapshot as far as the prune goes.
         if (rec.itemCount == 0)
         {
             continue;
         }
 
-        snapshotIds[rec.id] = true;
+        while (lc != lastChecked.end() && lc->first < rec.id)
+        {
+            lastChecked.erase(lc++);
+        }
+        time_t checkedAt = 0;
+        if (lc != lastChecked.end() && lc->first == rec.id)
+        {
+            checkedAt = lc->second;
+            ++lc;
+        }
+
+        // Candidate-selection predicates (verbatim from GetBuyableEntry):
+        // a bot-owned auction only once a player has bid on it, any other
+        // auction when it has a bid+bidder or no bid at all.
+        bool candidate;
+        if (rec.ownerGuid == botGuid)
+        {
+            candidate = (rec.curBid != 0) && rec.bidderGuid;
+        }
+        else
+        {
+            candidate = (rec.curBid == 0) || rec.bidderGuid;
+        }
+        if (!candidate)
+        {
+            continue;
+        }
+        ++plan.candidateCount;
+
+        // Recheck throttle (cpp:1337).
+        if (checkedAt != 0 && (now - checkedAt) <= recheckSecs)
+        {
+            continue;
+        }
+        eligible.push_back(r);
+    }
+    lastChecked.erase(lc, lastChecked.end());
+
+    if (eligible.empty())
+    {
+        return;
+    }
+
+    // BuyCycles from the PRE-recheck candidate count (see the caller).
+    size_t const buyCycles =
+        plan.candidateCount > boostCycles ? boostCycles : normalCycles;
+    eligible.resize(std::min(eligible.size(), buyCycles));
+
+    for (size_t c = 0; c < plan.evaluate.size(); ++c)
+    {
+        plan.itemInfo[house[plan.evaluate[c]].itemId];
+    }
+
+    // SameItemInfo for the evaluated items only (verbatim accumulation).
+    for (size_t r = 0; r < house.size(); ++r)
+    {
+        const AuctionRecord& rec = house[r];
+        if (rec.itemCount == 0)
+        {
+            continue;
+        }
+        std::unordered_map<uint32, BuyerItemInfo>::iterator si =
+            plan.itemInfo.find(rec.itemId);
+        if (si == plan.itemInfo.end())
+        {
+            continue;
+        }
 
-        BuyerItemInfo& bi = sameItemInfo[rec.itemId];
+        BuyerItemInfo& bi = si->second;
         ++bi.ItemCount;
         bi.BuyPrice = bi.BuyPrice + (rec.buyout / rec.itemCount);
         bi.BidPrice = bi.BidPrice + (rec.startBid / rec.itemCount);
@@ -1065,84 +1103,144 @@ void BotBrain::addNewAuctionBuyerBotBid(BuyerHouseConfig& cfg,
         {
             bi.MinBidPrice = rec.startBid / rec.itemCount;
         }
-
-        // Candidate-selection predicates (verbatim from GetBuyableEntry).
-        if (rec.ownerGuid == m_botGuid)
-        {
-            // Bot-owned: only a candidate if a player has bid on it.
-            if ((rec.curBid != 0) && rec.bidderGuid)
-            {
-                candidates.push_back(r);
-            }
-        }
-        else
-        {
-            if (rec.curBid != 0)
-            {
-                if (rec.bidderGuid)
-                {
-                    candidates.push_back(r);
-                }
-            }
-            else
-            {
-                candidates.push_back(r);
-            }
-        }
     }
+}
 
-    // --- Step 3: prune stale LastChecked entries (PrepareListOfEntry) ---
-    // Drop any auctionId that is no longer in the snapshot (sold/expired).
-    // Mirrors: for (itr = CheckedEntry.begin(); ...) if (!LastExist) erase.
-    for (std::map<uint32, time_t>::iterator it = lastChecked.begin();
-         it != lastChecked.end(); )
+void BuyerPrices::Resize(size_t n)
+{
+    basePrice.resize(n);
+    itemCount.resize(n);
+    buyout.resize(n);
+    curBid.resize(n);
+    startBid.resize(n);
+    sameCount.resize(n);
+    sameBuySum.resize(n);
+    maxChance.resize(n);
+    minBuy.resize(n);
+    minBid.resize(n);
+    maxBuyable.resize(n);
+    maxBidable.resize(n);
+    inGameBuy.resize(n);
+    buyoutPerItem.resize(n);
+    bidPerItem.resize(n);
+    bidTotal.resize(n);
+}
+
+// ---------------------------------------------------------------------------
+// PriceBuyer - the price math of step 6 (verbatim), hoisted out of the
+// decision loop. It draws no urand, so it runs over the whole plan first:
+// a gather of the record fields and item figures (one hash lookup per
+// auction), then one loop of plain arithmetic and selects over the packed
+// arrays. Every expression keeps the source's types and order.
+// ---------------------------------------------------------------------------
+
+void BotBrain::PriceBuyer(std::vector<AuctionRecord> const& house,
+                          uint32 botGuid, bool vendorBuyPrice,
+                          uint32 priceRatio, BuyerPlan& plan)
+{
+    BuyerPrices& p = plan.prices;
+    size_t const n = plan.evaluate.size();
+    p.Resize(n);
+
+    for (size_t c = 0; c < n; ++c)
     {
-        if (snapshotIds.find(it->first) == snapshotIds.end())
+        const AuctionRecord& rec = house[plan.evaluate[c]];
+        p.basePrice[c] = (vendorBuyPrice ? rec.vendorBuyPrice
+                                         : rec.vendorSellPrice) * rec.itemCount;
+        p.itemCount[c] = rec.itemCount;
+        p.buyout[c]    = rec.buyout;
+        p.curBid[c]    = rec.curBid;
+        p.startBid[c]  = rec.startBid;
+        // Player placed a bid on a bot auction: 1/5 chance to react.
+        p.maxChance[c] = rec.ownerGuid == botGuid ? 5000u / 5u : 5000u;
+
+        std::unordered_map<uint32, BuyerItemInfo>::const_iterator si =
+            plan.itemInfo.find(rec.itemId);
+        if (si == plan.itemInfo.end())
         {
-            it = lastChecked.erase(it);
+            p.sameCount[c]  = 0;
+            p.sameBuySum[c] = 0;
+            p.minBuy[c]     = 0;
+            p.minBid[c]     = 0;
         }
         else
         {
-            ++it;
+            p.sameCount[c]  = si->second.ItemCount;
+            p.sameBuySum[c] = si->second.BuyPrice;
+            p.minBuy[c]     = si->second.MinBuyPrice;
+            p.minBid[c]     = si->second.MinBidPrice;
         }
     }
 
-    if (candidates.empty())
+    for (size_t c = 0; c < n; ++c)
     {
-        return;
+        double maxBuyable = (p.basePrice[c] * priceRatio) / 100;
+        // If only one item exists it can be bought at a high price.
+        maxBuyable = p.sameCount[c] == 1 ? maxBuyable * 5 : maxBuyable;
+        p.maxBuyable[c] = maxBuyable;
+        // Max Bidable price = 70% of max buyable price (- 1/30).
+        p.maxBidable[c] = maxBuyable - (maxBuyable / 30);
+        p.inGameBuy[c] = p.sameCount[c] != 0
+            ? p.sameBuySum[c] / p.sameCount[c] : 0;
+        p.buyoutPerItem[c] = p.buyout[c] / p.itemCount[c];
+
+        // See the wire contract in addNewAuctionBuyerBotBid: outbid the
+        // current bid by GetAuctionOutBid() ((bid / 100) * 5, min 1), or
+        // open at startBid.
+        bool const outbidding = p.curBid[c] >= p.startBid[c];
+        uint32 const outbid = std::max((p.curBid[c] / 100) * 5, 1u);
+        p.bidTotal[c] = outbidding ? p.curBid[c] + outbid : p.startBid[c];
+        p.bidPerItem[c] = (outbidding ? p.curBid[c] : p.startBid[c]) /
+                          p.itemCount[c];
     }
+}
 
-    // --- Step 4: apply recheck throttle; collect post-skip candidates ---
-    // Mirrors cpp:1337: skip if (LastChecked != 0) && (Now-LastChecked) <=
-    // recheckSecs (config-driven; live read so GM reload takes effect).
-    // BuyCycles is derived from the post-skip count.
-    std::vector<size_t> eligible;
-    eligible.reserve(candidates.size());
-    for (size_t c = 0; c < candidates.size(); ++c)
-    {
-        const AuctionRecord& rec = house[candidates[c]];
-        std::map<uint32, time_t>::iterator lc = lastChecked.find(rec.id);
-        if (lc != lastChecked.end() && lc->second != 0)
-        {
-            // Read live from config (minutes) and convert to seconds, so a
-            // GM reload of AuctionHouseBot.Buyer.Recheck.Interval takes
-            // effect on the next buyer tick without a service restart.
-            const time_t recheckSecs = static_cast<time_t>(
-                m_config.getConfig(
-                    AHBOT_CONFIG_UINT32_BUYER_RECHECK_INTERVAL)) * 60;
-            if ((now - lc->second) <= recheckSecs)
-            {
-                // Still within the configured recheck window — skip.
-                continue;
-            }
-        }
-        eligible.push_back(candidates[c]);
-    }
+// ---------------------------------------------------------------------------
+// addNewAuctionBuyerBotBid - REIMPLEMENTED against MarketSnapshot.
+//
+// Folds the source's GetBuyableEntry (cpp:1020) + PrepareListOfEntry
+// (cpp:1100) + addNewAuctionBuyerBotBid (cpp:1306) into a single pass
+// over the house's snapshot (PlanBuyer):
+//
+//   1. Build SameItemInfo (per-itemId average/min buy/bid prices) exactly as
+//      GetBuyableEntry does, from EVERY record in the house of that item.
+//   2. Build the candidate set with the SAME predicates GetBuyableEntry uses
+//      (skip bot-owned auctions unless a player bid on them; otherwise take
+//      any auction that has a bid+bidder, or any with no bid at all).
+//   3. PRUNE the cross-tick LastChecked map: remove any entry whose auctionId
+//      is not present in the current snapshot (mirrors PrepareListOfEntry's
+//      stale-CheckedEntry pruning, cpp:1100).
+//   4. SKIP candidates whose LastChecked is within the configured recheck
+//      interval (AHBOT_CONFIG_UINT32_BUYER_RECHECK_INTERVAL minutes, read
+//      live so a GM reload takes effect immediately; mirrors cpp:1337).
+//      Set LastChecked = now when a candidate IS evaluated.
+//   5. Cap the post-skip candidates at BuyCycles.
+//   6. Price every evaluated candidate in one packed pass (PriceBuyer), then
+//      run the IDENTICAL decision logic from addNewAuctionBuyerBotBid
+//      (IsBuyable/IsBidable, bid-vs-buyout coin flip) in candidate order,
+//      emitting Bid/Buyout intents.
+//
+// The cross-tick LastChecked map lives in m_buyerLastChecked[houseType]
+// (a BotBrain member) so it persists between ticks exactly as
+// AHB_Buyer_Config::CheckedEntry does in the in-process bot.
+//
+// Wall-clock time(NULL) is used for 'now'.  The source uses server gametime,
+// but gametime advances 1:1 with wall-clock; a 20-minute throttle is coarse
+// enough that the difference is irrelevant.
+// ---------------------------------------------------------------------------
 
-    if (eligible.empty())
-    {
-        return;
-    }
+void BotBrain::addNewAuctionBuyerBotBid(BuyerHouseConfig& cfg,
+                                        std::vector<EmittedIntent>& out)
+{
+    const std::vector<AuctionRecord>& house =
+        m_snapshot.GetHouse(cfg.houseType);
+
+    // Wall-clock 'now' — see rationale above re: gametime equivalence.
+    time_t now = time(NULL);
+
+    // Convenience reference to the persistent per-house LastChecked map.
+    std::map<uint32, time_t>& lastChecked =
+        m_buyerLastChecked[cfg.houseType];
 
     // --- BuyCycles cap derived from PRE-recheck candidate count ---
     // The boost-vs-normal decision mirrors the in-process source which bases it
@@ -1153,44 +1251,33 @@ void BotBrain::addNewAuctionBuyerBotBid(BuyerHouseConfig& cfg,
     // the child incorrectly picks NORMAL. The decision must use candidates
     // (pre-recheck), while the actual work loop still iterates the
     // post-skip eligible set capped at buyCycles.
-    uint32 buyCycles;
-    if (candidates.size() >
-        m_config.getConfig(AHBOT_CONFIG_UINT32_ITEMS_PER_CYCLE_BOOST))
-    {
-        buyCycles = m_config.getConfig(
-            AHBOT_CONFIG_UINT32_ITEMS_PER_CYCLE_BOOST);
-    }
-    else
-    {
-        buyCycles = m_config.getConfig(
-            AHBOT_CONFIG_UINT32_ITEMS_PER_CYCLE_NORMAL);
-    }
-
-    // --- Step 5: per-candidate decision (verbatim math) ---
+    //
+    // The recheck interval is read live from config (minutes -> seconds), so
+    // a GM reload of AuctionHouseBot.Buyer.Recheck.Interval takes effect on
+    // the next buyer tick without a service restart.
+    PlanBuyer(house, m_botGuid, now,
+              static_cast<time_t>(m_config.getConfig(
+                  AHBOT_CONFIG_UINT32_BUYER_RECHECK_INTERVAL)) * 60,
+              m_config.getConfig(AHBOT_CONFIG_UINT32_ITEMS_PER_CYCLE_BOOST),
+              m_config.getConfig(AHBOT_CONFIG_UINT32_ITEMS_PER_CYCLE_NORMAL),
+              lastChecked, m_buyerPlan);
+
+    PriceBuyer(house, m_botGuid,
+               m_config.getConfig(AHBOT_CONFIG_BOOL_BUYPRICE_BUYER),
+               cfg.buyerPriceRatio, m_buyerPlan);
+
+    std::vector<size_t> const& eligible = m_buyerPlan.evaluate;
+    BuyerPrices const& prices = m_buyerPlan.prices;
+    out.reserve(out.size() + eligible.size());
+
+    // --- Step 6: per-candidate decision (verbatim draws, prices above) ---
     for (size_t c = 0; c < eligible.size(); ++c)
     {
-        if (buyCycles == 0)
-        {
-            break;
-        }
-
         const AuctionRecord& rec = house[eligible[c]];
 
         // Mark evaluated — mirrors: auctionEval.LastChecked = Now (cpp:1453).
         lastChecked[rec.id] = now;
 
-        uint32 MaxChance = 5000;
-
-        // BasePrice = (buyprice? BuyPrice : SellPrice) * count.
-        uint32 BasePrice =
-            m_config.getConfig(AHBOT_CONFIG_BOOL_BUYPRICE_BUYER)
-                ? rec.vendorBuyPrice : rec.vendorSellPrice;
-        BasePrice *= rec.itemCount;
-
-        double MaxBuyablePrice = (BasePrice * cfg.buyerPriceRatio) / 100;
-
-        uint32 buyoutPrice = rec.buyout / rec.itemCount;
-
         // bidPrice = the FINAL TOTAL bid to emit, bidPriceByItem = the
         // per-item value the IsBidable decision uses.
         //
@@ -1204,66 +1291,19 @@ void BotBrain::addNewAuctionBuyerBotBid(BuyerHouseConfig& cfg,
         // INCREMENT to PlaceBidToEntry -> UpdateBid, which works in-process
         // only because UpdateBid has no floor checks (it assigns bid = newbid
         // directly). Across the wire we must emit the total the executor's
-        // floors expect, so add the increment to the current bid here.
-        uint32 bidPrice;
-        uint32 bidPriceByItem;
-        if (rec.curBid >= rec.startBid)
-        {
-            // GetAuctionOutBid(): (bid / 100) * 5, min 1.
-            uint32 outbid = (rec.curBid / 100) * 5;
-            if (!outbid)
-            {
-                outbid = 1;
-            }
-            // FINAL TOTAL = current bid + minimum outbid increment. This
-            // satisfies bidAmount >= auction->bid + GetAuctionOutBid() and
-            // (since outbid >= 1) bidAmount > auction->bid, i.e. it actually
-            // outbids a contested auction instead of being rejected as stale.
-            bidPrice = rec.curBid + outbid;
-            bidPriceByItem = rec.curBid / rec.itemCount;
-        }
-        else
-        {
-            // No prior bid (curBid < startBid, e.g. curBid == 0): startBid is
-            // itself the final total. The executor accepts it because
-            // minBid = bid + GetAuctionOutBid() = 0 + 1 = 1 <= startBid and
-            // bidAmount == startBid satisfies the startbid floor.
-            bidPrice = rec.startBid;
-            bidPriceByItem = rec.startBid / rec.itemCount;
-        }
-
-        double InGame_BuyPrice;
-        uint32 minBidPrice;
-        uint32 minBuyPrice;
-        std::map<uint32, BuyerItemInfo>::iterator si =
-            sameItemInfo.find(rec.itemId);
-        if (si == sameItemInfo.end())
-        {
-            InGame_BuyPrice = 0;
-            minBidPrice = 0;
-            minBuyPrice = 0;
-        }
-        else
-        {
-            const BuyerItemInfo& sb = si->second;
-            if (sb.ItemCount == 1)
-            {
-                // If only one item exists it can be bought at a high price.
-                MaxBuyablePrice = MaxBuyablePrice * 5;
-            }
-            InGame_BuyPrice = sb.BuyPrice / sb.ItemCount;
-            minBidPrice = sb.MinBidPrice;
-            minBuyPrice = sb.MinBuyPrice;
-        }
-
-        // Max Bidable price = 70% of max buyable price (- 1/30).
-        double MaxBidablePrice = MaxBuyablePrice - (MaxBuyablePrice / 30);
-
-        if (rec.ownerGuid == m_botGuid)
-        {
-            // Player placed a bid on a bot auction: 1/5 chance to react.
-            MaxChance = MaxChance / 5;
-        }
+        // floors expect, so PriceBuyer adds the increment to the current bid
+        // (a bid of curBid + outbid >= 1 actually outbids a contested
+        // auction), or opens at startBid when there is no prior bid (the
+        // executor's minBid is then 0 + 1 <= startBid).
+        uint32 const MaxChance = prices.maxChance[c];
+        uint32 const buyoutPrice = prices.buyoutPerItem[c];
+        uint32 const bidPrice = prices.bidTotal[c];
+        uint32 const bidPriceByItem = prices.bidPerItem[c];
+        double const InGame_BuyPrice = prices.inGameBuy[c];
+        double const MaxBuyablePrice = prices.maxBuyable[c];
+        double const MaxBidablePrice = prices.maxBidable[c];
+        uint32 const minBuyPrice = prices.minBuy[c];
+        uint32 const minBidPrice = prices.minBid[c];
 
         bool doBid = false;
         bool doBuyout = false;
@@ -1357,7 +1397,5 @@ void BotBrain::addNewAuctionBuyerBotBid(BuyerHouseConfig& cfg,
             ei.bid.bidAmount = bidPrice;
             out.push_back(ei);
         }
-
-        --buyCycles;
     }
 }
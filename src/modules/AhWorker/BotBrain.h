@@ -31,6 +31,7 @@
 
 #include <ctime>
 #include <map>
+#include <unordered_map>
 #include <vector>
 
 /**
@@ -126,6 +127,69 @@ struct BuyerHouseConfig
     uint32 factionChance;   ///< 5000 * configured faction chance.
 };
 
+/**
+ * @brief Per-item market figures the buyer prices against (mirror of the
+ *        source's @c BuyerItemInfo / SameItemInfo).
+ */
+struct BuyerItemInfo
+{
+    BuyerItemInfo()
+        : ItemCount(0), BuyPrice(0.0), BidPrice(0.0),
+          MinBuyPrice(0), MinBidPrice(0) {}
+
+    uint32 ItemCount;    ///< Listings of the item in the house.
+    double BuyPrice;     ///< Sum of per-unit buyouts.
+    double BidPrice;     ///< Sum of per-unit start bids.
+    uint32 MinBuyPrice;  ///< Lowest non-zero per-unit buyout.
+    uint32 MinBidPrice;  ///< Lowest per-unit start bid.
+};
+
+/**
+ * @brief Buyer prices of the evaluated auctions, one array per figure,
+ *        parallel to @c BuyerPlan::evaluate (see @c BotBrain::PriceBuyer).
+ *
+ * The first group is gathered from the records and the item figures; the
+ * second is derived from it in one loop with no lookups and no RNG.
+ */
+struct BuyerPrices
+{
+    std::vector<uint32> basePrice;    ///< Vendor price * itemCount.
+    std::vector<uint32> itemCount;
+    std::vector<uint32> buyout;
+    std::vector<uint32> curBid;
+    std::vector<uint32> startBid;
+    std::vector<uint32> sameCount;    ///< BuyerItemInfo::ItemCount, 0 if none.
+    std::vector<double> sameBuySum;   ///< BuyerItemInfo::BuyPrice.
+
+    std::vector<uint32> maxChance;    ///< 5000, a fifth of it on bot auctions.
+    std::vector<uint32> minBuy;       ///< BuyerItemInfo::MinBuyPrice, 0 if none.
+    std::vector<uint32> minBid;       ///< BuyerItemInfo::MinBidPrice, 0 if none.
+    std::vector<double> maxBuyable;
+    std::vector<double> maxBidable;
+    std::vector<double> inGameBuy;    ///< Average per-unit buyout of the item.
+    std::vector<uint32> buyoutPerItem;
+    std::vector<uint32> bidPerItem;   ///< Per-unit bid the IsBidable check uses.
+    std::vector<uint32> bidTotal;     ///< The total bid an intent carries.
+
+    void Resize(size_t n);
+};
+
+/**
+ * @brief What one buyer operation evaluates (see @c BotBrain::PlanBuyer).
+ */
+struct BuyerPlan
+{
+    /// Candidates before the recheck throttle (the BuyCycles basis).
+    size_t candidateCount;
+    /// Indices into the house of the auctions to evaluate, ascending id,
+    /// at most BuyCycles of them.
+    std::vector<size_t> evaluate;
+    /// Market figures of the items in @c evaluate, and of no others.
+    std::unordered_map<uint32, BuyerItemInfo> itemInfo;
+    /// Prices of the auctions in @c evaluate, filled by PriceBuyer.
+    BuyerPrices prices;
+};
+
 /**
  * @brief The AH bot decision engine for the ah-service child.
  */
@@ -185,6 +249,13 @@ class BotBrain
          */
         void RunOneOperation(std::vector<EmittedIntent>& out);
 
+        /**
+         * @brief Restrict the rotation to the house groups in @p mask
+         *        (AhHouseShards.h): operations on any other house are skipped
+         *        without counting as work. The default owns every house.
+         */
+        void SetHouseMask(uint8 mask) { m_houseMask = mask; }
+
         /// @brief True if the seller is enabled (config + bot guid resolved).
         bool SellerEnabled() const { return m_sellerEnabled; }
         /// @brief True if any buyer house is enabled.
@@ -214,6 +285,53 @@ class BotBrain
             return m_seq;
         }
 
+        /**
+         * @brief Choose the auctions one buyer operation evaluates, in a
+         *        single pass over @p house (sorted by auction id).
+         *
+         * Same selection as the source's GetBuyableEntry + PrepareListOfEntry:
+         * the candidate predicates, the stale-@p lastChecked prune, the
+         * recheck throttle and the BuyCycles cap. @p lastChecked is walked
+         * alongside @p house instead of being looked up per record, and the
+         * per-item figures are summed only for the items actually evaluated,
+         * in house order, so they come out bit-identical to a full
+         * SameItemInfo build. No RNG; @p lastChecked is only pruned.
+         *
+         * @param house        One house of the snapshot, ascending id.
+         * @param botGuid      The bot's low guid.
+         * @param now          Wall-clock time of the operation.
+         * @param recheckSecs  Recheck throttle in seconds.
+         * @param boostCycles  ITEMS_PER_CYCLE_BOOST.
+         * @param normalCycles ITEMS_PER_CYCLE_NORMAL.
+         * @param lastChecked  The house's auctionId -> last evaluation map.
+         * @param plan         Filled with the result.
+         */
+        static void PlanBuyer(std::vector<AuctionRecord> const& house,
+                              uint32 botGuid, time_t now, time_t recheckSecs,
+                              uint32 boostCycles, uint32 normalCycles,
+                              std::map<uint32, time_t>& lastChecked,
+                              BuyerPlan& plan);
+
+        /**
+         * @brief Price every auction of @p plan ahead of the decision draws.
+         *
+         * The price math of addNewAuctionBuyerBotBid takes no random draw,
+         * so it runs here over packed arrays: one gather of the record
+         * fields and item figures, then one branch-free loop the compiler
+         * can vectorize. The decision loop only draws and compares, in the
+         * same order as before. Results are bit-identical to the per-record
+         * math.
+         *
+         * @param house          The house @p plan was built from.
+         * @param botGuid        The bot's low guid.
+         * @param vendorBuyPrice BUYPRICE_BUYER: base on the vendor buy price.
+         * @param priceRatio     The house's buyerPriceRatio.
+         * @param plan           A PlanBuyer result; fills @c plan.prices.
+         */
+        static void PriceBuyer(std::vector<AuctionRecord> const& house,
+                               uint32 botGuid, bool vendorBuyPrice,
+                               uint32 priceRatio, BuyerPlan& plan);
+
     private:
         // --- Orchestration ------------------------------------------------
         bool SellerUpdate(uint8 houseType, std::vector<EmittedIntent>& out);
@@ -222,8 +340,8 @@ class BotBrain
         // --- Seller (SetStat reimplemented; rest verbatim) ----------------
         uint32 SetStat(SellerHouseConfig& cfg);
         bool getRandomArray(const SellerHouseConfig& cfg, RandomArray& ra,
-                            const std::vector<std::vector<uint32> >& added)
-            const;
+                            const uint32 (&added)[AH_MAX_AUCTION_QUALITY]
+                                                 [AH_MAX_ITEM_CLASS]) const;
         void SetPricesOfItem(const SellerHouseConfig& cfg, uint32& buyp,
                              uint32& bidp, uint32 stackcnt,
                              uint32 itemQuality) const;
@@ -267,6 +385,7 @@ class BotBrain
         uint32                m_runId;
         uint32                m_seq;               ///< uuid low-32 counter.
         uint32                m_operationSelector; ///< 0..2*MAX_HOUSE-1.
+        uint8                 m_houseMask;         ///< owned house groups
         bool                  m_sellerEnabled;
         bool                  m_buyerEnabled;
 
@@ -286,6 +405,9 @@ class BotBrain
         std::map<uint32, time_t>
             m_buyerLastChecked[AH_MAX_AUCTION_HOUSE_TYPE];
 
+        /// Reused across buyer operations so a tick does not reallocate it.
+        BuyerPlan             m_buyerPlan;
+
         // Non-copyable.
         BotBrain(const BotBrain&);
         BotBrain& operator=(const BotBrain&);
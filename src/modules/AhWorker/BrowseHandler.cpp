@@ -20,12 +20,14 @@
  */
 
 #include "BrowseHandler.h"
+#include "BrowseIndex.h"
 #include "Usability.h"
 #include "Utilities/Util.h"   // Utf8FitTo / Utf8toWStr (src/shared; worker links `shared`)
 #include "IpcMessage.h"
 #include "IpcOpcodes.h"
 #include "ItemInstanceFields.h"
 #include "Log/Log.h"
+#include <algorithm>
 #include <cstdio>
 #include <cstring>
 #include <unordered_map>
@@ -455,19 +457,231 @@ BrowseResult Fetch(ServiceDatabase& db, const BrowseQuery& q, FetchStatus& statu
 } // namespace BrowseHandler (Fetch)
 
 // ---------------------------------------------------------------------------
-// BrowseThread
+// BrowseLatency
 // ---------------------------------------------------------------------------
 
-bool BrowseThread::Submit(const BrowseQuery& q)
+const size_t BrowseLatency::BUCKETS;
+
+BrowseLatency::BrowseLatency()
+{
+    for (size_t i = 0; i < BUCKETS; ++i)
+    {
+        m_buckets[i].store(0u, std::memory_order_relaxed);
+    }
+}
+
+void BrowseLatency::Record(uint64 micros)
+{
+    size_t bucket = 0;
+    while (micros != 0u && bucket < BUCKETS - 1u)
+    {
+        micros >>= 1;
+        ++bucket;
+    }
+    m_buckets[bucket].fetch_add(1u, std::memory_order_relaxed);
+}
+
+uint64 BrowseLatency::Count() const
+{
+    uint64 n = 0;
+    for (size_t i = 0; i < BUCKETS; ++i)
+    {
+        n += m_buckets[i].load(std::memory_order_relaxed);
+    }
+    return n;
+}
+
+uint64 BrowseLatency::Quantile(double p) const
 {
-    if (m_queue.push(q))
+    uint64 counts[BUCKETS];
+    uint64 total = 0;
+    for (size_t i = 0; i < BUCKETS; ++i)
+    {
+        counts[i] = m_buckets[i].load(std::memory_order_relaxed);
+        total += counts[i];
+    }
+    if (total == 0u)
+    {
+        return 0u;
+    }
+
+    // Rank of the quantile, 1-based; p = 1 lands on the last sample.
+    uint64 rank = static_cast<uint64>(p * static_cast<double>(total) + 0.5);
+    rank = std::max<uint64>(1u, std::min(rank, total));
+    uint64 seen = 0;
+    for (size_t i = 0; i < BUCKETS; ++i)
+    {
+        seen += counts[i];
+        if (seen >= rank)
+        {
+            return uint64(1) << i;
+        }
+    }
+    return uint64(1) << (BUCKETS - 1u);
+}
+
+std::string BrowseLatency::Summary() const
+{
+    char buf[128];
+    snprintf(buf, sizeof(buf), "n=%llu p50<=%lluus p90<=%lluus p99<=%lluus",
+             static_cast<unsigned long long>(Count()),
+             static_cast<unsigned long long>(Quantile(0.50)),
+             static_cast<unsigned long long>(Quantile(0.90)),
+             static_cast<unsigned long long>(Quantile(0.99)));
+    return buf;
+}
+
+// ---------------------------------------------------------------------------
+// BrowseQueue
+// ---------------------------------------------------------------------------
+
+BrowseQueue::BrowseQueue(size_t cap, size_t byteCap, size_t laneCap)
+    : m_cap(cap), m_byteCap(byteCap), m_laneCap(laneCap),
+      m_count(0), m_bytes(0), m_stop(false)
+{
+}
+
+bool BrowseQueue::Push(const BrowseQuery& q, size_t bytes)
+{
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+
+        if (m_stop || m_count >= m_cap ||
+            (m_byteCap != 0u && m_bytes + bytes > m_byteCap))
+        {
+            return false;
+        }
+
+        std::deque<Item>& lane = m_lanes[q.requesterGuidLow];
+        if (lane.size() >= m_laneCap)
+        {
+            return false;
+        }
+
+        if (lane.empty())
+        {
+            m_turns.push_back(q.requesterGuidLow);
+        }
+        lane.push_back(Item());
+        lane.back().query  = q;
+        lane.back().queued = std::chrono::steady_clock::now();
+        lane.back().bytes  = bytes;
+        ++m_count;
+        m_bytes += bytes;
+    }
+
+    // Outside the lock, as MapUpdater does: the woken worker would only
+    // block on the mutex again.
+    m_ready.notify_one();
+    return true;
+}
+
+bool BrowseQueue::Pop(Item& out)
+{
+    std::unique_lock<std::mutex> guard(m_mutex);
+
+    m_ready.wait(guard, [this] { return m_stop || !m_turns.empty(); });
+    if (m_stop)
+    {
+        return false;
+    }
+
+    // Serve the requester at the head of the rotation, then send it to the
+    // back if it still has work queued.
+    const uint32 requester = m_turns.front();
+    m_turns.pop_front();
+
+    Lanes::iterator lane = m_lanes.find(requester);
+    out = lane->second.front();
+    lane->second.pop_front();
+    --m_count;
+    m_bytes -= out.bytes;
+
+    if (lane->second.empty())
+    {
+        m_lanes.erase(lane);
+    }
+    else
+    {
+        m_turns.push_back(requester);
+    }
+    return true;
+}
+
+void BrowseQueue::Stop()
+{
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        m_stop = true;
+    }
+    m_ready.notify_all();
+}
+
+size_t BrowseQueue::Size() const
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    return m_count;
+}
+
+// ---------------------------------------------------------------------------
+// BrowsePool
+// ---------------------------------------------------------------------------
+
+BrowsePool::BrowsePool(ServiceDatabase& db, IpcClient& cli, BrowseIndex* index)
+    : m_db(db), m_cli(cli), m_index(index),
+      m_queue(QUEUE_CAP, QUEUE_BYTE_CAP, PLAYER_CAP), m_workerCount(0),
+      m_processed(0), m_rejected(0), m_dbErrors(0)
+{
+}
+
+BrowsePool::~BrowsePool()
+{
+    Stop();
+}
+
+void BrowsePool::Start(uint32 workers, uint32 firstConn)
+{
+    if (!m_workers.empty())
+    {
+        return;
+    }
+
+    workers = std::max(1u, std::min(workers, MAX_WORKERS));
+    m_workerCount = workers;
+    m_workers.reserve(workers);
+    for (uint32 i = 0; i < workers; ++i)
+    {
+        const uint32 conn = firstConn + i;
+        m_workers.emplace_back([this, conn] { WorkerLoop(conn); });
+    }
+}
+
+void BrowsePool::Stop()
+{
+    m_queue.Stop();
+    for (size_t i = 0; i < m_workers.size(); ++i)
+    {
+        if (m_workers[i].joinable())
+        {
+            m_workers[i].join();
+        }
+    }
+    m_workers.clear();
+}
+
+bool BrowsePool::Submit(const BrowseQuery& q)
+{
+    // Byte cost: the variable-length parts of the query on top of the struct.
+    const size_t bytes = sizeof(BrowseQuery) + q.searchedName.size() +
+        (q.outbidIds.size() + q.knownRecipeCastSpells.size()) * sizeof(uint32);
+    if (m_queue.Push(q, bytes))
     {
         return true;
     }
     m_rejected.fetch_add(1, std::memory_order_relaxed);
-    // D4: queue saturated. Reply tooMany=1 NOW so mangosd tells the player the
-    // AH is unavailable immediately instead of waiting the ~10s TTL (coordinator
-    // model: no in-process fallback).
+    // D4: queue (or this player's lane) saturated. Reply tooMany=1 NOW so
+    // mangosd tells the player the AH is unavailable immediately instead of
+    // waiting the ~10s TTL (coordinator model: no in-process fallback).
     // IpcClient::SendFrame is CONFIRMED thread-safe (see header comment).
     BrowseResult full;
     full.queryId      = q.queryId;
@@ -482,178 +696,215 @@ bool BrowseThread::Submit(const BrowseQuery& q)
     return false;
 }
 
-void BrowseThread::run()
+void BrowsePool::WorkerLoop(uint32 conn)
 {
-    // C4: per-thread MySQL init/teardown for this thread's connection.
+    // C4: per-thread MySQL init/teardown for this thread's connection. The
+    // pin keeps this worker's SELECTs off the other workers' connections.
     m_db.Character().ThreadStart();
-
-    BrowseQuery q;
-    while (!m_stop.load())
     {
-        if (m_queue.pop(q))
-        {
-            FetchStatus st = FETCH_OK;
-            BrowseResult res = BrowseHandler::Fetch(m_db, q, st);
-            if (st == FETCH_DB_ERROR)
-            {
-                // I3: no reply -- mangosd's TTL sweep tells the player the AH is
-                // unavailable (coordinator model: no in-process fallback).
-                m_dbErrors.fetch_add(1, std::memory_order_relaxed);
-                continue;
-            }
-            IpcMessage rm;
-            rm.op = IPC_BROWSE_RESULT;
-            if (res.entries.size() > BrowseResult::MAX_ENTRIES)
-            {
-                BrowseResult capped;
-                capped.queryId      = res.queryId;
-                capped.kind         = res.kind;
-                capped.elunaPending = 0u;
-                capped.tooMany      = 1u;
-                capped.totalcount   = 0u;
-                capped.Encode(rm.body);
-            }
-            else
-            {
-                res.Encode(rm.body);
-            }
-            // I8: preflight outbound body size; never emit over the MAXLEN cap.
-            if (rm.body.size() > BrowseResult::MAX_WIRE)
-            {
-                // Should be impossible within MAX_ENTRIES; fail safe by
-                // replying tooMany so mangosd tells the player the AH is
-                // unavailable (coordinator model: no in-process fallback).
-                BrowseResult capped;
-                capped.queryId      = res.queryId;
-                capped.kind         = res.kind;
-                capped.elunaPending = 0u;
-                capped.tooMany      = 1u;
-                capped.totalcount   = 0u;
-                rm.body.clear();
-                capped.Encode(rm.body);
-            }
-            m_cli.SendFrame(rm);
-            m_processed.fetch_add(1, std::memory_order_relaxed);
-        }
-        else
+        Database::QueryConnectionScope pin(m_db.Character(), conn);
+
+        BrowseQueue::Item item;
+        while (m_queue.Pop(item))
         {
-            MaNGOS::Thread::Sleep(5);
+            const std::chrono::steady_clock::time_point picked =
+                std::chrono::steady_clock::now();
+            m_waitLatency.Record(static_cast<uint64>(
+                std::chrono::duration_cast<std::chrono::microseconds>(
+                    picked - item.queued).count()));
+
+            Process(item.query);
+
+            m_serviceLatency.Record(static_cast<uint64>(
+                std::chrono::duration_cast<std::chrono::microseconds>(
+                    std::chrono::steady_clock::now() - picked).count()));
         }
     }
-
     m_db.Character().ThreadEnd();
 }
 
+void BrowsePool::Process(const BrowseQuery& q)
+{
+    FetchStatus st = FETCH_OK;
+    BrowseResult res = (m_index != NULL)
+        ? m_index->Query(m_db, q, st)
+        : BrowseHandler::Fetch(m_db, q, st);
+    if (st == FETCH_DB_ERROR)
+    {
+        // I3: no reply -- mangosd's TTL sweep tells the player the AH is
+        // unavailable (coordinator model: no in-process fallback).
+        m_dbErrors.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    IpcMessage rm;
+    rm.op = IPC_BROWSE_RESULT;
+    if (res.entries.size() > BrowseResult::MAX_ENTRIES)
+    {
+        BrowseResult capped;
+        capped.queryId      = res.queryId;
+        capped.kind         = res.kind;
+        capped.elunaPending = 0u;
+        capped.tooMany      = 1u;
+        capped.totalcount   = 0u;
+        capped.Encode(rm.body);
+    }
+    else
+    {
+        res.Encode(rm.body);
+    }
+    // I8: preflight outbound body size; never emit over the MAXLEN cap.
+    if (rm.body.size() > BrowseResult::MAX_WIRE)
+    {
+        // Should be impossible within MAX_ENTRIES; fail safe by
+        // replying tooMany so mangosd tells the player the AH is
+        // unavailable (coordinator model: no in-process fallback).
+        BrowseResult capped;
+        capped.queryId      = res.queryId;
+        capped.kind         = res.kind;
+        capped.elunaPending = 0u;
+        capped.tooMany      = 1u;
+        capped.totalcount   = 0u;
+        rm.body.clear();
+        capped.Encode(rm.body);
+    }
+    m_cli.SendFrame(rm);
+    m_processed.fetch_add(1, std::memory_order_relaxed);
+}
+
 // ---------------------------------------------------------------------------
 
-namespace BrowseHandler
+BrowsePage::BrowsePage(const BrowseQuery& q)
+    : m_q(q), m_isList(q.kind == static_cast<uint8>(BROWSE_LIST)),
+      m_defer(false), m_needleBad(false), m_done(false)
 {
-    BrowseResult FilterAndPaginate(const std::vector<BrowseRow>& rows,
-                                   const BrowseQuery& q)
+    m_res.queryId      = q.queryId;
+    m_res.kind         = q.kind;
+    m_res.elunaPending = 0u;
+    m_res.tooMany      = 0u;
+    m_res.totalcount   = 0u;
+
+    m_defer = m_isList && (q.deferEluna != 0u);
+
+    // V4: convert the (already lower-cased UTF-8) needle to wide ONCE for
+    // Utf8FitTo parity. Empty needle matches everything. If a NON-empty needle
+    // fails to convert (malformed UTF-8), match NOTHING -- mirrors the live
+    // in-process handler, which returns early on a bad Utf8toWStr (v4-verify
+    // R2: an empty wneedle must NOT silently fall through to match-all).
+    if (m_isList && !q.searchedName.empty())
     {
-        BrowseResult res;
-        res.queryId      = q.queryId;
-        res.kind         = q.kind;
-        res.elunaPending = 0u;
-        res.tooMany      = 0u;
-        res.totalcount   = 0u;
+        m_needleBad = !Utf8toWStr(q.searchedName, m_wneedle);
+    }
+}
 
-        const bool isList = (q.kind == static_cast<uint8>(BROWSE_LIST));
-        const bool defer  = isList && (q.deferEluna != 0u);
+bool BrowsePage::Add(const BrowseRow& r, const std::string& name)
+{
+    return Add(r, !m_isList || m_needleBad || NameMatches(name, m_wneedle));
+}
 
-        // V4: convert the (already lower-cased UTF-8) needle to wide ONCE for
-        // Utf8FitTo parity. Empty needle matches everything. If a NON-empty needle
-        // fails to convert (malformed UTF-8), match NOTHING -- mirrors the live
-        // in-process handler, which returns early on a bad Utf8toWStr (v4-verify
-        // R2: an empty wneedle must NOT silently fall through to match-all).
-        std::wstring wneedle;
-        bool needleBad = false;
-        if (isList && !q.searchedName.empty())
+bool BrowsePage::Add(const BrowseRow& r, bool nameMatches)
+{
+    if (m_done)
+    {
+        return false;
+    }
+
+    if (m_isList)
+    {
+        if (m_needleBad)
         {
-            needleBad = !Utf8toWStr(q.searchedName, wneedle);
+            return true;    // malformed search name -> no matches (parity)
         }
-
-        for (size_t i = 0; i < rows.size(); ++i)
+        if (!nameMatches)
+        {
+            return true;
+        }
+        if (m_q.usable != 0u && !RowUsable(r, m_q))
         {
-            const BrowseRow& r = rows[i];
+            return true;
+        }
+    }
 
-            if (isList)
-            {
-                if (needleBad)
-                {
-                    continue;   // malformed search name -> no matches (parity)
-                }
-                if (q.usable != 0u && !RowUsable(r, q))
-                {
-                    continue;
-                }
-                if (!NameMatches(r.name, wneedle))
-                {
-                    continue;
-                }
-            }
+    if (!m_isList)
+    {
+        // OWNER/BIDDER: every row is an entry.
+        if (m_res.entries.size() >= BrowseResult::MAX_ENTRIES)
+        {
+            // The IPC decoder rejects a larger count. Decline now so
+            // mangosd consumes the pending request and immediately
+            // reports the AH as unavailable instead of timing out.
+            m_res.tooMany = 1u;
+            m_res.entries.clear();
+            m_res.totalcount = 0u;
+            m_done = true;
+            return false;
+        }
+        ++m_res.totalcount;
+        m_res.entries.push_back(r.entry);
+        return true;
+    }
 
-            if (!isList)
-            {
-                // OWNER/BIDDER: every row is an entry.
-                if (res.entries.size() >= BrowseResult::MAX_ENTRIES)
-                {
-                    // The IPC decoder rejects a larger count. Decline now so
-                    // mangosd consumes the pending request and immediately
-                    // reports the AH as unavailable instead of timing out.
-                    res.tooMany = 1u;
-                    res.entries.clear();
-                    res.totalcount = 0u;
-                    return res;
-                }
-                ++res.totalcount;
-                res.entries.push_back(r.entry);
-                continue;
-            }
+    if (m_defer)
+    {
+        // Un-paginated full set (capped): the common exact-parity path --
+        // mangosd runs Eluna over all of these, then paginates. totalcount
+        // counts all survivors even past the cap so the >cap edge in Finish
+        // can detect it.
+        if (m_res.entries.size() < BROWSE_ELUNA_CAP)
+        {
+            m_res.entries.push_back(r.entry);
+        }
+        ++m_res.totalcount;
+    }
+    else
+    {
+        // Match the in-process single-pass order: emit while count < 50
+        // and totalcount >= listfrom, then bump totalcount per survivor.
+        if (m_res.entries.size() < 50u && m_res.totalcount >= m_q.listfrom)
+        {
+            m_res.entries.push_back(r.entry);
+        }
+        ++m_res.totalcount;
+    }
+    return true;
+}
 
-            if (defer)
-            {
-                // Un-paginated full set (capped): the common exact-parity path --
-                // mangosd runs Eluna over all of these, then paginates. totalcount
-                // counts all survivors even past the cap so the >cap edge below can
-                // detect it.
-                if (res.entries.size() < BROWSE_ELUNA_CAP)
-                {
-                    res.entries.push_back(r.entry);
-                }
-                ++res.totalcount;
-            }
-            else
-            {
-                // Match the in-process single-pass order: emit while count < 50
-                // and totalcount >= listfrom, then bump totalcount per survivor.
-                if (res.entries.size() < 50u && res.totalcount >= q.listfrom)
-                {
-                    res.entries.push_back(r.entry);
-                }
-                ++res.totalcount;
-            }
+BrowseResult BrowsePage::Finish()
+{
+    if (m_defer && !m_done)
+    {
+        m_res.elunaPending = 1u;
+        if (m_res.totalcount > BROWSE_ELUNA_CAP)
+        {
+            // >cap (decision #2): too many survivors for an EXACT deferred-Eluna
+            // pass -- mangosd can only veto what the worker ships, so a
+            // pre-paginated page would be short (vetoed items not backfilled)
+            // with a pre-veto totalcount. The coordinator does not serve an
+            // approximate result: the worker declines (tooMany) and mangosd
+            // sends "AH unavailable". Rare: needs >cap survivors AND a bound
+            // OnCanUseItem Lua hook.
+            m_res.tooMany      = 1u;
+            m_res.elunaPending = 0u;
+            m_res.entries.clear();
+            m_res.totalcount   = 0u;
         }
+    }
+    m_done = true;
+    return m_res;
+}
 
-        if (defer)
+namespace BrowseHandler
+{
+    BrowseResult FilterAndPaginate(const std::vector<BrowseRow>& rows,
+                                   const BrowseQuery& q)
+    {
+        BrowsePage page(q);
+        for (size_t i = 0; i < rows.size(); ++i)
         {
-            res.elunaPending = 1u;
-            if (res.totalcount > BROWSE_ELUNA_CAP)
+            if (!page.Add(rows[i], rows[i].name))
             {
-                // >cap (decision #2): too many survivors for an EXACT deferred-Eluna
-                // pass -- mangosd can only veto what the worker ships, so a
-                // pre-paginated page would be short (vetoed items not backfilled)
-                // with a pre-veto totalcount. The coordinator does not serve an
-                // approximate result: the worker declines (tooMany) and mangosd
-                // sends "AH unavailable". Rare: needs >cap survivors AND a bound
-                // OnCanUseItem Lua hook.
-                res.tooMany      = 1u;
-                res.elunaPending = 0u;
-                res.entries.clear();
-                res.totalcount   = 0u;
+                break;
             }
         }
-
-        return res;
+        return page.Finish();
     }
 }
@@ -26,16 +26,22 @@
 #include "BrowseMessages.h"
 #include "ServiceDatabase.h"
 #include "IpcChannel.h"            // IpcClient
-#include "Threading/Threading.h"   // MaNGOS::Runnable, Thread
-#include "BoundedQueue.h"          // explicit-capacity thread-safe queue
 #include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <unordered_map>
 #include <vector>
 
 /// Cap on the un-paginated survivor set returned for a deferEluna browse. Must
 /// be <= BrowseResult::MAX_ENTRIES. If exceeded, the worker returns tooMany=1.
 const uint32 BROWSE_ELUNA_CAP = 1000u;
 
+class BrowseIndex;
+
 /// A fetched auction row: the wire entry plus the columns the in-code filters
 /// need. Populated by BrowseHandler::Fetch (Task 10); consumed by
 /// FilterAndPaginate.
@@ -68,6 +74,47 @@ enum FetchStatus
     FETCH_DB_ERROR = 2    ///< DB error -- caller must NOT reply (TTL fallback)
 };
 
+/**
+ * @brief Streaming form of BrowseHandler::FilterAndPaginate.
+ *
+ * Rows are offered one at a time, in auction-id order, after the cheap proto
+ * filters; the page applies the usable + name filters and the pagination
+ * rules. FilterAndPaginate is a loop over Add(), so a caller that already
+ * holds its rows in memory (BrowseIndex) gets the same result without
+ * copying every candidate into a vector first.
+ */
+class BrowsePage
+{
+    public:
+        explicit BrowsePage(const BrowseQuery& q);
+
+        /// Offer one row; @p name is its locale-resolved item name.
+        /// @return false once the result is final (an OWNER/BIDDER overflow).
+        bool Add(const BrowseRow& r, const std::string& name);
+
+        /// As above, for a caller that already matched the name against
+        /// Needle() itself (same Utf8FitTo semantics, no per-row conversion).
+        bool Add(const BrowseRow& r, bool nameMatches);
+
+        /// The search name as wide text; empty when there is none.
+        const std::wstring& Needle() const { return m_wneedle; }
+
+        /// True when the search name is malformed UTF-8: nothing can match.
+        bool NeedleBad() const { return m_needleBad; }
+
+        /// Close the page (deferEluna cap) and hand the result over.
+        BrowseResult Finish();
+
+    private:
+        const BrowseQuery& m_q;
+        BrowseResult       m_res;
+        std::wstring       m_wneedle;
+        bool               m_isList;
+        bool               m_defer;
+        bool               m_needleBad;
+        bool               m_done;
+};
+
 namespace BrowseHandler
 {
     /// PURE: compose a BIDDER result exactly like the legacy client path.
@@ -90,47 +137,150 @@ namespace BrowseHandler
                        FetchStatus& status);
 }
 
-/// Dedicated worker browse thread. Single thread (FIFO, open-d). Owns per-thread
-/// MySQL init/teardown (C4). Explicit-capacity bounded queue (C4: BoundedQueue
-/// has no default ctor). Atomic stop. Joined before DB/client shutdown.
-class BrowseThread : public MaNGOS::Runnable
+/**
+ * @brief Per-query latency histogram.
+ *
+ * Power-of-two microsecond buckets held in atomics, so every browse worker
+ * records without a lock. Quantiles are bucket upper bounds: coarse (within
+ * 2x) but cheap enough to keep on for every query.
+ */
+class BrowseLatency
+{
+    public:
+        /// Bucket 0 is [0, 1) us, bucket i is [2^(i-1), 2^i) us; the last
+        /// bucket (>= ~8.4 s) is open-ended.
+        static const size_t BUCKETS = 25u;
+
+        BrowseLatency();
+
+        void Record(uint64 micros);
+
+        uint64 Count() const;
+
+        /// Upper bound, in microseconds, of the bucket holding the
+        /// @p p quantile (0 < p <= 1); 0 while empty.
+        uint64 Quantile(double p) const;
+
+        /// "n=<count> p50<=<us>us p90<=<us>us p99<=<us>us" for the log.
+        std::string Summary() const;
+
+    private:
+        std::atomic<uint64> m_buckets[BUCKETS];
+
+        // Non-copyable.
+        BrowseLatency(const BrowseLatency&);
+        BrowseLatency& operator=(const BrowseLatency&);
+};
+
+/**
+ * @brief Blocking browse queue with per-player round robin.
+ *
+ * Every requester (BrowseQuery::requesterGuidLow) has its own FIFO lane and
+ * Pop() serves the lanes in turn, so a client spamming browse packets only
+ * delays its own queries. Admission is bounded by total count, total bytes
+ * and per-requester count; a refused Push() never blocks. Pop() sleeps on a
+ * condition variable until work arrives or Stop() is called.
+ */
+class BrowseQueue
+{
+    public:
+        struct Item
+        {
+            BrowseQuery                           query;
+            std::chrono::steady_clock::time_point queued;
+            size_t                                bytes;
+        };
+
+        BrowseQueue(size_t cap, size_t byteCap, size_t laneCap);
+
+        /// @return false (never blocks) if any bound would be exceeded or
+        ///         the queue is stopped.
+        bool Push(const BrowseQuery& q, size_t bytes);
+
+        /// Block for the next item in round-robin order.
+        /// @return false once Stop() was called; queued items are abandoned
+        ///         (mangosd's TTL sweep answers them).
+        bool Pop(Item& out);
+
+        /// Wake every blocked Pop() and refuse further pushes.
+        void Stop();
+
+        size_t Size() const;
+
+    private:
+        typedef std::unordered_map<uint32, std::deque<Item> > Lanes;
+
+        mutable std::mutex      m_mutex;
+        std::condition_variable m_ready;
+        Lanes                   m_lanes;
+        std::deque<uint32>      m_turns;    ///< requesters with queued work, in serve order
+        const size_t            m_cap;
+        const size_t            m_byteCap;
+        const size_t            m_laneCap;
+        size_t                  m_count;
+        size_t                  m_bytes;
+        bool                    m_stop;
+};
+
+/// Pool of worker browse threads fed by one BrowseQueue. Each worker pins its
+/// SELECTs to its own character-DB query connection (per-thread MySQL
+/// init/teardown, C4). Stop() wakes and joins every worker; it must run before
+/// DB/client shutdown. With a BrowseIndex (write authority) queries are
+/// answered from memory; without one every query is a BrowseHandler::Fetch.
+class BrowsePool
 {
     public:
         static const size_t QUEUE_CAP      = 256u;                  ///< max queued browses
         static const size_t QUEUE_BYTE_CAP = 8u * 1024u * 1024u;   ///< 8 MB backstop
+        static const size_t PLAYER_CAP     = 8u;                    ///< max queued per requester
+        static const uint32 MAX_WORKERS    = 8u;
 
-        BrowseThread(ServiceDatabase& db, IpcClient& cli)
-            : m_db(db), m_cli(cli),
-              m_queue(QUEUE_CAP, QUEUE_BYTE_CAP),
-              m_stop(false),
-              m_processed(0), m_rejected(0), m_dbErrors(0)
-        {}
+        BrowsePool(ServiceDatabase& db, IpcClient& cli, BrowseIndex* index = NULL);
+        ~BrowsePool();
 
-        /// Enqueue a decoded query (thread-safe). On queue-full, sends an
-        /// immediate tooMany IPC_BROWSE_RESULT (D4) so mangosd falls back
-        /// in-process at once instead of waiting the ~10s TTL; returns false.
+        /// Start @p workers threads (clamped to 1..MAX_WORKERS). Worker i pins
+        /// query connection @p firstConn + i of the character database.
+        void Start(uint32 workers, uint32 firstConn);
+
+        /// Enqueue a decoded query (thread-safe). When the queue refuses it,
+        /// sends an immediate tooMany IPC_BROWSE_RESULT (D4) so mangosd tells
+        /// the player at once instead of waiting the ~10s TTL; returns false.
         bool Submit(const BrowseQuery& q);
 
-        void Stop() { m_stop.store(true); }
+        /// Wake and join every worker (idempotent).
+        void Stop();
 
-        void run() override;
+        /// Workers started (still reported after Stop()).
+        uint32 Workers() const { return m_workerCount; }
 
         uint64 Processed() const { return m_processed.load(std::memory_order_relaxed); }
         uint64 Rejected()  const { return m_rejected.load(std::memory_order_relaxed); }
         uint64 DbErrors()  const { return m_dbErrors.load(std::memory_order_relaxed); }
 
+        /// Submit -> worker pickup.
+        const BrowseLatency& WaitLatency() const { return m_waitLatency; }
+        /// Pickup -> reply sent (index lookup or SQL fetch, plus encode).
+        const BrowseLatency& ServiceLatency() const { return m_serviceLatency; }
+
     private:
-        ServiceDatabase&          m_db;
-        IpcClient&                m_cli;
-        BoundedQueue<BrowseQuery> m_queue;
-        std::atomic<bool>         m_stop;
-        std::atomic<uint64>       m_processed;
-        std::atomic<uint64>       m_rejected;
-        std::atomic<uint64>       m_dbErrors;
+        void WorkerLoop(uint32 conn);
+        void Process(const BrowseQuery& q);
+
+        ServiceDatabase&         m_db;
+        IpcClient&               m_cli;
+        BrowseIndex*             m_index;    ///< NULL: SQL-backed browse
+        BrowseQueue              m_queue;
+        std::vector<std::thread> m_workers;
+        uint32                   m_workerCount;
+        std::atomic<uint64>      m_processed;
+        std::atomic<uint64>      m_rejected;
+        std::atomic<uint64>      m_dbErrors;
+        BrowseLatency            m_waitLatency;
+        BrowseLatency            m_serviceLatency;
 
         // Non-copyable.
-        BrowseThread(const BrowseThread&);
-        BrowseThread& operator=(const BrowseThread&);
+        BrowsePool(const BrowsePool&);
+        BrowsePool& operator=(const BrowsePool&);
 };
 
 #endif // AH_WORKER_BROWSE_HANDLER_H
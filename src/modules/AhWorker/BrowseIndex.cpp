@@ -0,0 +1,935 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2025 MaNGOS <https://www.getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "BrowseIndex.h"
+#include "ServiceDatabase.h"
+#include "ItemInstanceFields.h"
+#include "Usability.h"
+#include "Utilities/Util.h"   // Utf8toWStr / wstrToLower
+#include "Log/Log.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <mutex>
+
+namespace
+{
+    const uint32 ANY = 0xFFFFFFFFu;
+
+    /// Guids per item_instance IN (...) batch of ResolvePending.
+    const size_t RESOLVE_BATCH = 500u;
+
+    /// Sorted union of a run of postings (range filters).
+    void UnionInto(std::vector<std::vector<uint64> const*> const& parts,
+                   std::vector<uint64>& out)
+    {
+        out.clear();
+        for (size_t i = 0; i < parts.size(); ++i)
+        {
+            out.insert(out.end(), parts[i]->begin(), parts[i]->end());
+        }
+        // Each auction sits in exactly one bucket of a range index, so the
+        // concatenation has no duplicates; it only needs ordering.
+        std::sort(out.begin(), out.end());
+    }
+}
+
+const uint32 BrowseIndex::RETRY_MS;
+
+BrowseIndex::BrowseIndex()
+    : m_pendingFresh(false), m_nextRetry(std::chrono::steady_clock::now())
+{
+    for (int i = 0; i < MAX_LOCALE; ++i)
+    {
+        m_localeReady[i] = false;
+    }
+}
+
+uint8 BrowseIndex::Group(uint8 houseId)
+{
+    if (houseId >= 1 && houseId <= 3)
+    {
+        return 0;
+    }
+    if (houseId >= 4 && houseId <= 6)
+    {
+        return 1;
+    }
+    if (houseId == 7)
+    {
+        return 2;
+    }
+    return NO_GROUP;
+}
+
+uint8 BrowseIndex::QueryGroup(const BrowseQuery& q)
+{
+    // Same scoping as BrowseHandler's HouseClause.
+    if (q.allHouses != 0u)
+    {
+        return 2;
+    }
+    if (q.house == 0u)
+    {
+        return 0;
+    }
+    if (q.house == 1u)
+    {
+        return 1;
+    }
+    return 2;
+}
+
+void BrowseIndex::PostingAdd(Posting& p, uint64 key)
+{
+    // Ids are minted ascending, so the common case is an append.
+    if (p.empty() || p.back() < key)
+    {
+        p.push_back(key);
+        return;
+    }
+    Posting::iterator it = std::lower_bound(p.begin(), p.end(), key);
+    if (it == p.end() || *it != key)
+    {
+        p.insert(it, key);
+    }
+}
+
+void BrowseIndex::PostingErase(Posting& p, uint64 key)
+{
+    Posting::iterator it = std::lower_bound(p.begin(), p.end(), key);
+    if (it != p.end() && *it == key)
+    {
+        p.erase(it);
+    }
+}
+
+template <class Map>
+void BrowseIndex::BucketErase(Map& map, typename Map::key_type bucket, uint64 key)
+{
+    typename Map::iterator it = map.find(bucket);
+    if (it == map.end())
+    {
+        return;
+    }
+    PostingErase(it->second, key);
+    if (it->second.empty())
+    {
+        map.erase(it);
+    }
+}
+
+bool BrowseIndex::LoadTemplates(ServiceDatabase& db)
+{
+    //                                         0      1        2           3
+    QueryResult* result = db.World().Query(
+        "SELECT `entry`, `class`, `subclass`, `InventoryType`,"
+        //  4          5                6                 7
+        " `Quality`, `RequiredLevel`, `AllowableClass`, `AllowableRace`,"
+        //  8                9                    10               11
+        " `RequiredSkill`, `RequiredSkillRank`, `RequiredSpell`, `RequiredHonorRank`,"
+        //  12                           13                        14      15
+        " `RequiredReputationFaction`, `RequiredReputationRank`, `name`, `spellid_1`"
+        " FROM `item_template`");
+    if (result == NULL)
+    {
+        fprintf(stderr, "ah-service: browse index: item_template unreadable -"
+                        " browse stays SQL-backed\n");
+        return false;
+    }
+
+    std::unique_lock<std::shared_mutex> guard(m_lock);
+    m_items.clear();
+    do
+    {
+        Field* f = result->Fetch();
+        CachedItem& item = m_items[f[0].GetUInt32()];
+        BrowseItemInfo& info = item.info;
+        info.itemClass      = f[1].GetUInt32();
+        info.itemSubClass   = f[2].GetUInt32();
+        info.inventoryType  = f[3].GetUInt32();
+        info.quality        = f[4].GetUInt32();
+        info.requiredLevel  = f[5].GetUInt32();
+        info.allowableClass = f[6].GetUInt32();
+        info.allowableRace  = f[7].GetUInt32();
+        info.reqSkill       = f[8].GetUInt32();
+        info.reqSkillRank   = f[9].GetUInt32();
+        info.reqSpell       = f[10].GetUInt32();
+        info.reqHonorRank   = f[11].GetUInt32();
+        info.reqRepFaction  = f[12].GetUInt32();
+        info.reqRepRank     = f[13].GetUInt32();
+        info.names[0]       = f[14].GetCppString();
+        info.castSpellId    = f[15].GetUInt32();
+    }
+    while (result->NextRow());
+    delete result;
+
+    // Locale overlay: Fetch reads name_loc{localeIndex} directly (V3), so the
+    // cache keeps the same columns. A missing table just leaves enUS names.
+    std::string sql = "SELECT `entry`";
+    for (int i = 1; i < MAX_LOCALE; ++i)
+    {
+        char col[32];
+        snprintf(col, sizeof(col), ", `name_loc%d`", i);
+        sql += col;
+    }
+    sql += " FROM `locales_item`";
+    uint32 localized = 0u;
+    if (QueryResult* loc = db.World().Query(sql.c_str()))
+    {
+        do
+        {
+            Field* f = loc->Fetch();
+            ItemMap::iterator it = m_items.find(f[0].GetUInt32());
+            if (it == m_items.end())
+            {
+                continue;
+            }
+            for (int i = 1; i < MAX_LOCALE; ++i)
+            {
+                it->second.info.names[i] = f[i].GetCppString();
+            }
+            ++localized;
+        }
+        while (loc->NextRow());
+        delete loc;
+    }
+
+    printf("ah-service: browse index: %u item template(s), %u localized\n",
+           static_cast<unsigned>(m_items.size()), localized);
+    return true;
+}
+
+std::string const& BrowseIndex::NameOf(CachedItem const& item, int locale)
+{
+    if (locale >= 1 && locale < MAX_LOCALE && !item.info.names[locale].empty())
+    {
+        return item.info.names[locale];
+    }
+    return item.info.names[0];
+}
+
+void BrowseIndex::LowerName(CachedItem& item, int locale)
+{
+    // Exactly what Utf8FitTo does to the row name before its wide find().
+    item.lowered[locale].clear();
+    item.convertible[locale] = Utf8toWStr(NameOf(item, locale), item.lowered[locale]);
+    if (item.convertible[locale])
+    {
+        wstrToLower(item.lowered[locale]);
+    }
+}
+
+void BrowseIndex::Trigrams(std::wstring const& lowered, std::vector<uint64>& out)
+{
+    out.clear();
+    for (size_t i = 0; i + 3 <= lowered.size(); ++i)
+    {
+        out.push_back((uint64(uint32(lowered[i])     & 0x1FFFFFu) << 42) |
+                      (uint64(uint32(lowered[i + 1]) & 0x1FFFFFu) << 21) |
+                       uint64(uint32(lowered[i + 2]) & 0x1FFFFFu));
+    }
+    std::sort(out.begin(), out.end());
+    out.erase(std::unique(out.begin(), out.end()), out.end());
+}
+
+void BrowseIndex::FillRow(IndexedAuction& a)
+{
+    BrowseRow& r = a.row;
+    if (a.item != NULL)
+    {
+        BrowseItemInfo const& t = a.item->info;
+        r.itemClass      = t.itemClass;
+        r.itemSubClass   = t.itemSubClass;
+        r.inventoryType  = t.inventoryType;
+        r.quality        = t.quality;
+        r.requiredLevel  = t.requiredLevel;
+        r.allowableClass = t.allowableClass;
+        r.allowableRace  = t.allowableRace;
+        r.reqSkill       = t.reqSkill;
+        r.reqSkillRank   = t.reqSkillRank;
+        r.reqSpell       = t.reqSpell;
+        r.reqHonorRank   = t.reqHonorRank;
+        r.reqRepFaction  = t.reqRepFaction;
+        r.reqRepRank     = t.reqRepRank;
+        r.castSpellId    = t.castSpellId;
+        r.itemProficiencySkill =
+            AhUsability::GetItemProficiencySkill(r.itemClass, r.itemSubClass);
+    }
+
+    // Derived bid columns, exactly as Fetch computes them.
+    const uint32 lastbid = a.bid;
+    BrowseEntry& e = r.entry;
+    if (lastbid != 0u)
+    {
+        uint32 ob = (lastbid / 100u) * 5u;
+        e.outbid = (ob == 0u) ? 1u : ob;
+    }
+    else
+    {
+        e.outbid = 0u;
+    }
+    e.curBid = (lastbid && e.startbid > lastbid) ? e.startbid : lastbid;
+}
+
+void BrowseIndex::IndexAuction(uint32 slot)
+{
+    IndexedAuction const& a = m_slots[slot];
+    if (a.group == NO_GROUP || a.item == NULL)
+    {
+        return;   // never listed: the Fetch JOIN / house clause drops it too
+    }
+    Partition& part = m_parts[a.group];
+    BrowseRow const& r = a.row;
+    const uint64 key = Key(r.entry.id, slot);
+
+    PostingAdd(part.all, key);
+    PostingAdd(part.byClass[r.itemClass], key);
+    PostingAdd(part.bySubClass[(r.itemClass << 16) | (r.itemSubClass & 0xFFFFu)], key);
+    PostingAdd(part.byInvType[r.inventoryType], key);
+    PostingAdd(part.byQuality[r.quality], key);
+    PostingAdd(part.byLevel[r.requiredLevel], key);
+    PostingAdd(part.byOwner[r.entry.ownerGuidLow], key);
+    if (r.entry.bidderGuidLow != 0u)
+    {
+        PostingAdd(part.byBidder[r.entry.bidderGuidLow], key);
+    }
+
+    std::vector<uint64> grams;
+    for (int loc = 0; loc < MAX_LOCALE; ++loc)
+    {
+        if (m_localeReady[loc] && a.item->convertible[loc])
+        {
+            Trigrams(a.item->lowered[loc], grams);
+            for (size_t i = 0; i < grams.size(); ++i)
+            {
+                PostingAdd(part.byTrigram[loc][grams[i]], key);
+            }
+        }
+    }
+}
+
+void BrowseIndex::UnindexAuction(uint32 slot)
+{
+    IndexedAuction const& a = m_slots[slot];
+    if (a.group == NO_GROUP || a.item == NULL)
+    {
+        return;
+    }
+    Partition& part = m_parts[a.group];
+    BrowseRow const& r = a.row;
+    const uint64 key = Key(r.entry.id, slot);
+
+    PostingErase(part.all, key);
+    BucketErase(part.byClass, r.itemClass, key);
+    BucketErase(part.bySubClass, (r.itemClass << 16) | (r.itemSubClass & 0xFFFFu), key);
+    BucketErase(part.byInvType, r.inventoryType, key);
+    BucketErase(part.byQuality, r.quality, key);
+    BucketErase(part.byLevel, r.requiredLevel, key);
+    BucketErase(part.byOwner, r.entry.ownerGuidLow, key);
+    if (r.entry.bidderGuidLow != 0u)
+    {
+        BucketErase(part.byBidder, r.entry.bidderGuidLow, key);
+    }
+
+    std::vector<uint64> grams;
+    for (int loc = 0; loc < MAX_LOCALE; ++loc)
+    {
+        if (m_localeReady[loc] && a.item->convertible[loc])
+        {
+            Trigrams(a.item->lowered[loc], grams);
+            for (size_t i = 0; i < grams.size(); ++i)
+            {
+                BucketErase(part.byTrigram[loc], grams[i], key);
+            }
+        }
+    }
+}
+
+void BrowseIndex::PrepareLocale(int locale)
+{
+    // Caller holds the exclusive lock. Names are lowered once per template;
+    // postings are appended unordered and sorted once at the end.
+    for (ItemMap::iterator it = m_items.begin(); it != m_items.end(); ++it)
+    {
+        LowerName(it->second, locale);
+    }
+
+    std::unordered_map<CachedItem const*, std::vector<uint64> > perItem;
+    for (uint32 slot = 0; slot < m_slots.size(); ++slot)
+    {
+        IndexedAuction const& a = m_slots[slot];
+        if (!a.live || a.group == NO_GROUP || a.item == NULL ||
+            !a.item->convertible[locale])
+        {
+            continue;
+        }
+        std::vector<uint64>& grams = perItem[a.item];
+        if (grams.empty())
+        {
+            Trigrams(a.item->lowered[locale], grams);
+        }
+        std::unordered_map<uint64, Posting>& index = m_parts[a.group].byTrigram[locale];
+        for (size_t i = 0; i < grams.size(); ++i)
+        {
+            index[grams[i]].push_back(Key(a.row.entry.id, slot));
+        }
+    }
+    for (int g = 0; g < 3; ++g)
+    {
+        std::unordered_map<uint64, Posting>& index = m_parts[g].byTrigram[locale];
+        for (std::unordered_map<uint64, Posting>::iterator it = index.begin();
+             it != index.end(); ++it)
+        {
+            std::sort(it->second.begin(), it->second.end());
+        }
+    }
+    m_localeReady[locale] = true;
+}
+
+void BrowseIndex::OnInsert(BookRow const& row)
+{
+    std::unique_lock<std::shared_mutex> guard(m_lock);
+
+    std::unordered_map<uint32, uint32>::iterator old = m_slotOf.find(row.id);
+    uint32 slot;
+    if (old != m_slotOf.end())
+    {
+        slot = old->second;
+        UnindexAuction(slot);
+    }
+    else if (!m_freeSlots.empty())
+    {
+        slot = m_freeSlots.back();
+        m_freeSlots.pop_back();
+    }
+    else
+    {
+        slot = static_cast<uint32>(m_slots.size());
+        m_slots.push_back(IndexedAuction());
+    }
+    m_slotOf[row.id] = slot;
+
+    IndexedAuction a = IndexedAuction();
+    ItemMap::const_iterator item = m_items.find(row.itemTemplate);
+    a.item       = (item != m_items.end()) ? &item->second : NULL;
+    a.expireTime = row.expireTime;
+    a.bid        = row.bid;
+    a.itemGuid   = row.itemGuid;
+    a.group      = Group(row.houseId);
+    a.resolved   = false;
+    a.live       = true;
+
+    BrowseEntry& e = a.row.entry;
+    e.id            = row.id;
+    e.itemEntry     = row.itemTemplate;
+    e.enchantId     = 0u;
+    e.randomPropId  = static_cast<uint32>(row.randomPropertyId);
+    e.suffixFactor  = 0u;
+    e.count         = row.itemCount;
+    e.charges       = 0;
+    e.ownerGuidLow  = row.owner;
+    e.startbid      = row.startbid;
+    e.buyout        = row.buyout;
+    e.timeLeftMs    = 0u;
+    e.bidderGuidLow = row.bidder;
+    FillRow(a);
+
+    m_slots[slot] = a;
+    IndexAuction(slot);
+    m_pending.push_back(row.id);
+    m_pendingFresh = true;
+}
+
+void BrowseIndex::OnBid(uint32 auctionId, uint32 bidder, uint32 bid)
+{
+    std::unique_lock<std::shared_mutex> guard(m_lock);
+
+    std::unordered_map<uint32, uint32>::const_iterator it = m_slotOf.find(auctionId);
+    if (it == m_slotOf.end())
+    {
+        return;
+    }
+    IndexedAuction& a = m_slots[it->second];
+    if (a.group != NO_GROUP && a.item != NULL)
+    {
+        Partition& part = m_parts[a.group];
+        const uint64 key = Key(auctionId, it->second);
+        if (a.row.entry.bidderGuidLow != 0u)
+        {
+            BucketErase(part.byBidder, a.row.entry.bidderGuidLow, key);
+        }
+        if (bidder != 0u)
+        {
+            PostingAdd(part.byBidder[bidder], key);
+        }
+    }
+    a.row.entry.bidderGuidLow = bidder;
+    a.bid                     = bid;
+    FillRow(a);
+}
+
+void BrowseIndex::OnRemove(uint32 auctionId)
+{
+    std::unique_lock<std::shared_mutex> guard(m_lock);
+
+    std::unordered_map<uint32, uint32>::iterator it = m_slotOf.find(auctionId);
+    if (it == m_slotOf.end())
+    {
+        return;
+    }
+    const uint32 slot = it->second;
+    UnindexAuction(slot);
+    m_slots[slot].live = false;
+    m_freeSlots.push_back(slot);
+    m_slotOf.erase(it);
+    // A stale m_pending id is dropped by the next resolve pass.
+}
+
+void BrowseIndex::ResolvePending(ServiceDatabase& db)
+{
+    {
+        // Every browse worker passes here first; keep the common nothing-to-do
+        // case off the exclusive lock.
+        std::shared_lock<std::shared_mutex> peek(m_lock);
+        if (m_pending.empty())
+        {
+            return;
+        }
+    }
+
+    std::vector<uint32> guids;
+    {
+        std::unique_lock<std::shared_mutex> guard(m_lock);
+        if (m_pending.empty())
+        {
+            return;
+        }
+        const std::chrono::steady_clock::time_point now =
+            std::chrono::steady_clock::now();
+        if (!m_pendingFresh && now < m_nextRetry)
+        {
+            return;
+        }
+        m_pendingFresh = false;
+        m_nextRetry    = now + std::chrono::milliseconds(RETRY_MS);
+        for (size_t i = 0; i < m_pending.size(); ++i)
+        {
+            std::unordered_map<uint32, uint32>::const_iterator it = m_slotOf.find(m_pending[i]);
+            if (it != m_slotOf.end() && !m_slots[it->second].resolved)
+            {
+                guids.push_back(m_slots[it->second].itemGuid);
+            }
+        }
+    }
+
+    // No lock while the SELECTs run: mutations keep flowing meanwhile.
+    std::unordered_map<uint32, ItemInstanceFields> found;
+    for (size_t first = 0; first < guids.size(); first += RESOLVE_BATCH)
+    {
+        std::string sql = "SELECT `guid`, `data` FROM `item_instance` WHERE `guid` IN (";
+        const size_t last = std::min(guids.size(), first + RESOLVE_BATCH);
+        for (size_t i = first; i < last; ++i)
+        {
+            char buf[16];
+            snprintf(buf, sizeof(buf), i == first ? "%u" : ",%u", guids[i]);
+            sql += buf;
+        }
+        sql += ')';
+        if (QueryResult* result = db.Character().Query(sql.c_str()))
+        {
+            do
+            {
+                Field* f = result->Fetch();
+                found[f[0].GetUInt32()] = AhItemBlob::Decode(f[1].GetCppString());
+            }
+            while (result->NextRow());
+            delete result;
+        }
+    }
+
+    std::unique_lock<std::shared_mutex> guard(m_lock);
+    std::vector<uint32> stillPending;
+    for (size_t i = 0; i < m_pending.size(); ++i)
+    {
+        std::unordered_map<uint32, uint32>::const_iterator it = m_slotOf.find(m_pending[i]);
+        if (it == m_slotOf.end() || m_slots[it->second].resolved)
+        {
+            continue;
+        }
+        IndexedAuction& a = m_slots[it->second];
+        std::unordered_map<uint32, ItemInstanceFields>::const_iterator hit =
+            found.find(a.itemGuid);
+        if (hit == found.end())
+        {
+            stillPending.push_back(m_pending[i]);
+            continue;
+        }
+        // Same fallbacks as Fetch: an undecodable blob still lists, zeroed.
+        BrowseEntry& e = a.row.entry;
+        e.enchantId    = hit->second.valid ? hit->second.enchantId    : 0u;
+        e.suffixFactor = hit->second.valid ? hit->second.suffixFactor : 0u;
+        e.charges      = hit->second.valid ? hit->second.charges      : 0;
+        a.resolved     = true;
+    }
+    m_pending.swap(stillPending);
+}
+
+bool BrowseIndex::ProtoMatches(BrowseRow const& r, const BrowseQuery& q)
+{
+    // The WHERE clause Fetch builds for a LIST.
+    if (q.itemClass != ANY && r.itemClass != q.itemClass)
+    {
+        return false;
+    }
+    if (q.itemSubClass != ANY && r.itemSubClass != q.itemSubClass)
+    {
+        return false;
+    }
+    if (q.inventoryType != ANY && r.inventoryType != q.inventoryType)
+    {
+        return false;
+    }
+    if (q.quality != ANY && r.quality < q.quality)
+    {
+        return false;
+    }
+    if (q.levelmin != 0u)
+    {
+        if (r.requiredLevel < q.levelmin)
+        {
+            return false;
+        }
+        if (q.levelmax != 0u && r.requiredLevel > q.levelmax)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+BrowseIndex::Posting const* BrowseIndex::PlanList(Partition const& part,
+                                                  const BrowseQuery& q,
+                                                  std::wstring const& needle,
+                                                  Posting& scratch) const
+{
+    // Equality filters: a missing key means nothing can match.
+    Posting const* best = &part.all;
+    if (q.itemClass != ANY)
+    {
+        if (q.itemSubClass != ANY)
+        {
+            std::unordered_map<uint32, Posting>::const_iterator it =
+                part.bySubClass.find((q.itemClass << 16) | (q.itemSubClass & 0xFFFFu));
+            if (it == part.bySubClass.end())
+            {
+                return NULL;
+            }
+            best = &it->second;
+        }
+        else
+        {
+            std::unordered_map<uint32, Posting>::const_iterator it =
+                part.byClass.find(q.itemClass);
+            if (it == part.byClass.end())
+            {
+                return NULL;
+            }
+            best = &it->second;
+        }
+    }
+    if (q.inventoryType != ANY)
+    {
+        std::unordered_map<uint32, Posting>::const_iterator it =
+            part.byInvType.find(q.inventoryType);
+        if (it == part.byInvType.end())
+        {
+            return NULL;
+        }
+        if (it->second.size() < best->size())
+        {
+            best = &it->second;
+        }
+    }
+
+    // Range filters are a union of buckets: only worth materializing when the
+    // union is still narrower than the best equality posting.
+    std::vector<Posting const*> quality;
+    size_t qualitySize = 0;
+    if (q.quality != ANY)
+    {
+        for (std::map<uint32, Posting>::const_iterator it = part.byQuality.lower_bound(q.quality);
+             it != part.byQuality.end(); ++it)
+        {
+            quality.push_back(&it->second);
+            qualitySize += it->second.size();
+        }
+    }
+    std::vector<Posting const*> level;
+    size_t levelSize = 0;
+    if (q.levelmin != 0u)
+    {
+        std::map<uint32, Posting>::const_iterator it = part.byLevel.lower_bound(q.levelmin);
+        for (; it != part.byLevel.end() && (q.levelmax == 0u || it->first <= q.levelmax); ++it)
+        {
+            level.push_back(&it->second);
+            levelSize += it->second.size();
+        }
+    }
+
+    // Name: every trigram of the needle must occur in a matching name.
+    std::vector<Posting const*> grams;
+    size_t gramSize = ~size_t(0);
+    if (needle.size() >= 3u)
+    {
+        const int loc = (q.localeIndex >= 1 && int(q.localeIndex) < MAX_LOCALE)
+            ? int(q.localeIndex) : 0;
+        std::vector<uint64> keys;
+        Trigrams(needle, keys);
+        for (size_t i = 0; i < keys.size(); ++i)
+        {
+            std::unordered_map<uint64, Posting>::const_iterator it =
+                part.byTrigram[loc].find(keys[i]);
+            if (it == part.byTrigram[loc].end())
+            {
+                return NULL;
+            }
+            grams.push_back(&it->second);
+            gramSize = std::min(gramSize, it->second.size());
+        }
+    }
+
+    if (!grams.empty() && gramSize < best->size() &&
+        (quality.empty() || gramSize <= qualitySize) &&
+        (level.empty() || gramSize <= levelSize))
+    {
+        std::sort(grams.begin(), grams.end(),
+                  [](Posting const* a, Posting const* b) { return a->size() < b->size(); });
+        scratch = *grams[0];
+        Posting tmp;
+        for (size_t i = 1; i < grams.size() && !scratch.empty(); ++i)
+        {
+            tmp.clear();
+            std::set_intersection(scratch.begin(), scratch.end(),
+                                  grams[i]->begin(), grams[i]->end(),
+                                  std::back_inserter(tmp));
+            scratch.swap(tmp);
+        }
+        return &scratch;
+    }
+    if (!quality.empty() && qualitySize < best->size() &&
+        (level.empty() || qualitySize <= levelSize))
+    {
+        UnionInto(quality, scratch);
+        return &scratch;
+    }
+    if (q.levelmin != 0u && levelSize < best->size())
+    {
+        UnionInto(level, scratch);
+        return &scratch;
+    }
+    return best;
+}
+
+uint32 BrowseIndex::TimeLeftMs(uint64 expireTime, time_t now)
+{
+    if (static_cast<time_t>(expireTime) > now)
+    {
+        return static_cast<uint32>((expireTime - static_cast<uint64>(now)) * 1000u);
+    }
+    return 0u;
+}
+
+BrowseResult BrowseIndex::Answer(const BrowseQuery& q, time_t now)
+{
+    const bool isList = (q.kind == static_cast<uint8>(BROWSE_LIST));
+    const int  loc    = (q.localeIndex >= 1 && int(q.localeIndex) < MAX_LOCALE)
+        ? int(q.localeIndex) : 0;
+
+    BrowsePage page(q);
+    std::wstring const& needle = page.Needle();
+    const bool byName = isList && !needle.empty();
+
+    if (byName)
+    {
+        bool ready;
+        {
+            std::shared_lock<std::shared_mutex> guard(m_lock);
+            ready = m_localeReady[loc];
+        }
+        if (!ready)
+        {
+            std::unique_lock<std::shared_mutex> guard(m_lock);
+            if (!m_localeReady[loc])
+            {
+                PrepareLocale(loc);
+            }
+        }
+    }
+
+    std::shared_lock<std::shared_mutex> guard(m_lock);
+    const uint8 group = QueryGroup(q);
+    Partition const& part = m_parts[group];
+
+    if (q.kind == static_cast<uint8>(BROWSE_BIDDER))
+    {
+        // Small by construction: materialize and reuse the SQL path's composer.
+        std::unordered_map<uint32, Posting>::const_iterator bids =
+            part.byBidder.find(q.requesterGuidLow);
+        Posting keys;
+        if (bids != part.byBidder.end())
+        {
+            keys = bids->second;
+        }
+        for (size_t i = 0; i < q.outbidIds.size(); ++i)
+        {
+            std::unordered_map<uint32, uint32>::const_iterator it = m_slotOf.find(q.outbidIds[i]);
+            if (it != m_slotOf.end())
+            {
+                keys.push_back(Key(q.outbidIds[i], it->second));
+            }
+        }
+        std::sort(keys.begin(), keys.end());
+        keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+        std::vector<BrowseRow> rows;
+        for (size_t i = 0; i < keys.size(); ++i)
+        {
+            IndexedAuction const& a = m_slots[uint32(keys[i])];
+            if (!a.resolved || a.item == NULL || a.group != group)
+            {
+                continue;
+            }
+            rows.push_back(a.row);
+            rows.back().name = NameOf(*a.item, loc);
+            rows.back().entry.timeLeftMs = TimeLeftMs(a.expireTime, now);
+        }
+        rows = BrowseHandler::ComposeBidderRows(rows, q);
+        return BrowseHandler::FilterAndPaginate(rows, q);
+    }
+
+    Posting scratch;
+    Posting const* keys = NULL;
+    if (q.kind == static_cast<uint8>(BROWSE_OWNER))
+    {
+        std::unordered_map<uint32, Posting>::const_iterator it =
+            part.byOwner.find(q.requesterGuidLow);
+        keys = (it != part.byOwner.end()) ? &it->second : NULL;
+    }
+    else if (!page.NeedleBad())
+    {
+        keys = PlanList(part, q, needle, scratch);
+    }
+
+    if (keys != NULL)
+    {
+        for (size_t i = 0; i < keys->size(); ++i)
+        {
+            IndexedAuction const& a = m_slots[uint32((*keys)[i])];
+            if (!a.resolved)
+            {
+                continue;
+            }
+            if (isList && !ProtoMatches(a.row, q))
+            {
+                continue;
+            }
+            const bool nameMatches = !byName ||
+                (a.item->convertible[loc] &&
+                 a.item->lowered[loc].find(needle) != std::wstring::npos);
+            if (!page.Add(a.row, nameMatches))
+            {
+                break;
+            }
+        }
+    }
+    BrowseResult res = page.Finish();
+
+    // Rows are stored without a clock; stamp the shipped entries only.
+    for (size_t i = 0; i < res.entries.size(); ++i)
+    {
+        std::unordered_map<uint32, uint32>::const_iterator it =
+            m_slotOf.find(res.entries[i].id);
+        res.entries[i].timeLeftMs = (it != m_slotOf.end())
+            ? TimeLeftMs(m_slots[it->second].expireTime, now) : 0u;
+    }
+    return res;
+}
+
+BrowseResult BrowseIndex::Query(ServiceDatabase& db, const BrowseQuery& q,
+                                FetchStatus& status)
+{
+    ResolvePending(db);
+    BrowseResult res = Answer(q, time(NULL));
+    status = (res.totalcount == 0u && res.entries.empty()) ? FETCH_EMPTY : FETCH_OK;
+    return res;
+}
+
+size_t BrowseIndex::Size() const
+{
+    std::shared_lock<std::shared_mutex> guard(m_lock);
+    return m_slotOf.size();
+}
+
+size_t BrowseIndex::PendingCount() const
+{
+    std::shared_lock<std::shared_mutex> guard(m_lock);
+    return m_pending.size();
+}
+
+void BrowseIndex::TestSeedItem(uint32 entry, BrowseItemInfo const& info)
+{
+    std::unique_lock<std::shared_mutex> guard(m_lock);
+    CachedItem& item = m_items[entry];
+    item.info = info;
+    for (int loc = 0; loc < MAX_LOCALE; ++loc)
+    {
+        if (m_localeReady[loc])
+        {
+            LowerName(item, loc);
+        }
+    }
+}
+
+void BrowseIndex::TestResolve(uint32 auctionId, uint32 enchantId,
+                              uint32 suffixFactor, int32 charges)
+{
+    std::unique_lock<std::shared_mutex> guard(m_lock);
+    std::unordered_map<uint32, uint32>::const_iterator it = m_slotOf.find(auctionId);
+    if (it == m_slotOf.end())
+    {
+        return;
+    }
+    IndexedAuction& a = m_slots[it->second];
+    a.row.entry.enchantId    = enchantId;
+    a.row.entry.suffixFactor = suffixFactor;
+    a.row.entry.charges      = charges;
+    a.resolved               = true;
+    if (!m_pending.empty() && m_pending.back() == auctionId)
+    {
+        m_pending.pop_back();
+    }
+    else
+    {
+        m_pending.erase(std::remove(m_pending.begin(), m_pending.end(), auctionId),
+                        m_pending.end());
+    }
+}
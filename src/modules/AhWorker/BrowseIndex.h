@@ -0,0 +1,221 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2025 MaNGOS <https://www.getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef AH_WORKER_BROWSE_INDEX_H
+#define AH_WORKER_BROWSE_INDEX_H
+
+#include "Common.h"
+#include "BrowseHandler.h"
+#include "AuctionBook.h"
+
+#include <chrono>
+#include <map>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class ServiceDatabase;
+
+/**
+ * @file BrowseIndex.h
+ * @brief In-memory auction browse engine (serves IPC_BROWSE_QUERY without SQL).
+ *
+ * Under write authority the worker owns the `auction` table, so every change
+ * to it already passes through AuctionBook. The book forwards each mutation
+ * here (AuctionBook::AttachListener) and the browse workers answer from
+ * memory with the same result BrowseHandler::Fetch would produce: the same
+ * house scoping, the same proto filters, ascending auction id, and the rows
+ * then run through the shared BrowsePage filter/paginator.
+ *
+ * Per house group (alliance 1-3, horde 4-6, neutral 7) the index keeps sorted
+ * auction-id postings by class, class/subclass, InventoryType, Quality,
+ * RequiredLevel, owner and bidder, plus a per-locale trigram index over the
+ * lower-cased item name (built on the first name search in that locale). A
+ * LIST query walks its most selective posting only. Rows live in a dense slot
+ * array and postings carry the slot, so a walk never hashes.
+ *
+ * Threading: mutations arrive on the main service-loop thread, queries on the
+ * BrowsePool workers; a shared_mutex lets the workers read side by side. The item_instance fields the
+ * wire needs (enchant, suffix factor, charges) are not part of the mutation
+ * stream, so a freshly inserted auction is unresolved until a browse worker
+ * fetches its blob in one batched SELECT; unresolved rows are invisible, just
+ * as the Fetch JOIN hides an auction whose item_instance row is missing.
+ */
+
+/// item_template columns a browse needs, cached once per entry at boot.
+struct BrowseItemInfo
+{
+    uint32 itemClass;
+    uint32 itemSubClass;
+    uint32 inventoryType;
+    uint32 quality;
+    uint32 requiredLevel;
+    uint32 allowableClass;
+    uint32 allowableRace;
+    uint32 reqSkill;
+    uint32 reqSkillRank;
+    uint32 reqSpell;
+    uint32 reqHonorRank;
+    uint32 reqRepFaction;
+    uint32 reqRepRank;
+    uint32 castSpellId;
+    std::string names[MAX_LOCALE];   ///< [0] enUS name; others empty when no overlay
+};
+
+class BrowseIndex : public AuctionBookListener
+{
+    public:
+        BrowseIndex();
+
+        /**
+         * @brief Cache item_template (+ locales_item names) from the world DB.
+         *
+         * @return false when item_template cannot be read: the caller keeps
+         *         the SQL browse path.
+         */
+        bool LoadTemplates(ServiceDatabase& db);
+
+        /// Book listener (main thread). Rows start unresolved.
+        void OnInsert(BookRow const& row) override;
+        void OnBid(uint32 auctionId, uint32 bidder, uint32 bid) override;
+        void OnRemove(uint32 auctionId) override;
+
+        /**
+         * @brief Fetch the item_instance blob of every unresolved auction
+         *        (batched SELECT, no lock held while it runs).
+         *
+         * Rows whose item is still missing are retried at most once per
+         * RETRY_MS so an orphan does not cost every browse a query. When
+         * several workers arrive together only one issues the SELECT.
+         */
+        void ResolvePending(ServiceDatabase& db);
+
+        /// Browse worker: ResolvePending + Answer. Never reports FETCH_DB_ERROR.
+        BrowseResult Query(ServiceDatabase& db, const BrowseQuery& q,
+                           FetchStatus& status);
+
+        /// PURE: answer @p q from memory (no DB), timeLeftMs measured at @p now.
+        BrowseResult Answer(const BrowseQuery& q, time_t now);
+
+        size_t Size() const;
+        size_t PendingCount() const;
+
+        /// Test/bench seams: seed a template, resolve an auction's blob fields.
+        void TestSeedItem(uint32 entry, BrowseItemInfo const& info);
+        void TestResolve(uint32 auctionId, uint32 enchantId,
+                         uint32 suffixFactor, int32 charges);
+
+        static const uint32 RETRY_MS = 1000u;
+
+    private:
+        /// (auction id << 32) | slot, ascending: id order is Fetch's ORDER BY,
+        /// the slot reaches the row without a hash lookup.
+        typedef std::vector<uint64> Posting;
+
+        /// A template plus its names lower-cased the way Utf8FitTo does it,
+        /// filled per locale on the first name search in that locale.
+        struct CachedItem
+        {
+            BrowseItemInfo info;
+            std::wstring   lowered[MAX_LOCALE];
+            bool           convertible[MAX_LOCALE];   ///< false: name is not valid UTF-8
+        };
+
+        struct IndexedAuction
+        {
+            BrowseRow         row;          ///< entry + template columns (name unused)
+            CachedItem const* item;         ///< NULL: no item_template row (never listed)
+            uint64            expireTime;
+            uint32            bid;          ///< auction.lastbid (curBid/outbid derive from it)
+            uint32            itemGuid;
+            uint8             group;
+            bool              resolved;     ///< item_instance fields present
+            bool              live;         ///< false: free slot
+        };
+
+        struct Partition
+        {
+            Posting all;
+            std::unordered_map<uint32, Posting> byClass;
+            std::unordered_map<uint32, Posting> bySubClass;   ///< class << 16 | subclass
+            std::unordered_map<uint32, Posting> byInvType;
+            std::unordered_map<uint32, Posting> byOwner;
+            std::unordered_map<uint32, Posting> byBidder;
+            std::map<uint32, Posting>           byQuality;
+            std::map<uint32, Posting>           byLevel;
+            std::unordered_map<uint64, Posting> byTrigram[MAX_LOCALE];
+        };
+
+        static const uint8 NO_GROUP = 0xFF;
+
+        /// houseid -> partition; unlike AuctionBook::HouseGroup an invalid
+        /// house maps nowhere, because Fetch's house clause never matches it.
+        static uint8 Group(uint8 houseId);
+        /// The partition a query is scoped to (Fetch's HouseClause).
+        static uint8 QueryGroup(const BrowseQuery& q);
+
+        static uint64 Key(uint32 auctionId, uint32 slot)
+        {
+            return (uint64(auctionId) << 32) | slot;
+        }
+        static void PostingAdd(Posting& p, uint64 key);
+        static void PostingErase(Posting& p, uint64 key);
+        /// PostingErase on @p map's @p bucket, dropping the bucket once it
+        /// is empty so owner, bidder and trigram keys do not pile up.
+        template <class Map>
+        static void BucketErase(Map& map, typename Map::key_type bucket, uint64 key);
+
+        static std::string const& NameOf(CachedItem const& item, int locale);
+        static void LowerName(CachedItem& item, int locale);
+        static void Trigrams(std::wstring const& lowered, std::vector<uint64>& out);
+
+        void IndexAuction(uint32 slot);
+        void UnindexAuction(uint32 slot);
+        void PrepareLocale(int locale);
+
+        /// LIST: narrowest posting for @p q, materialized into @p scratch when
+        /// it is a union or an intersection. NULL: nothing can match.
+        Posting const* PlanList(Partition const& part, const BrowseQuery& q,
+                                std::wstring const& needle, Posting& scratch) const;
+        static bool ProtoMatches(BrowseRow const& r, const BrowseQuery& q);
+        static void FillRow(IndexedAuction& a);
+        static uint32 TimeLeftMs(uint64 expireTime, time_t now);
+
+        typedef std::unordered_map<uint32, CachedItem> ItemMap;
+
+        mutable std::shared_mutex             m_lock;
+        ItemMap                               m_items;
+        std::vector<IndexedAuction>           m_slots;
+        std::vector<uint32>                   m_freeSlots;
+        std::unordered_map<uint32, uint32>    m_slotOf;         ///< auction id -> slot
+        Partition                             m_parts[3];
+        bool                                  m_localeReady[MAX_LOCALE];
+        std::vector<uint32>                   m_pending;        ///< unresolved auction ids
+        bool                                  m_pendingFresh;   ///< inserts since the last resolve pass
+        std::chrono::steady_clock::time_point m_nextRetry;      ///< earliest retry of a missing item
+
+        // Non-copyable.
+        BrowseIndex(const BrowseIndex&);
+        BrowseIndex& operator=(const BrowseIndex&);
+};
+
+#endif // AH_WORKER_BROWSE_INDEX_H
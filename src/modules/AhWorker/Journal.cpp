@@ -22,7 +22,11 @@
 #include "Journal.h"
 #include "ServiceDatabase.h"
 #include "Database/DatabaseEnv.h"
+#include "AhHouseShards.h"
+#include "AuctionIntents.h"
+#include "PlayerMutations.h"
 
+#include <cstdio>
 #include <ctime>
 #include <limits>
 
@@ -314,3 +318,75 @@ bool AhJournal::DeleteTerminalBatchOlderThan(ServiceDatabase& db, uint64 cutoff,
     hasMore = committedCount == batchRows || appliedCount == batchRows;
     return true;
 }
+
+bool AhJournal::RowHouseGroup(JournalRow const& row, uint8& group)
+{
+    ByteBuffer bb;
+    bb.append(reinterpret_cast<const uint8*>(row.facts.data()), row.facts.size());
+
+    switch (row.state)
+    {
+        case JRN_COMMITTED:
+        case JRN_CANCEL_PREPARED:
+        {
+            PlayerMutationResult res;
+            if (!res.Decode(bb))
+            {
+                return false;
+            }
+            group = AhHouseIdToGroup(res.facts.houseId);
+            return true;
+        }
+        case JRN_RESOLVING:
+        {
+            ResolveApply ra;
+            if (!ra.Decode(bb))
+            {
+                return false;
+            }
+            group = AhHouseIdToGroup(ra.facts.houseId);
+            return true;
+        }
+        case JRN_INTENT_PENDING:
+        {
+            SellIntent si;
+            if (!si.Decode(bb) || si.house >= AH_HOUSE_GROUP_COUNT)
+            {
+                return false;
+            }
+            group = si.house;
+            return true;
+        }
+        default:
+            return false;
+    }
+}
+
+size_t AhJournal::FilterByHouse(std::vector<JournalRow>& rows, uint8 houseMask)
+{
+    if (houseMask == AH_HOUSE_MASK_ALL)
+    {
+        return 0;
+    }
+
+    size_t kept = 0;
+    for (size_t i = 0; i < rows.size(); ++i)
+    {
+        uint8 group = 0;
+        if (!RowHouseGroup(rows[i], group))
+        {
+            fprintf(stderr, "ah-service: journal row " UI64FMTD " (state %u) has"
+                            " no readable house - kept by the alliance shard\n",
+                    rows[i].uuid, static_cast<unsigned>(rows[i].state));
+            group = 0;
+        }
+        if (houseMask & AhHouseGroupBit(group))
+        {
+            rows[kept++] = rows[i];
+        }
+    }
+
+    size_t const dropped = rows.size() - kept;
+    rows.resize(kept);
+    return dropped;
+}
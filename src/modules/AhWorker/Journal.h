@@ -114,6 +114,28 @@ namespace AhJournal
     bool DeleteTerminalBatchOlderThan(ServiceDatabase& db, uint64 cutoff,
                                       uint32 batchRows, bool& hasMore,
                                       uint32& deletedRows);
+
+    /**
+     * @brief House group (AhHouseShards.h) of the auction @p row concerns,
+     *        read from its facts: the PlayerMutationResult of a COMMITTED or
+     *        CANCEL_PREPARED row, the ResolveApply of a RESOLVING row, the
+     *        SellIntent of an INTENT_PENDING row.
+     * @return false when the facts do not decode or the state has none.
+     */
+    bool RowHouseGroup(JournalRow const& row, uint8& group);
+
+    /**
+     * @brief Keep only the active rows a house-shard worker owns.
+     *
+     * The journal table is shared by every shard (AH.Service.Shards), so a
+     * shard must adopt, re-send and re-mark only its own houses' rows. A row
+     * whose house cannot be read stays with the shard owning the alliance
+     * group, so exactly one shard keeps it. @p houseMask ==
+     * AH_HOUSE_MASK_ALL keeps everything.
+     *
+     * @return the number of rows dropped.
+     */
+    size_t FilterByHouse(std::vector<JournalRow>& rows, uint8 houseMask);
 }
 
 #endif // AH_WORKER_JOURNAL_H
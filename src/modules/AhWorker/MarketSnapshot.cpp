@@ -24,8 +24,32 @@
 #include "Database/DatabaseEnv.h"
 #include "Log/Log.h"
 
+#include <algorithm>
+
 static const uint32 k_maxConsecFailures = 5;
 
+static bool RecordIdLess(AuctionRecord const& rec, uint32 id)
+{
+    return rec.id < id;
+}
+
+static bool RecordLess(AuctionRecord const& a, AuctionRecord const& b)
+{
+    return a.id < b.id;
+}
+
+static bool SameRecord(AuctionRecord const& a, AuctionRecord const& b)
+{
+    return a.id == b.id && a.houseType == b.houseType &&
+           a.itemId == b.itemId && a.itemCount == b.itemCount &&
+           a.ownerGuid == b.ownerGuid && a.buyout == b.buyout &&
+           a.curBid == b.curBid && a.startBid == b.startBid &&
+           a.expireTime == b.expireTime && a.bidderGuid == b.bidderGuid &&
+           a.quality == b.quality && a.itemClass == b.itemClass &&
+           a.vendorBuyPrice == b.vendorBuyPrice &&
+           a.vendorSellPrice == b.vendorSellPrice;
+}
+
 // ---------------------------------------------------------------------------
 // houseid -> AhAuctionHouseType
 //
@@ -58,8 +82,16 @@ uint8 MarketSnapshot::HouseIdToType(uint32 houseid)
 MarketSnapshot::MarketSnapshot(ServiceDatabase& db)
     : m_db(db),
       m_consecutiveFailures(0),
-      m_hasSucceeded(false)
+      m_hasSucceeded(false),
+      m_incremental(false),
+      m_book(NULL),
+      m_resyncIntervalSec(0),
+      m_nextResync(0)
 {
+    m_drift.resyncs = 0u;
+    m_drift.missing = 0u;
+    m_drift.stale   = 0u;
+    m_drift.changed = 0u;
 }
 
 // ---------------------------------------------------------------------------
@@ -67,6 +99,47 @@ MarketSnapshot::MarketSnapshot(ServiceDatabase& db)
 // ---------------------------------------------------------------------------
 
 void MarketSnapshot::Refresh()
+{
+    if (m_incremental)
+    {
+        // The book keeps the view current; a resync only checks it.
+        const time_t now = time(NULL);
+        if (m_resyncIntervalSec == 0u || now < m_nextResync)
+        {
+            return;
+        }
+        m_nextResync = now + m_resyncIntervalSec;
+        Resync();
+        return;
+    }
+
+    House fresh[AH_MAX_AUCTION_HOUSE_TYPE];
+    if (!Query(fresh))
+    {
+        return;     // stale-fallback
+    }
+
+    // Success: replace snapshot.
+    for (int h = 0; h < AH_MAX_AUCTION_HOUSE_TYPE; ++h)
+    {
+        m_houses[h].swap(fresh[h]);
+    }
+    sLog.outDetail(
+        "MarketSnapshot::Refresh: OK"
+        " (alliance=%u horde=%u neutral=%u)",
+        static_cast<unsigned>(
+            m_houses[AH_AUCTION_HOUSE_ALLIANCE].size()),
+        static_cast<unsigned>(
+            m_houses[AH_AUCTION_HOUSE_HORDE].size()),
+        static_cast<unsigned>(
+            m_houses[AH_AUCTION_HOUSE_NEUTRAL].size()));
+}
+
+// ---------------------------------------------------------------------------
+// Query - the auction x item_template JOIN
+// ---------------------------------------------------------------------------
+
+bool MarketSnapshot::Query(House (&out)[AH_MAX_AUCTION_HOUSE_TYPE])
 {
     // auction lives in the character database; item_template lives in
     // the world database. Build a cross-database JOIN using the world
@@ -115,7 +188,7 @@ void MarketSnapshot::Refresh()
                 "MarketSnapshot::Refresh: character DB unreachable"
                 " (consecutive failures: %u)",
                 static_cast<unsigned>(m_consecutiveFailures));
-            return;     // stale-fallback
+            return false;
         }
 
         const uint32 auctionRows = probe->Fetch()[0].GetUInt32();
@@ -135,25 +208,15 @@ void MarketSnapshot::Refresh()
                 " (consecutive failures: %u)",
                 static_cast<unsigned>(auctionRows),
                 static_cast<unsigned>(m_consecutiveFailures));
-            return;     // stale-fallback
+            return false;
         }
 
         // Auction table is genuinely empty: snapshot is valid (all houses 0).
-        for (int h = 0; h < AH_MAX_AUCTION_HOUSE_TYPE; ++h)
-        {
-            m_houses[h].clear();
-        }
         m_consecutiveFailures = 0;
         m_hasSucceeded = true;
         sLog.outDetail("MarketSnapshot::Refresh: auction table empty"
                        " (0 auctions)");
-        return;
-    }
-
-    // Success: replace snapshot.
-    for (int h = 0; h < AH_MAX_AUCTION_HOUSE_TYPE; ++h)
-    {
-        m_houses[h].clear();
+        return true;
     }
 
     do
@@ -179,24 +242,234 @@ void MarketSnapshot::Refresh()
 
         if (rec.houseType < AH_MAX_AUCTION_HOUSE_TYPE)
         {
-            m_houses[rec.houseType].push_back(rec);
+            out[rec.houseType].push_back(rec);
         }
     }
     while (result->NextRow());
 
     delete result;
 
+    // Id order: the incremental view keeps it, so a resync compares by merge.
+    for (int h = 0; h < AH_MAX_AUCTION_HOUSE_TYPE; ++h)
+    {
+        std::sort(out[h].begin(), out[h].end(), RecordLess);
+    }
+
     m_consecutiveFailures = 0;
     m_hasSucceeded = true;
-    sLog.outDetail(
-        "MarketSnapshot::Refresh: OK"
-        " (alliance=%u horde=%u neutral=%u)",
-        static_cast<unsigned>(
-            m_houses[AH_AUCTION_HOUSE_ALLIANCE].size()),
-        static_cast<unsigned>(
-            m_houses[AH_AUCTION_HOUSE_HORDE].size()),
-        static_cast<unsigned>(
-            m_houses[AH_AUCTION_HOUSE_NEUTRAL].size()));
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// Following the auction book
+// ---------------------------------------------------------------------------
+
+bool MarketSnapshot::LoadTemplates()
+{
+    QueryResult* result = m_db.World().Query(
+        "SELECT `entry`, `Quality`, `class`, `BuyPrice`, `SellPrice`"
+        " FROM `item_template`");
+    if (!result)
+    {
+        sLog.outError("MarketSnapshot::LoadTemplates: item_template"
+                      " unreadable - keeping full refreshes");
+        return false;
+    }
+
+    m_templates.clear();
+    do
+    {
+        Field* f = result->Fetch();
+        TemplateInfo& t = m_templates[f[0].GetUInt32()];
+        t.quality   = f[1].GetUInt32();
+        t.itemClass = f[2].GetUInt32();
+        t.buyPrice  = f[3].GetUInt32();
+        t.sellPrice = f[4].GetUInt32();
+    }
+    while (result->NextRow());
+    delete result;
+    return true;
+}
+
+void MarketSnapshot::TestSeedTemplate(uint32 entry, uint32 quality,
+                                      uint32 itemClass, uint32 buyPrice,
+                                      uint32 sellPrice)
+{
+    TemplateInfo& t = m_templates[entry];
+    t.quality   = quality;
+    t.itemClass = itemClass;
+    t.buyPrice  = buyPrice;
+    t.sellPrice = sellPrice;
+}
+
+void MarketSnapshot::Follow(AuctionBook& book)
+{
+    for (int h = 0; h < AH_MAX_AUCTION_HOUSE_TYPE; ++h)
+    {
+        m_houses[h].clear();
+    }
+    // The book is the table's writer: its image is as good as a refresh.
+    m_incremental = true;
+    m_hasSucceeded = true;
+    m_nextResync = time(NULL) + m_resyncIntervalSec;
+    m_book = &book;
+    book.AttachListener(this);
+}
+
+AuctionRecord* MarketSnapshot::Find(uint32 auctionId)
+{
+    for (int h = 0; h < AH_MAX_AUCTION_HOUSE_TYPE; ++h)
+    {
+        House::iterator it = std::lower_bound(m_houses[h].begin(),
+                                              m_houses[h].end(), auctionId,
+                                              RecordIdLess);
+        if (it != m_houses[h].end() && it->id == auctionId)
+        {
+            return &*it;
+        }
+    }
+    return NULL;
+}
+
+void MarketSnapshot::OnInsert(BookRow const& row)
+{
+    std::unordered_map<uint32, TemplateInfo>::const_iterator t =
+        m_templates.find(row.itemTemplate);
+    if (t == m_templates.end())
+    {
+        return;     // the JOIN drops it too
+    }
+
+    AuctionRecord rec;
+    rec.id              = row.id;
+    rec.houseType       = HouseIdToType(row.houseId);
+    rec.itemId          = row.itemTemplate;
+    rec.itemCount       = row.itemCount;
+    rec.ownerGuid       = row.owner;
+    rec.buyout          = row.buyout;
+    rec.curBid          = row.bid;
+    rec.startBid        = row.startbid;
+    rec.expireTime      = static_cast<uint32>(row.expireTime);
+    rec.bidderGuid      = row.bidder;
+    rec.quality         = t->second.quality;
+    rec.itemClass       = t->second.itemClass;
+    rec.vendorBuyPrice  = t->second.buyPrice;
+    rec.vendorSellPrice = t->second.sellPrice;
+
+    // New ids are the highest, so this is an append in the common case.
+    House& house = m_houses[rec.houseType];
+    House::iterator it = std::lower_bound(house.begin(), house.end(), rec.id,
+                                          RecordIdLess);
+    if (it != house.end() && it->id == rec.id)
+    {
+        *it = rec;
+    }
+    else
+    {
+        house.insert(it, rec);
+    }
+}
+
+void MarketSnapshot::OnBid(uint32 auctionId, uint32 bidder, uint32 bid)
+{
+    if (AuctionRecord* rec = Find(auctionId))
+    {
+        rec->bidderGuid = bidder;
+        rec->curBid     = bid;
+    }
+}
+
+void MarketSnapshot::OnRemove(uint32 auctionId)
+{
+    for (int h = 0; h < AH_MAX_AUCTION_HOUSE_TYPE; ++h)
+    {
+        House::iterator it = std::lower_bound(m_houses[h].begin(),
+                                              m_houses[h].end(), auctionId,
+                                              RecordIdLess);
+        if (it != m_houses[h].end() && it->id == auctionId)
+        {
+            m_houses[h].erase(it);
+            return;
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Resync - rebuild from the book, counting the drift
+//
+// Not against the auction table: the book's writes reach it through the async
+// queue, so under load the table lags the book and adopting it would drop
+// fresh posts and bring back sold auctions.
+// ---------------------------------------------------------------------------
+
+void MarketSnapshot::Resync()
+{
+    if (m_book == NULL)
+    {
+        return;
+    }
+
+    House view[AH_MAX_AUCTION_HOUSE_TYPE];
+    for (int h = 0; h < AH_MAX_AUCTION_HOUSE_TYPE; ++h)
+    {
+        view[h].swap(m_houses[h]);
+    }
+    m_book->Mirror(*this);
+
+    uint32 missing = 0u;
+    uint32 stale   = 0u;
+    uint32 changed = 0u;
+    uint32 rows    = 0u;
+
+    for (int h = 0; h < AH_MAX_AUCTION_HOUSE_TYPE; ++h)
+    {
+        House const& old  = view[h];
+        House const& book = m_houses[h];
+        size_t i = 0;
+        size_t j = 0;
+        while (i < old.size() || j < book.size())
+        {
+            if (j == book.size() || (i < old.size() && old[i].id < book[j].id))
+            {
+                ++stale;
+                ++i;
+            }
+            else if (i == old.size() || book[j].id < old[i].id)
+            {
+                ++missing;
+                ++j;
+            }
+            else
+            {
+                if (!SameRecord(old[i], book[j]))
+                {
+                    ++changed;
+                }
+                ++i;
+                ++j;
+            }
+        }
+        rows += static_cast<uint32>(book.size());
+    }
+
+    ++m_drift.resyncs;
+    m_drift.missing += missing;
+    m_drift.stale   += stale;
+    m_drift.changed += changed;
+
+    if (missing != 0u || stale != 0u || changed != 0u)
+    {
+        sLog.outString(
+            "MarketSnapshot: resync of %u auction(s) found drift: %u missing,"
+            " %u stale, %u changed (since start: " UI64FMTD " / " UI64FMTD
+            " / " UI64FMTD " over " UI64FMTD " resync(s))",
+            rows, missing, stale, changed, m_drift.missing, m_drift.stale,
+            m_drift.changed, m_drift.resyncs);
+    }
+    else
+    {
+        sLog.outDetail("MarketSnapshot: resync of %u auction(s) clean", rows);
+    }
 }
 
 // ---------------------------------------------------------------------------
@@ -24,7 +24,10 @@
 
 #include "Common.h"
 #include "AhBotDefines.h"
+#include "AuctionBook.h"
 
+#include <ctime>
+#include <unordered_map>
 #include <vector>
 
 class ServiceDatabase;
@@ -33,7 +36,8 @@ class ServiceDatabase;
  * @brief A single auction entry from the live auction table.
  *
  * Fields are populated by MarketSnapshot::Refresh() from a JOIN of
- * @c auction and @c item_template.  All monetary values are in copper.
+ * @c auction and @c item_template, or from the auction book plus the cached
+ * item_template columns.  All monetary values are in copper.
  */
 struct AuctionRecord
 {
@@ -53,14 +57,37 @@ struct AuctionRecord
     uint32 vendorSellPrice; ///< item_template.SellPrice (vendor sell, copper).
 };
 
+/**
+ * @brief How far the incremental view had drifted from the book, counted
+ *        at each consistency resync.
+ */
+struct SnapshotDrift
+{
+    uint64 resyncs;     ///< resyncs compared
+    uint64 missing;     ///< rows in the book the view did not have
+    uint64 stale;       ///< rows in the view the book no longer had
+    uint64 changed;     ///< rows present in both with different columns
+};
+
 /**
  * @brief Read-only snapshot of the live auction tables.
  *
  * Refresh() issues one SELECT joining @c auction and @c item_template for
  * all three houses in a single query, then groups the results by house into
- * three vectors.  On failure the previous snapshot is preserved (stale
- * fallback); after more than five consecutive failures Healthy() returns
- * false so 8c can stop emitting while the DB is unreachable.
+ * three vectors sorted by auction id.  On failure the previous snapshot is
+ * preserved (stale fallback); after more than five consecutive failures
+ * Healthy() returns false so 8c can stop emitting while the DB is
+ * unreachable.
+ *
+ * Under write authority every change to @c auction passes through the
+ * worker's AuctionBook, so the snapshot can follow the book instead: after
+ * LoadTemplates() caches the item_template columns and Follow() mirrors the
+ * book in, each create / bid / buyout / cancel / expiry updates one record in
+ * place and Refresh() no longer queries. Every
+ * SetResyncInterval() seconds Refresh() rebuilds the view from the book and
+ * counts how far it had drifted (Drift()). The book, not the table, is the
+ * reference: its writes reach the table through the async queue, so the
+ * table can lag it.
  *
  * The houseid->houseType mapping is derived from
  * AuctionHouseMgr::GetAuctionHouseTeam() (AuctionHouseMgr.cpp:555-564):
@@ -69,7 +96,7 @@ struct AuctionRecord
  *   houseid 7     -> NEUTRAL  (AH_AUCTION_HOUSE_NEUTRAL  = 2)
  *   all others    -> NEUTRAL  (safe default)
  */
-class MarketSnapshot
+class MarketSnapshot : public AuctionBookListener
 {
     public:
         /**
@@ -83,9 +110,40 @@ class MarketSnapshot
          *
          * On query failure the previous snapshot is preserved.  Successive
          * failures increment @c m_consecutiveFailures; > 5 trips Healthy().
+         * Once following the book this only queries when a resync is due.
          */
         void Refresh();
 
+        /**
+         * @brief Cache the item_template columns a record carries, so book
+         *        rows can be turned into records without the JOIN.
+         *
+         * @return false when item_template cannot be read: the caller keeps
+         *         the snapshot on full refreshes.
+         */
+        bool LoadTemplates();
+
+        /// Seconds between consistency resyncs while following the book
+        /// (0 = never).
+        void SetResyncInterval(uint32 seconds) { m_resyncIntervalSec = seconds; }
+
+        /**
+         * @brief Rebuild the view from @p book's rows and keep it current from
+         *        the book's mutations from now on. Call after LoadTemplates().
+         */
+        void Follow(AuctionBook& book);
+
+        /// Book listener (main thread).
+        void OnInsert(BookRow const& row) override;
+        void OnBid(uint32 auctionId, uint32 bidder, uint32 bid) override;
+        void OnRemove(uint32 auctionId) override;
+
+        /// True once the snapshot follows the book.
+        bool Incremental() const { return m_incremental; }
+
+        /// Cumulative drift found by the resyncs.
+        SnapshotDrift const& Drift() const { return m_drift; }
+
         /**
          * @brief Auction list for one house.
          *
@@ -113,18 +171,50 @@ class MarketSnapshot
          */
         uint32 ConsecutiveFailures() const;
 
+        /// Test seam: cache one template without the world DB.
+        void TestSeedTemplate(uint32 entry, uint32 quality, uint32 itemClass,
+                              uint32 buyPrice, uint32 sellPrice);
+
+        /// Test seam: run the resync now.
+        void TestResync() { Resync(); }
+
     private:
+        typedef std::vector<AuctionRecord> House;
+
+        /// The item_template columns an AuctionRecord carries.
+        struct TemplateInfo
+        {
+            uint32 quality;
+            uint32 itemClass;
+            uint32 buyPrice;
+            uint32 sellPrice;
+        };
+
         /// Convert a DB houseid to AhAuctionHouseType.
         static uint8 HouseIdToType(uint32 houseid);
 
+        /// Run the JOIN into @p out, sorted by id. false: failure (counted).
+        bool Query(House (&out)[AH_MAX_AUCTION_HOUSE_TYPE]);
+        /// Rebuild the view from the book, counting the drift from the old one.
+        void Resync();
+        /// The record for @p auctionId, or NULL.
+        AuctionRecord* Find(uint32 auctionId);
+
         ServiceDatabase&                 m_db;
-        std::vector<AuctionRecord>       m_houses[AH_MAX_AUCTION_HOUSE_TYPE];
+        House                            m_houses[AH_MAX_AUCTION_HOUSE_TYPE];
         uint32                           m_consecutiveFailures;
         /// True once a refresh has succeeded (populated or confirmed-empty).
         /// Until then Healthy() is false so the seller never trusts the
         /// default-empty snapshot (see Refresh() / Healthy()).
         bool                             m_hasSucceeded;
 
+        std::unordered_map<uint32, TemplateInfo> m_templates;
+        bool                             m_incremental;
+        AuctionBook*                     m_book;    ///< followed book, or NULL
+        uint32                           m_resyncIntervalSec;
+        time_t                           m_nextResync;
+        SnapshotDrift                    m_drift;
+
         // Non-copyable.
         MarketSnapshot(const MarketSnapshot&);
         MarketSnapshot& operator=(const MarketSnapshot&);
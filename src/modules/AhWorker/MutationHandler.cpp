@@ -57,7 +57,7 @@ namespace
 
 MutationHandler::MutationHandler(AuctionBook& book, ServiceDatabase* db, uint32 runId)
     : m_book(book), m_db(db), m_runId(runId), m_nextSeq(0x80000000u),
-      m_gameTimeNow(0)
+      m_gameTimeNow(0), m_inGroup(false)
 {
 }
 
@@ -140,15 +140,20 @@ uint32 MutationHandler::LookupAccount(uint32 guidLow) const
 
 bool MutationHandler::BeginCommit()
 {
-    if (m_db == NULL)
+    if (m_db == NULL || m_inGroup)
     {
-        return true;   // selftest mode
+        return true;   // selftest mode / the group's txn is already open
     }
     return m_db->Character().BeginTransaction();
 }
 
-bool MutationHandler::FinishCommit()
+bool MutationHandler::FinishCommit(GroupUndo const& undo)
 {
+    if (m_inGroup)
+    {
+        m_groupUndo.push_back(undo);
+        return true;   // committed (or undone) by CommitGroup
+    }
     if (m_db == NULL)
     {
         return true;   // selftest mode
@@ -165,6 +170,110 @@ bool MutationHandler::FinishCommit()
     return committed;
 }
 
+bool MutationHandler::BeginGroup()
+{
+    if (m_db != NULL && !m_db->Character().BeginTransaction())
+    {
+        return false;
+    }
+    m_inGroup = true;
+    m_groupUndo.clear();
+    return true;
+}
+
+bool MutationHandler::CommitGroupTransaction()
+{
+    if (m_db == NULL)
+    {
+        return true;   // selftest mode
+    }
+    bool const committed = m_db->Character().CommitTransactionChecked();
+    if (committed)
+    {
+        // Same crash point as the ungrouped commit: every journal COMMITTED
+        // row of the group is durable and no reply has been sent yet.
+        AhWorkerMaybeCrash("worker-committed-pre-reply");
+    }
+    return committed;
+}
+
+bool MutationHandler::CommitGroup(std::vector<PlayerMutationResult>& results)
+{
+    m_inGroup = false;
+    std::vector<GroupUndo> undo;
+    undo.swap(m_groupUndo);
+
+    if (undo.empty())
+    {
+        // Only rejections: nothing was written, so there is nothing to commit.
+        if (m_db != NULL)
+        {
+            m_db->Character().RollbackTransaction();
+        }
+        return true;
+    }
+
+    if (CommitGroupTransaction())
+    {
+        return true;
+    }
+
+    // The DB rolled the whole group back: undo the book the same way.
+    for (size_t i = undo.size(); i-- > 0; )
+    {
+        GroupUndo const& u = undo[i];
+        switch (u.kind)
+        {
+            case GroupUndo::UNDO_INSERT:
+                m_book.RollbackInsert(u.row.id);
+                break;
+            case GroupUndo::UNDO_BID:
+                m_book.RollbackUpdateBid(u.row.id, u.prevBidder, u.prevBid);
+                break;
+            case GroupUndo::UNDO_REMOVE:
+                m_book.RollbackRemove(u.row);
+                break;
+        }
+    }
+
+    // Rewrite each admitted reply as its ungrouped commit-failure reply.
+    std::map<uint64, size_t> undoOf;
+    for (size_t i = 0; i < undo.size(); ++i)
+    {
+        undoOf[undo[i].uuid] = i;
+    }
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        PlayerMutationResult& res = results[i];
+        std::map<uint64, size_t>::const_iterator it = undoOf.find(res.uuid);
+        if (res.status != MUT_OK || it == undoOf.end())
+        {
+            continue;
+        }
+        GroupUndo const& u = undo[it->second];
+        res.status = MUT_REJECTED;
+        res.reason = BOOK_ERR_DATABASE;
+        ClearFacts(res.facts);
+        if (u.kind == GroupUndo::UNDO_REMOVE)
+        {
+            FillFacts(u.row, res.facts);
+        }
+        else if (u.kind == GroupUndo::UNDO_BID)
+        {
+            BookRow const* row = m_book.Find(u.row.id);
+            if (row != NULL)
+            {
+                FillFacts(*row, res.facts);
+            }
+        }
+    }
+
+    fprintf(stderr, "ah-service: group commit of %u mutation(s) failed -"
+                    " all REJECTED err-database\n",
+            static_cast<unsigned>(undo.size()));
+    return false;
+}
+
 void MutationHandler::JournalCommitted(uint64 uuid, uint32 auctionId, uint8 kind,
                                        PlayerMutationResult const& res)
 {
@@ -320,6 +429,16 @@ PlayerMutationResult MutationHandler::OnSell(PlayerSellIntent const& in)
         return res;
     }
 
+    // mangosd routes each sell to the shard owning its house
+    // (AH.Service.Shards); anything else is a routing fault.
+    if (!m_book.OwnsHouse(in.house))
+    {
+        fprintf(stderr, "ah-service: protocol fault: IPC_PLAYER_SELL for"
+                        " houseid %u outside this worker's houses\n",
+                static_cast<unsigned>(in.house));
+        return res;
+    }
+
     // 50-owned-listings cap, moved worker-side (spec I6). Legacy replies
     // AUCTION_ERR_DATABASE on AUCTION_STARTED (AuctionHouseHandler.cpp:579-601).
     if (m_book.CountOwned(in.sellerGuid, in.house) >= 50u)
@@ -355,7 +474,8 @@ PlayerMutationResult MutationHandler::OnSell(PlayerSellIntent const& in)
     FillFacts(row, res.facts);
 
     JournalCommitted(in.uuid, in.auctionId, 0x40u, res);
-    if (!FinishCommit())
+    GroupUndo const undo = { GroupUndo::UNDO_INSERT, in.uuid, row, 0u, 0u };
+    if (!FinishCommit(undo))
     {
         m_book.RollbackInsert(in.auctionId);
         res.status = MUT_REJECTED;
@@ -435,7 +555,9 @@ PlayerMutationResult MutationHandler::CommitBidAt(uint32 auctionId, uint32 bidde
     res.facts.effectiveBid    = amount;
 
     JournalCommitted(uuid, auctionId, op, res);
-    if (!FinishCommit())
+    GroupUndo const undo = { GroupUndo::UNDO_BID, uuid, *m_book.Find(auctionId),
+                             prevBidder, prevBid };
+    if (!FinishCommit(undo))
     {
         m_book.RollbackUpdateBid(auctionId, prevBidder, prevBid);
         res.status = MUT_REJECTED;
@@ -511,7 +633,8 @@ PlayerMutationResult MutationHandler::OnBuyout(PlayerBuyoutIntent const& in)
     // priorBidderGuid / priorBidAmount already carry the outbid-refund leg.
 
     JournalCommitted(in.uuid, in.auctionId, 0x42u, res);
-    if (!FinishCommit())
+    GroupUndo const undo = { GroupUndo::UNDO_REMOVE, in.uuid, sold, 0u, 0u };
+    if (!FinishCommit(undo))
     {
         m_book.RollbackRemove(sold);
         res.status = MUT_REJECTED;
@@ -649,7 +772,8 @@ PlayerMutationResult MutationHandler::OnCancelDecide(uint64 uuid, uint32 auction
             AhJournal::SetState(*m_db, uuid, AhJournal::JRN_COMMITTED,
                                 static_cast<uint64>(time(NULL)));
         }
-        if (!FinishCommit())
+        GroupUndo const undo = { GroupUndo::UNDO_REMOVE, uuid, removed, 0u, 0u };
+        if (!FinishCommit(undo))
         {
             // DB rolled back: restore the prepared row in memory. The lock
             // stays armed and the timeout sweep recovers it; mangosd releases
@@ -1296,8 +1420,7 @@ bool MutationHandler::OnBotBid(uint64 uuid, uint32 auctionId, uint32 bidAmount)
         {
             return false;   // nothing sent; memory untouched
         }
-        row->bidder = 0u;
-        row->bid    = bidAmount;
+        m_book.UpdateBidMemoryOnly(auctionId, 0u, bidAmount);
         row->state  = static_cast<uint8>(BOOK_LIVE);
 
         // The refund row is already durable (co-committed above): track+send
@@ -1313,8 +1436,7 @@ bool MutationHandler::OnBotBid(uint64 uuid, uint32 auctionId, uint32 bidAmount)
     {
         return false;
     }
-    row->bidder = 0u;
-    row->bid    = bidAmount;
+    m_book.UpdateBidMemoryOnly(auctionId, 0u, bidAmount);
     return true;
 }
 
@@ -1354,36 +1476,56 @@ bool MutationHandler::OnBotBuyout(uint64 uuid, uint32 auctionId)
 
 bool MutationHandler::BotSellBegin(SellIntent const& si)
 {
-    // Journal the intent PENDING (facts = encoded SellIntent) durably BEFORE the
-    // send, so a crash after the send still replays the materialization request.
-    // auctionId is unknown until mangosd allocates it (sole allocator, spec 8).
-    ByteBuffer bb;
-    si.Encode(bb);
+    return BotSellBeginBatch(std::vector<SellIntent>(1, si)) == 1u;
+}
 
-    AhJournal::JournalRow row;
-    row.uuid         = si.uuid;
-    row.auctionId    = 0u;
-    row.kind         = static_cast<uint8>(JKIND_BOT_SELL);
-    row.state        = static_cast<uint8>(AhJournal::JRN_INTENT_PENDING);
-    row.facts        = std::string(reinterpret_cast<const char*>(bb.contents()),
-                                   bb.size());
-    row.createdTime  = static_cast<uint64>(time(NULL));
-    row.resolvedTime = 0u;
+size_t MutationHandler::BotSellBeginBatch(std::vector<SellIntent> const& sells)
+{
+    if (sells.empty())
+    {
+        return 0;
+    }
 
-    if (!PersistIntentPending(row))
+    // Journal the intents PENDING (facts = encoded SellIntent) durably BEFORE
+    // the send, so a crash after the send still replays the materialization
+    // request. auctionId is unknown until mangosd allocates it (sole
+    // allocator, spec 8).
+    uint64 const now = static_cast<uint64>(time(NULL));
+    std::vector<AhJournal::JournalRow> rows(sells.size());
+    for (size_t i = 0; i < sells.size(); ++i)
     {
-        return false;
+        ByteBuffer bb;
+        sells[i].Encode(bb);
+
+        AhJournal::JournalRow& row = rows[i];
+        row.uuid         = sells[i].uuid;
+        row.auctionId    = 0u;
+        row.kind         = static_cast<uint8>(JKIND_BOT_SELL);
+        row.state        = static_cast<uint8>(AhJournal::JRN_INTENT_PENDING);
+        row.facts        = std::string(reinterpret_cast<const char*>(bb.contents()),
+                                       bb.size());
+        row.createdTime  = now;
+        row.resolvedTime = 0u;
     }
 
-    // In-memory copy: repurpose resolvedTime as the last-send anchor.
-    row.resolvedTime = row.createdTime;
-    m_pendingSells[si.uuid] = row;
+    if (!PersistIntentPending(rows))
+    {
+        return 0;
+    }
 
-    IpcMessage msg;
-    msg.op = IPC_INTENT_SELL;
-    si.Encode(msg.body);
-    QueueSend(msg);
-    return true;
+    for (size_t i = 0; i < sells.size(); ++i)
+    {
+        // In-memory copy: repurpose resolvedTime as the last-send anchor.
+        AhJournal::JournalRow& row = rows[i];
+        row.resolvedTime = row.createdTime;
+        m_pendingSells[row.uuid] = row;
+
+        IpcMessage msg;
+        msg.op = IPC_INTENT_SELL;
+        sells[i].Encode(msg.body);
+        QueueSend(msg);
+    }
+    return sells.size();
 }
 
 void MutationHandler::OnBotSellResult(uint64 uuid, uint8 status, uint8 reason,
@@ -1639,7 +1781,8 @@ bool MutationHandler::PersistBotBidDisplacing(BookRow const& row, uint32 bidAmou
     return db.CommitTransactionChecked();
 }
 
-bool MutationHandler::PersistIntentPending(AhJournal::JournalRow const& row)
+bool MutationHandler::PersistIntentPending(
+    std::vector<AhJournal::JournalRow> const& rows)
 {
     if (m_db == NULL)
     {
@@ -1650,7 +1793,10 @@ bool MutationHandler::PersistIntentPending(AhJournal::JournalRow const& row)
     {
         return false;
     }
-    AhJournal::Insert(*m_db, row);
+    for (size_t i = 0; i < rows.size(); ++i)
+    {
+        AhJournal::Insert(*m_db, rows[i]);
+    }
     return m_db->Character().CommitTransactionChecked();
 }
 
@@ -200,6 +200,35 @@ class MutationHandler
          */
         PlayerMutationResult OnCancelDecide(uint64 uuid, uint32 auctionId, bool confirm);
 
+        // --- Group commit (AH.Service.GroupCommitMax > 1) ---------------------
+
+        /**
+         * @brief Open one character-DB transaction that the following OnSell /
+         *        OnBid / OnBuyout calls share instead of committing one by one.
+         *        Their book changes still apply at once; the caller holds their
+         *        replies until CommitGroup(). The cancel steps, resolve acks,
+         *        the tick and the bot paths run their own transactions and must
+         *        not be called while a group is open.
+         * @return false if the transaction could not be opened (the caller
+         *         then runs the mutations ungrouped).
+         */
+        bool BeginGroup();
+
+        /**
+         * @brief Commit the open group. On failure every book change of the
+         *        group is rolled back, newest first, and each MUT_OK result of
+         *        the group in @p results is rewritten to the reply the ungrouped
+         *        path gives on a failed commit (MUT_REJECTED, err-database).
+         * @return true if the group committed (or had nothing to commit).
+         */
+        bool CommitGroup(std::vector<PlayerMutationResult>& results);
+
+        /// True between BeginGroup() and CommitGroup().
+        bool InGroup() const
+        {
+            return m_inGroup;
+        }
+
         // --- SP-2 Task 8: bot fold-in (spec 5.2 / 5.4 / 6 / 4.3 / decision 4,8) --
 
         /// Journal `kind` for directly-APPLIED bot rows (spec M2). Disjoint from
@@ -239,6 +268,17 @@ class MutationHandler
          */
         bool BotSellBegin(SellIntent const& si);
 
+        /**
+         * @brief BotSellBegin for every sell one bot operation planned: the
+         *        JRN_INTENT_PENDING rows share ONE checked txn, then the
+         *        IPC_INTENT_SELL frames are queued in order. On a failed
+         *        commit nothing is sent and 0 is returned; the seller sees the
+         *        listings still missing on its next pass.
+         *
+         * @return The number of sells begun (all or none).
+         */
+        size_t BotSellBeginBatch(std::vector<SellIntent> const& sells);
+
         /**
          * @brief Materialization reply: on INTENT_OK commit the listing to the
          *        book + auction row + retire the INTENT_PENDING journal row
@@ -329,6 +369,9 @@ class MutationHandler
         /// Append one frame to the outbound queue (reliable lane on send).
         virtual void QueueSend(IpcMessage const& msg);
 
+        /// Checked commit of the open group transaction (true in selftest mode).
+        virtual bool CommitGroupTransaction();
+
         /// Track a freshly journalled resolution and queue its APPLY frame.
         void TrackAndSend(uint64 uuid, uint32 auctionId, uint8 kind,
                           std::string const& wire, uint64 now);
@@ -345,8 +388,9 @@ class MutationHandler
         virtual bool PersistBotBidDisplacing(BookRow const& row, uint32 bidAmount,
                                              uint64 resolveUuid,
                                              std::string const& factsBlob);
-        /// Standalone durable INSERT of a JRN_INTENT_PENDING row (before send).
-        virtual bool PersistIntentPending(AhJournal::JournalRow const& row);
+        /// Durable INSERT of JRN_INTENT_PENDING rows in one txn (before send).
+        virtual bool PersistIntentPending(
+            std::vector<AhJournal::JournalRow> const& rows);
         /// One txn: INSERT auction row (+ book insert) + retire the pending row
         /// to JRN_APPLIED.
         virtual bool PersistBotListing(BookRow const& row, uint64 uuid);
@@ -372,8 +416,29 @@ class MutationHandler
         /// SELECT account FROM characters (0 if unknown / selftest mode).
         uint32 LookupAccount(uint32 guidLow) const;
 
-        bool BeginCommit();    ///< BeginTransaction (true in selftest mode)
-        bool FinishCommit();   ///< CommitTransactionChecked (true in selftest mode)
+        /// How to take back one book change if its group fails to commit.
+        struct GroupUndo
+        {
+            enum Kind
+            {
+                UNDO_INSERT,   ///< RollbackInsert(row.id)
+                UNDO_BID,      ///< RollbackUpdateBid(row.id, prevBidder, prevBid)
+                UNDO_REMOVE    ///< RollbackRemove(row)
+            };
+
+            Kind    kind;
+            uint64  uuid;        ///< The mutation whose reply is rewritten.
+            BookRow row;         ///< UNDO_REMOVE: the removed row; else its id.
+            uint32  prevBidder;
+            uint32  prevBid;
+        };
+
+        /// BeginTransaction (true in selftest mode, and inside a group whose
+        /// transaction is already open).
+        bool BeginCommit();
+        /// CommitTransactionChecked (true in selftest mode). Inside a group the
+        /// commit is deferred to CommitGroup() and @p undo recorded instead.
+        bool FinishCommit(GroupUndo const& undo);
 
         /// Append the JRN_COMMITTED journal row (facts = encoded @p res) to the
         /// open transaction. No-op in selftest mode.
@@ -428,6 +493,10 @@ class MutationHandler
         // (resend throttle). ---------------------------------------------------
         std::map<uint64, AhJournal::JournalRow> m_pendingSells;
 
+        // --- Group commit state (BeginGroup .. CommitGroup) ------------------
+        bool                   m_inGroup;
+        std::vector<GroupUndo> m_groupUndo;   ///< In commit order.
+
         // Non-copyable: single-owner main-thread state.
         MutationHandler(const MutationHandler&);
         MutationHandler& operator=(const MutationHandler&);
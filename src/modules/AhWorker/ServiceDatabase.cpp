@@ -146,7 +146,7 @@ bool ServiceDatabase::InitCharacter()
     std::string dbstring =
         sConfig.GetStringDefault("CharacterDatabaseInfo", "");
     int nConnections =
-        sConfig.GetIntDefault("CharacterDatabaseConnections", 1);
+        sConfig.GetIntDefault("CharacterDatabaseConnections", 3);
 
     if (dbstring.empty())
     {
@@ -0,0 +1,1583 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2025 MaNGOS <https://www.getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * @file AhSoak.cpp
+ * @brief AH worker workload benchmark and soak harness.
+ *
+ * Plays the mangosd side of the AH IPC protocol against a real ah-service
+ * child and a real (disposable) character database: the child is spawned and
+ * supervised by the production WorkerSupervisor, and every frame goes over
+ * the production IpcServer. Thousands of synthetic players then issue an
+ * open-loop mix of browse / post / bid / buyout / cancel traffic at a fixed
+ * rate, each player with at most one request in flight.
+ *
+ * The harness answers what mangosd would: IPC_RESOLVE_APPLY gets a
+ * RES_APPLIED ack, cancel PREPAREs are CONFIRMed, and bot intents are
+ * rejected (the soak measures player traffic, not the bot). It keeps its own
+ * model of every auction it created, updated only from the worker's result
+ * facts, and periodically quiesces to audit that model against the
+ * `auction` table (custody drift).
+ *
+ * Reports, every --report seconds and at the end:
+ *   - per-op throughput, reject/lost counts and p50/p90/p99/max latency;
+ *   - resolution count and expiry lag (auction due -> IPC_RESOLVE_APPLY);
+ *   - ah_worker_journal growth per state since the run started;
+ *   - the latest custody audit.
+ *
+ * Each synthetic listing gets a minimal item_instance row, written through
+ * the harness's own character DB handle before the sell is sent, so the
+ * worker resolves it like a real listing and a restart reloads it. Run
+ * against a disposable DB clone only; see tools/ah_soak.md.
+ *
+ * Exit status: 0 when the final audit is clean, 1 on drift or setup failure.
+ */
+
+#include "Common.h"
+#include "Config/Config.h"
+#include "Database/DatabaseEnv.h"
+#include "ServiceDatabase.h"
+#include "WorkerSupervisor.h"
+#include "IpcMessage.h"
+#include "IpcOpcodes.h"
+#include "AuctionIntents.h"
+#include "BrowseMessages.h"
+#include "PlayerMutations.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <random>
+#include <set>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+typedef std::chrono::steady_clock SoakClock;
+
+enum SoakOp
+{
+    SOAK_BROWSE = 0,
+    SOAK_POST   = 1,
+    SOAK_BID    = 2,
+    SOAK_BUYOUT = 3,
+    SOAK_CANCEL = 4,
+    SOAK_OP_MAX = 5
+};
+
+static const char* const SOAK_OP_NAMES[SOAK_OP_MAX] =
+{
+    "browse", "post", "bid", "buyout", "cancel"
+};
+
+/// Listings a synthetic player keeps at most (the worker caps 50 per house).
+static const uint32 SOAK_MAX_LISTINGS = 40u;
+
+/// Synthetic item low GUIDs start here, or above the highest existing one.
+static const uint32 SOAK_ITEM_GUID_BASE = 0x60000000u;
+
+/// Words in a 1.12 item_instance.data blob (ITEM_END).
+static const uint32 SOAK_ITEM_WORDS = 48u;
+
+// ---------------------------------------------------------------------------
+// Options
+// ---------------------------------------------------------------------------
+
+struct SoakOptions
+{
+    std::string worker;             ///< ah-service executable
+    std::string config;             ///< ah-service.conf (DB keys; handed to the child)
+    uint16 port      = 5761;
+    uint32 botGuid   = 0;
+    uint32 players   = 2000;
+    uint32 guidBase  = 0x70000000u; ///< synthetic character low GUIDs (no `characters` row)
+    double rate      = 200.0;       ///< requests per second, all kinds
+    uint32 weights[SOAK_OP_MAX] = { 40, 20, 25, 5, 10 };
+    std::vector<uint8> houses;      ///< AuctionHouse.dbc ids (1..7)
+    uint32 duration  = 3600;        ///< seconds of traffic
+    uint32 report    = 60;          ///< seconds between reports
+    uint32 audit     = 300;         ///< seconds between custody audits
+    uint32 grace     = 120;         ///< seconds a due auction may wait for its resolve
+    uint32 timeout   = 30;          ///< seconds before an unanswered request is lost
+    uint32 expireMin = 120;         ///< listing duration range, seconds
+    uint32 expireMax = 1800;
+    uint32 seed      = 1;
+    bool   shm       = false;
+    bool   cleanup   = false;
+};
+
+// ---------------------------------------------------------------------------
+// Latency histogram
+// ---------------------------------------------------------------------------
+
+/**
+ * @brief Log-linear histogram of microsecond samples: 8 sub-buckets per
+ *        power of two (~12% resolution), constant memory however long the
+ *        soak runs. Percentiles report the bucket's upper bound.
+ */
+class SoakHistogram
+{
+    public:
+        SoakHistogram() : m_buckets(BUCKETS, 0u), m_count(0u), m_max(0u) {}
+
+        void Add(uint64 us)
+        {
+            ++m_buckets[Index(us)];
+            ++m_count;
+            if (us > m_max)
+            {
+                m_max = us;
+            }
+        }
+
+        void Merge(SoakHistogram const& other)
+        {
+            for (uint32 i = 0; i < BUCKETS; ++i)
+            {
+                m_buckets[i] += other.m_buckets[i];
+            }
+            m_count += other.m_count;
+            if (other.m_max > m_max)
+            {
+                m_max = other.m_max;
+            }
+        }
+
+        void Reset()
+        {
+            m_buckets.assign(BUCKETS, 0u);
+            m_count = 0u;
+            m_max   = 0u;
+        }
+
+        uint64 Count() const { return m_count; }
+        uint64 Max() const { return m_max; }
+
+        /// @p p in (0, 100]; 0 when empty.
+        uint64 Percentile(double p) const
+        {
+            if (m_count == 0u)
+            {
+                return 0u;
+            }
+            uint64 rank = static_cast<uint64>(p / 100.0 * double(m_count) + 0.5);
+            if (rank < 1u)
+            {
+                rank = 1u;
+            }
+            uint64 seen = 0u;
+            for (uint32 i = 0; i < BUCKETS; ++i)
+            {
+                seen += m_buckets[i];
+                if (seen >= rank)
+                {
+                    uint64 const upper = UpperBound(i);
+                    return upper < m_max ? upper : m_max;
+                }
+            }
+            return m_max;
+        }
+
+    private:
+        static const uint32 SUB_BITS = 3u;
+        static const uint32 BUCKETS  = 64u << SUB_BITS;
+
+        static uint32 Index(uint64 v)
+        {
+            if (v < (uint64(1) << SUB_BITS))
+            {
+                return static_cast<uint32>(v);
+            }
+            uint32 msb = 0u;
+            for (uint64 t = v; t > 1u; t >>= 1)
+            {
+                ++msb;
+            }
+            uint32 const sub = static_cast<uint32>(v >> (msb - SUB_BITS)) &
+                               ((1u << SUB_BITS) - 1u);
+            return ((msb - SUB_BITS + 1u) << SUB_BITS) + sub;
+        }
+
+        static uint64 UpperBound(uint32 index)
+        {
+            if (index < (1u << SUB_BITS))
+            {
+                return index;
+            }
+            uint32 const shift = (index >> SUB_BITS) - 1u;
+            uint64 const sub   = index & ((1u << SUB_BITS) - 1u);
+            uint64 const lower = ((uint64(1) << SUB_BITS) + sub) << shift;
+            return lower + (uint64(1) << shift) - 1u;
+        }
+
+        std::vector<uint64> m_buckets;
+        uint64              m_count;
+        uint64              m_max;
+};
+
+struct SoakOpStats
+{
+    uint64 sent     = 0;
+    uint64 ok       = 0;
+    uint64 rejected = 0;
+    uint64 lost     = 0;
+    SoakHistogram window;   ///< since the last report
+    SoakHistogram total;
+};
+
+// ---------------------------------------------------------------------------
+// Model
+// ---------------------------------------------------------------------------
+
+/// One auction the harness created, as the worker's result facts describe it.
+struct SoakAuction
+{
+    uint32 id         = 0;
+    uint8  house      = 0;
+    uint32 owner      = 0;
+    uint32 startbid   = 0;
+    uint32 buyout     = 0;
+    uint32 deposit    = 0;
+    uint32 bidder     = 0;
+    uint32 bid        = 0;
+    uint64 expireTime = 0;
+    uint32 liveIndex  = 0;      ///< position in SoakHarness::m_liveIds
+    bool   cancelling = false;  ///< a cancel PREPARE/CONFIRM is in flight
+};
+
+struct SoakPlayer
+{
+    uint32 guid = 0;
+    bool   busy = false;
+    std::vector<uint32> listings;   ///< posted or posting auction ids
+};
+
+struct SoakInFlight
+{
+    uint32 player    = 0;
+    uint8  op        = 0;           ///< SoakOp
+    uint32 auctionId = 0;
+    uint32 amount    = 0;           ///< bid amount / buyout max price
+    SoakClock::time_point sent;
+    SoakAuction draft;              ///< SOAK_POST: the listing as requested
+};
+
+struct SoakAuditResult
+{
+    uint32 checked    = 0;  ///< model auctions compared field by field
+    uint32 missing    = 0;  ///< live in the model, absent from the table
+    uint32 changed    = 0;  ///< present in both, bidder/bid/deposit differ
+    uint32 extra      = 0;  ///< live in the table, unknown to the model
+    uint32 unresolved = 0;  ///< model auction past due + grace, never resolved
+    uint32 overdue    = 0;  ///< table row past due + grace, resolved per the model
+    int64  bidDrift     = 0;   ///< table escrowed bids - model escrowed bids
+    int64  depositDrift = 0;   ///< table deposits - model deposits
+
+    bool Clean() const
+    {
+        return missing == 0u && changed == 0u && extra == 0u &&
+               unresolved == 0u && overdue == 0u &&
+               bidDrift == 0 && depositDrift == 0;
+    }
+};
+
+/// Journal state counts, indexed by AhJournal state (1..5); [0] = total.
+typedef std::vector<uint64> SoakJournalCounts;
+
+static const char* const SOAK_JOURNAL_NAMES[6] =
+{
+    "total", "committed", "resolving", "applied", "prepared", "intent"
+};
+
+// ---------------------------------------------------------------------------
+// Harness
+// ---------------------------------------------------------------------------
+
+class SoakHarness
+{
+    public:
+        SoakHarness(SoakOptions const& opt, ServiceDatabase& db)
+            : m_opt(opt), m_db(db), m_rng(opt.seed), m_supervisor(NULL),
+              m_auctionBase(0), m_nextAuctionId(0), m_itemBase(SOAK_ITEM_GUID_BASE),
+              m_nextItemGuid(SOAK_ITEM_GUID_BASE),
+              m_uuidSeq(0), m_queryId(0), m_issued(0), m_saturated(0),
+              m_reconnects(0), m_orphanResults(0), m_botIntents(0),
+              m_resolves(0), m_unlocks(0)
+        {
+        }
+
+        bool Setup();
+        int  Run();
+
+    private:
+        uint32 Below(uint32 n) { return n == 0u ? 0u : uint32(m_rng() % n); }
+        uint64 MintUuid();
+        double Elapsed() const;
+
+        void Pump();
+        void Handle(IpcMessage& msg);
+        void OnMutationResult(PlayerMutationResult const& res);
+        void OnResolveApply(ResolveApply const& ra);
+        void OnBrowseResult(BrowseResult const& res);
+        void RejectIntent(IpcMessage const& msg);
+
+        void IssueDue();
+        bool Issue(uint32 player);
+        bool Send(IpcMessage const& msg, uint64 key, SoakInFlight const& fl, bool browse);
+        void Finish(SoakInFlight const& fl, bool ok);
+        void ExpireInFlight();
+
+        void AddAuction(SoakAuction const& a);
+        void RemoveAuction(uint32 id);
+        void DropListing(uint32 player, uint32 id);
+        uint32 PlayerIndex(uint32 guid) const;
+        bool InsertItem(uint32 itemGuid, uint32 itemTemplate, uint32 owner);
+
+        bool Quiesce(uint32 maxSec);
+        SoakAuditResult Audit();
+        bool ReadJournal(SoakJournalCounts& out);
+        void Report(bool final);
+        void PrintOp(uint32 op, SoakHistogram const& h, double secs) const;
+
+        SoakOptions const&  m_opt;
+        ServiceDatabase&    m_db;
+        std::mt19937        m_rng;
+        WorkerSupervisor*   m_supervisor;
+
+        std::vector<uint32> m_templates;
+        std::vector<SoakPlayer> m_players;
+        std::unordered_map<uint32, SoakAuction> m_auctions;
+        std::vector<uint32> m_liveIds;          ///< keys of m_auctions, for O(1) picks
+        std::set<uint32>    m_unknownIds;       ///< posts whose outcome was lost
+
+        std::unordered_map<uint64, SoakInFlight> m_mutations;  ///< by uuid
+        std::unordered_map<uint64, SoakInFlight> m_browses;    ///< by queryId
+
+        uint32 m_auctionBase;
+        uint32 m_nextAuctionId;
+        uint32 m_itemBase;
+        uint32 m_nextItemGuid;
+        uint32 m_uuidSeq;
+        uint64 m_queryId;
+
+        SoakOpStats m_stats[SOAK_OP_MAX];
+        SoakHistogram m_expiryLag;              ///< due -> IPC_RESOLVE_APPLY, us
+        SoakJournalCounts m_journalBase;
+        SoakAuditResult m_lastAudit;
+
+        SoakClock::time_point m_start;
+        SoakClock::time_point m_lastReport;
+        double m_issued;                        ///< requests issued so far (rate clock)
+        uint64 m_saturated;                     ///< issue slots with no idle player
+        uint32 m_reconnects;
+        uint64 m_orphanResults;
+        uint64 m_botIntents;
+        uint64 m_resolves;
+        uint64 m_unlocks;
+};
+
+uint64 SoakHarness::MintUuid()
+{
+    // Same (unix time << 32 | sequence) scheme as AhMintMutationUuid.
+    return (uint64(uint32(time(NULL))) << 32) | uint64(++m_uuidSeq);
+}
+
+double SoakHarness::Elapsed() const
+{
+    return std::chrono::duration<double>(SoakClock::now() - m_start).count();
+}
+
+uint32 SoakHarness::PlayerIndex(uint32 guid) const
+{
+    return guid - m_opt.guidBase;
+}
+
+bool SoakHarness::Setup()
+{
+    QueryResult* result = m_db.World().Query(
+        "SELECT `entry` FROM `item_template` WHERE `Quality` BETWEEN 1 AND 4"
+        " AND `SellPrice` > 0");
+    if (result != NULL)
+    {
+        do
+        {
+            m_templates.push_back(result->Fetch()[0].GetUInt32());
+        }
+        while (result->NextRow());
+        delete result;
+    }
+    if (m_templates.empty())
+    {
+        fprintf(stderr, "ah-soak: item_template returned no listable items\n");
+        return false;
+    }
+
+    // mangosd is the sole auction-id allocator; the harness stands in for it.
+    result = m_db.Character().Query("SELECT MAX(`id`) FROM `auction`");
+    m_auctionBase = 1u;
+    if (result != NULL)
+    {
+        m_auctionBase = result->Fetch()[0].GetUInt32() + 1u;
+        delete result;
+    }
+    m_nextAuctionId = m_auctionBase;
+
+    result = m_db.Character().Query("SELECT MAX(`guid`) FROM `item_instance`");
+    if (result != NULL)
+    {
+        uint32 const highest = result->Fetch()[0].GetUInt32();
+        if (highest >= m_itemBase)
+        {
+            m_itemBase = highest + 1u;
+        }
+        delete result;
+    }
+    m_nextItemGuid = m_itemBase;
+
+    if (!ReadJournal(m_journalBase))
+    {
+        fprintf(stderr, "ah-soak: cannot read ah_worker_journal\n");
+        return false;
+    }
+
+    m_players.resize(m_opt.players);
+    for (uint32 i = 0; i < m_opt.players; ++i)
+    {
+        m_players[i].guid = m_opt.guidBase + i;
+    }
+
+    printf("ah-soak: %u item templates, %u players, auction ids from %u, item guids from %u\n",
+           static_cast<unsigned>(m_templates.size()), m_opt.players, m_auctionBase, m_itemBase);
+    return true;
+}
+
+/**
+ * @brief Write the item_instance row a listing needs: the object header,
+ *        owner/contained and a stack of one, everything else zero. That is
+ *        all AhItemBlob::Decode and mangosd's Item::LoadFromDB read back.
+ */
+bool SoakHarness::InsertItem(uint32 itemGuid, uint32 itemTemplate, uint32 owner)
+{
+    uint32 words[SOAK_ITEM_WORDS] = {};
+    words[0]  = itemGuid;                   // OBJECT_FIELD_GUID
+    words[1]  = 0x40000000u;                // HIGHGUID_ITEM
+    words[2]  = 0x3u;                       // TYPEMASK_OBJECT | TYPEMASK_ITEM
+    words[3]  = itemTemplate;               // OBJECT_FIELD_ENTRY
+    words[4]  = 0x3F800000u;                // OBJECT_FIELD_SCALE_X = 1.0f
+    words[6]  = owner;                      // ITEM_FIELD_OWNER
+    words[8]  = owner;                      // ITEM_FIELD_CONTAINED
+    words[14] = 1u;                         // ITEM_FIELD_STACK_COUNT
+
+    std::string data;
+    data.reserve(SOAK_ITEM_WORDS * 4u);
+    char word[16];
+    for (uint32 i = 0; i < SOAK_ITEM_WORDS; ++i)
+    {
+        snprintf(word, sizeof(word), "%u ", words[i]);
+        data += word;
+    }
+
+    return m_db.Character().DirectPExecute(
+        "INSERT INTO `item_instance` (`guid`, `owner_guid`, `data`, `text`) VALUES (%u, %u, '%s', '')",
+        itemGuid, owner, data.c_str());
+}
+
+// ---------------------------------------------------------------------------
+// Inbound
+// ---------------------------------------------------------------------------
+
+void SoakHarness::Pump()
+{
+    std::vector<IpcMessage> frames;
+    m_supervisor->DrainInbound(frames, 4096u);
+    for (size_t i = 0; i < frames.size(); ++i)
+    {
+        Handle(frames[i]);
+    }
+}
+
+void SoakHarness::Handle(IpcMessage& msg)
+{
+    switch (msg.op)
+    {
+        case IPC_PLAYER_RESULT:
+        {
+            PlayerMutationResult res;
+            if (res.Decode(msg.body))
+            {
+                OnMutationResult(res);
+            }
+            break;
+        }
+        case IPC_PLAYER_RESULT_BATCH:
+        {
+            PlayerMutationResultBatch batch;
+            if (batch.Decode(msg.body))
+            {
+                for (size_t i = 0; i < batch.results.size(); ++i)
+                {
+                    OnMutationResult(batch.results[i]);
+                }
+            }
+            break;
+        }
+        case IPC_RESOLVE_APPLY:
+        {
+            ResolveApply ra;
+            if (ra.Decode(msg.body))
+            {
+                OnResolveApply(ra);
+            }
+            break;
+        }
+        case IPC_BROWSE_RESULT:
+        {
+            BrowseResult res;
+            if (res.Decode(msg.body))
+            {
+                OnBrowseResult(res);
+            }
+            break;
+        }
+        case IPC_INTENT_SELL:
+        case IPC_INTENT_BID:
+        case IPC_INTENT_BUYOUT:
+        {
+            RejectIntent(msg);
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+void SoakHarness::OnMutationResult(PlayerMutationResult const& res)
+{
+    std::unordered_map<uint64, SoakInFlight>::iterator it = m_mutations.find(res.uuid);
+    if (it == m_mutations.end())
+    {
+        ++m_orphanResults;
+        return;
+    }
+    SoakInFlight const fl = it->second;
+    bool const ok = res.status == MUT_OK;
+
+    switch (fl.op)
+    {
+        case SOAK_POST:
+        {
+            if (ok)
+            {
+                SoakAuction a = fl.draft;
+                a.deposit = res.facts.deposit;
+                AddAuction(a);
+            }
+            else
+            {
+                DropListing(fl.player, fl.auctionId);
+            }
+            break;
+        }
+        case SOAK_BID:
+        case SOAK_BUYOUT:
+        {
+            std::unordered_map<uint32, SoakAuction>::iterator a = m_auctions.find(fl.auctionId);
+            if (ok && a != m_auctions.end())
+            {
+                if (fl.op == SOAK_BUYOUT && a->second.buyout != 0u &&
+                    fl.amount >= a->second.buyout)
+                {
+                    RemoveAuction(fl.auctionId);
+                }
+                else
+                {
+                    a->second.bidder = res.facts.curBidderGuid;
+                    a->second.bid    = res.facts.curBid;
+                }
+            }
+            break;
+        }
+        case SOAK_CANCEL:
+        {
+            if (res.status == MUT_PREPARED)
+            {
+                // What mangosd does once the seller's cut is reserved.
+                PlayerCancelDecide decide;
+                decide.uuid      = res.uuid;
+                decide.auctionId = fl.auctionId;
+                IpcMessage m;
+                m.op = IPC_PLAYER_CANCEL_CONFIRM;
+                decide.Encode(m.body);
+                if (m_supervisor->Channel().SendFrame(m))
+                {
+                    return;   // still in flight until the CONFIRM result
+                }
+            }
+            if (ok)
+            {
+                RemoveAuction(fl.auctionId);
+            }
+            else
+            {
+                std::unordered_map<uint32, SoakAuction>::iterator a =
+                    m_auctions.find(fl.auctionId);
+                if (a != m_auctions.end())
+                {
+                    a->second.cancelling = false;
+                }
+            }
+            break;
+        }
+        default:
+            break;
+    }
+
+    m_mutations.erase(it);
+    Finish(fl, ok);
+}
+
+void SoakHarness::OnResolveApply(ResolveApply const& ra)
+{
+    // What World::HandleAhInbound does after a successful apply.
+    ResolveAck ack;
+    ack.uuid   = ra.uuid;
+    ack.status = RES_APPLIED;
+    IpcMessage reply;
+    reply.op = IPC_RESOLVE_ACK;
+    ack.Encode(reply.body);
+    m_supervisor->Channel().SendFrame(reply);
+
+    ++m_resolves;
+    std::unordered_map<uint32, SoakAuction>::iterator a = m_auctions.find(ra.facts.auctionId);
+    if (a == m_auctions.end())
+    {
+        return;   // not ours (pre-existing book) or already settled
+    }
+
+    if (ra.kind == RESOLVE_CANCELLED_UNLOCK)
+    {
+        ++m_unlocks;
+        a->second.cancelling = false;
+        return;
+    }
+
+    if (ra.kind == RESOLVE_WON || ra.kind == RESOLVE_EXPIRED_NOBID)
+    {
+        int64 const lagMs = int64(std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count()) -
+            int64(a->second.expireTime) * 1000;
+        m_expiryLag.Add(lagMs > 0 ? uint64(lagMs) * 1000u : 0u);
+    }
+    RemoveAuction(ra.facts.auctionId);
+}
+
+void SoakHarness::OnBrowseResult(BrowseResult const& res)
+{
+    std::unordered_map<uint64, SoakInFlight>::iterator it = m_browses.find(res.queryId);
+    if (it == m_browses.end())
+    {
+        ++m_orphanResults;
+        return;
+    }
+    SoakInFlight const fl = it->second;
+    m_browses.erase(it);
+    Finish(fl, res.tooMany == 0u);
+}
+
+void SoakHarness::RejectIntent(IpcMessage const& msg)
+{
+    // Every intent body starts with its uint64 uuid.
+    if (msg.body.size() < sizeof(uint64))
+    {
+        return;
+    }
+    ++m_botIntents;
+    IntentResult r;
+    r.uuid      = msg.body.read<uint64>(0);
+    r.status    = INTENT_REJECTED;
+    r.reason    = REASON_BAD_ITEM;
+    r.itemGuid  = 0u;
+    r.auctionId = 0u;
+    IpcMessage reply;
+    reply.op = IPC_INTENT_RESULT;
+    r.Encode(reply.body);
+    m_supervisor->Channel().SendFrame(reply);
+}
+
+// ---------------------------------------------------------------------------
+// Outbound
+// ---------------------------------------------------------------------------
+
+void SoakHarness::IssueDue()
+{
+    double const due = m_opt.rate * Elapsed();
+    while (m_issued + 1.0 <= due)
+    {
+        uint32 player = m_opt.players;
+        for (uint32 probe = 0; probe < 16u; ++probe)
+        {
+            uint32 const p = Below(m_opt.players);
+            if (!m_players[p].busy)
+            {
+                player = p;
+                break;
+            }
+        }
+        if (player == m_opt.players)
+        {
+            // Open loop: the slot is shed, not queued, so a slow worker shows
+            // up as latency and saturation rather than an unbounded backlog.
+            ++m_saturated;
+            m_issued += 1.0;
+            continue;
+        }
+        Issue(player);
+        m_issued += 1.0;
+    }
+}
+
+bool SoakHarness::Issue(uint32 player)
+{
+    SoakPlayer& pl = m_players[player];
+
+    uint32 total = 0u;
+    for (uint32 i = 0; i < SOAK_OP_MAX; ++i)
+    {
+        total += m_opt.weights[i];
+    }
+    uint32 roll = Below(total);
+    uint32 op = SOAK_BROWSE;
+    while (op + 1u < SOAK_OP_MAX && roll >= m_opt.weights[op])
+    {
+        roll -= m_opt.weights[op];
+        ++op;
+    }
+
+    // Pick a target; an op with nothing to act on degrades to a browse.
+    SoakAuction* target = NULL;
+    if (op == SOAK_BID || op == SOAK_BUYOUT)
+    {
+        for (uint32 probe = 0; probe < 8u && target == NULL && !m_liveIds.empty(); ++probe)
+        {
+            SoakAuction& a = m_auctions[m_liveIds[Below(uint32(m_liveIds.size()))]];
+            if (a.owner != pl.guid && a.bidder != pl.guid && !a.cancelling)
+            {
+                target = &a;
+            }
+        }
+    }
+    else if (op == SOAK_CANCEL)
+    {
+        for (uint32 probe = 0; probe < 4u && target == NULL && !pl.listings.empty(); ++probe)
+        {
+            std::unordered_map<uint32, SoakAuction>::iterator a =
+                m_auctions.find(pl.listings[Below(uint32(pl.listings.size()))]);
+            if (a != m_auctions.end() && !a->second.cancelling)
+            {
+                target = &a->second;
+            }
+        }
+    }
+    if (((op == SOAK_BID || op == SOAK_BUYOUT || op == SOAK_CANCEL) && target == NULL) ||
+        (op == SOAK_POST && pl.listings.size() >= SOAK_MAX_LISTINGS))
+    {
+        op = SOAK_BROWSE;
+    }
+
+    SoakInFlight fl;
+    fl.player = player;
+    fl.op     = uint8(op);
+    fl.sent   = SoakClock::now();
+
+    IpcMessage m;
+    switch (op)
+    {
+        case SOAK_BROWSE:
+        {
+            BrowseQuery q;
+            q.queryId          = ++m_queryId;
+            q.kind             = Below(4u) == 0u ? uint8(BROWSE_OWNER) : uint8(BROWSE_LIST);
+            q.house            = uint8(Below(3u));
+            q.allHouses        = 0u;
+            q.itemClass        = 0xFFFFFFFFu;
+            q.itemSubClass     = 0xFFFFFFFFu;
+            q.inventoryType    = 0xFFFFFFFFu;
+            q.quality          = 0xFFFFFFFFu;
+            q.levelmin         = 0u;
+            q.levelmax         = 0u;
+            q.usable           = 0u;
+            q.deferEluna       = 0u;
+            q.listfrom         = Below(4u) * 50u;
+            q.localeIndex      = 0;
+            q.requesterGuidLow = pl.guid;
+            q.profile.classId  = 1u;
+            q.profile.raceId   = 1u;
+            q.profile.level    = 60u;
+            m.op = IPC_BROWSE_QUERY;
+            q.Encode(m.body);
+            return Send(m, q.queryId, fl, true);
+        }
+        case SOAK_POST:
+        {
+            SoakAuction& a = fl.draft;
+            a.id         = m_nextAuctionId++;
+            a.house      = m_opt.houses[Below(uint32(m_opt.houses.size()))];
+            a.owner      = pl.guid;
+            a.startbid   = 100u + Below(100000u);
+            a.buyout     = Below(10u) == 0u ? 0u : a.startbid * (2u + Below(3u));
+            a.deposit    = a.startbid / 20u + 1u;
+            a.expireTime = uint64(time(NULL)) + m_opt.expireMin +
+                           Below(m_opt.expireMax - m_opt.expireMin + 1u);
+
+            PlayerSellIntent s;
+            s.uuid             = MintUuid();
+            s.auctionId        = a.id;
+            s.sellerGuid       = a.owner;
+            s.house            = a.house;
+            s.itemGuid         = m_nextItemGuid++;
+            s.itemTemplate     = m_templates[Below(uint32(m_templates.size()))];
+            if (!InsertItem(s.itemGuid, s.itemTemplate, a.owner))
+            {
+                fprintf(stderr, "ah-soak: item_instance insert failed for item %u\n", s.itemGuid);
+            }
+            fl.sent = SoakClock::now();         // the row write is the harness's, not the worker's
+            s.itemCount        = 1u;
+            s.randomPropertyId = 0;
+            s.startbid         = a.startbid;
+            s.buyout           = a.buyout;
+            s.deposit          = a.deposit;
+            s.expireTime       = uint32(a.expireTime);
+            fl.auctionId = a.id;
+            pl.listings.push_back(a.id);
+            m.op = IPC_PLAYER_SELL;
+            s.Encode(m.body);
+            return Send(m, s.uuid, fl, false);
+        }
+        case SOAK_BID:
+        case SOAK_BUYOUT:
+        {
+            uint32 const outbid = (target->bid / 100u) * 5u;
+            uint32 amount = target->bid + (outbid == 0u ? 1u : outbid);
+            if (amount < target->startbid)
+            {
+                amount = target->startbid;
+            }
+            // mangosd routes a bid at/over buyout as a buyout.
+            if (target->buyout != 0u && (op == SOAK_BUYOUT || amount >= target->buyout))
+            {
+                op     = SOAK_BUYOUT;
+                amount = target->buyout;
+            }
+            fl.op        = uint8(op);
+            fl.auctionId = target->id;
+            fl.amount    = amount;
+            uint64 const uuid = MintUuid();
+            if (op == SOAK_BUYOUT)
+            {
+                PlayerBuyoutIntent b;
+                b.uuid       = uuid;
+                b.auctionId  = target->id;
+                b.bidderGuid = pl.guid;
+                b.maxPrice   = amount;
+                m.op = IPC_PLAYER_BUYOUT;
+                b.Encode(m.body);
+            }
+            else
+            {
+                PlayerBidIntent b;
+                b.uuid       = uuid;
+                b.auctionId  = target->id;
+                b.bidderGuid = pl.guid;
+                b.bidAmount  = amount;
+                m.op = IPC_PLAYER_BID;
+                b.Encode(m.body);
+            }
+            return Send(m, uuid, fl, false);
+        }
+        case SOAK_CANCEL:
+        {
+            PlayerCancelPrepare c;
+            c.uuid       = MintUuid();
+            c.auctionId  = target->id;
+            c.sellerGuid = pl.guid;
+            fl.auctionId = target->id;
+            target->cancelling = true;
+            m.op = IPC_PLAYER_CANCEL;
+            c.Encode(m.body);
+            return Send(m, c.uuid, fl, false);
+        }
+        default:
+            return false;
+    }
+}
+
+bool SoakHarness::Send(IpcMessage const& msg, uint64 key, SoakInFlight const& fl, bool browse)
+{
+    ++m_stats[fl.op].sent;
+    if (!m_supervisor->Channel().SendFrame(msg))
+    {
+        ++m_stats[fl.op].lost;
+        if (fl.op == SOAK_POST)
+        {
+            DropListing(fl.player, fl.auctionId);
+        }
+        else if (fl.op == SOAK_CANCEL)
+        {
+            m_auctions[fl.auctionId].cancelling = false;
+        }
+        return false;
+    }
+    m_players[fl.player].busy = true;
+    if (browse)
+    {
+        m_browses[key] = fl;
+    }
+    else
+    {
+        m_mutations[key] = fl;
+    }
+    return true;
+}
+
+void SoakHarness::Finish(SoakInFlight const& fl, bool ok)
+{
+    SoakOpStats& st = m_stats[fl.op];
+    if (ok)
+    {
+        ++st.ok;
+    }
+    else
+    {
+        ++st.rejected;
+    }
+    uint64 const us = uint64(std::chrono::duration_cast<std::chrono::microseconds>(
+        SoakClock::now() - fl.sent).count());
+    st.window.Add(us);
+    st.total.Add(us);
+    m_players[fl.player].busy = false;
+}
+
+void SoakHarness::ExpireInFlight()
+{
+    SoakClock::time_point const cutoff =
+        SoakClock::now() - std::chrono::seconds(m_opt.timeout);
+
+    for (std::unordered_map<uint64, SoakInFlight>::iterator it = m_browses.begin();
+         it != m_browses.end();)
+    {
+        if (it->second.sent < cutoff)
+        {
+            ++m_stats[it->second.op].lost;
+            m_players[it->second.player].busy = false;
+            it = m_browses.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+
+    for (std::unordered_map<uint64, SoakInFlight>::iterator it = m_mutations.begin();
+         it != m_mutations.end();)
+    {
+        SoakInFlight const& fl = it->second;
+        if (fl.sent >= cutoff)
+        {
+            ++it;
+            continue;
+        }
+        ++m_stats[fl.op].lost;
+        if (fl.op == SOAK_POST)
+        {
+            // The listing may or may not have committed: keep it out of the audit.
+            m_unknownIds.insert(fl.auctionId);
+            DropListing(fl.player, fl.auctionId);
+        }
+        else if (fl.op == SOAK_CANCEL || fl.op == SOAK_BID || fl.op == SOAK_BUYOUT)
+        {
+            std::unordered_map<uint32, SoakAuction>::iterator a = m_auctions.find(fl.auctionId);
+            if (a != m_auctions.end())
+            {
+                m_unknownIds.insert(fl.auctionId);
+                RemoveAuction(fl.auctionId);
+            }
+        }
+        m_players[fl.player].busy = false;
+        it = m_mutations.erase(it);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Model upkeep
+// ---------------------------------------------------------------------------
+
+void SoakHarness::AddAuction(SoakAuction const& a)
+{
+    SoakAuction& slot = m_auctions[a.id];
+    slot = a;
+    slot.liveIndex = uint32(m_liveIds.size());
+    m_liveIds.push_back(a.id);
+}
+
+void SoakHarness::RemoveAuction(uint32 id)
+{
+    std::unordered_map<uint32, SoakAuction>::iterator it = m_auctions.find(id);
+    if (it == m_auctions.end())
+    {
+        return;
+    }
+    uint32 const index = it->second.liveIndex;
+    uint32 const moved = m_liveIds.back();
+    m_liveIds[index] = moved;
+    m_auctions[moved].liveIndex = index;
+    m_liveIds.pop_back();
+
+    DropListing(PlayerIndex(it->second.owner), id);
+    m_auctions.erase(id);
+}
+
+void SoakHarness::DropListing(uint32 player, uint32 id)
+{
+    if (player >= m_players.size())
+    {
+        return;
+    }
+    std::vector<uint32>& l = m_players[player].listings;
+    for (size_t i = 0; i < l.size(); ++i)
+    {
+        if (l[i] == id)
+        {
+            l[i] = l.back();
+            l.pop_back();
+            return;
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Audit and reporting
+// ---------------------------------------------------------------------------
+
+bool SoakHarness::Quiesce(uint32 maxSec)
+{
+    SoakClock::time_point const deadline = SoakClock::now() + std::chrono::seconds(maxSec);
+    while (!m_mutations.empty() || !m_browses.empty())
+    {
+        if (SoakClock::now() > deadline)
+        {
+            return false;
+        }
+        m_supervisor->Tick(uint32(time(NULL)));
+        Pump();
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+
+SoakAuditResult SoakHarness::Audit()
+{
+    SoakAuditResult r;
+    uint64 const now   = uint64(time(NULL));
+    uint64 const stale = now > m_opt.grace ? now - m_opt.grace : 0u;
+
+    struct DbRow { uint32 bidder; uint32 bid; uint32 deposit; uint64 expireTime; };
+    std::unordered_map<uint32, DbRow> table;
+    QueryResult* result = m_db.Character().PQuery(
+        "SELECT `id`, `buyguid`, `lastbid`, `deposit`, `time` FROM `auction`"
+        " WHERE `id` >= %u", m_auctionBase);
+    if (result != NULL)
+    {
+        do
+        {
+            Field* f = result->Fetch();
+            DbRow row;
+            row.bidder     = f[1].GetUInt32();
+            row.bid        = f[2].GetUInt32();
+            row.deposit    = f[3].GetUInt32();
+            row.expireTime = f[4].GetUInt64();
+            table[f[0].GetUInt32()] = row;
+        }
+        while (result->NextRow());
+        delete result;
+    }
+
+    // Rows between due and due + grace are in resolution: neither side counts.
+    for (std::unordered_map<uint32, SoakAuction>::const_iterator it = m_auctions.begin();
+         it != m_auctions.end(); ++it)
+    {
+        SoakAuction const& a = it->second;
+        if (a.expireTime <= stale)
+        {
+            ++r.unresolved;
+            continue;
+        }
+        if (a.expireTime <= now)
+        {
+            continue;
+        }
+        r.bidDrift     -= int64(a.bid);
+        r.depositDrift -= int64(a.deposit);
+        std::unordered_map<uint32, DbRow>::const_iterator row = table.find(a.id);
+        if (row == table.end())
+        {
+            ++r.missing;
+            continue;
+        }
+        ++r.checked;
+        if (row->second.bidder != a.bidder || row->second.bid != a.bid ||
+            row->second.deposit != a.deposit)
+        {
+            ++r.changed;
+        }
+    }
+
+    for (std::unordered_map<uint32, DbRow>::const_iterator it = table.begin();
+         it != table.end(); ++it)
+    {
+        if (m_unknownIds.count(it->first) != 0u)
+        {
+            continue;
+        }
+        if (it->second.expireTime > now)
+        {
+            r.bidDrift     += int64(it->second.bid);
+            r.depositDrift += int64(it->second.deposit);
+            if (m_auctions.count(it->first) == 0u)
+            {
+                ++r.extra;
+            }
+        }
+        else if (it->second.expireTime <= stale && m_auctions.count(it->first) == 0u)
+        {
+            ++r.overdue;
+        }
+    }
+    return r;
+}
+
+bool SoakHarness::ReadJournal(SoakJournalCounts& out)
+{
+    out.assign(6, 0u);
+    // COUNT(*) always yields a row, so NULL here means the table is unusable.
+    QueryResult* result = m_db.Character().Query(
+        "SELECT COUNT(*) FROM `ah_worker_journal`");
+    if (result == NULL)
+    {
+        return false;
+    }
+    out[0] = result->Fetch()[0].GetUInt64();
+    delete result;
+
+    result = m_db.Character().Query(
+        "SELECT `state`, COUNT(*) FROM `ah_worker_journal` GROUP BY `state`");
+    if (result == NULL)
+    {
+        return true;   // empty journal
+    }
+    do
+    {
+        Field* f = result->Fetch();
+        uint32 const state = f[0].GetUInt32();
+        if (state > 0u && state < out.size())
+        {
+            out[state] = f[1].GetUInt64();
+        }
+    }
+    while (result->NextRow());
+    delete result;
+    return true;
+}
+
+void SoakHarness::PrintOp(uint32 op, SoakHistogram const& h, double secs) const
+{
+    SoakOpStats const& st = m_stats[op];
+    printf("  %-7s %9llu done %8.1f/s  p50 %8.2f  p90 %8.2f  p99 %8.2f  max %9.2f ms"
+           "  (sent %llu ok %llu rej %llu lost %llu)\n",
+           SOAK_OP_NAMES[op], static_cast<unsigned long long>(h.Count()),
+           secs > 0.0 ? double(h.Count()) / secs : 0.0,
+           h.Percentile(50.0) / 1000.0, h.Percentile(90.0) / 1000.0,
+           h.Percentile(99.0) / 1000.0, h.Max() / 1000.0,
+           static_cast<unsigned long long>(st.sent),
+           static_cast<unsigned long long>(st.ok),
+           static_cast<unsigned long long>(st.rejected),
+           static_cast<unsigned long long>(st.lost));
+}
+
+void SoakHarness::Report(bool final)
+{
+    SoakClock::time_point const now = SoakClock::now();
+    double const window = std::chrono::duration<double>(now - m_lastReport).count();
+    double const elapsed = Elapsed();
+    m_lastReport = now;
+
+    printf("%s t=%.0fs live=%u inflight=%u resolves=%llu unlocks=%llu"
+           " saturated=%llu reconnects=%u orphans=%llu bot-intents=%llu\n",
+           final ? "ah-soak summary:" : "ah-soak:", elapsed,
+           static_cast<unsigned>(m_liveIds.size()),
+           static_cast<unsigned>(m_mutations.size() + m_browses.size()),
+           static_cast<unsigned long long>(m_resolves),
+           static_cast<unsigned long long>(m_unlocks),
+           static_cast<unsigned long long>(m_saturated), m_reconnects,
+           static_cast<unsigned long long>(m_orphanResults),
+           static_cast<unsigned long long>(m_botIntents));
+
+    double const secs = final ? elapsed : window;
+    SoakHistogram all;
+    for (uint32 op = 0; op < SOAK_OP_MAX; ++op)
+    {
+        SoakHistogram const& h = final ? m_stats[op].total : m_stats[op].window;
+        PrintOp(op, h, secs);
+        all.Merge(h);
+        if (!final)
+        {
+            m_stats[op].window.Reset();
+        }
+    }
+    printf("  %-7s %9llu done %8.1f/s  p50 %8.2f  p90 %8.2f  p99 %8.2f  max %9.2f ms\n",
+           "all", static_cast<unsigned long long>(all.Count()),
+           secs > 0.0 ? double(all.Count()) / secs : 0.0,
+           all.Percentile(50.0) / 1000.0, all.Percentile(90.0) / 1000.0,
+           all.Percentile(99.0) / 1000.0, all.Max() / 1000.0);
+    printf("  expiry lag: %llu resolved, p50 %.2f s, p99 %.2f s, max %.2f s\n",
+           static_cast<unsigned long long>(m_expiryLag.Count()),
+           m_expiryLag.Percentile(50.0) / 1e6, m_expiryLag.Percentile(99.0) / 1e6,
+           m_expiryLag.Max() / 1e6);
+
+    SoakJournalCounts journal;
+    if (ReadJournal(journal))
+    {
+        printf("  journal:");
+        for (size_t i = 0; i < journal.size(); ++i)
+        {
+            printf(" %s %llu (%+lld)", SOAK_JOURNAL_NAMES[i],
+                   static_cast<unsigned long long>(journal[i]),
+                   static_cast<long long>(int64(journal[i]) - int64(m_journalBase[i])));
+        }
+        printf(" rows\n");
+    }
+
+    SoakAuditResult const& a = m_lastAudit;
+    printf("  custody: %u checked, missing %u, changed %u, extra %u, unresolved %u,"
+           " overdue %u, bid drift %lld, deposit drift %lld%s\n",
+           a.checked, a.missing, a.changed, a.extra, a.unresolved, a.overdue,
+           static_cast<long long>(a.bidDrift), static_cast<long long>(a.depositDrift),
+           a.Clean() ? "" : "  <-- DRIFT");
+    fflush(stdout);
+}
+
+// ---------------------------------------------------------------------------
+// Run
+// ---------------------------------------------------------------------------
+
+int SoakHarness::Run()
+{
+    // A fresh secret per run: the harness owns both ends of the channel.
+    std::random_device rd;
+    char secret[33];
+    for (int i = 0; i < 32; ++i)
+    {
+        secret[i] = "0123456789abcdef"[rd() & 15u];
+    }
+    secret[32] = '\0';
+
+    WorkerSupervisor supervisor("AH-soak", m_opt.worker, m_opt.port, secret,
+                                m_opt.botGuid, m_opt.config);
+    supervisor.SetWriteAuthority(true);
+    supervisor.SetSharedMemory(m_opt.shm);
+    if (!supervisor.Start())
+    {
+        fprintf(stderr, "ah-soak: could not start the worker\n");
+        return 1;
+    }
+    m_supervisor = &supervisor;
+
+    SoakClock::time_point const connectBy = SoakClock::now() + std::chrono::seconds(120);
+    while (!supervisor.Channel().Connected())
+    {
+        if (SoakClock::now() > connectBy)
+        {
+            fprintf(stderr, "ah-soak: worker did not connect within 120 s\n");
+            supervisor.Shutdown();
+            return 1;
+        }
+        supervisor.Tick(uint32(time(NULL)));
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+    printf("ah-soak: worker connected (%s); %u s at %.0f req/s\n",
+           supervisor.Channel().SharedMemoryActive() ? "shm" : "tcp",
+           m_opt.duration, m_opt.rate);
+    fflush(stdout);
+
+    m_start      = SoakClock::now();
+    m_lastReport = m_start;
+    SoakClock::time_point nextReport = m_start + std::chrono::seconds(m_opt.report);
+    SoakClock::time_point nextAudit  = m_start + std::chrono::seconds(m_opt.audit);
+    SoakClock::time_point nextExpire = m_start + std::chrono::seconds(1);
+    SoakClock::time_point const end  = m_start + std::chrono::seconds(m_opt.duration);
+    bool connected = true;
+
+    while (SoakClock::now() < end)
+    {
+        supervisor.Tick(uint32(time(NULL)));
+        bool const nowConnected = supervisor.Channel().Connected();
+        if (connected && !nowConnected)
+        {
+            ++m_reconnects;
+        }
+        connected = nowConnected;
+
+        Pump();
+        if (connected)
+        {
+            IssueDue();
+        }
+        else
+        {
+            m_issued = m_opt.rate * Elapsed();   // no catch-up burst on reconnect
+        }
+
+        SoakClock::time_point const now = SoakClock::now();
+        if (now >= nextExpire)
+        {
+            ExpireInFlight();
+            nextExpire = now + std::chrono::seconds(1);
+        }
+        if (now >= nextAudit)
+        {
+            if (Quiesce(m_opt.timeout))
+            {
+                m_lastAudit = Audit();
+            }
+            m_issued = m_opt.rate * Elapsed();  // the pause is not made up
+            nextAudit = SoakClock::now() + std::chrono::seconds(m_opt.audit);
+        }
+        if (now >= nextReport)
+        {
+            Report(false);
+            nextReport = now + std::chrono::seconds(m_opt.report);
+        }
+        std::this_thread::sleep_for(std::chrono::microseconds(500));
+    }
+
+    bool const drained = Quiesce(m_opt.timeout);
+    ExpireInFlight();
+    m_lastAudit = Audit();
+    Report(true);
+    if (!drained)
+    {
+        printf("ah-soak: in-flight requests did not drain; final audit may be noisy\n");
+    }
+
+    supervisor.Shutdown();
+    m_supervisor = NULL;
+
+    if (m_opt.cleanup)
+    {
+        m_db.Character().PExecute("DELETE FROM `auction` WHERE `id` >= %u", m_auctionBase);
+        m_db.Character().PExecute("DELETE FROM `item_instance` WHERE `guid` >= %u AND `guid` < %u",
+                                  m_itemBase, m_nextItemGuid);
+        printf("ah-soak: removed auction rows from id %u and item rows from guid %u\n",
+               m_auctionBase, m_itemBase);
+    }
+    return m_lastAudit.Clean() ? 0 : 1;
+}
+
+// ---------------------------------------------------------------------------
+// main
+// ---------------------------------------------------------------------------
+
+static bool ParseMix(const char* text, SoakOptions& opt)
+{
+    uint32 weights[SOAK_OP_MAX] = { 0, 0, 0, 0, 0 };
+    std::string s(text);
+    size_t pos = 0;
+    while (pos < s.size())
+    {
+        size_t const comma = s.find(',', pos);
+        std::string const item = s.substr(pos, comma == std::string::npos ? std::string::npos
+                                                                         : comma - pos);
+        size_t const eq = item.find('=');
+        if (eq == std::string::npos)
+        {
+            return false;
+        }
+        std::string const name = item.substr(0, eq);
+        uint32 op = 0;
+        while (op < SOAK_OP_MAX && name != SOAK_OP_NAMES[op])
+        {
+            ++op;
+        }
+        if (op == SOAK_OP_MAX)
+        {
+            return false;
+        }
+        weights[op] = uint32(strtoul(item.c_str() + eq + 1, NULL, 10));
+        if (comma == std::string::npos)
+        {
+            break;
+        }
+        pos = comma + 1;
+    }
+    uint32 total = 0;
+    for (uint32 i = 0; i < SOAK_OP_MAX; ++i)
+    {
+        total += weights[i];
+    }
+    if (total == 0u)
+    {
+        return false;
+    }
+    memcpy(opt.weights, weights, sizeof(weights));
+    return true;
+}
+
+static bool ParseHouses(const char* text, SoakOptions& opt)
+{
+    opt.houses.clear();
+    for (const char* p = text; *p != '\0';)
+    {
+        char* next = NULL;
+        unsigned long const h = strtoul(p, &next, 10);
+        if (next == p || h < 1u || h > 7u)
+        {
+            return false;
+        }
+        opt.houses.push_back(uint8(h));
+        p = (*next == ',') ? next + 1 : next;
+    }
+    return !opt.houses.empty();
+}
+
+static void PrintUsage(const char* argv0)
+{
+    fprintf(stderr,
+            "Usage: %s --worker <ah-service> --config <ah-service.conf> --botguid <guid>\n"
+            "          [--port <p>] [--players <n>] [--rate <req/s>]\n"
+            "          [--mix browse=40,post=20,bid=25,buyout=5,cancel=10]\n"
+            "          [--houses 1,6,7] [--duration <s>] [--report <s>] [--audit <s>]\n"
+            "          [--expire <min>,<max>] [--timeout <s>] [--grace <s>]\n"
+            "          [--seed <n>] [--shm] [--cleanup]\n",
+            argv0);
+}
+
+int main(int argc, char** argv)
+{
+    SoakOptions opt;
+    opt.houses.push_back(1u);
+    opt.houses.push_back(6u);
+    opt.houses.push_back(7u);
+
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string const a = argv[i];
+        bool const hasValue = i + 1 < argc;
+        if (a == "--shm")
+        {
+            opt.shm = true;
+        }
+        else if (a == "--cleanup")
+        {
+            opt.cleanup = true;
+        }
+        else if (!hasValue)
+        {
+            PrintUsage(argv[0]);
+            return 1;
+        }
+        else if (a == "--worker")   { opt.worker   = argv[++i]; }
+        else if (a == "--config")   { opt.config   = argv[++i]; }
+        else if (a == "--port")     { opt.port     = uint16(atoi(argv[++i])); }
+        else if (a == "--botguid")  { opt.botGuid  = uint32(strtoul(argv[++i], NULL, 10)); }
+        else if (a == "--players")  { opt.players  = uint32(strtoul(argv[++i], NULL, 10)); }
+        else if (a == "--rate")     { opt.rate     = atof(argv[++i]); }
+        else if (a == "--duration") { opt.duration = uint32(strtoul(argv[++i], NULL, 10)); }
+        else if (a == "--report")   { opt.report   = uint32(strtoul(argv[++i], NULL, 10)); }
+        else if (a == "--audit")    { opt.audit    = uint32(strtoul(argv[++i], NULL, 10)); }
+        else if (a == "--timeout")  { opt.timeout  = uint32(strtoul(argv[++i], NULL, 10)); }
+        else if (a == "--grace")    { opt.grace    = uint32(strtoul(argv[++i], NULL, 10)); }
+        else if (a == "--seed")     { opt.seed     = uint32(strtoul(argv[++i], NULL, 10)); }
+        else if (a == "--mix")
+        {
+            if (!ParseMix(argv[++i], opt))
+            {
+                fprintf(stderr, "ah-soak: bad --mix '%s'\n", argv[i]);
+                return 1;
+            }
+        }
+        else if (a == "--houses")
+        {
+            if (!ParseHouses(argv[++i], opt))
+            {
+                fprintf(stderr, "ah-soak: bad --houses '%s' (ids 1..7)\n", argv[i]);
+                return 1;
+            }
+        }
+        else if (a == "--expire")
+        {
+            if (sscanf(argv[++i], "%u,%u", &opt.expireMin, &opt.expireMax) != 2 ||
+                opt.expireMin == 0u || opt.expireMax < opt.expireMin)
+            {
+                fprintf(stderr, "ah-soak: bad --expire '%s'\n", argv[i]);
+                return 1;
+            }
+        }
+        else
+        {
+            PrintUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (opt.worker.empty() || opt.config.empty() || opt.botGuid == 0u ||
+        opt.players == 0u || opt.rate <= 0.0 || opt.report == 0u || opt.audit == 0u)
+    {
+        PrintUsage(argv[0]);
+        return 1;
+    }
+
+    if (!sConfig.SetSource(opt.config.c_str()))
+    {
+        fprintf(stderr, "ah-soak: could not load config '%s'\n", opt.config.c_str());
+        return 1;
+    }
+
+    ServiceDatabase db;
+    if (!db.Init() || !db.InitCharacter())
+    {
+        fprintf(stderr, "ah-soak: could not open the world/character databases\n");
+        db.Shutdown();
+        return 1;
+    }
+
+    int rc = 1;
+    {
+        SoakHarness harness(opt, db);
+        if (harness.Setup())
+        {
+            rc = harness.Run();
+        }
+    }
+    db.Shutdown();
+    return rc;
+}
@@ -34,6 +34,27 @@
 namespace proto
 {
 std::atomic<uint32> ClientConnection::s_openConnections{0};
+std::atomic<bool> ClientConnection::s_corkEnabled{false};
+std::atomic<std::size_t> ClientConnection::s_corkThreshold{16384};
+std::atomic<bool> ClientConnection::s_shapeEnabled{false};
+std::atomic<std::size_t> ClientConnection::s_shapeBacklog{65536};
+std::atomic<std::size_t> ClientConnection::s_shapeBudget{16384};
+std::atomic<uint64> ClientConnection::s_packetsSent{0};
+std::atomic<uint64> ClientConnection::s_writes{0};
+std::atomic<uint64> ClientConnection::s_bytesWritten{0};
+std::atomic<uint64> ClientConnection::s_packetsShaped{0};
+std::atomic<uint64> ClientConnection::s_packetsMerged{0};
+
+ClientConnection::SendStats ClientConnection::GetSendStats()
+{
+    SendStats stats;
+    stats.packets = s_packetsSent.load(std::memory_order_relaxed);
+    stats.writes = s_writes.load(std::memory_order_relaxed);
+    stats.bytes = s_bytesWritten.load(std::memory_order_relaxed);
+    stats.shaped = s_packetsShaped.load(std::memory_order_relaxed);
+    stats.merged = s_packetsMerged.load(std::memory_order_relaxed);
+    return stats;
+}
 
 ClientConnection::ClientConnection(IWorldGateway& gateway)
     : m_gateway(gateway), m_seed(rand32())
@@ -129,6 +150,7 @@ void ClientConnection::onClose()
             std::lock_guard<std::mutex> guard(m_sessionLock);
             session = m_session;
             m_session = INVALID_SESSION_ID;
+            m_attached.store(false);
         }
         if (session != INVALID_SESSION_ID)
         {
@@ -158,12 +180,204 @@ void ClientConnection::SendPacket(WorldPacket const& packet)
         }
 
         m_gateway.TracePacket(packet, false);
-        std::vector<uint8> const frame = PacketCodec::Encode(packet,
-            [this](uint8* header, std::size_t len)
+
+        // Header encryption is a stream cipher, so reordering has to happen on
+        // whole packets before they are encoded, never on the encoded bytes.
+        if (!m_attached.load() || !IsShaping())
+        {
+            EmitLocked(packet);
+            return;
+        }
+
+        if (IsSendBarrier(packet.GetOpcode()))
+        {
+            ReleaseHeldInOrderLocked();
+            EmitLocked(packet);
+            return;
+        }
+
+        bool const congested = CongestedLocked();
+        if (!congested && !HasHeldLocked())
+        {
+            EmitLocked(packet);
+            return;
+        }
+
+        HoldLocked(packet);
+        if (!congested)
+        {
+            ReleaseHeldLocked(0);
+        }
+    }
+    catch (...)
+    {
+        Close();
+    }
+}
+
+void ClientConnection::EmitLocked(WorldPacket const& packet)
+{
+    PacketCodec::HeaderEncryptor const encryptor =
+        [this](uint8* header, std::size_t len)
+        {
+            m_crypt.EncryptSend(header, len);
+        };
+    s_packetsSent.fetch_add(1, std::memory_order_relaxed);
+
+    if (!m_attached.load() || !IsCorking())
+    {
+        std::vector<uint8> const frame = PacketCodec::Encode(packet, encryptor);
+        Write(frame.data(), frame.size());
+        return;
+    }
+
+    PacketCodec::EncodeTo(packet, encryptor, m_staged);
+    if (m_staged.size() >= s_corkThreshold.load(std::memory_order_relaxed))
+    {
+        FlushStagedLocked();
+    }
+}
+
+bool ClientConnection::CongestedLocked() const
+{
+    uint64 const backlog = (m_flow ? m_flow->outstandingBytes() : 0) + m_staged.size();
+    return backlog >= s_shapeBacklog.load(std::memory_order_relaxed);
+}
+
+bool ClientConnection::HasHeldLocked() const
+{
+    for (std::deque<HeldPacket> const& lane : m_held)
+    {
+        if (!lane.empty())
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+void ClientConnection::HoldLocked(WorldPacket const& packet)
+{
+    s_packetsShaped.fetch_add(1, std::memory_order_relaxed);
+
+    uint16 const opcode = packet.GetOpcode();
+    SendLane const lane = ClassifySendLane(opcode);
+    uint8 const supersede = SupersedeClass(opcode);
+    uint64 guid = 0;
+
+    // Every movement-range packet leads with the unit's packed guid. Non-positional
+    // ones (speed changes, roots) are recorded too, so a later position is never
+    // folded into one queued ahead of them.
+    bool const tracked = lane == SendLane::Urgent
+        && opcode >= MSG_MOVE_START_FORWARD && opcode <= MSG_MOVE_HOVER
+        && PeekPackedGuid(packet, guid);
+
+    std::deque<HeldPacket>& urgent = m_held[std::size_t(SendLane::Urgent)];
+    if (tracked && supersede)
+    {
+        std::unordered_map<uint64, uint64>::const_iterator const last = m_lastUrgent.find(guid);
+        uint64 const base = m_urgentPushed - urgent.size();
+        if (last != m_lastUrgent.end() && last->second >= base)
+        {
+            HeldPacket& held = urgent[std::size_t(last->second - base)];
+            if (held.supersede == supersede && held.guid == guid)
             {
-                m_crypt.EncryptSend(header, len);
-            });
-        m_sender(frame.data(), frame.size());
+                held.packet = packet;
+                s_packetsMerged.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+        }
+    }
+
+    m_held[std::size_t(lane)].push_back(HeldPacket{ m_nextSeq++, guid, uint8(tracked ? supersede : 0), packet });
+    if (lane == SendLane::Urgent)
+    {
+        if (tracked)
+        {
+            m_lastUrgent[guid] = m_urgentPushed;
+        }
+        else
+        {
+            // An object update may create, move or destroy any guid; a position
+            // queued after it must not be folded into one queued before it.
+            m_lastUrgent.clear();
+        }
+        ++m_urgentPushed;
+    }
+}
+
+void ClientConnection::PopHeldLocked(SendLane lane)
+{
+    std::deque<HeldPacket>& queue = m_held[std::size_t(lane)];
+    if (lane == SendLane::Urgent)
+    {
+        uint64 const index = m_urgentPushed - queue.size();
+        std::unordered_map<uint64, uint64>::iterator const last = m_lastUrgent.find(queue.front().guid);
+        if (last != m_lastUrgent.end() && last->second == index)
+        {
+            m_lastUrgent.erase(last);
+        }
+    }
+
+    EmitLocked(queue.front().packet);
+    queue.pop_front();
+}
+
+void ClientConnection::ReleaseHeldLocked(std::size_t budget)
+{
+    std::size_t released = 0;
+    for (std::size_t lane = 0; lane < SEND_LANE_COUNT; ++lane)
+    {
+        std::deque<HeldPacket>& queue = m_held[lane];
+        while (!queue.empty() && (budget == 0 || released < budget))
+        {
+            released += SERVER_HEADER_SIZE + queue.front().packet.size();
+            PopHeldLocked(SendLane(lane));
+        }
+    }
+}
+
+void ClientConnection::ReleaseHeldInOrderLocked()
+{
+    for (;;)
+    {
+        std::size_t next = SEND_LANE_COUNT;
+        for (std::size_t lane = 0; lane < SEND_LANE_COUNT; ++lane)
+        {
+            if (!m_held[lane].empty()
+                && (next == SEND_LANE_COUNT || m_held[lane].front().seq < m_held[next].front().seq))
+            {
+                next = lane;
+            }
+        }
+
+        if (next == SEND_LANE_COUNT)
+        {
+            return;
+        }
+
+        PopHeldLocked(SendLane(next));
+    }
+}
+
+void ClientConnection::Flush()
+{
+    try
+    {
+        std::lock_guard<std::mutex> guard(m_sendOrderLock);
+        if (m_closed.load() || !m_sender)
+        {
+            return;
+        }
+
+        // A congested link gets at most one budget of held output per tick;
+        // once the transport has caught up everything held goes out.
+        if (HasHeldLocked())
+        {
+            ReleaseHeldLocked(CongestedLocked() ? s_shapeBudget.load(std::memory_order_relaxed) : 0);
+        }
+
+        FlushStagedLocked();
     }
     catch (...)
     {
@@ -178,6 +392,21 @@ void ClientConnection::Close()
         return;
     }
 
+    // Whatever was corked or held still precedes the teardown on the wire (a kick
+    // reason, a logout reply); the transport drains its queue before closing the socket.
+    try
+    {
+        std::lock_guard<std::mutex> guard(m_sendOrderLock);
+        if (m_sender)
+        {
+            ReleaseHeldInOrderLocked();
+            FlushStagedLocked();
+        }
+    }
+    catch (...)
+    {
+    }
+
     try
     {
         if (m_closer)
@@ -190,6 +419,26 @@ void ClientConnection::Close()
     }
 }
 
+void ClientConnection::FlushStagedLocked()
+{
+    if (m_staged.empty())
+    {
+        return;
+    }
+
+    // clear() keeps the capacity, so a connection stops allocating once its
+    // per-tick output has reached its steady-state size.
+    Write(m_staged.data(), m_staged.size());
+    m_staged.clear();
+}
+
+void ClientConnection::Write(uint8 const* data, std::size_t len)
+{
+    s_writes.fetch_add(1, std::memory_order_relaxed);
+    s_bytesWritten.fetch_add(len, std::memory_order_relaxed);
+    m_sender(data, len);
+}
+
 bool ClientConnection::HandlePacket(WorldPacket& packet)
 {
     if (packet.GetOpcode() == CMSG_AUTH_SESSION)
@@ -287,6 +536,7 @@ bool ClientConnection::HandleAuthSession(WorldPacket& packet)
         if (!closedDuringAttach)
         {
             m_session = session;
+            m_attached.store(true);
         }
     }
     if (closedDuringAttach)
@@ -29,12 +29,17 @@
 #include "IClientLink.h"
 #include "IWorldGateway.h"
 #include "PacketCodec.h"
+#include "SendLanes.h"
 #include "net/ISession.hpp"
 
 #include <atomic>
+#include <deque>
+#include <memory>
 #include <mutex>
 #include <string>
+#include <unordered_map>
 #include <utility>
+#include <vector>
 
 namespace proto
 {
@@ -47,12 +52,14 @@ public:
     void setPeerAddress(std::string const& address) override { m_address = address; }
     void setSender(net::Sender sender) override { m_sender = std::move(sender); }
     void setCloser(net::Closer closer) override { m_closer = std::move(closer); }
+    void setFlowControl(std::shared_ptr<net::FlowControl> flow) override { m_flow = std::move(flow); }
     std::vector<uint8_t> onConnect() override;
     std::vector<uint8_t> onData(uint8_t const* data, std::size_t len) override;
     void onClose() override;
     bool closed() const override { return m_closed.load(); }
 
     void SendPacket(WorldPacket const& packet) override;
+    void Flush() override;
     void Close() override;
     std::string const& GetRemoteAddress() const override { return m_address; }
     bool IsClosed() const override { return m_closed.load(); }
@@ -62,12 +69,71 @@ public:
         return s_openConnections.load(std::memory_order_relaxed);
     }
 
+    /// Output corking: while enabled, packets sent to an attached session are
+    /// encoded into a per-connection staging buffer instead of being handed to
+    /// the transport one by one. The buffer goes out in a single write when the
+    /// world flushes the link at tick end, or as soon as it reaches
+    /// `flushThreshold` bytes. Pre-authentication traffic is never corked.
+    static void SetCorking(bool enabled, std::size_t flushThreshold)
+    {
+        s_corkThreshold.store(flushThreshold, std::memory_order_relaxed);
+        s_corkEnabled.store(enabled, std::memory_order_relaxed);
+    }
+
+    static bool IsCorking() { return s_corkEnabled.load(std::memory_order_relaxed); }
+
+    /// Output shaping: once the transport holds `backlogBytes` unwritten bytes
+    /// for an attached session, further packets are held in per-connection
+    /// priority lanes (see SendLanes.h) instead of joining the FIFO. Each
+    /// Flush() then releases up to `tickBudget` bytes (0 - no cap), urgent lane
+    /// first, and a queued position update is replaced by a newer one for the
+    /// same unit unless an object update was queued between them. Barrier
+    /// packets release everything held, in submission order.
+    static void SetShaping(bool enabled, std::size_t backlogBytes, std::size_t tickBudget)
+    {
+        s_shapeBacklog.store(backlogBytes, std::memory_order_relaxed);
+        s_shapeBudget.store(tickBudget, std::memory_order_relaxed);
+        s_shapeEnabled.store(enabled, std::memory_order_relaxed);
+    }
+
+    static bool IsShaping() { return s_shapeEnabled.load(std::memory_order_relaxed); }
+
+    /// Process-wide output counters, for comparing corked and uncorked runs.
+    struct SendStats
+    {
+        uint64 packets = 0;     ///< packets encoded for the wire
+        uint64 writes = 0;      ///< buffers handed to the transport
+        uint64 bytes = 0;       ///< bytes handed to the transport
+        uint64 shaped = 0;      ///< packets held in a priority lane
+        uint64 merged = 0;      ///< held position updates replaced by a newer one
+    };
+
+    static SendStats GetSendStats();
+
 private:
     bool HandlePacket(WorldPacket& packet);
     bool HandleAuthSession(WorldPacket& packet);
     SessionId CurrentSession();
     void SendAuthResponse(AuthStatus status);
     std::vector<uint8> EncodePacket(WorldPacket const& packet);
+    void EmitLocked(WorldPacket const& packet);
+    void FlushStagedLocked();
+    void Write(uint8 const* data, std::size_t len);
+
+    bool CongestedLocked() const;
+    bool HasHeldLocked() const;
+    void HoldLocked(WorldPacket const& packet);
+    void ReleaseHeldLocked(std::size_t budget);
+    void ReleaseHeldInOrderLocked();
+    void PopHeldLocked(SendLane lane);
+
+    struct HeldPacket
+    {
+        uint64 seq;             ///< submission order across all lanes
+        uint64 guid;
+        uint8 supersede;        ///< SupersedeClass() of the opcode, 0 if never replaced
+        WorldPacket packet;
+    };
 
     IWorldGateway& m_gateway;
     std::string m_address;
@@ -78,11 +144,28 @@ private:
     uint32 m_seed;
     SessionId m_session = INVALID_SESSION_ID;
     bool m_authStarted = false;
+    std::atomic<bool> m_attached{false};
     std::atomic<bool> m_closed{false};
+    std::vector<uint8> m_staged;            ///< corked output, guarded by m_sendOrderLock
+    std::deque<HeldPacket> m_held[SEND_LANE_COUNT];     ///< shaped output, guarded by m_sendOrderLock
+    std::unordered_map<uint64, uint64> m_lastUrgent;    ///< guid -> urgent index of its newest held movement
+    uint64 m_nextSeq = 0;
+    uint64 m_urgentPushed = 0;              ///< urgent index the next held urgent packet gets
+    std::shared_ptr<net::FlowControl> m_flow;
     net::Sender m_sender;
     net::Closer m_closer;
 
     static std::atomic<uint32> s_openConnections;
+    static std::atomic<bool> s_corkEnabled;
+    static std::atomic<std::size_t> s_corkThreshold;
+    static std::atomic<bool> s_shapeEnabled;
+    static std::atomic<std::size_t> s_shapeBacklog;
+    static std::atomic<std::size_t> s_shapeBudget;
+    static std::atomic<uint64> s_packetsSent;
+    static std::atomic<uint64> s_writes;
+    static std::atomic<uint64> s_bytesWritten;
+    static std::atomic<uint64> s_packetsShaped;
+    static std::atomic<uint64> s_packetsMerged;
 };
 }
 
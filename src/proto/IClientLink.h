@@ -36,6 +36,9 @@ class IClientLink
 public:
     virtual ~IClientLink() = default;
     virtual void SendPacket(WorldPacket const& packet) = 0;
+    // Pushes any output staged by a corked link to the transport. The world calls
+    // this once per tick; links that write through immediately need not override it.
+    virtual void Flush() {}
     virtual void Close() = 0;
     virtual std::string const& GetRemoteAddress() const = 0;
     virtual bool IsClosed() const = 0;
@@ -29,8 +29,9 @@
 
 namespace proto
 {
-PacketCodec::PacketCodec(HeaderDecryptor decryptor)
-    : m_decryptor(std::move(decryptor))
+PacketCodec::PacketCodec(HeaderDecryptor decryptor, CodecRole role)
+    : m_decryptor(std::move(decryptor)),
+      m_role(role)
 {
 }
 
@@ -76,40 +77,57 @@ DecodeStatus PacketCodec::FeedOne(uint8 const* data, std::size_t len,
         return DecodeStatus::Malformed;
     }
 
+    std::size_t const headerSize = m_role == CodecRole::Server
+        ? CLIENT_HEADER_SIZE : SERVER_HEADER_SIZE;
+
     while (consumed < len)
     {
         if (!m_haveHeader)
         {
-            std::size_t const wanted = CLIENT_HEADER_SIZE - m_headerFill;
+            std::size_t const wanted = headerSize - m_headerFill;
             std::size_t const taken = std::min(wanted, len - consumed);
             std::memcpy(m_header + m_headerFill, data + consumed, taken);
             m_headerFill += taken;
             consumed += taken;
 
-            if (m_headerFill < CLIENT_HEADER_SIZE)
+            if (m_headerFill < headerSize)
             {
                 return DecodeStatus::NeedMore;
             }
 
             if (m_decryptor)
             {
-                m_decryptor(m_header, CLIENT_HEADER_SIZE);
+                m_decryptor(m_header, headerSize);
             }
 
             uint32 const wireSize = (uint32(m_header[0]) << 8) | uint32(m_header[1]);
-            uint32 const opcode = uint32(m_header[2])
-                | (uint32(m_header[3]) << 8)
-                | (uint32(m_header[4]) << 16)
-                | (uint32(m_header[5]) << 24);
-
-            if (wireSize < 4 || wireSize > MAX_CLIENT_PACKET_SIZE
-                || opcode > MAX_CLIENT_PACKET_SIZE)
+            if (m_role == CodecRole::Server)
             {
-                return DecodeStatus::Malformed;
+                uint32 const opcode = uint32(m_header[2])
+                    | (uint32(m_header[3]) << 8)
+                    | (uint32(m_header[4]) << 16)
+                    | (uint32(m_header[5]) << 24);
+
+                if (wireSize < 4 || wireSize > MAX_CLIENT_PACKET_SIZE
+                    || opcode > MAX_CLIENT_PACKET_SIZE)
+                {
+                    return DecodeStatus::Malformed;
+                }
+
+                m_opcode = uint16(opcode);
+                m_payloadNeeded = wireSize - 4;
+            }
+            else
+            {
+                if (wireSize < 2)
+                {
+                    return DecodeStatus::Malformed;
+                }
+
+                m_opcode = uint16(uint32(m_header[2]) | (uint32(m_header[3]) << 8));
+                m_payloadNeeded = wireSize - 2;
             }
 
-            m_opcode = uint16(opcode);
-            m_payloadNeeded = wireSize - 4;
             m_haveHeader = true;
             m_payload.clear();
             m_payload.reserve(m_payloadNeeded);
@@ -147,6 +165,15 @@ DecodeStatus PacketCodec::FeedOne(uint8 const* data, std::size_t len,
 
 std::vector<uint8> PacketCodec::Encode(WorldPacket const& packet,
     HeaderEncryptor const& encryptor)
+{
+    std::vector<uint8> wire;
+    wire.reserve(SERVER_HEADER_SIZE + packet.size());
+    EncodeTo(packet, encryptor, wire);
+    return wire;
+}
+
+void PacketCodec::EncodeTo(WorldPacket const& packet,
+    HeaderEncryptor const& encryptor, std::vector<uint8>& wire)
 {
     uint16 const wireSize = uint16(packet.size() + 2);
     uint16 const opcode = packet.GetOpcode();
@@ -160,13 +187,32 @@ std::vector<uint8> PacketCodec::Encode(WorldPacket const& packet,
         encryptor(header, SERVER_HEADER_SIZE);
     }
 
-    std::vector<uint8> wire;
-    wire.reserve(SERVER_HEADER_SIZE + packet.size());
     wire.insert(wire.end(), header, header + SERVER_HEADER_SIZE);
     if (!packet.empty())
     {
         wire.insert(wire.end(), packet.contents(), packet.contents() + packet.size());
     }
-    return wire;
+}
+
+void PacketCodec::EncodeClientTo(WorldPacket const& packet,
+    HeaderEncryptor const& encryptor, std::vector<uint8>& wire)
+{
+    uint16 const wireSize = uint16(packet.size() + 4);
+    uint32 const opcode = packet.GetOpcode();
+    uint8 header[CLIENT_HEADER_SIZE] = {
+        uint8(wireSize >> 8), uint8(wireSize),
+        uint8(opcode), uint8(opcode >> 8), uint8(opcode >> 16), uint8(opcode >> 24)
+    };
+
+    if (encryptor)
+    {
+        encryptor(header, CLIENT_HEADER_SIZE);
+    }
+
+    wire.insert(wire.end(), header, header + CLIENT_HEADER_SIZE);
+    if (!packet.empty())
+    {
+        wire.insert(wire.end(), packet.contents(), packet.contents() + packet.size());
+    }
 }
 }
@@ -46,19 +46,36 @@ enum class DecodeStatus
     Malformed
 };
 
+// Which end of the connection the codec sits on. The server decodes 6-byte client
+// headers; a client (the load generator) decodes the 4-byte server headers.
+enum class CodecRole
+{
+    Server,
+    Client
+};
+
 class PacketCodec
 {
 public:
     using HeaderDecryptor = std::function<void(uint8*, std::size_t)>;
     using HeaderEncryptor = std::function<void(uint8*, std::size_t)>;
 
-    explicit PacketCodec(HeaderDecryptor decryptor = {});
+    explicit PacketCodec(HeaderDecryptor decryptor = {},
+        CodecRole role = CodecRole::Server);
     DecodeStatus Feed(uint8 const* data, std::size_t len,
         std::vector<WorldPacket>& out);
     DecodeStatus FeedOne(uint8 const* data, std::size_t len,
         std::size_t& consumed, std::vector<WorldPacket>& out);
     static std::vector<uint8> Encode(WorldPacket const& packet,
         HeaderEncryptor const& encryptor = {});
+    // Appends one server frame to `wire` without disturbing what is already there,
+    // so several packets can be staged into a single buffer and written at once.
+    static void EncodeTo(WorldPacket const& packet,
+        HeaderEncryptor const& encryptor, std::vector<uint8>& wire);
+    // Client-side counterpart of EncodeTo: appends one frame with the 6-byte
+    // client header, as a real 1.12 client would put it on the wire.
+    static void EncodeClientTo(WorldPacket const& packet,
+        HeaderEncryptor const& encryptor, std::vector<uint8>& wire);
 
     void SetHeaderDecryptor(HeaderDecryptor decryptor)
     {
@@ -67,6 +84,7 @@ public:
 
 private:
     HeaderDecryptor m_decryptor;
+    CodecRole m_role;
     uint8 m_header[CLIENT_HEADER_SIZE]{};
     std::size_t m_headerFill = 0;
     bool m_haveHeader = false;
@@ -0,0 +1,156 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2025 MaNGOS <https://www.getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+#include "SendLanes.h"
+
+#include "Opcodes.h"
+
+namespace proto
+{
+SendLane ClassifySendLane(uint16 opcode)
+{
+    if (opcode >= MSG_MOVE_START_FORWARD && opcode <= MSG_MOVE_HOVER)
+    {
+        return SendLane::Urgent;
+    }
+
+    switch (opcode)
+    {
+        case SMSG_PONG:
+        case SMSG_AUTH_RESPONSE:
+        case SMSG_LOGOUT_RESPONSE:
+        case SMSG_FORCE_WALK_SPEED_CHANGE:
+        case SMSG_FORCE_SWIM_BACK_SPEED_CHANGE:
+        case SMSG_FORCE_TURN_RATE_CHANGE:
+            return SendLane::Urgent;
+
+        // Object creates, value updates and destroys stay in order with the
+        // movement that refers to them: the client drops movement for a guid
+        // it has not been introduced to, and combat and chat read the values.
+        case SMSG_UPDATE_OBJECT:
+        case SMSG_COMPRESSED_UPDATE_OBJECT:
+        case SMSG_DESTROY_OBJECT:
+            return SendLane::Urgent;
+
+        case SMSG_NAME_QUERY_RESPONSE:
+        case SMSG_ITEM_QUERY_SINGLE_RESPONSE:
+        case SMSG_ITEM_NAME_QUERY_RESPONSE:
+        case SMSG_ITEM_TEXT_QUERY_RESPONSE:
+        case SMSG_PAGE_TEXT_QUERY_RESPONSE:
+        case SMSG_QUEST_QUERY_RESPONSE:
+        case SMSG_GAMEOBJECT_QUERY_RESPONSE:
+        case SMSG_CREATURE_QUERY_RESPONSE:
+        case SMSG_GUILD_QUERY_RESPONSE:
+        case SMSG_PETITION_QUERY_RESPONSE:
+        case SMSG_NPC_TEXT_UPDATE:
+        case SMSG_GUILD_ROSTER:
+        case SMSG_WHO:
+        case SMSG_FRIEND_LIST:
+        case SMSG_MAIL_LIST_RESULT:
+        case SMSG_LIST_INVENTORY:
+        case SMSG_AUCTION_LIST_RESULT:
+        case SMSG_AUCTION_OWNER_LIST_RESULT:
+        case SMSG_AUCTION_BIDDER_LIST_RESULT:
+        case SMSG_BATTLEFIELD_LIST:
+        case SMSG_INITIAL_SPELLS:
+        case SMSG_ACTION_BUTTONS:
+            return SendLane::Bulk;
+
+        default:
+            return SendLane::Normal;
+    }
+}
+
+bool IsSendBarrier(uint16 opcode)
+{
+    switch (opcode)
+    {
+        case SMSG_CHAR_ENUM:
+        case SMSG_TRANSFER_PENDING:
+        case SMSG_TRANSFER_ABORTED:
+        case SMSG_NEW_WORLD:
+        case SMSG_LOGIN_VERIFY_WORLD:
+        case SMSG_LOGOUT_COMPLETE:
+        case MSG_MOVE_TELEPORT_ACK:
+            return true;
+        default:
+            return false;
+    }
+}
+
+uint8 SupersedeClass(uint16 opcode)
+{
+    switch (opcode)
+    {
+        case MSG_MOVE_START_FORWARD:
+        case MSG_MOVE_START_BACKWARD:
+        case MSG_MOVE_STOP:
+        case MSG_MOVE_START_STRAFE_LEFT:
+        case MSG_MOVE_START_STRAFE_RIGHT:
+        case MSG_MOVE_STOP_STRAFE:
+        case MSG_MOVE_START_TURN_LEFT:
+        case MSG_MOVE_START_TURN_RIGHT:
+        case MSG_MOVE_STOP_TURN:
+        case MSG_MOVE_START_PITCH_UP:
+        case MSG_MOVE_START_PITCH_DOWN:
+        case MSG_MOVE_STOP_PITCH:
+        case MSG_MOVE_FALL_LAND:
+        case MSG_MOVE_START_SWIM:
+        case MSG_MOVE_STOP_SWIM:
+        case MSG_MOVE_SET_FACING:
+        case MSG_MOVE_SET_PITCH:
+        case MSG_MOVE_HEARTBEAT:
+            return 1;                                       // relayed player movement: guid + MovementInfo
+        case SMSG_MONSTER_MOVE:
+            return 2;                                       // spline from the unit's current position
+        default:
+            return 0;
+    }
+}
+
+bool PeekPackedGuid(WorldPacket const& packet, uint64& guid)
+{
+    if (packet.size() < 1)
+    {
+        return false;
+    }
+
+    uint8 const* data = packet.contents();
+    uint8 const mask = data[0];
+    std::size_t pos = 1;
+    guid = 0;
+    for (uint8 i = 0; i < 8; ++i)
+    {
+        if (mask & (1 << i))
+        {
+            if (pos >= packet.size())
+            {
+                return false;
+            }
+            guid |= uint64(data[pos++]) << (i * 8);
+        }
+    }
+    return true;
+}
+}
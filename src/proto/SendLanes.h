@@ -0,0 +1,60 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2025 MaNGOS <https://www.getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+#ifndef MANGOS_PROTO_SENDLANES_H
+#define MANGOS_PROTO_SENDLANES_H
+
+#include "Platform/Define.h"
+#include "Utilities/WorldPacket.h"
+
+#include <cstddef>
+
+namespace proto
+{
+// Priority classes a congested link sorts its outbound packets into (see
+// ClientConnection::SetShaping). Lower lanes go out first.
+enum class SendLane : uint8
+{
+    Urgent = 0,     // movement, object updates and link control
+    Normal = 1,     // combat, chat and anything unclassified
+    Bulk   = 2      // query responses, list results
+};
+
+constexpr std::size_t SEND_LANE_COUNT = 3;
+
+SendLane ClassifySendLane(uint16 opcode);
+
+// World transitions and login/logout replies: everything queued before one of
+// these is written, in submission order, before it.
+bool IsSendBarrier(uint16 opcode);
+
+// Non-zero for packets that carry a unit's complete position: a newer packet of
+// the same class for the same guid makes an older, still queued one redundant.
+uint8 SupersedeClass(uint16 opcode);
+
+// Reads the packed guid that leads movement packets. False when truncated.
+bool PeekPackedGuid(WorldPacket const& packet, uint64& guid);
+}
+
+#endif
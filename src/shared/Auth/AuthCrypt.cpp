@@ -36,6 +36,17 @@ const static size_t CRYPTED_RECV_LEN = 6;
 AuthCrypt::AuthCrypt()
 {
     _initialized = false;
+    _sendLen = CRYPTED_SEND_LEN;
+    _recvLen = CRYPTED_RECV_LEN;
+}
+
+/**
+ * Swaps the per-direction header lengths for use on the client end.
+ */
+void AuthCrypt::SetClientSide()
+{
+    _sendLen = CRYPTED_RECV_LEN;
+    _recvLen = CRYPTED_SEND_LEN;
 }
 
 /**
@@ -47,12 +58,12 @@ void AuthCrypt::DecryptRecv(uint8* data, size_t len)
     {
         return;
     }
-    if (len < CRYPTED_RECV_LEN)
+    if (len < _recvLen)
     {
         return;
     }
 
-    for (size_t t = 0; t < CRYPTED_RECV_LEN; t++)
+    for (size_t t = 0; t < _recvLen; t++)
     {
         _recv_i %= _key.size();
         uint8 x = (data[t] - _recv_j) ^ _key[_recv_i];
@@ -72,12 +83,12 @@ void AuthCrypt::EncryptSend(uint8* data, size_t len)
         return;
     }
 
-    if (len < CRYPTED_SEND_LEN)
+    if (len < _sendLen)
     {
         return;
     }
 
-    for (size_t t = 0; t < CRYPTED_SEND_LEN; t++)
+    for (size_t t = 0; t < _sendLen; t++)
     {
         _send_i %= _key.size();
         uint8 x = (data[t] ^ _key[_send_i]) + _send_j;
@@ -83,6 +83,15 @@ class AuthCrypt
          */
         void EncryptSend(uint8*, size_t);
 
+        /**
+         * @brief Drive the client end of the stream instead of the server end
+         *
+         * Swaps the header lengths so that EncryptSend covers the 6-byte client
+         * header and DecryptRecv the 4-byte server header. Only the headless
+         * load generator needs this; the server never calls it.
+         */
+        void SetClientSide();
+
         /**
          * @brief Check if the crypt object is initialized
          * @return True if initialized, false otherwise
@@ -95,6 +104,7 @@ class AuthCrypt
     private:
         std::vector<uint8> _key; /**< Session key for encryption */
         uint8 _send_i, _send_j, _recv_i, _recv_j; /**< ARC4 state variables for send/recv */
+        size_t _sendLen, _recvLen; /**< Encrypted header length per direction */
         bool _initialized; /**< Initialization status */
 };
 #endif
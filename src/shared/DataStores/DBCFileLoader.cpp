@@ -28,67 +28,179 @@
 
 #include "DBCFileLoader.h"
 
-DBCFileLoader::DBCFileLoader()
+#ifdef WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+DBCFileMapping::DBCFileMapping() : m_data(NULL), m_size(0), m_mapped(false)
+#ifdef WIN32
+    , m_mapping(NULL)
+#endif
 {
-    data = NULL;
-    fieldsOffset = NULL;
 }
 
-bool DBCFileLoader::Load(const char* filename, const char* fmt)
+DBCFileMapping::~DBCFileMapping()
 {
-    uint32 header;
-    delete[] data;
+    if (!m_mapped)
+    {
+        delete[] m_data;
+        return;
+    }
+
+#ifdef WIN32
+    UnmapViewOfFile(m_data);
+    CloseHandle(m_mapping);
+#else
+    munmap(m_data, m_size);
+#endif
+}
 
-    FILE* f = fopen(filename, "rb");
-    if (!f)
+bool DBCFileMapping::Open(const char* filename)
+{
+#ifdef WIN32
+    HANDLE f = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (f == INVALID_HANDLE_VALUE)
     {
         return false;
     }
 
-    if (fread(&header, 4, 1, f) != 1)                       // Number of records
+    LARGE_INTEGER size;
+    if (GetFileSizeEx(f, &size) && size.QuadPart > 0)
+    {
+        m_mapping = CreateFileMappingA(f, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (m_mapping)
+        {
+            m_data = (unsigned char*)MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0);
+            if (!m_data)
+            {
+                CloseHandle(m_mapping);
+                m_mapping = NULL;
+            }
+        }
+        m_size = size_t(size.QuadPart);
+    }
+    CloseHandle(f);                                         // the mapping keeps the file open
+
+    if (m_data)
+    {
+        m_mapped = true;
+        return true;
+    }
+#else
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0)
     {
-        fclose(f);
         return false;
     }
 
-    EndianConvert(header);
-    if (header != 0x43424457)                               //'WDBC'
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size > 0)
+    {
+        m_size = size_t(st.st_size);
+        void* mapped = mmap(NULL, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped != MAP_FAILED)
+        {
+            m_data = (unsigned char*)mapped;
+        }
+    }
+    close(fd);                                              // the mapping keeps the file open
+
+    if (m_data)
+    {
+        m_mapped = true;
+        return true;
+    }
+#endif
+
+    if (!m_size)
     {
-        fclose(f);
         return false;
     }
 
-    if (fread(&recordCount, 4, 1, f) != 1)                  // Number of records
+    // could not map it: read it into a buffer instead
+    FILE* in = fopen(filename, "rb");
+    if (!in)
     {
-        fclose(f);
         return false;
     }
 
-    EndianConvert(recordCount);
+    m_data = new unsigned char[m_size];
+    bool const read = fread(m_data, m_size, 1, in) == 1;
+    fclose(in);
+    return read;
+}
 
-    if (fread(&fieldCount, 4, 1, f) != 1)                   // Number of fields
+void DBCFileMapping::Discard(size_t length)
+{
+#ifndef WIN32
+    if (!m_mapped)
     {
-        fclose(f);
-        return false;
+        return;
     }
 
-    EndianConvert(fieldCount);
+    // whole pages only: the tail of the last one may already hold strings
+    size_t const page = size_t(sysconf(_SC_PAGESIZE));
+    length -= length % page;
+    if (length)
+    {
+        madvise(m_data, length, MADV_DONTNEED);
+    }
+#else
+    (void)length;                                           // views are trimmed by the working set manager there
+#endif
+}
+
+DBCFileLoader::DBCFileLoader()
+{
+    file = NULL;
+    data = NULL;
+    stringTable = NULL;
+    fieldsOffset = NULL;
+}
 
-    if (fread(&recordSize, 4, 1, f) != 1)                   // Size of a record
+bool DBCFileLoader::Load(const char* filename, const char* fmt)
+{
+    delete file;
+    file = NULL;
+    data = NULL;
+    delete[] fieldsOffset;
+    fieldsOffset = NULL;
+
+    DBCFileMapping* mapping = new DBCFileMapping();
+    if (!mapping->Open(filename) || mapping->GetSize() < 5 * 4)
     {
-        fclose(f);
+        delete mapping;
         return false;
     }
 
-    EndianConvert(recordSize);
+    uint32 header[5];                                       // 'WDBC', records, fields, record size, string size
+    memcpy(header, mapping->GetData(), sizeof(header));
+    for (uint32 i = 0; i < 5; ++i)
+    {
+        EndianConvert(header[i]);
+    }
 
-    if (fread(&stringSize, 4, 1, f) != 1)                   // String size
+    if (header[0] != 0x43424457)                            //'WDBC'
     {
-        fclose(f);
+        delete mapping;
         return false;
     }
 
-    EndianConvert(stringSize);
+    recordCount = header[1];
+    fieldCount = header[2];
+    recordSize = header[3];
+    stringSize = header[4];
+
+    if (uint64(sizeof(header)) + uint64(recordSize) * recordCount + stringSize > mapping->GetSize())
+    {
+        delete mapping;                                     // truncated file
+        return false;
+    }
 
     fieldsOffset = new uint32[fieldCount];
     fieldsOffset[0] = 0;
@@ -105,25 +217,33 @@ bool DBCFileLoader::Load(const char* filename, const char* fmt)
         }
     }
 
-    data = new unsigned char[recordSize * recordCount + stringSize];
+    file = mapping;
+    data = mapping->GetData() + sizeof(header);
     stringTable = data + recordSize * recordCount;
-
-    if (fread(data, recordSize * recordCount + stringSize, 1, f) != 1)
-    {
-        fclose(f);
-        return false;
-    }
-
-    fclose(f);
     return true;
 }
 
 DBCFileLoader::~DBCFileLoader()
 {
-    delete[] data;
+    delete file;
     delete[] fieldsOffset;
 }
 
+DBCFileMapping* DBCFileLoader::DetachMapping()
+{
+    DBCFileMapping* mapping = file;
+    if (mapping)
+    {
+        // the records were copied into the data table; only the strings are still read
+        mapping->Discard(size_t(stringTable - mapping->GetData()));
+    }
+
+    file = NULL;
+    data = NULL;
+    stringTable = NULL;
+    return mapping;
+}
+
 DBCFileLoader::Record DBCFileLoader::getRecord(size_t id)
 {
     assert(data);
@@ -277,16 +397,13 @@ char* DBCFileLoader::AutoProduceData(const char* format, uint32& records, char**
     return dataTable;
 }
 
-char* DBCFileLoader::AutoProduceStrings(const char* format, char* dataTable)
+bool DBCFileLoader::AutoProduceStrings(const char* format, char* dataTable)
 {
     if (strlen(format) != fieldCount)
     {
-        return NULL;
+        return false;
     }
 
-    char* stringPool = new char[stringSize];
-    memcpy(stringPool, stringTable, stringSize);
-
     uint32 offset = 0;
 
     for (uint32 y = 0; y < recordCount; ++y)
@@ -311,8 +428,8 @@ char* DBCFileLoader::AutoProduceStrings(const char* format, char* dataTable)
                     char** slot = (char**)(&dataTable[offset]);
                     if (!*slot || !** slot)
                     {
-                        const char* st = getRecord(y).getString(x);
-                        *slot = stringPool + (st - (const char*)stringTable);
+                        // in place: the store keeps the mapping (see DetachMapping)
+                        *slot = const_cast<char*>(getRecord(y).getString(x));
                     }
                     offset += sizeof(char*);
                     break;
@@ -331,5 +448,5 @@ char* DBCFileLoader::AutoProduceStrings(const char* format, char* dataTable)
         }
     }
 
-    return stringPool;
+    return true;
 }
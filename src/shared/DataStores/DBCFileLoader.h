@@ -50,6 +50,54 @@ enum FieldFormat
     DBC_FF_LOGIC = 'l'                                          // Logical (boolean)
 };
 
+/**
+ * @brief A DBC file mapped read-only into memory
+ *
+ * Where the platform cannot map the file it is read into a buffer instead,
+ * so callers see the same bytes either way. The string blocks of the loaded
+ * stores point straight into it, so DBCStorage keeps it alive.
+ */
+class DBCFileMapping
+{
+    public:
+        DBCFileMapping();
+
+        /**
+         * @brief Destructor - unmaps or frees the file
+         */
+        ~DBCFileMapping();
+
+        /**
+         * @brief Map a file
+         * @param filename Path to the file
+         * @return True on success, false if it is missing, empty or cannot be read
+         */
+        bool Open(const char* filename);
+
+        /**
+         * @brief Give the pages of the first @p length bytes back to the OS
+         *
+         * For the record block once it has been copied into the store: the
+         * bytes stay readable, they are just no longer resident.
+         * @param length Bytes from the start of the file
+         */
+        void Discard(size_t length);
+
+        unsigned char const* GetData() const { return m_data; }
+        size_t GetSize() const { return m_size; }
+
+    private:
+        DBCFileMapping(DBCFileMapping const&);
+        DBCFileMapping& operator=(DBCFileMapping const&);
+
+        unsigned char* m_data; /**< File contents */
+        size_t m_size; /**< File size in bytes */
+        bool m_mapped; /**< Mapped, rather than read into a buffer */
+#ifdef WIN32
+        void* m_mapping; /**< File mapping object handle */
+#endif
+};
+
 /**
  * @brief DBC (Database Client) file loader
  *
@@ -71,7 +119,7 @@ class DBCFileLoader
         ~DBCFileLoader();
 
         /**
-         * @brief Load a DBC file from disk
+         * @brief Map a DBC file from disk
          * @param filename Path to the DBC file
          * @param fmt Format string describing field types
          * @return True on success, false on failure
@@ -95,7 +143,7 @@ class DBCFileLoader
                 float getFloat(size_t field) const
                 {
                     assert(field < file.fieldCount);
-                    float val = *reinterpret_cast<float*>(offset + file.GetOffset(field));
+                    float val = *reinterpret_cast<const float*>(offset + file.GetOffset(field));
                     EndianConvert(val);
                     return val;
                 }
@@ -108,7 +156,7 @@ class DBCFileLoader
                 uint32 getUInt(size_t field) const
                 {
                     assert(field < file.fieldCount);
-                    uint32 val = *reinterpret_cast<uint32*>(offset + file.GetOffset(field));
+                    uint32 val = *reinterpret_cast<const uint32*>(offset + file.GetOffset(field));
                     EndianConvert(val);
                     return val;
                 }
@@ -121,7 +169,7 @@ class DBCFileLoader
                 uint8 getUInt8(size_t field) const
                 {
                     assert(field < file.fieldCount);
-                    return *reinterpret_cast<uint8*>(offset + file.GetOffset(field));
+                    return *reinterpret_cast<const uint8*>(offset + file.GetOffset(field));
                 }
 
                 /**
@@ -134,7 +182,7 @@ class DBCFileLoader
                     assert(field < file.fieldCount);
                     size_t stringOffset = getUInt(field);
                     assert(stringOffset < file.stringSize);
-                    return reinterpret_cast<char*>(file.stringTable + stringOffset);
+                    return reinterpret_cast<const char*>(file.stringTable + stringOffset);
                 }
 
             private:
@@ -143,8 +191,8 @@ class DBCFileLoader
                  * @param file_ Parent DBCFileLoader reference
                  * @param offset_ Offset to record data
                  */
-                Record(DBCFileLoader& file_, unsigned char* offset_): offset(offset_), file(file_) {}
-                unsigned char* offset; /**< Offset to record data */
+                Record(DBCFileLoader& file_, unsigned char const* offset_): offset(offset_), file(file_) {}
+                unsigned char const* offset; /**< Offset to record data */
                 DBCFileLoader& file; /**< Parent DBCFileLoader reference */
 
                 friend class DBCFileLoader;
@@ -192,12 +240,22 @@ class DBCFileLoader
         char* AutoProduceData(const char* fmt, uint32& count, char**& indexTable);
 
         /**
-         * @brief Automatically produce string table from DBC file
+         * @brief Point the still empty string fields of a data table at this file's strings
+         *
+         * The strings are not copied: they stay in the mapped file, which the
+         * caller takes over with DetachMapping() to keep them valid.
          * @param fmt Format string for conversion
-         * @param dataTable Data table to reference
-         * @return Allocated string table
+         * @param dataTable Data table to fill
+         * @return False if the format does not match the file
+         */
+        bool AutoProduceStrings(const char* fmt, char* dataTable);
+
+        /**
+         * @brief Hand the mapped file over to the caller, and with it the strings
+         *        AutoProduceStrings() pointed at. Its record pages are discarded.
+         * @return The mapping, to delete once the strings are no longer used
          */
-        char* AutoProduceStrings(const char* fmt, char* dataTable);
+        DBCFileMapping* DetachMapping();
 
         /**
          * Calculate and return the total amount of memory required by the types specified within the format string
@@ -214,7 +272,8 @@ class DBCFileLoader
         uint32 fieldCount; /**< Number of fields per record */
         uint32 stringSize; /**< Size of string table in bytes */
         uint32* fieldsOffset; /**< Array of field offsets */
-        unsigned char* data; /**< Raw record data */
-        unsigned char* stringTable; /**< String table data */
+        DBCFileMapping* file; /**< The mapped file */
+        unsigned char const* data; /**< Raw record data, in the mapped file */
+        unsigned char const* stringTable; /**< String table data, in the mapped file */
 };
 #endif
@@ -40,7 +40,7 @@ class DBCStorage
      * @brief
      *
      */
-    typedef std::list<char*> StringPoolList;
+    typedef std::list<DBCFileMapping*> FileList;
 
     public:
         /**
@@ -48,7 +48,7 @@ class DBCStorage
          *
          * @param f
          */
-        explicit DBCStorage(const char* f) : nCount(0), fieldCount(0), fmt(f), indexTable(NULL), m_dataTable(NULL) {}
+        explicit DBCStorage(const char* f) : nCount(0), fieldCount(0), fmt(f), indexTable(NULL), m_dataTable(NULL), loaded(false) {}
 
         /**
          * @brief
@@ -119,8 +119,9 @@ class DBCStorage
             // load raw non-string data
             m_dataTable = (T*)dbc.AutoProduceData(fmt, nCount, (char**&)indexTable);
 
-            // load strings from dbc data
-            m_stringPoolList.push_back(dbc.AutoProduceStrings(fmt, (char*)m_dataTable));
+            // point the strings into the mapped file, which the store keeps from here on
+            dbc.AutoProduceStrings(fmt, (char*)m_dataTable);
+            m_fileList.push_back(dbc.DetachMapping());
 
             // error in dbc file at loading if NULL
             return indexTable != NULL;
@@ -166,7 +167,8 @@ class DBCStorage
             }
 
             // load strings from another locale dbc data
-            m_stringPoolList.push_back(dbc.AutoProduceStrings(fmt, (char*)m_dataTable));
+            dbc.AutoProduceStrings(fmt, (char*)m_dataTable);
+            m_fileList.push_back(dbc.DetachMapping());
 
             return true;
         }
@@ -193,10 +195,10 @@ class DBCStorage
             delete[]((char*)m_dataTable);
             m_dataTable = NULL;
 
-            while (!m_stringPoolList.empty())
+            while (!m_fileList.empty())
             {
-                delete[] m_stringPoolList.front();
-                m_stringPoolList.pop_front();
+                delete m_fileList.front();
+                m_fileList.pop_front();
             }
             nCount = 0;
         }
@@ -224,7 +226,7 @@ class DBCStorage
         T* m_dataTable; /**< TODO */
         std::map<uint32, T const*> data;
         bool loaded;
-        StringPoolList m_stringPoolList; /**< TODO */
+        FileList m_fileList; /**< mapped files the string fields point into */
 };
 
 #endif
@@ -25,17 +25,21 @@
 #include "DatabaseEnv.h"
 #include "Config/Config.h"
 #include "Database/SqlOperations.h"
+#include "Database/SqlSnapshot.h"
 #include "GitRevision.h"
 #include "Utilities/Util.h"
+#include <algorithm>
 #include <ctime>
 #include <iostream>
 #include <fstream>
 #include <future>
 #include <memory>
+#include <thread>
 #include <cstdarg>
 
 #define MIN_CONNECTION_POOL_SIZE 1
 #define MAX_CONNECTION_POOL_SIZE 16
+#define MAX_ASYNC_SHARDS 16
 
 struct DBVersion
 {
@@ -128,7 +132,7 @@ Database::~Database()
     StopServer();
 }
 
-bool Database::Initialize(const char* infoString, int nConns /*= 1*/)
+bool Database::Initialize(const char* infoString, int nConns /*= 1*/, int nAsyncShards /*= 0*/)
 {
     // Enable logging of SQL commands (usually only GM commands)
     // (See method: PExecuteLog)
@@ -143,6 +147,12 @@ bool Database::Initialize(const char* infoString, int nConns /*= 1*/)
     }
 
     m_pingIntervallms = sConfig.GetIntDefault("MaxPingTime", 30) * (MINUTE * 1000);
+    m_batchRows = std::max(sConfig.GetIntDefault("DatabaseBatchRows", 64), 1);
+    m_snapshotDir = sConfig.GetStringDefault("DatabaseSnapshotDir", "");
+    if (!m_snapshotDir.empty() && m_snapshotDir[m_snapshotDir.length() - 1] != '/' && m_snapshotDir[m_snapshotDir.length() - 1] != '\\')
+    {
+        m_snapshotDir.append("/");
+    }
 
     // create DB connections
 
@@ -180,6 +190,20 @@ bool Database::Initialize(const char* infoString, int nConns /*= 1*/)
         return false;
     }
 
+    // and one more per keyed async shard
+    nAsyncShards = std::min(std::max(nAsyncShards, 0), MAX_ASYNC_SHARDS);
+    for (int i = 0; i < nAsyncShards; ++i)
+    {
+        SqlConnection* pConn = CreateConnection();
+        if (!pConn->Initialize(infoString))
+        {
+            delete pConn;
+            return false;
+        }
+
+        m_shardConns.push_back(pConn);
+    }
+
     m_pResultQueue = new SqlResultQueue;
 
     InitDelayThread();
@@ -202,22 +226,41 @@ void Database::StopServer()
     }
 
     m_pQueryConnections.clear();
+
+    for (size_t i = 0; i < m_shardConns.size(); ++i)
+    {
+        delete m_shardConns[i];
+    }
+
+    m_shardConns.clear();
 }
 
-SqlDelayThread* Database::CreateDelayThread()
+SqlDelayThread* Database::CreateDelayThread(SqlConnection* conn, uint32 shard)
 {
-    assert(m_pAsyncConn);
-    return new SqlDelayThread(this, m_pAsyncConn);
+    assert(conn);
+    return new SqlDelayThread(this, conn, m_shardGate, shard);
 }
 
 void Database::InitDelayThread()
 {
     assert(!m_delayThread);
 
+    if (!m_shardConns.empty())
+    {
+        m_shardGate = new SqlShardGate(uint32(m_shardConns.size()) + 1);
+    }
+
     // New delay thread for delay execute
-    m_threadBody = CreateDelayThread();              // will deleted at m_delayThread delete
+    m_threadBody = CreateDelayThread(m_pAsyncConn, 0);  // will deleted at m_delayThread delete
     m_TransStorage = new MaNGOS::ThreadLocalStore<Database::TransHelper>();
     m_delayThread = new MaNGOS::Thread(m_threadBody);
+
+    for (size_t i = 0; i < m_shardConns.size(); ++i)
+    {
+        SqlDelayThread* body = CreateDelayThread(m_shardConns[i], uint32(i) + 1);
+        m_shardBodies.push_back(body);
+        m_shardThreads.push_back(new MaNGOS::Thread(body));
+    }
 }
 
 void Database::HaltDelayThread()
@@ -228,12 +271,113 @@ void Database::HaltDelayThread()
     }
 
     m_threadBody->Stop();                                   // Stop event
+    for (size_t i = 0; i < m_shardBodies.size(); ++i)
+    {
+        m_shardBodies[i]->Stop();
+    }
+
+    if (m_shardGate)
+    {
+        m_shardGate->Halt();                                // release threads waiting on another shard
+    }
+
     m_delayThread->wait();                                  // Wait for flush to DB
+    for (size_t i = 0; i < m_shardThreads.size(); ++i)
+    {
+        m_shardThreads[i]->wait();
+    }
+
+    if (m_shardGate)
+    {
+        // whatever the shards left behind runs here, oldest first across all of them
+        std::vector<SqlDelayThread*> bodies(1, m_threadBody);
+        bodies.insert(bodies.end(), m_shardBodies.begin(), m_shardBodies.end());
+        for (;;)
+        {
+            SqlDelayThread* oldest = NULL;
+            uint64 oldestSeq = 0;
+            for (size_t i = 0; i < bodies.size(); ++i)
+            {
+                uint64 seq;
+                if (bodies[i]->PeekSequence(seq) && (!oldest || seq < oldestSeq))
+                {
+                    oldest = bodies[i];
+                    oldestSeq = seq;
+                }
+            }
+
+            if (!oldest)
+            {
+                break;
+            }
+
+            oldest->ExecuteNext();
+        }
+    }
+
     delete m_TransStorage;
     delete m_delayThread;                                   // This also deletes m_threadBody
+    for (size_t i = 0; i < m_shardThreads.size(); ++i)
+    {
+        delete m_shardThreads[i];                           // and the shard bodies
+    }
+
+    delete m_shardGate;
     m_delayThread = NULL;
     m_threadBody = NULL;
     m_TransStorage=NULL;
+    m_shardThreads.clear();
+    m_shardBodies.clear();
+    m_shardGate = NULL;
+}
+
+SqlDelayThread* Database::GetAsyncThread() const
+{
+    if (m_shardBodies.empty() || !m_TransStorage)
+    {
+        return m_threadBody;
+    }
+
+    uint64 key = (*m_TransStorage)->GetShardKey();
+    if (!key)
+    {
+        return m_threadBody;
+    }
+
+    return m_shardBodies[key % m_shardBodies.size()];
+}
+
+std::vector<SqlDelayStats> Database::GetAsyncStats() const
+{
+    std::vector<SqlDelayStats> stats;
+    if (m_threadBody)
+    {
+        stats.push_back(m_threadBody->GetStats());
+    }
+
+    for (size_t i = 0; i < m_shardBodies.size(); ++i)
+    {
+        stats.push_back(m_shardBodies[i]->GetStats());
+    }
+
+    return stats;
+}
+
+Database::ShardKeyScope::ShardKeyScope(Database& db, uint64 key) : m_db(db), m_previous(0)
+{
+    if (m_db.m_TransStorage)
+    {
+        m_previous = (*m_db.m_TransStorage)->GetShardKey();
+        (*m_db.m_TransStorage)->SetShardKey(key);
+    }
+}
+
+Database::ShardKeyScope::~ShardKeyScope()
+{
+    if (m_db.m_TransStorage)
+    {
+        (*m_db.m_TransStorage)->SetShardKey(m_previous);
+    }
 }
 
 void Database::ThreadStart()
@@ -267,20 +411,62 @@ void Database::escape_string(std::string& str)
     delete[] buf;
 }
 
-SqlConnection* Database::getQueryConnection()
+Database::QueryConnectionScope::QueryConnectionScope(Database& db, uint32 index) : m_db(db), m_previous(-1)
 {
-    int nCount = 0;
+    if (m_db.m_TransStorage)
+    {
+        m_previous = (*m_db.m_TransStorage)->GetQueryConnection();
+        (*m_db.m_TransStorage)->SetQueryConnection(int(index));
+        ++m_db.m_pinnedQueryScopes;
+    }
+}
 
-    if (m_nQueryCounter == long(1 << 31))
+Database::QueryConnectionScope::~QueryConnectionScope()
+{
+    if (m_db.m_TransStorage)
     {
-        m_nQueryCounter = 0;
+        (*m_db.m_TransStorage)->SetQueryConnection(m_previous);
+        --m_db.m_pinnedQueryScopes;
     }
-    else
+}
+
+SqlConnection* Database::getQueryConnection()
+{
+    // the thread-local lookup takes a lock, so only pay for it while some thread is pinned
+    int nCount = -1;
+    if (m_pinnedQueryScopes.load(std::memory_order_relaxed) && m_TransStorage)
+    {
+        nCount = (*m_TransStorage)->GetQueryConnection();
+    }
+
+    if (nCount < 0)
     {
-        nCount = ++m_nQueryCounter;
+        if (m_nQueryCounter == long(1 << 31))
+        {
+            m_nQueryCounter = 0;
+            nCount = 0;
+        }
+        else
+        {
+            nCount = ++m_nQueryCounter;
+        }
     }
 
-    return m_pQueryConnections[nCount % m_nQueryConnPoolSize];
+    // a connection streaming a result can't take another query before the
+    // stream is drained: move on to the next one. QueryStream() always leaves
+    // one free, so a scan only misses while streams end and start under it.
+    for (;;)
+    {
+        for (int i = 0; i < m_nQueryConnPoolSize; ++i)
+        {
+            SqlConnection* conn = m_pQueryConnections[(nCount + i) % m_nQueryConnPoolSize];
+            if (!conn->IsStreaming())
+            {
+                return conn;
+            }
+        }
+        std::this_thread::yield();
+    }
 }
 
 void Database::Ping()
@@ -366,6 +552,83 @@ QueryResult* Database::PQuery(const char* format, ...)
     return Query(szQuery);
 }
 
+QueryResult* Database::QueryStream(const char* sql)
+{
+    // streams start one at a time, so the count below still holds when this
+    // one has begun: a query made while any stream is open finds a free connection
+    std::lock_guard<std::mutex> streamGuard(m_streamLock);
+
+    int freeConnections = 0;
+    for (int i = 0; i < m_nQueryConnPoolSize; ++i)
+    {
+        if (!m_pQueryConnections[i]->IsStreaming())
+        {
+            ++freeConnections;
+        }
+    }
+
+    // taking the last free connection would leave nested queries nowhere to go
+    if (freeConnections < 2)
+    {
+        return Query(sql);
+    }
+
+    CheckSyncQuery(sql);
+    SqlConnection::Lock guard(getQueryConnection());
+    return guard->QueryStream(sql);
+}
+
+SqlQueryFuture Database::QueryAsync(const char* sql)
+{
+    if (!sql)
+    {
+        return SqlQueryFuture();
+    }
+
+    SqlDelayThread* thread = GetAsyncThread();
+    if (!thread)
+    {
+        return SqlQueryFuture::Ready(Query(sql));
+    }
+
+    std::shared_ptr<SqlQueryFuture::State> state = std::make_shared<SqlQueryFuture::State>();
+    thread->Delay(new SqlFutureQuery(sql, state));
+    return SqlQueryFuture(state);
+}
+
+SqlQueryFuture Database::PQueryAsync(const char* format, ...)
+{
+    if (!format)
+    {
+        return SqlQueryFuture();
+    }
+
+    va_list ap;
+    char szQuery [MAX_QUERY_LEN];
+    va_start(ap, format);
+    int res = vsnprintf(szQuery, MAX_QUERY_LEN, format, ap);
+    va_end(ap);
+
+    if (res == -1)
+    {
+        sLog.outError("SQL Query truncated (and not execute) for format: %s", format);
+        return SqlQueryFuture();
+    }
+
+    return QueryAsync(szQuery);
+}
+
+void Database::ReportSyncQuery(const char* sql)
+{
+    sLog.outError("SQL: sync query on the %s thread, the world tick waits for it: %s",
+                  SqlProfiler::GetThreadCaller() == SQL_CALLER_MAP ? "map" : "world", sql);
+
+    if (m_syncQueryCheck.load(std::memory_order_relaxed) == SQL_SYNC_QUERY_ASSERT)
+    {
+        MANGOS_ASSERT(false && "sync query on a thread the world tick waits for");
+    }
+}
+
 QueryNamedResult* Database::PQueryNamed(const char* format, ...)
 {
     if (!format)
@@ -410,7 +673,7 @@ bool Database::Execute(const char* sql)
         }
 
         // Simple sql statement
-        m_threadBody->Delay(new SqlPlainRequest(sql));
+        GetAsyncThread()->Delay(new SqlPlainRequest(sql));
     }
 
     return true;
@@ -493,10 +756,48 @@ bool Database::CommitTransaction()
     }
 
     // add SqlTransaction to the async queue
-    m_threadBody->Delay((*m_TransStorage)->detach());
+    GetAsyncThread()->Delay((*m_TransStorage)->detach());
     return true;
 }
 
+bool Database::CommitTransaction(std::shared_ptr<SqlCommitStatus> const& status)
+{
+    if (!m_pAsyncConn)
+    {
+        return false;
+    }
+
+    // check if we have pending transaction
+    if (!(*m_TransStorage)->get())
+    {
+        return false;
+    }
+
+    SqlTransactionStatusSignal* op = new SqlTransactionStatusSignal((*m_TransStorage)->detach(), status);
+
+    // if async execution is not available
+    if (!m_bAllowAsyncTransactions)
+    {
+        op->Execute(m_pAsyncConn);
+        delete op;
+        return true;
+    }
+
+    GetAsyncThread()->Delay(op);
+    return true;
+}
+
+size_t Database::GetTransactionSize() const
+{
+    if (!m_TransStorage)
+    {
+        return 0;
+    }
+
+    SqlTransaction const* pTrans = (*m_TransStorage)->get();
+    return pTrans ? pTrans->Size() : 0;
+}
+
 bool Database::CommitTransactionDirect()
 {
     if (!m_pAsyncConn)
@@ -556,7 +857,8 @@ bool Database::CommitTransactionChecked()
     /// closed in practice by shutdown sequencing: the world thread is torn down
     /// before the DB delay thread is stopped, so no world-thread caller reaches
     /// this commit path concurrently with the delay thread stopping.
-    if (!m_threadBody->IsRunning())
+    SqlDelayThread* asyncThread = GetAsyncThread();
+    if (!asyncThread->IsRunning())
     {
         SqlTransaction* t = (*m_TransStorage)->detach();
         bool r = t->Execute(m_pAsyncConn);
@@ -573,7 +875,7 @@ bool Database::CommitTransactionChecked()
     std::promise<bool> prom;
     std::future<bool> fut = prom.get_future();
     SqlTransaction* pTrans = (*m_TransStorage)->detach();
-    m_threadBody->Delay(new SqlTransactionResultSignal(pTrans, &prom));
+    asyncThread->Delay(new SqlTransactionResultSignal(pTrans, &prom));
     return fut.get();
 }
 
@@ -749,7 +1051,7 @@ bool Database::ExecuteStmt(const SqlStatementID& id, SqlStmtParameters* params)
         }
 
         // Simple sql statement
-        m_threadBody->Delay(new SqlPreparedRequest(id.ID(), params));
+        GetAsyncThread()->Delay(new SqlPreparedRequest(id.ID(), params));
     }
 
     return true;
@@ -814,6 +1116,260 @@ std::string Database::GetStmtString(const int stmtId) const
     return std::string();
 }
 
+/// FNV-1a, for snapshot keys and file names
+static uint64 HashString(uint64 hash, std::string const& text)
+{
+    for (size_t i = 0; i < text.size(); ++i)
+    {
+        hash = (hash ^ uint8(text[i])) * UI64LIT(1099511628211);
+    }
+    return hash;
+}
+
+QueryResult* Database::QuerySnapshot(const char* sql, const char* tables, bool stream)
+{
+    if (m_snapshotDir.empty())
+    {
+        return stream ? QueryStream(sql) : Query(sql);
+    }
+
+    // the key covers the query and the current contents of every table it reads
+    std::string checksumSql = "CHECKSUM TABLE ";
+    Tokens const tableNames = StrSplit(tables, ",");
+    for (Tokens::const_iterator itr = tableNames.begin(); itr != tableNames.end(); ++itr)
+    {
+        checksumSql += (itr == tableNames.begin() ? "`" : ", `") + *itr + "`";
+    }
+
+    uint64 key = HashString(UI64LIT(14695981039346656037), sql);
+    QueryResult* checksums = Query(checksumSql.c_str());
+    if (!checksums)
+    {
+        return stream ? QueryStream(sql) : Query(sql);
+    }
+    do
+    {
+        Field* fields = checksums->Fetch();
+        if (fields[1].IsNULL())                             // no such table: leave it to the query to complain
+        {
+            delete checksums;
+            return stream ? QueryStream(sql) : Query(sql);
+        }
+        key = HashString(key, fields[0].GetCppString() + "=" + fields[1].GetCppString() + ";");
+    }
+    while (checksums->NextRow());
+    delete checksums;
+
+    uint64 const name = HashString(UI64LIT(14695981039346656037), sql);
+    char fileName[32];
+    snprintf(fileName, sizeof(fileName), "%08x%08x.snap", PAIR64_HIPART(name), PAIR64_LOPART(name));
+    std::string const file = m_snapshotDir + fileName;
+
+    QueryResult* result = NULL;
+    if (SqlSnapshot::Load(file, key, result))
+    {
+        DETAIL_LOG("Database: %s read from snapshot %s", tables, file.c_str());
+        return result;
+    }
+
+    DETAIL_LOG("Database: %s changed, rewriting snapshot %s", tables, file.c_str());
+    return SqlSnapshot::Capture(stream ? QueryStream(sql) : Query(sql), key, file);
+}
+
+/// case-insensitive "does @p text continue with @p word at @p pos", skipping leading blanks
+static bool MatchWord(std::string const& text, size_t& pos, char const* word)
+{
+    while (pos < text.size() && isspace(uint8(text[pos])))
+    {
+        ++pos;
+    }
+
+    size_t const len = strlen(word);
+    if (text.size() - pos < len || strnicmp(text.c_str() + pos, word, len) != 0)
+    {
+        return false;
+    }
+
+    pos += len;
+    return true;
+}
+
+/// blanks only from @p pos to the end
+static bool AtEnd(std::string const& text, size_t pos)
+{
+    while (pos < text.size() && isspace(uint8(text[pos])))
+    {
+        ++pos;
+    }
+    return pos == text.size();
+}
+
+/**
+ * @brief Work out whether a statement can be repeated as one multi-row statement.
+ *
+ * "INSERT|REPLACE INTO t (...) VALUES (?, ...)" repeats its VALUES tuple and
+ * "DELETE FROM t WHERE col = ?" turns into "... WHERE col IN (?, ...)". Anything
+ * else (INSERT ... SELECT, ON DUPLICATE KEY, literals in the tuple, more
+ * conditions) keeps running a row at a time.
+ */
+static bool ParseBatchShape(std::string const& fmt, std::string& head, std::string& row, std::string& separator, std::string& tail)
+{
+    size_t pos = 0;
+    if (MatchWord(fmt, pos, "INSERT") || MatchWord(fmt, pos, "REPLACE"))
+    {
+        // the VALUES tuple must hold every parameter and close the statement
+        size_t const open = fmt.rfind('(');
+        size_t const close = fmt.rfind(')');
+        if (open == std::string::npos || close == std::string::npos || close < open || !AtEnd(fmt, close + 1))
+        {
+            return false;
+        }
+
+        size_t values = open;
+        while (values > 0 && isspace(uint8(fmt[values - 1])))
+        {
+            --values;
+        }
+        if (values < 6 || strnicmp(fmt.c_str() + values - 6, "VALUES", 6) != 0 || fmt.find('?') < open)
+        {
+            return false;
+        }
+
+        for (size_t i = open + 1; i < close; ++i)
+        {
+            if (fmt[i] != '?' && fmt[i] != ',' && !isspace(uint8(fmt[i])))
+            {
+                return false;
+            }
+        }
+
+        head = fmt.substr(0, open);
+        row = fmt.substr(open, close - open + 1);
+        separator = ",";
+        tail.clear();
+        return true;
+    }
+
+    pos = 0;
+    if (MatchWord(fmt, pos, "DELETE") && MatchWord(fmt, pos, "FROM"))
+    {
+        size_t const param = fmt.find('?');
+        if (param == std::string::npos || fmt.find('?', param + 1) != std::string::npos || !AtEnd(fmt, param + 1))
+        {
+            return false;
+        }
+
+        // walk back over "WHERE column = ?", the only condition allowed
+        size_t at = param;
+        while (at > 0 && isspace(uint8(fmt[at - 1])))
+        {
+            --at;
+        }
+        if (at == 0 || fmt[at - 1] != '=')
+        {
+            return false;
+        }
+        --at;
+        while (at > 0 && isspace(uint8(fmt[at - 1])))
+        {
+            --at;
+        }
+
+        size_t const columnEnd = at;
+        while (at > 0 && (isalnum(uint8(fmt[at - 1])) || fmt[at - 1] == '_' || fmt[at - 1] == '`' || fmt[at - 1] == '.'))
+        {
+            --at;
+        }
+        if (at == columnEnd || at == 0 || !isspace(uint8(fmt[at - 1])))
+        {
+            return false;
+        }
+        while (at > 0 && isspace(uint8(fmt[at - 1])))
+        {
+            --at;
+        }
+        if (at < 5 || strnicmp(fmt.c_str() + at - 5, "WHERE", 5) != 0)
+        {
+            return false;
+        }
+
+        head = fmt.substr(0, columnEnd) + " IN (";
+        row = "?";
+        separator = ",";
+        tail = ")";
+        return true;
+    }
+
+    return false;
+}
+
+int Database::GetBatchStmtId(int stmtId, uint32 rows)
+{
+    if (rows < 2 || stmtId == -1)
+    {
+        return -1;
+    }
+
+    LOCK_GUARD _guard(m_stmtGuard);
+
+    std::map<int, BatchShape>::iterator shape = m_batchShapes.find(stmtId);
+    if (shape == m_batchShapes.end())
+    {
+        BatchShape parsed;
+        parsed.rowParams = 0;
+        for (PreparedStmtRegistry::const_iterator iter = m_stmtRegistry.begin(); iter != m_stmtRegistry.end(); ++iter)
+        {
+            if (iter->second == stmtId)
+            {
+                if (ParseBatchShape(iter->first, parsed.head, parsed.row, parsed.separator, parsed.tail))
+                {
+                    parsed.rowParams = uint32(std::count(parsed.row.begin(), parsed.row.end(), '?'));
+                }
+                break;
+            }
+        }
+        shape = m_batchShapes.insert(std::make_pair(stmtId, parsed)).first;
+    }
+
+    if (!shape->second.rowParams)
+    {
+        return -1;
+    }
+
+    std::pair<int, uint32> const key(stmtId, rows);
+    std::map<std::pair<int, uint32>, int>::const_iterator batched = m_batchStmts.find(key);
+    if (batched != m_batchStmts.end())
+    {
+        return batched->second;
+    }
+
+    std::string fmt = shape->second.head;
+    for (uint32 i = 0; i < rows; ++i)
+    {
+        if (i)
+        {
+            fmt += shape->second.separator;
+        }
+        fmt += shape->second.row;
+    }
+    fmt += shape->second.tail;
+
+    int nId;
+    PreparedStmtRegistry::const_iterator iter = m_stmtRegistry.find(fmt);
+    if (iter == m_stmtRegistry.end())
+    {
+        nId = ++m_iStmtIndex;
+        m_stmtRegistry[fmt] = nId;
+    }
+    else
+    {
+        nId = iter->second;
+    }
+
+    m_batchStmts[key] = nId;
+    return nId;
+}
+
 // HELPER CLASSES AND FUNCTIONS
 Database::TransHelper::~TransHelper()
 {
@@ -30,11 +30,15 @@
 #include "Utilities/UnorderedMapSet.h"
 #include "Database/SqlDelayThread.h"
 #include "SqlPreparedStatement.h"
+#include "SqlProfiler.h"
+#include "SqlQueryFuture.h"
 
 #include <atomic>
+#include <map>
 #include <mutex>
 
 class SqlTransaction;
+struct SqlCommitStatus;
 class SqlResultQueue;
 class SqlQueryHolder;
 class SqlStmtParameters;
@@ -104,6 +108,50 @@ class SqlConnection
          */
         virtual QueryNamedResult* QueryNamed(const char* sql) = 0;
 
+        /**
+         * @brief Execute a SELECT and hand the rows over as the server sends them
+         *
+         * Called with the connection locked. A streamed result keeps the
+         * connection locked and busy (see BeginStream()) until its last row
+         * has been read or it is deleted, which must happen on the thread that
+         * ran the query. GetRowCount() of a streamed result is 0: the count is
+         * not known before the end. Connections that can't stream buffer the
+         * result as Query() does.
+         *
+         * @param sql
+         * @return QueryResult NULL on error or for an empty result
+         */
+        virtual QueryResult* QueryStream(const char* sql) { return Query(sql); }
+
+        /**
+         * @brief Keep the connection locked for a streamed result
+         *
+         * Must be called with the connection locked, on the thread that
+         * will later call EndStream().
+         */
+        void BeginStream()
+        {
+            m_mutex.lock();
+            m_streaming.store(true, std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief Release the connection kept by BeginStream()
+         *
+         */
+        void EndStream()
+        {
+            m_streaming.store(false, std::memory_order_relaxed);
+            m_mutex.unlock();
+        }
+
+        /**
+         * @brief Whether a streamed result still holds the connection
+         *
+         * @return bool
+         */
+        bool IsStreaming() const { return m_streaming.load(std::memory_order_relaxed); }
+
         /**
          * @brief public methods for making requests
          *
@@ -211,7 +259,7 @@ class SqlConnection
          *
          * @param db
          */
-        SqlConnection(Database& db) : m_db(db) {}
+        SqlConnection(Database& db) : m_db(db), m_streaming(false) {}
 
         /**
          * @brief
@@ -244,6 +292,7 @@ class SqlConnection
          */
         typedef std::recursive_mutex LOCK_TYPE;
         LOCK_TYPE m_mutex; /**< TODO */
+        std::atomic<bool> m_streaming; /**< a streamed result holds m_mutex */
 
         /**
          * @brief
@@ -257,6 +306,14 @@ class SqlConnection
  * @brief
  *
  */
+/// What a synchronous query on a thread the world tick waits for does.
+enum SqlSyncQueryCheck
+{
+    SQL_SYNC_QUERY_ALLOW    = 0,                            // nothing
+    SQL_SYNC_QUERY_LOG      = 1,                            // log the statement
+    SQL_SYNC_QUERY_ASSERT   = 2                             // log it, then stop the server
+};
+
 class Database
 {
     public:
@@ -271,9 +328,10 @@ class Database
          *
          * @param infoString
          * @param nConns
+         * @param nAsyncShards extra async connections for keyed work, see ShardKeyScope
          * @return bool
          */
-        virtual bool Initialize(const char* infoString, int nConns = 1);
+        virtual bool Initialize(const char* infoString, int nConns = 1, int nAsyncShards = 0);
 
         /**
          * @brief start worker thread for async DB request execution
@@ -287,6 +345,97 @@ class Database
          */
         virtual void HaltDelayThread();
 
+        /**
+         * @brief Routes the async work queued by this thread to a keyed shard
+         *
+         * While a scope is alive, async statements, queries, query holders and
+         * transactions queued by the current thread go to the shard owning
+         * @p key instead of the unkeyed async thread. Work with the same key
+         * keeps its order, work with other keys may run in parallel, and
+         * unkeyed work stays ordered against both. A no-op when the database
+         * has no async shards. Scopes nest; the previous key is restored.
+         */
+        class ShardKeyScope
+        {
+            public:
+                /**
+                 * @brief
+                 *
+                 * @param db
+                 * @param key e.g. a character guid or account id, 0 for unkeyed
+                 */
+                ShardKeyScope(Database& db, uint64 key);
+
+                /**
+                 * @brief
+                 *
+                 */
+                ~ShardKeyScope();
+
+                ShardKeyScope(ShardKeyScope const&) = delete;
+                ShardKeyScope& operator=(ShardKeyScope const&) = delete;
+
+            private:
+                Database& m_db; /**< TODO */
+                uint64 m_previous; /**< key to restore */
+        };
+
+        /**
+         * @brief Pins the sync queries of this thread to one query connection
+         *
+         * While a scope is alive, Query(), PQuery() and DirectExecute() on the
+         * current thread always use query connection @p index (modulo the pool
+         * size) instead of the round-robin pick, so threads holding distinct
+         * indexes never wait on each other's connection lock. Used by the
+         * parallel startup loader, one index per worker. Scopes nest; the
+         * previous pin is restored.
+         */
+        class QueryConnectionScope
+        {
+            public:
+                /**
+                 * @brief
+                 *
+                 * @param db
+                 * @param index query connection to use
+                 */
+                QueryConnectionScope(Database& db, uint32 index);
+
+                /**
+                 * @brief
+                 *
+                 */
+                ~QueryConnectionScope();
+
+                QueryConnectionScope(QueryConnectionScope const&) = delete;
+                QueryConnectionScope& operator=(QueryConnectionScope const&) = delete;
+
+            private:
+                Database& m_db; /**< TODO */
+                int m_previous; /**< pin to restore, -1 for none */
+        };
+
+        /**
+         * @brief Size of the sync query connection pool (<X>DatabaseConnections)
+         *
+         * @return uint32
+         */
+        uint32 GetQueryConnectionCount() const { return uint32(m_pQueryConnections.size()); }
+
+        /**
+         * @brief Queue depth and latency of every async thread, unkeyed shard first
+         *
+         * @return std::vector<SqlDelayStats>
+         */
+        std::vector<SqlDelayStats> GetAsyncStats() const;
+
+        /**
+         * @brief Per-statement timing and the slow-query log of this database
+         *
+         * @return SqlProfiler
+         */
+        SqlProfiler& GetProfiler() { return m_profiler; }
+
         /**
          * @brief Synchronous DB queries
          *
@@ -295,6 +444,7 @@ class Database
          */
         inline QueryResult* Query(const char* sql)
         {
+            CheckSyncQuery(sql);
             SqlConnection::Lock guard(getQueryConnection());
             return guard->Query(sql);
         }
@@ -307,6 +457,7 @@ class Database
          */
         inline QueryNamedResult* QueryNamed(const char* sql)
         {
+            CheckSyncQuery(sql);
             SqlConnection::Lock guard(getQueryConnection());
             return guard->QueryNamed(sql);
         }
@@ -319,6 +470,67 @@ class Database
          */
         QueryResult* PQuery(const char* format, ...) ATTR_PRINTF(2, 3);
 
+        /**
+         * @brief SELECT run on the async thread, polled through the returned handle
+         *
+         * For code that must not wait on the database, such as opcode handlers:
+         * pass the handle to WorldSession::AddQueryCallback() to resume on the
+         * session's next update. Without an async thread the query runs now.
+         *
+         * @param sql
+         * @return SqlQueryFuture invalid when @p sql is NULL
+         */
+        SqlQueryFuture QueryAsync(const char* sql);
+
+        /**
+         * @brief
+         *
+         * @param format...
+         * @return SqlQueryFuture invalid when the query doesn't fit MAX_QUERY_LEN
+         */
+        SqlQueryFuture PQueryAsync(const char* format, ...) ATTR_PRINTF(2, 3);
+
+        /**
+         * @brief What a sync query does on the world thread or a map thread (DatabaseProfiler.SyncQueryCheck)
+         *
+         * @param check
+         */
+        void SetSyncQueryCheck(SqlSyncQueryCheck check) { m_syncQueryCheck.store(check, std::memory_order_relaxed); }
+
+        /**
+         * @brief Synchronous SELECT whose rows are read as they arrive, for huge startup loads
+         *
+         * The rows are not buffered client side first, so a loader that turns
+         * each row into its own structures never holds the whole result set
+         * twice. The connection stays busy until the result is drained or
+         * deleted; sync queries issued meanwhile go to the other connections
+         * of the pool. A stream never takes the last connection no other
+         * stream holds: with a single query connection, or while the others
+         * are streaming, this is Query().
+         *
+         * @param sql
+         * @return QueryResult NULL for an empty result, like Query(); GetRowCount() is 0
+         */
+        QueryResult* QueryStream(const char* sql);
+
+        /**
+         * @brief SELECT over static tables through the on-disk snapshot cache (DatabaseSnapshotDir)
+         *
+         * The rows come from the snapshot file when every table in @p tables
+         * still has the CHECKSUM TABLE value the snapshot was taken at; otherwise
+         * the query runs and its snapshot is rewritten. A NULL result (an empty
+         * table or a query error) is returned as is and never snapshotted.
+         * CHECKSUM TABLE still scans each InnoDB table on the server; what is
+         * saved is the query itself and the transfer of its rows. Without a
+         * snapshot directory this is Query(), or QueryStream() with @p stream.
+         *
+         * @param sql
+         * @param tables comma separated tables the query reads
+         * @param stream read rows coming from the server through QueryStream()
+         * @return QueryResult NULL for an empty result, like Query()
+         */
+        QueryResult* QuerySnapshot(const char* sql, const char* tables, bool stream = false);
+
         /**
          * @brief
          *
@@ -619,6 +831,15 @@ class Database
          */
         bool CommitTransaction();
 
+        /**
+         * @brief CommitTransaction() that publishes in @p status whether the
+         *        transaction committed, once it has run
+         *
+         * @param status left PENDING when no transaction was begun
+         * @return bool
+         */
+        bool CommitTransaction(std::shared_ptr<SqlCommitStatus> const& status);
+
         /**
          * @brief
          *
@@ -626,6 +847,13 @@ class Database
          */
         bool RollbackTransaction();
 
+        /**
+         * @brief statements queued in the current thread's open transaction, 0 if none
+         *
+         * @return size_t
+         */
+        size_t GetTransactionSize() const;
+
         /**
          * @brief for sync transaction execution
          *
@@ -670,6 +898,28 @@ class Database
          */
         std::string GetStmtString(const int stmtId) const;
 
+        /**
+         * @brief get a statement running @p rows consecutive executions of
+         *        @p stmtId as one multi-row INSERT/REPLACE or DELETE ... IN
+         *
+         * Only "INSERT|REPLACE ... VALUES (?, ...)" with no other parameters and
+         * "DELETE FROM t WHERE col = ?" have a batchable shape. Each distinct
+         * @p rows prepares its own statement per connection, so callers keep
+         * to a few sizes (see SqlTransaction::ExecuteBatched).
+         *
+         * @param stmtId
+         * @param rows
+         * @return int statement id, -1 if the statement can't be batched
+         */
+        int GetBatchStmtId(int stmtId, uint32 rows);
+
+        /**
+         * @brief most rows a transaction folds into one statement (DatabaseBatchRows), 1 disables batching
+         *
+         * @return uint32
+         */
+        uint32 GetBatchRows() const { return m_batchRows; }
+
         /**
          * @brief
          *
@@ -746,10 +996,11 @@ class Database
          */
         Database()
             : m_TransStorage(NULL),m_nQueryConnPoolSize(1), m_pAsyncConn(NULL), m_pResultQueue(NULL),
-            m_threadBody(NULL), m_delayThread(NULL), m_bAllowAsyncTransactions(false),
-            m_iStmtIndex(-1), m_logSQL(false), m_pingIntervallms(0)
+            m_threadBody(NULL), m_delayThread(NULL), m_shardGate(NULL), m_bAllowAsyncTransactions(false),
+            m_iStmtIndex(-1), m_batchRows(1), m_syncQueryCheck(SQL_SYNC_QUERY_ALLOW), m_logSQL(false), m_pingIntervallms(0)
         {
             m_nQueryCounter = -1;
+            m_pinnedQueryScopes = 0;
         }
 
         /**
@@ -768,9 +1019,11 @@ class Database
         /**
          * @brief factory method to create SqlDelayThread objects
          *
+         * @param conn connection the thread executes on
+         * @param shard 0 for the unkeyed thread, 1..N for the keyed shards
          * @return SqlDelayThread
          */
-        virtual SqlDelayThread* CreateDelayThread();
+        virtual SqlDelayThread* CreateDelayThread(SqlConnection* conn, uint32 shard);
 
         /**
          * @brief
@@ -783,7 +1036,7 @@ class Database
                  * @brief
                  *
                  */
-                TransHelper() : m_pTrans(NULL) {}
+                TransHelper() : m_pTrans(NULL), m_shardKey(0), m_queryConn(-1) {}
 
                 /**
                  * @brief
@@ -821,8 +1074,38 @@ class Database
                  */
                 void reset();
 
+                /**
+                 * @brief shard key set by the innermost ShardKeyScope on this thread, 0 if none
+                 *
+                 * @return uint64
+                 */
+                uint64 GetShardKey() const { return m_shardKey; }
+
+                /**
+                 * @brief
+                 *
+                 * @param key
+                 */
+                void SetShardKey(uint64 key) { m_shardKey = key; }
+
+                /**
+                 * @brief query connection set by the innermost QueryConnectionScope on this thread, -1 if none
+                 *
+                 * @return int
+                 */
+                int GetQueryConnection() const { return m_queryConn; }
+
+                /**
+                 * @brief
+                 *
+                 * @param index
+                 */
+                void SetQueryConnection(int index) { m_queryConn = index; }
+
             private:
                 SqlTransaction* m_pTrans; /**< TODO */
+                uint64 m_shardKey; /**< TODO */
+                int m_queryConn; /**< TODO */
         };
 
         /**
@@ -835,7 +1118,7 @@ class Database
         ///< DB connections
 
         /**
-         * @brief round-robin connection selection
+         * @brief round-robin connection selection, unless the thread is pinned by a QueryConnectionScope
          *
          * @return SqlConnection
          */
@@ -848,6 +1131,34 @@ class Database
          */
         SqlConnection* getAsyncConnection() const { return m_pAsyncConn; }
 
+        /**
+         * @brief async thread for work queued by the current thread, picked by its shard key
+         *
+         * @return SqlDelayThread
+         */
+        SqlDelayThread* GetAsyncThread() const;
+
+        /**
+         * @brief reports @p sql when it is a sync query the world tick waits for, see SetSyncQueryCheck()
+         *
+         * @param sql
+         */
+        inline void CheckSyncQuery(const char* sql)
+        {
+            if (m_syncQueryCheck.load(std::memory_order_relaxed) != SQL_SYNC_QUERY_ALLOW &&
+                SqlProfiler::IsTickBound(SqlProfiler::GetThreadCaller()))
+            {
+                ReportSyncQuery(sql);
+            }
+        }
+
+        /**
+         * @brief
+         *
+         * @param sql
+         */
+        void ReportSyncQuery(const char* sql);
+
         friend class SqlStatement;
         // PREPARED STATEMENT API
 
@@ -872,6 +1183,8 @@ class Database
         // connection helper counters
         int m_nQueryConnPoolSize;                               /**< current size of query connection pool */
         std::atomic<long> m_nQueryCounter;  /**< counter for connection selection */
+        std::atomic<int> m_pinnedQueryScopes; /**< live QueryConnectionScopes; the per-thread pin is only looked up while non-zero */
+        std::mutex m_streamLock;                                /**< serializes QueryStream() starts */
 
         /**
          * @brief lets use pool of connections for sync queries
@@ -887,6 +1200,12 @@ class Database
         SqlDelayThread*     m_threadBody;                   /**< Pointer to delay sql executer (owned by m_delayThread) */
         MaNGOS::Thread*  m_delayThread;                  /**< Pointer to executer thread */
 
+        // keyed async shards, empty unless <X>DatabaseAsyncShards is set
+        SqlConnectionContainer m_shardConns;                /**< one connection per keyed shard */
+        std::vector<SqlDelayThread*> m_shardBodies;         /**< owned by the matching m_shardThreads entry */
+        std::vector<MaNGOS::Thread*> m_shardThreads;
+        SqlShardGate* m_shardGate;                          /**< orders the unkeyed thread against the shards */
+
         bool m_bAllowAsyncTransactions;                     /**< flag which specifies if async transactions are enabled */
 
         // PREPARED STATEMENT REGISTRY
@@ -914,6 +1233,24 @@ class Database
 
         int m_iStmtIndex; /**< TODO */
 
+        /// how a statement grows into a multi-row one: head + row (separator row)... + tail
+        struct BatchShape
+        {
+            std::string head;
+            std::string row;
+            std::string separator;
+            std::string tail;
+            uint32 rowParams;                               ///< 0 when the statement can't be batched
+        };
+        std::map<int, BatchShape> m_batchShapes;            ///< by statement id, guarded by m_stmtGuard
+        std::map<std::pair<int, uint32>, int> m_batchStmts; ///< (statement id, rows) -> batched statement id
+        uint32 m_batchRows;
+
+        std::string m_snapshotDir;                          ///< DatabaseSnapshotDir, empty when snapshots are off
+
+        SqlProfiler m_profiler;
+        std::atomic<SqlSyncQueryCheck> m_syncQueryCheck;
+
     private:
 
         bool m_logSQL; /**< TODO */
@@ -298,6 +298,7 @@ bool MySQLConnection::Initialize(const char* infoString)
  * @param pFields Output: Field metadata array
  * @param pRowCount Output: Number of rows in result
  * @param pFieldCount Output: Number of fields per row
+ * @param stream Read the rows from the server on demand instead of storing them
  * @return true if query succeeded and has rows, false otherwise
  *
  * Internal query execution method that handles:
@@ -307,7 +308,7 @@ bool MySQLConnection::Initialize(const char* infoString)
  *
  * @note Caller must free the result with mysql_free_result()
  */
-bool MySQLConnection::_Query(const char* sql, MYSQL_RES** pResult, MYSQL_FIELD** pFields, uint64* pRowCount, uint32* pFieldCount)
+bool MySQLConnection::_Query(const char* sql, MYSQL_RES** pResult, MYSQL_FIELD** pFields, uint64* pRowCount, uint32* pFieldCount, bool stream)
 {
     if (!mMysql)
     {
@@ -315,6 +316,8 @@ bool MySQLConnection::_Query(const char* sql, MYSQL_RES** pResult, MYSQL_FIELD**
     }
 
     uint32 _s = getMSTime();
+    SqlProfiler& profiler = m_db.GetProfiler();
+    uint64 const startUs = profiler.IsTiming() ? SqlProfiler::NowUs() : 0;
 
     if (mysql_query(mMysql, sql))
     {
@@ -327,16 +330,23 @@ bool MySQLConnection::_Query(const char* sql, MYSQL_RES** pResult, MYSQL_FIELD**
         DEBUG_FILTER_LOG(LOG_FILTER_SQL_TEXT, "[%u ms] SQL: %s", getMSTimeDiff(_s, getMSTime()), sql);
     }
 
-    *pResult = mysql_store_result(mMysql);
-    *pRowCount = mysql_affected_rows(mMysql);
+    *pResult = stream ? mysql_use_result(mMysql) : mysql_store_result(mMysql);
+    *pRowCount = stream ? 0 : mysql_affected_rows(mMysql);
     *pFieldCount = mysql_field_count(mMysql);
 
+    // a stream is timed to its first row, its rows are not counted
+    if (startUs)
+    {
+        profiler.Record(sql, false, *pResult ? *pRowCount : 0, SqlProfiler::NowUs() - startUs);
+    }
+
     if (!*pResult)
     {
         return false;
     }
 
-    if (!*pRowCount)
+    // an empty stream only shows at its first fetch
+    if (!stream && !*pRowCount)
     {
         mysql_free_result(*pResult);
         return false;
@@ -374,6 +384,40 @@ QueryResult* MySQLConnection::Query(const char* sql)
     return queryResult;
 }
 
+/**
+ * @brief Execute a SELECT query and stream its rows
+ * @param sql SELECT query string
+ * @return QueryResult on the first row, or NULL on failure/no rows
+ *
+ * The rows stay on the server until fetched, so the client never holds
+ * the whole result set. The returned result keeps this connection locked
+ * until it has been drained or deleted.
+ *
+ * @note Called with the connection locked, see SqlConnection::QueryStream()
+ */
+QueryResult* MySQLConnection::QueryStream(const char* sql)
+{
+    MYSQL_RES* result = NULL;
+    MYSQL_FIELD* fields = NULL;
+    uint64 rowCount = 0;
+    uint32 fieldCount = 0;
+
+    if (!_Query(sql, &result, &fields, &rowCount, &fieldCount, true))
+    {
+        return NULL;
+    }
+
+    BeginStream();
+    QueryResultMysql* queryResult = new QueryResultMysql(result, fields, rowCount, fieldCount, this, mMysql);
+
+    if (!queryResult->NextRow())
+    {
+        delete queryResult;
+        return NULL;
+    }
+    return queryResult;
+}
+
 /**
  * @brief Execute a SELECT query with named field access
  * @param sql SELECT query string
@@ -429,6 +473,8 @@ bool MySQLConnection::Execute(const char* sql)
 
     {
         uint32 _s = getMSTime();
+        SqlProfiler& profiler = m_db.GetProfiler();
+        uint64 const startUs = profiler.IsTiming() ? SqlProfiler::NowUs() : 0;
 
         if (mysql_query(mMysql, sql))
         {
@@ -440,6 +486,11 @@ bool MySQLConnection::Execute(const char* sql)
         {
             DEBUG_FILTER_LOG(LOG_FILTER_SQL_TEXT, "[%u ms] SQL: %s", getMSTimeDiff(_s, getMSTime()), sql);
         }
+
+        if (startUs)
+        {
+            profiler.Record(sql, false, mysql_affected_rows(mMysql), SqlProfiler::NowUs() - startUs);
+        }
         // end guarded block
     }
 
@@ -739,6 +790,9 @@ bool MySqlPreparedStatement::execute()
         return false;
     }
 
+    SqlProfiler& profiler = m_pConn.DB().GetProfiler();
+    uint64 const startUs = profiler.IsTiming() ? SqlProfiler::NowUs() : 0;
+
     if (mysql_stmt_execute(m_stmt))
     {
         sLog.outError("SQL: can not execute '%s'", m_szFmt.c_str());
@@ -746,6 +800,11 @@ bool MySqlPreparedStatement::execute()
         return false;
     }
 
+    if (startUs)
+    {
+        profiler.Record(m_szFmt.c_str(), true, isQuery() ? 0 : mysql_stmt_affected_rows(m_stmt), SqlProfiler::NowUs() - startUs);
+    }
+
     return true;
 }
 
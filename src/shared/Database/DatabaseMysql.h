@@ -147,6 +147,13 @@ class MySQLConnection : public SqlConnection
          */
         QueryNamedResult* QueryNamed(const char* sql) override;
 
+        /**
+         * @brief Execute SELECT query, rows read from the server one by one (mysql_use_result)
+         * @param sql SQL query string
+         * @return QueryResult pointer holding the connection, or NULL on error or no rows
+         */
+        QueryResult* QueryStream(const char* sql) override;
+
         /**
          * @brief Execute non-SELECT query (INSERT, UPDATE, DELETE)
          * @param sql SQL query string
@@ -204,9 +211,10 @@ class MySQLConnection : public SqlConnection
          * @param pFields Output field array pointer
          * @param pRowCount Output row count
          * @param pFieldCount Output field count
+         * @param stream Leave the rows on the server (mysql_use_result); the row count is then 0
          * @return True on success, false on failure
          */
-        bool _Query(const char* sql, MYSQL_RES** pResult, MYSQL_FIELD** pFields, uint64* pRowCount, uint32* pFieldCount);
+        bool _Query(const char* sql, MYSQL_RES** pResult, MYSQL_FIELD** pFields, uint64* pRowCount, uint32* pFieldCount, bool stream = false);
 
         MYSQL* mMysql; /**< MySQL connection handle */
 };
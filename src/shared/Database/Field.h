@@ -54,14 +54,14 @@ class Field
         /**
          * @brief Default constructor - creates NULL field
          */
-        Field() : mValue(NULL), mType(MYSQL_TYPE_NULL) {}
+        Field() : mValue(NULL), mLength(UNKNOWN_LENGTH), mType(MYSQL_TYPE_NULL) {}
 
         /**
          * @brief Constructor with value and type
          * @param value Pointer to string value
          * @param type MySQL field type
          */
-        Field(const char* value, enum_field_types type) : mValue(value), mType(type) {}
+        Field(const char* value, enum_field_types type) : mValue(value), mLength(UNKNOWN_LENGTH), mType(type) {}
 
         /**
          * @brief Destructor
@@ -86,6 +86,23 @@ class Field
          */
         const char* GetString() const { return mValue; }
 
+        /**
+         * @brief Get the length of the raw value in bytes
+         *
+         * Binary columns may hold NULs, so this is the length the DBMS
+         * reported; strlen() only stands in when none was set.
+         *
+         * @return Value length (0 if NULL)
+         */
+        size_t GetLength() const
+        {
+            if (!mValue)
+            {
+                return 0;
+            }
+            return mLength != UNKNOWN_LENGTH ? mLength : strlen(mValue);
+        }
+
         /**
          * @brief Get C++ string value
          * @return String value (empty if NULL)
@@ -197,7 +214,15 @@ class Field
          *
          * @param value Pointer to string value
          */
-        void SetValue(const char* value) { mValue = value; }
+        void SetValue(const char* value) { mValue = value; mLength = UNKNOWN_LENGTH; }
+
+        /**
+         * @brief Set the field value along with its length in bytes
+         *
+         * @param value Pointer to value, may hold NULs
+         * @param length Length of @p value
+         */
+        void SetValue(const char* value, size_t length) { mValue = value; mLength = length; }
 
     private:
         /**
@@ -210,7 +235,10 @@ class Field
          */
         Field& operator=(Field const&);
 
+        static size_t const UNKNOWN_LENGTH = size_t(-1);
+
         const char* mValue; /**< Pointer to field value string */
+        size_t mLength; /**< Length of mValue, UNKNOWN_LENGTH when not given */
         enum_field_types mType; /**< MySQL field type */
 };
 #endif
@@ -47,6 +47,8 @@
  * @param fields MySQL field metadata array
  * @param rowCount Number of rows in result set
  * @param fieldCount Number of fields per row
+ * @param stream Connection a streamed (mysql_use_result) result holds, NULL for a stored one
+ * @param mysql MySQL handle of @p stream
  *
  * Initializes the query result with MySQL data. Creates a Field array
  * for the current row and sets up field type information for proper
@@ -54,8 +56,9 @@
  *
  * @note The MYSQL_RES* ownership is transferred to this object
  */
-QueryResultMysql::QueryResultMysql(MYSQL_RES* result, MYSQL_FIELD* fields, uint64 rowCount, uint32 fieldCount)
-    : QueryResult(rowCount, fieldCount), mResult(result)
+QueryResultMysql::QueryResultMysql(MYSQL_RES* result, MYSQL_FIELD* fields, uint64 rowCount, uint32 fieldCount,
+                                   SqlConnection* stream, MYSQL* mysql)
+    : QueryResult(rowCount, fieldCount), mResult(result), mStream(stream), mStreamMysql(mysql)
 {
     mCurrentRow = new Field[mFieldCount];
     MANGOS_ASSERT(mCurrentRow);
@@ -100,13 +103,19 @@ bool QueryResultMysql::NextRow()
     row = mysql_fetch_row(mResult);
     if (!row)
     {
+        // a stored result can't fail here, a streamed one can lose its connection
+        if (mStream && mysql_errno(mStreamMysql))
+        {
+            sLog.outErrorDb("query ERROR while streaming rows: %s", mysql_error(mStreamMysql));
+        }
         EndQuery();
         return false;
     }
 
+    unsigned long const* lengths = mysql_fetch_lengths(mResult);
     for (uint32 i = 0; i < mFieldCount; ++i)
     {
-        mCurrentRow[i].SetValue(row[i]);
+        mCurrentRow[i].SetValue(row[i], lengths[i]);
     }
 
     return true;
@@ -118,6 +127,7 @@ bool QueryResultMysql::NextRow()
  * Frees all memory associated with this query result:
  * - Deletes the Field array for current row
  * - Frees the MySQL result structure with mysql_free_result()
+ * - Releases the connection a streamed result holds
  *
  * Called automatically by destructor and NextRow() when done.
  * Safe to call multiple times (idempotent).
@@ -129,9 +139,16 @@ void QueryResultMysql::EndQuery()
 
     if (mResult)
     {
+        // for a stream this also reads and drops the rows not fetched yet
         mysql_free_result(mResult);
         mResult = 0;
     }
+
+    if (mStream)
+    {
+        mStream->EndStream();
+        mStream = NULL;
+    }
 }
 
 /**
@@ -35,6 +35,8 @@
 
 #include <mysql.h>
 
+class SqlConnection;
+
 /**
  * @brief
  *
@@ -49,8 +51,11 @@ class QueryResultMysql : public QueryResult
          * @param fields
          * @param rowCount
          * @param fieldCount
+         * @param stream the connection an unbuffered @p result is read from, kept until EndQuery()
+         * @param mysql the handle of @p stream, for errors in the middle of the rows
          */
-        QueryResultMysql(MYSQL_RES* result, MYSQL_FIELD* fields, uint64 rowCount, uint32 fieldCount);
+        QueryResultMysql(MYSQL_RES* result, MYSQL_FIELD* fields, uint64 rowCount, uint32 fieldCount,
+                         SqlConnection* stream = NULL, MYSQL* mysql = NULL);
 
         /**
          * @brief
@@ -81,6 +86,8 @@ class QueryResultMysql : public QueryResult
         void EndQuery();
 
         MYSQL_RES* mResult; /**< TODO */
+        SqlConnection* mStream; /**< connection held by a streamed result */
+        MYSQL* mStreamMysql; /**< TODO */
 };
 #endif
 
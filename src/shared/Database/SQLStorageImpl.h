@@ -303,7 +303,8 @@ void SQLStorageLoaderBase<DerivedLoader, StorageClass>::Load(StorageClass& store
         delete result;
     }
 
-    result = WorldDatabase.PQuery("SELECT * FROM `%s`", store.GetTableName());
+    std::string const selectAll = std::string("SELECT * FROM `") + store.GetTableName() + "`";
+    result = WorldDatabase.QuerySnapshot(selectAll.c_str(), store.GetTableName());
 
     if (!result)
     {
@@ -30,6 +30,9 @@
  * processing of SQL operations. This allows the main thread to queue
  * non-blocking SQL operations that will be executed asynchronously,
  * improving server responsiveness.
+ *
+ * A Database may run several delay threads (see <X>DatabaseAsyncShards); they
+ * then share one SqlShardGate which keeps keyed and unkeyed work in order.
  */
 
 #include "Database/SqlDelayThread.h"
@@ -37,17 +40,39 @@
 #include "DatabaseEnv.h"
 #include "Timer.h"
 
+#include <algorithm>
+#include <chrono>
+
+static uint64 NowUs()
+{
+    return uint64(std::chrono::duration_cast<std::chrono::microseconds>(
+                      std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+void SqlShardGate::Halt()
+{
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+        m_halting = true;
+    }
+    m_completedCv.notify_all();
+}
+
 /**
  * @brief Constructor for SqlDelayThread
  * @param db Pointer to the Database engine
  * @param conn Pointer to the SqlConnection for this thread
+ * @param gate Ordering gate shared by every shard of @p db, NULL when unsharded
+ * @param shard Index of this thread's shard, 0 for the unkeyed one
  *
  * Initializes the delay thread with the database connection it will use
  * for executing queued operations. The thread starts in running state
  * but doesn't begin execution until run() is called.
  */
-SqlDelayThread::SqlDelayThread(Database* db, SqlConnection* conn) : m_dbEngine(db), m_dbConnection(conn), m_running(true)
+SqlDelayThread::SqlDelayThread(Database* db, SqlConnection* conn, SqlShardGate* gate, uint32 shard)
+    : m_dbEngine(db), m_dbConnection(conn), m_gate(gate), m_shard(shard), m_running(true)
 {
+    m_stats.shard = shard;
 }
 
 /**
@@ -56,6 +81,8 @@ SqlDelayThread::SqlDelayThread(Database* db, SqlConnection* conn) : m_dbEngine(d
  * Processes any remaining queued requests before destruction.
  * This ensures that no SQL operations are lost when the thread
  * is destroyed, even if they were queued during shutdown.
+ * Sharded databases drain their queues in Database::HaltDelayThread()
+ * first, since only there the global order across shards is known.
  */
 SqlDelayThread::~SqlDelayThread()
 {
@@ -67,13 +94,10 @@ SqlDelayThread::~SqlDelayThread()
  * @brief Main execution loop for the delay thread
  *
  * The thread runs in a loop until stopped:
- * 1. Sleeps for a short interval (10ms) to prevent CPU spinning
+ * 1. Waits until an operation is queued (or the ping interval is due)
  * 2. Processes any queued SQL requests
  * 3. Periodically pings the database to keep the connection alive
  *
- * The loop interval and ping frequency are calculated based on the
- * database's configured ping interval.
- *
  * @note This method is called when the thread starts. It should not
  * be called directly - use MaNGOS::Thread::Start() instead.
  */
@@ -84,32 +108,44 @@ void SqlDelayThread::run()
     mysql_thread_init();
 #endif
 
-    const uint32 loopSleepms = 10; /**< Sleep interval between processing cycles in milliseconds */
+    SqlProfiler::SetThreadCaller(SQL_CALLER_ASYNC);
 
-    // Calculate how many loops to run before sending a ping
-    // This keeps the database connection alive
-    const uint32 pingEveryLoop = m_dbEngine->GetPingIntervall() / loopSleepms;
+    const uint32 pingIntervalms = std::max(m_dbEngine->GetPingIntervall(), uint32(1000));
+    uint32 lastPing = getMSTime();
 
-    uint32 loopCounter = 0;
     while (m_running)
     {
-        // if the running state gets turned off while sleeping
-        // empty the queue before exiting
-        MaNGOS::Thread::Sleep(loopSleepms);
+        {
+            // Delay() wakes us up at once, the timeout only keeps the ping going
+            std::unique_lock<std::mutex> lock(m_queueLock);
+            m_queueCv.wait_for(lock, std::chrono::milliseconds(pingIntervalms), [this]()
+            {
+                return !m_sqlQueue.empty() || !m_running;
+            });
+        }
 
         uint32 start = getMSTime();
         ProcessRequests();
         uint32 elapsed = getMSTimeDiff(start, getMSTime());
         if (elapsed > 5000)
         {
-            sLog.outError("SqlDelayThread: ProcessRequests took %u ms", elapsed);
+            sLog.outError("SqlDelayThread: ProcessRequests took %u ms on shard %u", elapsed, m_shard);
         }
 
         // Send periodic ping to keep connection alive
-        if ((loopCounter++) >= pingEveryLoop)
+        if (getMSTimeDiff(lastPing, getMSTime()) >= pingIntervalms)
         {
-            loopCounter = 0;
-            m_dbEngine->Ping();
+            lastPing = getMSTime();
+            if (m_shard == 0)
+            {
+                m_dbEngine->Ping();
+            }
+            else
+            {
+                // the unkeyed shard pings the shared connections, keyed shards their own only
+                SqlConnection::Lock guard(m_dbConnection);
+                delete guard->Query("SELECT 1");
+            }
         }
     }
 
@@ -123,38 +159,180 @@ void SqlDelayThread::run()
 /**
  * @brief Signal the thread to stop running
  *
- * Sets the running flag to false, which will cause the main loop
- * to exit after the current sleep cycle. The thread will process
- * any remaining queued operations before terminating.
- *
- * This is a graceful shutdown mechanism - the thread will not
- * terminate immediately but will finish its current operations.
+ * Sets the running flag to false and wakes the thread, which will cause
+ * the main loop to exit after the current batch. Remaining operations are
+ * executed by the destructor (or by Database::HaltDelayThread() when sharded).
  */
 void SqlDelayThread::Stop()
 {
-    m_running = false;
+    {
+        std::lock_guard<std::mutex> guard(m_queueLock);
+        m_running = false;
+    }
+    m_queueCv.notify_all();
 }
 
 /**
- * @brief Process all queued SQL operations
+ * @brief Queue an operation for this thread
  *
- * Dequeues and executes all pending SQL operations from the queue.
- * Each operation is executed using the thread's database connection,
- * then deleted. This method processes the entire queue before returning.
+ * With a gate the operation is stamped, under the gate lock, with a global
+ * sequence number and the sequences it has to wait for: everything queued
+ * before it on the keyed shards if this is the unkeyed shard, everything
+ * queued before it on the unkeyed shard otherwise.
+ */
+bool SqlDelayThread::Delay(SqlOperation* sql)
+{
+    Entry entry;
+    entry.op = sql;
+    entry.sequence = 0;
+    entry.enqueuedUs = NowUs();
+
+    if (m_gate)
+    {
+        // the gate lock is held across the push so every shard queue stays in sequence order
+        std::lock_guard<std::mutex> gateGuard(m_gate->m_lock);
+        entry.sequence = ++m_gate->m_sequence;
+        if (m_shard == 0)
+        {
+            entry.waitFor = m_gate->m_submitted;
+            entry.waitFor[0] = 0;
+        }
+        else
+        {
+            entry.waitFor.assign(m_gate->m_submitted.size(), 0);
+            entry.waitFor[0] = m_gate->m_submitted[0];
+        }
+        m_gate->m_submitted[m_shard] = entry.sequence;
+
+        std::lock_guard<std::mutex> guard(m_queueLock);
+        m_sqlQueue.push_back(entry);
+    }
+    else
+    {
+        std::lock_guard<std::mutex> guard(m_queueLock);
+        m_sqlQueue.push_back(entry);
+    }
+
+    m_queueCv.notify_one();
+    return true;
+}
+
+bool SqlDelayThread::WaitForDependencies(Entry const& entry)
+{
+    std::unique_lock<std::mutex> lock(m_gate->m_lock);
+    auto ready = [this, &entry]()
+    {
+        for (size_t i = 0; i < entry.waitFor.size(); ++i)
+        {
+            if (m_gate->m_completed[i] < entry.waitFor[i])
+            {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    m_gate->m_completedCv.wait(lock, [this, &ready]() { return m_gate->m_halting || ready(); });
+    return ready();
+}
+
+void SqlDelayThread::ExecuteEntry(Entry const& entry)
+{
+    uint64 const start = NowUs();
+    entry.op->Execute(m_dbConnection);
+    delete entry.op;
+    uint64 const end = NowUs();
+
+    if (m_gate)
+    {
+        {
+            std::lock_guard<std::mutex> guard(m_gate->m_lock);
+            m_gate->m_completed[m_shard] = entry.sequence;
+        }
+        m_gate->m_completedCv.notify_all();
+    }
+
+    std::lock_guard<std::mutex> guard(m_statsLock);
+    ++m_stats.executed;
+    m_stats.totalWaitUs += start - entry.enqueuedUs;
+    m_stats.totalExecUs += end - start;
+    m_stats.maxLatencyUs = std::max(m_stats.maxLatencyUs, end - entry.enqueuedUs);
+}
+
+/**
+ * @brief Process all queued SQL operations
  *
- * This is thread-safe as it uses the queue's internal synchronization
- * mechanisms. Multiple threads can safely enqueue operations while
- * this thread processes them.
+ * Executes the queued operations in order on the thread's database
+ * connection, then deletes them. An operation stays at the front of the
+ * queue until it has run, so a stopped shard keeps whatever it could not
+ * execute for Database::HaltDelayThread() to drain.
  *
  * @note This method should only be called from the delay thread itself
  * or during thread shutdown in the destructor.
  */
-void SqlDelayThread::ProcessRequests()
+bool SqlDelayThread::ProcessRequests()
+{
+    for (;;)
+    {
+        Entry entry;
+        {
+            std::lock_guard<std::mutex> guard(m_queueLock);
+            if (m_sqlQueue.empty())
+            {
+                return true;
+            }
+            entry = m_sqlQueue.front();
+        }
+
+        if (m_gate && !WaitForDependencies(entry))
+        {
+            return false;
+        }
+
+        ExecuteEntry(entry);
+
+        std::lock_guard<std::mutex> guard(m_queueLock);
+        m_sqlQueue.pop_front();
+    }
+}
+
+bool SqlDelayThread::PeekSequence(uint64& sequence)
 {
-    SqlOperation* s = NULL;
-    while (m_sqlQueue.next(s))
+    std::lock_guard<std::mutex> guard(m_queueLock);
+    if (m_sqlQueue.empty())
     {
-        s->Execute(m_dbConnection);
-        delete s;
+        return false;
     }
+
+    sequence = m_sqlQueue.front().sequence;
+    return true;
+}
+
+void SqlDelayThread::ExecuteNext()
+{
+    Entry entry;
+    {
+        std::lock_guard<std::mutex> guard(m_queueLock);
+        if (m_sqlQueue.empty())
+        {
+            return;
+        }
+        entry = m_sqlQueue.front();
+        m_sqlQueue.pop_front();
+    }
+
+    ExecuteEntry(entry);
+}
+
+SqlDelayStats SqlDelayThread::GetStats()
+{
+    SqlDelayStats stats;
+    {
+        std::lock_guard<std::mutex> guard(m_statsLock);
+        stats = m_stats;
+    }
+
+    std::lock_guard<std::mutex> guard(m_queueLock);
+    stats.queued = m_sqlQueue.size();
+    return stats;
 }
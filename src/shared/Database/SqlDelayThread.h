@@ -25,13 +25,70 @@
 #ifndef MANGOS_H_SQLDELAYTHREAD
 #define MANGOS_H_SQLDELAYTHREAD
 
-#include "LockedQueue/LockedQueue.h"
+#include "Common/Common.h"
 #include "Threading/Threading.h"
 
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <vector>
+
 class Database;
 class SqlOperation;
 class SqlConnection;
 
+/**
+ * @brief Orders the async shards of one Database.
+ *
+ * Shard 0 carries every operation queued without a shard key and keeps the
+ * historical single-thread FIFO semantics: it runs an operation only after every
+ * keyed shard has finished what was queued before it. A keyed shard in turn runs
+ * an operation only after shard 0 has finished what was queued before it, so two
+ * keyed operations are reordered only when their keys differ.
+ */
+class SqlShardGate
+{
+        friend class SqlDelayThread;
+
+    public:
+        /**
+         * @brief
+         *
+         * @param shardCount shard 0 plus the keyed shards
+         */
+        explicit SqlShardGate(uint32 shardCount)
+            : m_sequence(0), m_submitted(shardCount, 0), m_completed(shardCount, 0), m_halting(false) {}
+
+        /**
+         * @brief Wake every shard blocked on an ordering dependency so it can stop.
+         *
+         */
+        void Halt();
+
+    private:
+        std::mutex m_lock;
+        std::condition_variable m_completedCv;
+        uint64 m_sequence;                                  /**< last sequence handed out */
+        std::vector<uint64> m_submitted;                    /**< per shard: sequence of its newest queued operation */
+        std::vector<uint64> m_completed;                    /**< per shard: sequence of its newest finished operation */
+        bool m_halting;
+};
+
+/**
+ * @brief Queue-depth and latency gauges of one async shard.
+ *
+ */
+struct SqlDelayStats
+{
+    uint32 shard = 0;
+    uint64 queued = 0;                                      /**< operations waiting right now */
+    uint64 executed = 0;                                    /**< operations finished since startup */
+    uint64 totalWaitUs = 0;                                 /**< time spent queued, summed */
+    uint64 totalExecUs = 0;                                 /**< time spent executing, summed */
+    uint64 maxLatencyUs = 0;                                /**< worst queue-to-finish time */
+};
+
 /**
  * @brief
  *
@@ -39,22 +96,45 @@ class SqlConnection;
 class SqlDelayThread : public MaNGOS::Runnable
 {
     /**
-     * @brief
+     * @brief One queued operation with its ordering stamp
      *
      */
-    typedef MaNGOS::LockedQueue<SqlOperation*> SqlQueue;
+    struct Entry
+    {
+        SqlOperation* op;
+        uint64 sequence;
+        std::vector<uint64> waitFor;                        /**< per shard: sequence that must complete first */
+        uint64 enqueuedUs;
+    };
 
     private:
-        SqlQueue m_sqlQueue;                                /**< Queue of SQL statements */
+        std::mutex m_queueLock;
+        std::condition_variable m_queueCv;                  /**< signalled by Delay() and Stop() */
+        std::deque<Entry> m_sqlQueue;                       /**< Queue of SQL statements */
         Database* m_dbEngine;                               /**< Pointer to used Database engine */
         SqlConnection* m_dbConnection;                      /**< Pointer to DB connection */
-        volatile bool m_running; /**< TODO */
+        SqlShardGate* m_gate;                               /**< NULL when the database has a single async thread */
+        uint32 m_shard;
+        std::atomic<bool> m_running;
+
+        mutable std::mutex m_statsLock;
+        SqlDelayStats m_stats;
 
         /**
          * @brief process all enqueued requests
          *
+         * @return bool false if stopped while an ordering dependency was still pending
+         */
+        bool ProcessRequests();
+
+        /**
+         * @brief Block until every operation @p entry depends on has finished
+         *
+         * @return bool false when the gate is halting first
          */
-        void ProcessRequests();
+        bool WaitForDependencies(Entry const& entry);
+
+        void ExecuteEntry(Entry const& entry);
 
     public:
         /**
@@ -62,8 +142,10 @@ class SqlDelayThread : public MaNGOS::Runnable
          *
          * @param db
          * @param conn
+         * @param gate shared by all shards of @p db, or NULL
+         * @param shard index of this thread's shard
          */
-        SqlDelayThread(Database* db, SqlConnection* conn);
+        SqlDelayThread(Database* db, SqlConnection* conn, SqlShardGate* gate = NULL, uint32 shard = 0);
 
         /**
          * @brief
@@ -77,20 +159,36 @@ class SqlDelayThread : public MaNGOS::Runnable
          * @param sql
          * @return bool
          */
-        bool Delay(SqlOperation* sql) { m_sqlQueue.add(sql); return true; }
+        bool Delay(SqlOperation* sql);
 
         /**
          * @brief Whether the worker loop is still running (not yet stopped)
          *
          * Used by Database::CommitTransactionChecked() to avoid enqueuing a
          * blocking transaction onto a thread that will never drain it (which
-         * would block the caller forever). m_running is a volatile bool toggled
-         * only by Stop(); this best-effort cross-thread read is sufficient for a
-         * pure shutdown gate (we only ever transition true -> false).
+         * would block the caller forever). Only ever transitions true -> false,
+         * in Stop().
          *
          * @return bool true while the thread loop is running
          */
-        bool IsRunning() const { return m_running; }
+        bool IsRunning() const { return m_running.load(); }
+
+        /**
+         * @brief Sequence of the oldest queued operation, for draining shards in order
+         *
+         * @param sequence
+         * @return bool false if the queue is empty
+         */
+        bool PeekSequence(uint64& sequence);
+
+        /**
+         * @brief Execute the oldest queued operation on the calling thread
+         *
+         * Only for shutdown, once the worker has stopped.
+         */
+        void ExecuteNext();
+
+        SqlDelayStats GetStats();
 
         /**
          * @brief Stop event
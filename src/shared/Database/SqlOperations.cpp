@@ -41,6 +41,7 @@
 #include "SqlDelayThread.h"
 #include "DatabaseEnv.h"
 #include "DatabaseImpl.h"
+#include <algorithm>
 #include <cstdarg>
 
 /**
@@ -119,12 +120,30 @@ bool SqlTransaction::Execute(SqlConnection* conn)
         return false;
     }
 
-    const int nItems = m_queue.size();
-    for (int i = 0; i < nItems; ++i)
+    uint32 const batchRows = conn->DB().GetBatchRows();
+    const size_t nItems = m_queue.size();
+    for (size_t i = 0; i < nItems;)
     {
-        SqlOperation* pStmt = m_queue[i];
+        // a run of the same prepared statement goes out as multi-row statements
+        size_t last = i + 1;
+        SqlPreparedRequest const* pFirst = batchRows > 1 ? dynamic_cast<SqlPreparedRequest const*>(m_queue[i]) : NULL;
+        if (pFirst)
+        {
+            while (last < nItems)
+            {
+                SqlPreparedRequest const* pNext = dynamic_cast<SqlPreparedRequest const*>(m_queue[last]);
+                if (!pNext || pNext->GetIndex() != pFirst->GetIndex())
+                {
+                    break;
+                }
+                ++last;
+            }
+        }
+
+        bool const ok = last - i > 1 ? ExecuteBatched(conn, i, last) : m_queue[i]->Execute(conn);
+        i = last;
 
-        if (!pStmt->Execute(conn))
+        if (!ok)
         {
             /// a failed rollback leaves the connection in an unknown
             /// transaction state - never swallow it silently
@@ -139,6 +158,98 @@ bool SqlTransaction::Execute(SqlConnection* conn)
     return conn->CommitTransaction();
 }
 
+/**
+ * @brief Execute a run of one prepared statement as multi-row statements
+ * @param conn The database connection to use, already locked
+ * @param first First queued execution of the run
+ * @param last One past the last queued execution of the run
+ * @return true if every row was written, false otherwise
+ *
+ * A save queues one INSERT per inventory item, spell, quest... Folding those
+ * into "VALUES (...),(...)" or "WHERE guid IN (...)" chunks of at most
+ * DatabaseBatchRows rows turns a round trip per row into one per chunk. The
+ * rows keep their queue order, and as the whole run sits inside the
+ * transaction a failing chunk rolls back exactly what a failing row would.
+ * Statements without a batchable shape run a row at a time.
+ *
+ * Every chunk size is a server-side prepared statement on each connection,
+ * counted against max_prepared_stmt_count, so chunks only come in
+ * DatabaseBatchRows, 16 and 4 rows; a remainder under 4 goes row by row.
+ */
+bool SqlTransaction::ExecuteBatched(SqlConnection* conn, size_t first, size_t last)
+{
+    Database& db = conn->DB();
+    SqlPreparedRequest const* pFirst = static_cast<SqlPreparedRequest const*>(m_queue[first]);
+    uint32 const rowParams = pFirst->GetParams().boundParams();
+
+    // keep a chunk within the 65535 placeholders a server-side prepared statement takes
+    uint32 maxRows = db.GetBatchRows();
+    if (rowParams && maxRows > 65535 / rowParams)
+    {
+        maxRows = 65535 / rowParams;
+    }
+
+    while (first < last)
+    {
+        size_t const remaining = last - first;
+        uint32 rows = 1;
+        if (remaining >= maxRows)
+        {
+            rows = maxRows;
+        }
+        else if (remaining >= 16 && maxRows > 16)
+        {
+            rows = 16;
+        }
+        else if (remaining >= 4 && maxRows > 4)
+        {
+            rows = 4;
+        }
+
+        if (rows == 1)
+        {
+            if (!m_queue[first]->Execute(conn))
+            {
+                return false;
+            }
+            ++first;
+            continue;
+        }
+
+        int const batchId = db.GetBatchStmtId(pFirst->GetIndex(), rows);
+        if (batchId == -1)
+        {
+            for (; first < last; ++first)
+            {
+                if (!m_queue[first]->Execute(conn))
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        SqlStmtParameters params(rows * rowParams);
+        for (uint32 row = 0; row < rows; ++row)
+        {
+            SqlStmtParameters::ParameterContainer const& rowData =
+                static_cast<SqlPreparedRequest const*>(m_queue[first + row])->GetParams().params();
+            for (SqlStmtParameters::ParameterContainer::const_iterator iter = rowData.begin(); iter != rowData.end(); ++iter)
+            {
+                params.addParam(*iter);
+            }
+        }
+
+        if (!conn->ExecuteStmt(batchId, params))
+        {
+            return false;
+        }
+        first += rows;
+    }
+
+    return true;
+}
+
 /**
  * @brief Execute the wrapped transaction and signal its result to the caller
  * @param conn The database connection to use
@@ -183,6 +294,31 @@ bool SqlTransactionResultSignal::Execute(SqlConnection* conn)
     return ok;
 }
 
+/**
+ * @brief Run the wrapped transaction and publish its outcome
+ * @param conn Database connection to use
+ * @return true if the transaction committed
+ */
+bool SqlTransactionStatusSignal::Execute(SqlConnection* conn)
+{
+    bool ok = false;
+    try
+    {
+        ok = m_trans->Execute(conn);
+    }
+    catch (std::exception& e)
+    {
+        sLog.outError("CommitTransaction: exception during transaction execute: %s", e.what());
+    }
+    catch (...)
+    {
+        sLog.outError("CommitTransaction: unknown exception during transaction execute");
+    }
+
+    m_status->state.store(ok ? SqlCommitStatus::COMMITTED : SqlCommitStatus::FAILED, std::memory_order_release);
+    return ok;
+}
+
 /**
  * @brief Constructor for SqlPreparedRequest
  * @param nIndex Index of the prepared statement
@@ -250,6 +386,24 @@ bool SqlQuery::Execute(SqlConnection* conn)
     return true;
 }
 
+/**
+ * @brief Execute a query for a SqlQueryFuture
+ *
+ * Runs on the async thread. The result is published to the handles last,
+ * so a caller seeing the future ready also sees the result.
+ *
+ * @param conn The database connection to use for execution
+ * @return true
+ */
+bool SqlFutureQuery::Execute(SqlConnection* conn)
+{
+    LOCK_DB_CONN(conn);
+    m_state->result = conn->Query(m_sql);
+    m_state->ready.store(true, std::memory_order_release);
+
+    return true;
+}
+
 /**
  * @brief Process pending query callbacks
  *
@@ -31,6 +31,7 @@
 #include <queue>
 #include <future>
 #include "Utilities/Callback.h"
+#include "Database/SqlQueryFuture.h"
 
 /// ---- BASE ---
 
@@ -116,6 +117,17 @@ class SqlTransaction : public SqlOperation
     private:
         std::vector<SqlOperation* > m_queue; /**< TODO */
 
+        /**
+         * @brief run m_queue[first, last) - executions of one prepared statement -
+         *        as multi-row statements when the statement allows it
+         *
+         * @param conn
+         * @param first
+         * @param last
+         * @return bool
+         */
+        bool ExecuteBatched(SqlConnection* conn, size_t first, size_t last);
+
     public:
         /**
          * @brief
@@ -136,6 +148,13 @@ class SqlTransaction : public SqlOperation
          */
         void DelayExecute(SqlOperation* sql) { m_queue.push_back(sql); }
 
+        /**
+         * @brief number of statements queued so far
+         *
+         * @return size_t
+         */
+        size_t Size() const { return m_queue.size(); }
+
         /**
          * @brief
          *
@@ -186,6 +205,52 @@ class SqlTransactionResultSignal : public SqlOperation
         bool Execute(SqlConnection* conn) override;
 };
 
+/**
+ * @brief Outcome of a transaction queued by Database::CommitTransaction(status),
+ *        published by the delay thread for a caller that polls instead of blocking.
+ */
+struct SqlCommitStatus
+{
+    enum State { PENDING, COMMITTED, FAILED };
+
+    std::atomic<uint8> state;
+
+    SqlCommitStatus() : state(PENDING) {}
+
+    /// Never blocks.
+    State Get() const { return State(state.load(std::memory_order_acquire)); }
+};
+
+/**
+ * @brief Runs a SqlTransaction and records whether it committed in a shared
+ *        SqlCommitStatus, which outlives this op for as long as the caller holds it.
+ */
+class SqlTransactionStatusSignal : public SqlOperation
+{
+    private:
+        SqlTransaction* m_trans;                        ///< owned wrapped transaction
+        std::shared_ptr<SqlCommitStatus> m_status;      ///< shared with the caller
+    public:
+        /**
+         * @brief
+         *
+         * @param trans transaction detached from the TSS slot (this op owns it)
+         * @param status
+         */
+        SqlTransactionStatusSignal(SqlTransaction* trans, std::shared_ptr<SqlCommitStatus> const& status)
+            : m_trans(trans), m_status(status) {}
+
+        ~SqlTransactionStatusSignal() { delete m_trans; }
+
+        /**
+         * @brief
+         *
+         * @param conn
+         * @return bool
+         */
+        bool Execute(SqlConnection* conn) override;
+};
+
 /**
  * @brief
  *
@@ -215,6 +280,9 @@ class SqlPreparedRequest : public SqlOperation
          */
         bool Execute(SqlConnection* conn) override;
 
+        int GetIndex() const { return m_nIndex; }
+        SqlStmtParameters const& GetParams() const { return *m_param; }
+
     private:
         const int m_nIndex; /**< TODO */
         SqlStmtParameters* m_param; /**< TODO */
@@ -288,6 +356,45 @@ class SqlQuery : public SqlOperation
         bool Execute(SqlConnection* conn) override;
 };
 
+/**
+ * @brief A single async query whose result is collected through a SqlQueryFuture
+ *
+ * Unlike SqlQuery nothing is queued back: the caller polls the future.
+ */
+class SqlFutureQuery : public SqlOperation
+{
+    private:
+        const char* m_sql; /**< TODO */
+        std::shared_ptr<SqlQueryFuture::State> m_state; /**< shared with the caller's handles */
+    public:
+        /**
+         * @brief
+         *
+         * @param sql
+         * @param state
+         */
+        SqlFutureQuery(const char* sql, std::shared_ptr<SqlQueryFuture::State> const& state)
+            : m_sql(mangos_strdup(sql)), m_state(state) {}
+
+        /**
+         * @brief
+         *
+         */
+        ~SqlFutureQuery()
+        {
+            char* tofree = const_cast<char*>(m_sql);
+            delete[] tofree;
+        }
+
+        /**
+         * @brief
+         *
+         * @param conn
+         * @return bool
+         */
+        bool Execute(SqlConnection* conn) override;
+};
+
 /**
  * @brief
  *
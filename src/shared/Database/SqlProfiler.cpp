@@ -0,0 +1,257 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2025 MaNGOS <https://www.getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+#include "SqlProfiler.h"
+#include "Log.h"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstring>
+
+static char const* const s_callerNames[SQL_CALLER_COUNT] = { "sync", "world thread sync", "async", "map thread sync" };
+
+static thread_local SqlCaller t_caller = SQL_CALLER_SYNC;
+
+namespace
+{
+    bool IsWordChar(char c)
+    {
+        return isalnum(uint8(c)) || c == '_' || c == '$';
+    }
+
+    /// Drops the last "?, " of @p out when another value follows it.
+    bool FoldValue(std::string& out)
+    {
+        size_t end = out.size();
+        while (end && out[end - 1] == ' ')
+        {
+            --end;
+        }
+        if (end < 2 || out[end - 1] != ',')
+        {
+            return false;
+        }
+
+        size_t value = end - 1;
+        while (value && out[value - 1] == ' ')
+        {
+            --value;
+        }
+        if (!value || out[value - 1] != '?')
+        {
+            return false;
+        }
+
+        out.resize(value);
+        return true;
+    }
+
+    /// Folds "(?), (?)" into "(?)", for multi-row VALUES.
+    void FoldGroups(std::string& out)
+    {
+        static std::string const repeats[] = { "(?), (?)", "(?),(?)" };
+        for (std::string const& repeat : repeats)
+        {
+            size_t pos;
+            while ((pos = out.find(repeat)) != std::string::npos)
+            {
+                out.erase(pos + 3, repeat.size() - 3);
+            }
+        }
+    }
+}
+
+SqlProfiler::SqlProfiler()
+    : m_enabled(false), m_slowQueryUs(0), m_since(time(NULL))
+{
+}
+
+void SqlProfiler::Configure(bool enabled, uint32 slowQueryMs)
+{
+    if (enabled && !IsEnabled())
+    {
+        Reset();
+    }
+
+    m_enabled.store(enabled, std::memory_order_relaxed);
+    m_slowQueryUs.store(uint64(slowQueryMs) * 1000, std::memory_order_relaxed);
+}
+
+void SqlProfiler::SetThreadCaller(SqlCaller caller)
+{
+    t_caller = caller;
+}
+
+SqlCaller SqlProfiler::GetThreadCaller()
+{
+    return t_caller;
+}
+
+uint64 SqlProfiler::NowUs()
+{
+    return uint64(std::chrono::duration_cast<std::chrono::microseconds>(
+                      std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+std::string SqlProfiler::Normalize(char const* sql)
+{
+    std::string out;
+    out.reserve(strlen(sql));
+
+    for (char const* p = sql; *p;)
+    {
+        char const c = *p;
+        if (c == '\'' || c == '"')
+        {
+            // a string literal; both backslash and doubled quotes escape
+            ++p;
+            while (*p)
+            {
+                if (*p == '\\' && p[1])
+                {
+                    p += 2;
+                }
+                else if (*p == c && p[1] == c)
+                {
+                    p += 2;
+                }
+                else if (*p == c)
+                {
+                    ++p;
+                    break;
+                }
+                else
+                {
+                    ++p;
+                }
+            }
+        }
+        else if (isdigit(uint8(c)) && (out.empty() || !IsWordChar(out.back())))
+        {
+            // a number (hex, decimal, exponent); digits inside a name stay
+            while (isalnum(uint8(*p)) || *p == '.')
+            {
+                ++p;
+            }
+        }
+        else if (c == '?')
+        {
+            ++p;
+        }
+        else if (c == '`')
+        {
+            char const* end = strchr(p + 1, '`');
+            end = end ? end + 1 : p + strlen(p);
+            out.append(p, end);
+            p = end;
+            continue;
+        }
+        else if (isspace(uint8(c)))
+        {
+            while (isspace(uint8(*p)))
+            {
+                ++p;
+            }
+            if (!out.empty() && out.back() != ' ' && *p)
+            {
+                out += ' ';
+            }
+            continue;
+        }
+        else
+        {
+            out += c;
+            ++p;
+            continue;
+        }
+
+        // a value: one '?' for a whole run of them
+        if (!FoldValue(out))
+        {
+            out += '?';
+        }
+    }
+
+    FoldGroups(out);
+    return out;
+}
+
+void SqlProfiler::Record(char const* sql, bool prepared, uint64 rows, uint64 elapsedUs)
+{
+    SqlCaller const caller = t_caller;
+
+    uint64 const slowUs = m_slowQueryUs.load(std::memory_order_relaxed);
+    if (slowUs && elapsedUs >= slowUs)
+    {
+        sLog.outError("SQL: slow %s statement, %u ms, " UI64FMTD " rows: %s",
+                      s_callerNames[caller], uint32(elapsedUs / 1000), rows, sql);
+    }
+
+    if (!IsEnabled())
+    {
+        return;
+    }
+
+    std::string const key = prepared ? std::string(sql) : Normalize(sql);
+    uint32 const elapsed = uint32(std::min<uint64>(elapsedUs, 0xFFFFFFFF));
+
+    std::lock_guard<std::mutex> guard(m_lock);
+    Counter& c = m_counters[key];
+    ++c.calls[caller];
+    c.totalUs[caller] += elapsedUs;
+    c.rows += rows;
+    c.maxUs = std::max(c.maxUs, elapsed);
+}
+
+void SqlProfiler::Reset()
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+    m_counters.clear();
+    m_since = time(NULL);
+}
+
+std::vector<SqlProfiler::Row> SqlProfiler::GetTop(uint32 count) const
+{
+    std::vector<Row> rows;
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+        rows.reserve(m_counters.size());
+        for (std::unordered_map<std::string, Counter>::const_iterator itr = m_counters.begin(); itr != m_counters.end(); ++itr)
+        {
+            rows.push_back(Row{ itr->first, itr->second });
+        }
+    }
+
+    std::sort(rows.begin(), rows.end(), [](Row const& a, Row const& b)
+    {
+        return a.counter.TotalUs() > b.counter.TotalUs();
+    });
+
+    if (count && rows.size() > count)
+    {
+        rows.resize(count);
+    }
+    return rows;
+}
@@ -0,0 +1,132 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2025 MaNGOS <https://www.getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+#ifndef MANGOS_H_SQLPROFILER
+#define MANGOS_H_SQLPROFILER
+
+#include "Common/Common.h"
+
+#include <atomic>
+#include <ctime>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/// Who ran a statement: the caller's thread decides.
+enum SqlCaller
+{
+    SQL_CALLER_SYNC     = 0,                                // any thread waiting on its own query: startup, network
+    SQL_CALLER_WORLD    = 1,                                // a sync query on the world thread, the tick waits for it
+    SQL_CALLER_ASYNC    = 2,                                // an async shard thread
+    SQL_CALLER_MAP      = 3,                                // a map update worker, the tick waits for it too
+    SQL_CALLER_COUNT
+};
+
+/**
+ * @brief Per-statement timing of one database (see DatabaseProfiler.Enable).
+ *
+ * Statements are keyed by their SQL with the literals replaced by '?', so
+ * every PQuery() of one format lands on one row, as does a prepared
+ * statement; runs of values ("?, ?, ?" and "(?), (?)") fold into one, so an
+ * IN list or a multi-row INSERT counts as one statement whatever its length.
+ *
+ * The MySQL layer records each query, execute and prepared statement run;
+ * calls and time are kept apart by SqlCaller. Statements slower than the
+ * slow-query threshold are logged as they finish, enabled or not.
+ */
+class SqlProfiler
+{
+    public:
+        struct Counter
+        {
+            uint64 calls[SQL_CALLER_COUNT] = {};
+            uint64 totalUs[SQL_CALLER_COUNT] = {};
+            uint64 rows = 0;                                ///< returned by queries, affected by the rest
+            uint32 maxUs = 0;
+
+            uint64 Calls() const { return calls[SQL_CALLER_SYNC] + calls[SQL_CALLER_WORLD] + calls[SQL_CALLER_ASYNC] + calls[SQL_CALLER_MAP]; }
+            uint64 TotalUs() const { return totalUs[SQL_CALLER_SYNC] + totalUs[SQL_CALLER_WORLD] + totalUs[SQL_CALLER_ASYNC] + totalUs[SQL_CALLER_MAP]; }
+        };
+
+        struct Row
+        {
+            std::string statement;
+            Counter counter;
+        };
+
+        SqlProfiler();
+
+        /**
+         * @brief
+         *
+         * @param enabled keep the per-statement counters
+         * @param slowQueryMs log statements taking at least this long, 0 for never
+         */
+        void Configure(bool enabled, uint32 slowQueryMs);
+
+        bool IsEnabled() const { return m_enabled.load(std::memory_order_relaxed); }
+
+        /// Whether statements need timing at all: counters or the slow-query log.
+        bool IsTiming() const { return IsEnabled() || m_slowQueryUs.load(std::memory_order_relaxed); }
+
+        /**
+         * @brief Count one statement run on the current thread
+         *
+         * @param sql the SQL as sent, or a prepared statement's format
+         * @param prepared @p sql already has '?' for its values
+         * @param rows
+         * @param elapsedUs
+         */
+        void Record(char const* sql, bool prepared, uint64 rows, uint64 elapsedUs);
+
+        void Reset();
+
+        /// The statements with the most total time first; @p count 0 for all.
+        std::vector<Row> GetTop(uint32 count) const;
+
+        time_t GetSince() const { return m_since; }
+
+        /// Marks what the current thread's statements count as; threads start as SQL_CALLER_SYNC.
+        static void SetThreadCaller(SqlCaller caller);
+        static SqlCaller GetThreadCaller();
+
+        /// Whether @p caller holds up the world tick while it waits on a query.
+        static bool IsTickBound(SqlCaller caller) { return caller == SQL_CALLER_WORLD || caller == SQL_CALLER_MAP; }
+
+        /// @p sql with its literals replaced by '?' and runs of values folded.
+        static std::string Normalize(char const* sql);
+
+        static uint64 NowUs();
+
+    private:
+        std::atomic<bool> m_enabled;
+        std::atomic<uint64> m_slowQueryUs;
+
+        mutable std::mutex m_lock;                          // statements are ms apart per thread: one lock is plenty
+        std::unordered_map<std::string, Counter> m_counters;
+        time_t m_since;
+};
+
+#endif
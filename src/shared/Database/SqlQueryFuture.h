@@ -0,0 +1,110 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2025 MaNGOS <https://www.getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+#ifndef MANGOS_H_SQLQUERYFUTURE
+#define MANGOS_H_SQLQUERYFUTURE
+
+#include "Common/Common.h"
+#include "Database/QueryResult.h"
+
+#include <atomic>
+#include <memory>
+
+/**
+ * @brief Handle to the result of one Database::QueryAsync()
+ *
+ * The query runs on the async thread; the caller polls IsReady() from its
+ * own thread, usually through WorldSession::AddQueryCallback(), and takes
+ * the result once. Copies share the one result. A result nobody took is
+ * freed with the last handle or with the finished operation, whichever
+ * goes last, so dropping the handle early (a session closing) is safe.
+ */
+class SqlQueryFuture
+{
+    public:
+        /// The state shared by the handles and the queued operation.
+        struct State
+        {
+            std::atomic<bool> ready;
+            QueryResult* result;
+
+            State() : ready(false), result(NULL) {}
+            ~State() { delete result; }
+        };
+
+        /**
+         * @brief An empty handle, not valid
+         *
+         */
+        SqlQueryFuture() {}
+
+        /**
+         * @brief A handle to a query not run yet
+         *
+         * @param state
+         */
+        explicit SqlQueryFuture(std::shared_ptr<State> const& state) : m_state(state) {}
+
+        /**
+         * @brief An already finished query
+         *
+         * @param result
+         * @return SqlQueryFuture
+         */
+        static SqlQueryFuture Ready(QueryResult* result)
+        {
+            std::shared_ptr<State> state = std::make_shared<State>();
+            state->result = result;
+            state->ready.store(true, std::memory_order_release);
+            return SqlQueryFuture(state);
+        }
+
+        /// Whether a query is attached; a failed queueing gives an invalid handle.
+        bool IsValid() const { return bool(m_state); }
+
+        /// Whether the query has run; never blocks.
+        bool IsReady() const { return m_state && m_state->ready.load(std::memory_order_acquire); }
+
+        /**
+         * @brief The result of a ready query, the caller deletes it
+         *
+         * @return QueryResult NULL for an empty result, a failed query or when taken already
+         */
+        QueryResult* Take()
+        {
+            if (!IsReady())
+            {
+                return NULL;
+            }
+
+            QueryResult* result = m_state->result;
+            m_state->result = NULL;
+            return result;
+        }
+
+    private:
+        std::shared_ptr<State> m_state;
+};
+
+#endif
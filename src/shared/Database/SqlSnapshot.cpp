@@ -0,0 +1,267 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2025 MaNGOS <https://www.getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+#include "SqlSnapshot.h"
+#include "Log.h"
+
+#include <cstdio>
+#include <cstring>
+
+namespace
+{
+    char const SNAPSHOT_MAGIC[8] = { 'M', 'S', 'N', 'A', 'P', '0', '0', '1' };
+
+    struct SnapshotHeader
+    {
+        char magic[8];
+        uint64 key;
+        uint64 rowCount;
+        uint32 fieldCount;
+        uint32 padding;
+    };
+
+    template<class T>
+    void Append(std::vector<char>& data, T const& value)
+    {
+        char const* bytes = reinterpret_cast<char const*>(&value);
+        data.insert(data.end(), bytes, bytes + sizeof(T));
+    }
+
+    template<class T>
+    bool Read(std::vector<char> const& data, size_t& pos, T& value)
+    {
+        if (data.size() - pos < sizeof(T))
+        {
+            return false;
+        }
+        memcpy(&value, &data[pos], sizeof(T));
+        pos += sizeof(T);
+        return true;
+    }
+
+    // walks every row once, so a truncated or damaged file is refused
+    // instead of replaying as a shorter table
+    bool CheckRows(std::vector<char> const& data, uint64 rowCount, uint32 fieldCount)
+    {
+        size_t pos = 0;
+        uint32 value = 0;
+        for (uint32 i = 0; i < fieldCount; ++i)
+        {
+            if (!Read(data, pos, value))
+            {
+                return false;
+            }
+        }
+
+        for (uint64 row = 0; row < rowCount; ++row)
+        {
+            for (uint32 i = 0; i < fieldCount; ++i)
+            {
+                if (!Read(data, pos, value))
+                {
+                    return false;
+                }
+                if (value == SqlSnapshot::NULL_LENGTH)
+                {
+                    continue;
+                }
+                if (data.size() - pos <= value || data[pos + value] != '\0')
+                {
+                    return false;
+                }
+                pos += size_t(value) + 1;
+            }
+        }
+        return pos == data.size();
+    }
+}
+
+QueryResultSnapshot::QueryResultSnapshot(std::vector<char>& data, uint64 rowCount, uint32 fieldCount)
+    : QueryResult(rowCount, fieldCount), m_pos(0), m_rowsLeft(rowCount)
+{
+    m_data.swap(data);
+
+    mCurrentRow = new Field[mFieldCount];
+    for (uint32 i = 0; i < mFieldCount; ++i)
+    {
+        uint32 type = 0;
+        Read(m_data, m_pos, type);
+        mCurrentRow[i].SetType(enum_field_types(type));
+    }
+}
+
+QueryResultSnapshot::~QueryResultSnapshot()
+{
+    delete[] mCurrentRow;
+}
+
+bool QueryResultSnapshot::NextRow()
+{
+    if (!m_rowsLeft)
+    {
+        return false;
+    }
+
+    for (uint32 i = 0; i < mFieldCount; ++i)
+    {
+        uint32 length = 0;
+        if (!Read(m_data, m_pos, length))
+        {
+            m_rowsLeft = 0;
+            return false;
+        }
+
+        if (length == SqlSnapshot::NULL_LENGTH)
+        {
+            mCurrentRow[i].SetValue(NULL);
+            continue;
+        }
+
+        if (m_data.size() - m_pos <= length)
+        {
+            m_rowsLeft = 0;
+            return false;
+        }
+
+        mCurrentRow[i].SetValue(&m_data[m_pos], length);
+        m_pos += length + 1;
+    }
+
+    --m_rowsLeft;
+    return true;
+}
+
+bool SqlSnapshot::Load(std::string const& file, uint64 key, QueryResult*& result)
+{
+    result = NULL;
+
+    FILE* f = fopen(file.c_str(), "rb");
+    if (!f)
+    {
+        return false;
+    }
+
+    SnapshotHeader header;
+    bool ok = fread(&header, sizeof(header), 1, f) == 1 &&
+              memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) == 0 && header.key == key;
+
+    std::vector<char> data;
+    if (ok)
+    {
+        // one bulk read; the rows are replayed in place
+        fseek(f, 0, SEEK_END);
+        long const size = ftell(f) - long(sizeof(header));
+        fseek(f, long(sizeof(header)), SEEK_SET);
+
+        ok = size >= long(header.fieldCount * sizeof(uint32));
+        if (ok && size > 0)
+        {
+            data.resize(size_t(size));
+            ok = fread(&data[0], data.size(), 1, f) == 1;
+        }
+    }
+    fclose(f);
+
+    if (!ok || !CheckRows(data, header.rowCount, header.fieldCount))
+    {
+        return false;
+    }
+
+    if (header.rowCount)
+    {
+        QueryResultSnapshot* snapshot = new QueryResultSnapshot(data, header.rowCount, header.fieldCount);
+        snapshot->NextRow();
+        result = snapshot;
+    }
+    return true;
+}
+
+QueryResult* SqlSnapshot::Capture(QueryResult* result, uint64 key, std::string const& file)
+{
+    // NULL is an empty table or a failed query, and the two can't be told
+    // apart here: snapshotting a failure would load nothing until the table changes
+    if (!result)
+    {
+        return NULL;
+    }
+
+    SnapshotHeader header;
+    memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+    header.key = key;
+    header.rowCount = 0;
+    header.fieldCount = result->GetFieldCount();
+    header.padding = 0;
+
+    std::vector<char> data;
+    Field const* fields = result->Fetch();
+    for (uint32 i = 0; i < header.fieldCount; ++i)
+    {
+        Append(data, uint32(fields[i].GetType()));
+    }
+
+    do
+    {
+        fields = result->Fetch();
+        for (uint32 i = 0; i < header.fieldCount; ++i)
+        {
+            char const* value = fields[i].GetString();
+            if (!value)
+            {
+                Append(data, NULL_LENGTH);
+                continue;
+            }
+
+            uint32 const length = uint32(fields[i].GetLength());
+            Append(data, length);
+            data.insert(data.end(), value, value + length);
+            data.push_back('\0');
+        }
+        ++header.rowCount;
+    }
+    while (result->NextRow());
+
+    delete result;
+
+    // write aside and rename, so a crash never leaves a half snapshot behind
+    std::string const temp = file + ".tmp";
+    FILE* f = fopen(temp.c_str(), "wb");
+    bool written = f && fwrite(&header, sizeof(header), 1, f) == 1 &&
+                   (data.empty() || fwrite(&data[0], data.size(), 1, f) == 1);
+    if (f)
+    {
+        written = fclose(f) == 0 && written;
+    }
+#ifdef WIN32
+    remove(file.c_str());                                   // rename() does not replace there
+#endif
+    if (!written || rename(temp.c_str(), file.c_str()) != 0)
+    {
+        remove(temp.c_str());
+        sLog.outError("SqlSnapshot: can't write snapshot '%s'", file.c_str());
+    }
+
+    QueryResultSnapshot* snapshot = new QueryResultSnapshot(data, header.rowCount, header.fieldCount);
+    snapshot->NextRow();
+    return snapshot;
+}
@@ -0,0 +1,98 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2025 MaNGOS <https://www.getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+#ifndef MANGOS_H_SQLSNAPSHOT
+#define MANGOS_H_SQLSNAPSHOT
+
+#include "Common/Common.h"
+#include "QueryResult.h"
+
+#include <string>
+#include <vector>
+
+/**
+ * @brief A query result replayed from memory, as read from a snapshot file.
+ *
+ * Values point straight into the buffer (every value is stored with its
+ * length and a terminating NUL), so replaying a row costs no copy and no
+ * allocation.
+ */
+class QueryResultSnapshot : public QueryResult
+{
+    public:
+        /**
+         * @brief take over @p data, laid out as written by SqlSnapshot::Capture()
+         *
+         * @param data field types followed by the rows
+         * @param rowCount
+         * @param fieldCount
+         */
+        QueryResultSnapshot(std::vector<char>& data, uint64 rowCount, uint32 fieldCount);
+
+        ~QueryResultSnapshot();
+
+        bool NextRow() override;
+
+    private:
+        std::vector<char> m_data;
+        size_t m_pos;                                       ///< next row in m_data
+        uint64 m_rowsLeft;
+};
+
+/**
+ * @brief On-disk snapshots of SELECT results over static tables (see Database::QuerySnapshot).
+ *
+ * File layout: header (magic, key, field count, row count), one uint32 MySQL
+ * field type per column, then per row and column a uint32 length
+ * (NULL_LENGTH for NULL) followed by the value and a NUL.
+ */
+namespace SqlSnapshot
+{
+    uint32 const NULL_LENGTH = 0xFFFFFFFF;
+
+    /**
+     * @brief read the snapshot in @p file if it was taken with @p key
+     *
+     * @param file
+     * @param key
+     * @param result set to the replayed result, NULL for a snapshot of an empty result
+     * @return bool false when the file is missing, stale, truncated or damaged
+     */
+    bool Load(std::string const& file, uint64 key, QueryResult*& result);
+
+    /**
+     * @brief drain @p result into a snapshot written to @p file
+     *
+     * A NULL result writes nothing: it may be a failed query rather than an
+     * empty table, so that query simply runs again next time.
+     *
+     * @param result a fresh query result, deleted here; may be NULL
+     * @param key
+     * @param file
+     * @return QueryResult* the same rows replayed from memory, NULL for a NULL @p result
+     */
+    QueryResult* Capture(QueryResult* result, uint64 key, std::string const& file);
+}
+
+#endif
@@ -807,6 +807,7 @@ void Log::outError(const char* err, ...)
 
     if (logfile)
     {
+        std::lock_guard<std::mutex> fileGuard(m_fileMtx);
         outTimestamp(logfile);
         fprintf(logfile, "ERROR:");
 
@@ -825,6 +826,7 @@ void Log::outErrorDb()
 
     if (logfile)
     {
+        std::lock_guard<std::mutex> fileGuard(m_fileMtx);
         outTimestamp(logfile);
         fprintf(logfile, "ERROR:\n");
         fflush(logfile);
@@ -832,6 +834,7 @@ void Log::outErrorDb()
 
     if (dberLogfile)
     {
+        std::lock_guard<std::mutex> fileGuard(m_fileMtx);
         outTimestamp(dberLogfile);
         fprintf(dberLogfile, "\n");
         fflush(dberLogfile);
@@ -853,6 +856,7 @@ void Log::outErrorDb(const char* err, ...)
 
     if (logfile)
     {
+        std::lock_guard<std::mutex> fileGuard(m_fileMtx);
         outTimestamp(logfile);
         fprintf(logfile, "ERROR:");
 
@@ -866,6 +870,7 @@ void Log::outErrorDb(const char* err, ...)
 
     if (dberLogfile)
     {
+        std::lock_guard<std::mutex> fileGuard(m_fileMtx);
         outTimestamp(dberLogfile);
 
         va_list ap;
@@ -619,7 +619,7 @@ class Log : public MaNGOS::Singleton<Log>
         FILE* worldLogfile; /**< TODO */
         FILE* wardenLogfile; /**< TODO */
         std::mutex m_worldLogMtx; /**< Serializes packet-dump writes to worldLogfile */
-        std::mutex m_fileMtx; /**< Serializes writes to the main logfile so concurrent map-update worker threads cannot tear lines */
+        std::mutex m_fileMtx; /**< Serializes writes to the main and DB error logfiles so concurrent map-update and startup loader threads cannot tear lines */
 
         ConsoleLogWriter* m_consoleBody; /**< Off-thread console writer Runnable (owned via thread refcount) */
         MaNGOS::Thread* m_consoleThread; /**< Thread driving m_consoleBody; deleting it drops the Runnable refcount */
@@ -0,0 +1,158 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2025 MaNGOS <https://www.getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+#include "TaskGraph.h"
+#include "Utilities/Errors.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <set>
+#include <thread>
+
+namespace
+{
+    uint32 MsSince(std::chrono::steady_clock::time_point start)
+    {
+        using namespace std::chrono;
+        return uint32(duration_cast<milliseconds>(steady_clock::now() - start).count());
+    }
+}
+
+uint32 MaNGOS::TaskGraph::Add(std::string const& name, Body body, std::initializer_list<uint32> after)
+{
+    uint32 const id = uint32(m_tasks.size());
+
+    Task task;
+    task.name = name;
+    task.body = body;
+    task.waitingOn = uint32(after.size());
+    m_tasks.push_back(task);
+
+    for (uint32 dependency : after)
+    {
+        MANGOS_ASSERT(dependency < id);                     // keeps the added order runnable as it stands
+        m_tasks[dependency].dependents.push_back(id);
+    }
+
+    return id;
+}
+
+void MaNGOS::TaskGraph::Run(uint32 workers, WorkerHook const& workerStart, WorkerHook const& workerStop)
+{
+    std::chrono::steady_clock::time_point const start = std::chrono::steady_clock::now();
+
+    m_reports.assign(m_tasks.size(), Report());
+    for (size_t i = 0; i < m_tasks.size(); ++i)
+    {
+        m_reports[i].name = m_tasks[i].name;
+        m_reports[i].worker = 0;
+        m_reports[i].startMs = 0;
+        m_reports[i].durationMs = 0;
+    }
+
+    if (workers <= 1)
+    {
+        for (size_t i = 0; i < m_tasks.size(); ++i)
+        {
+            m_reports[i].startMs = MsSince(start);
+            m_tasks[i].body(0);
+            m_reports[i].durationMs = MsSince(start) - m_reports[i].startMs;
+        }
+
+        m_elapsedMs = MsSince(start);
+        return;
+    }
+
+    std::mutex lock;
+    std::condition_variable wake;
+    std::set<uint32> ready;                                 // lowest id first: closest to the added order
+    size_t finished = 0;
+
+    for (uint32 id = 0; id < m_tasks.size(); ++id)
+    {
+        if (!m_tasks[id].waitingOn)
+        {
+            ready.insert(id);
+        }
+    }
+
+    std::vector<std::thread> threads;
+    for (uint32 worker = 0; worker < workers; ++worker)
+    {
+        threads.push_back(std::thread([&, worker]()
+        {
+            if (workerStart)
+            {
+                workerStart(worker);
+            }
+
+            std::unique_lock<std::mutex> guard(lock);
+            while (true)
+            {
+                wake.wait(guard, [&]() { return !ready.empty() || finished == m_tasks.size(); });
+                if (ready.empty())
+                {
+                    break;                                  // everything has finished
+                }
+
+                uint32 const id = *ready.begin();
+                ready.erase(ready.begin());
+
+                Report& report = m_reports[id];
+                report.worker = worker;
+                report.startMs = MsSince(start);
+
+                guard.unlock();
+                m_tasks[id].body(worker);
+                guard.lock();
+
+                report.durationMs = MsSince(start) - report.startMs;
+                ++finished;
+
+                for (uint32 dependent : m_tasks[id].dependents)
+                {
+                    if (!--m_tasks[dependent].waitingOn)
+                    {
+                        ready.insert(dependent);
+                    }
+                }
+                wake.notify_all();
+            }
+            guard.unlock();
+
+            if (workerStop)
+            {
+                workerStop(worker);
+            }
+        }));
+    }
+
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+
+    m_elapsedMs = MsSince(start);
+}
@@ -0,0 +1,104 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2025 MaNGOS <https://www.getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+#ifndef MANGOS_H_TASKGRAPH
+#define MANGOS_H_TASKGRAPH
+
+#include "Platform/Define.h"
+
+#include <functional>
+#include <initializer_list>
+#include <string>
+#include <vector>
+
+namespace MaNGOS
+{
+    /**
+     * @brief A one-shot set of tasks with explicit dependencies, run on a small thread pool.
+     *
+     * Tasks are added in an order that is valid on its own -- every dependency
+     * is added before the task that needs it -- so one worker simply runs them
+     * in that order on the calling thread. With more workers, a task starts as
+     * soon as everything it depends on has finished; among the ready tasks the
+     * earliest added goes first, so the run stays close to the sequential order.
+     *
+     * Used for the world startup loads (see World::SetInitialWorldSettings).
+     */
+    class TaskGraph
+    {
+        public:
+            typedef std::function<void(uint32)> Body;          ///< gets the index of the worker running it
+            typedef std::function<void(uint32)> WorkerHook;    ///< gets the worker index
+
+            /// When and where one task ran, relative to the start of Run().
+            struct Report
+            {
+                std::string name;
+                uint32 worker;
+                uint32 startMs;
+                uint32 durationMs;
+            };
+
+            /**
+             * @brief add a task
+             *
+             * @param name
+             * @param body
+             * @param after tasks that must have finished first, as returned by earlier Add() calls
+             * @return uint32 the task's id
+             */
+            uint32 Add(std::string const& name, Body body, std::initializer_list<uint32> after = {});
+
+            /**
+             * @brief run every task and return once all have finished
+             *
+             * @param workers 0 and 1 both run on the calling thread, as worker 0
+             * @param workerStart called on each spawned worker thread before its first task, may be empty
+             * @param workerStop called on each spawned worker thread after its last task, may be empty;
+             *        neither hook runs when the tasks run on the calling thread
+             */
+            void Run(uint32 workers, WorkerHook const& workerStart = WorkerHook(), WorkerHook const& workerStop = WorkerHook());
+
+            /// One entry per task, in the order they were added; filled by Run().
+            std::vector<Report> const& GetReports() const { return m_reports; }
+
+            /// Wall time of the last Run().
+            uint32 GetElapsedMs() const { return m_elapsedMs; }
+
+        private:
+            struct Task
+            {
+                std::string name;
+                Body body;
+                std::vector<uint32> dependents;
+                uint32 waitingOn;
+            };
+
+            std::vector<Task> m_tasks;
+            std::vector<Report> m_reports;
+            uint32 m_elapsedMs = 0;
+    };
+}
+
+#endif
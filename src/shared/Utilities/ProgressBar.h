@@ -64,6 +64,13 @@ class BarGoLink
          */
         static void SetOutputState(bool on);
 
+        /**
+         * @brief
+         *
+         * @return bool
+         */
+        static bool GetOutputState() { return m_showOutput; }
+
         /**
          * @brief Console output sink for one fully-built bar redraw.
          *
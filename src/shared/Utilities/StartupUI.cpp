@@ -47,7 +47,12 @@ namespace
     using ConsoleStyle::VisibleWidth;
 
     bool        s_stepOpen    = false; ///< a step line is currently drawn
-    bool        s_consumeNext = false; ///< the line being logged is ours: file only
+    bool        s_concurrent  = false; ///< between BeginConcurrent() and EndConcurrent()
+    bool        s_barsShown   = true;  ///< progress bar state to restore after a concurrent run
+
+    thread_local bool   t_consumeNext = false; ///< the line this thread is logging is ours: file only
+    thread_local uint32 t_rows        = 0;     ///< ">> Loaded N" rows of this thread's concurrent step
+    thread_local bool   t_rowsKnown   = false;
 
     std::string s_stepName;            ///< display name of the open step
     uint64      s_stepStartMs = 0;     ///< when the open step began
@@ -295,9 +300,9 @@ namespace
             return;
         }
 
-        s_consumeNext = true;
+        t_consumeNext = true;
         sLog.outString("%s", plain.c_str());
-        s_consumeNext = false;
+        t_consumeNext = false;
 
         ConsoleStyle::Emit(styled + "\n");
     }
@@ -329,12 +334,12 @@ namespace
             return false;
         }
 
-        if (s_consumeNext)
+        if (t_consumeNext)
         {
             return true;                                    // our own line: file only
         }
 
-        if (!s_stepOpen)
+        if (!s_stepOpen && !s_concurrent)
         {
             return false;
         }
@@ -352,12 +357,16 @@ namespace
         // ">> Loaded 543 page texts" -> 543. Several loaders report more than one
         // result line per step, so accumulate. Lines with no number at all
         // (">>> Loot Tables loaded") are still consumed, they just add nothing.
+        // In concurrent mode the line belongs to the step of the thread logging it.
+        uint32& rows      = s_concurrent ? t_rows : s_rows;
+        bool&   rowsKnown = s_concurrent ? t_rowsKnown : s_rowsKnown;
+
         for (const char* p = text; *p; ++p)
         {
             if (*p >= '0' && *p <= '9')
             {
-                s_rows += (uint32)strtoul(p, NULL, 10);
-                s_rowsKnown = true;
+                rows += (uint32)strtoul(p, NULL, 10);
+                rowsKnown = true;
                 break;
             }
         }
@@ -430,9 +439,9 @@ void StartupUI::Step(const std::string& text)
     CloseStep();
 
     // The file log keeps the line exactly as the server has always written it.
-    s_consumeNext = ConsoleStyle::Fancy();
+    t_consumeNext = ConsoleStyle::Fancy();
     sLog.outString("%s", text.c_str());
-    s_consumeNext = false;
+    t_consumeNext = false;
 
     s_stepOpen    = true;
     s_stepName    = DisplayName(text);
@@ -450,9 +459,95 @@ void StartupUI::LogOnly(const std::string& text)
 {
     CloseStep();
 
-    s_consumeNext = ConsoleStyle::Fancy();
+    t_consumeNext = ConsoleStyle::Fancy();
+    sLog.outString("%s", text.c_str());
+    t_consumeNext = false;
+}
+
+void StartupUI::BeginConcurrent()
+{
+    CloseStep();
+
+    // Bars repaint a single shared line, which concurrent steps do not have.
+    s_barsShown = BarGoLink::GetOutputState();
+    BarGoLink::SetOutputState(false);
+
+    s_concurrent = true;
+}
+
+void StartupUI::ConcurrentStep(const std::string& text)
+{
+    t_consumeNext = ConsoleStyle::Fancy();
     sLog.outString("%s", text.c_str());
-    s_consumeNext = false;
+    t_consumeNext = false;
+
+    t_rows      = 0;
+    t_rowsKnown = false;
+}
+
+bool StartupUI::ConcurrentStepRows(uint32& rows)
+{
+    rows = t_rows;
+    return t_rowsKnown;
+}
+
+void StartupUI::EndConcurrent(const std::vector<TimelineEntry>& entries, uint32 wallMs)
+{
+    s_concurrent = false;
+    BarGoLink::SetOutputState(s_barsShown);
+
+    const ConsoleStyle::Glyphs& g = ConsoleStyle::G();
+    const Layout l = LayoutFor(ConsoleStyle::Width());
+
+    // The middle column becomes the time axis: "w2 " then the track.
+    const int track = l.middle - 3;
+    const uint32 span = wallMs ? wallMs : 1;
+
+    uint64 workMs = 0;
+    uint32 workers = 0;
+
+    for (std::vector<TimelineEntry>::const_iterator itr = entries.begin(); itr != entries.end(); ++itr)
+    {
+        workMs += itr->durationMs;
+        workers = std::max(workers, itr->worker + 1);
+
+        int from = (int)((uint64)itr->startMs * track / span);
+        int width = (int)((uint64)itr->durationMs * track / span);
+        from = std::min(from, track - 1);
+        width = std::max(1, std::min(width, track - from));
+
+        const std::string name = DisplayName(itr->text);
+        const std::string rows = itr->rowsKnown ? FormatCount(itr->rows) + " rows" : std::string();
+
+        char worker[16];
+        snprintf(worker, sizeof(worker), "w%u ", itr->worker + 1);
+
+        // The file gets the same facts as plain text: worker, start offset, time, rows.
+        char plain[256];
+        snprintf(plain, sizeof(plain), "  [w%u] +%-7s %7s  %s%s%s", itr->worker + 1,
+                 FormatMs(itr->startMs).c_str(), FormatMs(itr->durationMs).c_str(), name.c_str(),
+                 rows.empty() ? "" : ", ", rows.c_str());
+
+        std::string styled = "  ";
+        styled += std::string(Good()) + g.done + Reset();
+        styled += " ";
+        styled += Fit(name, (std::size_t)l.name);
+        styled += " ";
+        styled += std::string(Dim()) + worker +
+                  Repeat(g.barEmpty, (std::size_t)from) +
+                  Reset() + Accent() + Repeat(g.barFull, (std::size_t)width) +
+                  Reset() + Dim() + Repeat(g.barEmpty, (std::size_t)(track - from - width));
+        styled += " ";
+        styled += RightAlign(FormatMs(itr->durationMs), (std::size_t)l.time);
+        styled += Reset();
+
+        Paint(plain, styled);
+    }
+
+    char summary[128];
+    snprintf(summary, sizeof(summary), "  %u loads on %u workers: %s wall, %s of work",
+             (uint32)entries.size(), workers, FormatMs(wallMs).c_str(), FormatMs((uint32)workMs).c_str());
+    Paint(summary, std::string(Dim()) + summary + Reset());
 }
 
 void StartupUI::BeginPhase(const std::string& title)
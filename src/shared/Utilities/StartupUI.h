@@ -111,6 +111,55 @@ namespace StartupUI
      */
     void Step(const std::string& text);
 
+    /// One load of a concurrent run, as drawn by EndConcurrent().
+    struct TimelineEntry
+    {
+        std::string text;  ///< the step's log line, as passed to ConcurrentStep()
+        uint32 worker;     ///< thread it ran on
+        uint32 startMs;    ///< relative to the start of the run
+        uint32 durationMs;
+        uint32 rows;       ///< see ConcurrentStepRows()
+        bool rowsKnown;
+    };
+
+    /**
+     * @brief Enter concurrent mode: the steps that follow run on several
+     *        threads at once, so there is no single line to repaint.
+     *
+     * Until EndConcurrent(), steps are started with ConcurrentStep() from the
+     * thread running them. Their ">> Loaded N" lines and blank spacers go to
+     * the log file only and are counted against the step of the thread that
+     * logged them; progress bars are off. Warnings and errors still print.
+     */
+    void BeginConcurrent();
+
+    /**
+     * @brief Start a step on the calling thread while in concurrent mode.
+     *
+     * @param text as for Step(): logged verbatim to the file (and to the
+     *        console in plain mode), nothing is drawn for it yet.
+     */
+    void ConcurrentStep(const std::string& text);
+
+    /**
+     * @brief Rows reported so far by the calling thread's current step.
+     *
+     * @param rows set to the sum of its ">> Loaded N" lines
+     * @return false if it logged no such line
+     */
+    bool ConcurrentStepRows(uint32& rows);
+
+    /**
+     * @brief Leave concurrent mode and draw the run as a timeline: one line per
+     *        step with its worker, a bar placed at its start offset and sized
+     *        by its duration, its row count and time, then the wall time
+     *        against the summed step time.
+     *
+     * @param entries in the order the steps would have run sequentially
+     * @param wallMs the whole run
+     */
+    void EndConcurrent(const std::vector<TimelineEntry>& entries, uint32 wallMs);
+
     /**
      * @brief Record @p text in the log file without drawing it on the console.
      *
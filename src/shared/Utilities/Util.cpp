@@ -38,6 +38,13 @@
 
 #include <array>
 
+#ifdef WIN32
+#include <psapi.h>
+#pragma comment(lib, "psapi.lib")
+#else
+#include <unistd.h>
+#endif
+
 //////////////////////////////////////////////////////////////////////////
 int32 irand(int32 min, int32 max)
 {
@@ -421,6 +428,64 @@ uint32 CreatePIDFile(const std::string& filename)
     return (uint32)pid;
 }
 
+uint64 GetResidentMemory()
+{
+#ifdef WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+    {
+        return uint64(counters.WorkingSetSize);
+    }
+    return 0;
+#else
+    // statm: total and resident size, in pages (Linux; elsewhere the file is missing)
+    FILE* statm = fopen("/proc/self/statm", "r");
+    if (!statm)
+    {
+        return 0;
+    }
+
+    unsigned long total = 0;
+    unsigned long resident = 0;
+    int const read = fscanf(statm, "%lu %lu", &total, &resident);
+    fclose(statm);
+
+    return read == 2 ? uint64(resident) * uint64(sysconf(_SC_PAGESIZE)) : 0;
+#endif
+}
+
+uint64 GetPeakResidentMemory()
+{
+#ifdef WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+    {
+        return uint64(counters.PeakWorkingSetSize);
+    }
+    return 0;
+#else
+    // VmHWM: the resident high water mark, in kB (Linux)
+    FILE* status = fopen("/proc/self/status", "r");
+    if (!status)
+    {
+        return 0;
+    }
+
+    char line[128];
+    unsigned long peak = 0;
+    while (fgets(line, sizeof(line), status))
+    {
+        if (sscanf(line, "VmHWM: %lu kB", &peak) == 1)
+        {
+            break;
+        }
+    }
+    fclose(status);
+
+    return uint64(peak) * 1024;
+#endif
+}
+
 size_t utf8length(std::string& utf8str)
 {
     try
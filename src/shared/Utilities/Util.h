@@ -922,6 +922,20 @@ std::string GetAddressString(uint32 ip, uint16 port);
  */
 uint32 CreatePIDFile(const std::string& filename);
 
+/**
+ * @brief Resident memory of this process
+ *
+ * @return uint64 bytes, 0 where the platform does not say
+ */
+uint64 GetResidentMemory();
+
+/**
+ * @brief Highest resident memory of this process so far
+ *
+ * @return uint64 bytes, 0 where the platform does not say
+ */
+uint64 GetPeakResidentMemory();
+
 /**
  * @brief
  *
@@ -78,6 +78,10 @@ public:
         return !m_closed.load(std::memory_order_seq_cst);
     }
 
+    uint64_t outstandingBytes() const override {
+        return m_outstanding.load(std::memory_order_relaxed);
+    }
+
 private:
     std::atomic<uint64_t>   m_outstanding{0};  ///< bytes queued but not yet written
     std::atomic<bool>       m_waiting{false};  ///< a producer is parked in wait()
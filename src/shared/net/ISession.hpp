@@ -47,10 +47,13 @@ using Closer = std::function<void()>;
 // Backpressure handle for bulk producers (realmd's patch stream): awaitWritable()
 // blocks until this connection's outbound backlog drains to at most
 // maxOutstandingBytes, or returns false once the connection is gone.
+// outstandingBytes() is the non-blocking read of that backlog, for producers
+// that shape their output instead of waiting (the world link).
 class FlowControl {
 public:
     virtual ~FlowControl() = default;
     virtual bool awaitWritable(uint64_t maxOutstandingBytes) = 0;
+    virtual uint64_t outstandingBytes() const = 0;
 };
 
 class ISession : public std::enable_shared_from_this<ISession> {
@@ -81,8 +84,8 @@ public:
     virtual void setCloser(Closer) {}
 
     // Hands the session a backpressure handle for this connection (net thread,
-    // once, before onConnect). Default: ignored — only bulk producers (the patch
-    // stream) use it; request/response and world sessions never need to throttle.
+    // once, before onConnect). Default: ignored — bulk producers (the patch
+    // stream) park on it and the world link reads it to shape congested output.
     virtual void setFlowControl(std::shared_ptr<FlowControl>) {}
 
     // Called by the world loop once per tick (world thread). Default: nothing —
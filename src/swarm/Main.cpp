@@ -0,0 +1,501 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2025 MaNGOS <https://www.getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+
+/**
+ * @file Main.cpp
+ * @brief mangos-swarm entry point: headless client load generator.
+ *
+ * Reads the database strings and world port from a mangosd.conf, provisions
+ * SWARMnnnnn accounts in the realmd database, ramps up the requested number
+ * of synthetic clients against the running world server and prints the round
+ * trip latency percentiles per request, the server tick time (sampled with
+ * ".server info" by the first client) and the traffic rate every report
+ * interval, plus a summary of the whole run at the end.
+ *
+ * Warden must be disabled on the target realm: the swarm cannot answer its
+ * checks and its accounts carry no client OS.
+ */
+
+#include "Swarm.h"
+#include "SwarmClient.h"
+#include "SwarmSetup.h"
+#include "SwarmStats.h"
+#include "Config/Config.h"
+#include "Log/Log.h"
+#include "SystemConfig.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <netdb.h>
+#include <poll.h>
+#include <sys/socket.h>
+
+static std::atomic<bool> s_stopRequested(false);
+
+static void SwarmSignalHandler(int /*signal*/)
+{
+    s_stopRequested = true;
+}
+
+/**
+ * One poll() loop driving a slice of the clients.
+ *
+ * Clients are handed out round-robin, so every worker ramps its share at the
+ * same pace. The stats are only touched under @c m_statsLock, which the
+ * reporter takes once per interval to drain them.
+ */
+class SwarmWorker
+{
+    public:
+        SwarmWorker(sockaddr_storage const& address, socklen_t addressLength, uint32 seed)
+            : m_address(address),
+              m_addressLength(addressLength),
+              m_rng(seed),
+              m_nextToStart(0),
+              m_connected(0),
+              m_inWorld(0),
+              m_failed(0)
+        {
+        }
+
+        void AddClient(std::unique_ptr<SwarmClient> client, uint64 startAt)
+        {
+            m_clients.push_back(std::move(client));
+            m_startAt.push_back(startAt);
+        }
+
+        void Start()
+        {
+            m_thread = std::thread(&SwarmWorker::Run, this);
+        }
+
+        void Join()
+        {
+            if (m_thread.joinable())
+            {
+                m_thread.join();
+            }
+        }
+
+        /// Move everything recorded since the last call into @p into.
+        void Drain(SwarmStats& into)
+        {
+            std::lock_guard<std::mutex> guard(m_statsLock);
+            into.Merge(m_stats);
+            m_stats.Reset();
+        }
+
+        uint32 Connected() const
+        {
+            return m_connected;
+        }
+
+        uint32 InWorld() const
+        {
+            return m_inWorld;
+        }
+
+        uint32 Failed() const
+        {
+            return m_failed;
+        }
+
+    private:
+        void Run()
+        {
+            std::vector<pollfd> descriptors;
+            std::vector<SwarmClient*> polled;
+
+            while (!s_stopRequested)
+            {
+                uint64 now = SwarmNowMicros();
+                while (m_nextToStart < m_clients.size() && now >= m_startAt[m_nextToStart])
+                {
+                    m_clients[m_nextToStart]->Connect(
+                        reinterpret_cast<sockaddr const*>(&m_address), m_addressLength, now);
+                    ++m_nextToStart;
+                }
+
+                descriptors.clear();
+                polled.clear();
+                for (std::unique_ptr<SwarmClient> const& client : m_clients)
+                {
+                    if (client->GetSocket() < 0)
+                    {
+                        continue;
+                    }
+
+                    pollfd descriptor;
+                    descriptor.fd = client->GetSocket();
+                    descriptor.events = POLLIN | (client->WantsWrite() ? POLLOUT : 0);
+                    descriptor.revents = 0;
+                    descriptors.push_back(descriptor);
+                    polled.push_back(client.get());
+                }
+
+                if (descriptors.empty())
+                {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+                }
+                else if (poll(descriptors.data(), descriptors.size(), 5) < 0 && errno != EINTR)
+                {
+                    perror("swarm: poll");
+                    return;
+                }
+
+                now = SwarmNowMicros();
+                uint32 connected = 0;
+                uint32 inWorld = 0;
+                uint32 failed = 0;
+                {
+                    std::lock_guard<std::mutex> guard(m_statsLock);
+                    for (std::size_t i = 0; i < polled.size(); ++i)
+                    {
+                        short const events = descriptors[i].revents;
+                        if (events & POLLOUT)
+                        {
+                            polled[i]->OnWritable(now, m_stats);
+                        }
+                        if (events & (POLLIN | POLLHUP | POLLERR))
+                        {
+                            polled[i]->OnReadable(now, m_stats);
+                        }
+                    }
+
+                    for (std::unique_ptr<SwarmClient> const& client : m_clients)
+                    {
+                        client->Update(now, m_rng, m_stats);
+                        connected += client->GetSocket() >= 0 ? 1 : 0;
+                        inWorld += client->IsInWorld() ? 1 : 0;
+                        failed += client->HasFailed() ? 1 : 0;
+                    }
+                }
+                m_connected = connected;
+                m_inWorld = inWorld;
+                m_failed = failed;
+            }
+
+            for (std::unique_ptr<SwarmClient> const& client : m_clients)
+            {
+                client->Close();
+            }
+        }
+
+        sockaddr_storage m_address;
+        socklen_t m_addressLength;
+        std::mt19937 m_rng;
+        std::vector<std::unique_ptr<SwarmClient>> m_clients;
+        std::vector<uint64> m_startAt;
+        std::size_t m_nextToStart;
+        std::thread m_thread;
+
+        std::mutex m_statsLock;
+        SwarmStats m_stats;
+        std::atomic<uint32> m_connected;
+        std::atomic<uint32> m_inWorld;
+        std::atomic<uint32> m_failed;
+};
+
+static void PrintUsage(char const* argv0)
+{
+    fprintf(stderr,
+            "Usage: %s [options]\n"
+            "  -c, --config <path>      mangosd.conf to read DB strings and port from (default %s)\n"
+            "      --host <address>     world server address (default BindIP, or 127.0.0.1)\n"
+            "      --port <port>        world server port (default WorldServerPort)\n"
+            "  -n, --clients <n>        synthetic clients to log in (default 100)\n"
+            "      --first <n>          number of the first SWARMnnnnn account (default 1)\n"
+            "      --threads <n>        worker threads (default: one per core)\n"
+            "      --ramp <n>           connections started per second (default 50)\n"
+            "  -d, --duration <sec>     run length (default 300)\n"
+            "      --report <sec>       report interval (default 10)\n"
+            "      --interval <ms>      mean delay between scripted actions (default 1000)\n"
+            "      --tick-probe <sec>   \".server info\" sampling interval, 0 = off (default 5)\n"
+            "      --timeout <ms>       round trip timeout (default 10000)\n"
+            "      --gmlevel <n>        account level, \".go xyz\" needs 1 (default 1)\n"
+            "      --spell <id>         spell cast by the cast behaviour (default 2457)\n"
+            "      --race <id> --class <id>  race/class of created characters (default 1/1)\n"
+            "      --mix walk=40,cast=15,chat=15,auction=10,zone=5,ping=15\n"
+            "                           relative weights of the scripted behaviours\n",
+            argv0, MANGOSD_CONFIG_LOCATION);
+}
+
+static bool ParseMix(char const* text, SwarmBehaviourMix& mix)
+{
+    std::string const spec = text;
+    std::string::size_type start = 0;
+    while (start < spec.size())
+    {
+        std::string::size_type end = spec.find(',', start);
+        if (end == std::string::npos)
+        {
+            end = spec.size();
+        }
+
+        std::string const item = spec.substr(start, end - start);
+        std::string::size_type const equals = item.find('=');
+        if (equals == std::string::npos)
+        {
+            return false;
+        }
+
+        std::string const name = item.substr(0, equals);
+        uint32 const weight = uint32(strtoul(item.c_str() + equals + 1, NULL, 10));
+        if (name == "walk")         { mix.walk = weight; }
+        else if (name == "cast")    { mix.cast = weight; }
+        else if (name == "chat")    { mix.chat = weight; }
+        else if (name == "auction") { mix.auction = weight; }
+        else if (name == "zone")    { mix.zone = weight; }
+        else if (name == "ping")    { mix.ping = weight; }
+        else
+        {
+            return false;
+        }
+        start = end + 1;
+    }
+    return true;
+}
+
+static bool ParseArguments(int argc, char** argv, SwarmOptions& options,
+    std::string& hostOverride, uint32& portOverride)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string const arg = argv[i];
+        if (arg == "-h" || arg == "--help")
+        {
+            return false;
+        }
+        if (i + 1 >= argc)
+        {
+            fprintf(stderr, "swarm: %s needs a value\n", arg.c_str());
+            return false;
+        }
+
+        char const* value = argv[++i];
+        uint32 const number = uint32(strtoul(value, NULL, 10));
+        if (arg == "-c" || arg == "--config")        { options.configFile = value; }
+        else if (arg == "--host")                    { hostOverride = value; }
+        else if (arg == "--port")                    { portOverride = number; }
+        else if (arg == "-n" || arg == "--clients")  { options.clients = number; }
+        else if (arg == "--first")                   { options.firstAccount = number; }
+        else if (arg == "--threads")                 { options.threads = number; }
+        else if (arg == "--ramp")                    { options.rampPerSecond = number; }
+        else if (arg == "-d" || arg == "--duration") { options.durationSec = number; }
+        else if (arg == "--report")                  { options.reportSec = number; }
+        else if (arg == "--interval")                { options.actionIntervalMs = number; }
+        else if (arg == "--tick-probe")              { options.tickProbeSec = number; }
+        else if (arg == "--timeout")                 { options.requestTimeoutMs = number; }
+        else if (arg == "--gmlevel")                 { options.gmLevel = number; }
+        else if (arg == "--spell")                   { options.spellId = number; }
+        else if (arg == "--race")                    { options.race = uint8(number); }
+        else if (arg == "--class")                   { options.playerClass = uint8(number); }
+        else if (arg == "--mix")
+        {
+            if (!ParseMix(value, options.mix))
+            {
+                fprintf(stderr, "swarm: bad --mix '%s'\n", value);
+                return false;
+            }
+        }
+        else
+        {
+            fprintf(stderr, "swarm: unknown option %s\n", arg.c_str());
+            return false;
+        }
+    }
+
+    if (options.clients == 0 || options.rampPerSecond == 0 || options.reportSec == 0
+        || options.actionIntervalMs == 0 || options.firstAccount + options.clients > 100000)
+    {
+        fprintf(stderr, "swarm: clients, ramp, report and interval must be positive"
+                        " and the accounts must fit SWARM00001..SWARM99999\n");
+        return false;
+    }
+    return true;
+}
+
+static bool OpenSwarmDatabase(DatabaseType& database, char const* infoKey)
+{
+    std::string const info = sConfig.GetStringDefault(infoKey, "");
+    if (info.empty())
+    {
+        sLog.outError("swarm: %s not specified in %s", infoKey, sConfig.GetFilename().c_str());
+        return false;
+    }
+    if (!database.Initialize(info.c_str(), 1))
+    {
+        sLog.outError("swarm: cannot connect to %s", infoKey);
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    SwarmOptions options;
+    options.configFile = MANGOSD_CONFIG_LOCATION;
+    std::string hostOverride;
+    uint32 portOverride = 0;
+    if (!ParseArguments(argc, argv, options, hostOverride, portOverride))
+    {
+        PrintUsage(argv[0]);
+        return 1;
+    }
+
+    if (!sConfig.SetSource(options.configFile.c_str()))
+    {
+        fprintf(stderr, "swarm: could not load config '%s'\n", options.configFile.c_str());
+        return 1;
+    }
+
+    options.host = hostOverride.empty() ? sConfig.GetStringDefault("BindIP", "0.0.0.0") : hostOverride;
+    if (options.host == "0.0.0.0")
+    {
+        options.host = "127.0.0.1";
+    }
+    options.port = uint16(portOverride ? portOverride : uint32(sConfig.GetIntDefault("WorldServerPort", 8085)));
+    if (options.threads == 0)
+    {
+        options.threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    options.threads = std::min(options.threads, options.clients);
+
+    std::vector<SwarmAccount> accounts;
+    SwarmWorldData world;
+    {
+        DatabaseType loginDatabase;
+        DatabaseType worldDatabase;
+        if (!OpenSwarmDatabase(loginDatabase, "LoginDatabaseInfo")
+            || !OpenSwarmDatabase(worldDatabase, "WorldDatabaseInfo")
+            || !SwarmProvisionAccounts(loginDatabase, options, accounts)
+            || !SwarmLoadWorldData(worldDatabase, world))
+        {
+            return 1;
+        }
+        loginDatabase.HaltDelayThread();
+        worldDatabase.HaltDelayThread();
+    }
+
+    addrinfo hints;
+    std::memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* resolved = NULL;
+    char port[16];
+    snprintf(port, sizeof(port), "%u", uint32(options.port));
+    if (getaddrinfo(options.host.c_str(), port, &hints, &resolved) != 0 || !resolved)
+    {
+        fprintf(stderr, "swarm: cannot resolve %s\n", options.host.c_str());
+        return 1;
+    }
+    sockaddr_storage address;
+    std::memset(&address, 0, sizeof(address));
+    std::memcpy(&address, resolved->ai_addr, resolved->ai_addrlen);
+    socklen_t const addressLength = socklen_t(resolved->ai_addrlen);
+    freeaddrinfo(resolved);
+
+    std::signal(SIGINT, SwarmSignalHandler);
+    std::signal(SIGTERM, SwarmSignalHandler);
+
+    std::random_device seed;
+    std::vector<std::unique_ptr<SwarmWorker>> workers;
+    for (uint32 i = 0; i < options.threads; ++i)
+    {
+        workers.push_back(std::unique_ptr<SwarmWorker>(new SwarmWorker(address, addressLength, seed())));
+    }
+
+    uint64 const start = SwarmNowMicros();
+    for (uint32 i = 0; i < options.clients; ++i)
+    {
+        uint64 const startAt = start + uint64(i) * 1000000 / options.rampPerSecond;
+        workers[i % options.threads]->AddClient(std::unique_ptr<SwarmClient>(
+            new SwarmClient(i, accounts[i], options, world)), startAt);
+    }
+
+    printf("swarm: %u clients -> %s:%u on %u threads, ramp %u/s, %u s\n",
+        options.clients, options.host.c_str(), uint32(options.port), options.threads,
+        options.rampPerSecond, options.durationSec);
+    for (std::unique_ptr<SwarmWorker> const& worker : workers)
+    {
+        worker->Start();
+    }
+
+    SwarmStats total;
+    uint64 const end = start + uint64(options.durationSec) * 1000000;
+    uint64 windowStart = start;
+    while (!s_stopRequested && SwarmNowMicros() < end)
+    {
+        uint64 const windowEnd = std::min(end, windowStart + uint64(options.reportSec) * 1000000);
+        while (!s_stopRequested && SwarmNowMicros() < windowEnd)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        }
+
+        uint64 const now = SwarmNowMicros();
+        SwarmStats window;
+        uint32 connected = 0;
+        uint32 inWorld = 0;
+        uint32 failed = 0;
+        for (std::unique_ptr<SwarmWorker> const& worker : workers)
+        {
+            worker->Drain(window);
+            connected += worker->Connected();
+            inWorld += worker->InWorld();
+            failed += worker->Failed();
+        }
+        total.Merge(window);
+
+        char title[128];
+        snprintf(title, sizeof(title), "t+%us: %u connected, %u in world, %u failed",
+            uint32((now - start) / 1000000), connected, inWorld, failed);
+        window.Print(stdout, title, double(now - windowStart) / 1000000.0);
+        fflush(stdout);
+        windowStart = now;
+    }
+
+    s_stopRequested = true;
+    for (std::unique_ptr<SwarmWorker> const& worker : workers)
+    {
+        worker->Join();
+        worker->Drain(total);
+    }
+
+    total.Print(stdout, "whole run", double(SwarmNowMicros() - start) / 1000000.0);
+    return 0;
+}
@@ -0,0 +1,130 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2025 MaNGOS <https://www.getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+
+#ifndef MANGOS_SWARM_SWARM_H
+#define MANGOS_SWARM_SWARM_H
+
+#include "Platform/Define.h"
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * @file Swarm.h
+ * @brief Shared definitions of the headless client swarm (mangos-swarm).
+ *
+ * The swarm logs synthetic 1.12 clients into a running mangosd, one account
+ * and one character each, and drives them with a weighted random script.
+ * Accounts are provisioned straight into the realmd database with a known
+ * session key, so the realm server itself is not needed: the clients connect
+ * to the world port and prove that key exactly as a client coming from realmd
+ * would.
+ */
+
+/// Monotonic clock all swarm timestamps are taken from, in microseconds.
+inline uint64 SwarmNowMicros()
+{
+    return uint64(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+/// Relative weights of the scripted behaviours; a zero weight disables one.
+struct SwarmBehaviourMix
+{
+    uint32 walk = 40;
+    uint32 cast = 15;
+    uint32 chat = 15;
+    uint32 auction = 10;
+    uint32 zone = 5;
+    uint32 ping = 15;
+
+    uint32 Total() const
+    {
+        return walk + cast + chat + auction + zone + ping;
+    }
+};
+
+/// Command line and mangosd.conf derived settings of one swarm run.
+struct SwarmOptions
+{
+    std::string configFile;         ///< mangosd.conf to take the DB strings and port from
+    std::string host;               ///< World server address (BindIP, or 127.0.0.1)
+    uint16 port = 8085;             ///< World server port (WorldServerPort)
+    uint32 clients = 100;           ///< Number of synthetic clients
+    uint32 firstAccount = 1;        ///< Number of the first SWARMnnnnn account
+    uint32 threads = 0;             ///< Worker threads, 0 = one per core
+    uint32 rampPerSecond = 50;      ///< New connections started per second
+    uint32 durationSec = 300;       ///< Run length once the ramp has started
+    uint32 reportSec = 10;          ///< Interval between window reports
+    uint32 actionIntervalMs = 1000; ///< Mean delay between two scripted actions
+    uint32 tickProbeSec = 5;        ///< Interval of the ".server info" tick probe
+    uint32 requestTimeoutMs = 10000;///< Round trips slower than this count as timeouts
+    uint32 gmLevel = 1;             ///< Account level; ".go xyz" needs a moderator
+    uint32 spellId = 2457;          ///< Spell cast by the cast behaviour (Battle Stance)
+    uint8 race = 1;                 ///< Race of created characters (Human)
+    uint8 playerClass = 1;          ///< Class of created characters (Warrior)
+    SwarmBehaviourMix mix;
+};
+
+/// One provisioned account: the name it logs in with and its session key (hex).
+struct SwarmAccount
+{
+    std::string name;
+    std::string sessionKey;
+};
+
+/// A point clients can be sent to with ".go xyz".
+struct SwarmLocation
+{
+    uint32 map;
+    float x;
+    float y;
+    float z;
+};
+
+/// An auctioneer spawn clients can browse at.
+struct SwarmAuctioneer
+{
+    uint64 guid;
+    SwarmLocation where;
+};
+
+/**
+ * World data loaded once before the clients start and then shared read-only,
+ * apart from the per-auctioneer "unusable" flags. An auctioneer that does not
+ * answer MSG_AUCTION_HELLO (usually one of the opposing faction) is flagged
+ * by the first client that finds out and skipped by everybody afterwards.
+ */
+struct SwarmWorldData
+{
+    std::vector<SwarmLocation> destinations;
+    std::vector<SwarmAuctioneer> auctioneers;
+    std::unique_ptr<std::atomic<bool>[]> unusableAuctioneers;
+};
+
+#endif
@@ -0,0 +1,895 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2025 MaNGOS <https://www.getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+
+#include "SwarmClient.h"
+#include "Auth/BigNumber.h"
+#include "Auth/Sha1.h"
+#include "IWorldGateway.h"
+#include "Opcodes.h"
+
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <unistd.h>
+
+/// Build the swarm identifies with; must be one mangosd accepts (1.12.1).
+static const uint32 SWARM_CLIENT_BUILD = 5875;
+
+/// Result codes of SMSG_CHAR_CREATE the swarm cares about.
+static const uint8 SWARM_CHAR_CREATE_SUCCESS = 0x2E;
+
+/// Chat types and language used by the chat behaviour.
+static const uint8 SWARM_CHAT_MSG_SAY = 0x00;
+static const uint8 SWARM_CHAT_MSG_SYSTEM = 0x0A;
+static const uint32 SWARM_LANG_COMMON = 7;
+
+/// Movement: forward flag, run speed and heartbeat period of the walk behaviour.
+static const uint32 SWARM_MOVEFLAG_FORWARD = 0x00000001;
+static const float SWARM_RUN_SPEED = 7.0f;
+static const uint64 SWARM_HEARTBEAT_US = 500 * 1000;
+
+static const std::size_t SWARM_READ_CHUNK = 64 * 1024;
+
+SwarmClient::SwarmClient(uint32 index, SwarmAccount const& account,
+    SwarmOptions const& options, SwarmWorldData& world)
+    : m_index(index),
+      m_account(account),
+      m_options(options),
+      m_world(world),
+      m_socket(-1),
+      m_state(STATE_IDLE),
+      m_failed(false),
+      m_codec({}, proto::CodecRole::Client),
+      m_sendOffset(0),
+      m_packetsIn(0),
+      m_bytesIn(0),
+      m_packetsOut(0),
+      m_bytesOut(0),
+      m_playerGuid(0),
+      m_map(0),
+      m_x(0.0f),
+      m_y(0.0f),
+      m_z(0.0f),
+      m_orientation(0.0f),
+      m_pingSequence(0),
+      m_nextAction(0),
+      m_nextTickProbe(0),
+      m_moving(false),
+      m_moveUntil(0),
+      m_lastMoveUpdate(0),
+      m_nextHeartbeat(0),
+      m_auctioneer(-1),
+      m_teleportForAuction(false)
+{
+    std::memset(m_pending, 0, sizeof(m_pending));
+    m_crypt.SetClientSide();
+}
+
+SwarmClient::~SwarmClient()
+{
+    Close();
+}
+
+bool SwarmClient::Connect(sockaddr const* address, socklen_t addressLength, uint64 /*now*/)
+{
+    m_socket = socket(address->sa_family, SOCK_STREAM, 0);
+    if (m_socket < 0)
+    {
+        Fail("socket() failed");
+        return false;
+    }
+
+    int const noDelay = 1;
+    setsockopt(m_socket, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+    fcntl(m_socket, F_SETFL, fcntl(m_socket, F_GETFL, 0) | O_NONBLOCK);
+
+    if (connect(m_socket, address, addressLength) != 0 && errno != EINPROGRESS)
+    {
+        Fail("connect() failed");
+        return false;
+    }
+
+    m_state = STATE_CONNECTING;
+    return true;
+}
+
+void SwarmClient::Close()
+{
+    if (m_socket >= 0)
+    {
+        ::close(m_socket);
+        m_socket = -1;
+    }
+    m_state = STATE_CLOSED;
+}
+
+void SwarmClient::Fail(char const* reason)
+{
+    if (m_state != STATE_CLOSED)
+    {
+        fprintf(stderr, "swarm: %s: %s\n", m_account.name.c_str(), reason);
+    }
+    m_failed = true;
+    Close();
+}
+
+void SwarmClient::Send(WorldPacket const& packet)
+{
+    if (m_state == STATE_CLOSED)
+    {
+        return;
+    }
+
+    std::size_t const before = m_sendBuffer.size();
+    if (m_crypt.IsInitialized())
+    {
+        proto::PacketCodec::EncodeClientTo(packet,
+            [this](uint8* header, std::size_t len)
+            {
+                m_crypt.EncryptSend(header, len);
+            }, m_sendBuffer);
+    }
+    else
+    {
+        proto::PacketCodec::EncodeClientTo(packet, {}, m_sendBuffer);
+    }
+
+    ++m_packetsOut;
+    m_bytesOut += m_sendBuffer.size() - before;
+    FlushSend();
+}
+
+void SwarmClient::FlushSend()
+{
+    while (m_state != STATE_CONNECTING && m_sendOffset < m_sendBuffer.size())
+    {
+        ssize_t const written = ::send(m_socket, m_sendBuffer.data() + m_sendOffset,
+            m_sendBuffer.size() - m_sendOffset, MSG_NOSIGNAL);
+        if (written < 0)
+        {
+            if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)
+            {
+                return;
+            }
+            Fail("send() failed");
+            return;
+        }
+        m_sendOffset += std::size_t(written);
+    }
+
+    if (m_sendOffset == m_sendBuffer.size())
+    {
+        m_sendBuffer.clear();
+        m_sendOffset = 0;
+    }
+}
+
+void SwarmClient::OnWritable(uint64 /*now*/, SwarmStats& /*stats*/)
+{
+    if (m_state == STATE_CONNECTING)
+    {
+        int error = 0;
+        socklen_t length = sizeof(error);
+        if (getsockopt(m_socket, SOL_SOCKET, SO_ERROR, &error, &length) != 0 || error != 0)
+        {
+            Fail(error ? strerror(error) : "connect failed");
+            return;
+        }
+        m_state = STATE_AWAIT_CHALLENGE;
+    }
+
+    FlushSend();
+}
+
+void SwarmClient::OnReadable(uint64 now, SwarmStats& stats)
+{
+    uint8 chunk[SWARM_READ_CHUNK];
+    while (m_state != STATE_CLOSED)
+    {
+        ssize_t const received = ::recv(m_socket, chunk, sizeof(chunk), 0);
+        if (received == 0)
+        {
+            Fail("server closed the connection");
+            return;
+        }
+        if (received < 0)
+        {
+            if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)
+            {
+                return;
+            }
+            Fail("recv() failed");
+            return;
+        }
+
+        // Re-read the clock per chunk: a reply that arrives while we are still
+        // draining the socket must not inherit the time the drain started.
+        now = SwarmNowMicros();
+        m_bytesIn += uint64(received);
+        m_received.clear();
+        if (m_codec.Feed(chunk, std::size_t(received), m_received) == proto::DecodeStatus::Malformed)
+        {
+            Fail("malformed server frame");
+            return;
+        }
+
+        for (WorldPacket& packet : m_received)
+        {
+            ++m_packetsIn;
+            try
+            {
+                HandlePacket(packet, now, stats);
+            }
+            catch (ByteBufferException const&)
+            {
+                Fail("short server packet");
+                return;
+            }
+            if (m_state == STATE_CLOSED)
+            {
+                return;
+            }
+        }
+    }
+}
+
+void SwarmClient::Begin(SwarmRequest request, uint64 now)
+{
+    m_pending[request] = now ? now : 1;
+}
+
+void SwarmClient::Complete(SwarmRequest request, uint64 now, SwarmStats& stats)
+{
+    if (m_pending[request] == 0)
+    {
+        return;
+    }
+
+    stats.RecordRoundTrip(request, now > m_pending[request] ? now - m_pending[request] : 0);
+    m_pending[request] = 0;
+}
+
+void SwarmClient::HandlePacket(WorldPacket& packet, uint64 now, SwarmStats& stats)
+{
+    switch (packet.GetOpcode())
+    {
+        case SMSG_AUTH_CHALLENGE:
+            HandleAuthChallenge(packet, now);
+            break;
+        case SMSG_AUTH_RESPONSE:
+            HandleAuthResponse(packet, now, stats);
+            break;
+        case SMSG_CHAR_ENUM:
+            HandleCharEnum(packet, now, stats);
+            break;
+        case SMSG_CHAR_CREATE:
+            HandleCharCreate(packet, now, stats);
+            break;
+        case SMSG_LOGIN_VERIFY_WORLD:
+            HandleLoginVerifyWorld(packet, now, stats);
+            break;
+        case SMSG_PONG:
+            Complete(SWARM_REQ_PING, now, stats);
+            break;
+        case SMSG_SPELL_START:
+        case SMSG_SPELL_GO:
+            HandleSpellStart(packet, now, stats);
+            break;
+        case SMSG_CAST_FAILED:
+            HandleCastFailed(packet, now, stats);
+            break;
+        case SMSG_MESSAGECHAT:
+            HandleMessageChat(packet, now, stats);
+            break;
+        case MSG_MOVE_TELEPORT_ACK:
+            HandleTeleportAck(packet, now, stats);
+            break;
+        case SMSG_NEW_WORLD:
+            HandleNewWorld(packet, now, stats);
+            break;
+        case MSG_AUCTION_HELLO:
+            HandleAuctionHello(packet, now, stats);
+            break;
+        case SMSG_AUCTION_LIST_RESULT:
+            Complete(SWARM_REQ_AUCTION_LIST, now, stats);
+            break;
+        default:
+            break;
+    }
+}
+
+void SwarmClient::HandleAuthChallenge(WorldPacket& packet, uint64 now)
+{
+    if (m_state != STATE_AWAIT_CHALLENGE)
+    {
+        Fail("unexpected SMSG_AUTH_CHALLENGE");
+        return;
+    }
+
+    uint32 serverSeed;
+    packet >> serverSeed;
+    uint32 const clientSeed = serverSeed ^ (0x9E3779B9u * (m_index + 1));
+
+    BigNumber sessionKey;
+    sessionKey.SetHexStr(m_account.sessionKey.c_str());
+
+    uint8 const zero[4] = {0, 0, 0, 0};
+    Sha1Hash sha;
+    sha.UpdateData(m_account.name);
+    sha.UpdateData(zero, sizeof(zero));
+    sha.UpdateData(reinterpret_cast<uint8 const*>(&clientSeed), sizeof(clientSeed));
+    sha.UpdateData(reinterpret_cast<uint8 const*>(&serverSeed), sizeof(serverSeed));
+    sha.UpdateBigNumbers(&sessionKey, nullptr);
+    sha.Finalize();
+
+    WorldPacket session(CMSG_AUTH_SESSION, 4 + 4 + m_account.name.size() + 1 + 4 + 20 + 4);
+    session << uint32(SWARM_CLIENT_BUILD);
+    session << uint32(0);
+    session << m_account.name;
+    session << uint32(clientSeed);
+    session.append(sha.GetDigest(), 20);
+    session << uint32(0);                                   // no addon block
+    Send(session);
+    Begin(SWARM_REQ_AUTH, now);
+
+    // The server switches its header crypt on as soon as it has verified the
+    // proof, so everything after CMSG_AUTH_SESSION travels encrypted.
+    m_crypt.SetKey(sessionKey.AsByteArray(40), 40);
+    m_crypt.Init();
+    m_codec.SetHeaderDecryptor(
+        [this](uint8* header, std::size_t len)
+        {
+            m_crypt.DecryptRecv(header, len);
+        });
+    m_state = STATE_AWAIT_AUTH;
+}
+
+void SwarmClient::HandleAuthResponse(WorldPacket& packet, uint64 now, SwarmStats& stats)
+{
+    uint8 status;
+    packet >> status;
+    if (status == uint8(proto::AuthStatus::WaitQueue))
+    {
+        return;                                             // a second response follows once admitted
+    }
+    if (status != uint8(proto::AuthStatus::Ok))
+    {
+        char reason[64];
+        snprintf(reason, sizeof(reason), "authentication refused (status 0x%02X)", status);
+        Fail(reason);
+        return;
+    }
+
+    Complete(SWARM_REQ_AUTH, now, stats);
+    SendCharEnum(now);
+}
+
+void SwarmClient::SendCharEnum(uint64 now)
+{
+    Send(WorldPacket(CMSG_CHAR_ENUM, 0));
+    Begin(SWARM_REQ_CHAR_ENUM, now);
+    m_state = STATE_AWAIT_CHAR_ENUM;
+}
+
+std::string SwarmClient::CharacterName() const
+{
+    // "Swarm" plus seven letters alternating consonant/vowel, so no generated
+    // name ever repeats a letter three times or spells out a digit.
+    static char const consonants[] = "bcdfghjklmnpqrstvwxz";
+    static char const vowels[] = "aeiou";
+    uint32 value = m_options.firstAccount + m_index;
+    std::string name = "Swarm";
+    for (uint32 i = 0; i < 7; ++i)
+    {
+        if (i % 2 == 0)
+        {
+            name += consonants[value % 20];
+            value /= 20;
+        }
+        else
+        {
+            name += vowels[value % 5];
+            value /= 5;
+        }
+    }
+    return name;
+}
+
+void SwarmClient::HandleCharEnum(WorldPacket& packet, uint64 now, SwarmStats& stats)
+{
+    if (m_state != STATE_AWAIT_CHAR_ENUM)
+    {
+        return;
+    }
+
+    Complete(SWARM_REQ_CHAR_ENUM, now, stats);
+
+    uint8 count;
+    packet >> count;
+    if (count == 0)
+    {
+        WorldPacket create(CMSG_CHAR_CREATE, 32);
+        create << CharacterName();
+        create << uint8(m_options.race);
+        create << uint8(m_options.playerClass);
+        create << uint8(m_index % 2);                       // gender
+        create << uint8(0) << uint8(0) << uint8(0) << uint8(0) << uint8(0);
+        create << uint8(0);                                 // outfit
+        Send(create);
+        Begin(SWARM_REQ_CHAR_CREATE, now);
+        m_state = STATE_AWAIT_CHAR_CREATE;
+        return;
+    }
+
+    // Only the first character is used; its guid leads the record.
+    packet >> m_playerGuid;
+
+    WorldPacket login(CMSG_PLAYER_LOGIN, 8);
+    login << m_playerGuid;
+    Send(login);
+    Begin(SWARM_REQ_PLAYER_LOGIN, now);
+    m_state = STATE_AWAIT_LOGIN;
+}
+
+void SwarmClient::HandleCharCreate(WorldPacket& packet, uint64 now, SwarmStats& stats)
+{
+    if (m_state != STATE_AWAIT_CHAR_CREATE)
+    {
+        return;
+    }
+
+    uint8 result;
+    packet >> result;
+    if (result != SWARM_CHAR_CREATE_SUCCESS)
+    {
+        char reason[64];
+        snprintf(reason, sizeof(reason), "character creation refused (code 0x%02X)", result);
+        Fail(reason);
+        return;
+    }
+
+    Complete(SWARM_REQ_CHAR_CREATE, now, stats);
+    SendCharEnum(now);
+}
+
+void SwarmClient::HandleLoginVerifyWorld(WorldPacket& packet, uint64 now, SwarmStats& stats)
+{
+    packet >> m_map >> m_x >> m_y >> m_z >> m_orientation;
+    if (m_state != STATE_AWAIT_LOGIN)
+    {
+        return;
+    }
+
+    Complete(SWARM_REQ_PLAYER_LOGIN, now, stats);
+    m_state = STATE_IN_WORLD;
+    m_nextAction = now + uint64(m_options.actionIntervalMs) * 1000;
+    m_nextTickProbe = now;
+}
+
+void SwarmClient::HandleSpellStart(WorldPacket& packet, uint64 now, SwarmStats& stats)
+{
+    packet.readPackGUID();                                  // cast item or caster
+    uint64 const caster = packet.readPackGUID();
+    uint32 spellId;
+    packet >> spellId;
+    if (caster == m_playerGuid && spellId == m_options.spellId)
+    {
+        Complete(SWARM_REQ_CAST_SPELL, now, stats);
+    }
+}
+
+void SwarmClient::HandleCastFailed(WorldPacket& packet, uint64 now, SwarmStats& stats)
+{
+    uint32 spellId;
+    packet >> spellId;
+    if (spellId == m_options.spellId)
+    {
+        Complete(SWARM_REQ_CAST_SPELL, now, stats);
+    }
+}
+
+void SwarmClient::HandleMessageChat(WorldPacket& packet, uint64 now, SwarmStats& stats)
+{
+    uint8 type;
+    uint32 language;
+    packet >> type >> language;
+
+    if (type == SWARM_CHAT_MSG_SAY)
+    {
+        uint64 sender;
+        packet >> sender;
+        if (sender == m_playerGuid)
+        {
+            Complete(SWARM_REQ_CHAT_SAY, now, stats);
+        }
+        return;
+    }
+
+    if (type != SWARM_CHAT_MSG_SYSTEM || !IsPending(SWARM_REQ_SERVER_INFO))
+    {
+        return;
+    }
+
+    uint64 sender;
+    uint32 length;
+    std::string text;
+    packet >> sender >> length >> text;
+
+    static char const prefix[] = "World Delay: ";
+    std::string::size_type const at = text.find(prefix);
+    if (at != std::string::npos)
+    {
+        stats.RecordServerTick(uint32(strtoul(text.c_str() + at + sizeof(prefix) - 1, NULL, 10)));
+        Complete(SWARM_REQ_SERVER_INFO, now, stats);
+    }
+}
+
+void SwarmClient::HandleTeleportAck(WorldPacket& packet, uint64 now, SwarmStats& stats)
+{
+    uint64 const guid = packet.readPackGUID();
+    uint32 counter;
+    uint32 moveFlags;
+    uint32 moveTime;
+    packet >> counter >> moveFlags >> moveTime;
+    packet >> m_x >> m_y >> m_z >> m_orientation;
+
+    WorldPacket ack(MSG_MOVE_TELEPORT_ACK, 16);
+    ack << guid;
+    ack << counter;
+    ack << uint32(now / 1000);
+    Send(ack);
+
+    OnTeleported(now, stats);
+}
+
+void SwarmClient::HandleNewWorld(WorldPacket& packet, uint64 now, SwarmStats& stats)
+{
+    packet >> m_map >> m_x >> m_y >> m_z >> m_orientation;
+    Send(WorldPacket(MSG_MOVE_WORLDPORT_ACK, 0));
+    OnTeleported(now, stats);
+}
+
+void SwarmClient::OnTeleported(uint64 now, SwarmStats& stats)
+{
+    m_moving = false;
+    Complete(SWARM_REQ_TELEPORT, now, stats);
+
+    if (m_teleportForAuction && m_auctioneer >= 0)
+    {
+        m_teleportForAuction = false;
+        WorldPacket hello(MSG_AUCTION_HELLO, 8);
+        hello << m_world.auctioneers[m_auctioneer].guid;
+        Send(hello);
+        Begin(SWARM_REQ_AUCTION_HELLO, now);
+    }
+}
+
+void SwarmClient::HandleAuctionHello(WorldPacket& packet, uint64 now, SwarmStats& stats)
+{
+    uint64 auctioneer;
+    packet >> auctioneer;
+    if (!IsPending(SWARM_REQ_AUCTION_HELLO))
+    {
+        return;
+    }
+    Complete(SWARM_REQ_AUCTION_HELLO, now, stats);
+
+    // An empty search for the first page: the broadest and most expensive browse.
+    WorldPacket list(CMSG_AUCTION_LIST_ITEMS, 8 + 4 + 1 + 1 + 1 + 4 * 4 + 1);
+    list << auctioneer;
+    list << uint32(0);                                      // list from
+    list << std::string();                                  // name filter
+    list << uint8(0) << uint8(0);                           // level range
+    list << uint32(0xFFFFFFFF);                             // inventory slot
+    list << uint32(0xFFFFFFFF);                             // item class
+    list << uint32(0xFFFFFFFF);                             // item subclass
+    list << uint32(0xFFFFFFFF);                             // quality
+    list << uint8(0);                                       // usable only
+    Send(list);
+    Begin(SWARM_REQ_AUCTION_LIST, now);
+}
+
+void SwarmClient::Update(uint64 now, std::mt19937& rng, SwarmStats& stats)
+{
+    if (m_packetsIn || m_packetsOut || m_bytesIn || m_bytesOut)
+    {
+        stats.RecordTraffic(m_packetsIn, m_bytesIn, m_packetsOut, m_bytesOut);
+        m_packetsIn = m_bytesIn = m_packetsOut = m_bytesOut = 0;
+    }
+
+    if (m_state == STATE_CLOSED || m_state == STATE_IDLE)
+    {
+        return;
+    }
+
+    uint64 const timeout = uint64(m_options.requestTimeoutMs) * 1000;
+    for (uint32 i = 0; i < SWARM_REQ_COUNT; ++i)
+    {
+        if (m_pending[i] != 0 && now - m_pending[i] > timeout)
+        {
+            stats.RecordTimeout(SwarmRequest(i));
+            m_pending[i] = 0;
+
+            if (i == SWARM_REQ_AUCTION_HELLO && m_auctioneer >= 0)
+            {
+                m_world.unusableAuctioneers[m_auctioneer] = true;
+                m_auctioneer = -1;
+            }
+            if (i == SWARM_REQ_TELEPORT)
+            {
+                m_auctioneer = -1;
+                m_teleportForAuction = false;
+            }
+            // The login steps lead the enum; a client stuck in them is lost.
+            if (i <= SWARM_REQ_PLAYER_LOGIN)
+            {
+                Fail("login sequence timed out");
+                return;
+            }
+        }
+    }
+
+    if (m_state != STATE_IN_WORLD)
+    {
+        return;
+    }
+
+    UpdateWalk(now);
+
+    if (m_index == 0 && m_options.tickProbeSec != 0 && now >= m_nextTickProbe)
+    {
+        m_nextTickProbe = now + uint64(m_options.tickProbeSec) * 1000000;
+        if (!IsPending(SWARM_REQ_SERVER_INFO))
+        {
+            SendChatSay(".server info", now);
+            Begin(SWARM_REQ_SERVER_INFO, now);
+        }
+    }
+
+    if (now >= m_nextAction)
+    {
+        std::uniform_int_distribution<uint32> jitter(m_options.actionIntervalMs / 2,
+            m_options.actionIntervalMs + m_options.actionIntervalMs / 2);
+        m_nextAction = now + uint64(jitter(rng)) * 1000;
+        RunAction(now, rng);
+    }
+}
+
+void SwarmClient::RunAction(uint64 now, std::mt19937& rng)
+{
+    SwarmBehaviourMix const& mix = m_options.mix;
+    uint32 const total = mix.Total();
+    if (total == 0 || IsPending(SWARM_REQ_TELEPORT))
+    {
+        return;
+    }
+
+    uint32 roll = std::uniform_int_distribution<uint32>(0, total - 1)(rng);
+    if (roll < mix.walk)
+    {
+        ActWalk(now, rng);
+        return;
+    }
+    roll -= mix.walk;
+    if (roll < mix.cast)
+    {
+        ActCast(now);
+        return;
+    }
+    roll -= mix.cast;
+    if (roll < mix.chat)
+    {
+        ActChat(now, rng);
+        return;
+    }
+    roll -= mix.chat;
+    if (roll < mix.auction)
+    {
+        ActAuction(now, rng);
+        return;
+    }
+    roll -= mix.auction;
+    if (roll < mix.zone)
+    {
+        ActZone(now, rng);
+        return;
+    }
+    ActPing(now);
+}
+
+void SwarmClient::SendMovement(uint16 opcode, uint32 moveFlags, uint64 now)
+{
+    WorldPacket move(opcode, 4 + 4 + 4 * 4 + 4);
+    move << uint32(moveFlags);
+    move << uint32(now / 1000);
+    move << m_x << m_y << m_z << m_orientation;
+    move << uint32(0);                                      // fall time
+    Send(move);
+}
+
+void SwarmClient::ActWalk(uint64 now, std::mt19937& rng)
+{
+    if (m_moving)
+    {
+        return;
+    }
+
+    m_orientation = std::uniform_real_distribution<float>(0.0f, 6.2831853f)(rng);
+    m_moving = true;
+    m_lastMoveUpdate = now;
+    m_nextHeartbeat = now + SWARM_HEARTBEAT_US;
+    m_moveUntil = now + uint64(std::uniform_int_distribution<uint32>(2000, 4000)(rng)) * 1000;
+    SendMovement(MSG_MOVE_START_FORWARD, SWARM_MOVEFLAG_FORWARD, now);
+}
+
+void SwarmClient::UpdateWalk(uint64 now)
+{
+    if (!m_moving)
+    {
+        return;
+    }
+
+    if (now < m_nextHeartbeat && now < m_moveUntil)
+    {
+        return;
+    }
+
+    float const seconds = float(now - m_lastMoveUpdate) / 1000000.0f;
+    m_x += std::cos(m_orientation) * SWARM_RUN_SPEED * seconds;
+    m_y += std::sin(m_orientation) * SWARM_RUN_SPEED * seconds;
+    m_lastMoveUpdate = now;
+
+    if (now >= m_moveUntil)
+    {
+        m_moving = false;
+        SendMovement(MSG_MOVE_STOP, 0, now);
+        return;
+    }
+
+    m_nextHeartbeat = now + SWARM_HEARTBEAT_US;
+    SendMovement(MSG_MOVE_HEARTBEAT, SWARM_MOVEFLAG_FORWARD, now);
+}
+
+void SwarmClient::ActCast(uint64 now)
+{
+    if (IsPending(SWARM_REQ_CAST_SPELL) || m_moving)
+    {
+        return;
+    }
+
+    WorldPacket cast(CMSG_CAST_SPELL, 4 + 2);
+    cast << uint32(m_options.spellId);
+    cast << uint16(0);                                      // TARGET_FLAG_SELF
+    Send(cast);
+    Begin(SWARM_REQ_CAST_SPELL, now);
+}
+
+void SwarmClient::SendChatSay(std::string const& text, uint64 /*now*/)
+{
+    WorldPacket chat(CMSG_MESSAGECHAT, 4 + 4 + text.size() + 1);
+    chat << uint32(SWARM_CHAT_MSG_SAY);
+    chat << uint32(SWARM_LANG_COMMON);
+    chat << text;
+    Send(chat);
+}
+
+void SwarmClient::ActChat(uint64 now, std::mt19937& rng)
+{
+    if (IsPending(SWARM_REQ_CHAT_SAY))
+    {
+        return;
+    }
+
+    static char const* const lines[] =
+    {
+        "LFG anything", "wts [Linen Cloth] x20", "anyone seen the mailbox?",
+        "lag?", "selling copper ore, pst", "where is the flight master"
+    };
+    SendChatSay(lines[std::uniform_int_distribution<uint32>(0, 5)(rng)], now);
+    Begin(SWARM_REQ_CHAT_SAY, now);
+}
+
+void SwarmClient::SendTeleport(SwarmLocation const& location, uint64 now)
+{
+    char command[128];
+    snprintf(command, sizeof(command), ".go xyz %.2f %.2f %.2f %u",
+        location.x, location.y, location.z, location.map);
+    m_moving = false;
+    SendChatSay(command, now);
+    Begin(SWARM_REQ_TELEPORT, now);
+}
+
+void SwarmClient::ActAuction(uint64 now, std::mt19937& rng)
+{
+    std::vector<SwarmAuctioneer> const& auctioneers = m_world.auctioneers;
+    if (auctioneers.empty() || IsPending(SWARM_REQ_AUCTION_HELLO)
+        || IsPending(SWARM_REQ_AUCTION_LIST))
+    {
+        return;
+    }
+
+    // Browse again where we stand if the last visit worked, otherwise try
+    // another usable auctioneer (a few random probes are plenty).
+    int32 target = m_auctioneer;
+    if (target < 0 || m_world.unusableAuctioneers[target])
+    {
+        target = -1;
+        for (uint32 attempt = 0; attempt < 8 && target < 0; ++attempt)
+        {
+            uint32 const pick = std::uniform_int_distribution<uint32>(0, uint32(auctioneers.size()) - 1)(rng);
+            if (!m_world.unusableAuctioneers[pick])
+            {
+                target = int32(pick);
+            }
+        }
+        if (target < 0)
+        {
+            return;
+        }
+
+        m_auctioneer = target;
+        m_teleportForAuction = true;
+        SendTeleport(auctioneers[target].where, now);
+        return;
+    }
+
+    WorldPacket hello(MSG_AUCTION_HELLO, 8);
+    hello << auctioneers[target].guid;
+    Send(hello);
+    Begin(SWARM_REQ_AUCTION_HELLO, now);
+}
+
+void SwarmClient::ActZone(uint64 now, std::mt19937& rng)
+{
+    std::vector<SwarmLocation> const& destinations = m_world.destinations;
+    if (destinations.empty())
+    {
+        return;
+    }
+
+    m_auctioneer = -1;
+    m_teleportForAuction = false;
+    SendTeleport(destinations[std::uniform_int_distribution<uint32>(0,
+        uint32(destinations.size()) - 1)(rng)], now);
+}
+
+void SwarmClient::ActPing(uint64 now)
+{
+    if (IsPending(SWARM_REQ_PING))
+    {
+        return;
+    }
+
+    WorldPacket ping(CMSG_PING, 8);
+    ping << uint32(++m_pingSequence);
+    ping << uint32(0);                                      // latency
+    Send(ping);
+    Begin(SWARM_REQ_PING, now);
+}
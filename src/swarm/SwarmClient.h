@@ -0,0 +1,186 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2025 MaNGOS <https://www.getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+
+#ifndef MANGOS_SWARM_SWARMCLIENT_H
+#define MANGOS_SWARM_SWARMCLIENT_H
+
+#include "Swarm.h"
+#include "SwarmStats.h"
+#include "Auth/AuthCrypt.h"
+#include "PacketCodec.h"
+#include "Utilities/WorldPacket.h"
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include <sys/socket.h>
+
+/**
+ * One synthetic 1.12 client.
+ *
+ * Owns a non-blocking socket, a client-role PacketCodec and the client end of
+ * the header crypt. Walks the login sequence on its own (challenge, auth
+ * session, character enum/create, player login) and, once in the world, runs
+ * one scripted action every @c actionIntervalMs: walking, casting, saying
+ * something, browsing an auction house, changing zone or pinging.
+ *
+ * A client is driven by exactly one swarm worker thread and is not
+ * thread-safe; the only state it shares is the auctioneer "unusable" flags.
+ */
+class SwarmClient
+{
+    public:
+        SwarmClient(uint32 index, SwarmAccount const& account,
+            SwarmOptions const& options, SwarmWorldData& world);
+        ~SwarmClient();
+
+        /// Start a non-blocking connect. False if the socket could not even be created.
+        bool Connect(sockaddr const* address, socklen_t addressLength, uint64 now);
+        void Close();
+
+        int GetSocket() const
+        {
+            return m_socket;
+        }
+
+        bool IsClosed() const
+        {
+            return m_state == STATE_CLOSED;
+        }
+
+        bool IsInWorld() const
+        {
+            return m_state == STATE_IN_WORLD;
+        }
+
+        /// True once the client had to give up (refused login, broken stream, ...).
+        bool HasFailed() const
+        {
+            return m_failed;
+        }
+
+        bool WantsWrite() const
+        {
+            return m_state == STATE_CONNECTING || m_sendOffset < m_sendBuffer.size();
+        }
+
+        void OnReadable(uint64 now, SwarmStats& stats);
+        void OnWritable(uint64 now, SwarmStats& stats);
+
+        /// Expire overdue round trips and run the behaviour script.
+        void Update(uint64 now, std::mt19937& rng, SwarmStats& stats);
+
+    private:
+        enum State
+        {
+            STATE_IDLE,
+            STATE_CONNECTING,
+            STATE_AWAIT_CHALLENGE,
+            STATE_AWAIT_AUTH,
+            STATE_AWAIT_CHAR_ENUM,
+            STATE_AWAIT_CHAR_CREATE,
+            STATE_AWAIT_LOGIN,
+            STATE_IN_WORLD,
+            STATE_CLOSED
+        };
+
+        void Fail(char const* reason);
+        void Send(WorldPacket const& packet);
+        void FlushSend();
+
+        void Begin(SwarmRequest request, uint64 now);
+        void Complete(SwarmRequest request, uint64 now, SwarmStats& stats);
+        bool IsPending(SwarmRequest request) const
+        {
+            return m_pending[request] != 0;
+        }
+
+        void HandlePacket(WorldPacket& packet, uint64 now, SwarmStats& stats);
+        void HandleAuthChallenge(WorldPacket& packet, uint64 now);
+        void HandleAuthResponse(WorldPacket& packet, uint64 now, SwarmStats& stats);
+        void HandleCharEnum(WorldPacket& packet, uint64 now, SwarmStats& stats);
+        void HandleCharCreate(WorldPacket& packet, uint64 now, SwarmStats& stats);
+        void HandleLoginVerifyWorld(WorldPacket& packet, uint64 now, SwarmStats& stats);
+        void HandleSpellStart(WorldPacket& packet, uint64 now, SwarmStats& stats);
+        void HandleCastFailed(WorldPacket& packet, uint64 now, SwarmStats& stats);
+        void HandleMessageChat(WorldPacket& packet, uint64 now, SwarmStats& stats);
+        void HandleTeleportAck(WorldPacket& packet, uint64 now, SwarmStats& stats);
+        void HandleNewWorld(WorldPacket& packet, uint64 now, SwarmStats& stats);
+        void HandleAuctionHello(WorldPacket& packet, uint64 now, SwarmStats& stats);
+
+        void SendCharEnum(uint64 now);
+        void SendChatSay(std::string const& text, uint64 now);
+        void SendMovement(uint16 opcode, uint32 moveFlags, uint64 now);
+        void SendTeleport(SwarmLocation const& location, uint64 now);
+
+        void RunAction(uint64 now, std::mt19937& rng);
+        void ActWalk(uint64 now, std::mt19937& rng);
+        void ActCast(uint64 now);
+        void ActChat(uint64 now, std::mt19937& rng);
+        void ActAuction(uint64 now, std::mt19937& rng);
+        void ActZone(uint64 now, std::mt19937& rng);
+        void ActPing(uint64 now);
+        void UpdateWalk(uint64 now);
+        void OnTeleported(uint64 now, SwarmStats& stats);
+
+        std::string CharacterName() const;
+
+        uint32 m_index;
+        SwarmAccount const& m_account;
+        SwarmOptions const& m_options;
+        SwarmWorldData& m_world;
+
+        int m_socket;
+        State m_state;
+        bool m_failed;
+        AuthCrypt m_crypt;
+        proto::PacketCodec m_codec;
+        std::vector<uint8> m_sendBuffer;
+        std::size_t m_sendOffset;
+        std::vector<WorldPacket> m_received;
+
+        uint64 m_pending[SWARM_REQ_COUNT];
+        uint64 m_packetsIn;
+        uint64 m_bytesIn;
+        uint64 m_packetsOut;
+        uint64 m_bytesOut;
+
+        uint64 m_playerGuid;
+        uint32 m_map;
+        float m_x, m_y, m_z, m_orientation;
+        uint32 m_pingSequence;
+
+        uint64 m_nextAction;
+        uint64 m_nextTickProbe;
+        bool m_moving;
+        uint64 m_moveUntil;
+        uint64 m_lastMoveUpdate;
+        uint64 m_nextHeartbeat;
+        int32 m_auctioneer;                                 ///< index being visited, -1 = none
+        bool m_teleportForAuction;
+};
+
+#endif
@@ -0,0 +1,175 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2025 MaNGOS <https://www.getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+
+#include "SwarmSetup.h"
+#include "Auth/Sha1.h"
+#include "Log/Log.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <random>
+
+/// Accounts written per INSERT statement while provisioning.
+static const uint32 SWARM_ACCOUNT_BATCH = 250;
+
+/// Bytes of the synthetic session key K (matches what realmd stores).
+static const uint32 SWARM_SESSION_KEY_BYTES = 40;
+
+static std::string SwarmHex(uint8 const* data, std::size_t len)
+{
+    static char const digits[] = "0123456789ABCDEF";
+    std::string hex;
+    hex.reserve(len * 2);
+    for (std::size_t i = 0; i < len; ++i)
+    {
+        hex += digits[data[i] >> 4];
+        hex += digits[data[i] & 0x0F];
+    }
+    return hex;
+}
+
+static std::string SwarmPasswordHash(std::string const& name)
+{
+    Sha1Hash sha;
+    sha.Initialize();
+    sha.UpdateData(name + ":" + name);
+    sha.Finalize();
+    return SwarmHex(sha.GetDigest(), sha.GetLength());
+}
+
+bool SwarmProvisionAccounts(DatabaseType& loginDatabase, SwarmOptions const& options,
+    std::vector<SwarmAccount>& accounts)
+{
+    std::random_device seed;
+    std::mt19937 rng(seed());
+    std::uniform_int_distribution<uint32> byte(0, 255);
+
+    accounts.clear();
+    accounts.reserve(options.clients);
+    for (uint32 i = 0; i < options.clients; ++i)
+    {
+        char name[32];
+        snprintf(name, sizeof(name), "SWARM%05u", options.firstAccount + i);
+
+        uint8 key[SWARM_SESSION_KEY_BYTES];
+        for (uint32 b = 0; b < SWARM_SESSION_KEY_BYTES; ++b)
+        {
+            key[b] = uint8(byte(rng));
+        }
+        key[0] |= 0x80;                                     // keep K exactly 40 bytes long
+
+        SwarmAccount account;
+        account.name = name;
+        account.sessionKey = SwarmHex(key, sizeof(key));
+        accounts.push_back(account);
+    }
+
+    for (uint32 first = 0; first < accounts.size(); first += SWARM_ACCOUNT_BATCH)
+    {
+        uint32 const last = std::min<uint32>(first + SWARM_ACCOUNT_BATCH, uint32(accounts.size()));
+        std::string sql = "INSERT INTO `account` (`username`, `sha_pass_hash`, `gmlevel`, `sessionkey`) VALUES ";
+        for (uint32 i = first; i < last; ++i)
+        {
+            char row[256];
+            snprintf(row, sizeof(row), "%s('%s', '%s', %u, '%s')",
+                i == first ? "" : ", ",
+                accounts[i].name.c_str(), SwarmPasswordHash(accounts[i].name).c_str(),
+                options.gmLevel, accounts[i].sessionKey.c_str());
+            sql += row;
+        }
+        sql += " ON DUPLICATE KEY UPDATE `gmlevel` = VALUES(`gmlevel`), "
+            "`sessionkey` = VALUES(`sessionkey`), `locked` = 0";
+
+        if (!loginDatabase.DirectExecute(sql.c_str()))
+        {
+            sLog.outError("swarm: could not provision accounts %s..%s",
+                accounts[first].name.c_str(), accounts[last - 1].name.c_str());
+            return false;
+        }
+    }
+
+    sLog.outString("swarm: provisioned %u accounts (%s..%s, gm level %u)",
+        uint32(accounts.size()), accounts.front().name.c_str(),
+        accounts.back().name.c_str(), options.gmLevel);
+    return true;
+}
+
+bool SwarmLoadWorldData(DatabaseType& worldDatabase, SwarmWorldData& data)
+{
+    data.destinations.clear();
+    data.auctioneers.clear();
+
+    // Only the two continents: instance maps refuse a plain ".go xyz".
+    if (QueryResult* result = worldDatabase.Query(
+        "SELECT `map`, `position_x`, `position_y`, `position_z` FROM `game_tele` "
+        "WHERE `map` IN (0, 1)"))
+    {
+        do
+        {
+            Field* fields = result->Fetch();
+            SwarmLocation location;
+            location.map = fields[0].GetUInt32();
+            location.x = fields[1].GetFloat();
+            location.y = fields[2].GetFloat();
+            location.z = fields[3].GetFloat();
+            data.destinations.push_back(location);
+        }
+        while (result->NextRow());
+        delete result;
+    }
+
+    if (QueryResult* result = worldDatabase.Query(
+        "SELECT `c`.`guid`, `c`.`id`, `c`.`map`, `c`.`position_x`, `c`.`position_y`, `c`.`position_z` "
+        "FROM `creature` AS `c` JOIN `creature_template` AS `t` ON `t`.`Entry` = `c`.`id` "
+        "WHERE (`t`.`NpcFlags` & 0x1000) != 0 AND `c`.`map` IN (0, 1)"))
+    {
+        do
+        {
+            Field* fields = result->Fetch();
+            uint64 const lowGuid = fields[0].GetUInt32();
+            uint64 const entry = fields[1].GetUInt32();
+
+            SwarmAuctioneer auctioneer;
+            auctioneer.guid = (uint64(0xF130) << 48) | (entry << 24) | lowGuid;
+            auctioneer.where.map = fields[2].GetUInt32();
+            auctioneer.where.x = fields[3].GetFloat();
+            auctioneer.where.y = fields[4].GetFloat();
+            auctioneer.where.z = fields[5].GetFloat();
+            data.auctioneers.push_back(auctioneer);
+        }
+        while (result->NextRow());
+        delete result;
+    }
+
+    data.unusableAuctioneers.reset(new std::atomic<bool>[data.auctioneers.size() + 1]);
+    for (std::size_t i = 0; i < data.auctioneers.size(); ++i)
+    {
+        data.unusableAuctioneers[i] = false;
+    }
+
+    sLog.outString("swarm: %u teleport destinations, %u auctioneers",
+        uint32(data.destinations.size()), uint32(data.auctioneers.size()));
+    return true;
+}
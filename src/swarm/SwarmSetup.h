@@ -0,0 +1,51 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2025 MaNGOS <https://www.getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+
+#ifndef MANGOS_SWARM_SWARMSETUP_H
+#define MANGOS_SWARM_SWARMSETUP_H
+
+#include "Swarm.h"
+#include "Database/DatabaseEnv.h"
+
+#include <vector>
+
+/**
+ * Create or refresh the swarm accounts in the realmd database.
+ *
+ * Accounts are named SWARMnnnnn from @c options.firstAccount on, get the
+ * configured gm level, a password equal to their name and a fresh random
+ * session key, which is returned alongside the name so the clients can pass
+ * the world server's proof without going through realmd.
+ */
+bool SwarmProvisionAccounts(DatabaseType& loginDatabase, SwarmOptions const& options,
+    std::vector<SwarmAccount>& accounts);
+
+/**
+ * Load the teleport destinations (continent rows of game_tele) and the
+ * continent auctioneer spawns the scripted behaviours pick from.
+ */
+bool SwarmLoadWorldData(DatabaseType& worldDatabase, SwarmWorldData& data);
+
+#endif
@@ -0,0 +1,233 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2025 MaNGOS <https://www.getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+
+#include "SwarmStats.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+char const* SwarmRequestName(SwarmRequest request)
+{
+    switch (request)
+    {
+        case SWARM_REQ_AUTH:          return "CMSG_AUTH_SESSION";
+        case SWARM_REQ_CHAR_ENUM:     return "CMSG_CHAR_ENUM";
+        case SWARM_REQ_CHAR_CREATE:   return "CMSG_CHAR_CREATE";
+        case SWARM_REQ_PLAYER_LOGIN:  return "CMSG_PLAYER_LOGIN";
+        case SWARM_REQ_PING:          return "CMSG_PING";
+        case SWARM_REQ_CAST_SPELL:    return "CMSG_CAST_SPELL";
+        case SWARM_REQ_CHAT_SAY:      return "CMSG_MESSAGECHAT (say)";
+        case SWARM_REQ_TELEPORT:      return "teleport (.go xyz)";
+        case SWARM_REQ_AUCTION_HELLO: return "MSG_AUCTION_HELLO";
+        case SWARM_REQ_AUCTION_LIST:  return "CMSG_AUCTION_LIST_ITEMS";
+        case SWARM_REQ_SERVER_INFO:   return "server info (.server info)";
+        default:                      return "unknown";
+    }
+}
+
+LatencyHistogram::LatencyHistogram()
+{
+    Reset();
+}
+
+uint32 LatencyHistogram::BucketOf(uint64 micros)
+{
+    if (micros < LINEAR_BUCKETS)
+    {
+        return uint32(micros);
+    }
+
+    uint32 msb = 5;
+    while (msb < 63 && (micros >> (msb + 1)) != 0)
+    {
+        ++msb;
+    }
+
+    uint32 const top = uint32(micros >> (msb - 4));        // 16..31
+    return LINEAR_BUCKETS + (msb - 5) * SUB_BUCKETS + (top - SUB_BUCKETS);
+}
+
+uint64 LatencyHistogram::BucketUpperBound(uint32 bucket)
+{
+    if (bucket < LINEAR_BUCKETS)
+    {
+        return bucket;
+    }
+
+    uint32 const index = bucket - LINEAR_BUCKETS;
+    uint32 const msb = index / SUB_BUCKETS + 5;
+    uint64 const top = index % SUB_BUCKETS + SUB_BUCKETS;
+    if (msb == 63 && top == 2 * SUB_BUCKETS - 1)
+    {
+        return std::numeric_limits<uint64>::max();
+    }
+    return ((top + 1) << (msb - 4)) - 1;
+}
+
+void LatencyHistogram::Record(uint64 micros)
+{
+    ++m_counts[BucketOf(micros)];
+    ++m_count;
+    m_max = std::max(m_max, micros);
+}
+
+void LatencyHistogram::Merge(LatencyHistogram const& other)
+{
+    for (uint32 i = 0; i < BUCKET_COUNT; ++i)
+    {
+        m_counts[i] += other.m_counts[i];
+    }
+    m_count += other.m_count;
+    m_max = std::max(m_max, other.m_max);
+}
+
+void LatencyHistogram::Reset()
+{
+    m_counts.fill(0);
+    m_count = 0;
+    m_max = 0;
+}
+
+uint64 LatencyHistogram::Percentile(double fraction) const
+{
+    if (m_count == 0)
+    {
+        return 0;
+    }
+
+    uint64 const wanted = std::max<uint64>(1, uint64(std::ceil(fraction * double(m_count))));
+    uint64 seen = 0;
+    for (uint32 i = 0; i < BUCKET_COUNT; ++i)
+    {
+        seen += m_counts[i];
+        if (seen >= wanted)
+        {
+            return std::min(BucketUpperBound(i), m_max);
+        }
+    }
+    return m_max;
+}
+
+SwarmStats::SwarmStats()
+{
+    Reset();
+}
+
+void SwarmStats::RecordRoundTrip(SwarmRequest request, uint64 micros)
+{
+    m_roundTrips[request].Record(micros);
+}
+
+void SwarmStats::RecordTimeout(SwarmRequest request)
+{
+    ++m_timeouts[request];
+}
+
+void SwarmStats::RecordServerTick(uint32 millis)
+{
+    m_serverTick.Record(uint64(millis) * 1000);
+}
+
+void SwarmStats::RecordTraffic(uint64 packetsIn, uint64 bytesIn, uint64 packetsOut, uint64 bytesOut)
+{
+    m_packetsIn += packetsIn;
+    m_bytesIn += bytesIn;
+    m_packetsOut += packetsOut;
+    m_bytesOut += bytesOut;
+}
+
+void SwarmStats::Merge(SwarmStats const& other)
+{
+    for (uint32 i = 0; i < SWARM_REQ_COUNT; ++i)
+    {
+        m_roundTrips[i].Merge(other.m_roundTrips[i]);
+        m_timeouts[i] += other.m_timeouts[i];
+    }
+    m_serverTick.Merge(other.m_serverTick);
+    m_packetsIn += other.m_packetsIn;
+    m_bytesIn += other.m_bytesIn;
+    m_packetsOut += other.m_packetsOut;
+    m_bytesOut += other.m_bytesOut;
+}
+
+void SwarmStats::Reset()
+{
+    for (uint32 i = 0; i < SWARM_REQ_COUNT; ++i)
+    {
+        m_roundTrips[i].Reset();
+    }
+    m_timeouts.fill(0);
+    m_serverTick.Reset();
+    m_packetsIn = m_bytesIn = m_packetsOut = m_bytesOut = 0;
+}
+
+static double ToMillis(uint64 micros)
+{
+    return double(micros) / 1000.0;
+}
+
+void SwarmStats::Print(FILE* out, char const* title, double seconds) const
+{
+    if (seconds <= 0.0)
+    {
+        seconds = 1.0;
+    }
+
+    fprintf(out, "== %s (%.1fs) ==\n", title, seconds);
+    fprintf(out, "%-28s %9s %9s %9s %9s %9s %9s\n",
+        "round trip", "count", "p50 ms", "p90 ms", "p99 ms", "max ms", "timeouts");
+    for (uint32 i = 0; i < SWARM_REQ_COUNT; ++i)
+    {
+        LatencyHistogram const& histogram = m_roundTrips[i];
+        if (histogram.Count() == 0 && m_timeouts[i] == 0)
+        {
+            continue;
+        }
+
+        fprintf(out, "%-28s %9llu %9.2f %9.2f %9.2f %9.2f %9llu\n",
+            SwarmRequestName(SwarmRequest(i)),
+            (unsigned long long)histogram.Count(),
+            ToMillis(histogram.Percentile(0.50)),
+            ToMillis(histogram.Percentile(0.90)),
+            ToMillis(histogram.Percentile(0.99)),
+            ToMillis(histogram.Max()),
+            (unsigned long long)m_timeouts[i]);
+    }
+
+    if (m_serverTick.Count() != 0)
+    {
+        fprintf(out, "server tick (World Delay): %llu samples, p50 %.0f ms, p90 %.0f ms, p99 %.0f ms, max %.0f ms\n",
+            (unsigned long long)m_serverTick.Count(),
+            ToMillis(m_serverTick.Percentile(0.50)),
+            ToMillis(m_serverTick.Percentile(0.90)),
+            ToMillis(m_serverTick.Percentile(0.99)),
+            ToMillis(m_serverTick.Max()));
+    }
+
+    fprintf(out, "traffic: in %.0f pkt/s %.1f KiB/s, out %.0f pkt/s %.1f KiB/s\n",
+        double(m_packetsIn) / seconds, double(m_bytesIn) / 1024.0 / seconds,
+        double(m_packetsOut) / seconds, double(m_bytesOut) / 1024.0 / seconds);
+}
@@ -0,0 +1,141 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2025 MaNGOS <https://www.getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+
+#ifndef MANGOS_SWARM_SWARMSTATS_H
+#define MANGOS_SWARM_SWARMSTATS_H
+
+#include "Platform/Define.h"
+
+#include <array>
+#include <cstdio>
+
+/**
+ * @file SwarmStats.h
+ * @brief Latency histograms and counters gathered by the client swarm.
+ *
+ * Every request the swarm makes that the server answers is timed from the
+ * moment its frame is queued to the moment the answering packet is decoded.
+ * Samples land in fixed log-linear buckets, so recording is allocation free
+ * and per-thread histograms merge by simple addition.
+ */
+
+/// Round trips the swarm measures; each names the request that starts the clock.
+enum SwarmRequest
+{
+    SWARM_REQ_AUTH,             ///< CMSG_AUTH_SESSION -> SMSG_AUTH_RESPONSE
+    SWARM_REQ_CHAR_ENUM,        ///< CMSG_CHAR_ENUM -> SMSG_CHAR_ENUM
+    SWARM_REQ_CHAR_CREATE,      ///< CMSG_CHAR_CREATE -> SMSG_CHAR_CREATE
+    SWARM_REQ_PLAYER_LOGIN,     ///< CMSG_PLAYER_LOGIN -> SMSG_LOGIN_VERIFY_WORLD
+    SWARM_REQ_PING,             ///< CMSG_PING -> SMSG_PONG
+    SWARM_REQ_CAST_SPELL,       ///< CMSG_CAST_SPELL -> SMSG_SPELL_START / SMSG_CAST_FAILED
+    SWARM_REQ_CHAT_SAY,         ///< CMSG_MESSAGECHAT -> own SMSG_MESSAGECHAT echo
+    SWARM_REQ_TELEPORT,         ///< ".go xyz" -> MSG_MOVE_TELEPORT_ACK / SMSG_NEW_WORLD
+    SWARM_REQ_AUCTION_HELLO,    ///< MSG_AUCTION_HELLO -> MSG_AUCTION_HELLO
+    SWARM_REQ_AUCTION_LIST,     ///< CMSG_AUCTION_LIST_ITEMS -> SMSG_AUCTION_LIST_RESULT
+    SWARM_REQ_SERVER_INFO,      ///< ".server info" -> "World Delay" system line
+    SWARM_REQ_COUNT
+};
+
+/// Printable name of a measured round trip.
+char const* SwarmRequestName(SwarmRequest request);
+
+/**
+ * Log-linear latency histogram in microseconds.
+ *
+ * Values below 32us get an exact bucket; above that every power of two is
+ * split into 16 sub-buckets, which keeps any reported percentile within ~6%
+ * of the true sample.
+ */
+class LatencyHistogram
+{
+    public:
+        LatencyHistogram();
+
+        void Record(uint64 micros);
+        void Merge(LatencyHistogram const& other);
+        void Reset();
+
+        uint64 Count() const
+        {
+            return m_count;
+        }
+
+        uint64 Max() const
+        {
+            return m_max;
+        }
+
+        /// Upper bound of the bucket holding the given fraction (0..1) of samples.
+        uint64 Percentile(double fraction) const;
+
+    private:
+        static const uint32 LINEAR_BUCKETS = 32;
+        static const uint32 SUB_BUCKETS = 16;
+        static const uint32 BUCKET_COUNT = LINEAR_BUCKETS + 59 * SUB_BUCKETS;
+
+        static uint32 BucketOf(uint64 micros);
+        static uint64 BucketUpperBound(uint32 bucket);
+
+        std::array<uint64, BUCKET_COUNT> m_counts;
+        uint64 m_count;
+        uint64 m_max;
+};
+
+/**
+ * Everything one reporting window observed.
+ *
+ * Each swarm worker thread owns one of these; the reporter merges them into a
+ * window total and a run total, so recording never contends across threads.
+ */
+class SwarmStats
+{
+    public:
+        SwarmStats();
+
+        void RecordRoundTrip(SwarmRequest request, uint64 micros);
+        void RecordTimeout(SwarmRequest request);
+        void RecordServerTick(uint32 millis);
+        void RecordTraffic(uint64 packetsIn, uint64 bytesIn, uint64 packetsOut, uint64 bytesOut);
+
+        void Merge(SwarmStats const& other);
+        void Reset();
+
+        /**
+         * Print the per-request latency table, server tick percentiles and
+         * traffic rates for a window of the given length.
+         */
+        void Print(FILE* out, char const* title, double seconds) const;
+
+    private:
+        std::array<LatencyHistogram, SWARM_REQ_COUNT> m_roundTrips;
+        std::array<uint64, SWARM_REQ_COUNT> m_timeouts;
+        LatencyHistogram m_serverTick;
+        uint64 m_packetsIn;
+        uint64 m_bytesIn;
+        uint64 m_packetsOut;
+        uint64 m_bytesOut;
+};
+
+#endif
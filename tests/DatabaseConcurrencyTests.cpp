@@ -26,9 +26,18 @@
 
 #include "Database/QueryResult.h"
 #include "Database/Database.h"
+#include "Database/SqlOperations.h"
+#include "Database/SqlProfiler.h"
+#include "Database/SqlSnapshot.h"
+#include "Threading/TaskGraph.h"
 
 #include <atomic>
 #include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <set>
 #include <string>
 #include <thread>
 #include <vector>
@@ -156,11 +165,629 @@ void escapingSharesTheQueryConnectionLock()
 
     CHECK(!connection.overlap.load());
 }
+
+class RecordingConnection final : public SqlConnection
+{
+public:
+    RecordingConnection(Database& database, std::mutex& lock, std::vector<std::string>& log)
+        : SqlConnection(database), m_lock(lock), m_log(log)
+    {
+    }
+
+    bool Initialize(char const*) override { return true; }
+    QueryResult* Query(char const*) override { return nullptr; }
+    QueryNamedResult* QueryNamed(char const*) override { return nullptr; }
+
+    bool Execute(char const* sql) override
+    {
+        // long enough for the shards to interleave
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+        std::lock_guard<std::mutex> guard(m_lock);
+        m_log.push_back(sql);
+        return std::strstr(sql, "`broken`") == nullptr;
+    }
+
+private:
+    std::mutex& m_lock;
+    std::vector<std::string>& m_log;
+};
+
+class ShardedDatabase final : public Database
+{
+public:
+    std::mutex lock;
+    std::vector<std::string> log;
+
+    void SetBatchRows(uint32 rows) { m_batchRows = rows; }
+
+protected:
+    SqlConnection* CreateConnection() override
+    {
+        return new RecordingConnection(*this, lock, log);
+    }
+};
+
+std::size_t position(std::vector<std::string> const& log, std::string const& sql)
+{
+    for (std::size_t i = 0; i < log.size(); ++i)
+        if (log[i] == sql)
+            return i;
+    return log.size();
+}
+
+void shardedAsyncWorkKeepsPerKeyAndUnkeyedOrder()
+{
+    unsigned const keys = 6;
+    unsigned const rounds = 20;
+
+    ShardedDatabase database;
+    CHECK(database.Initialize("fake", 1, 3));
+    database.AllowAsyncTransactions();
+    CHECK(database.GetAsyncStats().size() == 4);
+
+    for (unsigned round = 0; round < rounds; ++round)
+    {
+        for (unsigned key = 1; key <= keys; ++key)
+        {
+            Database::ShardKeyScope scope(database, key);
+            database.PExecute("k %u %u", key, round);
+        }
+    }
+    database.PExecute("unkeyed");
+    for (unsigned key = 1; key <= keys; ++key)
+    {
+        Database::ShardKeyScope scope(database, key);
+        database.PExecute("k %u %u", key, rounds);
+    }
+
+    // let the shard threads do the work rather than the drain in HaltDelayThread()
+    uint64 const total = keys * (rounds + 1) + 1;
+    for (unsigned spin = 0; spin < 5000; ++spin)
+    {
+        uint64 executed = 0;
+        for (SqlDelayStats const& shard : database.GetAsyncStats())
+            executed += shard.executed;
+        if (executed == total)
+            break;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    // keyed work spread over the shards; the unkeyed one only had the barrier
+    std::vector<SqlDelayStats> const stats = database.GetAsyncStats();
+    CHECK(stats[0].executed == 1);
+    CHECK(stats[1].executed > 0 && stats[2].executed > 0 && stats[3].executed > 0);
+
+    database.HaltDelayThread();
+
+    std::vector<std::string> const& log = database.log;
+    CHECK(log.size() == total);
+    std::size_t const barrier = position(log, "unkeyed");
+    for (unsigned key = 1; key <= keys; ++key)
+    {
+        std::size_t previous = 0;
+        for (unsigned round = 0; round <= rounds; ++round)
+        {
+            std::size_t const at = position(log, "k " + std::to_string(key) + " " + std::to_string(round));
+            CHECK(at < log.size());
+            CHECK(round == 0 || at > previous);
+            CHECK(round == rounds ? at > barrier : at < barrier);
+            previous = at;
+        }
+    }
+}
+
+void transactionsBatchRunsOfOnePreparedStatement()
+{
+    ShardedDatabase database;
+    CHECK(database.Initialize("fake", 1, 0));
+    CHECK(database.GetBatchRows() == 64);
+
+    static SqlStatementID deleteItems;
+    static SqlStatementID insertItem;
+    static SqlStatementID updateMoney;
+    static SqlStatementID upsert;
+
+    database.BeginTransaction();
+    for (uint32 guid = 1; guid <= 4; ++guid)
+        database.CreateStatement(deleteItems, "DELETE FROM `inv` WHERE `guid` = ?").PExecute(guid);
+    for (uint32 item = 1; item <= 70; ++item)
+        database.CreateStatement(insertItem, "INSERT INTO `inv` (`guid`, `item`) VALUES (?, ?)").PExecute(item % 3, item);
+    for (uint32 guid = 1; guid <= 2; ++guid)
+        database.CreateStatement(updateMoney, "UPDATE `characters` SET `money` = ? WHERE `guid` = ?").PExecute(guid * 10, guid);
+    for (uint32 guid = 1; guid <= 2; ++guid)
+        database.CreateStatement(upsert, "INSERT INTO `t` (`a`) VALUES (?) ON DUPLICATE KEY UPDATE `a` = 1").PExecute(guid);
+    database.CreateStatement(deleteItems, "DELETE FROM `inv` WHERE `guid` = ?").PExecute(5u);
+    CHECK(database.CommitTransaction());
+
+    std::string firstInsert = "INSERT INTO `inv` (`guid`, `item`) VALUES ";
+    for (uint32 item = 1; item <= 64; ++item)
+        firstInsert += (item > 1 ? "," : "") + std::string("('") + std::to_string(item % 3) + "', '" + std::to_string(item) + "')";
+    std::string secondInsert = "INSERT INTO `inv` (`guid`, `item`) VALUES ";
+    for (uint32 item = 65; item <= 68; ++item)
+        secondInsert += (item > 65 ? "," : "") + std::string("('") + std::to_string(item % 3) + "', '" + std::to_string(item) + "')";
+
+    // same rows in the same order; only statements of a batchable shape are folded,
+    // in chunks of 64, 16 or 4 rows and the remainder row by row
+    std::vector<std::string> const expected =
+    {
+        "DELETE FROM `inv` WHERE `guid` IN ('1','2','3','4')",
+        firstInsert,
+        secondInsert,
+        "INSERT INTO `inv` (`guid`, `item`) VALUES ('0', '69')",
+        "INSERT INTO `inv` (`guid`, `item`) VALUES ('1', '70')",
+        "UPDATE `characters` SET `money` = '10' WHERE `guid` = '1'",
+        "UPDATE `characters` SET `money` = '20' WHERE `guid` = '2'",
+        "INSERT INTO `t` (`a`) VALUES ('1') ON DUPLICATE KEY UPDATE `a` = 1",
+        "INSERT INTO `t` (`a`) VALUES ('2') ON DUPLICATE KEY UPDATE `a` = 1",
+        "DELETE FROM `inv` WHERE `guid` = '5'",
+    };
+    CHECK(database.log == expected);
+
+    database.HaltDelayThread();
+}
+
+void commitStatusReportsTheOutcomeOnceRun()
+{
+    ShardedDatabase database;
+    CHECK(database.Initialize("fake", 1, 0));
+
+    std::shared_ptr<SqlCommitStatus> committed = std::make_shared<SqlCommitStatus>();
+    std::shared_ptr<SqlCommitStatus> failed = std::make_shared<SqlCommitStatus>();
+
+    database.BeginTransaction();
+    database.PExecute("UPDATE `characters` SET `money` = 1 WHERE `guid` = 1");
+    CHECK(database.CommitTransaction(committed));
+
+    database.BeginTransaction();
+    database.PExecute("UPDATE `broken` SET `money` = 1 WHERE `guid` = 1");
+    CHECK(database.CommitTransaction(failed));
+
+    database.HaltDelayThread();
+    CHECK(committed->Get() == SqlCommitStatus::COMMITTED);
+    CHECK(failed->Get() == SqlCommitStatus::FAILED);
+}
+
+void batchedInsertsBenchmark()
+{
+    uint32 const rows = 1000;
+    std::size_t statements[2] = {};
+    for (uint32 pass = 0; pass < 2; ++pass)
+    {
+        ShardedDatabase database;
+        CHECK(database.Initialize("fake", 1, 0));
+        database.SetBatchRows(pass ? 64 : 1);
+
+        SqlStatementID insertItem;
+        auto const start = std::chrono::steady_clock::now();
+        database.BeginTransaction();
+        for (uint32 item = 0; item < rows; ++item)
+            database.CreateStatement(insertItem, "INSERT INTO `inv` (`guid`, `item`) VALUES (?, ?)").PExecute(1u, item);
+        CHECK(database.CommitTransaction());
+        double const seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        statements[pass] = database.log.size();
+        std::cout << "batched inserts: " << (pass ? "64 rows" : "1 row") << " per statement, "
+                  << statements[pass] << " round trips, " << uint64(rows / seconds) << " rows/sec\n";
+        database.HaltDelayThread();
+    }
+
+    CHECK(statements[0] == rows);
+    // 15 chunks of 64, then the last 40 rows as 16 + 16 + 4 + 4
+    CHECK(statements[1] == 15 + 4);
+}
+
+class RowsResult final : public QueryResult
+{
+public:
+    // lengths: per value, for values with NULs in them; empty lets Field use strlen
+    explicit RowsResult(std::vector<std::vector<char const*> > const& rows,
+                        std::vector<std::vector<std::size_t> > const& lengths = {})
+        : QueryResult(rows.size(), uint32(rows[0].size())), m_rows(rows), m_lengths(lengths), m_next(0)
+    {
+        mCurrentRow = new Field[mFieldCount];
+        mCurrentRow[0].SetType(MYSQL_TYPE_LONG);
+        for (uint32 i = 1; i < mFieldCount; ++i)
+            mCurrentRow[i].SetType(MYSQL_TYPE_STRING);
+        NextRow();
+    }
+
+    ~RowsResult() override { delete[] mCurrentRow; }
+
+    bool NextRow() override
+    {
+        if (m_next == m_rows.size())
+            return false;
+        for (uint32 i = 0; i < mFieldCount; ++i)
+        {
+            if (m_lengths.empty())
+                mCurrentRow[i].SetValue(m_rows[m_next][i]);
+            else
+                mCurrentRow[i].SetValue(m_rows[m_next][i], m_lengths[m_next][i]);
+        }
+        ++m_next;
+        return true;
+    }
+
+private:
+    std::vector<std::vector<char const*> > m_rows;
+    std::vector<std::vector<std::size_t> > m_lengths;
+    std::size_t m_next;
+};
+
+void snapshotsReplayRowsAndRejectOtherKeys()
+{
+    std::string const file = "database_concurrency_tests.snap";
+    std::vector<std::vector<char const*> > const rows =
+    {
+        { "1", "Defias Thug", nullptr },
+        { "2", "", "it's" },
+        { "42", "Hogger", "gnoll" },
+    };
+
+    QueryResult* captured = SqlSnapshot::Capture(new RowsResult(rows), 7, file);
+    QueryResult* loaded = nullptr;
+    CHECK(SqlSnapshot::Load(file, 7, loaded));
+
+    for (QueryResult* result : { captured, loaded })
+    {
+        CHECK(result && result->GetRowCount() == rows.size() && result->GetFieldCount() == 3);
+        if (!result)
+            continue;
+        CHECK(result->Fetch()[0].GetType() == MYSQL_TYPE_LONG);
+        std::size_t row = 0;
+        do
+        {
+            Field* fields = result->Fetch();
+            CHECK(fields[0].GetUInt32() == uint32(std::stoul(rows[row][0])));
+            CHECK(fields[1].GetCppString() == rows[row][1]);
+            CHECK(rows[row][2] ? fields[2].GetCppString() == rows[row][2] : fields[2].IsNULL());
+            ++row;
+        }
+        while (result->NextRow());
+        CHECK(row == rows.size());
+        delete result;
+    }
+
+    // a table changed since: the snapshot is not used
+    QueryResult* stale = nullptr;
+    CHECK(!SqlSnapshot::Load(file, 8, stale));
+    CHECK(!stale);
+
+    // no result may be a failed query: nothing is written, the old snapshot stays
+    CHECK(SqlSnapshot::Capture(nullptr, 9, file) == nullptr);
+    QueryResult* failed = nullptr;
+    CHECK(!SqlSnapshot::Load(file, 9, failed));
+    CHECK(!failed);
+    CHECK(SqlSnapshot::Load(file, 7, loaded));
+    delete loaded;
+
+    std::remove(file.c_str());
+}
+
+void snapshotsKeepBinaryValuesAndRefuseDamagedFiles()
+{
+    std::string const file = "database_concurrency_tests_binary.snap";
+    char const blob[] = { 'a', '\0', 'b', '\0', 'c' };
+    std::vector<std::vector<char const*> > const rows =
+    {
+        { "1", blob },
+        { "2", "plain" },
+    };
+
+    QueryResult* captured = SqlSnapshot::Capture(new RowsResult(rows, { { 1, sizeof(blob) }, { 1, 5 } }), 3, file);
+    delete captured;
+    QueryResult* loaded = nullptr;
+    CHECK(SqlSnapshot::Load(file, 3, loaded));
+    CHECK(loaded && loaded->GetRowCount() == 2);
+    if (loaded)
+    {
+        Field* fields = loaded->Fetch();
+        CHECK(fields[1].GetLength() == sizeof(blob) && memcmp(fields[1].GetString(), blob, sizeof(blob)) == 0);
+        CHECK(loaded->NextRow());
+        CHECK(loaded->Fetch()[1].GetCppString() == "plain");
+        delete loaded;
+    }
+
+    std::vector<char> bytes;
+    if (FILE* f = std::fopen(file.c_str(), "rb"))
+    {
+        int c;
+        while ((c = std::fgetc(f)) != EOF)
+            bytes.push_back(char(c));
+        std::fclose(f);
+    }
+    CHECK(!bytes.empty());
+
+    // a file cut short anywhere in the rows, or with bytes past them, is refused
+    for (std::size_t keep : { bytes.size() - 1, bytes.size() - 7, bytes.size() + 1 })
+    {
+        std::vector<char> damaged(bytes.begin(), bytes.begin() + std::min(keep, bytes.size()));
+        damaged.resize(keep, 'x');
+        FILE* f = std::fopen(file.c_str(), "wb");
+        std::fwrite(damaged.data(), damaged.size(), 1, f);
+        std::fclose(f);
+
+        QueryResult* partial = nullptr;
+        CHECK(!SqlSnapshot::Load(file, 3, partial));
+        CHECK(!partial);
+    }
+
+    std::remove(file.c_str());
+}
+}
+
+class ThreadRecordingConnection final : public SqlConnection
+{
+public:
+    explicit ThreadRecordingConnection(Database& database)
+        : SqlConnection(database)
+    {
+    }
+
+    bool Initialize(char const*) override { return true; }
+
+    QueryResult* Query(char const*) override
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        std::lock_guard<std::mutex> guard(lock);
+        threads.insert(std::this_thread::get_id());
+        ++queries;
+        return nullptr;
+    }
+
+    QueryResult* QueryStream(char const*) override;
+
+    QueryNamedResult* QueryNamed(char const*) override { return nullptr; }
+    bool Execute(char const*) override { return true; }
+
+    std::mutex lock;
+    std::set<std::thread::id> threads;
+    uint32 queries = 0;
+    uint32 streams = 0;
+};
+
+/// Three rows of one column, holding its connection like a mysql_use_result stream.
+class StreamResult final : public QueryResult
+{
+public:
+    explicit StreamResult(SqlConnection* connection)
+        : QueryResult(0, 1), m_connection(connection), m_next(0)
+    {
+        m_connection->BeginStream();
+        mCurrentRow = new Field[1];
+        mCurrentRow[0].SetType(MYSQL_TYPE_STRING);
+        NextRow();
+    }
+
+    ~StreamResult() override
+    {
+        delete[] mCurrentRow;
+        if (m_connection)
+            m_connection->EndStream();
+    }
+
+    bool NextRow() override
+    {
+        static char const* const values[] = { "a", "b", "c" };
+        if (m_next == 3)
+        {
+            if (m_connection)
+                m_connection->EndStream();
+            m_connection = nullptr;
+            return false;
+        }
+        mCurrentRow[0].SetValue(values[m_next++]);
+        return true;
+    }
+
+private:
+    SqlConnection* m_connection;
+    uint32 m_next;
+};
+
+QueryResult* ThreadRecordingConnection::QueryStream(char const*)
+{
+    ++streams;
+    return new StreamResult(this);
+}
+
+class PooledDatabase final : public Database
+{
+public:
+    std::vector<ThreadRecordingConnection*> connections;
+
+protected:
+    SqlConnection* CreateConnection() override
+    {
+        connections.push_back(new ThreadRecordingConnection(*this));
+        return connections.back();
+    }
+};
+
+void taskGraphRunsDependentsAfterTheirDependencies()
+{
+    PooledDatabase database;
+    CHECK(database.Initialize("fake", 4, 0));
+    CHECK(database.GetQueryConnectionCount() == 4);
+
+    std::mutex lock;
+    std::vector<std::string> finished;
+    auto load = [&](char const* name)
+    {
+        return [&, name](uint32 worker)
+        {
+            Database::QueryConnectionScope pin(database, worker);
+            for (unsigned query = 0; query < 5; ++query)
+                database.PQuery("SELECT %s", name);
+            std::lock_guard<std::mutex> guard(lock);
+            finished.push_back(name);
+        };
+    };
+
+    MaNGOS::TaskGraph graph;
+    uint32 const a = graph.Add("a", load("a"));
+    uint32 const b = graph.Add("b", load("b"), { a });
+    uint32 const c = graph.Add("c", load("c"), { a });
+    uint32 const d = graph.Add("d", load("d"));
+    graph.Add("e", load("e"), { b, c, d });
+    graph.Run(4);
+
+    CHECK(finished.size() == 5);
+    CHECK(position(finished, "a") < position(finished, "b"));
+    CHECK(position(finished, "a") < position(finished, "c"));
+    CHECK(finished.back() == "e");
+    CHECK(graph.GetReports().size() == 5);
+    CHECK(graph.GetReports()[4].startMs >= graph.GetReports()[1].startMs + graph.GetReports()[1].durationMs);
+
+    // a pinned worker keeps to its own connection: no connection saw two threads
+    for (ThreadRecordingConnection* connection : database.connections)
+        CHECK(connection->threads.size() <= 1);
+
+    // one worker runs everything in the added order on the calling thread
+    finished.clear();
+    MaNGOS::TaskGraph sequential;
+    uint32 const first = sequential.Add("first", load("first"));
+    sequential.Add("second", load("second"));
+    sequential.Add("third", load("third"), { first });
+    sequential.Run(1);
+    CHECK(finished == std::vector<std::string>({ "first", "second", "third" }));
+
+    database.HaltDelayThread();
+}
+
+void streamedResultsKeepTheirConnection()
+{
+    PooledDatabase database;
+    CHECK(database.Initialize("fake", 2, 0));
+
+    Database::QueryConnectionScope pin(database, 0);
+    QueryResult* stream = database.QueryStream("SELECT `name` FROM `creature`");
+    CHECK(stream && stream->GetRowCount() == 0);
+    CHECK(database.connections[0]->streams == 1 && database.connections[0]->IsStreaming());
+
+    // the pinned connection is busy: queries made while reading the rows go elsewhere
+    std::string names;
+    do
+    {
+        names += stream->Fetch()[0].GetCppString();
+        database.Query("SELECT 1");
+    }
+    while (stream->NextRow());
+    CHECK(names == "abc");
+    CHECK(database.connections[0]->queries == 0 && database.connections[1]->queries == 3);
+
+    // drained: the connection is free again
+    CHECK(!database.connections[0]->IsStreaming());
+    database.Query("SELECT 1");
+    CHECK(database.connections[0]->queries == 1);
+    delete stream;
+
+    // deleting an undrained stream gives the connection back too
+    stream = database.QueryStream("SELECT `name` FROM `creature`");
+    CHECK(database.connections[0]->IsStreaming());
+
+    // a second stream would take the last free connection: it is buffered there instead
+    CHECK(!database.QueryStream("SELECT `name` FROM `creature`"));
+    CHECK(database.connections[1]->streams == 0 && !database.connections[1]->IsStreaming());
+    CHECK(database.connections[1]->queries == 4);
+    delete stream;
+    CHECK(!database.connections[0]->IsStreaming());
+    database.HaltDelayThread();
+
+    // with a single connection a nested query would have nowhere to go: buffer instead
+    PooledDatabase single;
+    CHECK(single.Initialize("fake", 1, 0));
+    CHECK(!single.QueryStream("SELECT `name` FROM `creature`"));
+    CHECK(single.connections[0]->streams == 0 && single.connections[0]->queries == 1);
+    single.HaltDelayThread();
+}
+
+void profilerFoldsLiteralsAndSplitsCallers()
+{
+    CHECK(SqlProfiler::Normalize("SELECT `name`  FROM `characters` WHERE `guid` = 42 AND `name` = 'O''Neil\\'s'") ==
+          "SELECT `name` FROM `characters` WHERE `guid` = ? AND `name` = ?");
+    CHECK(SqlProfiler::Normalize("DELETE FROM `item_instance` WHERE `guid` IN (1, 2,3)") ==
+          "DELETE FROM `item_instance` WHERE `guid` IN (?)");
+    CHECK(SqlProfiler::Normalize("INSERT INTO `t` (`a`, `b2`) VALUES (1, 'x'), (2, 'y'),(3,'z')") ==
+          "INSERT INTO `t` (`a`, `b2`) VALUES (?)");
+    CHECK(SqlProfiler::Normalize("UPDATE t1 SET x2 = -1.5, y = 0x1F") == "UPDATE t1 SET x2 = -?, y = ?");
+
+    SqlProfiler profiler;
+    profiler.Record("SELECT 1", false, 1, 100);
+    CHECK(profiler.GetTop(0).empty());
+
+    profiler.Configure(true, 0);
+    profiler.Record("SELECT `name` FROM `characters` WHERE `guid` = 1", false, 1, 300);
+    std::thread([&profiler]()
+    {
+        SqlProfiler::SetThreadCaller(SQL_CALLER_WORLD);
+        profiler.Record("SELECT `name` FROM `characters` WHERE `guid` = 2", false, 1, 700);
+        SqlProfiler::SetThreadCaller(SQL_CALLER_ASYNC);
+        profiler.Record("UPDATE `characters` SET `money` = ? WHERE `guid` = ?", true, 1, 50);
+    }).join();
+
+    std::vector<SqlProfiler::Row> const rows = profiler.GetTop(0);
+    CHECK(rows.size() == 2);
+    if (rows.size() == 2)
+    {
+        SqlProfiler::Counter const& select = rows[0].counter;
+        CHECK(rows[0].statement == "SELECT `name` FROM `characters` WHERE `guid` = ?");
+        CHECK(select.Calls() == 2 && select.TotalUs() == 1000 && select.maxUs == 700 && select.rows == 2);
+        CHECK(select.calls[SQL_CALLER_WORLD] == 1 && select.totalUs[SQL_CALLER_WORLD] == 700);
+        CHECK(rows[1].counter.calls[SQL_CALLER_ASYNC] == 1);
+    }
+    CHECK(profiler.GetTop(1).size() == 1);
+
+    profiler.Reset();
+    CHECK(profiler.GetTop(0).empty());
+}
+
+void futuresResolveOffTheCallingThread()
+{
+    PooledDatabase database;
+    CHECK(database.Initialize("fake", 1, 0));
+    std::size_t const syncConnections = database.connections.size() - 1;
+    uint32 const setupQueries = database.connections[0]->queries;
+
+    SqlQueryFuture future = database.QueryAsync("SELECT `race` FROM `characters` WHERE `account` = 1");
+    SqlQueryFuture dropped = database.PQueryAsync("SELECT `guid` FROM `characters` WHERE `name` = '%s'", "Nobody");
+    CHECK(future.IsValid() && dropped.IsValid() && !SqlQueryFuture().IsValid());
+    dropped = SqlQueryFuture();                              // the caller may go away first
+
+    for (int i = 0; i < 1000 && !future.IsReady(); ++i)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    CHECK(future.IsReady());
+    CHECK(!future.Take());
+
+    database.HaltDelayThread();
+    uint32 syncQueries = 0;
+    for (std::size_t i = 0; i < syncConnections; ++i)
+        syncQueries += database.connections[i]->queries;
+    CHECK(syncQueries == setupQueries);
+    CHECK(database.connections.back()->threads.count(std::this_thread::get_id()) == 0);
+
+    // a result is taken once; nobody taking it frees it with the last handle
+    SqlQueryFuture ready = SqlQueryFuture::Ready(new RowsResult({ { "1" } }));
+    SqlQueryFuture copy = ready;
+    QueryResult* result = copy.Take();
+    CHECK(result && ready.IsReady() && !ready.Take());
+    delete result;
+    SqlQueryFuture::Ready(new RowsResult({ { "2" } }));
 }
 
 int main()
 {
     concurrentQueriesUseTheConnectionLock();
     escapingSharesTheQueryConnectionLock();
+    shardedAsyncWorkKeepsPerKeyAndUnkeyedOrder();
+    transactionsBatchRunsOfOnePreparedStatement();
+    commitStatusReportsTheOutcomeOnceRun();
+    batchedInsertsBenchmark();
+    snapshotsReplayRowsAndRejectOtherKeys();
+    snapshotsKeepBinaryValuesAndRefuseDamagedFiles();
+    taskGraphRunsDependentsAfterTheirDependencies();
+    streamedResultsKeepTheirConnection();
+    profilerFoldsLiteralsAndSplitsCallers();
+    futuresResolveOffTheCallingThread();
     return mangos::test::failures == 0 ? 0 : 1;
 }
@@ -24,6 +24,7 @@
 
 #include "TestSupport.hpp"
 
+#include "Auth/AuthCrypt.h"
 #include "Auth/Sha1.h"
 #include "ClientConnection.h"
 #include "IWorldGateway.h"
@@ -900,6 +901,278 @@ void concurrentSendsPreserveEncryptionAndSubmissionOrder()
     CHECK(ServerOpcode(frames[0]) == SMSG_PONG);
     CHECK(ServerOpcode(frames[1]) == SMSG_NOTIFICATION);
 }
+
+void corkedOutputIsWrittenOncePerFlushInOrder()
+{
+    ConnectionHarness harness;
+    BigNumber sessionKey = Authenticate(harness);
+    proto::ClientConnection::SetCorking(true, 64);
+
+    WorldPacket first(SMSG_PONG, 1);
+    first << uint8(1);
+    WorldPacket second(SMSG_NOTIFICATION, 1);
+    second << uint8(2);
+    harness.connection->SendPacket(first);
+    harness.connection->SendPacket(second);
+    CHECK(harness.sent.empty());
+
+    harness.connection->Flush();
+    CHECK(harness.sent.size() == 1);
+    CHECK(harness.sent[0].size() == 2 * (proto::SERVER_HEADER_SIZE + 1));
+    std::vector<uint8> head(harness.sent[0].begin(),
+        harness.sent[0].begin() + proto::SERVER_HEADER_SIZE + 1);
+    std::vector<uint8> tail(harness.sent[0].begin() + proto::SERVER_HEADER_SIZE + 1,
+        harness.sent[0].end());
+    ClassicHeaderCipher cipher(sessionKey);
+    cipher.DecryptServerHeader(head);
+    cipher.DecryptServerHeader(tail);
+    CHECK(ServerOpcode(head) == SMSG_PONG);
+    CHECK(ServerOpcode(tail) == SMSG_NOTIFICATION);
+
+    harness.connection->Flush();
+    CHECK(harness.sent.size() == 1);
+
+    WorldPacket bulk(SMSG_NOTIFICATION, 80);
+    bulk.append(std::vector<uint8>(80, 0x33).data(), 80);
+    harness.connection->SendPacket(bulk);
+    CHECK(harness.sent.size() == 2);
+
+    harness.connection->SendPacket(first);
+    harness.connection->Close();
+    CHECK(harness.sent.size() == 3);
+    CHECK(harness.closeCalls == 1);
+
+    proto::ClientConnection::SetCorking(false, 16384);
+}
+
+void corkingNeverDelaysPreAuthenticationOutput()
+{
+    proto::ClientConnection::SetCorking(true, 16384);
+    ConnectionHarness harness;
+    harness.gateway.sendDuringAttach = true;
+    Authenticate(harness);
+    CHECK(harness.sent.size() == 1);
+    proto::ClientConnection::SetCorking(false, 16384);
+}
+
+class FakeFlowControl : public net::FlowControl
+{
+public:
+    bool awaitWritable(uint64_t) override { return true; }
+    uint64_t outstandingBytes() const override { return backlog; }
+
+    uint64_t backlog = 0;
+};
+
+WorldPacket MovementPacket(uint16 opcode, uint8 guid, uint8 marker)
+{
+    WorldPacket packet(opcode, 3);
+    packet << uint8(0x01) << guid << marker;                // packed guid, then payload
+    return packet;
+}
+
+std::vector<uint16> DecryptOpcodes(ClassicHeaderCipher& cipher,
+    std::vector<std::vector<uint8>>& frames, std::size_t first)
+{
+    std::vector<uint16> opcodes;
+    for (std::size_t i = first; i < frames.size(); ++i)
+    {
+        cipher.DecryptServerHeader(frames[i]);
+        opcodes.push_back(ServerOpcode(frames[i]));
+    }
+    return opcodes;
+}
+
+void congestedOutputIsReleasedByPriorityWithMovementMerged()
+{
+    ConnectionHarness harness;
+    std::shared_ptr<FakeFlowControl> const flow = std::make_shared<FakeFlowControl>();
+    harness.connection->setFlowControl(flow);
+    BigNumber sessionKey = Authenticate(harness);
+    proto::ClientConnection::SetShaping(true, 1024, 0);
+    ClassicHeaderCipher cipher(sessionKey);
+
+    WorldPacket pong(SMSG_PONG, 1);
+    pong << uint8(1);
+    harness.connection->SendPacket(pong);
+    CHECK(harness.sent.size() == 1);
+
+    flow->backlog = 4096;
+    WorldPacket update(SMSG_UPDATE_OBJECT, 1);
+    update << uint8(2);
+    WorldPacket chat(SMSG_MESSAGECHAT, 1);
+    chat << uint8(3);
+    harness.connection->SendPacket(update);
+    harness.connection->SendPacket(MovementPacket(MSG_MOVE_HEARTBEAT, 5, 0xA0));
+    harness.connection->SendPacket(chat);
+    harness.connection->SendPacket(MovementPacket(MSG_MOVE_STOP, 5, 0xA1));
+    harness.connection->SendPacket(MovementPacket(MSG_MOVE_HEARTBEAT, 6, 0xB0));
+    CHECK(harness.sent.size() == 1);
+
+    flow->backlog = 0;
+    harness.connection->Flush();
+    std::vector<uint16> const opcodes = DecryptOpcodes(cipher, harness.sent, 0);
+    std::vector<uint16> const expected =
+        { SMSG_PONG, SMSG_UPDATE_OBJECT, MSG_MOVE_STOP, MSG_MOVE_HEARTBEAT, SMSG_MESSAGECHAT };
+    CHECK(opcodes == expected);
+    CHECK(harness.sent[2].back() == 0xA1);
+    CHECK(harness.sent[3].back() == 0xB0);
+
+    proto::ClientConnection::SetShaping(false, 65536, 16384);
+}
+
+void shapedBudgetHoldsBulkUntilABarrierReleasesItInOrder()
+{
+    ConnectionHarness harness;
+    std::shared_ptr<FakeFlowControl> const flow = std::make_shared<FakeFlowControl>();
+    harness.connection->setFlowControl(flow);
+    BigNumber sessionKey = Authenticate(harness);
+    proto::ClientConnection::SetShaping(true, 1024, 1);
+    ClassicHeaderCipher cipher(sessionKey);
+
+    flow->backlog = 4096;
+    WorldPacket update(SMSG_UPDATE_OBJECT, 1);
+    update << uint8(1);
+    WorldPacket chat(SMSG_MESSAGECHAT, 1);
+    chat << uint8(2);
+    harness.connection->SendPacket(update);
+    harness.connection->SendPacket(chat);
+    harness.connection->SendPacket(MovementPacket(MSG_MOVE_HEARTBEAT, 5, 0xA0));
+    harness.connection->Flush();
+    CHECK(harness.sent.size() == 1);
+
+    // A movement update that is not positional blocks merging across it.
+    harness.connection->SendPacket(MovementPacket(MSG_MOVE_SET_RUN_SPEED, 5, 0xA1));
+    harness.connection->SendPacket(MovementPacket(MSG_MOVE_HEARTBEAT, 5, 0xA2));
+    WorldPacket newWorld(SMSG_NEW_WORLD, 1);
+    newWorld << uint8(3);
+    harness.connection->SendPacket(newWorld);
+
+    std::vector<uint16> const opcodes = DecryptOpcodes(cipher, harness.sent, 0);
+    std::vector<uint16> const expected = { SMSG_UPDATE_OBJECT, SMSG_MESSAGECHAT,
+        MSG_MOVE_HEARTBEAT, MSG_MOVE_SET_RUN_SPEED, MSG_MOVE_HEARTBEAT, SMSG_NEW_WORLD };
+    CHECK(opcodes == expected);
+    CHECK(harness.sent[4].back() == 0xA2);
+
+    proto::ClientConnection::SetShaping(false, 65536, 16384);
+}
+
+void heldMovementIsNotMergedAcrossAnObjectUpdate()
+{
+    ConnectionHarness harness;
+    std::shared_ptr<FakeFlowControl> const flow = std::make_shared<FakeFlowControl>();
+    harness.connection->setFlowControl(flow);
+    BigNumber sessionKey = Authenticate(harness);
+    proto::ClientConnection::SetShaping(true, 1024, 0);
+    ClassicHeaderCipher cipher(sessionKey);
+
+    // The update may destroy and re-create unit 5: both positions must reach
+    // the client, each on its own side of it.
+    flow->backlog = 4096;
+    WorldPacket chat(SMSG_MESSAGECHAT, 1);
+    chat << uint8(1);
+    WorldPacket update(SMSG_UPDATE_OBJECT, 1);
+    update << uint8(2);
+    harness.connection->SendPacket(chat);
+    harness.connection->SendPacket(MovementPacket(MSG_MOVE_HEARTBEAT, 5, 0xA0));
+    harness.connection->SendPacket(update);
+    harness.connection->SendPacket(MovementPacket(MSG_MOVE_HEARTBEAT, 5, 0xA1));
+
+    flow->backlog = 0;
+    harness.connection->Flush();
+    std::vector<uint16> const opcodes = DecryptOpcodes(cipher, harness.sent, 0);
+    std::vector<uint16> const expected =
+        { MSG_MOVE_HEARTBEAT, SMSG_UPDATE_OBJECT, MSG_MOVE_HEARTBEAT, SMSG_MESSAGECHAT };
+    CHECK(opcodes == expected);
+    CHECK(harness.sent[0].back() == 0xA0);
+    CHECK(harness.sent[2].back() == 0xA1);
+
+    proto::ClientConnection::SetShaping(false, 65536, 16384);
+}
+}
+
+void clientRoleDecodesServerFramesAcrossEverySplit()
+{
+    WorldPacket first(SMSG_PONG, 4);
+    first << uint32(0x01020304);
+    WorldPacket second(SMSG_AUTH_CHALLENGE, 0);
+    std::vector<uint8> wire = proto::PacketCodec::Encode(first);
+    proto::PacketCodec::EncodeTo(second, {}, wire);
+
+    for (std::size_t split = 1; split < wire.size(); ++split)
+    {
+        proto::PacketCodec codec({}, proto::CodecRole::Client);
+        std::vector<WorldPacket> packets;
+        codec.Feed(wire.data(), split, packets);
+        CHECK(codec.Feed(wire.data() + split, wire.size() - split, packets)
+            == proto::DecodeStatus::Ready);
+        CHECK(packets.size() == 2);
+        CHECK(packets[0].GetOpcode() == SMSG_PONG);
+        CHECK_BYTES(packets[0].contents(), packets[0].size(), {0x04, 0x03, 0x02, 0x01});
+        CHECK(packets[1].GetOpcode() == SMSG_AUTH_CHALLENGE && packets[1].empty());
+    }
+
+    proto::PacketCodec codec({}, proto::CodecRole::Client);
+    std::vector<WorldPacket> packets;
+    uint8 const tooSmall[] = {0x00, 0x01, 0x00, 0x00};
+    CHECK(codec.Feed(tooSmall, sizeof(tooSmall), packets) == proto::DecodeStatus::Malformed);
+}
+
+void encryptedFramesRoundTripBetweenClientAndServerRoles()
+{
+    uint8 key[40];
+    for (std::size_t i = 0; i < sizeof(key); ++i)
+    {
+        key[i] = uint8(i * 7 + 3);
+    }
+    AuthCrypt client;
+    client.SetClientSide();
+    client.SetKey(key, sizeof(key));
+    client.Init();
+    AuthCrypt server;
+    server.SetKey(key, sizeof(key));
+    server.Init();
+
+    std::vector<uint8> wire;
+    for (uint32 i = 0; i < 3; ++i)
+    {
+        WorldPacket packet(CMSG_PING, 8);
+        packet << uint32(i) << uint32(0);
+        proto::PacketCodec::EncodeClientTo(packet,
+            [&client](uint8* header, std::size_t len)
+            {
+                client.EncryptSend(header, len);
+            }, wire);
+    }
+
+    proto::PacketCodec codec([&server](uint8* header, std::size_t len)
+    {
+        server.DecryptRecv(header, len);
+    });
+    std::vector<WorldPacket> packets;
+    CHECK(codec.Feed(wire.data(), wire.size(), packets) == proto::DecodeStatus::Ready);
+    CHECK(packets.size() == 3);
+    for (uint32 i = 0; i < packets.size(); ++i)
+    {
+        uint32 sequence = 0;
+        packets[i] >> sequence;
+        CHECK(packets[i].GetOpcode() == CMSG_PING && sequence == i);
+    }
+
+    WorldPacket pong(SMSG_PONG, 4);
+    pong << uint32(2);
+    std::vector<uint8> const reply = proto::PacketCodec::Encode(pong,
+        [&server](uint8* header, std::size_t len)
+        {
+            server.EncryptSend(header, len);
+        });
+    proto::PacketCodec clientCodec([&client](uint8* header, std::size_t len)
+    {
+        client.DecryptRecv(header, len);
+    }, proto::CodecRole::Client);
+    packets.clear();
+    CHECK(clientCodec.Feed(reply.data(), reply.size(), packets) == proto::DecodeStatus::Ready);
+    CHECK(packets.size() == 1 && packets[0].GetOpcode() == SMSG_PONG);
 }
 
 int main()
@@ -910,6 +1183,8 @@ int main()
     malformedFramesAreRejected();
     maximumAcceptedSizeDecodes();
     serverFramesUseTheFixedClassicHeader();
+    clientRoleDecodesServerFramesAcrossEverySplit();
+    encryptedFramesRoundTripBetweenClientAndServerRoles();
     connectionChallengeHasTheExpectedClassicShape();
     preAuthenticationWorldPacketsAreRejected();
     authenticationFilterVetoAllowsALaterAcceptedAttempt();
@@ -928,5 +1203,10 @@ int main()
     coalescedAuthenticationActivatesCryptBeforeTheNextFrame();
     fragmentedEncryptedHeadersKeepCipherStateSynchronized();
     concurrentSendsPreserveEncryptionAndSubmissionOrder();
+    corkedOutputIsWrittenOncePerFlushInOrder();
+    corkingNeverDelaysPreAuthenticationOutput();
+    congestedOutputIsReleasedByPriorityWithMovementMerged();
+    shapedBudgetHoldsBulkUntilABarrierReleasesItInOrder();
+    heldMovementIsNotMergedAcrossAnObjectUpdate();
     return mangos::test::failures == 0 ? 0 : 1;
 }